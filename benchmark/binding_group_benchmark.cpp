@@ -0,0 +1,99 @@
+#include "jipu/binding_group.h"
+#include "jipu/binding_group_layout.h"
+#include "jipu/buffer.h"
+#include "jipu/device.h"
+#include "jipu/instance.h"
+#include "jipu/physical_device.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+using namespace jipu;
+
+namespace
+{
+
+// offsets are cycled so that every group misses the binding group cache.
+constexpr uint64_t kUniformSize = 256;
+constexpr uint64_t kUniformCount = 1024;
+
+class BindingGroupFixture : public benchmark::Fixture
+{
+public:
+    void SetUp(const benchmark::State& state) override
+    {
+        InstanceDescriptor instanceDescriptor{};
+        instanceDescriptor.type = InstanceType::kVulkan;
+        m_instance = Instance::create(instanceDescriptor);
+
+        m_physicalDevices = m_instance->getPhysicalDevices();
+
+        DeviceDescriptor deviceDescriptor{};
+        m_device = m_physicalDevices[0]->createDevice(deviceDescriptor);
+
+        BufferDescriptor bufferDescriptor{};
+        bufferDescriptor.size = kUniformSize * kUniformCount;
+        bufferDescriptor.usage = BufferUsageFlagBits::kUniform;
+        m_buffer = m_device->createBuffer(bufferDescriptor);
+
+        BindingGroupLayoutDescriptor bindingGroupLayoutDescriptor{};
+        const auto bindingCount = static_cast<uint32_t>(state.range(0));
+        for (auto i = 0; i < bindingCount; ++i)
+        {
+            BufferBindingLayout bufferBindingLayout{};
+            bufferBindingLayout.index = i;
+            bufferBindingLayout.stages = BindingStageFlagBits::kVertexStage;
+            bufferBindingLayout.type = BufferBindingType::kUniform;
+            bindingGroupLayoutDescriptor.buffers.push_back(bufferBindingLayout);
+        }
+        m_bindingGroupLayout = m_device->createBindingGroupLayout(bindingGroupLayoutDescriptor);
+    }
+
+    void TearDown(const benchmark::State& state) override
+    {
+        m_bindingGroupLayout.reset();
+        m_buffer.reset();
+        m_device.reset();
+        m_physicalDevices.clear();
+        m_instance.reset();
+    }
+
+protected:
+    std::unique_ptr<Instance> m_instance = nullptr;
+    std::vector<std::unique_ptr<PhysicalDevice>> m_physicalDevices{};
+    std::unique_ptr<Device> m_device = nullptr;
+    std::unique_ptr<Buffer> m_buffer = nullptr;
+    std::unique_ptr<BindingGroupLayout> m_bindingGroupLayout = nullptr;
+};
+
+} // namespace
+
+// measures binding groups created per second. descriptors are written by update template if it is supported.
+BENCHMARK_DEFINE_F(BindingGroupFixture, CreateBindingGroup)(benchmark::State& state)
+{
+    const auto bindingCount = static_cast<uint32_t>(state.range(0));
+
+    uint64_t uniformIndex = 0;
+    for (auto _ : state)
+    {
+        BindingGroupDescriptor bindingGroupDescriptor{ .layout = *m_bindingGroupLayout };
+        for (auto i = 0; i < bindingCount; ++i)
+        {
+            bindingGroupDescriptor.buffers.push_back(BufferBinding{
+                .index = static_cast<uint32_t>(i),
+                .offset = ((uniformIndex + i) % kUniformCount) * kUniformSize,
+                .size = kUniformSize,
+                .buffer = *m_buffer,
+            });
+        }
+        uniformIndex = (uniformIndex + 1) % kUniformCount;
+
+        auto bindingGroup = m_device->createBindingGroup(bindingGroupDescriptor);
+        benchmark::DoNotOptimize(bindingGroup.get());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(BindingGroupFixture, CreateBindingGroup)->Arg(1)->Arg(4)->Arg(8);
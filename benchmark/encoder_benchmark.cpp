@@ -0,0 +1,300 @@
+#include "jipu/binding_group.h"
+#include "jipu/binding_group_layout.h"
+#include "jipu/buffer.h"
+#include "jipu/command_buffer.h"
+#include "jipu/command_encoder.h"
+#include "jipu/device.h"
+#include "jipu/instance.h"
+#include "jipu/physical_device.h"
+#include "jipu/pipeline.h"
+#include "jipu/pipeline_layout.h"
+#include "jipu/queue.h"
+#include "jipu/render_pass_encoder.h"
+#include "jipu/shader_module.h"
+#include "jipu/texture.h"
+#include "jipu/texture_view.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace jipu;
+
+namespace
+{
+
+constexpr uint64_t kUniformSize = 256;
+constexpr uint64_t kUniformCount = 64;
+// commands are recorded into one render pass up to this count, then it is submitted to bound the memory of the command buffer.
+constexpr uint32_t kDrawsPerPass = 4096;
+
+/*
+    #version 450
+
+    layout(location = 0) in vec2 inPos;
+    layout(location = 1) in vec2 inUV;
+    layout(location = 2) in vec4 inColor;
+
+    layout(location = 0) out vec2 outUV;
+    layout(location = 1) out vec4 outColor;
+
+    layout(binding = 1) uniform UITransform {
+        vec2 scale;
+        vec2 translate;
+    } uiTransform;
+
+    out gl_PerVertex
+    {
+        vec4 gl_Position;
+    };
+
+    void main()
+    {
+        outUV = inUV;
+        outColor = inColor;
+        gl_Position = vec4(inPos * uiTransform.scale + uiTransform.translate, 0.0, 1.0);
+    }
+*/
+const std::vector<uint32_t> vertexShaderSourceSpv = { 0x07230203, 0x00010000, 0x000d000b, 0x0000002b, 0x00000000, 0x00020011, 0x00000001, 0x0006000b, 0x00000001, 0x4c534c47, 0x6474732e, 0x3035342e, 0x00000000, 0x0003000e, 0x00000000, 0x00000001, 0x000b000f, 0x00000000, 0x00000004, 0x6e69616d, 0x00000000, 0x00000009, 0x0000000b, 0x0000000f, 0x00000011, 0x00000015, 0x00000018, 0x00030003, 0x00000002, 0x000001c2, 0x000a0004, 0x475f4c47, 0x4c474f4f, 0x70635f45, 0x74735f70, 0x5f656c79, 0x656e696c, 0x7269645f, 0x69746365, 0x00006576, 0x00080004, 0x475f4c47, 0x4c474f4f, 0x6e695f45, 0x64756c63, 0x69645f65, 0x74636572, 0x00657669, 0x00040005, 0x00000004, 0x6e69616d, 0x00000000, 0x00040005, 0x00000009, 0x5574756f, 0x00000056, 0x00040005, 0x0000000b, 0x56556e69, 0x00000000, 0x00050005, 0x0000000f, 0x4374756f, 0x726f6c6f, 0x00000000, 0x00040005, 0x00000011, 0x6f436e69, 0x00726f6c, 0x00060005, 0x00000013, 0x505f6c67, 0x65567265, 0x78657472, 0x00000000, 0x00060006, 0x00000013, 0x00000000, 0x505f6c67, 0x7469736f, 0x006e6f69, 0x00030005, 0x00000015, 0x00000000, 0x00040005, 0x00000018, 0x6f506e69, 0x00000073, 0x00050005, 0x0000001a, 0x72544955, 0x66736e61, 0x006d726f, 0x00050006, 0x0000001a, 0x00000000, 0x6c616373, 0x00000065, 0x00060006, 0x0000001a, 0x00000001, 0x6e617274, 0x74616c73, 0x00000065, 0x00050005, 0x0000001c, 0x72546975, 0x66736e61, 0x006d726f, 0x00040047, 0x00000009, 0x0000001e, 0x00000000, 0x00040047, 0x0000000b, 0x0000001e, 0x00000001, 0x00040047, 0x0000000f, 0x0000001e, 0x00000001, 0x00040047, 0x00000011, 0x0000001e, 0x00000002, 0x00050048, 0x00000013, 0x00000000, 0x0000000b, 0x00000000, 0x00030047, 0x00000013, 0x00000002, 0x00040047, 0x00000018, 0x0000001e, 0x00000000, 0x00050048, 0x0000001a, 0x00000000, 0x00000023, 0x00000000, 0x00050048, 0x0000001a, 0x00000001, 0x00000023, 0x00000008, 0x00030047, 0x0000001a, 0x00000002, 0x00040047, 0x0000001c, 0x00000022, 0x00000000, 0x00040047, 0x0000001c, 0x00000021, 0x00000001, 0x00020013, 0x00000002, 0x00030021, 0x00000003, 0x00000002, 0x00030016, 0x00000006, 0x00000020, 0x00040017, 0x00000007, 0x00000006, 0x00000002, 0x00040020, 0x00000008, 0x00000003, 0x00000007, 0x0004003b, 0x00000008, 0x00000009, 0x00000003, 0x00040020, 0x0000000a, 0x00000001, 0x00000007, 0x0004003b, 0x0000000a, 0x0000000b, 0x00000001, 0x00040017, 0x0000000d, 0x00000006, 0x00000004, 0x00040020, 0x0000000e, 0x00000003, 0x0000000d, 0x0004003b, 0x0000000e, 0x0000000f, 0x00000003, 0x00040020, 0x00000010, 0x00000001, 0x0000000d, 0x0004003b, 0x00000010, 0x00000011, 0x00000001, 0x0003001e, 0x00000013, 0x0000000d, 0x00040020, 0x00000014, 0x00000003, 0x00000013, 0x0004003b, 0x00000014, 0x00000015, 0x00000003, 0x00040015, 0x00000016, 0x00000020, 0x00000001, 0x0004002b, 0x00000016, 0x00000017, 0x00000000, 0x0004003b, 0x0000000a, 0x00000018, 0x00000001, 0x0004001e, 0x0000001a, 0x00000007, 0x00000007, 0x00040020, 0x0000001b, 0x00000002, 0x0000001a, 0x0004003b, 0x0000001b, 0x0000001c, 0x00000002, 0x00040020, 0x0000001d, 0x00000002, 0x00000007, 0x0004002b, 0x00000016, 0x00000021, 0x00000001, 0x0004002b, 0x00000006, 0x00000025, 0x00000000, 0x0004002b, 0x00000006, 0x00000026, 0x3f800000, 0x00050036, 0x00000002, 0x00000004, 0x00000000, 0x00000003, 0x000200f8, 0x00000005, 0x0004003d, 0x00000007, 0x0000000c, 0x0000000b, 0x0003003e, 0x00000009, 0x0000000c, 0x0004003d, 0x0000000d, 0x00000012, 0x00000011, 0x0003003e, 0x0000000f, 0x00000012, 0x0004003d, 0x00000007, 0x00000019, 0x00000018, 0x00050041, 0x0000001d, 0x0000001e, 0x0000001c, 0x00000017, 0x0004003d, 0x00000007, 0x0000001f, 0x0000001e, 0x00050085, 0x00000007, 0x00000020, 0x00000019, 0x0000001f, 0x00050041, 0x0000001d, 0x00000022, 0x0000001c, 0x00000021, 0x0004003d, 0x00000007, 0x00000023, 0x00000022, 0x00050081, 0x00000007, 0x00000024, 0x00000020, 0x00000023, 0x00050051, 0x00000006, 0x00000027, 0x00000024, 0x00000000, 0x00050051, 0x00000006, 0x00000028, 0x00000024, 0x00000001, 0x00070050, 0x0000000d, 0x00000029, 0x00000027, 0x00000028, 0x00000025, 0x00000026, 0x00050041, 0x0000000e, 0x0000002a, 0x00000015, 0x00000017, 0x0003003e, 0x0000002a, 0x00000029, 0x000100fd, 0x00010038 };
+
+/*
+    #version 450
+
+    void main()
+    {
+    }
+*/
+const std::vector<uint32_t> fragmentShaderSourceSpv = { 0x07230203, 0x00010000, 0x00000000, 0x00000005, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0005000f, 0x00000004, 0x00000001, 0x6e69616d, 0x00000000, 0x00030010, 0x00000001, 0x00000007, 0x00020013, 0x00000002, 0x00030021, 0x00000003, 0x00000002, 0x00050036, 0x00000002, 0x00000001, 0x00000000, 0x00000003, 0x000200f8, 0x00000004, 0x000100fd, 0x00010038 };
+
+std::unique_ptr<ShaderModule> createShaderModule(Device& device, const std::vector<uint32_t>& spv)
+{
+    ShaderModuleDescriptor shaderModuleDescriptor{};
+    shaderModuleDescriptor.code = reinterpret_cast<const char*>(spv.data());
+    shaderModuleDescriptor.codeSize = static_cast<uint32_t>(spv.size() * 4);
+
+    return device.createShaderModule(shaderModuleDescriptor);
+}
+
+class EncoderFixture : public benchmark::Fixture
+{
+public:
+    void SetUp(const benchmark::State& state) override
+    {
+        InstanceDescriptor instanceDescriptor{};
+        instanceDescriptor.type = InstanceType::kVulkan;
+        m_instance = Instance::create(instanceDescriptor);
+
+        m_physicalDevices = m_instance->getPhysicalDevices();
+
+        DeviceDescriptor deviceDescriptor{};
+        m_device = m_physicalDevices[0]->createDevice(deviceDescriptor);
+
+        QueueDescriptor queueDescriptor{};
+        queueDescriptor.flags = QueueFlagBits::kGraphics;
+        m_queue = m_device->createQueue(queueDescriptor);
+
+        TextureDescriptor textureDescriptor{};
+        textureDescriptor.type = TextureType::k2D;
+        textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+        textureDescriptor.mipLevels = 1;
+        textureDescriptor.sampleCount = 1;
+        textureDescriptor.width = 256;
+        textureDescriptor.height = 256;
+        textureDescriptor.depth = 1;
+        textureDescriptor.usage = TextureUsageFlagBits::kColorAttachment;
+        m_texture = m_device->createTexture(textureDescriptor);
+
+        TextureViewDescriptor textureViewDescriptor{};
+        textureViewDescriptor.type = TextureViewType::k2D;
+        textureViewDescriptor.aspect = TextureAspectFlagBits::kColor;
+        m_textureView = m_texture->createTextureView(textureViewDescriptor);
+
+        BufferDescriptor uniformBufferDescriptor{};
+        uniformBufferDescriptor.size = kUniformSize * kUniformCount;
+        uniformBufferDescriptor.usage = BufferUsageFlagBits::kUniform;
+        m_uniformBuffer = m_device->createBuffer(uniformBufferDescriptor);
+
+        BufferDescriptor vertexBufferDescriptor{};
+        vertexBufferDescriptor.size = sizeof(float) * 8 * 3;
+        vertexBufferDescriptor.usage = BufferUsageFlagBits::kVertex;
+        m_vertexBuffer = m_device->createBuffer(vertexBufferDescriptor);
+
+        BufferDescriptor indexBufferDescriptor{};
+        indexBufferDescriptor.size = sizeof(uint16_t) * 3;
+        indexBufferDescriptor.usage = BufferUsageFlagBits::kIndex;
+        m_indexBuffer = m_device->createBuffer(indexBufferDescriptor);
+
+        BufferBindingLayout bufferBindingLayout{};
+        bufferBindingLayout.index = 1;
+        bufferBindingLayout.stages = BindingStageFlagBits::kVertexStage;
+        bufferBindingLayout.type = BufferBindingType::kUniform;
+        bufferBindingLayout.dynamicOffset = true;
+
+        BindingGroupLayoutDescriptor bindingGroupLayoutDescriptor{};
+        bindingGroupLayoutDescriptor.buffers = { bufferBindingLayout };
+        m_bindingGroupLayout = m_device->createBindingGroupLayout(bindingGroupLayoutDescriptor);
+
+        BindingGroupDescriptor bindingGroupDescriptor{ .layout = *m_bindingGroupLayout };
+        bindingGroupDescriptor.buffers = { BufferBinding{
+            .index = 1,
+            .offset = 0,
+            .size = kUniformSize,
+            .buffer = *m_uniformBuffer,
+        } };
+        m_bindingGroup = m_device->createBindingGroup(bindingGroupDescriptor);
+
+        PipelineLayoutDescriptor pipelineLayoutDescriptor{};
+        pipelineLayoutDescriptor.layouts = { *m_bindingGroupLayout };
+        m_pipelineLayout = m_device->createPipelineLayout(pipelineLayoutDescriptor);
+
+        m_vertexShaderModule = createShaderModule(*m_device, vertexShaderSourceSpv);
+        m_fragmentShaderModule = createShaderModule(*m_device, fragmentShaderSourceSpv);
+
+        InputAssemblyStage inputAssemblyStage{};
+        inputAssemblyStage.topology = PrimitiveTopology::kTriangleList;
+
+        VertexInputLayout vertexInputLayout{};
+        vertexInputLayout.mode = VertexMode::kVertex;
+        vertexInputLayout.stride = sizeof(float) * 8;
+        vertexInputLayout.attributes = {
+            { .format = VertexFormat::kSFLOATx2, .offset = 0, .location = 0 },
+            { .format = VertexFormat::kSFLOATx2, .offset = sizeof(float) * 2, .location = 1 },
+            { .format = VertexFormat::kSFLOATx4, .offset = sizeof(float) * 4, .location = 2 },
+        };
+
+        VertexStage vertexStage{
+            { *m_vertexShaderModule, "main" },
+            { vertexInputLayout },
+        };
+
+        RasterizationStage rasterizationStage{};
+        rasterizationStage.cullMode = CullMode::kNone;
+        rasterizationStage.frontFace = FrontFace::kCounterClockwise;
+        rasterizationStage.sampleCount = 1;
+
+        FragmentStage::Target target{};
+        target.format = TextureFormat::kRGBA_8888_UInt_Norm;
+
+        FragmentStage fragmentStage{
+            { *m_fragmentShaderModule, "main" },
+            { target },
+        };
+
+        RenderPipelineDescriptor renderPipelineDescriptor{
+            { *m_pipelineLayout },
+            inputAssemblyStage,
+            vertexStage,
+            rasterizationStage,
+            fragmentStage,
+        };
+        m_pipeline = m_device->createRenderPipeline(renderPipelineDescriptor);
+
+        CommandBufferDescriptor commandBufferDescriptor{};
+        m_commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    }
+
+    void TearDown(const benchmark::State& state) override
+    {
+        m_commandBuffer.reset();
+        m_pipeline.reset();
+        m_fragmentShaderModule.reset();
+        m_vertexShaderModule.reset();
+        m_pipelineLayout.reset();
+        m_bindingGroup.reset();
+        m_bindingGroupLayout.reset();
+        m_indexBuffer.reset();
+        m_vertexBuffer.reset();
+        m_uniformBuffer.reset();
+        m_textureView.reset();
+        m_texture.reset();
+        m_queue.reset();
+        m_device.reset();
+        m_physicalDevices.clear();
+        m_instance.reset();
+    }
+
+protected:
+    std::unique_ptr<RenderPassEncoder> beginRenderPass(CommandEncoder& commandEncoder)
+    {
+        RenderPassEncoderDescriptor renderPassDescriptor{};
+        renderPassDescriptor.colorAttachments.push_back(ColorAttachment{
+            .renderView = *m_textureView,
+            .loadOp = LoadOp::kClear,
+            .storeOp = StoreOp::kStore,
+            .clearValue = { .r = 0.0, .g = 0.0, .b = 0.0, .a = 0.0 },
+        });
+        renderPassDescriptor.sampleCount = 1;
+
+        auto renderPassEncoder = commandEncoder.beginRenderPass(renderPassDescriptor);
+        renderPassEncoder->setPipeline(*m_pipeline);
+        renderPassEncoder->setVertexBuffer(0, *m_vertexBuffer);
+        renderPassEncoder->setIndexBuffer(*m_indexBuffer, IndexFormat::kUint16);
+        renderPassEncoder->setViewport(0, 0, 256, 256, 0, 1);
+        renderPassEncoder->setScissor(0, 0, 256, 256);
+
+        return renderPassEncoder;
+    }
+
+protected:
+    std::unique_ptr<Instance> m_instance = nullptr;
+    std::vector<std::unique_ptr<PhysicalDevice>> m_physicalDevices{};
+    std::unique_ptr<Device> m_device = nullptr;
+    std::unique_ptr<Queue> m_queue = nullptr;
+    std::unique_ptr<Texture> m_texture = nullptr;
+    std::unique_ptr<TextureView> m_textureView = nullptr;
+    std::unique_ptr<Buffer> m_uniformBuffer = nullptr;
+    std::unique_ptr<Buffer> m_vertexBuffer = nullptr;
+    std::unique_ptr<Buffer> m_indexBuffer = nullptr;
+    std::unique_ptr<BindingGroupLayout> m_bindingGroupLayout = nullptr;
+    std::unique_ptr<BindingGroup> m_bindingGroup = nullptr;
+    std::unique_ptr<PipelineLayout> m_pipelineLayout = nullptr;
+    std::unique_ptr<ShaderModule> m_vertexShaderModule = nullptr;
+    std::unique_ptr<ShaderModule> m_fragmentShaderModule = nullptr;
+    std::unique_ptr<RenderPipeline> m_pipeline = nullptr;
+    std::unique_ptr<CommandBuffer> m_commandBuffer = nullptr;
+};
+
+} // namespace
+
+// measures ns per setBindingGroup + drawIndexed. the offset is same for every draw if arg is 0, so the binding is elided.
+// otherwise, the dynamic offset is changed for every draw and the set is bound again.
+BENCHMARK_DEFINE_F(EncoderFixture, SetBindingGroupDrawIndexed)(benchmark::State& state)
+{
+    const bool changeOffset = state.range(0) != 0;
+
+    auto commandEncoder = m_commandBuffer->createCommandEncoder(CommandEncoderDescriptor{});
+    auto renderPassEncoder = beginRenderPass(*commandEncoder);
+
+    uint32_t drawCount = 0;
+    uint32_t uniformIndex = 0;
+    for (auto _ : state)
+    {
+        const std::array<uint32_t, 1> dynamicOffset = { static_cast<uint32_t>(uniformIndex * kUniformSize) };
+        renderPassEncoder->setBindingGroup(0, *m_bindingGroup, dynamicOffset);
+        renderPassEncoder->drawIndexed(3, 1, 0, 0, 0);
+
+        if (changeOffset)
+            uniformIndex = (uniformIndex + 1) % kUniformCount;
+
+        if (++drawCount == kDrawsPerPass)
+        {
+            state.PauseTiming();
+            renderPassEncoder->end();
+            m_queue->submit({ commandEncoder->finish() });
+
+            commandEncoder = m_commandBuffer->createCommandEncoder(CommandEncoderDescriptor{});
+            renderPassEncoder = beginRenderPass(*commandEncoder);
+            drawCount = 0;
+            state.ResumeTiming();
+        }
+    }
+
+    renderPassEncoder->end();
+    m_queue->submit({ commandEncoder->finish() });
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(EncoderFixture, SetBindingGroupDrawIndexed)->Arg(0)->Arg(1);
@@ -0,0 +1,164 @@
+#include "jipu/device.h"
+#include "jipu/instance.h"
+#include "jipu/physical_device.h"
+#include "jipu/pipeline.h"
+#include "jipu/pipeline_layout.h"
+#include "jipu/shader_module.h"
+
+#include "source/vulkan/vulkan_device.h"
+#include "source/vulkan/vulkan_physical_device.h"
+#include "source/vulkan/vulkan_pipeline.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+using namespace jipu;
+
+namespace
+{
+
+/*
+    #version 450
+    void main()
+    {
+        vec2 position = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+        gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+    }
+*/
+const std::vector<uint32_t> fullScreenVertexShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x0000001c, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0007000f, 0x00000000, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00000003, 0x00040047, 0x00000002, 0x0000000b, 0x0000002a, 0x00040047, 0x00000003, 0x0000000b, 0x00000000, 0x00020013, 0x00000004, 0x00030021, 0x00000005, 0x00000004, 0x00030016, 0x00000006, 0x00000020, 0x00040017, 0x00000007, 0x00000006, 0x00000004, 0x00040015, 0x00000008, 0x00000020, 0x00000001, 0x00040020, 0x00000009, 0x00000001, 0x00000008, 0x0004003b, 0x00000009, 0x00000002, 0x00000001, 0x00040020, 0x0000000a, 0x00000003, 0x00000007, 0x0004003b, 0x0000000a, 0x00000003, 0x00000003, 0x0004002b, 0x00000008, 0x0000000b, 0x00000001, 0x0004002b, 0x00000008, 0x0000000c, 0x00000002, 0x0004002b, 0x00000006, 0x0000000d, 0x00000000, 0x0004002b, 0x00000006, 0x0000000e, 0x3f800000, 0x0004002b, 0x00000006, 0x0000000f, 0x40000000, 0x00050036, 0x00000004, 0x00000001, 0x00000000, 0x00000005, 0x000200f8, 0x00000010, 0x0004003d, 0x00000008, 0x00000011, 0x00000002, 0x000500c4, 0x00000008, 0x00000012, 0x00000011, 0x0000000b, 0x000500c7, 0x00000008, 0x00000013, 0x00000012, 0x0000000c, 0x000500c7, 0x00000008, 0x00000014, 0x00000011, 0x0000000c, 0x0004006f, 0x00000006, 0x00000015, 0x00000013, 0x0004006f, 0x00000006, 0x00000016, 0x00000014, 0x00050085, 0x00000006, 0x00000017, 0x00000015, 0x0000000f, 0x00050083, 0x00000006, 0x00000018, 0x00000017, 0x0000000e, 0x00050085, 0x00000006, 0x00000019, 0x00000016, 0x0000000f, 0x00050083, 0x00000006, 0x0000001a, 0x00000019, 0x0000000e, 0x00070050, 0x00000007, 0x0000001b, 0x00000018, 0x0000001a, 0x0000000d, 0x0000000e, 0x0003003e, 0x00000003, 0x0000001b, 0x000100fd, 0x00010038 };
+
+/*
+    #version 450
+    layout(location = 0) out vec4 outColor;
+    void main() { outColor = vec4(0.0, 1.0, 0.0, 1.0); }
+*/
+const std::vector<uint32_t> greenFragmentShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x0000000c, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000004, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00030010, 0x00000001, 0x00000007, 0x00040047, 0x00000002, 0x0000001e, 0x00000000, 0x00020013, 0x00000003, 0x00030021, 0x00000004, 0x00000003, 0x00030016, 0x00000005, 0x00000020, 0x00040017, 0x00000006, 0x00000005, 0x00000004, 0x00040020, 0x00000007, 0x00000003, 0x00000006, 0x0004003b, 0x00000007, 0x00000002, 0x00000003, 0x0004002b, 0x00000005, 0x00000008, 0x00000000, 0x0004002b, 0x00000005, 0x00000009, 0x3f800000, 0x0007002c, 0x00000006, 0x0000000a, 0x00000008, 0x00000009, 0x00000008, 0x00000009, 0x00050036, 0x00000003, 0x00000001, 0x00000000, 0x00000004, 0x000200f8, 0x0000000b, 0x0003003e, 0x00000002, 0x0000000a, 0x000100fd, 0x00010038 };
+
+const std::vector<PrimitiveTopology> kTopologies = { PrimitiveTopology::kTriangleList,
+                                                      PrimitiveTopology::kTriangleStrip,
+                                                      PrimitiveTopology::kLineList,
+                                                      PrimitiveTopology::kLineStrip };
+const std::vector<CullMode> kCullModes = { CullMode::kNone, CullMode::kFront, CullMode::kBack };
+const std::vector<FrontFace> kFrontFaces = { FrontFace::kCounterClockwise, FrontFace::kClockwise };
+const std::vector<bool> kBlends = { false, true };
+
+class PipelineLibraryFixture : public benchmark::Fixture
+{
+public:
+    void SetUp(const benchmark::State& state) override
+    {
+        InstanceDescriptor instanceDescriptor{};
+        instanceDescriptor.type = InstanceType::kVulkan;
+        m_instance = Instance::create(instanceDescriptor);
+
+        m_physicalDevices = m_instance->getPhysicalDevices();
+
+        DeviceDescriptor deviceDescriptor{};
+        m_device = m_physicalDevices[0]->createDevice(deviceDescriptor);
+
+        m_pipelineLayout = m_device->createPipelineLayout(PipelineLayoutDescriptor{});
+    }
+
+    void TearDown(const benchmark::State& state) override
+    {
+        m_pipelineLayout.reset();
+        m_device.reset();
+        m_physicalDevices.clear();
+        m_instance.reset();
+    }
+
+protected:
+    std::unique_ptr<ShaderModule> createShaderModule(const std::vector<uint32_t>& spirv)
+    {
+        ShaderModuleDescriptor shaderModuleDescriptor{};
+        shaderModuleDescriptor.code = reinterpret_cast<const char*>(spirv.data());
+        shaderModuleDescriptor.codeSize = static_cast<uint32_t>(spirv.size() * sizeof(uint32_t));
+
+        return m_device->createShaderModule(shaderModuleDescriptor);
+    }
+
+    /// @brief create all permutations of topologies, cull modes, front faces and blends with the shader modules.
+    std::vector<std::unique_ptr<VulkanRenderPipeline>> createPermutations(ShaderModule& vertexShaderModule, ShaderModule& fragmentShaderModule, bool pipelineLibrary)
+    {
+        auto& vulkanDevice = downcast(*m_device);
+
+        std::vector<std::unique_ptr<VulkanRenderPipeline>> pipelines{};
+        for (const auto topology : kTopologies)
+        {
+            for (const auto cullMode : kCullModes)
+            {
+                for (const auto frontFace : kFrontFaces)
+                {
+                    for (const auto blend : kBlends)
+                    {
+                        FragmentStage::Target target{ .format = TextureFormat::kRGBA_8888_UInt_Norm };
+                        if (blend)
+                            target.blend = BlendState{};
+
+                        RenderPipelineDescriptor descriptor{
+                            { *m_pipelineLayout },
+                            InputAssemblyStage{ .topology = topology },
+                            VertexStage{ { vertexShaderModule, "main" }, {} },
+                            RasterizationStage{ .sampleCount = 1, .cullMode = cullMode, .frontFace = frontFace },
+                            FragmentStage{ { fragmentShaderModule, "main" }, { target } },
+                        };
+
+                        auto vulkanDescriptor = generateVulkanRenderPipelineDescriptor(vulkanDevice, descriptor);
+                        vulkanDescriptor.pipelineLibrary = pipelineLibrary;
+                        // measure the link on the creating thread only.
+                        vulkanDescriptor.optimizeLibraryLink = false;
+
+                        pipelines.push_back(std::make_unique<VulkanRenderPipeline>(vulkanDevice, vulkanDescriptor));
+                    }
+                }
+            }
+        }
+
+        return pipelines;
+    }
+
+protected:
+    std::unique_ptr<Instance> m_instance = nullptr;
+    std::vector<std::unique_ptr<PhysicalDevice>> m_physicalDevices{};
+    std::unique_ptr<Device> m_device = nullptr;
+    std::unique_ptr<PipelineLayout> m_pipelineLayout = nullptr;
+};
+
+} // namespace
+
+// measures creation time of all permutations of a shader pair. libraries are compiled once per state of each part and linked
+// for each permutation if the argument is 1, and each pipeline is compiled as a whole if 0. new shader modules are created
+// for each iteration, so libraries of previous iterations are removed and nothing is cached at the beginning.
+// devices which don't support fast linking of graphics pipeline libraries compile each pipeline in both cases.
+BENCHMARK_DEFINE_F(PipelineLibraryFixture, CreatePermutations)(benchmark::State& state)
+{
+    const bool pipelineLibrary = state.range(0) == 1;
+    const auto& physicalDeviceInfo = downcast(*m_device).getPhysicalDevice().getVulkanPhysicalDeviceInfo();
+    const bool linked = pipelineLibrary &&
+                        physicalDeviceInfo.graphicsPipelineLibrary &&
+                        physicalDeviceInfo.graphicsPipelineLibraryProperties.graphicsPipelineLibraryFastLinking;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto vertexShaderModule = createShaderModule(fullScreenVertexShaderSpv);
+        auto fragmentShaderModule = createShaderModule(greenFragmentShaderSpv);
+        state.ResumeTiming();
+
+        auto pipelines = createPermutations(*vertexShaderModule, *fragmentShaderModule, pipelineLibrary);
+        benchmark::DoNotOptimize(pipelines.data());
+
+        state.PauseTiming();
+        pipelines.clear();
+        vertexShaderModule.reset();
+        fragmentShaderModule.reset();
+        state.ResumeTiming();
+    }
+
+    const auto permutations = kTopologies.size() * kCullModes.size() * kFrontFaces.size() * kBlends.size();
+    state.SetItemsProcessed(state.iterations() * permutations);
+    state.SetLabel(linked ? "pipeline library" : "whole pipeline");
+}
+BENCHMARK_REGISTER_F(PipelineLibraryFixture, CreatePermutations)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,165 @@
+#include "jipu/command_buffer.h"
+#include "jipu/command_encoder.h"
+#include "jipu/device.h"
+#include "jipu/instance.h"
+#include "jipu/physical_device.h"
+#include "jipu/queue.h"
+#include "jipu/render_pass_encoder.h"
+#include "jipu/texture.h"
+#include "jipu/texture_view.h"
+
+#include "utils/hash.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+using namespace jipu;
+
+namespace
+{
+
+class RenderPassFixture : public benchmark::Fixture
+{
+public:
+    void SetUp(const benchmark::State& state) override
+    {
+        InstanceDescriptor instanceDescriptor{};
+        instanceDescriptor.type = InstanceType::kVulkan;
+        m_instance = Instance::create(instanceDescriptor);
+
+        m_physicalDevices = m_instance->getPhysicalDevices();
+
+        DeviceDescriptor deviceDescriptor{};
+        m_device = m_physicalDevices[0]->createDevice(deviceDescriptor);
+
+        QueueDescriptor queueDescriptor{};
+        queueDescriptor.flags = QueueFlagBits::kGraphics;
+        m_queue = m_device->createQueue(queueDescriptor);
+
+        const auto attachmentCount = static_cast<uint32_t>(state.range(0));
+        for (auto i = 0; i < attachmentCount; ++i)
+        {
+            TextureDescriptor textureDescriptor{};
+            textureDescriptor.type = TextureType::k2D;
+            textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+            textureDescriptor.mipLevels = 1;
+            textureDescriptor.sampleCount = 1;
+            textureDescriptor.width = 256;
+            textureDescriptor.height = 256;
+            textureDescriptor.depth = 1;
+            textureDescriptor.usage = TextureUsageFlagBits::kColorAttachment;
+
+            auto texture = m_device->createTexture(textureDescriptor);
+
+            TextureViewDescriptor textureViewDescriptor{};
+            textureViewDescriptor.type = TextureViewType::k2D;
+            textureViewDescriptor.aspect = TextureAspectFlagBits::kColor;
+
+            m_textureViews.push_back(texture->createTextureView(textureViewDescriptor));
+            m_textures.push_back(std::move(texture));
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override
+    {
+        m_textureViews.clear();
+        m_textures.clear();
+        m_queue.reset();
+        m_device.reset();
+        m_physicalDevices.clear();
+        m_instance.reset();
+    }
+
+protected:
+    std::unique_ptr<Instance> m_instance = nullptr;
+    std::vector<std::unique_ptr<PhysicalDevice>> m_physicalDevices{};
+    std::unique_ptr<Device> m_device = nullptr;
+    std::unique_ptr<Queue> m_queue = nullptr;
+    std::vector<std::unique_ptr<Texture>> m_textures{};
+    std::vector<std::unique_ptr<TextureView>> m_textureViews{};
+};
+
+} // namespace
+
+// measures render pass and framebuffer cache lookup cost per beginRenderPass. every iteration hits the caches.
+// devices which support dynamic rendering skip the caches, so the legacy path is forced by a subpass if the second argument is 1.
+// the label reports which path is measured.
+BENCHMARK_DEFINE_F(RenderPassFixture, BeginRenderPass)(benchmark::State& state)
+{
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+
+    RenderPassEncoderDescriptor renderPassDescriptor{};
+    SubpassDescriptor subpassDescriptor{ .depthStencil = false };
+    for (auto& textureView : m_textureViews)
+    {
+        subpassDescriptor.colorAttachments.push_back(static_cast<uint32_t>(renderPassDescriptor.colorAttachments.size()));
+        renderPassDescriptor.colorAttachments.push_back(ColorAttachment{
+            .renderView = *textureView,
+            .loadOp = LoadOp::kClear,
+            .storeOp = StoreOp::kStore,
+            .clearValue = { .r = 0.0, .g = 0.0, .b = 0.0, .a = 0.0 },
+        });
+    }
+    renderPassDescriptor.sampleCount = 1;
+
+    const bool legacy = state.range(1) == 1;
+    if (legacy)
+        renderPassDescriptor.subpasses.push_back(subpassDescriptor);
+
+    m_device->resetStatistics();
+
+    for (auto _ : state)
+    {
+        auto renderPassEncoder = commandEncoder->beginRenderPass(renderPassDescriptor);
+        renderPassEncoder->end();
+    }
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    uint64_t cacheLookups = 0;
+    for (const auto& cache : m_device->getStatistics().caches)
+    {
+        if (cache.name == "Render Pass" || cache.name == "Framebuffer")
+        {
+            cacheLookups += cache.hits + cache.misses;
+            state.counters[cache.name + " hits"] = static_cast<double>(cache.hits);
+        }
+    }
+
+    state.SetLabel(cacheLookups > 0 ? "render pass" : "dynamic rendering");
+}
+BENCHMARK_REGISTER_F(RenderPassFixture, BeginRenderPass)->ArgsProduct({ { 1, 4, 8 }, { 0, 1 } });
+
+// compares the field by field hash with the packed byte hash on a render pass sized key.
+static void BM_CombineHash(benchmark::State& state)
+{
+    std::vector<std::array<uint32_t, 9>> attachments(state.range(0));
+    for (auto _ : state)
+    {
+        size_t hash = 0;
+        for (const auto& attachment : attachments)
+        {
+            for (const auto field : attachment)
+                combineHash(hash, field);
+        }
+        benchmark::DoNotOptimize(hash);
+    }
+}
+BENCHMARK(BM_CombineHash)->Arg(1)->Arg(4)->Arg(8);
+
+static void BM_HashRange(benchmark::State& state)
+{
+    std::vector<std::array<uint32_t, 9>> attachments(state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hashRange(attachments));
+    }
+}
+BENCHMARK(BM_HashRange)->Arg(1)->Arg(4)->Arg(8);
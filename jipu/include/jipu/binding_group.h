@@ -40,6 +40,11 @@ struct BindingGroupDescriptor
     std::vector<BufferBinding> buffers{};
     std::vector<SamplerBinding> samplers{};
     std::vector<TextureBinding> textures{};
+    /// @brief texture views which are input attachments of the subpass. view of a texture which has kInputAttachment usage.
+    std::vector<TextureBinding> inputAttachments{};
+    /// @brief share the descriptor set with binding groups which have the same layout and resources.
+    /// it is for binding groups which are recreated every frame with the same resources.
+    bool cached = false;
 };
 
 class Device;
@@ -11,7 +11,9 @@ enum class BufferBindingType
 {
     kUndefined = 0,
     kUniform,
-    kStorage
+    kStorage,
+    /// @brief storage buffer which is not written by shaders. it doesn't need a barrier to be read by other commands.
+    kReadOnlyStorage
 };
 
 struct BindingStageFlagBits
@@ -44,11 +46,19 @@ struct TextureBindingLayout : BindingLayout
 {
 };
 
+/// @brief color attachment which is read at the same pixel in a subpass. fragment stage only.
+struct InputAttachmentBindingLayout : BindingLayout
+{
+};
+
 struct BindingGroupLayoutDescriptor
 {
     std::vector<BufferBindingLayout> buffers = {};
     std::vector<SamplerBindingLayout> samplers = {};
     std::vector<TextureBindingLayout> textures = {};
+    std::vector<InputAttachmentBindingLayout> inputAttachments = {};
+    /// @brief bindings are pushed by pass encoders instead of binding groups. no descriptor set is allocated.
+    bool pushDescriptor = false;
 };
 
 class Device;
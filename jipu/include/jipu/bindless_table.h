@@ -0,0 +1,49 @@
+#pragma once
+
+#include "export.h"
+#include <stdint.h>
+
+namespace jipu
+{
+
+/// @brief binding indices of the bindless binding group. shaders declare them as runtime sized arrays.
+struct BindlessBinding
+{
+    static constexpr uint32_t kTextures = 0; // texture2D textures[];
+    static constexpr uint32_t kSamplers = 1; // sampler samplers[];
+    static constexpr uint32_t kBuffers = 2;  // buffer { ... } buffers[];
+};
+
+class Buffer;
+class Sampler;
+class TextureView;
+class BindingGroup;
+class BindingGroupLayout;
+class JIPU_EXPORT BindlessTable
+{
+public:
+    virtual ~BindlessTable() = default;
+
+protected:
+    BindlessTable() = default;
+
+public:
+    /// @brief add a resource to the table. the index is stable until it is removed and is passed to shaders by push constants or instance data.
+    virtual uint32_t addTexture(const TextureView& textureView) = 0;
+    virtual uint32_t addSampler(const Sampler& sampler) = 0;
+    /// @param size whole size from the offset if 0.
+    virtual uint32_t addBuffer(const Buffer& buffer, uint64_t offset = 0, uint64_t size = 0) = 0;
+
+    /// @brief the index can be returned by an add after submissions of commands recorded until the removal are completed.
+    /// shaders must not access removed index.
+    /// throws if the index is not added or is already removed.
+    virtual void removeTexture(uint32_t index) = 0;
+    virtual void removeSampler(uint32_t index) = 0;
+    virtual void removeBuffer(uint32_t index) = 0;
+
+    /// @brief layout for pipeline layouts and binding group which is set once per pass. it is valid while resources are added.
+    virtual BindingGroupLayout& getBindingGroupLayout() = 0;
+    virtual BindingGroup& getBindingGroup() = 0;
+};
+
+} // namespace jipu
@@ -18,6 +18,7 @@ struct BufferUsageFlagBits
     static constexpr uint32_t kCopySrc = 1 << 7;      // 0x00000020
     static constexpr uint32_t kCopyDst = 1 << 8;      // 0x00000040
     static constexpr uint32_t kQueryResolve = 1 << 9; // 0x00000080
+    static constexpr uint32_t kIndirect = 1 << 10;    // 0x00000100
 };
 using BufferUsageFlags = uint32_t;
 
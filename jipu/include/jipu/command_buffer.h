@@ -12,6 +12,28 @@ struct CommandBufferDescriptor
 {
 };
 
+/// @brief statistics of the last recording of the command buffer.
+struct CommandBufferStatistics
+{
+    /// @brief state commands which are recorded by pass encoders.
+    uint64_t issuedCommands = 0;
+    /// @brief state commands which are skipped because the same state is requested or bound, or merged into another command.
+    /// commands of deferred encoders are also counted when they are dropped at finish.
+    uint64_t elidedCommands = 0;
+    /// @brief pipeline barrier commands which are recorded by encoders. barriers of deferred encoders are counted before they are merged.
+    uint64_t barrierCommands = 0;
+    /// @brief buffer barriers which make a write visible to later reads or writes.
+    uint64_t bufferMemoryBarriers = 0;
+    /// @brief buffer barriers which only wait for reads before a write.
+    uint64_t bufferExecutionBarriers = 0;
+    /// @brief barriers of deferred encoders which are merged into a previous pipeline barrier at finish.
+    uint64_t mergedBarriers = 0;
+    /// @brief descriptor set binds of deferred encoders which are merged into a previous bind at finish.
+    uint64_t mergedDescriptorBinds = 0;
+    /// @brief transfer commands of deferred encoders which are moved to be grouped with independent transfers at finish.
+    uint64_t reorderedCommands = 0;
+};
+
 class Device;
 class JIPU_EXPORT CommandBuffer
 {
@@ -20,6 +42,9 @@ public:
 
     virtual std::unique_ptr<CommandEncoder> createCommandEncoder(const CommandEncoderDescriptor& descriptor) = 0;
 
+    /// @brief it is reset when a command encoder is created.
+    virtual CommandBufferStatistics getStatistics() const = 0;
+
 public:
     using Ref = std::reference_wrapper<CommandBuffer>;
 };
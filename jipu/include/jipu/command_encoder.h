@@ -25,18 +25,51 @@ struct BlitTextureBuffer
 {
     Buffer& buffer;
     uint32_t offset = 0;
+    /// @brief bytes between rows in the buffer. rows are tightly packed if 0.
     uint32_t bytesPerRow = 0;
+    /// @brief rows between images of array layers or depth slices in the buffer. images are tightly packed if 0.
     uint32_t rowsPerTexture = 0;
 };
 
+struct Origin3D
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t z = 0;
+};
+
+/// @brief origin.z and the depth of the copy extent are depth slices of 3D textures, and array layers of others.
 struct BlitTexture
 {
     Texture& texture;
     TextureAspectFlags aspect = TextureAspectFlagBits::kUndefined;
+    uint32_t mipLevel = 0;
+    Origin3D origin{};
+};
+
+struct BufferCopyRegion
+{
+    uint64_t srcOffset = 0;
+    uint64_t dstOffset = 0;
+    uint64_t size = 0;
+};
+
+/// @brief a region of a texture and its layout in a buffer. same as BlitTextureBuffer and BlitTexture.
+struct BufferTextureCopyRegion
+{
+    uint64_t bufferOffset = 0;
+    uint32_t bytesPerRow = 0;
+    uint32_t rowsPerTexture = 0;
+    uint32_t mipLevel = 0;
+    Origin3D origin{};
+    Extent3D extent{};
 };
 
 struct CommandEncoderDescriptor
 {
+    /// @brief record commands to a stream and translate them to the command buffer at finish.
+    /// redundant states are elided, and barriers and copies are batched in translation.
+    bool deferred = false;
 };
 
 class JIPU_EXPORT CommandEncoder
@@ -59,6 +92,26 @@ public:
     virtual void copyTextureToTexture(const BlitTexture& src,
                                       const BlitTexture& dst,
                                       const Extent3D& extent) = 0;
+
+    /// @brief copy regions between a pair of buffers with a single copy command.
+    virtual void copyBufferToBuffer(Buffer& src,
+                                    Buffer& dst,
+                                    const std::vector<BufferCopyRegion>& regions) = 0;
+    /// @brief copy regions from a buffer to a texture with a single copy command. regions must not overlap in the texture.
+    virtual void copyBufferToTexture(Buffer& buffer,
+                                     Texture& texture,
+                                     TextureAspectFlags aspect,
+                                     const std::vector<BufferTextureCopyRegion>& regions) = 0;
+
+    /// @brief fill the range of the buffer with the 32 bit value. offset and size must be multiples of 4.
+    virtual void fillBuffer(Buffer& buffer, uint64_t offset, uint64_t size, uint32_t value) = 0;
+    /// @brief fill the range of the buffer with zero. offset and size must be multiples of 4.
+    virtual void clearBuffer(Buffer& buffer, uint64_t offset, uint64_t size) = 0;
+
+    /// @brief generate all mip levels of the texture from the base level.
+    /// textures with storage binding usage are downsampled by a single compute dispatch, others by blits.
+    virtual void generateMipmaps(Texture& texture) = 0;
+
     virtual void resolveQuerySet(QuerySet* querySet,
                                  uint32_t firstQuery,
                                  uint32_t queryCount,
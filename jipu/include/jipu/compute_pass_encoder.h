@@ -1,6 +1,9 @@
 #pragma once
 
+#include "binding_group_layout.h"
+
 #include <cstdint>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -11,16 +14,34 @@ struct ComputePassEncoderDescriptor
 {
 };
 
+/// @brief layout of a dispatch in the indirect buffer.
+struct DispatchIndirectArgs
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t z = 0;
+};
+
+class Buffer;
 class ComputePipeline;
 class BindingGroup;
+struct BindingGroupDescriptor;
 class ComputePassEncoder
 {
 public:
     virtual ~ComputePassEncoder() = default;
 
     virtual void setPipeline(ComputePipeline& pipeline) = 0;
-    virtual void setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::vector<uint32_t> dynamicOffset = {}) = 0;
+    /// @brief binding groups are bound at next draw or dispatch. they can be set before the pipeline and are kept across pipelines.
+    /// dynamic offsets are copied, so they can be released after the call.
+    virtual void setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::span<const uint32_t> dynamicOffset = {}) = 0;
+    /// @brief update push constants in the range of the pipeline layout. size and offset are in bytes.
+    virtual void setPushConstants(BindingStageFlags stages, uint32_t offset, const void* data, uint32_t size) = 0;
+    /// @brief write bindings into the command buffer for the push descriptor layout at the index of the pipeline layout.
+    virtual void pushBindings(uint32_t index, const BindingGroupDescriptor& descriptor) = 0;
     virtual void dispatch(uint32_t x, uint32_t y = 1, uint32_t z = 1) = 0;
+    /// @brief dispatch with workgroup counts read from the buffer which has kIndirect usage. offset is multiple of 4.
+    virtual void dispatchIndirect(Buffer& indirectBuffer, uint64_t indirectOffset) = 0;
     virtual void end() = 0;
 };
 
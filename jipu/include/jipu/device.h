@@ -1,6 +1,7 @@
 #pragma once
 
 #include "export.h"
+#include "jipu/bindless_table.h"
 #include "jipu/binding_group.h"
 #include "jipu/binding_group_layout.h"
 #include "jipu/buffer.h"
@@ -13,8 +14,11 @@
 #include "jipu/shader_module.h"
 #include "jipu/swapchain.h"
 #include "jipu/texture.h"
+#include "jipu/upload_manager.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 #include <webgpu.h>
 
 namespace jipu
@@ -23,6 +27,21 @@ namespace jipu
 using DeviceDescriptor = WGPUDeviceDescriptor;
 using AdapterRequestDeviceCallback = WGPUAdapterRequestDeviceCallback;
 
+struct CacheStatistics
+{
+    std::string name = "";
+    uint64_t entries = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    double creationTime = 0.0; // total time spent creating objects on misses, in milliseconds.
+};
+
+struct DeviceStatistics
+{
+    std::vector<CacheStatistics> caches{};
+};
+
 class JIPU_EXPORT Device
 {
 public:
@@ -48,6 +67,24 @@ public:
     virtual std::unique_ptr<ShaderModule> createShaderModule(const ShaderModuleDescriptor& descriptor) = 0;
     virtual std::unique_ptr<Swapchain> createSwapchain(const SwapchainDescriptor& descriptor) = 0;
     virtual std::unique_ptr<Texture> createTexture(const TextureDescriptor& descriptor) = 0;
+
+public:
+    /// @brief resource table owned by the device for descriptor indexing. nullptr if it is not supported.
+    virtual BindlessTable* getBindlessTable() = 0;
+    /// @brief uploads through a staging ring which are submitted together, to a transfer queue if there is.
+    virtual UploadManager& getUploadManager() = 0;
+
+public:
+    /// @brief serial of the next submission to queues. resources used by commands recorded now are in use until it is completed.
+    virtual uint64_t getPendingSerial() = 0;
+    /// @brief all submissions up to the serial are completed.
+    virtual uint64_t getCompletedSerial() = 0;
+
+public:
+    /// @brief statistics of the internal object caches. entries are the current population.
+    virtual DeviceStatistics getStatistics() const = 0;
+    /// @brief reset hits, misses, evictions and creation time. entries are not changed.
+    virtual void resetStatistics() = 0;
 };
 
 } // namespace jipu
@@ -2,6 +2,7 @@
 
 #include "export.h"
 #include "pipeline_layout.h"
+#include "render_pass_encoder.h"
 #include "shader_module.h"
 #include "texture.h"
 
@@ -188,6 +189,19 @@ struct DepthStencilStage
     TextureFormat format;
 };
 
+// Subpass
+struct RenderPipelineSubpass
+{
+    /// @brief formats of all color attachments of the render pass in order.
+    std::vector<TextureFormat> colorFormats{};
+    /// @brief format of the depth stencil attachment of the render pass. kUndefined if there is no depth stencil attachment.
+    TextureFormat depthStencilFormat = TextureFormat::kUndefined;
+    /// @brief same as the subpasses of the render pass.
+    std::vector<SubpassDescriptor> subpasses{};
+    /// @brief subpass which the pipeline is used in. fragment targets are the color attachments of the subpass.
+    uint32_t index = 0;
+};
+
 struct PipelineDescriptor
 {
     /// @brief pipeline layout
@@ -201,6 +215,8 @@ struct RenderPipelineDescriptor : PipelineDescriptor
     RasterizationStage rasterization{};
     FragmentStage fragment;
     std::optional<DepthStencilStage> depthStencil = std::nullopt;
+    /// @brief render pass which has subpasses. the pipeline is used in a subpass of it.
+    std::optional<RenderPipelineSubpass> subpass = std::nullopt;
 };
 
 class Device;
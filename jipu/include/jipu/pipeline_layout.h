@@ -13,11 +13,20 @@ namespace jipu
 using BindingGroupLayoutRef = std::reference_wrapper<BindingGroupLayout>;
 using BindingGroupLayouts = std::vector<BindingGroupLayoutRef>;
 
+struct PushConstantRange
+{
+    BindingStageFlags stages = 0u;
+    /// @brief offset and size in bytes. they must be a multiple of 4.
+    uint32_t offset = 0;
+    uint32_t size = 0;
+};
+
 class Device;
 class BindingGroupLayout;
 struct PipelineLayoutDescriptor
 {
     BindingGroupLayouts layouts = {};
+    std::vector<PushConstantRange> pushConstantRanges = {};
 };
 
 class JIPU_EXPORT PipelineLayout
@@ -3,9 +3,11 @@
 #include "export.h"
 
 #include "jipu/command_buffer.h"
+#include "jipu/command_encoder.h"
 #include "jipu/swapchain.h"
 
 #include <functional>
+#include <span>
 #include <stdint.h>
 #include <vector>
 
@@ -26,6 +28,16 @@ struct QueueDescriptor
     QueueFlags flags;
 };
 
+/// @brief layout of texture data in memory. same as BlitTextureBuffer.
+struct TextureDataLayout
+{
+    uint64_t offset = 0;
+    /// @brief bytes between rows. rows are tightly packed if 0.
+    uint32_t bytesPerRow = 0;
+    /// @brief rows between images of array layers or depth slices. images are tightly packed if 0.
+    uint32_t rowsPerTexture = 0;
+};
+
 class JIPU_EXPORT Queue
 {
 public:
@@ -37,6 +49,20 @@ protected:
 public:
     virtual void submit(std::vector<CommandBuffer::Ref> commandBuffers) = 0;
     virtual void submit(std::vector<CommandBuffer::Ref> commandBuffers, Swapchain& swapchain) = 0;
+    /// @brief same as above without copying the list of command buffers.
+    virtual void submit(std::span<const CommandBuffer::Ref> commandBuffers) = 0;
+    virtual void submit(std::span<const CommandBuffer::Ref> commandBuffers, Swapchain& swapchain) = 0;
+
+public:
+    /// @brief data is copied to staging memory of the upload manager, so it can be released after the call.
+    /// the copy to the buffer is executed before command buffers of the next submit.
+    virtual void writeBuffer(Buffer& buffer, uint64_t offset, const void* data, uint64_t size) = 0;
+    /// @brief same as writeBuffer. the texture is restored to its final layout after the copy.
+    virtual void writeTexture(const BlitTexture& texture,
+                              const void* data,
+                              uint64_t size,
+                              const TextureDataLayout& layout,
+                              const Extent3D& extent) = 0;
 };
 
 } // namespace jipu
\ No newline at end of file
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "export.h"
+#include "jipu/buffer.h"
+#include "jipu/command_encoder.h"
+#include "jipu/compute_pass_encoder.h"
+#include "jipu/pipeline.h"
+#include "jipu/render_pass_encoder.h"
+#include "jipu/texture.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace jipu
+{
+
+/// @brief handle of a texture in a render graph. it is valid until the graph is reset.
+struct RenderGraphTexture
+{
+    uint32_t index = UINT32_MAX;
+};
+
+/// @brief handle of a buffer in a render graph. it is valid until the graph is reset.
+struct RenderGraphBuffer
+{
+    uint32_t index = UINT32_MAX;
+};
+
+enum class RenderGraphPassType
+{
+    kRender = 0,
+    kCompute,
+    kTransfer,
+};
+
+struct RenderGraphColorAttachment
+{
+    RenderGraphTexture texture{};
+    std::optional<RenderGraphTexture> resolveTexture = std::nullopt;
+    LoadOp loadOp = LoadOp::kClear;
+    StoreOp storeOp = StoreOp::kStore;
+    Color clearValue{};
+};
+
+struct RenderGraphDepthStencilAttachment
+{
+    RenderGraphTexture texture{};
+    LoadOp depthLoadOp = LoadOp::kClear;
+    StoreOp depthStoreOp = StoreOp::kStore;
+    LoadOp stencilLoadOp = LoadOp::kDontCare;
+    StoreOp stencilStoreOp = StoreOp::kDontCare;
+    DepthStencilClearValue clearValue{};
+};
+
+struct RenderGraphDescriptor
+{
+    /// @brief physical resources which are not used for the frames are released, after submissions which used them are completed.
+    uint32_t releaseFrames = 3;
+};
+
+struct RenderGraphStatistics
+{
+    /// @brief passes which are added.
+    uint32_t passes = 0;
+    /// @brief passes which don't contribute to imported resources or side effects.
+    uint32_t culledPasses = 0;
+    /// @brief dependencies between passes which are executed.
+    uint32_t dependencies = 0;
+    /// @brief stores of transient attachments which are discarded because nothing reads them later.
+    uint32_t discardedStores = 0;
+    /// @brief render passes which are merged into the previous render pass as subpasses.
+    uint32_t mergedPasses = 0;
+
+    uint32_t transientTextures = 0;
+    uint32_t transientBuffers = 0;
+    /// @brief textures and buffers allocated for transient resources after aliasing.
+    uint32_t physicalTextures = 0;
+    uint32_t physicalBuffers = 0;
+    /// @brief physical resources created in this frame, because there was no reusable one in the pool.
+    uint32_t createdTextures = 0;
+    uint32_t createdBuffers = 0;
+
+    /// @brief estimated bytes of physical transient resources.
+    uint64_t transientMemory = 0;
+    /// @brief estimated bytes saved by aliasing transient resources of which lifetimes don't overlap.
+    /// textures of the same format and extent, and buffers of any size are aliased. the usage of the physical resource is the union of them.
+    uint64_t aliasedMemory = 0;
+};
+
+class Device;
+class RenderGraph;
+
+/// @brief resources and encoders for the pass which is executed.
+class JIPU_EXPORT RenderGraphPassContext final
+{
+public:
+    RenderGraphPassContext() = delete;
+    RenderGraphPassContext(RenderGraph& graph, CommandEncoder& commandEncoder);
+
+public:
+    CommandEncoder& getCommandEncoder() const;
+    /// @brief valid in render passes only.
+    RenderPassEncoder& getRenderPassEncoder() const;
+    /// @brief valid in compute passes only.
+    ComputePassEncoder& getComputePassEncoder() const;
+    /// @brief subpass of the render pass which render pipelines of the pass must be created for.
+    /// nullopt if the pass is not merged with other passes.
+    const std::optional<RenderPipelineSubpass>& getSubpass() const;
+
+    Texture& getTexture(RenderGraphTexture texture) const;
+    TextureView& getTextureView(RenderGraphTexture texture) const;
+    Buffer& getBuffer(RenderGraphBuffer buffer) const;
+
+private:
+    friend class RenderGraph;
+
+    RenderGraph& m_graph;
+    CommandEncoder& m_commandEncoder;
+    RenderPassEncoder* m_renderPassEncoder = nullptr;
+    ComputePassEncoder* m_computePassEncoder = nullptr;
+    std::optional<RenderPipelineSubpass> m_subpass = std::nullopt;
+};
+
+using RenderGraphExecuteCallback = std::function<void(RenderGraphPassContext& context)>;
+
+/// @brief declares resources which are accessed by a pass.
+/// reads and writes must be declared for the graph to order, cull and alias passes and resources.
+class JIPU_EXPORT RenderGraphPassBuilder final
+{
+public:
+    RenderGraphPassBuilder() = delete;
+    RenderGraphPassBuilder(RenderGraph& graph, uint32_t passIndex);
+
+public:
+    /// @brief render passes only. the attachment is written, and it is read too if the load op is kLoad.
+    RenderGraphPassBuilder& addColorAttachment(const RenderGraphColorAttachment& attachment);
+    RenderGraphPassBuilder& setDepthStencilAttachment(const RenderGraphDepthStencilAttachment& attachment);
+    /// @brief render passes only. the color attachment of the previous render pass is read at the same pixel.
+    /// the pass is merged into the previous render pass as a subpass, so the attachment can stay in tile memory.
+    /// the order is the input attachment index of shaders.
+    RenderGraphPassBuilder& readInputAttachment(RenderGraphTexture texture);
+
+    /// @param usage kTextureBinding, kStorageBinding or kCopySrc.
+    RenderGraphPassBuilder& read(RenderGraphTexture texture, TextureUsageFlags usage);
+    /// @param usage kStorageBinding or kCopyDst.
+    RenderGraphPassBuilder& write(RenderGraphTexture texture, TextureUsageFlags usage);
+    /// @param usage usages of the buffer by the pass. e.g. kUniform, kVertex or kIndirect.
+    RenderGraphPassBuilder& read(RenderGraphBuffer buffer, BufferUsageFlags usage);
+    /// @param usage kStorage or kCopyDst.
+    RenderGraphPassBuilder& write(RenderGraphBuffer buffer, BufferUsageFlags usage);
+
+    /// @brief the pass is never culled. e.g. it writes to host visible memory or queries.
+    RenderGraphPassBuilder& setSideEffect();
+
+private:
+    RenderGraph& m_graph;
+    const uint32_t m_passIndex;
+};
+
+/// @brief passes and transient resources of a frame, built on the public API.
+/// passes which don't contribute to imported resources are culled, passes are ordered to keep dependent passes apart,
+/// render passes which read input attachments are merged into the render pass which writes them as subpasses,
+/// and transient resources of which lifetimes don't overlap share physical resources kept across frames.
+/// barriers between passes are recorded by the backend from the declared usages.
+class JIPU_EXPORT RenderGraph final
+{
+public:
+    RenderGraph() = delete;
+    RenderGraph(Device& device, const RenderGraphDescriptor& descriptor);
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+public:
+    /// @brief usage of the descriptor is combined with usages declared by passes.
+    RenderGraphTexture createTexture(const std::string& name, const TextureDescriptor& descriptor);
+    RenderGraphBuffer createBuffer(const std::string& name, const BufferDescriptor& descriptor);
+    /// @brief passes which write imported resources are not culled.
+    RenderGraphTexture importTexture(const std::string& name, TextureView& textureView);
+    RenderGraphBuffer importBuffer(const std::string& name, Buffer& buffer);
+
+    RenderGraphPassBuilder addPass(const std::string& name, RenderGraphPassType type, RenderGraphExecuteCallback callback);
+
+    /// @brief cull, order and merge passes, and alias transient resources. passes can't be added after compile until reset.
+    void compile();
+    /// @brief allocate transient resources and execute passes in the compiled order.
+    /// the encoder must be submitted by the next submission of the device.
+    void execute(CommandEncoder& commandEncoder);
+    /// @brief remove passes and resources to build next frame. physical resources are kept for reuse.
+    void reset();
+
+public:
+    /// @brief names of passes in the executed order. culled passes are not included.
+    std::vector<std::string> getPassOrder() const;
+    const RenderGraphStatistics& getStatistics() const;
+
+private:
+    friend class RenderGraphPassBuilder;
+    friend class RenderGraphPassContext;
+
+    struct TextureResource
+    {
+        std::string name{};
+        TextureDescriptor descriptor{};
+        TextureView* importedView = nullptr;
+        // index of the physical texture after compile.
+        uint32_t physicalIndex = UINT32_MAX;
+        // position of the last pass which reads it in the executed order.
+        uint32_t lastRead = UINT32_MAX;
+        // written by an executed pass in the frame.
+        bool written = false;
+    };
+
+    struct BufferResource
+    {
+        std::string name{};
+        BufferDescriptor descriptor{};
+        Buffer* importedBuffer = nullptr;
+        uint32_t physicalIndex = UINT32_MAX;
+    };
+
+    struct Access
+    {
+        uint32_t resource = UINT32_MAX;
+        bool texture = true;
+        bool write = false;
+    };
+
+    struct Pass
+    {
+        std::string name{};
+        RenderGraphPassType type = RenderGraphPassType::kRender;
+        RenderGraphExecuteCallback callback{};
+
+        std::vector<RenderGraphColorAttachment> colorAttachments{};
+        std::optional<RenderGraphDepthStencilAttachment> depthStencilAttachment = std::nullopt;
+        std::vector<RenderGraphTexture> inputAttachments{};
+        std::vector<Access> accesses{};
+        bool sideEffect = false;
+
+        bool culled = false;
+        std::vector<uint32_t> dependencies{};
+        // index of the merged render pass and the subpass in it after compile.
+        uint32_t renderPass = UINT32_MAX;
+        uint32_t subpass = 0;
+    };
+
+    // render passes which are executed as subpasses of a render pass. a pass which is not merged has its own.
+    struct MergedRenderPass
+    {
+        // positions of the first and the last subpass in the executed order.
+        uint32_t first = 0;
+        uint32_t last = 0;
+        std::vector<RenderGraphColorAttachment> colorAttachments{};
+        std::optional<RenderGraphDepthStencilAttachment> depthStencilAttachment = std::nullopt;
+        std::vector<SubpassDescriptor> subpasses{};
+        std::vector<Access> accesses{};
+    };
+
+    struct PhysicalTexture
+    {
+        TextureDescriptor descriptor{};
+        std::unique_ptr<Texture> texture = nullptr;
+        std::unique_ptr<TextureView> textureView = nullptr;
+        uint64_t lastUsedFrame = 0;
+        // serial of the last submission which uses it. it is not released until the submission is completed.
+        uint64_t lastUsedSerial = 0;
+    };
+
+    struct PhysicalBuffer
+    {
+        BufferDescriptor descriptor{};
+        std::unique_ptr<Buffer> buffer = nullptr;
+        uint64_t lastUsedFrame = 0;
+        // buffers may be written by the host, so they are not reused until the submission is completed either.
+        uint64_t lastUsedSerial = 0;
+    };
+
+    void cull();
+    void resolveDependencies();
+    void schedule();
+    void merge();
+    void alias();
+
+    bool canMerge(const MergedRenderPass& renderPass, const Pass& pass) const;
+    void addSubpass(MergedRenderPass& renderPass, Pass& pass, uint32_t position);
+
+    void acquirePhysicalResources();
+    void releasePhysicalResources();
+    void executePass(Pass& pass, uint32_t position, CommandEncoder& commandEncoder, std::unique_ptr<RenderPassEncoder>& renderPassEncoder);
+    RenderPassEncoderDescriptor generateRenderPassEncoderDescriptor(const MergedRenderPass& renderPass);
+
+    TextureView& getTextureView(RenderGraphTexture texture);
+    Buffer& getBuffer(RenderGraphBuffer buffer);
+
+private:
+    Device& m_device;
+    const RenderGraphDescriptor m_descriptor;
+
+    std::vector<TextureResource> m_textures{};
+    std::vector<BufferResource> m_buffers{};
+    std::vector<Pass> m_passes{};
+    bool m_compiled = false;
+
+    // indices of passes in the executed order.
+    std::vector<uint32_t> m_order{};
+    std::vector<MergedRenderPass> m_renderPasses{};
+    // descriptors of physical resources after aliasing, and the pool indices acquired for them.
+    std::vector<TextureDescriptor> m_textureSlots{};
+    std::vector<BufferDescriptor> m_bufferSlots{};
+    std::vector<uint32_t> m_acquiredTextures{};
+    std::vector<uint32_t> m_acquiredBuffers{};
+
+    std::vector<PhysicalTexture> m_texturePool{};
+    std::vector<PhysicalBuffer> m_bufferPool{};
+    uint64_t m_frame = 0;
+    // serial of the submission of the executed frame.
+    uint64_t m_serial = 0;
+
+    RenderGraphStatistics m_statistics{};
+};
+
+} // namespace jipu
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "binding_group_layout.h"
 #include "query_set.h"
 #include "texture_view.h"
 
 #include "export.h"
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace jipu
@@ -14,6 +16,7 @@ class Pipeline;
 class Buffer;
 class CommandBuffer;
 class BindingGroup;
+struct BindingGroupDescriptor;
 
 enum class LoadOp : uint8_t
 {
@@ -68,6 +71,18 @@ struct RenderPassTimestampWrites
     uint32_t endQueryIndex = 0;
 };
 
+/// @brief attachments which are used by a subpass. indices refer to color attachments of the render pass.
+struct SubpassDescriptor
+{
+    /// @brief color attachments which are written by the subpass.
+    std::vector<uint32_t> colorAttachments{};
+    /// @brief color attachments which are read by the subpass at the same pixel. they are kept in tile memory on tile based GPUs.
+    /// the order is the input attachment index of shaders.
+    std::vector<uint32_t> inputAttachments{};
+    /// @brief the subpass uses the depth stencil attachment of the render pass.
+    bool depthStencil = true;
+};
+
 struct RenderPassEncoderDescriptor
 {
     std::vector<ColorAttachment> colorAttachments{};
@@ -75,6 +90,9 @@ struct RenderPassEncoderDescriptor
     QuerySet* occlusionQuerySet = nullptr;
     RenderPassTimestampWrites timestampWrites{};
     uint32_t sampleCount = 0;
+    /// @brief subpasses in order. a subpass which uses all attachments if empty.
+    /// dependencies between subpasses are generated from the attachments they use.
+    std::vector<SubpassDescriptor> subpasses{};
 };
 
 enum IndexFormat
@@ -83,6 +101,25 @@ enum IndexFormat
     kUint32,
 };
 
+/// @brief layout of a draw in the indirect buffer.
+struct DrawIndirectArgs
+{
+    uint32_t vertexCount = 0;
+    uint32_t instanceCount = 0;
+    uint32_t firstVertex = 0;
+    uint32_t firstInstance = 0;
+};
+
+/// @brief layout of an indexed draw in the indirect buffer.
+struct DrawIndexedIndirectArgs
+{
+    uint32_t indexCount = 0;
+    uint32_t instanceCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+    uint32_t firstInstance = 0;
+};
+
 class RenderPipeline;
 class JIPU_EXPORT RenderPassEncoder
 {
@@ -94,7 +131,13 @@ protected:
 
 public:
     virtual void setPipeline(RenderPipeline& pipeline) = 0;
-    virtual void setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::vector<uint32_t> dynamicOffset = {}) = 0;
+    /// @brief binding groups are bound at next draw or dispatch. they can be set before the pipeline and are kept across pipelines.
+    /// dynamic offsets are copied, so they can be released after the call.
+    virtual void setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::span<const uint32_t> dynamicOffset = {}) = 0;
+    /// @brief update push constants in the range of the pipeline layout. size and offset are in bytes.
+    virtual void setPushConstants(BindingStageFlags stages, uint32_t offset, const void* data, uint32_t size) = 0;
+    /// @brief write bindings into the command buffer for the push descriptor layout at the index of the pipeline layout.
+    virtual void pushBindings(uint32_t index, const BindingGroupDescriptor& descriptor) = 0;
 
     virtual void setVertexBuffer(uint32_t slot, Buffer& buffer) = 0;
     virtual void setIndexBuffer(Buffer& buffer, IndexFormat format) = 0;
@@ -119,9 +162,27 @@ public:
                              uint32_t vertexOffset,
                              uint32_t firstInstance) = 0;
 
+    /// @brief draw with arguments read from the buffer which has kIndirect usage. offset is multiple of 4.
+    virtual void drawIndirect(Buffer& indirectBuffer, uint64_t indirectOffset) = 0;
+    virtual void drawIndexedIndirect(Buffer& indirectBuffer, uint64_t indirectOffset) = 0;
+    /// @brief draw tightly packed arguments. if count buffer is set, draw count is min(uint32_t at countBufferOffset, maxDrawCount).
+    virtual void multiDrawIndirect(Buffer& indirectBuffer,
+                                   uint64_t indirectOffset,
+                                   uint32_t maxDrawCount,
+                                   Buffer* countBuffer = nullptr,
+                                   uint64_t countBufferOffset = 0) = 0;
+    virtual void multiDrawIndexedIndirect(Buffer& indirectBuffer,
+                                          uint64_t indirectOffset,
+                                          uint32_t maxDrawCount,
+                                          Buffer* countBuffer = nullptr,
+                                          uint64_t countBufferOffset = 0) = 0;
+
     virtual void beginOcclusionQuery(uint32_t queryIndex) = 0;
     virtual void endOcclusionQuery() = 0;
 
+    /// @brief start the next subpass. pipelines must be created for the subpass. bindings are kept.
+    virtual void nextPass() = 0;
+    /// @brief all subpasses must be started before end.
     virtual void end() = 0;
 };
 
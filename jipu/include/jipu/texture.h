@@ -50,6 +50,7 @@ struct TextureUsageFlagBits
     static constexpr uint32_t kStorageBinding = 0x00000008;
     static constexpr uint32_t kDepthStencil = 0x00000010;
     static constexpr uint32_t kColorAttachment = 0x00000020;
+    static constexpr uint32_t kInputAttachment = 0x00000040;
 };
 using TextureUsageFlags = uint32_t;
 
@@ -60,6 +61,7 @@ struct TextureDescriptor
     TextureUsageFlags usage = TextureUsageFlagBits::kUndefined;
     uint32_t width = 0;
     uint32_t height = 0;
+    /// @brief depth of 3D textures, or array layers of 1D and 2D textures.
     uint32_t depth = 0;
     uint32_t mipLevels = 0;
     uint32_t sampleCount = 0;
@@ -32,6 +32,9 @@ struct TextureViewDescriptor
 {
     TextureViewType type = TextureViewType::kUndefined;
     TextureAspectFlags aspect = TextureAspectFlagBits::kUndefined;
+    uint32_t baseMipLevel = 0;
+    /// @brief mip levels from the base mip level. all remaining mip levels if 0.
+    uint32_t mipLevelCount = 0;
 };
 
 class Texture;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "export.h"
+#include "jipu/queue.h"
+
+#include <stdint.h>
+
+namespace jipu
+{
+
+class Buffer;
+class JIPU_EXPORT UploadManager
+{
+public:
+    virtual ~UploadManager() = default;
+
+protected:
+    UploadManager() = default;
+
+public:
+    /// @brief copy the data to staging memory and record a copy to the buffer. the buffer must have copy dst usage.
+    /// resources must be alive until the upload is completed.
+    /// @return serial of the submission which contains the upload.
+    virtual uint64_t uploadBuffer(Buffer& buffer, uint64_t offset, const void* data, uint64_t size) = 0;
+    virtual uint64_t uploadTexture(const BlitTexture& texture,
+                                   const void* data,
+                                   uint64_t size,
+                                   const TextureDataLayout& layout,
+                                   const Extent3D& extent) = 0;
+
+    /// @brief submit pending uploads in a single submission. queues flush it before their submissions.
+    /// @return serial of the submission. uploads are visible to command buffers which are submitted after it.
+    virtual uint64_t flush() = 0;
+
+    virtual uint64_t getCompletedSerial() = 0;
+    virtual bool isCompleted(uint64_t serial) = 0;
+    /// @brief flush if the serial is pending, and wait for the submission.
+    virtual void wait(uint64_t serial) = 0;
+};
+
+} // namespace jipu
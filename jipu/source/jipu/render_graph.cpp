@@ -0,0 +1,1048 @@
+#include "jipu/render_graph.h"
+
+#include "jipu/device.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+namespace jipu
+{
+
+namespace
+{
+
+// a texture can be used for the other one if they have same memory layout. usages are combined.
+bool isCompatibleTexture(const TextureDescriptor& lhs, const TextureDescriptor& rhs)
+{
+    return lhs.type == rhs.type &&
+           lhs.format == rhs.format &&
+           lhs.width == rhs.width &&
+           lhs.height == rhs.height &&
+           lhs.depth == rhs.depth &&
+           lhs.mipLevels == rhs.mipLevels &&
+           lhs.sampleCount == rhs.sampleCount;
+}
+
+// the physical resource has every usage and enough memory for the descriptor.
+bool canUseTexture(const TextureDescriptor& physical, const TextureDescriptor& descriptor)
+{
+    return isCompatibleTexture(physical, descriptor) && (physical.usage & descriptor.usage) == descriptor.usage;
+}
+
+bool canUseBuffer(const BufferDescriptor& physical, const BufferDescriptor& descriptor)
+{
+    return physical.size >= descriptor.size && (physical.usage & descriptor.usage) == descriptor.usage;
+}
+
+uint32_t getBytesPerPixel(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::kRGB_888_UInt_Norm:
+    case TextureFormat::kRGB_888_UInt_Norm_SRGB:
+        return 3;
+    case TextureFormat::kRGBA_16161616_UInt_Norm:
+        return 8;
+    case TextureFormat::kUndefined:
+        return 0;
+    default:
+        return 4;
+    }
+}
+
+uint64_t getTextureMemory(const TextureDescriptor& descriptor)
+{
+    uint64_t width = std::max(descriptor.width, 1u);
+    uint64_t height = std::max(descriptor.height, 1u);
+    uint64_t depth = std::max(descriptor.depth, 1u);
+
+    uint64_t memory = 0;
+    for (uint32_t level = 0; level < std::max(descriptor.mipLevels, 1u); ++level)
+    {
+        memory += width * height * depth;
+
+        width = std::max<uint64_t>(width >> 1, 1);
+        height = std::max<uint64_t>(height >> 1, 1);
+        depth = std::max<uint64_t>(depth >> 1, 1);
+    }
+
+    return memory * getBytesPerPixel(descriptor.format) * std::max(descriptor.sampleCount, 1u);
+}
+
+TextureViewDescriptor generateTextureViewDescriptor(const TextureDescriptor& descriptor)
+{
+    TextureViewDescriptor viewDescriptor{};
+    switch (descriptor.type)
+    {
+    case TextureType::k1D:
+        viewDescriptor.type = TextureViewType::k1D;
+        break;
+    case TextureType::k3D:
+        viewDescriptor.type = TextureViewType::k3D;
+        break;
+    default:
+        viewDescriptor.type = TextureViewType::k2D;
+        break;
+    }
+
+    switch (descriptor.format)
+    {
+    case TextureFormat::kD_32_SFloat:
+    case TextureFormat::kD_24_UInt_Norm_S_8_UInt:
+        viewDescriptor.aspect = TextureAspectFlagBits::kDepth;
+        break;
+    default:
+        viewDescriptor.aspect = TextureAspectFlagBits::kColor;
+        break;
+    }
+
+    return viewDescriptor;
+}
+
+} // namespace
+
+RenderGraphPassContext::RenderGraphPassContext(RenderGraph& graph, CommandEncoder& commandEncoder)
+    : m_graph(graph)
+    , m_commandEncoder(commandEncoder)
+{
+}
+
+CommandEncoder& RenderGraphPassContext::getCommandEncoder() const
+{
+    return m_commandEncoder;
+}
+
+RenderPassEncoder& RenderGraphPassContext::getRenderPassEncoder() const
+{
+    if (m_renderPassEncoder == nullptr)
+        throw std::runtime_error("Render pass encoder is valid in render passes of the render graph.");
+
+    return *m_renderPassEncoder;
+}
+
+ComputePassEncoder& RenderGraphPassContext::getComputePassEncoder() const
+{
+    if (m_computePassEncoder == nullptr)
+        throw std::runtime_error("Compute pass encoder is valid in compute passes of the render graph.");
+
+    return *m_computePassEncoder;
+}
+
+const std::optional<RenderPipelineSubpass>& RenderGraphPassContext::getSubpass() const
+{
+    return m_subpass;
+}
+
+Texture& RenderGraphPassContext::getTexture(RenderGraphTexture texture) const
+{
+    return *m_graph.getTextureView(texture).getTexture();
+}
+
+TextureView& RenderGraphPassContext::getTextureView(RenderGraphTexture texture) const
+{
+    return m_graph.getTextureView(texture);
+}
+
+Buffer& RenderGraphPassContext::getBuffer(RenderGraphBuffer buffer) const
+{
+    return m_graph.getBuffer(buffer);
+}
+
+RenderGraphPassBuilder::RenderGraphPassBuilder(RenderGraph& graph, uint32_t passIndex)
+    : m_graph(graph)
+    , m_passIndex(passIndex)
+{
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::addColorAttachment(const RenderGraphColorAttachment& attachment)
+{
+    auto& pass = m_graph.m_passes[m_passIndex];
+    if (pass.type != RenderGraphPassType::kRender)
+        throw std::runtime_error(fmt::format("Pass [{}] is not a render pass to add a color attachment.", pass.name));
+
+    write(attachment.texture, TextureUsageFlagBits::kColorAttachment);
+    if (attachment.loadOp == LoadOp::kLoad)
+        read(attachment.texture, TextureUsageFlagBits::kColorAttachment);
+    if (attachment.resolveTexture.has_value())
+        write(attachment.resolveTexture.value(), TextureUsageFlagBits::kColorAttachment);
+
+    pass.colorAttachments.push_back(attachment);
+
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::setDepthStencilAttachment(const RenderGraphDepthStencilAttachment& attachment)
+{
+    auto& pass = m_graph.m_passes[m_passIndex];
+    if (pass.type != RenderGraphPassType::kRender)
+        throw std::runtime_error(fmt::format("Pass [{}] is not a render pass to set a depth stencil attachment.", pass.name));
+
+    write(attachment.texture, TextureUsageFlagBits::kDepthStencil);
+    if (attachment.depthLoadOp == LoadOp::kLoad || attachment.stencilLoadOp == LoadOp::kLoad)
+        read(attachment.texture, TextureUsageFlagBits::kDepthStencil);
+
+    pass.depthStencilAttachment = attachment;
+
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::readInputAttachment(RenderGraphTexture texture)
+{
+    auto& pass = m_graph.m_passes[m_passIndex];
+    if (pass.type != RenderGraphPassType::kRender)
+        throw std::runtime_error(fmt::format("Pass [{}] is not a render pass to read an input attachment.", pass.name));
+
+    read(texture, TextureUsageFlagBits::kInputAttachment);
+    pass.inputAttachments.push_back(texture);
+
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::read(RenderGraphTexture texture, TextureUsageFlags usage)
+{
+    if (texture.index >= m_graph.m_textures.size())
+        throw std::runtime_error("Invalid texture handle of the render graph.");
+
+    m_graph.m_textures[texture.index].descriptor.usage |= usage;
+    m_graph.m_passes[m_passIndex].accesses.push_back({ .resource = texture.index, .texture = true, .write = false });
+
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::write(RenderGraphTexture texture, TextureUsageFlags usage)
+{
+    if (texture.index >= m_graph.m_textures.size())
+        throw std::runtime_error("Invalid texture handle of the render graph.");
+
+    m_graph.m_textures[texture.index].descriptor.usage |= usage;
+    m_graph.m_passes[m_passIndex].accesses.push_back({ .resource = texture.index, .texture = true, .write = true });
+
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::read(RenderGraphBuffer buffer, BufferUsageFlags usage)
+{
+    if (buffer.index >= m_graph.m_buffers.size())
+        throw std::runtime_error("Invalid buffer handle of the render graph.");
+
+    m_graph.m_buffers[buffer.index].descriptor.usage |= usage;
+    m_graph.m_passes[m_passIndex].accesses.push_back({ .resource = buffer.index, .texture = false, .write = false });
+
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::write(RenderGraphBuffer buffer, BufferUsageFlags usage)
+{
+    if (buffer.index >= m_graph.m_buffers.size())
+        throw std::runtime_error("Invalid buffer handle of the render graph.");
+
+    m_graph.m_buffers[buffer.index].descriptor.usage |= usage;
+    m_graph.m_passes[m_passIndex].accesses.push_back({ .resource = buffer.index, .texture = false, .write = true });
+
+    return *this;
+}
+
+RenderGraphPassBuilder& RenderGraphPassBuilder::setSideEffect()
+{
+    m_graph.m_passes[m_passIndex].sideEffect = true;
+
+    return *this;
+}
+
+RenderGraph::RenderGraph(Device& device, const RenderGraphDescriptor& descriptor)
+    : m_device(device)
+    , m_descriptor(descriptor)
+{
+}
+
+RenderGraph::~RenderGraph() = default;
+
+RenderGraphTexture RenderGraph::createTexture(const std::string& name, const TextureDescriptor& descriptor)
+{
+    m_textures.push_back({ .name = name, .descriptor = descriptor });
+
+    return { .index = static_cast<uint32_t>(m_textures.size() - 1) };
+}
+
+RenderGraphBuffer RenderGraph::createBuffer(const std::string& name, const BufferDescriptor& descriptor)
+{
+    m_buffers.push_back({ .name = name, .descriptor = descriptor });
+
+    return { .index = static_cast<uint32_t>(m_buffers.size() - 1) };
+}
+
+RenderGraphTexture RenderGraph::importTexture(const std::string& name, TextureView& textureView)
+{
+    auto texture = textureView.getTexture();
+
+    TextureDescriptor descriptor{};
+    descriptor.type = texture->getType();
+    descriptor.format = texture->getFormat();
+    descriptor.usage = texture->getUsage();
+    descriptor.width = textureView.getWidth();
+    descriptor.height = textureView.getHeight();
+    descriptor.depth = textureView.getDepth();
+    descriptor.mipLevels = texture->getMipLevels();
+    descriptor.sampleCount = texture->getSampleCount();
+
+    m_textures.push_back({ .name = name, .descriptor = descriptor, .importedView = &textureView });
+
+    return { .index = static_cast<uint32_t>(m_textures.size() - 1) };
+}
+
+RenderGraphBuffer RenderGraph::importBuffer(const std::string& name, Buffer& buffer)
+{
+    BufferDescriptor descriptor{};
+    descriptor.size = buffer.getSize();
+    descriptor.usage = buffer.getUsage();
+
+    m_buffers.push_back({ .name = name, .descriptor = descriptor, .importedBuffer = &buffer });
+
+    return { .index = static_cast<uint32_t>(m_buffers.size() - 1) };
+}
+
+RenderGraphPassBuilder RenderGraph::addPass(const std::string& name, RenderGraphPassType type, RenderGraphExecuteCallback callback)
+{
+    if (m_compiled)
+        throw std::runtime_error("Passes can't be added to the compiled render graph. reset it first.");
+
+    m_passes.push_back({ .name = name, .type = type, .callback = std::move(callback) });
+
+    return RenderGraphPassBuilder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+}
+
+void RenderGraph::compile()
+{
+    m_statistics = {};
+    m_statistics.passes = static_cast<uint32_t>(m_passes.size());
+
+    cull();
+    resolveDependencies();
+    schedule();
+    merge();
+    alias();
+
+    m_compiled = true;
+
+    spdlog::trace("render graph: passes {}, culled {}, dependencies {}, merged {}, textures {} -> {}, buffers {} -> {}, aliased {} bytes",
+                  m_statistics.passes,
+                  m_statistics.culledPasses,
+                  m_statistics.dependencies,
+                  m_statistics.mergedPasses,
+                  m_statistics.transientTextures,
+                  m_statistics.physicalTextures,
+                  m_statistics.transientBuffers,
+                  m_statistics.physicalBuffers,
+                  m_statistics.aliasedMemory);
+}
+
+void RenderGraph::execute(CommandEncoder& commandEncoder)
+{
+    if (!m_compiled)
+        compile();
+
+    ++m_frame;
+    m_serial = m_device.getPendingSerial();
+    acquirePhysicalResources();
+
+    std::unique_ptr<RenderPassEncoder> renderPassEncoder = nullptr;
+    for (auto i = 0; i < m_order.size(); ++i)
+        executePass(m_passes[m_order[i]], i, commandEncoder, renderPassEncoder);
+
+    releasePhysicalResources();
+}
+
+void RenderGraph::reset()
+{
+    m_textures.clear();
+    m_buffers.clear();
+    m_passes.clear();
+    m_order.clear();
+    m_renderPasses.clear();
+    m_textureSlots.clear();
+    m_bufferSlots.clear();
+    m_acquiredTextures.clear();
+    m_acquiredBuffers.clear();
+    m_compiled = false;
+}
+
+std::vector<std::string> RenderGraph::getPassOrder() const
+{
+    std::vector<std::string> names{};
+    names.reserve(m_order.size());
+    for (auto index : m_order)
+        names.push_back(m_passes[index].name);
+
+    return names;
+}
+
+const RenderGraphStatistics& RenderGraph::getStatistics() const
+{
+    return m_statistics;
+}
+
+void RenderGraph::cull()
+{
+    // the last writer of each resource before a pass produces what the pass reads.
+    std::vector<uint32_t> textureWriters(m_textures.size(), UINT32_MAX);
+    std::vector<uint32_t> bufferWriters(m_buffers.size(), UINT32_MAX);
+    std::vector<std::vector<uint32_t>> producers(m_passes.size());
+    std::vector<bool> needed(m_passes.size(), false);
+
+    for (auto i = 0; i < m_passes.size(); ++i)
+    {
+        auto& pass = m_passes[i];
+        needed[i] = pass.sideEffect;
+
+        for (const auto& access : pass.accesses)
+        {
+            auto& writer = access.texture ? textureWriters[access.resource] : bufferWriters[access.resource];
+            if (!access.write && writer != UINT32_MAX)
+                producers[i].push_back(writer);
+        }
+
+        for (const auto& access : pass.accesses)
+        {
+            if (!access.write)
+                continue;
+
+            if (access.texture)
+            {
+                textureWriters[access.resource] = i;
+                needed[i] = needed[i] || m_textures[access.resource].importedView != nullptr;
+            }
+            else
+            {
+                bufferWriters[access.resource] = i;
+                needed[i] = needed[i] || m_buffers[access.resource].importedBuffer != nullptr;
+            }
+        }
+    }
+
+    // producers are always added before the pass.
+    for (auto i = static_cast<int64_t>(m_passes.size()) - 1; i >= 0; --i)
+    {
+        if (!needed[i])
+            continue;
+
+        for (auto producer : producers[i])
+            needed[producer] = true;
+    }
+
+    for (auto i = 0; i < m_passes.size(); ++i)
+    {
+        m_passes[i].culled = !needed[i];
+        if (m_passes[i].culled)
+            ++m_statistics.culledPasses;
+    }
+}
+
+void RenderGraph::resolveDependencies()
+{
+    struct ResourceState
+    {
+        uint32_t writer = UINT32_MAX;
+        std::vector<uint32_t> readers{};
+    };
+
+    std::vector<ResourceState> textureStates(m_textures.size());
+    std::vector<ResourceState> bufferStates(m_buffers.size());
+
+    for (auto i = 0; i < m_passes.size(); ++i)
+    {
+        auto& pass = m_passes[i];
+        pass.dependencies.clear();
+
+        if (pass.culled)
+            continue;
+
+        // reads are resolved before writes of the same pass.
+        for (const auto& access : pass.accesses)
+        {
+            if (access.write)
+                continue;
+
+            auto& state = access.texture ? textureStates[access.resource] : bufferStates[access.resource];
+            if (state.writer != UINT32_MAX)
+                pass.dependencies.push_back(state.writer);
+            state.readers.push_back(i);
+        }
+
+        for (const auto& access : pass.accesses)
+        {
+            if (!access.write)
+                continue;
+
+            auto& state = access.texture ? textureStates[access.resource] : bufferStates[access.resource];
+            for (auto reader : state.readers)
+            {
+                if (reader != i)
+                    pass.dependencies.push_back(reader);
+            }
+            if (state.readers.empty() && state.writer != UINT32_MAX && state.writer != i)
+                pass.dependencies.push_back(state.writer);
+
+            state.writer = i;
+            state.readers.clear();
+        }
+
+        std::sort(pass.dependencies.begin(), pass.dependencies.end());
+        pass.dependencies.erase(std::unique(pass.dependencies.begin(), pass.dependencies.end()), pass.dependencies.end());
+        m_statistics.dependencies += static_cast<uint32_t>(pass.dependencies.size());
+    }
+}
+
+void RenderGraph::schedule()
+{
+    std::vector<std::vector<uint32_t>> successors(m_passes.size());
+    std::vector<uint32_t> remains(m_passes.size(), 0);
+    // position after the last dependency which is scheduled. passes of which inputs are ready earlier are executed first,
+    // so independent passes are placed between dependent passes and they can overlap on the GPU.
+    std::vector<uint32_t> readyPositions(m_passes.size(), 0);
+
+    std::vector<uint32_t> ready{};
+    for (auto i = 0; i < m_passes.size(); ++i)
+    {
+        const auto& pass = m_passes[i];
+        if (pass.culled)
+            continue;
+
+        remains[i] = static_cast<uint32_t>(pass.dependencies.size());
+        for (auto dependency : pass.dependencies)
+            successors[dependency].push_back(i);
+
+        if (remains[i] == 0)
+            ready.push_back(i);
+    }
+
+    m_order.clear();
+    while (!ready.empty())
+    {
+        // a pass which reads input attachments follows the render pass which writes them, to be merged into it.
+        auto selected = std::find_if(ready.begin(), ready.end(), [&](uint32_t index) {
+            return !m_passes[index].inputAttachments.empty();
+        });
+        if (selected == ready.end())
+        {
+            selected = std::min_element(ready.begin(), ready.end(), [&](uint32_t lhs, uint32_t rhs) {
+                return readyPositions[lhs] != readyPositions[rhs] ? readyPositions[lhs] < readyPositions[rhs] : lhs < rhs;
+            });
+        }
+
+        const uint32_t index = *selected;
+        ready.erase(selected);
+        m_order.push_back(index);
+
+        for (auto successor : successors[index])
+        {
+            readyPositions[successor] = static_cast<uint32_t>(m_order.size());
+            if (--remains[successor] == 0)
+                ready.push_back(successor);
+        }
+    }
+}
+
+void RenderGraph::merge()
+{
+    m_renderPasses.clear();
+    for (auto i = 0; i < m_order.size(); ++i)
+    {
+        auto& pass = m_passes[m_order[i]];
+        if (pass.type != RenderGraphPassType::kRender)
+            continue;
+
+        const uint32_t position = static_cast<uint32_t>(i);
+        if (pass.inputAttachments.empty())
+        {
+            m_renderPasses.push_back({ .first = position, .last = position });
+        }
+        else
+        {
+            // the attachments are read at the same pixel, so the writer must be the render pass right before.
+            if (m_renderPasses.empty() || m_renderPasses.back().last + 1 != position || !canMerge(m_renderPasses.back(), pass))
+                throw std::runtime_error(fmt::format("Pass [{}] reads input attachments, but it can't be merged into the previous render pass.", pass.name));
+
+            ++m_statistics.mergedPasses;
+        }
+
+        addSubpass(m_renderPasses.back(), pass, position);
+    }
+}
+
+bool RenderGraph::canMerge(const MergedRenderPass& renderPass, const Pass& pass) const
+{
+    auto findColorAttachment = [](const std::vector<RenderGraphColorAttachment>& attachments, RenderGraphTexture texture) {
+        return std::find_if(attachments.begin(), attachments.end(), [&](const RenderGraphColorAttachment& attachment) {
+            return attachment.texture.index == texture.index;
+        });
+    };
+    auto isAttachment = [&](const std::vector<RenderGraphColorAttachment>& attachments,
+                            const std::optional<RenderGraphDepthStencilAttachment>& depthStencilAttachment,
+                            uint32_t texture) {
+        return findColorAttachment(attachments, { .index = texture }) != attachments.end() ||
+               (depthStencilAttachment.has_value() && depthStencilAttachment->texture.index == texture);
+    };
+
+    // input attachments are color attachments of previous subpasses, and they are not written by the pass.
+    for (auto texture : pass.inputAttachments)
+    {
+        if (findColorAttachment(renderPass.colorAttachments, texture) == renderPass.colorAttachments.end() ||
+            findColorAttachment(pass.colorAttachments, texture) != pass.colorAttachments.end())
+            return false;
+    }
+
+    // all attachments of a render pass have the same extent and sample count.
+    const auto& reference = m_textures[renderPass.colorAttachments[0].texture.index].descriptor;
+    auto isSameExtent = [&](RenderGraphTexture texture) {
+        const auto& descriptor = m_textures[texture.index].descriptor;
+        return descriptor.width == reference.width && descriptor.height == reference.height && descriptor.sampleCount == reference.sampleCount;
+    };
+
+    for (const auto& attachment : pass.colorAttachments)
+    {
+        // resolves of subpasses are done once by the render pass.
+        if (attachment.resolveTexture.has_value() || !isSameExtent(attachment.texture))
+            return false;
+        // attachments of previous subpasses are not cleared again.
+        if (findColorAttachment(renderPass.colorAttachments, attachment.texture) != renderPass.colorAttachments.end() && attachment.loadOp != LoadOp::kLoad)
+            return false;
+    }
+    for (const auto& attachment : renderPass.colorAttachments)
+    {
+        if (attachment.resolveTexture.has_value())
+            return false;
+    }
+
+    if (pass.depthStencilAttachment.has_value())
+    {
+        const auto& attachment = pass.depthStencilAttachment.value();
+        if (!isSameExtent(attachment.texture))
+            return false;
+        if (renderPass.depthStencilAttachment.has_value() &&
+            (renderPass.depthStencilAttachment->texture.index != attachment.texture.index ||
+             attachment.depthLoadOp != LoadOp::kLoad || attachment.stencilLoadOp == LoadOp::kClear))
+            return false;
+    }
+
+    // other accesses to resources which are written by previous subpasses, or the other way around, need barriers between passes.
+    for (const auto& access : pass.accesses)
+    {
+        for (const auto& previous : renderPass.accesses)
+        {
+            if (access.resource != previous.resource || access.texture != previous.texture || (!access.write && !previous.write))
+                continue;
+
+            const bool attachment = access.texture &&
+                                    isAttachment(renderPass.colorAttachments, renderPass.depthStencilAttachment, access.resource) &&
+                                    (isAttachment(pass.colorAttachments, pass.depthStencilAttachment, access.resource) ||
+                                     std::any_of(pass.inputAttachments.begin(), pass.inputAttachments.end(), [&](RenderGraphTexture texture) {
+                                         return texture.index == access.resource;
+                                     }));
+            if (!attachment)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void RenderGraph::addSubpass(MergedRenderPass& renderPass, Pass& pass, uint32_t position)
+{
+    auto getColorAttachmentIndex = [&](RenderGraphTexture texture) {
+        for (auto i = 0; i < renderPass.colorAttachments.size(); ++i)
+        {
+            if (renderPass.colorAttachments[i].texture.index == texture.index)
+                return static_cast<uint32_t>(i);
+        }
+        return UINT32_MAX;
+    };
+
+    SubpassDescriptor subpass{ .depthStencil = pass.depthStencilAttachment.has_value() };
+    for (const auto& attachment : pass.colorAttachments)
+    {
+        uint32_t index = getColorAttachmentIndex(attachment.texture);
+        if (index == UINT32_MAX)
+        {
+            renderPass.colorAttachments.push_back(attachment);
+            index = static_cast<uint32_t>(renderPass.colorAttachments.size() - 1);
+        }
+        else
+        {
+            // the load op is from the first subpass, and the store op is from the last one.
+            renderPass.colorAttachments[index].storeOp = attachment.storeOp;
+        }
+        subpass.colorAttachments.push_back(index);
+    }
+    for (auto texture : pass.inputAttachments)
+        subpass.inputAttachments.push_back(getColorAttachmentIndex(texture));
+
+    if (pass.depthStencilAttachment.has_value())
+    {
+        const auto& attachment = pass.depthStencilAttachment.value();
+        if (renderPass.depthStencilAttachment.has_value())
+        {
+            renderPass.depthStencilAttachment->depthStoreOp = attachment.depthStoreOp;
+            renderPass.depthStencilAttachment->stencilStoreOp = attachment.stencilStoreOp;
+        }
+        else
+        {
+            renderPass.depthStencilAttachment = attachment;
+        }
+    }
+
+    renderPass.subpasses.push_back(subpass);
+    renderPass.accesses.insert(renderPass.accesses.end(), pass.accesses.begin(), pass.accesses.end());
+    renderPass.last = position;
+
+    pass.renderPass = static_cast<uint32_t>(m_renderPasses.size() - 1);
+    pass.subpass = static_cast<uint32_t>(renderPass.subpasses.size() - 1);
+}
+
+void RenderGraph::alias()
+{
+    struct Lifetime
+    {
+        uint32_t first = UINT32_MAX;
+        uint32_t last = 0;
+    };
+
+    std::vector<Lifetime> textureLifetimes(m_textures.size());
+    std::vector<Lifetime> bufferLifetimes(m_buffers.size());
+
+    for (auto i = 0; i < m_order.size(); ++i)
+    {
+        for (const auto& access : m_passes[m_order[i]].accesses)
+        {
+            auto& lifetime = access.texture ? textureLifetimes[access.resource] : bufferLifetimes[access.resource];
+            lifetime.first = std::min(lifetime.first, static_cast<uint32_t>(i));
+            lifetime.last = std::max(lifetime.last, static_cast<uint32_t>(i));
+
+            if (access.texture && !access.write)
+                m_textures[access.resource].lastRead = static_cast<uint32_t>(i);
+        }
+    }
+
+    // attachments of merged render passes are used by all subpasses.
+    for (const auto& renderPass : m_renderPasses)
+    {
+        auto extend = [&](RenderGraphTexture texture) {
+            auto& lifetime = textureLifetimes[texture.index];
+            lifetime.first = std::min(lifetime.first, renderPass.first);
+            lifetime.last = std::max(lifetime.last, renderPass.last);
+        };
+
+        for (const auto& attachment : renderPass.colorAttachments)
+            extend(attachment.texture);
+        if (renderPass.depthStencilAttachment.has_value())
+            extend(renderPass.depthStencilAttachment->texture);
+    }
+
+    // transient resources are assigned in the order of first use. a physical resource is shared if its last use is before.
+    // among compatible physical resources, the one which grows least is chosen, and it is grown to cover the resource.
+    auto assign = [](const std::vector<Lifetime>& lifetimes, auto isTransient, auto isCompatible, auto getGrowth, auto grow, auto getDescriptor, auto& slots, auto setSlot) {
+        std::vector<uint32_t> resources{};
+        for (auto i = 0; i < lifetimes.size(); ++i)
+        {
+            if (lifetimes[i].first != UINT32_MAX && isTransient(i))
+                resources.push_back(i);
+        }
+        std::sort(resources.begin(), resources.end(), [&](uint32_t lhs, uint32_t rhs) {
+            return lifetimes[lhs].first < lifetimes[rhs].first;
+        });
+
+        std::vector<uint32_t> slotLastUses{};
+        for (auto resource : resources)
+        {
+            const auto& descriptor = getDescriptor(resource);
+
+            uint32_t slot = UINT32_MAX;
+            uint64_t slotGrowth = UINT64_MAX;
+            for (auto i = 0; i < slots.size(); ++i)
+            {
+                if (slotLastUses[i] >= lifetimes[resource].first || !isCompatible(slots[i], descriptor))
+                    continue;
+
+                const uint64_t growth = getGrowth(slots[i], descriptor);
+                if (growth < slotGrowth)
+                {
+                    slot = i;
+                    slotGrowth = growth;
+                }
+            }
+
+            if (slot == UINT32_MAX)
+            {
+                slots.push_back(descriptor);
+                slotLastUses.push_back(0);
+                slot = static_cast<uint32_t>(slots.size() - 1);
+            }
+            else
+            {
+                grow(slots[slot], descriptor);
+            }
+
+            slotLastUses[slot] = lifetimes[resource].last;
+            setSlot(resource, slot);
+        }
+
+        return static_cast<uint32_t>(resources.size());
+    };
+
+    m_textureSlots.clear();
+    m_statistics.transientTextures = assign(
+        textureLifetimes,
+        [&](uint32_t index) { return m_textures[index].importedView == nullptr; },
+        isCompatibleTexture,
+        [](const TextureDescriptor&, const TextureDescriptor&) { return uint64_t{ 0 }; },
+        [](TextureDescriptor& slot, const TextureDescriptor& descriptor) { slot.usage |= descriptor.usage; },
+        [&](uint32_t index) -> const TextureDescriptor& { return m_textures[index].descriptor; },
+        m_textureSlots,
+        [&](uint32_t index, uint32_t slot) { m_textures[index].physicalIndex = slot; });
+    m_statistics.physicalTextures = static_cast<uint32_t>(m_textureSlots.size());
+
+    m_bufferSlots.clear();
+    m_statistics.transientBuffers = assign(
+        bufferLifetimes,
+        [&](uint32_t index) { return m_buffers[index].importedBuffer == nullptr; },
+        [](const BufferDescriptor&, const BufferDescriptor&) { return true; },
+        [](const BufferDescriptor& slot, const BufferDescriptor& descriptor) { return descriptor.size > slot.size ? descriptor.size - slot.size : uint64_t{ 0 }; },
+        [](BufferDescriptor& slot, const BufferDescriptor& descriptor) {
+            slot.size = std::max(slot.size, descriptor.size);
+            slot.usage |= descriptor.usage;
+        },
+        [&](uint32_t index) -> const BufferDescriptor& { return m_buffers[index].descriptor; },
+        m_bufferSlots,
+        [&](uint32_t index, uint32_t slot) { m_buffers[index].physicalIndex = slot; });
+    m_statistics.physicalBuffers = static_cast<uint32_t>(m_bufferSlots.size());
+
+    uint64_t virtualMemory = 0;
+    for (const auto& texture : m_textures)
+    {
+        if (texture.physicalIndex != UINT32_MAX)
+            virtualMemory += getTextureMemory(texture.descriptor);
+    }
+    for (const auto& buffer : m_buffers)
+    {
+        if (buffer.physicalIndex != UINT32_MAX)
+            virtualMemory += buffer.descriptor.size;
+    }
+
+    for (const auto& descriptor : m_textureSlots)
+        m_statistics.transientMemory += getTextureMemory(descriptor);
+    for (const auto& descriptor : m_bufferSlots)
+        m_statistics.transientMemory += descriptor.size;
+
+    m_statistics.aliasedMemory = virtualMemory - m_statistics.transientMemory;
+}
+
+void RenderGraph::acquirePhysicalResources()
+{
+    m_acquiredTextures.clear();
+    for (const auto& descriptor : m_textureSlots)
+    {
+        auto it = std::find_if(m_texturePool.begin(), m_texturePool.end(), [&](const PhysicalTexture& physicalTexture) {
+            return physicalTexture.lastUsedFrame != m_frame && canUseTexture(physicalTexture.descriptor, descriptor);
+        });
+
+        if (it == m_texturePool.end())
+        {
+            PhysicalTexture physicalTexture{};
+            physicalTexture.descriptor = descriptor;
+            physicalTexture.texture = m_device.createTexture(descriptor);
+            physicalTexture.textureView = physicalTexture.texture->createTextureView(generateTextureViewDescriptor(descriptor));
+
+            m_texturePool.push_back(std::move(physicalTexture));
+            it = m_texturePool.end() - 1;
+            ++m_statistics.createdTextures;
+        }
+
+        it->lastUsedFrame = m_frame;
+        it->lastUsedSerial = m_serial;
+        m_acquiredTextures.push_back(static_cast<uint32_t>(std::distance(m_texturePool.begin(), it)));
+    }
+
+    const uint64_t completedSerial = m_device.getCompletedSerial();
+
+    m_acquiredBuffers.clear();
+    for (const auto& descriptor : m_bufferSlots)
+    {
+        auto it = std::find_if(m_bufferPool.begin(), m_bufferPool.end(), [&](const PhysicalBuffer& physicalBuffer) {
+            return physicalBuffer.lastUsedFrame != m_frame && physicalBuffer.lastUsedSerial <= completedSerial &&
+                   canUseBuffer(physicalBuffer.descriptor, descriptor);
+        });
+
+        if (it == m_bufferPool.end())
+        {
+            PhysicalBuffer physicalBuffer{};
+            physicalBuffer.descriptor = descriptor;
+            physicalBuffer.buffer = m_device.createBuffer(descriptor);
+
+            m_bufferPool.push_back(std::move(physicalBuffer));
+            it = m_bufferPool.end() - 1;
+            ++m_statistics.createdBuffers;
+        }
+
+        it->lastUsedFrame = m_frame;
+        it->lastUsedSerial = m_serial;
+        m_acquiredBuffers.push_back(static_cast<uint32_t>(std::distance(m_bufferPool.begin(), it)));
+    }
+
+    for (auto& texture : m_textures)
+        texture.written = false;
+}
+
+void RenderGraph::releasePhysicalResources()
+{
+    // resources may be used by submissions which are not completed yet, even if they are not used for the frames.
+    const uint64_t completedSerial = m_device.getCompletedSerial();
+
+    // acquired indices are not valid after release, but they are not used until next execute.
+    std::erase_if(m_texturePool, [&](const PhysicalTexture& physicalTexture) {
+        return m_frame - physicalTexture.lastUsedFrame >= m_descriptor.releaseFrames && physicalTexture.lastUsedSerial <= completedSerial;
+    });
+    std::erase_if(m_bufferPool, [&](const PhysicalBuffer& physicalBuffer) {
+        return m_frame - physicalBuffer.lastUsedFrame >= m_descriptor.releaseFrames && physicalBuffer.lastUsedSerial <= completedSerial;
+    });
+}
+
+void RenderGraph::executePass(Pass& pass, uint32_t position, CommandEncoder& commandEncoder, std::unique_ptr<RenderPassEncoder>& renderPassEncoder)
+{
+    RenderGraphPassContext context(*this, commandEncoder);
+
+    switch (pass.type)
+    {
+    case RenderGraphPassType::kRender: {
+        const auto& renderPass = m_renderPasses[pass.renderPass];
+        if (pass.subpass == 0)
+            renderPassEncoder = commandEncoder.beginRenderPass(generateRenderPassEncoderDescriptor(renderPass));
+        else
+            renderPassEncoder->nextPass();
+
+        if (renderPass.subpasses.size() > 1)
+        {
+            RenderPipelineSubpass subpass{ .subpasses = renderPass.subpasses, .index = pass.subpass };
+            for (const auto& attachment : renderPass.colorAttachments)
+                subpass.colorFormats.push_back(m_textures[attachment.texture.index].descriptor.format);
+            if (renderPass.depthStencilAttachment.has_value())
+                subpass.depthStencilFormat = m_textures[renderPass.depthStencilAttachment->texture.index].descriptor.format;
+
+            context.m_subpass = subpass;
+        }
+
+        context.m_renderPassEncoder = renderPassEncoder.get();
+        pass.callback(context);
+
+        if (position == renderPass.last)
+        {
+            renderPassEncoder->end();
+            renderPassEncoder.reset();
+        }
+    }
+    break;
+    case RenderGraphPassType::kCompute: {
+        auto computePassEncoder = commandEncoder.beginComputePass(ComputePassEncoderDescriptor{});
+        context.m_computePassEncoder = computePassEncoder.get();
+        pass.callback(context);
+        computePassEncoder->end();
+    }
+    break;
+    case RenderGraphPassType::kTransfer:
+        pass.callback(context);
+        break;
+    }
+
+    for (const auto& access : pass.accesses)
+    {
+        if (access.texture && access.write)
+            m_textures[access.resource].written = true;
+    }
+}
+
+RenderPassEncoderDescriptor RenderGraph::generateRenderPassEncoderDescriptor(const MergedRenderPass& renderPass)
+{
+    // contents of transient attachments are not loaded before they are written,
+    // and they are not stored if nothing reads them after the render pass.
+    auto getLoadOp = [&](RenderGraphTexture texture, LoadOp loadOp) {
+        const auto& resource = m_textures[texture.index];
+        return (loadOp == LoadOp::kLoad && resource.importedView == nullptr && !resource.written) ? LoadOp::kDontCare : loadOp;
+    };
+    auto getStoreOp = [&](RenderGraphTexture texture, StoreOp storeOp) {
+        const auto& resource = m_textures[texture.index];
+        if (storeOp == StoreOp::kStore && resource.importedView == nullptr && (resource.lastRead == UINT32_MAX || resource.lastRead <= renderPass.last))
+        {
+            ++m_statistics.discardedStores;
+            return StoreOp::kDontCare;
+        }
+        return storeOp;
+    };
+
+    RenderPassEncoderDescriptor descriptor{};
+    for (const auto& attachment : renderPass.colorAttachments)
+    {
+        ColorAttachment colorAttachment{
+            .renderView = getTextureView(attachment.texture),
+            .loadOp = getLoadOp(attachment.texture, attachment.loadOp),
+            .storeOp = getStoreOp(attachment.texture, attachment.storeOp),
+            .clearValue = attachment.clearValue,
+        };
+        if (attachment.resolveTexture.has_value())
+            colorAttachment.resolveView = getTextureView(attachment.resolveTexture.value());
+
+        descriptor.colorAttachments.push_back(colorAttachment);
+        descriptor.sampleCount = m_textures[attachment.texture.index].descriptor.sampleCount;
+    }
+
+    if (renderPass.depthStencilAttachment.has_value())
+    {
+        const auto& attachment = renderPass.depthStencilAttachment.value();
+        descriptor.depthStencilAttachment.emplace(DepthStencilAttachment{
+            .textureView = getTextureView(attachment.texture),
+            .depthLoadOp = getLoadOp(attachment.texture, attachment.depthLoadOp),
+            .depthStoreOp = getStoreOp(attachment.texture, attachment.depthStoreOp),
+            .stencilLoadOp = getLoadOp(attachment.texture, attachment.stencilLoadOp),
+            .stencilStoreOp = getStoreOp(attachment.texture, attachment.stencilStoreOp),
+            .clearValue = attachment.clearValue,
+        });
+        descriptor.sampleCount = m_textures[attachment.texture.index].descriptor.sampleCount;
+    }
+
+    // a render pass which is not merged uses all attachments in its only subpass.
+    if (renderPass.subpasses.size() > 1)
+        descriptor.subpasses = renderPass.subpasses;
+
+    return descriptor;
+}
+
+TextureView& RenderGraph::getTextureView(RenderGraphTexture texture)
+{
+    if (texture.index >= m_textures.size())
+        throw std::runtime_error("Invalid texture handle of the render graph.");
+
+    const auto& resource = m_textures[texture.index];
+    if (resource.importedView)
+        return *resource.importedView;
+
+    if (resource.physicalIndex >= m_acquiredTextures.size())
+        throw std::runtime_error(fmt::format("Texture [{}] is not used by passes of the render graph.", resource.name));
+
+    return *m_texturePool[m_acquiredTextures[resource.physicalIndex]].textureView;
+}
+
+Buffer& RenderGraph::getBuffer(RenderGraphBuffer buffer)
+{
+    if (buffer.index >= m_buffers.size())
+        throw std::runtime_error("Invalid buffer handle of the render graph.");
+
+    const auto& resource = m_buffers[buffer.index];
+    if (resource.importedBuffer)
+        return *resource.importedBuffer;
+
+    if (resource.physicalIndex >= m_acquiredBuffers.size())
+        throw std::runtime_error(fmt::format("Buffer [{}] is not used by passes of the render graph.", resource.name));
+
+    return *m_bufferPool[m_acquiredBuffers[resource.physicalIndex]].buffer;
+}
+
+} // namespace jipu
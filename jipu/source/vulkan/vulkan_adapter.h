@@ -7,7 +7,7 @@
 namespace jipu
 {
 
-class VulkanAdapter : public Adapter
+class VulkanAdapter final : public Adapter
 {
 
 public:
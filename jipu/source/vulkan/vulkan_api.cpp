@@ -76,11 +76,14 @@ bool VulkanAPI::loadInstanceProcs(VkInstance instance, const VulkanInstanceKnobs
     // GET_INSTANCE_PROC(GetPhysicalDeviceExternalBufferProperties)
     // GET_INSTANCE_PROC(GetPhysicalDeviceExternalFenceProperties)
     // GET_INSTANCE_PROC(GetPhysicalDeviceExternalSemaphoreProperties)
-    // GET_INSTANCE_PROC(GetPhysicalDeviceFeatures2)
+    if (instanceKnobs.apiVersion >= VK_API_VERSION_1_1)
+    {
+        GET_INSTANCE_PROC(GetPhysicalDeviceFeatures2)
+        GET_INSTANCE_PROC(GetPhysicalDeviceProperties2)
+    }
     // GET_INSTANCE_PROC(GetPhysicalDeviceFormatProperties2)
     // GET_INSTANCE_PROC(GetPhysicalDeviceImageFormatProperties2)
     // GET_INSTANCE_PROC(GetPhysicalDeviceMemoryProperties2)
-    // GET_INSTANCE_PROC(GetPhysicalDeviceProperties2)
     // GET_INSTANCE_PROC(GetPhysicalDeviceQueueFamilyProperties2)
     // GET_INSTANCE_PROC(GetPhysicalDeviceSparseImageFormatProperties2)
 #endif /* defined(VK_VERSION_1_1) */
@@ -125,6 +128,16 @@ bool VulkanAPI::loadInstanceProcs(VkInstance instance, const VulkanInstanceKnobs
     //     GET_INSTANCE_PROC(GetPhysicalDeviceExternalSemaphorePropertiesKHR);
     // }
 
+    // the extension is promoted to vulkan 1.1. the core procs are used if the instance supports it.
+    if (instanceKnobs.getPhysicalDeviceProperties2 && instanceKnobs.apiVersion < VK_API_VERSION_1_1)
+    {
+        GET_INSTANCE_PROC(GetPhysicalDeviceFeatures2KHR);
+        GET_INSTANCE_PROC(GetPhysicalDeviceProperties2KHR);
+
+        GetPhysicalDeviceFeatures2 = GetPhysicalDeviceFeatures2KHR;
+        GetPhysicalDeviceProperties2 = GetPhysicalDeviceProperties2KHR;
+    }
+
     // if (instanceKnobs.getPhysicalDeviceProperties2 ||
     //     instanceKnobs.apiVersion >= VK_MAKE_VERSION(1, 1, 0))
     // {
@@ -320,9 +333,7 @@ bool VulkanAPI::loadDeviceProcs(VkDevice device, const VulkanDeviceKnobs& device
     // GET_DEVICE_PROC(BindImageMemory2)
     // GET_DEVICE_PROC(CmdDispatchBase)
     // GET_DEVICE_PROC(CmdSetDeviceMask)
-    // GET_DEVICE_PROC(CreateDescriptorUpdateTemplate)
     // GET_DEVICE_PROC(CreateSamplerYcbcrConversion)
-    // GET_DEVICE_PROC(DestroyDescriptorUpdateTemplate)
     // GET_DEVICE_PROC(DestroySamplerYcbcrConversion)
     // GET_DEVICE_PROC(GetBufferMemoryRequirements2)
     // GET_DEVICE_PROC(GetDescriptorSetLayoutSupport)
@@ -331,7 +342,12 @@ bool VulkanAPI::loadDeviceProcs(VkDevice device, const VulkanDeviceKnobs& device
     // GET_DEVICE_PROC(GetImageMemoryRequirements2)
     // GET_DEVICE_PROC(GetImageSparseMemoryRequirements2)
     // GET_DEVICE_PROC(TrimCommandPool)
-    // GET_DEVICE_PROC(UpdateDescriptorSetWithTemplate)
+    if (deviceKnobs.descriptorUpdateTemplate)
+    {
+        GET_DEVICE_PROC(CreateDescriptorUpdateTemplate);
+        GET_DEVICE_PROC(DestroyDescriptorUpdateTemplate);
+        GET_DEVICE_PROC(UpdateDescriptorSetWithTemplate);
+    }
 
 #endif /* defined(VK_VERSION_1_1) */
 #if defined(VK_VERSION_1_2)
@@ -398,6 +414,28 @@ bool VulkanAPI::loadDeviceProcs(VkDevice device, const VulkanDeviceKnobs& device
         GET_DEVICE_PROC(AcquireNextImageKHR);
         GET_DEVICE_PROC(QueuePresentKHR);
     }
+
+    if (deviceKnobs.dynamicRendering)
+    {
+        GET_DEVICE_PROC(CmdBeginRenderingKHR);
+        GET_DEVICE_PROC(CmdEndRenderingKHR);
+    }
+
+    if (deviceKnobs.pushDescriptor)
+    {
+        GET_DEVICE_PROC(CmdPushDescriptorSetKHR);
+    }
+
+    if (deviceKnobs.drawIndirectCount)
+    {
+        GET_DEVICE_PROC(CmdDrawIndirectCountKHR);
+        GET_DEVICE_PROC(CmdDrawIndexedIndirectCountKHR);
+    }
+
+    if (deviceKnobs.synchronization2)
+    {
+        GET_DEVICE_PROC(CmdPipelineBarrier2KHR);
+    }
     // if (deviceKnobs.debugMarker)
     // {
     //     GET_DEVICE_PROC(CmdDebugMarkerBeginEXT);
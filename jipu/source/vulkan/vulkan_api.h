@@ -37,12 +37,26 @@ struct VulkanInstanceKnobs
     bool win32Surface = false;
 
     bool portabilityEnum = false;
+    bool getPhysicalDeviceProperties2 = false;
 };
 
 struct VulkanDeviceKnobs
 {
     bool swapchain = false;
     bool portabilitySubset = false;
+    bool imageFormatList = false;
+    bool imagelessFramebuffer = false;
+    bool createRenderPass2 = false;
+    bool depthStencilResolve = false;
+    bool dynamicRendering = false;
+    bool pipelineLibrary = false;
+    bool graphicsPipelineLibrary = false;
+    bool descriptorIndexing = false;
+    bool descriptorUpdateTemplate = false;
+    bool imageExtendedUsage = false;
+    bool pushDescriptor = false;
+    bool drawIndirectCount = false;
+    bool synchronization2 = false;
 };
 
 /// @brief ref: https://dawn.googlesource.com/dawn/+/refs/heads/main/src/dawn/native/vulkan/ VulkanAPI.h
@@ -367,6 +381,20 @@ struct VulkanAPI
     PFN_vkAcquireNextImageKHR AcquireNextImageKHR = nullptr;
     PFN_vkQueuePresentKHR QueuePresentKHR = nullptr;
 
+    // VK_KHR_dynamic_rendering
+    PFN_vkCmdBeginRenderingKHR CmdBeginRenderingKHR = nullptr;
+    PFN_vkCmdEndRenderingKHR CmdEndRenderingKHR = nullptr;
+
+    // VK_KHR_push_descriptor
+    PFN_vkCmdPushDescriptorSetKHR CmdPushDescriptorSetKHR = nullptr;
+
+    // VK_KHR_draw_indirect_count
+    PFN_vkCmdDrawIndirectCountKHR CmdDrawIndirectCountKHR = nullptr;
+    PFN_vkCmdDrawIndexedIndirectCountKHR CmdDrawIndexedIndirectCountKHR = nullptr;
+
+    // VK_KHR_synchronization2
+    PFN_vkCmdPipelineBarrier2KHR CmdPipelineBarrier2KHR = nullptr;
+
     // VK_KHR_external_memory_fd
     PFN_vkGetMemoryFdKHR GetMemoryFdKHR = nullptr;
     PFN_vkGetMemoryFdPropertiesKHR GetMemoryFdPropertiesKHR = nullptr;
@@ -6,21 +6,85 @@
 #include "vulkan_texture.h"
 #include "vulkan_texture_view.h"
 
+#include "utils/hash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 
 namespace jipu
 {
 
+namespace
+{
+
+template <typename T>
+uint64_t toHandleKey(T handle)
+{
+    if constexpr (std::is_pointer_v<T>)
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+    else
+        return static_cast<uint64_t>(handle);
+}
+
+template <typename T>
+void appendKey(std::string& key, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "key value must be trivially copyable.");
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// VkDescriptorImageInfo has padding on 64 bit, so the key is built field by field.
+std::string generateBindingGroupKey(const VulkanBindingGroupDescriptor& descriptor, std::vector<uint64_t>& handles)
+{
+    auto descriptorSetLayout = downcast(descriptor.layout).getVkDescriptorSetLayout();
+    handles.push_back(toHandleKey(descriptorSetLayout));
+
+    std::string key{};
+    appendKey(key, descriptorSetLayout);
+
+    appendKey(key, descriptor.buffers.size());
+    for (const auto& buffer : descriptor.buffers)
+    {
+        appendKey(key, buffer.buffer);
+        appendKey(key, buffer.offset);
+        appendKey(key, buffer.range);
+        handles.push_back(toHandleKey(buffer.buffer));
+    }
+
+    appendKey(key, descriptor.samplers.size());
+    for (const auto& sampler : descriptor.samplers)
+    {
+        appendKey(key, sampler.sampler);
+        handles.push_back(toHandleKey(sampler.sampler));
+    }
+
+    appendKey(key, descriptor.textures.size());
+    for (const auto& texture : descriptor.textures)
+    {
+        appendKey(key, texture.imageView);
+        appendKey(key, texture.imageLayout);
+        handles.push_back(toHandleKey(texture.imageView));
+    }
+
+    return key;
+}
+
+} // namespace
+
 VulkanBindingGroupDescriptor generateVulkanBindingGroupDescriptor(const BindingGroupDescriptor& descriptor)
 {
     VulkanBindingGroupDescriptor vkdescriptor{
-        .layout = descriptor.layout
+        .layout = descriptor.layout,
+        .cached = descriptor.cached,
     };
 
     const uint64_t bufferSize = descriptor.buffers.size();
     const uint64_t samplerSize = descriptor.samplers.size();
     const uint64_t textureSize = descriptor.textures.size();
+    const uint64_t inputAttachmentSize = descriptor.inputAttachments.size();
 
     vkdescriptor.buffers.resize(bufferSize);
     for (auto i = 0; i < bufferSize; ++i)
@@ -46,7 +110,8 @@ VulkanBindingGroupDescriptor generateVulkanBindingGroupDescriptor(const BindingG
         vkdescriptor.samplers[i] = imageInfo;
     }
 
-    vkdescriptor.textures.resize(textureSize);
+    // input attachments are written after textures, same as the layout.
+    vkdescriptor.textures.resize(textureSize + inputAttachmentSize);
     // update texture
     for (auto i = 0; i < textureSize; ++i)
     {
@@ -62,34 +127,24 @@ VulkanBindingGroupDescriptor generateVulkanBindingGroupDescriptor(const BindingG
         vkdescriptor.textures[i] = imageInfo;
     }
 
-    return vkdescriptor;
-}
+    for (auto i = 0; i < inputAttachmentSize; ++i)
+    {
+        const TextureBinding& inputAttachment = descriptor.inputAttachments[i];
 
-VulkanBindingGroup::VulkanBindingGroup(VulkanDevice& device, const BindingGroupDescriptor& descriptor)
-    : VulkanBindingGroup(device, generateVulkanBindingGroupDescriptor(descriptor))
-{
-}
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageView = downcast(inputAttachment.textureView).getVkImageView();
+        // same as the layout of input attachment references in subpasses.
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-VulkanBindingGroup::VulkanBindingGroup(VulkanDevice& device, const VulkanBindingGroupDescriptor& descriptor)
-    : m_device(device)
-    , m_descriptor(descriptor)
-{
-    auto& vulkanDevice = downcast(device);
-    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
-    auto& vulkanBindingGroupLayout = downcast(m_descriptor.layout);
-    auto descriptorSetLayout = vulkanBindingGroupLayout.getVkDescriptorSetLayout();
+        vkdescriptor.textures[textureSize + i] = imageInfo;
+    }
 
-    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
-    descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    descriptorSetAllocateInfo.descriptorPool = downcast(device).getVkDescriptorPool();
-    descriptorSetAllocateInfo.descriptorSetCount = 1;
-    descriptorSetAllocateInfo.pSetLayouts = &descriptorSetLayout;
+    return vkdescriptor;
+}
 
-    VkResult result = vkAPI.AllocateDescriptorSets(vulkanDevice.getVkDevice(), &descriptorSetAllocateInfo, &m_descriptorSet);
-    if (result != VK_SUCCESS)
-    {
-        throw std::runtime_error("Failed to allocate descriptor sets.");
-    }
+std::vector<VkWriteDescriptorSet> generateVkWriteDescriptorSets(const VulkanBindingGroupDescriptor& descriptor, VkDescriptorSet descriptorSet)
+{
+    auto& vulkanBindingGroupLayout = downcast(descriptor.layout);
 
     const uint64_t bufferSize = descriptor.buffers.size();
     const uint64_t samplerSize = descriptor.samplers.size();
@@ -105,7 +160,7 @@ VulkanBindingGroup::VulkanBindingGroup(VulkanDevice& device, const VulkanBinding
 
         VkWriteDescriptorSet descriptorWrite{};
         descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = m_descriptorSet;
+        descriptorWrite.dstSet = descriptorSet;
         descriptorWrite.dstBinding = bufferLayout.binding;
         descriptorWrite.dstArrayElement = 0;
         descriptorWrite.descriptorType = bufferLayout.descriptorType;
@@ -125,7 +180,7 @@ VulkanBindingGroup::VulkanBindingGroup(VulkanDevice& device, const VulkanBinding
 
         VkWriteDescriptorSet descriptorWrite{};
         descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = m_descriptorSet;
+        descriptorWrite.dstSet = descriptorSet;
         descriptorWrite.dstBinding = samplerLayout.binding;
         descriptorWrite.dstArrayElement = 0;
         descriptorWrite.descriptorType = samplerLayout.descriptorType;
@@ -145,7 +200,7 @@ VulkanBindingGroup::VulkanBindingGroup(VulkanDevice& device, const VulkanBinding
 
         VkWriteDescriptorSet descriptorWrite{};
         descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = m_descriptorSet;
+        descriptorWrite.dstSet = descriptorSet;
         descriptorWrite.dstBinding = textureLayout.binding;
         descriptorWrite.dstArrayElement = 0;
         descriptorWrite.descriptorType = textureLayout.descriptorType;
@@ -158,15 +213,124 @@ VulkanBindingGroup::VulkanBindingGroup(VulkanDevice& device, const VulkanBinding
         descriptorWrites[bufferSize + samplerSize + i] = descriptorWrite;
     }
 
-    vkAPI.UpdateDescriptorSets(vulkanDevice.getVkDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    return descriptorWrites;
+}
+
+std::vector<VulkanBufferAccess> generateVulkanBufferAccesses(const VulkanBindingGroupDescriptor& descriptor)
+{
+    auto& vulkanBindingGroupLayout = downcast(descriptor.layout);
+
+    std::vector<VulkanBufferAccess> accesses{};
+    accesses.reserve(descriptor.buffers.size());
+    for (auto i = 0; i < descriptor.buffers.size(); ++i)
+    {
+        const VkDescriptorBufferInfo& buffer = descriptor.buffers[i];
+        auto bufferLayout = vulkanBindingGroupLayout.getBufferBindingLayout(i);
+
+        const bool dynamicOffset = bufferLayout.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+                                   bufferLayout.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+
+        accesses.push_back({ .buffer = buffer.buffer,
+                             .offset = buffer.offset,
+                             .size = dynamicOffset ? VK_WHOLE_SIZE : buffer.range,
+                             .stageMask = ToVkPipelineStageFlags2(bufferLayout.stageFlags),
+                             .accessMask = vulkanBindingGroupLayout.getBufferAccessFlags(i) });
+    }
+
+    return accesses;
+}
+
+VulkanBindingGroup::VulkanBindingGroup(VulkanDevice& device, const BindingGroupDescriptor& descriptor)
+    : VulkanBindingGroup(device, generateVulkanBindingGroupDescriptor(descriptor))
+{
+}
+
+VulkanBindingGroup::VulkanBindingGroup(VulkanDevice& device, const VulkanBindingGroupDescriptor& descriptor)
+    : m_device(device)
+    , m_descriptor(descriptor)
+{
+    auto& vulkanDevice = downcast(device);
+
+    if (downcast(m_descriptor.layout).isPushDescriptor())
+    {
+        throw std::runtime_error("Failed to create binding group for push descriptor layout. use pushBindings of pass encoder.");
+    }
+
+    // sets from custom allocator can be reset together, so they are not shared.
+    if (m_descriptor.allocator)
+    {
+        m_sharedDescriptorSet = createDescriptorSet(*m_descriptor.allocator);
+    }
+    else if (m_descriptor.cached)
+    {
+        m_sharedDescriptorSet = vulkanDevice.getBindingGroupCache().getDescriptorSet(m_descriptor, [&]() {
+            return createDescriptorSet(vulkanDevice.getDescriptorAllocator());
+        });
+    }
+    else
+    {
+        m_sharedDescriptorSet = createDescriptorSet(vulkanDevice.getDescriptorAllocator());
+    }
+
+    m_descriptorSet = m_sharedDescriptorSet->descriptorSet;
+    m_bufferAccesses = generateVulkanBufferAccesses(m_descriptor);
 }
 
 VulkanBindingGroup::~VulkanBindingGroup()
 {
+    // descriptor set is freed by the last binding group which shares it.
+    m_sharedDescriptorSet.reset();
+}
+
+VulkanSharedDescriptorSet VulkanBindingGroup::createDescriptorSet(VulkanDescriptorAllocator& allocator)
+{
+    const auto& descriptor = m_descriptor;
+
     auto& vulkanDevice = downcast(m_device);
     const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
+    auto& vulkanBindingGroupLayout = downcast(m_descriptor.layout);
+    auto descriptorSetLayout = vulkanBindingGroupLayout.getVkDescriptorSetLayout();
+
+    VulkanDescriptorSetAllocation allocation = allocator.allocate(descriptorSetLayout, vulkanBindingGroupLayout.getDescriptorPoolSizes());
+    VulkanSharedDescriptorSet sharedDescriptorSet(new VulkanDescriptorSetAllocation(allocation),
+                                                  [&allocator](const VulkanDescriptorSetAllocation* allocation) {
+                                                      allocator.free(*allocation);
+                                                      delete allocation;
+                                                  });
+    const VkDescriptorSet descriptorSet = allocation.descriptorSet;
+
+    const uint64_t bufferSize = descriptor.buffers.size();
+    const uint64_t samplerSize = descriptor.samplers.size();
+    const uint64_t textureSize = descriptor.textures.size();
+
+    // write all bindings at once from packed infos if the group binds every binding of the layout.
+    VkDescriptorUpdateTemplate descriptorUpdateTemplate = vulkanBindingGroupLayout.getVkDescriptorUpdateTemplate();
+    if (descriptorUpdateTemplate != VK_NULL_HANDLE &&
+        bufferSize == vulkanBindingGroupLayout.getBufferBindingLayouts().size() &&
+        samplerSize == vulkanBindingGroupLayout.getSamplerBindingLayouts().size() &&
+        textureSize == vulkanBindingGroupLayout.getTextureBindingLayouts().size())
+    {
+        const size_t bufferBytes = bufferSize * sizeof(VkDescriptorBufferInfo);
+        const size_t samplerBytes = samplerSize * sizeof(VkDescriptorImageInfo);
+        const size_t textureBytes = textureSize * sizeof(VkDescriptorImageInfo);
 
-    vkAPI.FreeDescriptorSets(vulkanDevice.getVkDevice(), vulkanDevice.getVkDescriptorPool(), 1, &m_descriptorSet);
+        std::vector<uint8_t> data(bufferBytes + samplerBytes + textureBytes);
+        if (bufferBytes > 0)
+            std::memcpy(data.data(), descriptor.buffers.data(), bufferBytes);
+        if (samplerBytes > 0)
+            std::memcpy(data.data() + bufferBytes, descriptor.samplers.data(), samplerBytes);
+        if (textureBytes > 0)
+            std::memcpy(data.data() + bufferBytes + samplerBytes, descriptor.textures.data(), textureBytes);
+
+        vkAPI.UpdateDescriptorSetWithTemplate(vulkanDevice.getVkDevice(), descriptorSet, descriptorUpdateTemplate, data.data());
+
+        return sharedDescriptorSet;
+    }
+
+    std::vector<VkWriteDescriptorSet> descriptorWrites = generateVkWriteDescriptorSets(descriptor, descriptorSet);
+    vkAPI.UpdateDescriptorSets(vulkanDevice.getVkDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+    return sharedDescriptorSet;
 }
 
 VkDescriptorSet VulkanBindingGroup::getVkDescriptorSet() const
@@ -174,4 +338,118 @@ VkDescriptorSet VulkanBindingGroup::getVkDescriptorSet() const
     return m_descriptorSet;
 }
 
-} // namespace jipu
\ No newline at end of file
+const std::vector<VulkanBufferAccess>& VulkanBindingGroup::getBufferAccesses() const
+{
+    return m_bufferAccesses;
+}
+
+size_t VulkanBindingGroupCache::Functor::operator()(const std::string& key) const
+{
+    return hashBytes(key.data(), key.size());
+}
+
+VulkanBindingGroupCache::VulkanBindingGroupCache(VulkanDevice& device)
+    : m_device(device)
+{
+}
+
+VulkanSharedDescriptorSet VulkanBindingGroupCache::getDescriptorSet(const VulkanBindingGroupDescriptor& descriptor,
+                                                                    const std::function<VulkanSharedDescriptorSet()>& create)
+{
+    std::vector<uint64_t> handles{};
+    std::string key = generateBindingGroupKey(descriptor, handles);
+
+    auto it = m_cache.find(key);
+    if (it != m_cache.end())
+    {
+        if (auto descriptorSet = it->second.descriptorSet.lock())
+        {
+            ++m_statistics.hits;
+            return descriptorSet;
+        }
+
+        // all binding groups which shared it are destroyed.
+        erase(it);
+    }
+
+    ++m_statistics.misses;
+
+    const auto begin = std::chrono::steady_clock::now();
+    VulkanSharedDescriptorSet descriptorSet = create();
+    m_statistics.creationTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    if (m_cache.size() >= m_purgeSize)
+    {
+        for (auto it = m_cache.begin(); it != m_cache.end();)
+            it = it->second.descriptorSet.expired() ? erase(it) : std::next(it);
+        m_purgeSize = std::max(m_purgeSize, m_cache.size() * 2);
+    }
+
+    // a resource can be bound to several bindings, but the key is indexed once for it.
+    std::sort(handles.begin(), handles.end());
+    handles.erase(std::unique(handles.begin(), handles.end()), handles.end());
+
+    auto [inserted, _] = m_cache.emplace(std::move(key), Entry{ .descriptorSet = descriptorSet, .handles = std::move(handles) });
+    for (auto handle : inserted->second.handles)
+        m_keys[handle].push_back(&inserted->first);
+
+    return descriptorSet;
+}
+
+VulkanBindingGroupCache::Cache::iterator VulkanBindingGroupCache::erase(Cache::iterator it)
+{
+    for (auto handle : it->second.handles)
+    {
+        auto keys = m_keys.find(handle);
+        if (keys == m_keys.end())
+            continue;
+
+        std::erase(keys->second, &it->first);
+        if (keys->second.empty())
+            m_keys.erase(keys);
+    }
+
+    return m_cache.erase(it);
+}
+
+void VulkanBindingGroupCache::invalidateHandle(uint64_t handle)
+{
+    auto keys = m_keys.find(handle);
+    if (keys == m_keys.end())
+        return;
+
+    // binding groups which already have the descriptor set keep it. only new requests miss.
+    const std::vector<const std::string*> invalidated = std::move(keys->second);
+    m_keys.erase(keys);
+
+    for (const auto* key : invalidated)
+    {
+        auto it = m_cache.find(*key);
+        if (it == m_cache.end())
+            continue;
+
+        erase(it);
+        ++m_statistics.evictions;
+    }
+}
+
+void VulkanBindingGroupCache::clear()
+{
+    m_keys.clear();
+    m_cache.clear();
+}
+
+CacheStatistics VulkanBindingGroupCache::getStatistics() const
+{
+    CacheStatistics statistics = m_statistics;
+    statistics.entries = m_cache.size();
+
+    return statistics;
+}
+
+void VulkanBindingGroupCache::resetStatistics()
+{
+    m_statistics = CacheStatistics{ .name = m_statistics.name };
+}
+
+} // namespace jipu
@@ -3,10 +3,19 @@
 #include "export.h"
 
 #include "jipu/binding_group.h"
+#include "jipu/device.h"
 #include "utils/cast.h"
 #include "vulkan_api.h"
+#include "vulkan_buffer_tracker.h"
+#include "vulkan_descriptor_allocator.h"
 #include "vulkan_export.h"
 
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
 namespace jipu
 {
 
@@ -16,10 +25,15 @@ struct VulkanBindingGroupDescriptor
     std::vector<VkDescriptorBufferInfo> buffers{};
     std::vector<VkDescriptorImageInfo> samplers{};
     std::vector<VkDescriptorImageInfo> textures{};
+    VulkanDescriptorAllocator* allocator = nullptr; // use device descriptor allocator if nullptr.
+    bool cached = false;                            // share descriptor set with binding groups which have same layout and resources.
 };
 
+/// @brief descriptor set freed when the last binding group which uses it is destroyed.
+using VulkanSharedDescriptorSet = std::shared_ptr<const VulkanDescriptorSetAllocation>;
+
 class VulkanDevice;
-class VULKAN_EXPORT VulkanBindingGroup : public BindingGroup
+class VULKAN_EXPORT VulkanBindingGroup final : public BindingGroup
 {
 public:
     VulkanBindingGroup() = delete;
@@ -28,9 +42,16 @@ public:
     ~VulkanBindingGroup() override;
 
     VkDescriptorSet getVkDescriptorSet() const;
+    /// @brief buffer ranges which are accessed by shaders of all stages in the layout.
+    const std::vector<VulkanBufferAccess>& getBufferAccesses() const;
+
+private:
+    VulkanSharedDescriptorSet createDescriptorSet(VulkanDescriptorAllocator& allocator);
 
 private:
     VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+    VulkanSharedDescriptorSet m_sharedDescriptorSet = nullptr;
+    std::vector<VulkanBufferAccess> m_bufferAccesses{};
 
 private:
     VulkanDevice& m_device;
@@ -41,7 +62,64 @@ public:
 };
 DOWN_CAST(VulkanBindingGroup, BindingGroup);
 
+class VULKAN_EXPORT VulkanBindingGroupCache final
+{
+public:
+    VulkanBindingGroupCache(VulkanDevice& device);
+    ~VulkanBindingGroupCache() = default;
+
+    /// @brief get the descriptor set which has same layout and resources. it is created by the callback if there is not.
+    VulkanSharedDescriptorSet getDescriptorSet(const VulkanBindingGroupDescriptor& descriptor,
+                                               const std::function<VulkanSharedDescriptorSet()>& create);
+
+    /// @brief remove descriptor sets which reference the handle of buffer, sampler, image view or descriptor set layout.
+    template <typename Handle>
+    void invalidate(Handle handle)
+    {
+        if constexpr (std::is_pointer_v<Handle>)
+            invalidateHandle(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle)));
+        else
+            invalidateHandle(static_cast<uint64_t>(handle));
+    }
+    void clear();
+
+    CacheStatistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    void invalidateHandle(uint64_t handle);
+
+private:
+    VulkanDevice& m_device;
+    CacheStatistics m_statistics{ .name = "Binding Group" };
+
+private:
+    struct Entry
+    {
+        std::weak_ptr<const VulkanDescriptorSetAllocation> descriptorSet{};
+        std::vector<uint64_t> handles{};
+    };
+    struct Functor
+    {
+        size_t operator()(const std::string& key) const;
+    };
+    using Cache = std::unordered_map<std::string, Entry, Functor>;
+
+    Cache::iterator erase(Cache::iterator it);
+
+    Cache m_cache{};
+    /// @brief keys of the entries which reference the handle. keys are owned by the nodes of the cache.
+    std::unordered_map<uint64_t, std::vector<const std::string*>> m_keys{};
+
+    /// @brief expired entries are removed when the cache grows over this size.
+    size_t m_purgeSize = 64;
+};
+
 // Generate Helper
 VulkanBindingGroupDescriptor VULKAN_EXPORT generateVulkanBindingGroupDescriptor(const BindingGroupDescriptor& descriptor);
+/// @brief writes point to the infos of the descriptor. descriptor set is ignored by push descriptors.
+std::vector<VkWriteDescriptorSet> VULKAN_EXPORT generateVkWriteDescriptorSets(const VulkanBindingGroupDescriptor& descriptor, VkDescriptorSet descriptorSet);
+/// @brief ranges of dynamic bindings are to the end of the buffer, because offsets are given when they are bound.
+std::vector<VulkanBufferAccess> VULKAN_EXPORT generateVulkanBufferAccesses(const VulkanBindingGroupDescriptor& descriptor);
 
 } // namespace jipu
\ No newline at end of file
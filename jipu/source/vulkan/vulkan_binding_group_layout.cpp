@@ -1,7 +1,10 @@
 #include "vulkan_binding_group_layout.h"
 #include "vulkan_device.h"
+#include "vulkan_physical_device.h"
 
+#include <algorithm>
 #include <fmt/format.h>
+#include <map>
 #include <stdexcept>
 
 namespace jipu
@@ -10,14 +13,19 @@ namespace jipu
 VulkanBindingGroupLayoutDescriptor generateVulkanBindingGroupLayoutDescriptor(const BindingGroupLayoutDescriptor& descriptor)
 {
     VulkanBindingGroupLayoutDescriptor vkdescriptor{};
+    if (descriptor.pushDescriptor)
+        vkdescriptor.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
 
     const uint64_t bufferSize = descriptor.buffers.size();
     const uint64_t samplerSize = descriptor.samplers.size();
     const uint64_t textureSize = descriptor.textures.size();
+    const uint64_t inputAttachmentSize = descriptor.inputAttachments.size();
 
     vkdescriptor.buffers.resize(bufferSize);
+    vkdescriptor.bufferAccesses.resize(bufferSize);
     vkdescriptor.samplers.resize(samplerSize);
-    vkdescriptor.textures.resize(textureSize);
+    // input attachments are image descriptors written after textures.
+    vkdescriptor.textures.resize(textureSize + inputAttachmentSize);
 
     for (uint64_t i = 0; i < bufferSize; ++i)
     {
@@ -27,6 +35,7 @@ VulkanBindingGroupLayoutDescriptor generateVulkanBindingGroupLayoutDescriptor(co
                                     .descriptorCount = 1,
                                     .stageFlags = ToVkShaderStageFlags(buffer.stages),
                                     .pImmutableSamplers = nullptr };
+        vkdescriptor.bufferAccesses[i] = ToVkAccessFlags2(buffer.type);
     }
 
     for (uint64_t i = 0; i < samplerSize; ++i)
@@ -49,6 +58,16 @@ VulkanBindingGroupLayoutDescriptor generateVulkanBindingGroupLayoutDescriptor(co
                                      .pImmutableSamplers = nullptr };
     }
 
+    for (uint64_t i = 0; i < inputAttachmentSize; ++i)
+    {
+        const auto& inputAttachment = descriptor.inputAttachments[i];
+        vkdescriptor.textures[textureSize + i] = { .binding = inputAttachment.index,
+                                                   .descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
+                                                   .descriptorCount = 1,
+                                                   .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+                                                   .pImmutableSamplers = nullptr };
+    }
+
     return vkdescriptor;
 }
 
@@ -61,12 +80,19 @@ VulkanBindingGroupLayout::VulkanBindingGroupLayout(VulkanDevice& device, const V
     : m_device(device)
     , m_descriptor(descriptor)
 {
+    if (isPushDescriptor() && !device.getPhysicalDevice().getVulkanPhysicalDeviceInfo().pushDescriptor)
+    {
+        throw std::runtime_error("Push descriptor is not supported.");
+    }
+
     std::vector<VkDescriptorSetLayoutBinding> bindings{};
     bindings.insert(bindings.end(), m_descriptor.buffers.begin(), m_descriptor.buffers.end());
     bindings.insert(bindings.end(), m_descriptor.samplers.begin(), m_descriptor.samplers.end());
     bindings.insert(bindings.end(), m_descriptor.textures.begin(), m_descriptor.textures.end());
 
     VkDescriptorSetLayoutCreateInfo layoutCreateInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                                                      .pNext = m_descriptor.next,
+                                                      .flags = m_descriptor.flags,
                                                       .bindingCount = static_cast<uint32_t>(bindings.size()),
                                                       .pBindings = bindings.data() };
 
@@ -76,15 +102,90 @@ VulkanBindingGroupLayout::VulkanBindingGroupLayout(VulkanDevice& device, const V
     {
         throw std::runtime_error("Failed to create VkDescriptorSetLayout");
     }
+
+    // sorted by type to share pools between layouts which have same descriptor counts.
+    std::map<VkDescriptorType, uint32_t> descriptorCounts{};
+    for (const auto& binding : bindings)
+    {
+        descriptorCounts[binding.descriptorType] += binding.descriptorCount;
+    }
+
+    for (const auto& [type, count] : descriptorCounts)
+    {
+        m_descriptorPoolSizes.push_back({ .type = type, .descriptorCount = count });
+    }
+
+    // push descriptor layouts are not used to allocate sets.
+    if (device.getPhysicalDevice().getVulkanPhysicalDeviceInfo().descriptorUpdateTemplate && !isPushDescriptor())
+        createDescriptorUpdateTemplate();
 }
 
 VulkanBindingGroupLayout::~VulkanBindingGroupLayout()
 {
     auto& vulkanDevice = downcast(m_device);
+    vulkanDevice.getBindingGroupCache().invalidate(m_descriptorSetLayout);
+    if (m_descriptorUpdateTemplate != VK_NULL_HANDLE)
+        vulkanDevice.vkAPI.DestroyDescriptorUpdateTemplate(vulkanDevice.getVkDevice(), m_descriptorUpdateTemplate, nullptr);
     vulkanDevice.vkAPI.DestroyDescriptorSetLayout(vulkanDevice.getVkDevice(), m_descriptorSetLayout, nullptr);
 }
 
-std::vector<VkDescriptorSetLayoutBinding> VulkanBindingGroupLayout::getBufferBindingLayouts() const
+void VulkanBindingGroupLayout::createDescriptorUpdateTemplate()
+{
+    // binding groups write one descriptor per binding. arrays are written one by one.
+    auto isArray = [](const VkDescriptorSetLayoutBinding& binding) { return binding.descriptorCount != 1; };
+    if (std::any_of(m_descriptor.buffers.begin(), m_descriptor.buffers.end(), isArray) ||
+        std::any_of(m_descriptor.samplers.begin(), m_descriptor.samplers.end(), isArray) ||
+        std::any_of(m_descriptor.textures.begin(), m_descriptor.textures.end(), isArray))
+        return;
+
+    const uint64_t bufferSize = m_descriptor.buffers.size();
+    const uint64_t samplerSize = m_descriptor.samplers.size();
+    const uint64_t textureSize = m_descriptor.textures.size();
+
+    std::vector<VkDescriptorUpdateTemplateEntry> entries{};
+    entries.reserve(bufferSize + samplerSize + textureSize);
+
+    size_t offset = 0;
+    auto addEntries = [&](const std::vector<VkDescriptorSetLayoutBinding>& bindings, size_t stride) {
+        for (const auto& binding : bindings)
+        {
+            entries.push_back({ .dstBinding = binding.binding,
+                                .dstArrayElement = 0,
+                                .descriptorCount = 1,
+                                .descriptorType = binding.descriptorType,
+                                .offset = offset,
+                                .stride = stride });
+            offset += stride;
+        }
+    };
+
+    addEntries(m_descriptor.buffers, sizeof(VkDescriptorBufferInfo));
+    addEntries(m_descriptor.samplers, sizeof(VkDescriptorImageInfo));
+    addEntries(m_descriptor.textures, sizeof(VkDescriptorImageInfo));
+
+    if (entries.empty())
+        return;
+
+    VkDescriptorUpdateTemplateCreateInfo createInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+                                                     .pNext = nullptr,
+                                                     .flags = 0,
+                                                     .descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size()),
+                                                     .pDescriptorUpdateEntries = entries.data(),
+                                                     .templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+                                                     .descriptorSetLayout = m_descriptorSetLayout,
+                                                     .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                                     .pipelineLayout = VK_NULL_HANDLE,
+                                                     .set = 0 };
+
+    auto& vulkanDevice = downcast(m_device);
+    VkResult result = vulkanDevice.vkAPI.CreateDescriptorUpdateTemplate(vulkanDevice.getVkDevice(), &createInfo, nullptr, &m_descriptorUpdateTemplate);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(fmt::format("Failed to create VkDescriptorUpdateTemplate. {}", static_cast<int32_t>(result)));
+    }
+}
+
+const std::vector<VkDescriptorSetLayoutBinding>& VulkanBindingGroupLayout::getBufferBindingLayouts() const
 {
     return m_descriptor.buffers;
 }
@@ -100,7 +201,15 @@ VkDescriptorSetLayoutBinding VulkanBindingGroupLayout::getBufferBindingLayout(ui
     return m_descriptor.buffers[index];
 }
 
-std::vector<VkDescriptorSetLayoutBinding> VulkanBindingGroupLayout::getSamplerBindingLayouts() const
+VkAccessFlags2 VulkanBindingGroupLayout::getBufferAccessFlags(uint32_t index) const
+{
+    if (index < m_descriptor.bufferAccesses.size())
+        return m_descriptor.bufferAccesses[index];
+
+    return ToVkAccessFlags2(getBufferBindingLayout(index).descriptorType);
+}
+
+const std::vector<VkDescriptorSetLayoutBinding>& VulkanBindingGroupLayout::getSamplerBindingLayouts() const
 {
     return m_descriptor.samplers;
 }
@@ -116,7 +225,7 @@ VkDescriptorSetLayoutBinding VulkanBindingGroupLayout::getSamplerBindingLayout(u
     return m_descriptor.samplers[index];
 }
 
-std::vector<VkDescriptorSetLayoutBinding> VulkanBindingGroupLayout::getTextureBindingLayouts() const
+const std::vector<VkDescriptorSetLayoutBinding>& VulkanBindingGroupLayout::getTextureBindingLayouts() const
 {
     return m_descriptor.textures;
 }
@@ -137,6 +246,21 @@ VkDescriptorSetLayout VulkanBindingGroupLayout::getVkDescriptorSetLayout() const
     return m_descriptorSetLayout;
 }
 
+bool VulkanBindingGroupLayout::isPushDescriptor() const
+{
+    return (m_descriptor.flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR) != 0;
+}
+
+VkDescriptorUpdateTemplate VulkanBindingGroupLayout::getVkDescriptorUpdateTemplate() const
+{
+    return m_descriptorUpdateTemplate;
+}
+
+const std::vector<VkDescriptorPoolSize>& VulkanBindingGroupLayout::getDescriptorPoolSizes() const
+{
+    return m_descriptorPoolSizes;
+}
+
 // Convert Helper
 VkDescriptorType ToVkDescriptorType(BufferBindingType type, bool dynamicOffset)
 {
@@ -149,6 +273,7 @@ VkDescriptorType ToVkDescriptorType(BufferBindingType type, bool dynamicOffset)
             return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     }
     case BufferBindingType::kStorage:
+    case BufferBindingType::kReadOnlyStorage:
         if (dynamicOffset)
             return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
         else
@@ -194,6 +319,58 @@ VkShaderStageFlags ToVkShaderStageFlags(BindingStageFlags flags)
     return vkFlags;
 }
 
+VkPipelineStageFlags2 ToVkPipelineStageFlags2(VkShaderStageFlags flags)
+{
+    VkPipelineStageFlags2 vkFlags = VK_PIPELINE_STAGE_2_NONE;
+
+    if (flags & VK_SHADER_STAGE_VERTEX_BIT)
+    {
+        vkFlags |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT;
+    }
+    if (flags & VK_SHADER_STAGE_FRAGMENT_BIT)
+    {
+        vkFlags |= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    }
+    if (flags & VK_SHADER_STAGE_COMPUTE_BIT)
+    {
+        vkFlags |= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    }
+
+    return vkFlags;
+}
+
+// only the access bits which have legacy equivalents are used, so they can be recorded without synchronization2.
+VkAccessFlags2 ToVkAccessFlags2(BufferBindingType type)
+{
+    switch (type)
+    {
+    case BufferBindingType::kUniform:
+        return VK_ACCESS_2_UNIFORM_READ_BIT;
+    case BufferBindingType::kStorage:
+        return VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+    case BufferBindingType::kReadOnlyStorage:
+        return VK_ACCESS_2_SHADER_READ_BIT;
+    default:
+    case BufferBindingType::kUndefined:
+        return VK_ACCESS_2_NONE;
+    }
+}
+
+VkAccessFlags2 ToVkAccessFlags2(VkDescriptorType type)
+{
+    switch (type)
+    {
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        return VK_ACCESS_2_UNIFORM_READ_BIT;
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+        return VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+    default:
+        return VK_ACCESS_2_NONE;
+    }
+}
+
 BindingStageFlags ToBindingStageFlags(VkShaderStageFlags vkFlags)
 {
     BindingStageFlags flags = 0u;
@@ -15,10 +15,12 @@ struct VulkanBindingGroupLayoutDescriptor
     std::vector<VkDescriptorSetLayoutBinding> buffers{};
     std::vector<VkDescriptorSetLayoutBinding> samplers{};
     std::vector<VkDescriptorSetLayoutBinding> textures{};
+    /// @brief accesses of buffer bindings by shaders. derived from the descriptor types if empty.
+    std::vector<VkAccessFlags2> bufferAccesses{};
 };
 
 class VulkanDevice;
-class VULKAN_EXPORT VulkanBindingGroupLayout : public BindingGroupLayout
+class VULKAN_EXPORT VulkanBindingGroupLayout final : public BindingGroupLayout
 {
 public:
     VulkanBindingGroupLayout() = delete;
@@ -35,19 +37,34 @@ public:
     // const std::vector<TextureBindingLayout>& getTextureBindingLayouts() const;
     // std::optional<TextureBindingLayout> getTextureBindingLayout(uint32_t index) const;
 
-    std::vector<VkDescriptorSetLayoutBinding> getBufferBindingLayouts() const;
+    const std::vector<VkDescriptorSetLayoutBinding>& getBufferBindingLayouts() const;
     VkDescriptorSetLayoutBinding getBufferBindingLayout(uint32_t index) const;
+    VkAccessFlags2 getBufferAccessFlags(uint32_t index) const;
 
-    std::vector<VkDescriptorSetLayoutBinding> getSamplerBindingLayouts() const;
+    const std::vector<VkDescriptorSetLayoutBinding>& getSamplerBindingLayouts() const;
     VkDescriptorSetLayoutBinding getSamplerBindingLayout(uint32_t index) const;
 
-    std::vector<VkDescriptorSetLayoutBinding> getTextureBindingLayouts() const;
+    const std::vector<VkDescriptorSetLayoutBinding>& getTextureBindingLayouts() const;
     VkDescriptorSetLayoutBinding getTextureBindingLayout(uint32_t index) const;
 
     VkDescriptorSetLayout getVkDescriptorSetLayout() const;
 
+    /// @brief descriptor counts per type for a set of this layout.
+    const std::vector<VkDescriptorPoolSize>& getDescriptorPoolSizes() const;
+
+    bool isPushDescriptor() const;
+
+    /// @brief template to write a set from packed buffer infos, sampler infos and texture infos in binding order.
+    /// @return null handle if it is not supported or the layout has array bindings.
+    VkDescriptorUpdateTemplate getVkDescriptorUpdateTemplate() const;
+
+private:
+    void createDescriptorUpdateTemplate();
+
 private:
     VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorUpdateTemplate m_descriptorUpdateTemplate = VK_NULL_HANDLE;
+    std::vector<VkDescriptorPoolSize> m_descriptorPoolSizes{};
 
 private:
     VulkanDevice& m_device;
@@ -62,5 +79,8 @@ VulkanBindingGroupLayoutDescriptor VULKAN_EXPORT generateVulkanBindingGroupLayou
 VkDescriptorType ToVkDescriptorType(BufferBindingType type, bool dynamicOffset = false);
 BufferBindingType ToBufferBindingType(VkDescriptorType type);
 VkShaderStageFlags ToVkShaderStageFlags(BindingStageFlags flags);
+VkPipelineStageFlags2 ToVkPipelineStageFlags2(VkShaderStageFlags flags);
+VkAccessFlags2 ToVkAccessFlags2(BufferBindingType type);
+VkAccessFlags2 ToVkAccessFlags2(VkDescriptorType type);
 BindingStageFlags ToBindingStageFlags(VkShaderStageFlags flags);
 } // namespace jipu
\ No newline at end of file
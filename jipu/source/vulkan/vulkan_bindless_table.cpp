@@ -0,0 +1,213 @@
+#include "vulkan_bindless_table.h"
+#include "vulkan_buffer.h"
+#include "vulkan_device.h"
+#include "vulkan_physical_device.h"
+#include "vulkan_sampler.h"
+#include "vulkan_texture.h"
+#include "vulkan_texture_view.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+namespace jipu
+{
+
+VulkanBindlessTable::VulkanBindlessTable(VulkanDevice& device, const VulkanBindlessTableDescriptor& descriptor)
+    : m_device(device)
+{
+    const auto& physicalDeviceInfo = device.getPhysicalDevice().getVulkanPhysicalDeviceInfo();
+    if (!physicalDeviceInfo.descriptorIndexing)
+    {
+        throw std::runtime_error("Bindless table requires descriptor indexing.");
+    }
+
+    const auto& properties = physicalDeviceInfo.descriptorIndexingProperties;
+    m_textures.count = std::min({ descriptor.textureCount,
+                                  properties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                  properties.maxPerStageDescriptorUpdateAfterBindSampledImages });
+    m_samplers.count = std::min({ descriptor.samplerCount,
+                                  properties.maxDescriptorSetUpdateAfterBindSamplers,
+                                  properties.maxPerStageDescriptorUpdateAfterBindSamplers });
+    m_buffers.count = std::min({ descriptor.bufferCount,
+                                 properties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                                 properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+
+    // sampled images and storage buffers share the per stage resource limit. samplers are not counted.
+    if (m_textures.count + m_buffers.count > properties.maxPerStageUpdateAfterBindResources)
+    {
+        m_textures.count = properties.maxPerStageUpdateAfterBindResources - std::min(m_buffers.count, properties.maxPerStageUpdateAfterBindResources);
+    }
+
+    spdlog::debug("Bindless table textures: {}, samplers: {}, buffers: {}", m_textures.count, m_samplers.count, m_buffers.count);
+
+    VulkanDescriptorAllocatorDescriptor allocatorDescriptor{ .initialSetCount = 1,
+                                                             .maxSetCount = 1,
+                                                             .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT };
+    m_allocator = std::make_unique<VulkanDescriptorAllocator>(device, allocatorDescriptor);
+
+    const VkShaderStageFlags stages = ToVkShaderStageFlags(BindingStageFlagBits::kVertexStage |
+                                                           BindingStageFlagBits::kFragmentStage |
+                                                           BindingStageFlagBits::kComputeStage);
+
+    // slots which are not added yet or removed are never accessed, so the arrays are partially bound.
+    const VkDescriptorBindingFlagsEXT bindingFlag = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                                    VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                                    VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+    const std::vector<VkDescriptorBindingFlagsEXT> bindingFlags(3, bindingFlag);
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsCreateInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+                                                                           .pNext = nullptr,
+                                                                           .bindingCount = static_cast<uint32_t>(bindingFlags.size()),
+                                                                           .pBindingFlags = bindingFlags.data() };
+
+    VulkanBindingGroupLayoutDescriptor layoutDescriptor{};
+    layoutDescriptor.next = &bindingFlagsCreateInfo;
+    layoutDescriptor.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    layoutDescriptor.buffers = { { .binding = BindlessBinding::kBuffers,
+                                   .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                   .descriptorCount = m_buffers.count,
+                                   .stageFlags = stages,
+                                   .pImmutableSamplers = nullptr } };
+    layoutDescriptor.samplers = { { .binding = BindlessBinding::kSamplers,
+                                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+                                    .descriptorCount = m_samplers.count,
+                                    .stageFlags = stages,
+                                    .pImmutableSamplers = nullptr } };
+    layoutDescriptor.textures = { { .binding = BindlessBinding::kTextures,
+                                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                                    .descriptorCount = m_textures.count,
+                                    .stageFlags = stages,
+                                    .pImmutableSamplers = nullptr } };
+    m_layout = std::make_unique<VulkanBindingGroupLayout>(device, layoutDescriptor);
+
+    // descriptors are written one by one when resources are added.
+    VulkanBindingGroupDescriptor bindingGroupDescriptor{ .layout = *m_layout };
+    bindingGroupDescriptor.allocator = m_allocator.get();
+    m_bindingGroup = std::make_unique<VulkanBindingGroup>(device, bindingGroupDescriptor);
+}
+
+VulkanBindlessTable::~VulkanBindlessTable()
+{
+    m_bindingGroup.reset();
+    m_layout.reset();
+    m_allocator.reset();
+}
+
+uint32_t VulkanBindlessTable::addTexture(const TextureView& textureView)
+{
+    auto& vulkanTextureView = downcast(textureView);
+    auto vulkanTexture = downcast(vulkanTextureView.getTexture());
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageView = vulkanTextureView.getVkImageView();
+    imageInfo.imageLayout = vulkanTexture->getFinalLayout();
+
+    const uint32_t index = acquire(m_textures, "texture");
+    write(BindlessBinding::kTextures, index, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, &imageInfo, nullptr);
+
+    return index;
+}
+
+uint32_t VulkanBindlessTable::addSampler(const Sampler& sampler)
+{
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = downcast(sampler).getVkSampler();
+
+    const uint32_t index = acquire(m_samplers, "sampler");
+    write(BindlessBinding::kSamplers, index, VK_DESCRIPTOR_TYPE_SAMPLER, &imageInfo, nullptr);
+
+    return index;
+}
+
+uint32_t VulkanBindlessTable::addBuffer(const Buffer& buffer, uint64_t offset, uint64_t size)
+{
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = downcast(buffer).getVkBuffer();
+    bufferInfo.offset = offset;
+    bufferInfo.range = size == 0 ? VK_WHOLE_SIZE : size;
+
+    const uint32_t index = acquire(m_buffers, "buffer");
+    write(BindlessBinding::kBuffers, index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &bufferInfo);
+
+    return index;
+}
+
+void VulkanBindlessTable::removeTexture(uint32_t index)
+{
+    release(m_textures, index, "texture");
+}
+
+void VulkanBindlessTable::removeSampler(uint32_t index)
+{
+    release(m_samplers, index, "sampler");
+}
+
+void VulkanBindlessTable::removeBuffer(uint32_t index)
+{
+    release(m_buffers, index, "buffer");
+}
+
+BindingGroupLayout& VulkanBindlessTable::getBindingGroupLayout()
+{
+    return *m_layout;
+}
+
+BindingGroup& VulkanBindlessTable::getBindingGroup()
+{
+    return *m_bindingGroup;
+}
+
+uint32_t VulkanBindlessTable::acquire(Slots& slots, const char* name)
+{
+    // descriptors are updated while sets are bound, so a removed index is reused after submissions which may read it are completed.
+    if (!slots.freeIndices.empty() && slots.freeIndices.front().second <= m_device.getCompletedSerial())
+    {
+        const uint32_t index = slots.freeIndices.front().first;
+        slots.freeIndices.pop_front();
+        slots.used[index] = true;
+        return index;
+    }
+
+    if (slots.next >= slots.count)
+    {
+        throw std::runtime_error(fmt::format("Bindless {} table is full. count: {}, removed in pending submissions: {}", name, slots.count, slots.freeIndices.size()));
+    }
+
+    slots.used.push_back(true);
+    return slots.next++;
+}
+
+void VulkanBindlessTable::release(Slots& slots, uint32_t index, const char* name)
+{
+    // an index which is removed twice would be returned by two adds.
+    if (index >= slots.next || !slots.used[index])
+    {
+        throw std::runtime_error(fmt::format("Failed to remove bindless {} which is not added. index: {}", name, index));
+    }
+
+    // stale descriptor is left in the slot. commands recorded until now are submitted with the pending serial at the latest.
+    slots.used[index] = false;
+    slots.freeIndices.push_back({ index, m_device.getPendingSerial() });
+}
+
+void VulkanBindlessTable::write(uint32_t binding, uint32_t index, VkDescriptorType type, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo)
+{
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_bindingGroup->getVkDescriptorSet();
+    descriptorWrite.dstBinding = binding;
+    descriptorWrite.dstArrayElement = index;
+    descriptorWrite.descriptorType = type;
+    descriptorWrite.descriptorCount = 1;
+
+    descriptorWrite.pBufferInfo = bufferInfo;
+    descriptorWrite.pImageInfo = imageInfo;
+    descriptorWrite.pTexelBufferView = nullptr;
+
+    // update after bind. the set can be updated while it is bound in recorded command buffers.
+    m_device.vkAPI.UpdateDescriptorSets(m_device.getVkDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+} // namespace jipu
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "jipu/bindless_table.h"
+#include "utils/cast.h"
+#include "vulkan_api.h"
+#include "vulkan_binding_group.h"
+#include "vulkan_binding_group_layout.h"
+#include "vulkan_descriptor_allocator.h"
+#include "vulkan_export.h"
+
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace jipu
+{
+
+struct VulkanBindlessTableDescriptor
+{
+    /// @brief array sizes. they are clamped to the update after bind limits of the device.
+    uint32_t textureCount = 16384;
+    uint32_t samplerCount = 256;
+    uint32_t bufferCount = 4096;
+};
+
+class VulkanDevice;
+class VULKAN_EXPORT VulkanBindlessTable final : public BindlessTable
+{
+public:
+    VulkanBindlessTable() = delete;
+    VulkanBindlessTable(VulkanDevice& device, const VulkanBindlessTableDescriptor& descriptor);
+    ~VulkanBindlessTable() override;
+
+    VulkanBindlessTable(const VulkanBindlessTable&) = delete;
+    VulkanBindlessTable& operator=(const VulkanBindlessTable&) = delete;
+
+public:
+    uint32_t addTexture(const TextureView& textureView) override;
+    uint32_t addSampler(const Sampler& sampler) override;
+    uint32_t addBuffer(const Buffer& buffer, uint64_t offset = 0, uint64_t size = 0) override;
+
+    void removeTexture(uint32_t index) override;
+    void removeSampler(uint32_t index) override;
+    void removeBuffer(uint32_t index) override;
+
+    BindingGroupLayout& getBindingGroupLayout() override;
+    BindingGroup& getBindingGroup() override;
+
+private:
+    struct Slots
+    {
+        uint32_t count = 0;
+        uint32_t next = 0;
+        /// @brief removed indexes and the serials of submissions which may read them, in removal order.
+        std::deque<std::pair<uint32_t, uint64_t>> freeIndices{};
+        /// @brief whether the index is added. indexes up to next.
+        std::vector<bool> used{};
+    };
+
+    uint32_t acquire(Slots& slots, const char* name);
+    void release(Slots& slots, uint32_t index, const char* name);
+    void write(uint32_t binding, uint32_t index, VkDescriptorType type, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo);
+
+private:
+    VulkanDevice& m_device;
+
+    Slots m_textures{};
+    Slots m_samplers{};
+    Slots m_buffers{};
+
+    // destroyed in reverse order. binding group frees its set to the allocator.
+    std::unique_ptr<VulkanDescriptorAllocator> m_allocator = nullptr;
+    std::unique_ptr<VulkanBindingGroupLayout> m_layout = nullptr;
+    std::unique_ptr<VulkanBindingGroup> m_bindingGroup = nullptr;
+};
+DOWN_CAST(VulkanBindlessTable, BindlessTable);
+
+} // namespace jipu
@@ -1,5 +1,4 @@
 #include "vulkan_buffer.h"
-#include "vulkan_command_buffer.h"
 #include "vulkan_device.h"
 #include "vulkan_physical_device.h"
 #include "vulkan_resource_allocator.h"
@@ -39,6 +38,14 @@ VulkanBuffer::~VulkanBuffer()
 {
     unmap();
 
+    // descriptor sets must not be shared for a recycled handle.
+    downcast(m_device).getBindingGroupCache().invalidate(m_resource.buffer);
+    {
+        // submitted states must not be inherited by a recycled handle.
+        std::lock_guard<std::mutex> lock(downcast(m_device).getQueueMutex());
+        downcast(m_device).getSubmittedBufferTracker().remove(m_resource.buffer);
+    }
+
     auto& vulkanResourceAllocator = downcast(m_device).getResourceAllocator();
     vulkanResourceAllocator.destroyBuffer(m_resource);
 }
@@ -74,95 +81,18 @@ uint64_t VulkanBuffer::getSize() const
     return m_descriptor.size;
 }
 
-void VulkanBuffer::setTransition(CommandBuffer& commandBuffer, VkPipelineStageFlags flags)
-{
-    auto& vulkanDevice = downcast(m_device);
-    auto& vulkanCommandBuffer = downcast(commandBuffer);
-    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
-
-    VkBufferMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-    barrier.pNext = nullptr;
-    barrier.srcAccessMask = ToVkAccessFlags(m_descriptor.usage);
-    barrier.dstAccessMask = ToVkAccessFlags(m_descriptor.usage);
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.buffer = m_resource.buffer;
-    barrier.size = getSize();
-    barrier.offset = 0;
-
-    vkAPI.CmdPipelineBarrier(vulkanCommandBuffer.getVkCommandBuffer(), m_stageFlags, flags, 0, 0, nullptr, 1, &barrier, 0, nullptr);
-
-    m_stageFlags = flags;
-}
-
 VkBuffer VulkanBuffer::getVkBuffer() const
 {
     return m_resource.buffer;
 }
 
-// Convert Helper
-VkAccessFlags ToVkAccessFlags(BufferUsageFlags usage)
-{
-    VkAccessFlags vkFlags = 0x00000000; // 0x00000000
-
-    if (usage & BufferUsageFlagBits::kMapRead)
-    {
-        vkFlags |= VK_ACCESS_HOST_READ_BIT;
-    }
-    if (usage & BufferUsageFlagBits::kMapWrite)
-    {
-        vkFlags |= VK_ACCESS_HOST_WRITE_BIT;
-    }
-    if (usage & BufferUsageFlagBits::kCopySrc)
-    {
-        vkFlags |= VK_ACCESS_TRANSFER_READ_BIT;
-    }
-    if (usage & BufferUsageFlagBits::kCopyDst)
-    {
-        vkFlags |= VK_ACCESS_TRANSFER_WRITE_BIT;
-    }
-    if (usage & BufferUsageFlagBits::kIndex)
-    {
-        vkFlags |= VK_ACCESS_INDEX_READ_BIT;
-    }
-    if (usage & BufferUsageFlagBits::kVertex)
-    {
-        vkFlags |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
-    }
-    if (usage & BufferUsageFlagBits::kUniform)
-    {
-        vkFlags |= VK_ACCESS_UNIFORM_READ_BIT;
-    }
-
-    return vkFlags;
-}
-
-VkPipelineStageFlags ToVkPipelineStageFlags(BufferUsageFlags usage)
+void VulkanBuffer::flush(uint64_t offset, uint64_t size)
 {
-    VkPipelineStageFlags flags = 0;
-
-    if (usage & (BufferUsageFlagBits::kMapRead | BufferUsageFlagBits::kMapWrite))
-    {
-        flags |= VK_PIPELINE_STAGE_HOST_BIT;
-    }
-    if (usage & (BufferUsageFlagBits::kCopySrc | BufferUsageFlagBits::kCopyDst))
-    {
-        flags |= VK_PIPELINE_STAGE_TRANSFER_BIT;
-    }
-    if (usage & (BufferUsageFlagBits::kIndex | BufferUsageFlagBits::kVertex))
-    {
-        flags |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
-    }
-    if (usage & (BufferUsageFlagBits::kUniform | BufferUsageFlagBits::kStorage))
-    {
-        // TODO: set by shader stage.
-        flags |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-    }
-
-    return flags;
+    auto& resourceAllocator = downcast(m_device).getResourceAllocator();
+    resourceAllocator.flush(m_resource.allocation, offset, size);
 }
 
+// Convert Helper
 VkBufferUsageFlags ToVkBufferUsageFlags(BufferUsageFlags usages)
 {
     VkBufferUsageFlags vkUsages = 0x00000000;
@@ -195,6 +125,10 @@ VkBufferUsageFlags ToVkBufferUsageFlags(BufferUsageFlags usages)
     {
         vkUsages |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
     }
+    if (usages & BufferUsageFlagBits::kIndirect)
+    {
+        vkUsages |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    }
 
     // TODO: kMapRead, kMapWrite
 
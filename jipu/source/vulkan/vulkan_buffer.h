@@ -14,8 +14,7 @@ namespace jipu
 {
 
 class VulkanDevice;
-class CommandBuffer;
-class VULKAN_EXPORT VulkanBuffer : public Buffer
+class VULKAN_EXPORT VulkanBuffer final : public Buffer
 {
 public:
     VulkanBuffer() = delete;
@@ -29,13 +28,12 @@ public:
     uint64_t getSize() const override;
 
 public:
-    void setTransition(CommandBuffer& commandBuffer, VkPipelineStageFlags flags);
-
     VkBuffer getVkBuffer() const;
+    /// @brief make host writes to the mapped range visible to the device. it is required if the memory is not host coherent.
+    void flush(uint64_t offset, uint64_t size);
 
 private:
     VulkanBufferResource m_resource;
-    VkPipelineStageFlags m_stageFlags = 0u;
 
     void* m_mappedPtr = nullptr;
 
@@ -50,9 +48,7 @@ public:
 DOWN_CAST(VulkanBuffer, Buffer);
 
 // Convert Helper
-VkAccessFlags ToVkAccessFlags(BufferUsageFlags flags);
 VkBufferUsageFlags ToVkBufferUsageFlags(BufferUsageFlags usage);
-VkPipelineStageFlags ToVkPipelineStageFlags(BufferUsageFlags usage);
 
 // TODO: remove or remain.
 // BufferUsageFlags ToBufferUsageFlags(VkAccessFlags vkflags);
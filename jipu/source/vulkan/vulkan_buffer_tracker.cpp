@@ -0,0 +1,459 @@
+#include "vulkan_buffer_tracker.h"
+#include "vulkan_command_recorder.h"
+
+#include <algorithm>
+
+namespace jipu
+{
+
+namespace
+{
+
+constexpr VkAccessFlags2 kWriteAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT |
+                                            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+                                            VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                            VK_ACCESS_2_TRANSFER_WRITE_BIT |
+                                            VK_ACCESS_2_HOST_WRITE_BIT |
+                                            VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+VkDeviceSize getEnd(VkDeviceSize offset, VkDeviceSize size)
+{
+    return size == VK_WHOLE_SIZE ? UINT64_MAX : offset + size;
+}
+
+VkDeviceSize getSize(VkDeviceSize begin, VkDeviceSize end)
+{
+    return end == UINT64_MAX ? VK_WHOLE_SIZE : end - begin;
+}
+
+bool isWrite(const VulkanBufferAccess& access)
+{
+    return (access.accessMask & kWriteAccessMask) != 0;
+}
+
+bool isSameDependency(const VulkanBufferBarrier& lhs, const VulkanBufferBarrier& rhs)
+{
+    return lhs.srcStageMask == rhs.srcStageMask &&
+           lhs.srcAccessMask == rhs.srcAccessMask &&
+           lhs.dstStageMask == rhs.dstStageMask &&
+           lhs.dstAccessMask == rhs.dstAccessMask;
+}
+
+} // namespace
+
+VulkanBufferTracker::VulkanBufferTracker(bool synchronization2)
+    : m_synchronization2(synchronization2)
+{
+}
+
+void VulkanBufferTracker::access(const VulkanBufferAccess& access)
+{
+    if (access.buffer == VK_NULL_HANDLE || access.stageMask == VK_PIPELINE_STAGE_2_NONE || access.size == 0)
+        return;
+
+    m_accesses.push_back(access);
+}
+
+const std::vector<VulkanBufferBarrier>& VulkanBufferTracker::resolve()
+{
+    resolveAccesses(true);
+
+    m_resolvedBarriers.swap(m_barriers);
+    m_barriers.clear();
+
+    return m_resolvedBarriers;
+}
+
+void VulkanBufferTracker::flush(VulkanCommandRecorder& recorder)
+{
+    record(recorder, resolve());
+}
+
+void VulkanBufferTracker::record(VulkanCommandRecorder& recorder, const std::vector<VulkanBufferBarrier>& barriers)
+{
+    if (barriers.empty())
+        return;
+
+    if (m_synchronization2)
+    {
+        m_bufferMemoryBarriers2.clear();
+        for (const auto& barrier : barriers)
+        {
+            VkBufferMemoryBarrier2 bufferMemoryBarrier{ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
+            bufferMemoryBarrier.srcStageMask = barrier.srcStageMask;
+            bufferMemoryBarrier.srcAccessMask = barrier.srcAccessMask;
+            bufferMemoryBarrier.dstStageMask = barrier.dstStageMask;
+            bufferMemoryBarrier.dstAccessMask = barrier.dstAccessMask;
+            bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferMemoryBarrier.buffer = barrier.buffer;
+            bufferMemoryBarrier.offset = barrier.offset;
+            bufferMemoryBarrier.size = barrier.size;
+
+            m_bufferMemoryBarriers2.push_back(bufferMemoryBarrier);
+        }
+
+        VkDependencyInfo dependencyInfo{ .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferMemoryBarriers2.size());
+        dependencyInfo.pBufferMemoryBarriers = m_bufferMemoryBarriers2.data();
+
+        recorder.cmdPipelineBarrier2(dependencyInfo);
+    }
+    else
+    {
+        // flags of accesses have legacy equivalents with the same bits.
+        VkPipelineStageFlags srcStageMask = 0u;
+        VkPipelineStageFlags dstStageMask = 0u;
+
+        m_bufferMemoryBarriers.clear();
+        for (const auto& barrier : barriers)
+        {
+            VkBufferMemoryBarrier bufferMemoryBarrier{ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+            bufferMemoryBarrier.srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccessMask);
+            bufferMemoryBarrier.dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccessMask);
+            bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferMemoryBarrier.buffer = barrier.buffer;
+            bufferMemoryBarrier.offset = barrier.offset;
+            bufferMemoryBarrier.size = barrier.size;
+
+            m_bufferMemoryBarriers.push_back(bufferMemoryBarrier);
+
+            srcStageMask |= static_cast<VkPipelineStageFlags>(barrier.srcStageMask);
+            dstStageMask |= static_cast<VkPipelineStageFlags>(barrier.dstStageMask);
+        }
+
+        recorder.cmdPipelineBarrier(srcStageMask,
+                                    dstStageMask,
+                                    0,
+                                    0,
+                                    nullptr,
+                                    static_cast<uint32_t>(m_bufferMemoryBarriers.size()),
+                                    m_bufferMemoryBarriers.data(),
+                                    0,
+                                    nullptr);
+    }
+
+    ++m_statistics.barrierCommands;
+}
+
+void VulkanBufferTracker::track()
+{
+    resolveAccesses(false);
+}
+
+void VulkanBufferTracker::makeVisible(VkPipelineStageFlags2 stageMask, VkAccessFlags2 accessMask)
+{
+    for (auto& [buffer, ranges] : m_buffers)
+    {
+        for (auto& range : ranges)
+        {
+            if (range.writeStageMask == VK_PIPELINE_STAGE_2_NONE)
+                continue;
+
+            if ((stageMask & ~range.readStageMask) == 0 && (accessMask & ~range.readAccessMask) == 0)
+                continue;
+
+            range.readStageMask |= stageMask;
+            range.readAccessMask |= accessMask;
+
+            addBarrier({ .buffer = buffer,
+                         .offset = range.begin,
+                         .size = getSize(range.begin, range.end),
+                         .srcStageMask = range.writeStageMask,
+                         .srcAccessMask = range.writeAccessMask,
+                         .dstStageMask = range.readStageMask,
+                         .dstAccessMask = range.readAccessMask });
+        }
+    }
+}
+
+void VulkanBufferTracker::reset()
+{
+    m_buffers.clear();
+    m_accesses.clear();
+    m_firstAccesses.clear();
+    m_barriers.clear();
+    m_statistics = {};
+}
+
+const std::vector<VulkanBufferBarrier>& VulkanBufferTracker::submit(VulkanBufferTracker& commandBuffer)
+{
+    const auto statistics = m_statistics;
+
+    // accesses of the command buffer which depend on previous submissions are resolved as a command.
+    for (const auto& firstAccess : commandBuffer.m_firstAccesses)
+        access(firstAccess);
+    resolve();
+
+    // written ranges take the final states of the command buffer. others are only read by the first accesses,
+    // so the readers are already made visible by the barriers.
+    for (const auto& [buffer, ranges] : commandBuffer.m_buffers)
+    {
+        auto& submittedRanges = m_buffers[buffer];
+        for (const auto& range : ranges)
+        {
+            split(submittedRanges, range.begin, range.end);
+            for (auto& submittedRange : submittedRanges)
+            {
+                if (submittedRange.end <= range.begin)
+                    continue;
+                if (submittedRange.begin >= range.end)
+                    break;
+
+                if (range.writeStageMask != VK_PIPELINE_STAGE_2_NONE)
+                {
+                    submittedRange.writeStageMask = range.writeStageMask;
+                    submittedRange.writeAccessMask = range.writeAccessMask;
+                    submittedRange.readStageMask = range.readStageMask;
+                    submittedRange.readAccessMask = range.readAccessMask;
+                }
+                else
+                {
+                    submittedRange.readStageMask |= range.readStageMask;
+                    submittedRange.readAccessMask |= range.readAccessMask;
+                }
+            }
+        }
+        merge(submittedRanges);
+    }
+
+    // the submitted states have no first access.
+    m_firstAccesses.clear();
+
+    commandBuffer.m_statistics.memoryBarriers += m_statistics.memoryBarriers - statistics.memoryBarriers;
+    commandBuffer.m_statistics.executionBarriers += m_statistics.executionBarriers - statistics.executionBarriers;
+
+    return m_resolvedBarriers;
+}
+
+void VulkanBufferTracker::remove(VkBuffer buffer)
+{
+    m_buffers.erase(buffer);
+}
+
+const VulkanBufferTrackerStatistics& VulkanBufferTracker::getStatistics() const
+{
+    return m_statistics;
+}
+
+void VulkanBufferTracker::resolveAccesses(bool barrier)
+{
+    if (m_accesses.empty())
+        return;
+
+    for (const auto& access : m_accesses)
+        split(m_buffers[access.buffer], access.offset, getEnd(access.offset, access.size));
+
+    // an access of ranges which are not written yet depends on previous submissions, unless it is already resolved.
+    for (const auto& access : m_accesses)
+    {
+        const VkDeviceSize end = getEnd(access.offset, access.size);
+        for (const auto& range : m_buffers[access.buffer])
+        {
+            if (range.end <= access.offset)
+                continue;
+            if (range.begin >= end)
+                break;
+
+            const bool resolved = (access.stageMask & ~range.readStageMask) == 0 && (access.accessMask & ~range.readAccessMask) == 0;
+            if (range.writeStageMask == VK_PIPELINE_STAGE_2_NONE && !resolved)
+            {
+                m_firstAccesses.push_back(access);
+                break;
+            }
+        }
+    }
+
+    // all accesses are compared with the accesses of previous commands, before ranges are updated.
+    if (barrier)
+    {
+        for (const auto& access : m_accesses)
+        {
+            const VkDeviceSize end = getEnd(access.offset, access.size);
+            const bool write = isWrite(access);
+
+            for (const auto& range : m_buffers[access.buffer])
+            {
+                if (range.end <= access.offset)
+                    continue;
+                if (range.begin >= end)
+                    break;
+
+                VulkanBufferBarrier bufferBarrier{ .buffer = access.buffer,
+                                                   .offset = range.begin,
+                                                   .size = getSize(range.begin, range.end) };
+
+                const bool visible = (access.stageMask & ~range.readStageMask) == 0 && (access.accessMask & ~range.readAccessMask) == 0;
+                if (range.writeStageMask != VK_PIPELINE_STAGE_2_NONE && !visible)
+                {
+                    // read after write, or write after write. a write waits for the readers of the last write too.
+                    // a read extends the visibility of the last write, so previous readers are kept in the destination.
+                    bufferBarrier.srcStageMask = range.writeStageMask | (write ? range.readStageMask : VK_PIPELINE_STAGE_2_NONE);
+                    bufferBarrier.srcAccessMask = range.writeAccessMask;
+                    bufferBarrier.dstStageMask = write ? access.stageMask : range.readStageMask | access.stageMask;
+                    bufferBarrier.dstAccessMask = write ? access.accessMask : range.readAccessMask | access.accessMask;
+                }
+                else if (write && range.readStageMask != VK_PIPELINE_STAGE_2_NONE)
+                {
+                    // write after read needs an execution dependency only.
+                    bufferBarrier.srcStageMask = range.readStageMask;
+                    bufferBarrier.dstStageMask = access.stageMask;
+                }
+                else
+                {
+                    continue;
+                }
+
+                addBarrier(bufferBarrier);
+            }
+        }
+    }
+
+    // reads are applied before writes, so the range which is read and written by a command has no reader after it.
+    for (const bool write : { false, true })
+    {
+        for (const auto& access : m_accesses)
+        {
+            if (isWrite(access) != write)
+                continue;
+
+            const VkDeviceSize end = getEnd(access.offset, access.size);
+            for (auto& range : m_buffers[access.buffer])
+            {
+                if (range.end <= access.offset)
+                    continue;
+                if (range.begin >= end)
+                    break;
+
+                if (write)
+                {
+                    range.writeStageMask = access.stageMask;
+                    range.writeAccessMask = access.accessMask & kWriteAccessMask;
+                    range.readStageMask = VK_PIPELINE_STAGE_2_NONE;
+                    range.readAccessMask = VK_ACCESS_2_NONE;
+                }
+                else
+                {
+                    range.readStageMask |= access.stageMask;
+                    range.readAccessMask |= access.accessMask;
+                }
+            }
+        }
+    }
+
+    for (const auto& access : m_accesses)
+        merge(m_buffers[access.buffer]);
+
+    m_statistics.accesses += m_accesses.size();
+    m_accesses.clear();
+}
+
+void VulkanBufferTracker::split(std::vector<Range>& ranges, VkDeviceSize begin, VkDeviceSize end)
+{
+    if (ranges.empty())
+    {
+        ranges.push_back({ .begin = begin, .end = end });
+        return;
+    }
+
+    // split ranges at the bounds and fill gaps, so [begin, end) is covered by whole ranges.
+    m_scratchRanges.clear();
+
+    VkDeviceSize cursor = begin;
+    for (const auto& range : ranges)
+    {
+        if (range.end <= begin)
+        {
+            m_scratchRanges.push_back(range);
+            continue;
+        }
+
+        if (range.begin >= end)
+        {
+            if (cursor < end)
+            {
+                m_scratchRanges.push_back({ .begin = cursor, .end = end });
+                cursor = end;
+            }
+
+            m_scratchRanges.push_back(range);
+            continue;
+        }
+
+        if (range.begin < begin)
+        {
+            Range head = range;
+            head.end = begin;
+            m_scratchRanges.push_back(head);
+        }
+        else if (cursor < range.begin)
+        {
+            m_scratchRanges.push_back({ .begin = cursor, .end = range.begin });
+        }
+
+        Range middle = range;
+        middle.begin = std::max(range.begin, begin);
+        middle.end = std::min(range.end, end);
+        m_scratchRanges.push_back(middle);
+        cursor = middle.end;
+
+        if (range.end > end)
+        {
+            Range tail = range;
+            tail.begin = end;
+            m_scratchRanges.push_back(tail);
+        }
+    }
+
+    if (cursor < end)
+        m_scratchRanges.push_back({ .begin = cursor, .end = end });
+
+    ranges.swap(m_scratchRanges);
+}
+
+void VulkanBufferTracker::merge(std::vector<Range>& ranges)
+{
+    size_t last = 0;
+    for (size_t i = 1; i < ranges.size(); ++i)
+    {
+        auto& lhs = ranges[last];
+        const auto& rhs = ranges[i];
+        if (lhs.end == rhs.begin &&
+            lhs.writeStageMask == rhs.writeStageMask &&
+            lhs.writeAccessMask == rhs.writeAccessMask &&
+            lhs.readStageMask == rhs.readStageMask &&
+            lhs.readAccessMask == rhs.readAccessMask)
+        {
+            lhs.end = rhs.end;
+            continue;
+        }
+
+        ranges[++last] = rhs;
+    }
+    ranges.resize(std::min(ranges.size(), last + 1));
+}
+
+void VulkanBufferTracker::addBarrier(const VulkanBufferBarrier& barrier)
+{
+    // ranges of an access are adjacent, so they are merged if they have same dependency.
+    if (!m_barriers.empty())
+    {
+        auto& last = m_barriers.back();
+        if (last.buffer == barrier.buffer && isSameDependency(last, barrier) &&
+            last.size != VK_WHOLE_SIZE && last.offset + last.size == barrier.offset)
+        {
+            last.size = barrier.size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : last.size + barrier.size;
+            return;
+        }
+    }
+
+    m_barriers.push_back(barrier);
+
+    if (barrier.srcAccessMask != VK_ACCESS_2_NONE)
+        ++m_statistics.memoryBarriers;
+    else
+        ++m_statistics.executionBarriers;
+}
+
+} // namespace jipu
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "vulkan_api.h"
+#include "vulkan_export.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace jipu
+{
+
+/// @brief access to a buffer range by a command.
+/// stages and accesses are synchronization2 flags, but only the bits which have legacy equivalents are used.
+struct VulkanBufferAccess
+{
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    /// @brief to the end of the buffer if VK_WHOLE_SIZE.
+    VkDeviceSize size = VK_WHOLE_SIZE;
+    VkPipelineStageFlags2 stageMask = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 accessMask = VK_ACCESS_2_NONE;
+};
+
+/// @brief barrier for a buffer range between previous accesses and the accesses of the next command.
+struct VulkanBufferBarrier
+{
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = VK_WHOLE_SIZE;
+    VkPipelineStageFlags2 srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 srcAccessMask = VK_ACCESS_2_NONE;
+    VkPipelineStageFlags2 dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 dstAccessMask = VK_ACCESS_2_NONE;
+};
+
+struct VulkanBufferTrackerStatistics
+{
+    /// @brief accesses which are resolved.
+    uint64_t accesses = 0;
+    /// @brief barriers which make a write available and visible. read after write or write after write.
+    uint64_t memoryBarriers = 0;
+    /// @brief barriers which have no access masks. write after read.
+    uint64_t executionBarriers = 0;
+    /// @brief pipeline barrier commands recorded by flush or record.
+    uint64_t barrierCommands = 0;
+};
+
+class VulkanCommandRecorder;
+
+/// @brief tracks the last write and the readers of buffer ranges within a command buffer.
+/// read after read needs no barrier, write after read needs an execution dependency only,
+/// and a write is made visible only to the stages and accesses which read it.
+/// accesses before the first write of a range in the command buffer depend on previous submissions.
+/// they are resolved at submission by the tracker of the device, which keeps the states of submitted command buffers.
+class VULKAN_EXPORT VulkanBufferTracker final
+{
+public:
+    VulkanBufferTracker() = delete;
+    /// @param synchronization2 record VkBufferMemoryBarrier2 with exact stages per barrier.
+    /// otherwise, stages of barriers are merged into a legacy pipeline barrier.
+    explicit VulkanBufferTracker(bool synchronization2);
+    ~VulkanBufferTracker() = default;
+
+    VulkanBufferTracker(const VulkanBufferTracker&) = delete;
+    VulkanBufferTracker& operator=(const VulkanBufferTracker&) = delete;
+
+public:
+    /// @brief add an access of the next command. accesses of the same command don't depend on each other.
+    void access(const VulkanBufferAccess& access);
+
+    /// @brief resolve the accesses of the next command with previous accesses.
+    /// @return barriers which must be recorded before the command. they are valid until next resolve.
+    const std::vector<VulkanBufferBarrier>& resolve();
+    /// @brief resolve and record barriers with a single pipeline barrier command.
+    void flush(VulkanCommandRecorder& recorder);
+    /// @brief record barriers with a single pipeline barrier command. nothing is recorded if they are empty.
+    void record(VulkanCommandRecorder& recorder, const std::vector<VulkanBufferBarrier>& barriers);
+    /// @brief resolve without barriers. used in render passes where barriers can't be recorded.
+    void track();
+
+    /// @brief make all writes visible to the stages and accesses by next resolve.
+    /// used before a render pass, because buffers used in it are not known yet.
+    void makeVisible(VkPipelineStageFlags2 stageMask, VkAccessFlags2 accessMask);
+
+    /// @brief forget all ranges at the beginning of a command buffer.
+    void reset();
+
+    /// @brief used by the tracker of submitted states. resolve the accesses of the command buffer which depend on
+    /// previous submissions, and apply its final states. barriers are counted in the statistics of the command buffer.
+    /// @return barriers which must be recorded before the command buffer in submission order. valid until next resolve.
+    const std::vector<VulkanBufferBarrier>& submit(VulkanBufferTracker& commandBuffer);
+    /// @brief forget ranges of a destroyed buffer, because its handle can be reused.
+    void remove(VkBuffer buffer);
+
+    const VulkanBufferTrackerStatistics& getStatistics() const;
+
+private:
+    // disjoint ranges sorted by offset. a gap is a range which is not accessed yet.
+    struct Range
+    {
+        VkDeviceSize begin = 0;
+        VkDeviceSize end = 0;
+        VkPipelineStageFlags2 writeStageMask = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 writeAccessMask = VK_ACCESS_2_NONE;
+        // stages and accesses after the last write. the write is visible to them.
+        VkPipelineStageFlags2 readStageMask = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 readAccessMask = VK_ACCESS_2_NONE;
+    };
+
+    void resolveAccesses(bool barrier);
+    void split(std::vector<Range>& ranges, VkDeviceSize begin, VkDeviceSize end);
+    /// @brief merge adjacent ranges which have same state to keep ranges few.
+    void merge(std::vector<Range>& ranges);
+    void addBarrier(const VulkanBufferBarrier& barrier);
+
+private:
+    const bool m_synchronization2 = false;
+
+    std::unordered_map<VkBuffer, std::vector<Range>> m_buffers{};
+    std::vector<VulkanBufferAccess> m_accesses{};
+    // accesses of ranges which are not written yet. they are resolved with previous submissions.
+    std::vector<VulkanBufferAccess> m_firstAccesses{};
+    std::vector<VulkanBufferBarrier> m_barriers{};
+
+    // reused to avoid allocation for each command.
+    std::vector<Range> m_scratchRanges{};
+    std::vector<VulkanBufferBarrier> m_resolvedBarriers{};
+    std::vector<VkBufferMemoryBarrier2> m_bufferMemoryBarriers2{};
+    std::vector<VkBufferMemoryBarrier> m_bufferMemoryBarriers{};
+
+    VulkanBufferTrackerStatistics m_statistics{};
+};
+
+} // namespace jipu
@@ -1,8 +1,12 @@
 #include "vulkan_command_buffer.h"
 #include "vulkan_command_encoder.h"
 #include "vulkan_device.h"
+#include "vulkan_framebuffer.h"
+#include "vulkan_physical_device.h"
 
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 namespace jipu
 {
@@ -22,6 +26,9 @@ VulkanCommandBuffer::VulkanCommandBuffer(VulkanDevice& device, const CommandBuff
     {
         throw std::runtime_error("failed to allocate command buffers.");
     }
+
+    m_recorder = std::make_unique<VulkanCommandRecorder>(vkAPI, m_commandBuffer);
+    m_bufferTracker = std::make_unique<VulkanBufferTracker>(device.getPhysicalDevice().getVulkanPhysicalDeviceInfo().synchronization2);
 }
 
 VulkanCommandBuffer::~VulkanCommandBuffer()
@@ -37,6 +44,16 @@ std::unique_ptr<CommandEncoder> VulkanCommandBuffer::createCommandEncoder(const
     return std::make_unique<VulkanCommandEncoder>(*this, descriptor);
 }
 
+CommandBufferStatistics VulkanCommandBuffer::getStatistics() const
+{
+    auto statistics = m_statistics;
+    statistics.barrierCommands = m_recorder->getBarrierCommandCount();
+    statistics.bufferMemoryBarriers = m_bufferTracker->getStatistics().memoryBarriers;
+    statistics.bufferExecutionBarriers = m_bufferTracker->getStatistics().executionBarriers;
+
+    return statistics;
+}
+
 VulkanDevice& VulkanCommandBuffer::getDevice() const
 {
     return m_device;
@@ -47,6 +64,49 @@ VkCommandBuffer VulkanCommandBuffer::getVkCommandBuffer() const
     return m_commandBuffer;
 }
 
+VulkanCommandRecorder& VulkanCommandBuffer::getCommandRecorder() const
+{
+    return *m_recorder;
+}
+
+VulkanCommandStream& VulkanCommandBuffer::getCommandStream()
+{
+    return m_commandStream;
+}
+
+VulkanBufferTracker& VulkanCommandBuffer::getBufferTracker() const
+{
+    return *m_bufferTracker;
+}
+
+void VulkanCommandBuffer::reset()
+{
+    m_bufferTracker->reset();
+    m_recorder->resetBarrierCommandCount();
+    m_framebuffers.clear();
+    m_textures.clear();
+    m_statistics = CommandBufferStatistics{};
+}
+
+void VulkanCommandBuffer::retain(std::shared_ptr<VulkanFramebuffer> framebuffer)
+{
+    m_framebuffers.push_back(std::move(framebuffer));
+}
+
+void VulkanCommandBuffer::addStatistics(const VulkanPassEncoderStatistics& statistics)
+{
+    m_statistics.issuedCommands += statistics.issuedCommands;
+    m_statistics.elidedCommands += statistics.elidedCommands;
+}
+
+void VulkanCommandBuffer::addStatistics(const VulkanCommandStreamStatistics& statistics)
+{
+    m_statistics.elidedCommands += statistics.elidedCommands;
+    m_statistics.mergedBarriers += statistics.mergedBarriers;
+    m_statistics.mergedDescriptorBinds += statistics.mergedDescriptorBinds;
+    m_statistics.reorderedCommands += statistics.reorderedCommands;
+}
+
 void VulkanCommandBuffer::setSignalPipelineStage(VkPipelineStageFlags stage)
 {
     m_signalStage = stage;
@@ -86,4 +146,15 @@ std::vector<std::pair<VkSemaphore, VkPipelineStageFlags>> VulkanCommandBuffer::e
     return waitSemaphores;
 }
 
+void VulkanCommandBuffer::addTexture(VulkanTexture& texture)
+{
+    if (std::find(m_textures.begin(), m_textures.end(), &texture) == m_textures.end())
+        m_textures.push_back(&texture);
+}
+
+std::vector<VulkanTexture*> VulkanCommandBuffer::ejectTextures()
+{
+    return std::exchange(m_textures, {});
+}
+
 } // namespace jipu
\ No newline at end of file
@@ -5,13 +5,22 @@
 #include "jipu/command_buffer.h"
 #include "utils/cast.h"
 #include "vulkan_api.h"
+#include "vulkan_buffer_tracker.h"
+#include "vulkan_command_recorder.h"
+#include "vulkan_command_stream.h"
 #include "vulkan_export.h"
+#include "vulkan_pass_encoder_state.h"
+
+#include <memory>
+#include <vector>
 
 namespace jipu
 {
 
 class VulkanDevice;
-class VULKAN_EXPORT VulkanCommandBuffer : public CommandBuffer
+class VulkanFramebuffer;
+class VulkanTexture;
+class VULKAN_EXPORT VulkanCommandBuffer final : public CommandBuffer
 {
 public:
     VulkanCommandBuffer() = delete;
@@ -19,6 +28,7 @@ public:
     ~VulkanCommandBuffer() override;
 
     std::unique_ptr<CommandEncoder> createCommandEncoder(const CommandEncoderDescriptor& descriptor) override;
+    CommandBufferStatistics getStatistics() const override;
 
 public:
     VulkanDevice& getDevice() const;
@@ -26,12 +36,31 @@ public:
 public:
     VkCommandBuffer getVkCommandBuffer() const;
 
+    /// @brief encoders record commands through the recorder. it writes to the command stream while deferred encoder is recording.
+    VulkanCommandRecorder& getCommandRecorder() const;
+    VulkanCommandStream& getCommandStream();
+    /// @brief hazards of buffers used by commands of the encoder which is recording.
+    VulkanBufferTracker& getBufferTracker() const;
+
+    /// @brief reset states of the previous recording. it is called when an encoder begins.
+    void reset();
+    /// @brief keep the framebuffer until the command buffer is recorded again, even if it is removed from the cache.
+    void retain(std::shared_ptr<VulkanFramebuffer> framebuffer);
+    /// @brief add statistics of a pass encoder when it ends.
+    void addStatistics(const VulkanPassEncoderStatistics& statistics);
+    /// @brief add statistics of the command stream when it is translated.
+    void addStatistics(const VulkanCommandStreamStatistics& statistics);
+
     void setSignalPipelineStage(VkPipelineStageFlags stage);
     std::pair<VkSemaphore, VkPipelineStageFlags> getSignalSemaphore();
 
     void injectWaitSemaphore(VkSemaphore semaphore, VkPipelineStageFlags stage);
     std::vector<std::pair<VkSemaphore, VkPipelineStageFlags>> ejectWaitSemaphores();
 
+    /// @brief textures which are left in their final layouts by the command buffer. the queue marks them at submission.
+    void addTexture(VulkanTexture& texture);
+    std::vector<VulkanTexture*> ejectTextures();
+
 private:
     VulkanDevice& m_device;
 
@@ -39,10 +68,18 @@ private:
     VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
     VkCommandPool m_commandPool = VK_NULL_HANDLE;
 
+    std::unique_ptr<VulkanCommandRecorder> m_recorder = nullptr;
+    // kept to reuse memory for next recording.
+    VulkanCommandStream m_commandStream{};
+    std::unique_ptr<VulkanBufferTracker> m_bufferTracker = nullptr;
+    std::vector<std::shared_ptr<VulkanFramebuffer>> m_framebuffers{};
+    CommandBufferStatistics m_statistics{};
+
     VkSemaphore m_signalSemaphore = VK_NULL_HANDLE;
     VkPipelineStageFlags m_signalStage = VK_PIPELINE_STAGE_NONE;
 
     std::vector<std::pair<VkSemaphore, VkPipelineStageFlags>> m_waitSemaphores{};
+    std::vector<VulkanTexture*> m_textures{};
 };
 
 DOWN_CAST(VulkanCommandBuffer, CommandBuffer);
@@ -13,264 +13,492 @@
 #include "vulkan_texture_view.h"
 
 #include <algorithm>
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 
 namespace jipu
 {
 
-VulkanCommandEncoder::VulkanCommandEncoder(VulkanCommandBuffer& commandBuffer, const CommandEncoderDescriptor& descriptor)
-    : m_commandBuffer(commandBuffer)
+namespace
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
 
+void beginCommandBuffer(VulkanCommandBuffer& commandBuffer)
+{
     VkCommandBufferBeginInfo commandBufferBeginInfo{};
     commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     commandBufferBeginInfo.pInheritanceInfo = nullptr; // Optional
 
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-    if (vulkanDevice.vkAPI.BeginCommandBuffer(vulkanCommandBuffer.getVkCommandBuffer(), &commandBufferBeginInfo) != VK_SUCCESS)
+    auto& vulkanDevice = downcast(commandBuffer.getDevice());
+    if (vulkanDevice.vkAPI.BeginCommandBuffer(commandBuffer.getVkCommandBuffer(), &commandBufferBeginInfo) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to begin command buffer.");
     }
 }
 
+// stages and accesses of buffers used in a render pass. barriers can't be recorded in the pass,
+// so previous writes are made visible to all of them before the pass begins.
+constexpr VkPipelineStageFlags2 kRenderPassBufferStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT |
+                                                            VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT |
+                                                            VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+                                                            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+constexpr VkAccessFlags2 kRenderPassBufferAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT |
+                                                       VK_ACCESS_2_INDEX_READ_BIT |
+                                                       VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT |
+                                                       VK_ACCESS_2_UNIFORM_READ_BIT |
+                                                       VK_ACCESS_2_SHADER_READ_BIT |
+                                                       VK_ACCESS_2_SHADER_WRITE_BIT;
+
+// 3D textures copy depth slices, and others copy array layers.
+VkImageSubresourceRange generateCopySubresourceRange(const VulkanTexture& texture, VkImageAspectFlags aspect, uint32_t mipLevel, const Origin3D& origin, const Extent3D& extent)
+{
+    const bool is3D = texture.getType() == TextureType::k3D;
+
+    VkImageSubresourceRange range{};
+    range.aspectMask = aspect;
+    range.baseMipLevel = mipLevel;
+    range.levelCount = 1;
+    range.baseArrayLayer = is3D ? 0 : origin.z;
+    range.layerCount = is3D ? 1 : extent.depth;
+
+    return range;
+}
+
+void validateCopyRegion(const VulkanTexture& texture, uint32_t mipLevel, const Origin3D& origin, const Extent3D& extent)
+{
+    if (mipLevel >= texture.getMipLevels())
+        throw std::runtime_error(fmt::format("The mip level {} is out of {} mip levels.", mipLevel, texture.getMipLevels()));
+
+    if (extent.width == 0 || extent.height == 0 || extent.depth == 0)
+        throw std::runtime_error("The copy extent must be greater than 0.");
+
+    const uint32_t width = std::max(texture.getWidth() >> mipLevel, 1u);
+    const uint32_t height = std::max(texture.getHeight() >> mipLevel, 1u);
+    const uint32_t depth = texture.getType() == TextureType::k3D ? std::max(texture.getDepth() >> mipLevel, 1u) : texture.getDepth();
+    if (origin.x + extent.width > width || origin.y + extent.height > height || origin.z + extent.depth > depth)
+    {
+        throw std::runtime_error(fmt::format("The copy region [{}, {}, {}] ~ [{}, {}, {}] is out of the mip level {} [{}, {}, {}].",
+                                             origin.x, origin.y, origin.z,
+                                             origin.x + extent.width, origin.y + extent.height, origin.z + extent.depth,
+                                             mipLevel, width, height, depth));
+    }
+}
+
+VkBufferImageCopy generateBufferImageCopy(const VulkanTexture& texture, VkImageAspectFlags aspect, const BufferTextureCopyRegion& layout)
+{
+    validateCopyRegion(texture, layout.mipLevel, layout.origin, layout.extent);
+
+    const uint32_t texelBlockSize = GenerateTexelBlockSize(ToVkFormat(texture.getFormat()), aspect);
+    if (layout.bytesPerRow != 0 && (layout.bytesPerRow % texelBlockSize != 0 || layout.bytesPerRow < layout.extent.width * texelBlockSize))
+        throw std::runtime_error(fmt::format("The bytes per row {} is not valid for the width {} and the texel size {}.", layout.bytesPerRow, layout.extent.width, texelBlockSize));
+    if (layout.rowsPerTexture != 0 && layout.rowsPerTexture < layout.extent.height)
+        throw std::runtime_error(fmt::format("The rows per texture {} is less than the height {}.", layout.rowsPerTexture, layout.extent.height));
+
+    const bool is3D = texture.getType() == TextureType::k3D;
+    const auto range = generateCopySubresourceRange(texture, aspect, layout.mipLevel, layout.origin, layout.extent);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = layout.bufferOffset;
+    region.bufferRowLength = layout.bytesPerRow / texelBlockSize; // texels
+    region.bufferImageHeight = layout.rowsPerTexture;
+
+    region.imageSubresource.aspectMask = aspect;
+    region.imageSubresource.mipLevel = layout.mipLevel;
+    region.imageSubresource.baseArrayLayer = range.baseArrayLayer;
+    region.imageSubresource.layerCount = range.layerCount;
+
+    region.imageOffset = { static_cast<int32_t>(layout.origin.x),
+                           static_cast<int32_t>(layout.origin.y),
+                           static_cast<int32_t>(is3D ? layout.origin.z : 0) };
+    region.imageExtent = { .width = layout.extent.width,
+                           .height = layout.extent.height,
+                           .depth = is3D ? layout.extent.depth : 1 };
+
+    return region;
+}
+
+// bytes of the buffer which are accessed by the copy, from the buffer offset.
+VkDeviceSize getBufferImageCopySize(const VkBufferImageCopy& region, uint32_t texelBlockSize)
+{
+    const VkDeviceSize rowLength = region.bufferRowLength != 0 ? region.bufferRowLength : region.imageExtent.width;
+    const VkDeviceSize imageHeight = region.bufferImageHeight != 0 ? region.bufferImageHeight : region.imageExtent.height;
+    const VkDeviceSize images = static_cast<VkDeviceSize>(region.imageExtent.depth) * region.imageSubresource.layerCount;
+
+    const VkDeviceSize bytesPerRow = rowLength * texelBlockSize;
+    const VkDeviceSize bytesPerImage = bytesPerRow * imageHeight;
+
+    return bytesPerImage * (images - 1) + bytesPerRow * (region.imageExtent.height - 1) + static_cast<VkDeviceSize>(region.imageExtent.width) * texelBlockSize;
+}
+
+} // namespace
+
+VulkanCommandEncoder::VulkanCommandEncoder(VulkanCommandBuffer& commandBuffer, const CommandEncoderDescriptor& descriptor)
+    : m_commandBuffer(commandBuffer)
+    , m_deferred(descriptor.deferred)
+{
+    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
+    vulkanCommandBuffer.reset();
+
+    if (m_deferred)
+    {
+        // the command buffer begins at finish, after the stream is recorded.
+        auto& commandStream = vulkanCommandBuffer.getCommandStream();
+        commandStream.reset();
+        vulkanCommandBuffer.getCommandRecorder().setCommandStream(&commandStream);
+    }
+    else
+    {
+        beginCommandBuffer(vulkanCommandBuffer);
+    }
+}
+
 std::unique_ptr<ComputePassEncoder> VulkanCommandEncoder::beginComputePass(const ComputePassEncoderDescriptor& descriptor)
 {
+    restoreFinalLayouts();
+
     return std::make_unique<VulkanComputePassEncoder>(downcast(m_commandBuffer), descriptor);
 }
 
 std::unique_ptr<RenderPassEncoder> VulkanCommandEncoder::beginRenderPass(const RenderPassEncoderDescriptor& descriptor)
 {
+    restoreFinalLayouts();
+    makeBuffersVisibleToRenderPass();
+
     return std::make_unique<VulkanRenderPassEncoder>(downcast(m_commandBuffer), descriptor);
 }
 
 std::unique_ptr<RenderPassEncoder> VulkanCommandEncoder::beginRenderPass(const VulkanRenderPassEncoderDescriptor& descriptor)
 {
+    restoreFinalLayouts();
+    makeBuffersVisibleToRenderPass();
+
     return std::make_unique<VulkanRenderPassEncoder>(downcast(m_commandBuffer), descriptor);
 }
 
 void VulkanCommandEncoder::copyBufferToBuffer(const BlitBuffer& src, const BlitBuffer& dst, uint64_t size)
+{
+    copyBufferToBuffer(src.buffer, dst.buffer, { { .srcOffset = src.offset, .dstOffset = dst.offset, .size = size } });
+}
+
+void VulkanCommandEncoder::copyBufferToTexture(const BlitTextureBuffer& textureBuffer, const BlitTexture& texture, const Extent3D& extent)
+{
+    copyBufferToTexture(textureBuffer.buffer,
+                        texture.texture,
+                        texture.aspect,
+                        { { .bufferOffset = textureBuffer.offset,
+                            .bytesPerRow = textureBuffer.bytesPerRow,
+                            .rowsPerTexture = textureBuffer.rowsPerTexture,
+                            .mipLevel = texture.mipLevel,
+                            .origin = texture.origin,
+                            .extent = extent } });
+}
+
+void VulkanCommandEncoder::copyTextureToBuffer(const BlitTexture& texture, const BlitTextureBuffer& buffer, const Extent3D& extent)
 {
     auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
+    auto& recorder = vulkanCommandBuffer.getCommandRecorder();
 
-    VkBufferCopy copyRegion{};
-    copyRegion.srcOffset = 0; // Optional
-    copyRegion.dstOffset = 0; // Optional
-    copyRegion.size = size;
+    auto& vulkanTexture = downcast(texture.texture);
+    auto& vulkanBuffer = downcast(buffer.buffer);
+    const auto aspect = ToVkImageAspectFlags(texture.aspect);
 
-    VkBuffer srcBuffer = downcast(src.buffer).getVkBuffer();
-    VkBuffer dstBuffer = downcast(dst.buffer).getVkBuffer();
+    auto region = generateBufferImageCopy(vulkanTexture, aspect, { .bufferOffset = buffer.offset,
+                                                                    .bytesPerRow = buffer.bytesPerRow,
+                                                                    .rowsPerTexture = buffer.rowsPerTexture,
+                                                                    .mipLevel = texture.mipLevel,
+                                                                    .origin = texture.origin,
+                                                                    .extent = extent });
+
+    auto srcImage = vulkanTexture.getVkImage();
+    auto dstBuffer = vulkanBuffer.getVkBuffer();
 
-    vkAPI.CmdCopyBuffer(vulkanCommandBuffer.getVkCommandBuffer(), srcBuffer, dstBuffer, 1, &copyRegion);
+    // layout transition from the current layout to keep contents.
+    VulkanPipelineBarrier barrier{};
+    vulkanTexture.transitionLayout(barrier,
+                                   generateCopySubresourceRange(vulkanTexture, aspect, texture.mipLevel, texture.origin, extent),
+                                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                   VK_ACCESS_TRANSFER_READ_BIT);
+    recorder.cmdPipelineBarrier(barrier);
+    addTransferTexture(vulkanTexture);
+
+    auto& bufferTracker = vulkanCommandBuffer.getBufferTracker();
+    bufferTracker.access({ .buffer = dstBuffer,
+                           .offset = region.bufferOffset,
+                           .size = getBufferImageCopySize(region, GenerateTexelBlockSize(ToVkFormat(vulkanTexture.getFormat()), aspect)),
+                           .stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                           .accessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT });
+    bufferTracker.flush(recorder);
+
+    recorder.cmdCopyImageToBuffer(srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dstBuffer, 1, &region);
 }
 
-void VulkanCommandEncoder::copyBufferToTexture(const BlitTextureBuffer& textureBuffer, const BlitTexture& texture, const Extent3D& extent)
+void VulkanCommandEncoder::copyTextureToTexture(const BlitTexture& src, const BlitTexture& dst, const Extent3D& extent)
 {
-    auto& vulkanTexture = downcast(texture.texture);
-    if (!(vulkanTexture.getUsage() & TextureUsageFlagBits::kCopyDst))
-        throw std::runtime_error("The texture is not used for copy dst.");
-
     auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    VkCommandBuffer commandBuffer = vulkanCommandBuffer.getVkCommandBuffer();
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
+    auto& recorder = vulkanCommandBuffer.getCommandRecorder();
 
-    VkImageSubresourceRange range;
-    range.aspectMask = ToVkImageAspectFlags(texture.aspect);
-    range.baseMipLevel = 0;
-    range.levelCount = texture.texture.getMipLevels();
-    range.baseArrayLayer = 0;
-    range.layerCount = 1;
+    auto& srcTexture = downcast(src.texture);
+    auto& dstTexture = downcast(dst.texture);
 
-    // set pipeline barrier for dst
-    vulkanTexture.setPipelineBarrier(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, range);
+    validateCopyRegion(srcTexture, src.mipLevel, src.origin, extent);
+    validateCopyRegion(dstTexture, dst.mipLevel, dst.origin, extent);
 
-    // copy buffer to texture
-    auto& vulkanBuffer = downcast(textureBuffer.buffer);
+    auto srcSubresourceRange = generateCopySubresourceRange(srcTexture, ToVkImageAspectFlags(src.aspect), src.mipLevel, src.origin, extent);
+    auto dstSubresourceRange = generateCopySubresourceRange(dstTexture, ToVkImageAspectFlags(dst.aspect), dst.mipLevel, dst.origin, extent);
 
-    VkBufferImageCopy region{};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-
-    region.imageSubresource.aspectMask = ToVkImageAspectFlags(texture.aspect);
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-
-    region.imageOffset = { 0, 0, 0 };
-    region.imageExtent = { .width = extent.width,
-                           .height = extent.height,
-                           .depth = extent.depth };
-
-    vkAPI.CmdCopyBufferToImage(commandBuffer,
-                               vulkanBuffer.getVkBuffer(),
-                               vulkanTexture.getVkImage(),
-                               // dstImageLayout must be
-                               //   VK_IMAGE_LAYOUT_SHARED_PRESENT_KHR
-                               //   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-                               //   VK_IMAGE_LAYOUT_GENERAL
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                               1,
-                               &region);
-
-    if (uint32_t mipLevels = texture.texture.getMipLevels(); mipLevels > 1)
-    {
-        VkImage image = vulkanTexture.getVkImage();
+    // set pipeline barrier to change image layouts for src and dst at once.
+    VulkanPipelineBarrier barrier{};
+    srcTexture.transitionLayout(barrier, srcSubresourceRange, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+    dstTexture.transitionLayout(barrier, dstSubresourceRange, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    recorder.cmdPipelineBarrier(barrier);
+    addTransferTexture(srcTexture);
+    addTransferTexture(dstTexture);
 
-        int32_t width = static_cast<int32_t>(texture.texture.getWidth());
-        int32_t height = static_cast<int32_t>(texture.texture.getHeight());
-        for (uint32_t i = 1; i < mipLevels; ++i)
-        {
+    const bool src3D = srcTexture.getType() == TextureType::k3D;
+    const bool dst3D = dstTexture.getType() == TextureType::k3D;
+
+    VkImageCopy copyRegion = {};
+    copyRegion.srcSubresource.aspectMask = srcSubresourceRange.aspectMask;
+    copyRegion.srcSubresource.mipLevel = srcSubresourceRange.baseMipLevel;
+    copyRegion.srcSubresource.baseArrayLayer = srcSubresourceRange.baseArrayLayer;
+    copyRegion.srcSubresource.layerCount = srcSubresourceRange.layerCount;
+
+    copyRegion.srcOffset = { static_cast<int32_t>(src.origin.x),
+                             static_cast<int32_t>(src.origin.y),
+                             static_cast<int32_t>(src3D ? src.origin.z : 0) };
+
+    copyRegion.dstSubresource.aspectMask = dstSubresourceRange.aspectMask;
+    copyRegion.dstSubresource.mipLevel = dstSubresourceRange.baseMipLevel;
+    copyRegion.dstSubresource.baseArrayLayer = dstSubresourceRange.baseArrayLayer;
+    copyRegion.dstSubresource.layerCount = dstSubresourceRange.layerCount;
+
+    copyRegion.dstOffset = { static_cast<int32_t>(dst.origin.x),
+                             static_cast<int32_t>(dst.origin.y),
+                             static_cast<int32_t>(dst3D ? dst.origin.z : 0) };
+
+    copyRegion.extent.width = extent.width;
+    copyRegion.extent.height = extent.height;
+    copyRegion.extent.depth = src3D || dst3D ? extent.depth : 1;
+
+    auto srcImage = srcTexture.getVkImage();
+    auto dstImage = dstTexture.getVkImage();
+    recorder.cmdCopyImage(srcImage,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          dstImage,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          1,
+                          &copyRegion);
+}
+
+void VulkanCommandEncoder::copyBufferToBuffer(Buffer& src, Buffer& dst, const std::vector<BufferCopyRegion>& regions)
+{
+    if (regions.empty())
+        return;
+
+    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
+    auto& recorder = vulkanCommandBuffer.getCommandRecorder();
+
+    VkBuffer srcBuffer = downcast(src).getVkBuffer();
+    VkBuffer dstBuffer = downcast(dst).getVkBuffer();
 
-            VkImageSubresourceRange srcSubresourceRange{};
-            srcSubresourceRange.aspectMask = ToVkImageAspectFlags(texture.aspect);
-            srcSubresourceRange.baseMipLevel = i - 1;
-            srcSubresourceRange.levelCount = 1;
-            srcSubresourceRange.baseArrayLayer = 0;
-            srcSubresourceRange.layerCount = 1;
-
-            // set pipeline barrier for src
-            vulkanTexture.setPipelineBarrier(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, srcSubresourceRange);
-
-            VkImageBlit blit{};
-            blit.srcOffsets[0] = { 0, 0, 0 };
-            blit.srcOffsets[1] = { width, height, 1 };
-            blit.srcSubresource.aspectMask = ToVkImageAspectFlags(texture.aspect);
-            blit.srcSubresource.mipLevel = i - 1;
-            blit.srcSubresource.baseArrayLayer = 0;
-            blit.srcSubresource.layerCount = 1;
-            blit.dstOffsets[0] = { 0, 0, 0 };
-            blit.dstOffsets[1] = { width > 1 ? width / 2 : 1, height > 1 ? height / 2 : 1, 1 };
-            blit.dstSubresource.aspectMask = ToVkImageAspectFlags(texture.aspect);
-            blit.dstSubresource.mipLevel = i;
-            blit.dstSubresource.baseArrayLayer = 0;
-            blit.dstSubresource.layerCount = 1;
-
-            vkAPI.CmdBlitImage(commandBuffer,
-                               image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                               image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                               1, &blit,
-                               VK_FILTER_LINEAR);
-
-            // set pipeline barrier for dst
-            vulkanTexture.setPipelineBarrier(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, srcSubresourceRange);
-
-            width = std::max(width >> 1, 1);
-            height = std::max(height >> 1, 1);
+    auto& bufferTracker = vulkanCommandBuffer.getBufferTracker();
+
+    std::vector<VkBufferCopy> copyRegions{};
+    copyRegions.reserve(regions.size());
+    for (const auto& region : regions)
+    {
+        if (region.srcOffset + region.size > src.getSize() || region.dstOffset + region.size > dst.getSize())
+        {
+            throw std::runtime_error(fmt::format("The copy region (src offset {}, dst offset {}, size {}) is out of the buffers (src size {}, dst size {}).",
+                                                 region.srcOffset, region.dstOffset, region.size, src.getSize(), dst.getSize()));
         }
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = region.srcOffset;
+        copyRegion.dstOffset = region.dstOffset;
+        copyRegion.size = region.size;
+        copyRegions.push_back(copyRegion);
+
+        bufferTracker.access({ .buffer = srcBuffer,
+                               .offset = copyRegion.srcOffset,
+                               .size = copyRegion.size,
+                               .stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                               .accessMask = VK_ACCESS_2_TRANSFER_READ_BIT });
+        bufferTracker.access({ .buffer = dstBuffer,
+                               .offset = copyRegion.dstOffset,
+                               .size = copyRegion.size,
+                               .stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                               .accessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT });
     }
+    bufferTracker.flush(recorder);
 
-    // set pipeline barrier to restore final layout
-    vulkanTexture.setPipelineBarrier(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vulkanTexture.getFinalLayout(), range);
+    recorder.cmdCopyBuffer(srcBuffer, dstBuffer, static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
 }
 
-void VulkanCommandEncoder::copyTextureToBuffer(const BlitTexture& texture, const BlitTextureBuffer& buffer, const Extent3D& extent)
+void VulkanCommandEncoder::copyBufferToTexture(Buffer& buffer, Texture& texture, TextureAspectFlags aspect, const std::vector<BufferTextureCopyRegion>& regions)
 {
+    if (regions.empty())
+        return;
+
+    auto& vulkanTexture = downcast(texture);
+    if (!(vulkanTexture.getUsage() & TextureUsageFlagBits::kCopyDst))
+        throw std::runtime_error("The texture is not used for copy dst.");
+
     auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
+    auto& recorder = vulkanCommandBuffer.getCommandRecorder();
 
-    // set pipeline barrier to change image layout
-    auto& vulkanTexture = downcast(texture.texture);
+    auto& vulkanBuffer = downcast(buffer);
+    const auto aspectMask = ToVkImageAspectFlags(aspect);
+    const uint32_t texelBlockSize = GenerateTexelBlockSize(ToVkFormat(vulkanTexture.getFormat()), aspectMask);
 
-    VkImageSubresourceRange range{};
-    range.aspectMask = ToVkImageAspectFlags(texture.aspect);
-    range.baseArrayLayer = 0;
-    range.layerCount = 1;
-    range.baseMipLevel = 0;
-    range.levelCount = 1;
+    auto& bufferTracker = vulkanCommandBuffer.getBufferTracker();
 
-    auto srcImage = vulkanTexture.getVkImage();
+    std::vector<VkBufferImageCopy> copyRegions{};
+    copyRegions.reserve(regions.size());
+    for (const auto& region : regions)
+    {
+        auto copyRegion = generateBufferImageCopy(vulkanTexture, aspectMask, { .bufferOffset = region.bufferOffset,
+                                                                                .bytesPerRow = region.bytesPerRow,
+                                                                                .rowsPerTexture = region.rowsPerTexture,
+                                                                                .mipLevel = region.mipLevel,
+                                                                                .origin = region.origin,
+                                                                                .extent = region.extent });
+
+        const VkDeviceSize size = getBufferImageCopySize(copyRegion, texelBlockSize);
+        if (copyRegion.bufferOffset + size > buffer.getSize())
+            throw std::runtime_error(fmt::format("The copy region (offset {}, size {}) is out of the buffer size {}.", copyRegion.bufferOffset, size, buffer.getSize()));
+
+        copyRegions.push_back(copyRegion);
+
+        bufferTracker.access({ .buffer = vulkanBuffer.getVkBuffer(),
+                               .offset = copyRegion.bufferOffset,
+                               .size = size,
+                               .stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                               .accessMask = VK_ACCESS_2_TRANSFER_READ_BIT });
+    }
 
-    auto& vulkanBuffer = downcast(buffer.buffer);
-    auto dstBuffer = vulkanBuffer.getVkBuffer();
+    // set pipeline barrier for dst. array layers of a mip level which are copied by regions are transitioned at once.
+    std::vector<VkImageSubresourceRange> ranges{};
+    for (const auto& copyRegion : copyRegions)
+    {
+        const auto& subresource = copyRegion.imageSubresource;
+        auto it = std::find_if(ranges.begin(), ranges.end(), [&](const VkImageSubresourceRange& range) {
+            return range.baseMipLevel == subresource.mipLevel;
+        });
+        if (it == ranges.end())
+        {
+            ranges.push_back({ .aspectMask = aspectMask,
+                               .baseMipLevel = subresource.mipLevel,
+                               .levelCount = 1,
+                               .baseArrayLayer = subresource.baseArrayLayer,
+                               .layerCount = subresource.layerCount });
+            continue;
+        }
 
-    VkBufferImageCopy region{};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.imageSubresource.aspectMask = ToVkImageAspectFlags(texture.aspect);
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = { 0, 0, 0 };
-    region.imageExtent = { .width = extent.width,
-                           .height = extent.height,
-                           .depth = extent.depth };
-
-    // layout transition before copy.
-    vulkanTexture.setPipelineBarrier(vulkanCommandBuffer.getVkCommandBuffer(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, range);
-    vkAPI.CmdCopyImageToBuffer(vulkanCommandBuffer.getVkCommandBuffer(), srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dstBuffer, 1, &region);
-
-    // set pipeline barrier to restore final layout.
-    vulkanTexture.setPipelineBarrier(vulkanCommandBuffer.getVkCommandBuffer(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vulkanTexture.getFinalLayout(), range);
+        const uint32_t end = std::max(it->baseArrayLayer + it->layerCount, subresource.baseArrayLayer + subresource.layerCount);
+        it->baseArrayLayer = std::min(it->baseArrayLayer, subresource.baseArrayLayer);
+        it->layerCount = end - it->baseArrayLayer;
+    }
+
+    VulkanPipelineBarrier barrier{};
+    for (const auto& range : ranges)
+        vulkanTexture.transitionLayout(barrier, range, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    recorder.cmdPipelineBarrier(barrier);
+    addTransferTexture(vulkanTexture);
+
+    bufferTracker.flush(recorder);
+
+    recorder.cmdCopyBufferToImage(vulkanBuffer.getVkBuffer(),
+                                  vulkanTexture.getVkImage(),
+                                  // dstImageLayout must be
+                                  //   VK_IMAGE_LAYOUT_SHARED_PRESENT_KHR
+                                  //   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+                                  //   VK_IMAGE_LAYOUT_GENERAL
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  static_cast<uint32_t>(copyRegions.size()),
+                                  copyRegions.data());
 }
 
-void VulkanCommandEncoder::copyTextureToTexture(const BlitTexture& src, const BlitTexture& dst, const Extent3D& extent)
+void VulkanCommandEncoder::fillBuffer(Buffer& buffer, uint64_t offset, uint64_t size, uint32_t value)
 {
+    if (offset % 4 != 0 || size % 4 != 0)
+        throw std::runtime_error(fmt::format("The fill offset {} and size {} must be multiples of 4.", offset, size));
+
+    if (!(buffer.getUsage() & BufferUsageFlagBits::kCopyDst))
+        throw std::runtime_error("The buffer to fill must have copy dst usage.");
+
+    if (offset + size > buffer.getSize())
+        throw std::runtime_error(fmt::format("The fill range (offset {}, size {}) is out of the buffer (size {}).", offset, size, buffer.getSize()));
+
+    if (size == 0)
+        return;
+
     auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
+    auto& recorder = vulkanCommandBuffer.getCommandRecorder();
 
-    // set pipeline barrier to change image layout for src
-    VkImageSubresourceRange srcSubresourceRange{};
-    srcSubresourceRange.aspectMask = ToVkImageAspectFlags(src.aspect);
-    srcSubresourceRange.baseArrayLayer = 0;
-    srcSubresourceRange.layerCount = 1;
-    srcSubresourceRange.baseMipLevel = 0;
-    srcSubresourceRange.levelCount = 1;
+    VkBuffer vkBuffer = downcast(buffer).getVkBuffer();
 
-    auto& srcTexture = downcast(src.texture);
-    srcTexture.setPipelineBarrier(vulkanCommandBuffer.getVkCommandBuffer(), srcTexture.getFinalLayout(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, srcSubresourceRange);
+    auto& bufferTracker = vulkanCommandBuffer.getBufferTracker();
+    bufferTracker.access({ .buffer = vkBuffer,
+                           .offset = offset,
+                           .size = size,
+                           .stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                           .accessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT });
+    bufferTracker.flush(recorder);
 
-    // set pipeline barrier to change image layout for dst
-    VkImageSubresourceRange dstSubresourceRange{};
-    dstSubresourceRange.aspectMask = ToVkImageAspectFlags(dst.aspect);
-    dstSubresourceRange.baseArrayLayer = 0;
-    dstSubresourceRange.layerCount = 1;
-    dstSubresourceRange.baseMipLevel = 0;
-    dstSubresourceRange.levelCount = 1;
+    recorder.cmdFillBuffer(vkBuffer, offset, size, value);
+}
 
-    auto& dstTexture = downcast(dst.texture);
-    dstTexture.setPipelineBarrier(vulkanCommandBuffer.getVkCommandBuffer(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, dstSubresourceRange);
+void VulkanCommandEncoder::clearBuffer(Buffer& buffer, uint64_t offset, uint64_t size)
+{
+    fillBuffer(buffer, offset, size, 0u);
+}
 
-    VkImageCopy copyRegion = {};
-    copyRegion.srcSubresource.aspectMask = ToVkImageAspectFlags(src.aspect);
-    copyRegion.srcSubresource.mipLevel = 0;
-    copyRegion.srcSubresource.baseArrayLayer = 0;
-    copyRegion.srcSubresource.layerCount = 1;
+void VulkanCommandEncoder::generateMipmaps(Texture& texture)
+{
+    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
+    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
+    auto& vulkanTexture = downcast(texture);
 
-    copyRegion.srcOffset = { 0, 0, 0 };
+    if (vulkanTexture.getMipLevels() <= 1)
+        return;
 
-    copyRegion.dstSubresource.aspectMask = ToVkImageAspectFlags(dst.aspect);
-    copyRegion.dstSubresource.mipLevel = 0;
-    copyRegion.dstSubresource.baseArrayLayer = 0;
-    copyRegion.dstSubresource.layerCount = 1;
+    VkImageSubresourceRange range{};
+    range.aspectMask = GenerateImageAspectFlags(ToVkFormat(vulkanTexture.getFormat()));
+    range.baseMipLevel = 0;
+    range.levelCount = vulkanTexture.getMipLevels();
+    range.baseArrayLayer = 0;
+    range.layerCount = vulkanTexture.getType() == TextureType::k3D ? 1 : vulkanTexture.getDepth();
 
-    copyRegion.dstOffset = { 0, 0, 0 };
+    auto& mipmapGenerator = vulkanDevice.getMipmapGenerator();
+    if (mipmapGenerator.isSupported(vulkanTexture))
+    {
+        // all levels are read and written by a dispatch. the levels are restored with others at the command boundary.
+        VulkanPipelineBarrier barrier{};
+        vulkanTexture.transitionLayout(barrier,
+                                       range,
+                                       VK_IMAGE_LAYOUT_GENERAL,
+                                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        vulkanCommandBuffer.getCommandRecorder().cmdPipelineBarrier(barrier);
+
+        mipmapGenerator.generate(vulkanCommandBuffer, vulkanTexture);
+    }
+    else
+    {
+        const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        if (!vulkanDevice.getPhysicalDevice().isFormatFeatureSupported(ToVkFormat(vulkanTexture.getFormat()), blitFeatures))
+        {
+            throw std::runtime_error(fmt::format("Mipmaps can't be generated for the texture format {}. it requires storage binding usage or linear blit support.",
+                                                 static_cast<uint32_t>(vulkanTexture.getFormat())));
+        }
 
-    copyRegion.extent.width = extent.width;
-    copyRegion.extent.height = extent.height;
-    copyRegion.extent.depth = extent.depth;
+        blitMipmaps(vulkanTexture, range);
+    }
 
-    auto srcImage = srcTexture.getVkImage();
-    auto dstImage = dstTexture.getVkImage();
-    vkAPI.CmdCopyImage(vulkanCommandBuffer.getVkCommandBuffer(),
-                       srcImage,
-                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                       dstImage,
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                       1,
-                       &copyRegion);
-
-    // set pipeline barrier to restore final layout.
-    srcTexture.setPipelineBarrier(vulkanCommandBuffer.getVkCommandBuffer(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, srcTexture.getFinalLayout(), srcSubresourceRange);
-    dstTexture.setPipelineBarrier(vulkanCommandBuffer.getVkCommandBuffer(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, dstTexture.getFinalLayout(), dstSubresourceRange);
+    addTransferTexture(vulkanTexture);
 }
 
 void VulkanCommandEncoder::resolveQuerySet(QuerySet* querySet,
@@ -280,28 +508,51 @@ void VulkanCommandEncoder::resolveQuerySet(QuerySet* querySet,
                                            uint64_t destinationOffset)
 {
 
-    auto& vulkanDevice = m_commandBuffer.getDevice();
     auto vulkanQuerySet = downcast(querySet);
     auto vulkanBuffer = downcast(destination);
 
-    std::vector<uint64_t> timestamps(vulkanQuerySet->getCount());
-
-    auto& vkAPI = vulkanDevice.vkAPI;
-    vkAPI.CmdCopyQueryPoolResults(m_commandBuffer.getVkCommandBuffer(),
-                                  vulkanQuerySet->getVkQueryPool(),
-                                  0, // firstQuery
-                                  vulkanQuerySet->getCount(),
-                                  vulkanBuffer->getVkBuffer(),
-                                  0, // offset
-                                  sizeof(uint64_t),
-                                  VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    auto& bufferTracker = m_commandBuffer.getBufferTracker();
+    bufferTracker.access({ .buffer = vulkanBuffer->getVkBuffer(),
+                           .offset = 0,
+                           .size = static_cast<VkDeviceSize>(vulkanQuerySet->getCount()) * sizeof(uint64_t),
+                           .stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                           .accessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT });
+    bufferTracker.flush(m_commandBuffer.getCommandRecorder());
+
+    m_commandBuffer.getCommandRecorder().cmdCopyQueryPoolResults(vulkanQuerySet->getVkQueryPool(),
+                                                                 0, // firstQuery
+                                                                 vulkanQuerySet->getCount(),
+                                                                 vulkanBuffer->getVkBuffer(),
+                                                                 0, // offset
+                                                                 sizeof(uint64_t),
+                                                                 VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
 }
 
 CommandBuffer& VulkanCommandEncoder::finish()
 {
+    restoreFinalLayouts();
+
     auto& vulkanCommandBuffer = downcast(m_commandBuffer);
     auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
 
+    if (m_deferred)
+    {
+        auto& recorder = vulkanCommandBuffer.getCommandRecorder();
+        recorder.setCommandStream(nullptr);
+
+        beginCommandBuffer(vulkanCommandBuffer);
+
+        auto statistics = vulkanCommandBuffer.getCommandStream().translate(vulkanDevice.vkAPI, vulkanCommandBuffer.getVkCommandBuffer());
+        spdlog::trace("command stream: recorded {}, translated {}, merged barriers {}, elided {}, merged descriptor binds {}, reordered {}",
+                      statistics.recordedCommands,
+                      statistics.translatedCommands,
+                      statistics.mergedBarriers,
+                      statistics.elidedCommands,
+                      statistics.mergedDescriptorBinds,
+                      statistics.reorderedCommands);
+        vulkanCommandBuffer.addStatistics(statistics);
+    }
+
     if (vulkanDevice.vkAPI.EndCommandBuffer(vulkanCommandBuffer.getVkCommandBuffer()) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to end command buffer.");
@@ -315,4 +566,84 @@ VulkanCommandBuffer& VulkanCommandEncoder::getCommandBuffer() const
     return m_commandBuffer;
 }
 
+void VulkanCommandEncoder::blitMipmaps(VulkanTexture& texture, const VkImageSubresourceRange& range)
+{
+    auto& recorder = downcast(m_commandBuffer).getCommandRecorder();
+
+    VkImage image = texture.getVkImage();
+
+    int32_t width = static_cast<int32_t>(texture.getWidth());
+    int32_t height = static_cast<int32_t>(texture.getHeight());
+    int32_t depth = texture.getType() == TextureType::k3D ? static_cast<int32_t>(texture.getDepth()) : 1;
+    for (uint32_t i = 1; i < texture.getMipLevels(); ++i)
+    {
+        VkImageSubresourceRange srcSubresourceRange = range;
+        srcSubresourceRange.baseMipLevel = i - 1;
+        srcSubresourceRange.levelCount = 1;
+
+        VkImageSubresourceRange dstSubresourceRange = range;
+        dstSubresourceRange.baseMipLevel = i;
+        dstSubresourceRange.levelCount = 1;
+
+        // set pipeline barrier for src and dst. the levels are restored with others at the command boundary.
+        VulkanPipelineBarrier barrier{};
+        texture.transitionLayout(barrier, srcSubresourceRange, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+        texture.transitionLayout(barrier, dstSubresourceRange, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+        recorder.cmdPipelineBarrier(barrier);
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = { 0, 0, 0 };
+        blit.srcOffsets[1] = { width, height, depth };
+        blit.srcSubresource.aspectMask = range.aspectMask;
+        blit.srcSubresource.mipLevel = i - 1;
+        blit.srcSubresource.baseArrayLayer = range.baseArrayLayer;
+        blit.srcSubresource.layerCount = range.layerCount;
+        blit.dstOffsets[0] = { 0, 0, 0 };
+        blit.dstOffsets[1] = { std::max(width >> 1, 1), std::max(height >> 1, 1), std::max(depth >> 1, 1) };
+        blit.dstSubresource.aspectMask = range.aspectMask;
+        blit.dstSubresource.mipLevel = i;
+        blit.dstSubresource.baseArrayLayer = range.baseArrayLayer;
+        blit.dstSubresource.layerCount = range.layerCount;
+
+        recorder.cmdBlitImage(image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                              image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              1, &blit,
+                              VK_FILTER_LINEAR);
+
+        width = std::max(width >> 1, 1);
+        height = std::max(height >> 1, 1);
+        depth = std::max(depth >> 1, 1);
+    }
+}
+
+void VulkanCommandEncoder::addTransferTexture(VulkanTexture& texture)
+{
+    if (std::find(m_transferTextures.begin(), m_transferTextures.end(), &texture) == m_transferTextures.end())
+        m_transferTextures.push_back(&texture);
+
+    m_commandBuffer.addTexture(texture);
+}
+
+void VulkanCommandEncoder::restoreFinalLayouts()
+{
+    if (m_transferTextures.empty())
+        return;
+
+    VulkanPipelineBarrier barrier{};
+    for (auto texture : m_transferTextures)
+        texture->transitionToFinalLayout(barrier);
+
+    downcast(m_commandBuffer).getCommandRecorder().cmdPipelineBarrier(barrier);
+    m_transferTextures.clear();
+}
+
+void VulkanCommandEncoder::makeBuffersVisibleToRenderPass()
+{
+    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
+    auto& bufferTracker = vulkanCommandBuffer.getBufferTracker();
+
+    bufferTracker.makeVisible(kRenderPassBufferStageMask, kRenderPassBufferAccessMask);
+    bufferTracker.flush(vulkanCommandBuffer.getCommandRecorder());
+}
+
 } // namespace jipu
\ No newline at end of file
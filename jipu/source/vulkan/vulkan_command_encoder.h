@@ -10,11 +10,14 @@
 
 #include "vulkan_render_pass_encoder.h"
 
+#include <vector>
+
 namespace jipu
 {
 
 class VulkanCommandBuffer;
-class VULKAN_EXPORT VulkanCommandEncoder : public CommandEncoder
+class VulkanTexture;
+class VULKAN_EXPORT VulkanCommandEncoder final : public CommandEncoder
 {
 public:
     VulkanCommandEncoder() = delete;
@@ -36,6 +39,16 @@ public:
     void copyTextureToTexture(const BlitTexture& src,
                               const BlitTexture& dst,
                               const Extent3D& extent) override;
+    void copyBufferToBuffer(Buffer& src,
+                            Buffer& dst,
+                            const std::vector<BufferCopyRegion>& regions) override;
+    void copyBufferToTexture(Buffer& buffer,
+                             Texture& texture,
+                             TextureAspectFlags aspect,
+                             const std::vector<BufferTextureCopyRegion>& regions) override;
+    void fillBuffer(Buffer& buffer, uint64_t offset, uint64_t size, uint32_t value) override;
+    void clearBuffer(Buffer& buffer, uint64_t offset, uint64_t size) override;
+    void generateMipmaps(Texture& texture) override;
     void resolveQuerySet(QuerySet* querySet,
                          uint32_t firstQuery,
                          uint32_t queryCount,
@@ -50,8 +63,21 @@ public:
 public:
     VulkanCommandBuffer& getCommandBuffer() const;
 
+private:
+    /// @brief blit the mip levels from the base level of the range in order. the levels are left in transfer layouts.
+    void blitMipmaps(VulkanTexture& texture, const VkImageSubresourceRange& range);
+    void addTransferTexture(VulkanTexture& texture);
+    /// @brief transition textures used by copies to their final layouts with a single barrier.
+    void restoreFinalLayouts();
+    /// @brief make buffer writes visible to the render pass which begins, because barriers can't be recorded in it.
+    void makeBuffersVisibleToRenderPass();
+
 private:
     VulkanCommandBuffer& m_commandBuffer;
+    const bool m_deferred = false;
+
+    // textures which may be in transfer layouts. they are kept until a pass begins or the encoder finishes.
+    std::vector<VulkanTexture*> m_transferTextures{};
 };
 DOWN_CAST(VulkanCommandEncoder, CommandEncoder);
 
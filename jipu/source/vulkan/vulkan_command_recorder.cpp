@@ -0,0 +1,659 @@
+#include "vulkan_command_recorder.h"
+#include "vulkan_command_stream.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace jipu
+{
+
+VulkanCommandRecorder::VulkanCommandRecorder(const VulkanAPI& vkAPI, VkCommandBuffer commandBuffer)
+    : m_vkAPI(vkAPI)
+    , m_commandBuffer(commandBuffer)
+{
+}
+
+void VulkanCommandRecorder::setCommandStream(VulkanCommandStream* commandStream)
+{
+    m_commandStream = commandStream;
+}
+
+VulkanCommandStream* VulkanCommandRecorder::getCommandStream() const
+{
+    return m_commandStream;
+}
+
+uint64_t VulkanCommandRecorder::getBarrierCommandCount() const
+{
+    return m_barrierCommandCount;
+}
+
+void VulkanCommandRecorder::resetBarrierCommandCount()
+{
+    m_barrierCommandCount = 0;
+}
+
+void VulkanCommandRecorder::cmdPipelineBarrier(VkPipelineStageFlags srcStageMask,
+                                               VkPipelineStageFlags dstStageMask,
+                                               VkDependencyFlags dependencyFlags,
+                                               uint32_t memoryBarrierCount,
+                                               const VkMemoryBarrier* memoryBarriers,
+                                               uint32_t bufferMemoryBarrierCount,
+                                               const VkBufferMemoryBarrier* bufferMemoryBarriers,
+                                               uint32_t imageMemoryBarrierCount,
+                                               const VkImageMemoryBarrier* imageMemoryBarriers)
+{
+    ++m_barrierCommandCount;
+
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdPipelineBarrier(m_commandBuffer,
+                                   srcStageMask,
+                                   dstStageMask,
+                                   dependencyFlags,
+                                   memoryBarrierCount,
+                                   memoryBarriers,
+                                   bufferMemoryBarrierCount,
+                                   bufferMemoryBarriers,
+                                   imageMemoryBarrierCount,
+                                   imageMemoryBarriers);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanPipelineBarrierCommand>();
+    command.srcStageMask = srcStageMask;
+    command.dstStageMask = dstStageMask;
+    command.dependencyFlags = dependencyFlags;
+    command.memoryBarrierCount = memoryBarrierCount;
+    command.memoryBarriers = m_commandStream->copy(memoryBarriers, memoryBarrierCount);
+    command.bufferMemoryBarrierCount = bufferMemoryBarrierCount;
+    command.bufferMemoryBarriers = m_commandStream->copy(bufferMemoryBarriers, bufferMemoryBarrierCount);
+    command.imageMemoryBarrierCount = imageMemoryBarrierCount;
+    command.imageMemoryBarriers = m_commandStream->copy(imageMemoryBarriers, imageMemoryBarrierCount);
+}
+
+void VulkanCommandRecorder::cmdPipelineBarrier(const VulkanPipelineBarrier& barrier)
+{
+    if (barrier.imageMemoryBarriers.empty())
+        return;
+
+    cmdPipelineBarrier(barrier.srcStageMask,
+                       barrier.dstStageMask,
+                       0,
+                       0,
+                       nullptr,
+                       0,
+                       nullptr,
+                       static_cast<uint32_t>(barrier.imageMemoryBarriers.size()),
+                       barrier.imageMemoryBarriers.data());
+}
+
+void VulkanCommandRecorder::cmdPipelineBarrier2(const VkDependencyInfo& dependencyInfo)
+{
+    ++m_barrierCommandCount;
+
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdPipelineBarrier2KHR(m_commandBuffer, &dependencyInfo);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanPipelineBarrier2Command>();
+    command.dependencyFlags = dependencyInfo.dependencyFlags;
+    command.memoryBarrierCount = dependencyInfo.memoryBarrierCount;
+    command.memoryBarriers = m_commandStream->copy(dependencyInfo.pMemoryBarriers, dependencyInfo.memoryBarrierCount);
+    command.bufferMemoryBarrierCount = dependencyInfo.bufferMemoryBarrierCount;
+    command.bufferMemoryBarriers = m_commandStream->copy(dependencyInfo.pBufferMemoryBarriers, dependencyInfo.bufferMemoryBarrierCount);
+    command.imageMemoryBarrierCount = dependencyInfo.imageMemoryBarrierCount;
+    command.imageMemoryBarriers = m_commandStream->copy(dependencyInfo.pImageMemoryBarriers, dependencyInfo.imageMemoryBarrierCount);
+}
+
+void VulkanCommandRecorder::cmdCopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy* regions)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdCopyBuffer(m_commandBuffer, srcBuffer, dstBuffer, regionCount, regions);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanCopyBufferCommand>();
+    command.srcBuffer = srcBuffer;
+    command.dstBuffer = dstBuffer;
+    command.regionCount = regionCount;
+    command.regions = m_commandStream->copy(regions, regionCount);
+}
+
+void VulkanCommandRecorder::cmdCopyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkBufferImageCopy* regions)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdCopyBufferToImage(m_commandBuffer, srcBuffer, dstImage, dstImageLayout, regionCount, regions);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanCopyBufferToImageCommand>();
+    command.srcBuffer = srcBuffer;
+    command.dstImage = dstImage;
+    command.dstImageLayout = dstImageLayout;
+    command.regionCount = regionCount;
+    command.regions = m_commandStream->copy(regions, regionCount);
+}
+
+void VulkanCommandRecorder::cmdCopyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferImageCopy* regions)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdCopyImageToBuffer(m_commandBuffer, srcImage, srcImageLayout, dstBuffer, regionCount, regions);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanCopyImageToBufferCommand>();
+    command.srcImage = srcImage;
+    command.srcImageLayout = srcImageLayout;
+    command.dstBuffer = dstBuffer;
+    command.regionCount = regionCount;
+    command.regions = m_commandStream->copy(regions, regionCount);
+}
+
+void VulkanCommandRecorder::cmdCopyImage(VkImage srcImage,
+                                         VkImageLayout srcImageLayout,
+                                         VkImage dstImage,
+                                         VkImageLayout dstImageLayout,
+                                         uint32_t regionCount,
+                                         const VkImageCopy* regions)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdCopyImage(m_commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, regions);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanCopyImageCommand>();
+    command.srcImage = srcImage;
+    command.srcImageLayout = srcImageLayout;
+    command.dstImage = dstImage;
+    command.dstImageLayout = dstImageLayout;
+    command.regionCount = regionCount;
+    command.regions = m_commandStream->copy(regions, regionCount);
+}
+
+void VulkanCommandRecorder::cmdBlitImage(VkImage srcImage,
+                                         VkImageLayout srcImageLayout,
+                                         VkImage dstImage,
+                                         VkImageLayout dstImageLayout,
+                                         uint32_t regionCount,
+                                         const VkImageBlit* regions,
+                                         VkFilter filter)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdBlitImage(m_commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, regions, filter);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanBlitImageCommand>();
+    command.srcImage = srcImage;
+    command.srcImageLayout = srcImageLayout;
+    command.dstImage = dstImage;
+    command.dstImageLayout = dstImageLayout;
+    command.regionCount = regionCount;
+    command.regions = m_commandStream->copy(regions, regionCount);
+    command.filter = filter;
+}
+
+void VulkanCommandRecorder::cmdCopyQueryPoolResults(VkQueryPool queryPool,
+                                                    uint32_t firstQuery,
+                                                    uint32_t queryCount,
+                                                    VkBuffer dstBuffer,
+                                                    VkDeviceSize dstOffset,
+                                                    VkDeviceSize stride,
+                                                    VkQueryResultFlags flags)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdCopyQueryPoolResults(m_commandBuffer, queryPool, firstQuery, queryCount, dstBuffer, dstOffset, stride, flags);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanCopyQueryPoolResultsCommand>();
+    command.queryPool = queryPool;
+    command.firstQuery = firstQuery;
+    command.queryCount = queryCount;
+    command.dstBuffer = dstBuffer;
+    command.dstOffset = dstOffset;
+    command.stride = stride;
+    command.flags = flags;
+}
+
+void VulkanCommandRecorder::cmdFillBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdFillBuffer(m_commandBuffer, dstBuffer, dstOffset, size, data);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanFillBufferCommand>();
+    command.dstBuffer = dstBuffer;
+    command.dstOffset = dstOffset;
+    command.size = size;
+    command.data = data;
+}
+
+void VulkanCommandRecorder::cmdResetQueryPool(VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdResetQueryPool(m_commandBuffer, queryPool, firstQuery, queryCount);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanResetQueryPoolCommand>();
+    command.queryPool = queryPool;
+    command.firstQuery = firstQuery;
+    command.queryCount = queryCount;
+}
+
+void VulkanCommandRecorder::cmdWriteTimestamp(VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t query)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdWriteTimestamp(m_commandBuffer, pipelineStage, queryPool, query);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanWriteTimestampCommand>();
+    command.pipelineStage = pipelineStage;
+    command.queryPool = queryPool;
+    command.query = query;
+}
+
+void VulkanCommandRecorder::cmdBeginQuery(VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdBeginQuery(m_commandBuffer, queryPool, query, flags);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanBeginQueryCommand>();
+    command.queryPool = queryPool;
+    command.query = query;
+    command.flags = flags;
+}
+
+void VulkanCommandRecorder::cmdEndQuery(VkQueryPool queryPool, uint32_t query)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdEndQuery(m_commandBuffer, queryPool, query);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanEndQueryCommand>();
+    command.queryPool = queryPool;
+    command.query = query;
+}
+
+void VulkanCommandRecorder::cmdBeginRenderPass(const VkRenderPassBeginInfo* renderPassBegin, VkSubpassContents contents)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdBeginRenderPass(m_commandBuffer, renderPassBegin, contents);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanBeginRenderPassCommand>();
+    command.renderPass = renderPassBegin->renderPass;
+    command.framebuffer = renderPassBegin->framebuffer;
+    command.renderArea = renderPassBegin->renderArea;
+    command.contents = contents;
+    command.clearValueCount = renderPassBegin->clearValueCount;
+    command.clearValues = m_commandStream->copy(renderPassBegin->pClearValues, renderPassBegin->clearValueCount);
+
+    if (auto next = static_cast<const VkBaseInStructure*>(renderPassBegin->pNext); next)
+    {
+        if (next->sType != VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO || next->pNext)
+            throw std::runtime_error("Only attachment begin info can be chained to the render pass begin info in command stream.");
+
+        auto attachmentBeginInfo = reinterpret_cast<const VkRenderPassAttachmentBeginInfo*>(next);
+        command.attachmentCount = attachmentBeginInfo->attachmentCount;
+        command.attachments = m_commandStream->copy(attachmentBeginInfo->pAttachments, attachmentBeginInfo->attachmentCount);
+    }
+}
+
+void VulkanCommandRecorder::cmdNextSubpass(VkSubpassContents contents)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdNextSubpass(m_commandBuffer, contents);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanNextSubpassCommand>();
+    command.contents = contents;
+}
+
+void VulkanCommandRecorder::cmdEndRenderPass()
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdEndRenderPass(m_commandBuffer);
+        return;
+    }
+
+    m_commandStream->record<VulkanEndRenderPassCommand>();
+}
+
+void VulkanCommandRecorder::cmdBeginRendering(const VkRenderingInfo* renderingInfo)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdBeginRenderingKHR(m_commandBuffer, renderingInfo);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanBeginRenderingCommand>();
+    command.renderingInfo = *renderingInfo;
+    command.renderingInfo.pColorAttachments = m_commandStream->copy(renderingInfo->pColorAttachments, renderingInfo->colorAttachmentCount);
+    command.renderingInfo.pDepthAttachment = m_commandStream->copy(renderingInfo->pDepthAttachment, renderingInfo->pDepthAttachment ? 1 : 0);
+    command.renderingInfo.pStencilAttachment = m_commandStream->copy(renderingInfo->pStencilAttachment, renderingInfo->pStencilAttachment ? 1 : 0);
+}
+
+void VulkanCommandRecorder::cmdEndRendering()
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdEndRenderingKHR(m_commandBuffer);
+        return;
+    }
+
+    m_commandStream->record<VulkanEndRenderingCommand>();
+}
+
+void VulkanCommandRecorder::cmdBindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdBindPipeline(m_commandBuffer, bindPoint, pipeline);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanBindPipelineCommand>();
+    command.bindPoint = bindPoint;
+    command.pipeline = pipeline;
+}
+
+void VulkanCommandRecorder::cmdBindDescriptorSets(VkPipelineBindPoint bindPoint,
+                                                  VkPipelineLayout layout,
+                                                  uint32_t firstSet,
+                                                  uint32_t descriptorSetCount,
+                                                  const VkDescriptorSet* descriptorSets,
+                                                  uint32_t dynamicOffsetCount,
+                                                  const uint32_t* dynamicOffsets)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdBindDescriptorSets(m_commandBuffer, bindPoint, layout, firstSet, descriptorSetCount, descriptorSets, dynamicOffsetCount, dynamicOffsets);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanBindDescriptorSetsCommand>();
+    command.bindPoint = bindPoint;
+    command.layout = layout;
+    command.firstSet = firstSet;
+    command.descriptorSetCount = descriptorSetCount;
+    command.descriptorSets = m_commandStream->copy(descriptorSets, descriptorSetCount);
+    command.dynamicOffsetCount = dynamicOffsetCount;
+    command.dynamicOffsets = m_commandStream->copy(dynamicOffsets, dynamicOffsetCount);
+}
+
+void VulkanCommandRecorder::cmdPushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* values)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdPushConstants(m_commandBuffer, layout, stageFlags, offset, size, values);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanPushConstantsCommand>();
+    command.layout = layout;
+    command.stageFlags = stageFlags;
+    command.offset = offset;
+    command.size = size;
+    command.values = m_commandStream->copy(static_cast<const std::byte*>(values), size);
+}
+
+void VulkanCommandRecorder::cmdPushDescriptorSet(VkPipelineBindPoint bindPoint,
+                                                 VkPipelineLayout layout,
+                                                 uint32_t set,
+                                                 uint32_t descriptorWriteCount,
+                                                 const VkWriteDescriptorSet* descriptorWrites)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdPushDescriptorSetKHR(m_commandBuffer, bindPoint, layout, set, descriptorWriteCount, descriptorWrites);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanPushDescriptorSetCommand>();
+    command.bindPoint = bindPoint;
+    command.layout = layout;
+    command.set = set;
+    command.descriptorWriteCount = descriptorWriteCount;
+
+    // writes point to infos which are released after recording. copy them together.
+    auto writes = const_cast<VkWriteDescriptorSet*>(m_commandStream->copy(descriptorWrites, descriptorWriteCount));
+    for (uint32_t i = 0; i < descriptorWriteCount; ++i)
+    {
+        auto& write = writes[i];
+        if (write.pNext)
+            throw std::runtime_error("Next chain of descriptor write is not supported in command stream.");
+
+        write.pImageInfo = m_commandStream->copy(write.pImageInfo, write.pImageInfo ? write.descriptorCount : 0);
+        write.pBufferInfo = m_commandStream->copy(write.pBufferInfo, write.pBufferInfo ? write.descriptorCount : 0);
+        write.pTexelBufferView = m_commandStream->copy(write.pTexelBufferView, write.pTexelBufferView ? write.descriptorCount : 0);
+    }
+    command.descriptorWrites = writes;
+}
+
+void VulkanCommandRecorder::cmdBindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers, const VkDeviceSize* offsets)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdBindVertexBuffers(m_commandBuffer, firstBinding, bindingCount, buffers, offsets);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanBindVertexBuffersCommand>();
+    command.firstBinding = firstBinding;
+    command.bindingCount = bindingCount;
+    command.buffers = m_commandStream->copy(buffers, bindingCount);
+    command.offsets = m_commandStream->copy(offsets, bindingCount);
+}
+
+void VulkanCommandRecorder::cmdBindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdBindIndexBuffer(m_commandBuffer, buffer, offset, indexType);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanBindIndexBufferCommand>();
+    command.buffer = buffer;
+    command.offset = offset;
+    command.indexType = indexType;
+}
+
+void VulkanCommandRecorder::cmdSetViewport(const VkViewport& viewport)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdSetViewport(m_commandBuffer, 0, 1, &viewport);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanSetViewportCommand>();
+    command.viewport = viewport;
+}
+
+void VulkanCommandRecorder::cmdSetScissor(const VkRect2D& scissor)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdSetScissor(m_commandBuffer, 0, 1, &scissor);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanSetScissorCommand>();
+    command.scissor = scissor;
+}
+
+void VulkanCommandRecorder::cmdSetBlendConstants(const float blendConstants[4])
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdSetBlendConstants(m_commandBuffer, blendConstants);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanSetBlendConstantsCommand>();
+    std::copy(blendConstants, blendConstants + 4, command.blendConstants);
+}
+
+void VulkanCommandRecorder::cmdDraw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdDraw(m_commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanDrawCommand>();
+    command.vertexCount = vertexCount;
+    command.instanceCount = instanceCount;
+    command.firstVertex = firstVertex;
+    command.firstInstance = firstInstance;
+}
+
+void VulkanCommandRecorder::cmdDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdDrawIndexed(m_commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanDrawIndexedCommand>();
+    command.indexCount = indexCount;
+    command.instanceCount = instanceCount;
+    command.firstIndex = firstIndex;
+    command.vertexOffset = vertexOffset;
+    command.firstInstance = firstInstance;
+}
+
+void VulkanCommandRecorder::cmdDrawIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdDrawIndirect(m_commandBuffer, buffer, offset, drawCount, stride);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanDrawIndirectCommand>();
+    command.buffer = buffer;
+    command.offset = offset;
+    command.drawCount = drawCount;
+    command.stride = stride;
+}
+
+void VulkanCommandRecorder::cmdDrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdDrawIndexedIndirect(m_commandBuffer, buffer, offset, drawCount, stride);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanDrawIndirectCommand>();
+    command.type = VulkanCommandType::kDrawIndexedIndirect;
+    command.buffer = buffer;
+    command.offset = offset;
+    command.drawCount = drawCount;
+    command.stride = stride;
+}
+
+void VulkanCommandRecorder::cmdDrawIndirectCount(VkBuffer buffer,
+                                                 VkDeviceSize offset,
+                                                 VkBuffer countBuffer,
+                                                 VkDeviceSize countBufferOffset,
+                                                 uint32_t maxDrawCount,
+                                                 uint32_t stride)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdDrawIndirectCountKHR(m_commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanDrawIndirectCountCommand>();
+    command.buffer = buffer;
+    command.offset = offset;
+    command.countBuffer = countBuffer;
+    command.countBufferOffset = countBufferOffset;
+    command.maxDrawCount = maxDrawCount;
+    command.stride = stride;
+}
+
+void VulkanCommandRecorder::cmdDrawIndexedIndirectCount(VkBuffer buffer,
+                                                        VkDeviceSize offset,
+                                                        VkBuffer countBuffer,
+                                                        VkDeviceSize countBufferOffset,
+                                                        uint32_t maxDrawCount,
+                                                        uint32_t stride)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdDrawIndexedIndirectCountKHR(m_commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanDrawIndirectCountCommand>();
+    command.type = VulkanCommandType::kDrawIndexedIndirectCount;
+    command.buffer = buffer;
+    command.offset = offset;
+    command.countBuffer = countBuffer;
+    command.countBufferOffset = countBufferOffset;
+    command.maxDrawCount = maxDrawCount;
+    command.stride = stride;
+}
+
+void VulkanCommandRecorder::cmdDispatch(uint32_t x, uint32_t y, uint32_t z)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdDispatch(m_commandBuffer, x, y, z);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanDispatchCommand>();
+    command.x = x;
+    command.y = y;
+    command.z = z;
+}
+
+void VulkanCommandRecorder::cmdDispatchIndirect(VkBuffer buffer, VkDeviceSize offset)
+{
+    if (!m_commandStream)
+    {
+        m_vkAPI.CmdDispatchIndirect(m_commandBuffer, buffer, offset);
+        return;
+    }
+
+    auto& command = m_commandStream->record<VulkanDispatchIndirectCommand>();
+    command.buffer = buffer;
+    command.offset = offset;
+}
+
+} // namespace jipu
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "vulkan_api.h"
+#include "vulkan_export.h"
+
+#include <vector>
+
+namespace jipu
+{
+
+/// @brief barriers which are batched into a pipeline barrier command.
+struct VulkanPipelineBarrier
+{
+    VkPipelineStageFlags srcStageMask = 0u;
+    VkPipelineStageFlags dstStageMask = 0u;
+    std::vector<VkImageMemoryBarrier> imageMemoryBarriers{};
+};
+
+class VulkanCommandStream;
+
+/// @brief records commands to the command buffer directly, or to the command stream if it is set.
+/// arrays are copied into the stream, but next chains are referenced and must be valid until the stream is translated.
+class VULKAN_EXPORT VulkanCommandRecorder final
+{
+public:
+    VulkanCommandRecorder() = delete;
+    VulkanCommandRecorder(const VulkanAPI& vkAPI, VkCommandBuffer commandBuffer);
+    ~VulkanCommandRecorder() = default;
+
+    VulkanCommandRecorder(const VulkanCommandRecorder&) = delete;
+    VulkanCommandRecorder& operator=(const VulkanCommandRecorder&) = delete;
+
+public:
+    /// @brief record commands directly if null.
+    void setCommandStream(VulkanCommandStream* commandStream);
+    VulkanCommandStream* getCommandStream() const;
+
+    /// @brief pipeline barrier commands which are recorded since the last reset, before deferred barriers are merged.
+    uint64_t getBarrierCommandCount() const;
+    void resetBarrierCommandCount();
+
+public:
+    void cmdPipelineBarrier(VkPipelineStageFlags srcStageMask,
+                            VkPipelineStageFlags dstStageMask,
+                            VkDependencyFlags dependencyFlags,
+                            uint32_t memoryBarrierCount,
+                            const VkMemoryBarrier* memoryBarriers,
+                            uint32_t bufferMemoryBarrierCount,
+                            const VkBufferMemoryBarrier* bufferMemoryBarriers,
+                            uint32_t imageMemoryBarrierCount,
+                            const VkImageMemoryBarrier* imageMemoryBarriers);
+    /// @brief record nothing if there is no barrier.
+    void cmdPipelineBarrier(const VulkanPipelineBarrier& barrier);
+    /// @brief VK_KHR_synchronization2 is required. next chain of the info is not recorded.
+    void cmdPipelineBarrier2(const VkDependencyInfo& dependencyInfo);
+
+    void cmdCopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy* regions);
+    void cmdCopyBufferToImage(VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkBufferImageCopy* regions);
+    void cmdCopyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferImageCopy* regions);
+    void cmdCopyImage(VkImage srcImage,
+                      VkImageLayout srcImageLayout,
+                      VkImage dstImage,
+                      VkImageLayout dstImageLayout,
+                      uint32_t regionCount,
+                      const VkImageCopy* regions);
+    void cmdBlitImage(VkImage srcImage,
+                      VkImageLayout srcImageLayout,
+                      VkImage dstImage,
+                      VkImageLayout dstImageLayout,
+                      uint32_t regionCount,
+                      const VkImageBlit* regions,
+                      VkFilter filter);
+    void cmdCopyQueryPoolResults(VkQueryPool queryPool,
+                                 uint32_t firstQuery,
+                                 uint32_t queryCount,
+                                 VkBuffer dstBuffer,
+                                 VkDeviceSize dstOffset,
+                                 VkDeviceSize stride,
+                                 VkQueryResultFlags flags);
+    void cmdFillBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data);
+
+    void cmdResetQueryPool(VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount);
+    void cmdWriteTimestamp(VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t query);
+    void cmdBeginQuery(VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags);
+    void cmdEndQuery(VkQueryPool queryPool, uint32_t query);
+
+    void cmdBeginRenderPass(const VkRenderPassBeginInfo* renderPassBegin, VkSubpassContents contents);
+    void cmdNextSubpass(VkSubpassContents contents);
+    void cmdEndRenderPass();
+    void cmdBeginRendering(const VkRenderingInfo* renderingInfo);
+    void cmdEndRendering();
+
+    void cmdBindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+    void cmdBindDescriptorSets(VkPipelineBindPoint bindPoint,
+                               VkPipelineLayout layout,
+                               uint32_t firstSet,
+                               uint32_t descriptorSetCount,
+                               const VkDescriptorSet* descriptorSets,
+                               uint32_t dynamicOffsetCount,
+                               const uint32_t* dynamicOffsets);
+    void cmdPushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* values);
+    void cmdPushDescriptorSet(VkPipelineBindPoint bindPoint,
+                              VkPipelineLayout layout,
+                              uint32_t set,
+                              uint32_t descriptorWriteCount,
+                              const VkWriteDescriptorSet* descriptorWrites);
+    void cmdBindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers, const VkDeviceSize* offsets);
+    void cmdBindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
+    void cmdSetViewport(const VkViewport& viewport);
+    void cmdSetScissor(const VkRect2D& scissor);
+    void cmdSetBlendConstants(const float blendConstants[4]);
+
+    void cmdDraw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
+    void cmdDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance);
+    void cmdDrawIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
+    void cmdDrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
+    void cmdDrawIndirectCount(VkBuffer buffer,
+                              VkDeviceSize offset,
+                              VkBuffer countBuffer,
+                              VkDeviceSize countBufferOffset,
+                              uint32_t maxDrawCount,
+                              uint32_t stride);
+    void cmdDrawIndexedIndirectCount(VkBuffer buffer,
+                                     VkDeviceSize offset,
+                                     VkBuffer countBuffer,
+                                     VkDeviceSize countBufferOffset,
+                                     uint32_t maxDrawCount,
+                                     uint32_t stride);
+    void cmdDispatch(uint32_t x, uint32_t y, uint32_t z);
+    void cmdDispatchIndirect(VkBuffer buffer, VkDeviceSize offset);
+
+private:
+    const VulkanAPI& m_vkAPI;
+    const VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+
+    VulkanCommandStream* m_commandStream = nullptr;
+    uint64_t m_barrierCommandCount = 0;
+};
+
+} // namespace jipu
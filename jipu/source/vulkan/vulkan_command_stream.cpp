@@ -0,0 +1,954 @@
+#include "vulkan_command_stream.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <optional>
+
+namespace jipu
+{
+
+namespace
+{
+
+size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename T>
+uint64_t toHandle(T handle)
+{
+    // non-dispatchable handles are pointers or 64 bit integers depending on the platform.
+    return (uint64_t)(handle);
+}
+
+template <typename T>
+bool equalArray(const T* lhs, uint32_t lhsCount, const T* rhs, uint32_t rhsCount)
+{
+    if (lhsCount != rhsCount)
+        return false;
+
+    return lhsCount == 0 || std::memcmp(lhs, rhs, sizeof(T) * lhsCount) == 0;
+}
+
+bool overlaps(uint32_t lhsBase, uint32_t lhsCount, uint32_t rhsBase, uint32_t rhsCount)
+{
+    const uint64_t lhsEnd = lhsCount == VK_REMAINING_MIP_LEVELS ? UINT64_MAX : static_cast<uint64_t>(lhsBase) + lhsCount;
+    const uint64_t rhsEnd = rhsCount == VK_REMAINING_MIP_LEVELS ? UINT64_MAX : static_cast<uint64_t>(rhsBase) + rhsCount;
+
+    return lhsBase < rhsEnd && rhsBase < lhsEnd;
+}
+
+bool overlaps(const VkImageSubresourceRange& lhs, const VkImageSubresourceRange& rhs)
+{
+    return (lhs.aspectMask & rhs.aspectMask) &&
+           overlaps(lhs.baseMipLevel, lhs.levelCount, rhs.baseMipLevel, rhs.levelCount) &&
+           overlaps(lhs.baseArrayLayer, lhs.layerCount, rhs.baseArrayLayer, rhs.layerCount);
+}
+
+bool isTransferCommand(VulkanCommandType type)
+{
+    switch (type)
+    {
+    case VulkanCommandType::kPipelineBarrier:
+    case VulkanCommandType::kCopyBuffer:
+    case VulkanCommandType::kCopyBufferToImage:
+    case VulkanCommandType::kCopyImageToBuffer:
+    case VulkanCommandType::kCopyImage:
+    case VulkanCommandType::kBlitImage:
+    case VulkanCommandType::kCopyQueryPoolResults:
+    case VulkanCommandType::kFillBuffer:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// resources which are accessed by a transfer command. barriers write all resources in them.
+struct TransferAccess
+{
+    bool global = false;
+    std::vector<std::pair<uint64_t, bool>> resources{}; // handle, write
+};
+
+void gatherTransferAccess(const VulkanCommand* command, TransferAccess& access)
+{
+    access.global = false;
+    access.resources.clear();
+
+    switch (command->type)
+    {
+    case VulkanCommandType::kPipelineBarrier: {
+        auto cmd = static_cast<const VulkanPipelineBarrierCommand*>(command);
+        access.global = cmd->memoryBarrierCount > 0;
+        for (uint32_t i = 0; i < cmd->bufferMemoryBarrierCount; ++i)
+            access.resources.push_back({ toHandle(cmd->bufferMemoryBarriers[i].buffer), true });
+        for (uint32_t i = 0; i < cmd->imageMemoryBarrierCount; ++i)
+            access.resources.push_back({ toHandle(cmd->imageMemoryBarriers[i].image), true });
+    }
+    break;
+    case VulkanCommandType::kCopyBuffer: {
+        auto cmd = static_cast<const VulkanCopyBufferCommand*>(command);
+        access.resources.push_back({ toHandle(cmd->srcBuffer), false });
+        access.resources.push_back({ toHandle(cmd->dstBuffer), true });
+    }
+    break;
+    case VulkanCommandType::kCopyBufferToImage: {
+        auto cmd = static_cast<const VulkanCopyBufferToImageCommand*>(command);
+        access.resources.push_back({ toHandle(cmd->srcBuffer), false });
+        access.resources.push_back({ toHandle(cmd->dstImage), true });
+    }
+    break;
+    case VulkanCommandType::kCopyImageToBuffer: {
+        auto cmd = static_cast<const VulkanCopyImageToBufferCommand*>(command);
+        access.resources.push_back({ toHandle(cmd->srcImage), false });
+        access.resources.push_back({ toHandle(cmd->dstBuffer), true });
+    }
+    break;
+    case VulkanCommandType::kCopyImage: {
+        auto cmd = static_cast<const VulkanCopyImageCommand*>(command);
+        access.resources.push_back({ toHandle(cmd->srcImage), false });
+        access.resources.push_back({ toHandle(cmd->dstImage), true });
+    }
+    break;
+    case VulkanCommandType::kBlitImage: {
+        auto cmd = static_cast<const VulkanBlitImageCommand*>(command);
+        access.resources.push_back({ toHandle(cmd->srcImage), false });
+        access.resources.push_back({ toHandle(cmd->dstImage), true });
+    }
+    break;
+    case VulkanCommandType::kCopyQueryPoolResults: {
+        auto cmd = static_cast<const VulkanCopyQueryPoolResultsCommand*>(command);
+        access.resources.push_back({ toHandle(cmd->queryPool), false });
+        access.resources.push_back({ toHandle(cmd->dstBuffer), true });
+    }
+    break;
+    case VulkanCommandType::kFillBuffer: {
+        auto cmd = static_cast<const VulkanFillBufferCommand*>(command);
+        access.resources.push_back({ toHandle(cmd->dstBuffer), true });
+    }
+    break;
+    default:
+        break;
+    }
+}
+
+bool conflicts(const TransferAccess& lhs, const TransferAccess& rhs)
+{
+    if (lhs.global || rhs.global)
+        return true;
+
+    for (const auto& [lhsHandle, lhsWrite] : lhs.resources)
+    {
+        for (const auto& [rhsHandle, rhsWrite] : rhs.resources)
+        {
+            if (lhsHandle == rhsHandle && (lhsWrite || rhsWrite))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// commands in a transfer segment are scheduled by dependency.
+// barriers are placed in even waves and other transfers in odd waves, so independent barriers become adjacent
+// and are merged. the order of commands which depend on each other is kept.
+class TransferScheduler
+{
+public:
+    static constexpr size_t kMaxWindow = 64;
+
+    uint64_t schedule(std::span<const VulkanCommand*> segment)
+    {
+        const size_t count = segment.size();
+        if (count < 3)
+            return 0;
+
+        m_accesses.resize(std::max(m_accesses.size(), count));
+        for (size_t i = 0; i < count; ++i)
+            gatherTransferAccess(segment[i], m_accesses[i]);
+
+        // predecessors as a bit matrix. window is small, so dense matrix is cheaper than lists.
+        m_dependencies.assign(count * count, false);
+        auto depends = [&](size_t after, size_t before) { m_dependencies[after * count + before] = true; };
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            const bool barrier = segment[j]->type == VulkanCommandType::kPipelineBarrier;
+            for (size_t i = 0; i < j; ++i)
+            {
+                if (!conflicts(m_accesses[i], m_accesses[j]))
+                    continue;
+
+                depends(j, i);
+
+                // a transfer may be synchronized with an earlier one by barriers between them.
+                // keep those barriers between them even if they are for other resources.
+                const bool transfer = segment[i]->type != VulkanCommandType::kPipelineBarrier;
+                if (!barrier && transfer)
+                {
+                    for (size_t b = i + 1; b < j; ++b)
+                    {
+                        if (segment[b]->type != VulkanCommandType::kPipelineBarrier)
+                            continue;
+
+                        depends(b, i);
+                        depends(j, b);
+                    }
+                }
+            }
+        }
+
+        m_waves.assign(count, 0);
+        for (size_t j = 0; j < count; ++j)
+        {
+            uint32_t wave = 0;
+            for (size_t i = 0; i < j; ++i)
+            {
+                if (m_dependencies[j * count + i])
+                    wave = std::max(wave, m_waves[i] + 1);
+            }
+
+            const uint32_t parity = segment[j]->type == VulkanCommandType::kPipelineBarrier ? 0 : 1;
+            if ((wave & 1) != parity)
+                ++wave;
+
+            m_waves[j] = wave;
+        }
+
+        m_order.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            m_order[i] = static_cast<uint32_t>(i);
+        std::stable_sort(m_order.begin(), m_order.end(), [&](uint32_t lhs, uint32_t rhs) { return m_waves[lhs] < m_waves[rhs]; });
+
+        uint64_t reordered = 0;
+        m_commands.assign(segment.begin(), segment.end());
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (m_order[i] != i)
+                ++reordered;
+            segment[i] = m_commands[m_order[i]];
+        }
+
+        return reordered;
+    }
+
+private:
+    std::vector<TransferAccess> m_accesses{};
+    std::vector<bool> m_dependencies{};
+    std::vector<uint32_t> m_waves{};
+    std::vector<uint32_t> m_order{};
+    std::vector<const VulkanCommand*> m_commands{};
+};
+
+class CommandTranslator
+{
+public:
+    CommandTranslator(const VulkanAPI& vkAPI, VkCommandBuffer commandBuffer, VulkanCommandStreamStatistics& statistics)
+        : m_vkAPI(vkAPI)
+        , m_commandBuffer(commandBuffer)
+        , m_statistics(statistics)
+    {
+    }
+
+    void translate(const VulkanCommand* command)
+    {
+        if (command->type != VulkanCommandType::kPipelineBarrier)
+            flushBarrier();
+        if (command->type != VulkanCommandType::kBindDescriptorSets)
+            flushDescriptorSets();
+
+        switch (command->type)
+        {
+        case VulkanCommandType::kPipelineBarrier:
+            pipelineBarrier(*static_cast<const VulkanPipelineBarrierCommand*>(command));
+            break;
+        case VulkanCommandType::kCopyBuffer: {
+            auto cmd = static_cast<const VulkanCopyBufferCommand*>(command);
+            m_vkAPI.CmdCopyBuffer(m_commandBuffer, cmd->srcBuffer, cmd->dstBuffer, cmd->regionCount, cmd->regions);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kCopyBufferToImage: {
+            auto cmd = static_cast<const VulkanCopyBufferToImageCommand*>(command);
+            m_vkAPI.CmdCopyBufferToImage(m_commandBuffer, cmd->srcBuffer, cmd->dstImage, cmd->dstImageLayout, cmd->regionCount, cmd->regions);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kCopyImageToBuffer: {
+            auto cmd = static_cast<const VulkanCopyImageToBufferCommand*>(command);
+            m_vkAPI.CmdCopyImageToBuffer(m_commandBuffer, cmd->srcImage, cmd->srcImageLayout, cmd->dstBuffer, cmd->regionCount, cmd->regions);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kCopyImage: {
+            auto cmd = static_cast<const VulkanCopyImageCommand*>(command);
+            m_vkAPI.CmdCopyImage(m_commandBuffer, cmd->srcImage, cmd->srcImageLayout, cmd->dstImage, cmd->dstImageLayout, cmd->regionCount, cmd->regions);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kBlitImage: {
+            auto cmd = static_cast<const VulkanBlitImageCommand*>(command);
+            m_vkAPI.CmdBlitImage(m_commandBuffer, cmd->srcImage, cmd->srcImageLayout, cmd->dstImage, cmd->dstImageLayout, cmd->regionCount, cmd->regions, cmd->filter);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kCopyQueryPoolResults: {
+            auto cmd = static_cast<const VulkanCopyQueryPoolResultsCommand*>(command);
+            m_vkAPI.CmdCopyQueryPoolResults(m_commandBuffer, cmd->queryPool, cmd->firstQuery, cmd->queryCount, cmd->dstBuffer, cmd->dstOffset, cmd->stride, cmd->flags);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kFillBuffer: {
+            auto cmd = static_cast<const VulkanFillBufferCommand*>(command);
+            m_vkAPI.CmdFillBuffer(m_commandBuffer, cmd->dstBuffer, cmd->dstOffset, cmd->size, cmd->data);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kResetQueryPool: {
+            auto cmd = static_cast<const VulkanResetQueryPoolCommand*>(command);
+            m_vkAPI.CmdResetQueryPool(m_commandBuffer, cmd->queryPool, cmd->firstQuery, cmd->queryCount);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kWriteTimestamp: {
+            auto cmd = static_cast<const VulkanWriteTimestampCommand*>(command);
+            m_vkAPI.CmdWriteTimestamp(m_commandBuffer, cmd->pipelineStage, cmd->queryPool, cmd->query);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kBeginQuery: {
+            auto cmd = static_cast<const VulkanBeginQueryCommand*>(command);
+            m_vkAPI.CmdBeginQuery(m_commandBuffer, cmd->queryPool, cmd->query, cmd->flags);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kEndQuery: {
+            auto cmd = static_cast<const VulkanEndQueryCommand*>(command);
+            m_vkAPI.CmdEndQuery(m_commandBuffer, cmd->queryPool, cmd->query);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kBeginRenderPass:
+            beginRenderPass(*static_cast<const VulkanBeginRenderPassCommand*>(command));
+            break;
+        case VulkanCommandType::kNextSubpass: {
+            auto cmd = static_cast<const VulkanNextSubpassCommand*>(command);
+            m_vkAPI.CmdNextSubpass(m_commandBuffer, cmd->contents);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kEndRenderPass:
+            m_vkAPI.CmdEndRenderPass(m_commandBuffer);
+            ++m_statistics.translatedCommands;
+            break;
+        case VulkanCommandType::kBeginRendering: {
+            auto cmd = static_cast<const VulkanBeginRenderingCommand*>(command);
+            m_vkAPI.CmdBeginRenderingKHR(m_commandBuffer, &cmd->renderingInfo);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kEndRendering:
+            m_vkAPI.CmdEndRenderingKHR(m_commandBuffer);
+            ++m_statistics.translatedCommands;
+            break;
+        case VulkanCommandType::kBindPipeline:
+            bindPipeline(*static_cast<const VulkanBindPipelineCommand*>(command));
+            break;
+        case VulkanCommandType::kBindDescriptorSets:
+            bindDescriptorSets(*static_cast<const VulkanBindDescriptorSetsCommand*>(command));
+            break;
+        case VulkanCommandType::kPushConstants: {
+            auto cmd = static_cast<const VulkanPushConstantsCommand*>(command);
+            m_vkAPI.CmdPushConstants(m_commandBuffer, cmd->layout, cmd->stageFlags, cmd->offset, cmd->size, cmd->values);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kPushDescriptorSet:
+            pushDescriptorSet(*static_cast<const VulkanPushDescriptorSetCommand*>(command));
+            break;
+        case VulkanCommandType::kBindVertexBuffers:
+            bindVertexBuffers(*static_cast<const VulkanBindVertexBuffersCommand*>(command));
+            break;
+        case VulkanCommandType::kBindIndexBuffer:
+            bindIndexBuffer(*static_cast<const VulkanBindIndexBufferCommand*>(command));
+            break;
+        case VulkanCommandType::kSetViewport: {
+            auto cmd = static_cast<const VulkanSetViewportCommand*>(command);
+            if (m_viewport.has_value() && std::memcmp(&m_viewport.value(), &cmd->viewport, sizeof(VkViewport)) == 0)
+            {
+                ++m_statistics.elidedCommands;
+                break;
+            }
+            m_vkAPI.CmdSetViewport(m_commandBuffer, 0, 1, &cmd->viewport);
+            m_viewport = cmd->viewport;
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kSetScissor: {
+            auto cmd = static_cast<const VulkanSetScissorCommand*>(command);
+            if (m_scissor.has_value() && std::memcmp(&m_scissor.value(), &cmd->scissor, sizeof(VkRect2D)) == 0)
+            {
+                ++m_statistics.elidedCommands;
+                break;
+            }
+            m_vkAPI.CmdSetScissor(m_commandBuffer, 0, 1, &cmd->scissor);
+            m_scissor = cmd->scissor;
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kSetBlendConstants: {
+            auto cmd = static_cast<const VulkanSetBlendConstantsCommand*>(command);
+            std::array<float, 4> blendConstants{};
+            std::copy(std::begin(cmd->blendConstants), std::end(cmd->blendConstants), blendConstants.begin());
+            if (m_blendConstants == blendConstants)
+            {
+                ++m_statistics.elidedCommands;
+                break;
+            }
+            m_vkAPI.CmdSetBlendConstants(m_commandBuffer, cmd->blendConstants);
+            m_blendConstants = blendConstants;
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kDraw: {
+            auto cmd = static_cast<const VulkanDrawCommand*>(command);
+            m_vkAPI.CmdDraw(m_commandBuffer, cmd->vertexCount, cmd->instanceCount, cmd->firstVertex, cmd->firstInstance);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kDrawIndexed: {
+            auto cmd = static_cast<const VulkanDrawIndexedCommand*>(command);
+            m_vkAPI.CmdDrawIndexed(m_commandBuffer, cmd->indexCount, cmd->instanceCount, cmd->firstIndex, cmd->vertexOffset, cmd->firstInstance);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kDrawIndirect: {
+            auto cmd = static_cast<const VulkanDrawIndirectCommand*>(command);
+            m_vkAPI.CmdDrawIndirect(m_commandBuffer, cmd->buffer, cmd->offset, cmd->drawCount, cmd->stride);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kDrawIndexedIndirect: {
+            auto cmd = static_cast<const VulkanDrawIndirectCommand*>(command);
+            m_vkAPI.CmdDrawIndexedIndirect(m_commandBuffer, cmd->buffer, cmd->offset, cmd->drawCount, cmd->stride);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kDrawIndirectCount: {
+            auto cmd = static_cast<const VulkanDrawIndirectCountCommand*>(command);
+            m_vkAPI.CmdDrawIndirectCountKHR(m_commandBuffer, cmd->buffer, cmd->offset, cmd->countBuffer, cmd->countBufferOffset, cmd->maxDrawCount, cmd->stride);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kDrawIndexedIndirectCount: {
+            auto cmd = static_cast<const VulkanDrawIndirectCountCommand*>(command);
+            m_vkAPI.CmdDrawIndexedIndirectCountKHR(m_commandBuffer, cmd->buffer, cmd->offset, cmd->countBuffer, cmd->countBufferOffset, cmd->maxDrawCount, cmd->stride);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kDispatch: {
+            auto cmd = static_cast<const VulkanDispatchCommand*>(command);
+            m_vkAPI.CmdDispatch(m_commandBuffer, cmd->x, cmd->y, cmd->z);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kDispatchIndirect: {
+            auto cmd = static_cast<const VulkanDispatchIndirectCommand*>(command);
+            m_vkAPI.CmdDispatchIndirect(m_commandBuffer, cmd->buffer, cmd->offset);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        case VulkanCommandType::kPipelineBarrier2: {
+            auto cmd = static_cast<const VulkanPipelineBarrier2Command*>(command);
+
+            VkDependencyInfo dependencyInfo{ .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+            dependencyInfo.dependencyFlags = cmd->dependencyFlags;
+            dependencyInfo.memoryBarrierCount = cmd->memoryBarrierCount;
+            dependencyInfo.pMemoryBarriers = cmd->memoryBarriers;
+            dependencyInfo.bufferMemoryBarrierCount = cmd->bufferMemoryBarrierCount;
+            dependencyInfo.pBufferMemoryBarriers = cmd->bufferMemoryBarriers;
+            dependencyInfo.imageMemoryBarrierCount = cmd->imageMemoryBarrierCount;
+            dependencyInfo.pImageMemoryBarriers = cmd->imageMemoryBarriers;
+
+            m_vkAPI.CmdPipelineBarrier2KHR(m_commandBuffer, &dependencyInfo);
+            ++m_statistics.translatedCommands;
+        }
+        break;
+        }
+    }
+
+    void finish()
+    {
+        flushBarrier();
+        flushDescriptorSets();
+    }
+
+private:
+    struct PendingBarrier
+    {
+        bool valid = false;
+        VkPipelineStageFlags srcStageMask = 0u;
+        VkPipelineStageFlags dstStageMask = 0u;
+        VkDependencyFlags dependencyFlags = 0u;
+        std::vector<VkMemoryBarrier> memoryBarriers{};
+        std::vector<VkBufferMemoryBarrier> bufferMemoryBarriers{};
+        std::vector<VkImageMemoryBarrier> imageMemoryBarriers{};
+    };
+
+    struct PendingDescriptorSets
+    {
+        bool valid = false;
+        VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        uint32_t firstSet = 0;
+        std::vector<VkDescriptorSet> descriptorSets{};
+        std::vector<uint32_t> dynamicOffsets{};
+    };
+
+    // a set which is bound in the command buffer with the range of the command which bound it.
+    struct BoundDescriptorSet
+    {
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        uint32_t firstSet = 0;
+        uint32_t setCount = 0;
+        const uint32_t* dynamicOffsets = nullptr;
+        uint32_t dynamicOffsetCount = 0;
+    };
+
+    struct BindPointState
+    {
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        std::vector<BoundDescriptorSet> descriptorSets{};
+    };
+
+    BindPointState& getBindPointState(VkPipelineBindPoint bindPoint)
+    {
+        return bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE ? m_compute : m_graphics;
+    }
+
+    // returns false if the barrier can not be executed together with pending barriers.
+    bool mergeBarrier(const VulkanPipelineBarrierCommand& cmd)
+    {
+        if (cmd.dependencyFlags != m_barrier.dependencyFlags)
+            return false;
+
+        // global barriers may form a dependency chain with any barrier.
+        if (cmd.memoryBarrierCount > 0 || !m_barrier.memoryBarriers.empty())
+            return false;
+
+        for (uint32_t i = 0; i < cmd.bufferMemoryBarrierCount; ++i)
+        {
+            for (const auto& pending : m_barrier.bufferMemoryBarriers)
+            {
+                if (pending.buffer == cmd.bufferMemoryBarriers[i].buffer)
+                    return false;
+            }
+        }
+
+        // transitions of the same subresource are fused if the new one starts from the pending one.
+        m_fuseTargets.assign(cmd.imageMemoryBarrierCount, -1);
+        for (uint32_t i = 0; i < cmd.imageMemoryBarrierCount; ++i)
+        {
+            const auto& barrier = cmd.imageMemoryBarriers[i];
+            for (size_t p = 0; p < m_barrier.imageMemoryBarriers.size(); ++p)
+            {
+                const auto& pending = m_barrier.imageMemoryBarriers[p];
+                if (pending.image != barrier.image || !overlaps(pending.subresourceRange, barrier.subresourceRange))
+                    continue;
+
+                const bool fusible = m_fuseTargets[i] < 0 &&
+                                     std::memcmp(&pending.subresourceRange, &barrier.subresourceRange, sizeof(VkImageSubresourceRange)) == 0 &&
+                                     pending.newLayout == barrier.oldLayout &&
+                                     pending.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED &&
+                                     barrier.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED;
+                if (!fusible)
+                    return false;
+
+                m_fuseTargets[i] = static_cast<int32_t>(p);
+            }
+        }
+
+        for (uint32_t i = 0; i < cmd.imageMemoryBarrierCount; ++i)
+        {
+            if (m_fuseTargets[i] < 0)
+            {
+                m_barrier.imageMemoryBarriers.push_back(cmd.imageMemoryBarriers[i]);
+                continue;
+            }
+
+            auto& pending = m_barrier.imageMemoryBarriers[m_fuseTargets[i]];
+            pending.newLayout = cmd.imageMemoryBarriers[i].newLayout;
+            pending.dstAccessMask = cmd.imageMemoryBarriers[i].dstAccessMask;
+        }
+        m_barrier.bufferMemoryBarriers.insert(m_barrier.bufferMemoryBarriers.end(), cmd.bufferMemoryBarriers, cmd.bufferMemoryBarriers + cmd.bufferMemoryBarrierCount);
+        m_barrier.srcStageMask |= cmd.srcStageMask;
+        m_barrier.dstStageMask |= cmd.dstStageMask;
+
+        return true;
+    }
+
+    void pipelineBarrier(const VulkanPipelineBarrierCommand& cmd)
+    {
+        if (m_barrier.valid)
+        {
+            if (mergeBarrier(cmd))
+            {
+                ++m_statistics.mergedBarriers;
+                return;
+            }
+
+            flushBarrier();
+        }
+
+        m_barrier.valid = true;
+        m_barrier.srcStageMask = cmd.srcStageMask;
+        m_barrier.dstStageMask = cmd.dstStageMask;
+        m_barrier.dependencyFlags = cmd.dependencyFlags;
+        m_barrier.memoryBarriers.assign(cmd.memoryBarriers, cmd.memoryBarriers + cmd.memoryBarrierCount);
+        m_barrier.bufferMemoryBarriers.assign(cmd.bufferMemoryBarriers, cmd.bufferMemoryBarriers + cmd.bufferMemoryBarrierCount);
+        m_barrier.imageMemoryBarriers.assign(cmd.imageMemoryBarriers, cmd.imageMemoryBarriers + cmd.imageMemoryBarrierCount);
+    }
+
+    void flushBarrier()
+    {
+        if (!m_barrier.valid)
+            return;
+
+        m_vkAPI.CmdPipelineBarrier(m_commandBuffer,
+                                   m_barrier.srcStageMask,
+                                   m_barrier.dstStageMask,
+                                   m_barrier.dependencyFlags,
+                                   static_cast<uint32_t>(m_barrier.memoryBarriers.size()),
+                                   m_barrier.memoryBarriers.data(),
+                                   static_cast<uint32_t>(m_barrier.bufferMemoryBarriers.size()),
+                                   m_barrier.bufferMemoryBarriers.data(),
+                                   static_cast<uint32_t>(m_barrier.imageMemoryBarriers.size()),
+                                   m_barrier.imageMemoryBarriers.data());
+        ++m_statistics.translatedCommands;
+
+        m_barrier.valid = false;
+    }
+
+    void beginRenderPass(const VulkanBeginRenderPassCommand& cmd)
+    {
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = cmd.renderPass;
+        renderPassInfo.framebuffer = cmd.framebuffer;
+        renderPassInfo.renderArea = cmd.renderArea;
+        renderPassInfo.clearValueCount = cmd.clearValueCount;
+        renderPassInfo.pClearValues = cmd.clearValues;
+
+        VkRenderPassAttachmentBeginInfo attachmentBeginInfo{ .sType = VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO };
+        if (cmd.attachmentCount > 0)
+        {
+            attachmentBeginInfo.attachmentCount = cmd.attachmentCount;
+            attachmentBeginInfo.pAttachments = cmd.attachments;
+
+            renderPassInfo.pNext = &attachmentBeginInfo;
+        }
+
+        m_vkAPI.CmdBeginRenderPass(m_commandBuffer, &renderPassInfo, cmd.contents);
+        ++m_statistics.translatedCommands;
+    }
+
+    void bindPipeline(const VulkanBindPipelineCommand& cmd)
+    {
+        auto& state = getBindPointState(cmd.bindPoint);
+        if (state.pipeline == cmd.pipeline)
+        {
+            ++m_statistics.elidedCommands;
+            return;
+        }
+
+        m_vkAPI.CmdBindPipeline(m_commandBuffer, cmd.bindPoint, cmd.pipeline);
+        state.pipeline = cmd.pipeline;
+        ++m_statistics.translatedCommands;
+    }
+
+    bool isBound(const BindPointState& state, const VulkanBindDescriptorSetsCommand& cmd) const
+    {
+        if (cmd.firstSet + cmd.descriptorSetCount > state.descriptorSets.size())
+            return false;
+
+        for (uint32_t i = 0; i < cmd.descriptorSetCount; ++i)
+        {
+            const auto& bound = state.descriptorSets[cmd.firstSet + i];
+            if (bound.layout != cmd.layout ||
+                bound.descriptorSet != cmd.descriptorSets[i] ||
+                bound.firstSet != cmd.firstSet ||
+                bound.setCount != cmd.descriptorSetCount ||
+                !equalArray(bound.dynamicOffsets, bound.dynamicOffsetCount, cmd.dynamicOffsets, cmd.dynamicOffsetCount))
+                return false;
+        }
+
+        return true;
+    }
+
+    // sets bound with other layouts may be disturbed. forget them instead of checking compatibility.
+    void disturbDescriptorSets(BindPointState& state, VkPipelineLayout layout)
+    {
+        for (auto& bound : state.descriptorSets)
+        {
+            if (bound.layout != layout)
+                bound = BoundDescriptorSet{};
+        }
+    }
+
+    void bindDescriptorSets(const VulkanBindDescriptorSetsCommand& cmd)
+    {
+        auto& state = getBindPointState(cmd.bindPoint);
+        if (isBound(state, cmd))
+        {
+            ++m_statistics.elidedCommands;
+            return;
+        }
+
+        disturbDescriptorSets(state, cmd.layout);
+        if (cmd.firstSet + cmd.descriptorSetCount > state.descriptorSets.size())
+            state.descriptorSets.resize(cmd.firstSet + cmd.descriptorSetCount);
+        for (uint32_t i = 0; i < cmd.descriptorSetCount; ++i)
+        {
+            state.descriptorSets[cmd.firstSet + i] = { .layout = cmd.layout,
+                                                       .descriptorSet = cmd.descriptorSets[i],
+                                                       .firstSet = cmd.firstSet,
+                                                       .setCount = cmd.descriptorSetCount,
+                                                       .dynamicOffsets = cmd.dynamicOffsets,
+                                                       .dynamicOffsetCount = cmd.dynamicOffsetCount };
+        }
+
+        // adjacent binds of following sets are recorded by one command.
+        auto& pending = m_descriptorSets;
+        const bool contiguous = pending.valid &&
+                                pending.bindPoint == cmd.bindPoint &&
+                                pending.layout == cmd.layout &&
+                                pending.firstSet + pending.descriptorSets.size() == cmd.firstSet;
+        if (contiguous)
+        {
+            ++m_statistics.mergedDescriptorBinds;
+        }
+        else
+        {
+            flushDescriptorSets();
+
+            pending.valid = true;
+            pending.bindPoint = cmd.bindPoint;
+            pending.layout = cmd.layout;
+            pending.firstSet = cmd.firstSet;
+            pending.descriptorSets.clear();
+            pending.dynamicOffsets.clear();
+        }
+
+        pending.descriptorSets.insert(pending.descriptorSets.end(), cmd.descriptorSets, cmd.descriptorSets + cmd.descriptorSetCount);
+        pending.dynamicOffsets.insert(pending.dynamicOffsets.end(), cmd.dynamicOffsets, cmd.dynamicOffsets + cmd.dynamicOffsetCount);
+    }
+
+    void flushDescriptorSets()
+    {
+        auto& pending = m_descriptorSets;
+        if (!pending.valid)
+            return;
+
+        m_vkAPI.CmdBindDescriptorSets(m_commandBuffer,
+                                      pending.bindPoint,
+                                      pending.layout,
+                                      pending.firstSet,
+                                      static_cast<uint32_t>(pending.descriptorSets.size()),
+                                      pending.descriptorSets.data(),
+                                      static_cast<uint32_t>(pending.dynamicOffsets.size()),
+                                      pending.dynamicOffsets.data());
+        ++m_statistics.translatedCommands;
+
+        pending.valid = false;
+    }
+
+    void pushDescriptorSet(const VulkanPushDescriptorSetCommand& cmd)
+    {
+        auto& state = getBindPointState(cmd.bindPoint);
+        disturbDescriptorSets(state, cmd.layout);
+        if (cmd.set < state.descriptorSets.size())
+            state.descriptorSets[cmd.set] = BoundDescriptorSet{};
+
+        m_vkAPI.CmdPushDescriptorSetKHR(m_commandBuffer, cmd.bindPoint, cmd.layout, cmd.set, cmd.descriptorWriteCount, cmd.descriptorWrites);
+        ++m_statistics.translatedCommands;
+    }
+
+    void bindVertexBuffers(const VulkanBindVertexBuffersCommand& cmd)
+    {
+        const uint32_t end = cmd.firstBinding + cmd.bindingCount;
+        if (end > m_vertexBuffers.size())
+            m_vertexBuffers.resize(end, { VK_NULL_HANDLE, 0 });
+
+        bool bound = true;
+        for (uint32_t i = 0; i < cmd.bindingCount; ++i)
+        {
+            auto& vertexBuffer = m_vertexBuffers[cmd.firstBinding + i];
+            if (vertexBuffer.first != cmd.buffers[i] || vertexBuffer.second != cmd.offsets[i])
+            {
+                bound = false;
+                vertexBuffer = { cmd.buffers[i], cmd.offsets[i] };
+            }
+        }
+
+        if (bound)
+        {
+            ++m_statistics.elidedCommands;
+            return;
+        }
+
+        m_vkAPI.CmdBindVertexBuffers(m_commandBuffer, cmd.firstBinding, cmd.bindingCount, cmd.buffers, cmd.offsets);
+        ++m_statistics.translatedCommands;
+    }
+
+    void bindIndexBuffer(const VulkanBindIndexBufferCommand& cmd)
+    {
+        if (m_indexBuffer.has_value() &&
+            m_indexBuffer->buffer == cmd.buffer &&
+            m_indexBuffer->offset == cmd.offset &&
+            m_indexBuffer->indexType == cmd.indexType)
+        {
+            ++m_statistics.elidedCommands;
+            return;
+        }
+
+        m_vkAPI.CmdBindIndexBuffer(m_commandBuffer, cmd.buffer, cmd.offset, cmd.indexType);
+        m_indexBuffer = cmd;
+        ++m_statistics.translatedCommands;
+    }
+
+private:
+    const VulkanAPI& m_vkAPI;
+    const VkCommandBuffer m_commandBuffer;
+    VulkanCommandStreamStatistics& m_statistics;
+
+    PendingBarrier m_barrier{};
+    std::vector<int32_t> m_fuseTargets{};
+    PendingDescriptorSets m_descriptorSets{};
+
+    // state of the command buffer. it is kept across passes, and pipelines keep viewport, scissor and blend constants dynamic.
+    BindPointState m_graphics{};
+    BindPointState m_compute{};
+    std::vector<std::pair<VkBuffer, VkDeviceSize>> m_vertexBuffers{};
+    std::optional<VulkanBindIndexBufferCommand> m_indexBuffer = std::nullopt;
+    std::optional<VkViewport> m_viewport = std::nullopt;
+    std::optional<VkRect2D> m_scissor = std::nullopt;
+    std::optional<std::array<float, 4>> m_blendConstants = std::nullopt;
+};
+
+} // namespace
+
+VulkanCommandArena::VulkanCommandArena(size_t blockSize)
+    : m_blockSize(blockSize)
+{
+}
+
+void* VulkanCommandArena::allocate(size_t size, size_t alignment)
+{
+    // blocks after the current one are empty since reset.
+    while (m_current < m_blocks.size())
+    {
+        Block& block = m_blocks[m_current];
+
+        const size_t offset = alignUp(block.used, alignment);
+        if (offset + size <= block.size)
+        {
+            block.used = offset + size;
+            return block.data.get() + offset;
+        }
+
+        if (m_current + 1 == m_blocks.size())
+            break;
+        ++m_current;
+    }
+
+    Block block{};
+    block.size = std::max(m_blockSize, size + alignment);
+    block.data = std::unique_ptr<std::byte[]>(new std::byte[block.size]);
+    block.used = size;
+
+    m_blocks.push_back(std::move(block));
+    m_current = m_blocks.size() - 1;
+
+    return m_blocks.back().data.get();
+}
+
+void VulkanCommandArena::reset()
+{
+    for (auto& block : m_blocks)
+        block.used = 0;
+
+    m_current = 0;
+}
+
+size_t VulkanCommandArena::getBlockCount() const
+{
+    return m_blocks.empty() ? 0 : m_current + 1;
+}
+
+std::span<const std::byte> VulkanCommandArena::getBlock(size_t index) const
+{
+    const Block& block = m_blocks[index];
+    return { block.data.get(), block.used };
+}
+
+void VulkanCommandStream::reset()
+{
+    m_commands.reset();
+    m_data.reset();
+    m_commandCount = 0;
+}
+
+VulkanCommandStreamStatistics VulkanCommandStream::translate(const VulkanAPI& vkAPI, VkCommandBuffer commandBuffer)
+{
+    VulkanCommandStreamStatistics statistics{};
+    statistics.recordedCommands = m_commandCount;
+
+    m_scratchCommands.clear();
+    m_scratchCommands.reserve(m_commandCount);
+    for (size_t i = 0; i < m_commands.getBlockCount(); ++i)
+    {
+        const auto block = m_commands.getBlock(i);
+        for (size_t offset = 0; offset < block.size();)
+        {
+            auto command = reinterpret_cast<const VulkanCommand*>(block.data() + offset);
+            m_scratchCommands.push_back(command);
+            offset += command->size;
+        }
+    }
+
+    // reorder runs of transfer commands which are recorded outside of passes.
+    TransferScheduler scheduler{};
+    for (size_t begin = 0; begin < m_scratchCommands.size();)
+    {
+        if (!isTransferCommand(m_scratchCommands[begin]->type))
+        {
+            ++begin;
+            continue;
+        }
+
+        size_t end = begin;
+        while (end < m_scratchCommands.size() && end - begin < TransferScheduler::kMaxWindow && isTransferCommand(m_scratchCommands[end]->type))
+            ++end;
+
+        statistics.reorderedCommands += scheduler.schedule(std::span<const VulkanCommand*>(m_scratchCommands.data() + begin, end - begin));
+        begin = end;
+    }
+
+    CommandTranslator translator(vkAPI, commandBuffer, statistics);
+    for (const auto command : m_scratchCommands)
+        translator.translate(command);
+    translator.finish();
+
+    return statistics;
+}
+
+uint64_t VulkanCommandStream::getCommandCount() const
+{
+    return m_commandCount;
+}
+
+} // namespace jipu
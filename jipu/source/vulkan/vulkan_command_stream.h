@@ -0,0 +1,479 @@
+#pragma once
+
+#include "vulkan_api.h"
+#include "vulkan_export.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <vector>
+
+namespace jipu
+{
+
+/// @brief linear allocator for recorded commands. memory is released only by reset and is reused by next recording.
+class VULKAN_EXPORT VulkanCommandArena final
+{
+public:
+    static constexpr size_t kDefaultBlockSize = 16 * 1024;
+
+public:
+    explicit VulkanCommandArena(size_t blockSize = kDefaultBlockSize);
+    ~VulkanCommandArena() = default;
+
+    VulkanCommandArena(const VulkanCommandArena&) = delete;
+    VulkanCommandArena& operator=(const VulkanCommandArena&) = delete;
+
+public:
+    /// @brief allocation larger than the block size gets its own block.
+    void* allocate(size_t size, size_t alignment);
+    void reset();
+
+    /// @brief used bytes of each block in allocation order.
+    size_t getBlockCount() const;
+    std::span<const std::byte> getBlock(size_t index) const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data = nullptr;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    const size_t m_blockSize;
+    std::vector<Block> m_blocks{};
+    size_t m_current = 0;
+};
+
+enum class VulkanCommandType : uint8_t
+{
+    // transfer
+    kPipelineBarrier = 0,
+    kCopyBuffer,
+    kCopyBufferToImage,
+    kCopyImageToBuffer,
+    kCopyImage,
+    kBlitImage,
+    kCopyQueryPoolResults,
+    kFillBuffer,
+
+    // query
+    kResetQueryPool,
+    kWriteTimestamp,
+    kBeginQuery,
+    kEndQuery,
+
+    // pass
+    kBeginRenderPass,
+    kNextSubpass,
+    kEndRenderPass,
+    kBeginRendering,
+    kEndRendering,
+
+    // state
+    kBindPipeline,
+    kBindDescriptorSets,
+    kPushConstants,
+    kPushDescriptorSet,
+    kBindVertexBuffers,
+    kBindIndexBuffer,
+    kSetViewport,
+    kSetScissor,
+    kSetBlendConstants,
+
+    // action
+    kDraw,
+    kDrawIndexed,
+    kDrawIndirect,
+    kDrawIndexedIndirect,
+    kDrawIndirectCount,
+    kDrawIndexedIndirectCount,
+    kDispatch,
+    kDispatchIndirect,
+
+    // synchronization2. it is not merged or reordered with transfers.
+    kPipelineBarrier2,
+};
+
+/// @brief header of a recorded command. size is the distance to the next command in the same block.
+struct VulkanCommand
+{
+    VulkanCommandType type;
+    uint32_t size = 0;
+};
+
+// arrays of commands point to the data arena of the stream, so commands are trivially copyable.
+struct VulkanPipelineBarrierCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kPipelineBarrier;
+    VkPipelineStageFlags srcStageMask;
+    VkPipelineStageFlags dstStageMask;
+    VkDependencyFlags dependencyFlags;
+    uint32_t memoryBarrierCount;
+    uint32_t bufferMemoryBarrierCount;
+    uint32_t imageMemoryBarrierCount;
+    const VkMemoryBarrier* memoryBarriers;
+    const VkBufferMemoryBarrier* bufferMemoryBarriers;
+    const VkImageMemoryBarrier* imageMemoryBarriers;
+};
+
+struct VulkanPipelineBarrier2Command : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kPipelineBarrier2;
+    VkDependencyFlags dependencyFlags;
+    uint32_t memoryBarrierCount;
+    uint32_t bufferMemoryBarrierCount;
+    uint32_t imageMemoryBarrierCount;
+    const VkMemoryBarrier2* memoryBarriers;
+    const VkBufferMemoryBarrier2* bufferMemoryBarriers;
+    const VkImageMemoryBarrier2* imageMemoryBarriers;
+};
+
+struct VulkanCopyBufferCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kCopyBuffer;
+    VkBuffer srcBuffer;
+    VkBuffer dstBuffer;
+    uint32_t regionCount;
+    const VkBufferCopy* regions;
+};
+
+struct VulkanCopyBufferToImageCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kCopyBufferToImage;
+    VkBuffer srcBuffer;
+    VkImage dstImage;
+    VkImageLayout dstImageLayout;
+    uint32_t regionCount;
+    const VkBufferImageCopy* regions;
+};
+
+struct VulkanCopyImageToBufferCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kCopyImageToBuffer;
+    VkImage srcImage;
+    VkImageLayout srcImageLayout;
+    VkBuffer dstBuffer;
+    uint32_t regionCount;
+    const VkBufferImageCopy* regions;
+};
+
+struct VulkanCopyImageCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kCopyImage;
+    VkImage srcImage;
+    VkImageLayout srcImageLayout;
+    VkImage dstImage;
+    VkImageLayout dstImageLayout;
+    uint32_t regionCount;
+    const VkImageCopy* regions;
+};
+
+struct VulkanBlitImageCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kBlitImage;
+    VkImage srcImage;
+    VkImageLayout srcImageLayout;
+    VkImage dstImage;
+    VkImageLayout dstImageLayout;
+    uint32_t regionCount;
+    const VkImageBlit* regions;
+    VkFilter filter;
+};
+
+struct VulkanCopyQueryPoolResultsCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kCopyQueryPoolResults;
+    VkQueryPool queryPool;
+    uint32_t firstQuery;
+    uint32_t queryCount;
+    VkBuffer dstBuffer;
+    VkDeviceSize dstOffset;
+    VkDeviceSize stride;
+    VkQueryResultFlags flags;
+};
+
+struct VulkanFillBufferCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kFillBuffer;
+    VkBuffer dstBuffer;
+    VkDeviceSize dstOffset;
+    VkDeviceSize size;
+    uint32_t data;
+};
+
+struct VulkanResetQueryPoolCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kResetQueryPool;
+    VkQueryPool queryPool;
+    uint32_t firstQuery;
+    uint32_t queryCount;
+};
+
+struct VulkanWriteTimestampCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kWriteTimestamp;
+    VkPipelineStageFlagBits pipelineStage;
+    VkQueryPool queryPool;
+    uint32_t query;
+};
+
+struct VulkanBeginQueryCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kBeginQuery;
+    VkQueryPool queryPool;
+    uint32_t query;
+    VkQueryControlFlags flags;
+};
+
+struct VulkanEndQueryCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kEndQuery;
+    VkQueryPool queryPool;
+    uint32_t query;
+};
+
+struct VulkanBeginRenderPassCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kBeginRenderPass;
+    VkRenderPass renderPass;
+    VkFramebuffer framebuffer;
+    VkRect2D renderArea;
+    VkSubpassContents contents;
+    uint32_t clearValueCount;
+    const VkClearValue* clearValues;
+    // image views of imageless framebuffer.
+    uint32_t attachmentCount;
+    const VkImageView* attachments;
+};
+
+struct VulkanNextSubpassCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kNextSubpass;
+    VkSubpassContents contents;
+};
+
+struct VulkanEndRenderPassCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kEndRenderPass;
+};
+
+struct VulkanBeginRenderingCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kBeginRendering;
+    // attachment pointers of the info point to the data arena. next chain is not copied.
+    VkRenderingInfo renderingInfo;
+};
+
+struct VulkanEndRenderingCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kEndRendering;
+};
+
+struct VulkanBindPipelineCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kBindPipeline;
+    VkPipelineBindPoint bindPoint;
+    VkPipeline pipeline;
+};
+
+struct VulkanBindDescriptorSetsCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kBindDescriptorSets;
+    VkPipelineBindPoint bindPoint;
+    VkPipelineLayout layout;
+    uint32_t firstSet;
+    uint32_t descriptorSetCount;
+    const VkDescriptorSet* descriptorSets;
+    uint32_t dynamicOffsetCount;
+    const uint32_t* dynamicOffsets;
+};
+
+struct VulkanPushConstantsCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kPushConstants;
+    VkPipelineLayout layout;
+    VkShaderStageFlags stageFlags;
+    uint32_t offset;
+    uint32_t size;
+    const void* values;
+};
+
+struct VulkanPushDescriptorSetCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kPushDescriptorSet;
+    VkPipelineBindPoint bindPoint;
+    VkPipelineLayout layout;
+    uint32_t set;
+    uint32_t descriptorWriteCount;
+    const VkWriteDescriptorSet* descriptorWrites;
+};
+
+struct VulkanBindVertexBuffersCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kBindVertexBuffers;
+    uint32_t firstBinding;
+    uint32_t bindingCount;
+    const VkBuffer* buffers;
+    const VkDeviceSize* offsets;
+};
+
+struct VulkanBindIndexBufferCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kBindIndexBuffer;
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkIndexType indexType;
+};
+
+struct VulkanSetViewportCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kSetViewport;
+    VkViewport viewport;
+};
+
+struct VulkanSetScissorCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kSetScissor;
+    VkRect2D scissor;
+};
+
+struct VulkanSetBlendConstantsCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kSetBlendConstants;
+    float blendConstants[4];
+};
+
+struct VulkanDrawCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kDraw;
+    uint32_t vertexCount;
+    uint32_t instanceCount;
+    uint32_t firstVertex;
+    uint32_t firstInstance;
+};
+
+struct VulkanDrawIndexedCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kDrawIndexed;
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t firstInstance;
+};
+
+/// @brief shared by draw indirect and draw indexed indirect.
+struct VulkanDrawIndirectCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kDrawIndirect;
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    uint32_t drawCount;
+    uint32_t stride;
+};
+
+/// @brief shared by draw indirect count and draw indexed indirect count.
+struct VulkanDrawIndirectCountCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kDrawIndirectCount;
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkBuffer countBuffer;
+    VkDeviceSize countBufferOffset;
+    uint32_t maxDrawCount;
+    uint32_t stride;
+};
+
+struct VulkanDispatchCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kDispatch;
+    uint32_t x;
+    uint32_t y;
+    uint32_t z;
+};
+
+struct VulkanDispatchIndirectCommand : VulkanCommand
+{
+    static constexpr VulkanCommandType kType = VulkanCommandType::kDispatchIndirect;
+    VkBuffer buffer;
+    VkDeviceSize offset;
+};
+
+struct VulkanCommandStreamStatistics
+{
+    /// @brief commands in the stream.
+    uint64_t recordedCommands = 0;
+    /// @brief vkCmd* calls made by translation.
+    uint64_t translatedCommands = 0;
+    /// @brief barrier commands merged into a previous pipeline barrier.
+    uint64_t mergedBarriers = 0;
+    /// @brief state commands dropped because the same state is already bound in the command buffer.
+    uint64_t elidedCommands = 0;
+    /// @brief descriptor set binds merged into a previous bind.
+    uint64_t mergedDescriptorBinds = 0;
+    /// @brief transfer commands which are moved to be grouped with independent transfers.
+    uint64_t reorderedCommands = 0;
+};
+
+/// @brief compact list of commands which is recorded without the command buffer and translated to vkCmd* calls at once.
+/// a stream is used by one thread at a time.
+class VULKAN_EXPORT VulkanCommandStream final
+{
+public:
+    VulkanCommandStream() = default;
+    ~VulkanCommandStream() = default;
+
+    VulkanCommandStream(const VulkanCommandStream&) = delete;
+    VulkanCommandStream& operator=(const VulkanCommandStream&) = delete;
+
+public:
+    /// @brief append a command. fields other than the header are left to the caller.
+    template <typename T>
+    T& record()
+    {
+        static_assert(alignof(T) <= kCommandAlignment);
+
+        const size_t size = (sizeof(T) + kCommandAlignment - 1) & ~(kCommandAlignment - 1);
+        T* command = new (m_commands.allocate(size, kCommandAlignment)) T{};
+        command->type = T::kType;
+        command->size = static_cast<uint32_t>(size);
+
+        ++m_commandCount;
+        return *command;
+    }
+
+    /// @brief copy an array into the stream. it is valid until reset.
+    template <typename T>
+    const T* copy(const T* data, size_t count)
+    {
+        if (count == 0)
+            return nullptr;
+
+        T* dst = static_cast<T*>(m_data.allocate(sizeof(T) * count, alignof(T)));
+        std::copy(data, data + count, dst);
+        return dst;
+    }
+
+    void reset();
+
+    /// @brief record commands in the stream to the command buffer which is begun.
+    VulkanCommandStreamStatistics translate(const VulkanAPI& vkAPI, VkCommandBuffer commandBuffer);
+
+    uint64_t getCommandCount() const;
+
+private:
+    static constexpr size_t kCommandAlignment = 8;
+
+    VulkanCommandArena m_commands{};
+    VulkanCommandArena m_data{};
+    uint64_t m_commandCount = 0;
+
+    // reused by translate.
+    std::vector<const VulkanCommand*> m_scratchCommands{};
+};
+
+} // namespace jipu
@@ -1,5 +1,6 @@
 #include "vulkan_compute_pass_encoder.h"
 #include "vulkan_binding_group.h"
+#include "vulkan_binding_group_layout.h"
 #include "vulkan_buffer.h"
 #include "vulkan_command_buffer.h"
 #include "vulkan_device.h"
@@ -8,11 +9,15 @@
 
 #include "vulkan_api.h"
 
+#include <spdlog/spdlog.h>
+
 namespace jipu
 {
 
 VulkanComputePassEncoder::VulkanComputePassEncoder(VulkanCommandBuffer& commandBuffer, const ComputePassEncoderDescriptor& descriptor)
     : m_commandBuffer(commandBuffer)
+    , m_recorder(commandBuffer.getCommandRecorder())
+    , m_bufferTracker(commandBuffer.getBufferTracker())
 {
     // do nothing.
 }
@@ -20,47 +25,88 @@ VulkanComputePassEncoder::VulkanComputePassEncoder(VulkanCommandBuffer& commandB
 void VulkanComputePassEncoder::setPipeline(ComputePipeline& pipeline)
 {
     m_pipeline = std::make_optional<VulkanComputePipeline::Ref>(downcast(pipeline));
+    m_descriptorSetState.setPipelineLayout(downcast(m_pipeline.value().get().getPipelineLayout()));
+
+    VkPipeline vkPipeline = m_pipeline.value().get().getVkPipeline();
+    if (m_boundPipeline == vkPipeline)
+    {
+        ++m_statistics.elidedCommands;
+        return;
+    }
+
+    m_recorder.cmdBindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE,
+                               vkPipeline);
+    m_boundPipeline = vkPipeline;
+    ++m_statistics.issuedCommands;
+}
 
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-    const VulkanAPI& vkAPI = downcast(vulkanDevice).vkAPI;
+void VulkanComputePassEncoder::setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::span<const uint32_t> dynamicOffset)
+{
+    auto& vulkanBindingGroup = downcast(bindingGroup);
+    m_descriptorSetState.setDescriptorSet(index, vulkanBindingGroup.getVkDescriptorSet(), dynamicOffset);
+    m_bufferAccessState.setBufferAccesses(index, vulkanBindingGroup.getBufferAccesses());
+}
+
+void VulkanComputePassEncoder::setPushConstants(BindingStageFlags stages, uint32_t offset, const void* data, uint32_t size)
+{
+    if (!m_pipeline.has_value())
+        throw std::runtime_error("The pipeline is null opt");
+
+    auto& vulkanPipelineLayout = downcast(m_pipeline.value().get().getPipelineLayout());
 
-    vkAPI.CmdBindPipeline(vulkanCommandBuffer.getVkCommandBuffer(),
-                          VK_PIPELINE_BIND_POINT_COMPUTE,
-                          m_pipeline.value().get().getVkPipeline());
+    m_recorder.cmdPushConstants(vulkanPipelineLayout.getVkPipelineLayout(),
+                                ToVkShaderStageFlags(stages),
+                                offset,
+                                size,
+                                data);
 }
 
-void VulkanComputePassEncoder::setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::vector<uint32_t> dynamicOffset)
+void VulkanComputePassEncoder::pushBindings(uint32_t index, const BindingGroupDescriptor& descriptor)
 {
     if (!m_pipeline.has_value())
         throw std::runtime_error("The pipeline is null opt");
 
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-    auto& vulkanBindingGroup = downcast(bindingGroup);
     auto& vulkanPipelineLayout = downcast(m_pipeline.value().get().getPipelineLayout());
 
-    const VulkanAPI& vkAPI = downcast(vulkanDevice).vkAPI;
+    if (!downcast(descriptor.layout).isPushDescriptor())
+        throw std::runtime_error("The binding group layout is not for push descriptor.");
 
-    VkDescriptorSet descriptorSet = vulkanBindingGroup.getVkDescriptorSet();
+    // infos are referenced by writes until they are recorded.
+    const VulkanBindingGroupDescriptor vulkanDescriptor = generateVulkanBindingGroupDescriptor(descriptor);
+    const std::vector<VkWriteDescriptorSet> descriptorWrites = generateVkWriteDescriptorSets(vulkanDescriptor, VK_NULL_HANDLE);
 
-    vkAPI.CmdBindDescriptorSets(vulkanCommandBuffer.getVkCommandBuffer(),
-                                VK_PIPELINE_BIND_POINT_COMPUTE,
-                                vulkanPipelineLayout.getVkPipelineLayout(),
-                                0,
-                                1,
-                                &descriptorSet,
-                                static_cast<uint32_t>(dynamicOffset.size()),
-                                dynamicOffset.data());
+    m_recorder.cmdPushDescriptorSet(VK_PIPELINE_BIND_POINT_COMPUTE,
+                                    vulkanPipelineLayout.getVkPipelineLayout(),
+                                    index,
+                                    static_cast<uint32_t>(descriptorWrites.size()),
+                                    descriptorWrites.data());
+    m_descriptorSetState.invalidate(index);
+    m_bufferAccessState.setBufferAccesses(index, generateVulkanBufferAccesses(vulkanDescriptor));
 }
 
 void VulkanComputePassEncoder::dispatch(uint32_t x, uint32_t y, uint32_t z)
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-    const VulkanAPI& vkAPI = downcast(vulkanDevice).vkAPI;
+    m_bufferAccessState.access(m_bufferTracker);
+    m_bufferTracker.flush(m_recorder);
 
-    vkAPI.CmdDispatch(vulkanCommandBuffer.getVkCommandBuffer(), x, y, z);
+    m_descriptorSetState.flush(m_recorder);
+    m_recorder.cmdDispatch(x, y, z);
+}
+
+void VulkanComputePassEncoder::dispatchIndirect(Buffer& indirectBuffer, uint64_t indirectOffset)
+{
+    VkBuffer vkIndirectBuffer = downcast(indirectBuffer).getVkBuffer();
+
+    m_bufferAccessState.access(m_bufferTracker);
+    m_bufferTracker.access({ .buffer = vkIndirectBuffer,
+                             .offset = indirectOffset,
+                             .size = sizeof(DispatchIndirectArgs),
+                             .stageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+                             .accessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT });
+    m_bufferTracker.flush(m_recorder);
+
+    m_descriptorSetState.flush(m_recorder);
+    m_recorder.cmdDispatchIndirect(vkIndirectBuffer, indirectOffset);
 }
 
 void VulkanComputePassEncoder::end()
@@ -70,6 +116,14 @@ void VulkanComputePassEncoder::end()
     // TODO: generate stage from binding group.
     VkPipelineStageFlags flags = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
     vulkanCommandBuffer.setSignalPipelineStage(flags);
+    vulkanCommandBuffer.addStatistics(m_statistics);
+
+    spdlog::trace("Compute pass state commands issued: {}, elided: {}", m_statistics.issuedCommands, m_statistics.elidedCommands);
+}
+
+const VulkanPassEncoderStatistics& VulkanComputePassEncoder::getStatistics() const
+{
+    return m_statistics;
 }
 
 } // namespace jipu
\ No newline at end of file
@@ -2,16 +2,20 @@
 
 #include "jipu/compute_pass_encoder.h"
 #include "vulkan_api.h"
+#include "vulkan_command_recorder.h"
 #include "vulkan_export.h"
+#include "vulkan_pass_encoder_state.h"
 #include "vulkan_pipeline.h"
 
+#include <span>
+
 namespace jipu
 {
 
 class VulkanBindingGroup;
 class VulkanComputePipeline;
 class VulkanCommandBuffer;
-class VULKAN_EXPORT VulkanComputePassEncoder : public ComputePassEncoder
+class VULKAN_EXPORT VulkanComputePassEncoder final : public ComputePassEncoder
 {
 public:
     VulkanComputePassEncoder() = delete;
@@ -20,15 +24,33 @@ public:
 
 public:
     void setPipeline(ComputePipeline& pipeline) override;
-    void setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::vector<uint32_t> dynamicOffset = {}) override;
+    void setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::span<const uint32_t> dynamicOffset = {}) override;
+    void setPushConstants(BindingStageFlags stages, uint32_t offset, const void* data, uint32_t size) override;
+    void pushBindings(uint32_t index, const BindingGroupDescriptor& descriptor) override;
     void dispatch(uint32_t x, uint32_t y = 1, uint32_t z = 1) override;
+    void dispatchIndirect(Buffer& indirectBuffer, uint64_t indirectOffset) override;
     void end() override;
 
+public:
+    const VulkanPassEncoderStatistics& getStatistics() const;
+
 private:
     VulkanCommandBuffer& m_commandBuffer;
+    // cached to record commands without going through the command buffer and device.
+    VulkanCommandRecorder& m_recorder;
+    VulkanBufferTracker& m_bufferTracker;
 
 private:
     std::optional<VulkanComputePipeline::Ref> m_pipeline = std::nullopt;
+
+    VulkanPassEncoderStatistics m_statistics{};
+
+    // shadow state to skip binding same state again. state is unknown at the beginning of a pass.
+    // binding groups are bound at dispatch.
+    VkPipeline m_boundPipeline = VK_NULL_HANDLE;
+    VulkanDescriptorSetState m_descriptorSetState{ VK_PIPELINE_BIND_POINT_COMPUTE, m_statistics };
+    // barriers for buffers are recorded before each dispatch.
+    VulkanBufferAccessState m_bufferAccessState{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT };
 };
 
 } // namespace jipu
\ No newline at end of file
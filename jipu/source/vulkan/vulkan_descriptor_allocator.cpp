@@ -0,0 +1,135 @@
+#include "vulkan_descriptor_allocator.h"
+#include "vulkan_device.h"
+
+#include "utils/hash.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <stdexcept>
+
+namespace jipu
+{
+
+size_t VulkanDescriptorAllocator::Functor::operator()(const std::vector<VkDescriptorPoolSize>& poolSizes) const
+{
+    return hashRange(poolSizes);
+}
+
+bool VulkanDescriptorAllocator::Functor::operator()(const std::vector<VkDescriptorPoolSize>& lhs,
+                                                    const std::vector<VkDescriptorPoolSize>& rhs) const
+{
+    return equalRange(lhs, rhs);
+}
+
+VulkanDescriptorAllocator::VulkanDescriptorAllocator(VulkanDevice& device, const VulkanDescriptorAllocatorDescriptor& descriptor)
+    : m_device(device)
+    , m_descriptor(descriptor)
+{
+}
+
+VulkanDescriptorAllocator::~VulkanDescriptorAllocator()
+{
+    auto& vulkanDevice = downcast(m_device);
+    for (const auto& [descriptorPool, _] : m_pools)
+    {
+        vulkanDevice.vkAPI.DestroyDescriptorPool(vulkanDevice.getVkDevice(), descriptorPool, nullptr);
+    }
+}
+
+VulkanDescriptorSetAllocation VulkanDescriptorAllocator::allocate(VkDescriptorSetLayout layout, const std::vector<VkDescriptorPoolSize>& poolSizes)
+{
+    auto& vulkanDevice = downcast(m_device);
+
+    auto tryAllocate = [&](Pool& pool) -> VkDescriptorSet {
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+        descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.descriptorPool = pool.descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts = &layout;
+
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        if (vulkanDevice.vkAPI.AllocateDescriptorSets(vulkanDevice.getVkDevice(), &descriptorSetAllocateInfo, &descriptorSet) != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+
+        ++pool.allocatedSets;
+        return descriptorSet;
+    };
+
+    auto& chain = m_poolChains[poolSizes];
+    if (chain.poolSizes.empty())
+        chain.poolSizes = poolSizes;
+
+    // newest pool is the most likely to have space.
+    for (auto it = chain.pools.rbegin(); it != chain.pools.rend(); ++it)
+    {
+        if (it->allocatedSets >= it->maxSets)
+            continue;
+
+        VkDescriptorSet descriptorSet = tryAllocate(*it);
+        if (descriptorSet != VK_NULL_HANDLE)
+            return { .descriptorSet = descriptorSet, .descriptorPool = it->descriptorPool };
+    }
+
+    // grow the chain.
+    const uint32_t maxSets = chain.pools.empty() ? m_descriptor.initialSetCount
+                                                 : std::min(chain.pools.back().maxSets * 2, m_descriptor.maxSetCount);
+    chain.pools.push_back(createPool(chain.poolSizes, maxSets));
+
+    Pool& pool = chain.pools.back();
+    m_pools.insert({ pool.descriptorPool, &pool });
+
+    VkDescriptorSet descriptorSet = tryAllocate(pool);
+    if (descriptorSet == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("Failed to allocate descriptor sets.");
+    }
+
+    return { .descriptorSet = descriptorSet, .descriptorPool = pool.descriptorPool };
+}
+
+void VulkanDescriptorAllocator::free(const VulkanDescriptorSetAllocation& allocation)
+{
+    auto it = m_pools.find(allocation.descriptorPool);
+    if (it == m_pools.end())
+    {
+        throw std::runtime_error("Failed to free descriptor set which is not allocated by this allocator.");
+    }
+
+    auto& vulkanDevice = downcast(m_device);
+    vulkanDevice.vkAPI.FreeDescriptorSets(vulkanDevice.getVkDevice(), allocation.descriptorPool, 1, &allocation.descriptorSet);
+
+    --it->second->allocatedSets;
+}
+
+VulkanDescriptorAllocator::Pool VulkanDescriptorAllocator::createPool(const std::vector<VkDescriptorPoolSize>& poolSizes, uint32_t maxSets)
+{
+    std::vector<VkDescriptorPoolSize> totalPoolSizes{};
+    for (const auto& poolSize : poolSizes)
+    {
+        totalPoolSizes.push_back({ .type = poolSize.type, .descriptorCount = poolSize.descriptorCount * maxSets });
+    }
+
+    // a pool needs at least one pool size even if the layout has no binding.
+    if (totalPoolSizes.empty())
+        totalPoolSizes.push_back({ .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = 1 });
+
+    VkDescriptorPoolCreateInfo poolCreateInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                                               .pNext = nullptr,
+                                               .flags = m_descriptor.flags | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+                                               .maxSets = maxSets,
+                                               .poolSizeCount = static_cast<uint32_t>(totalPoolSizes.size()),
+                                               .pPoolSizes = totalPoolSizes.data() };
+
+    auto& vulkanDevice = downcast(m_device);
+
+    Pool pool{ .maxSets = maxSets };
+    VkResult result = vulkanDevice.vkAPI.CreateDescriptorPool(vulkanDevice.getVkDevice(), &poolCreateInfo, nullptr, &pool.descriptorPool);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(fmt::format("Failed to create descriptor pool. {}", static_cast<uint32_t>(result)));
+    }
+
+    return pool;
+}
+
+} // namespace jipu
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "vulkan_api.h"
+#include "vulkan_export.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace jipu
+{
+
+struct VulkanDescriptorSetAllocation
+{
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+};
+
+struct VulkanDescriptorAllocatorDescriptor
+{
+    /// @brief the number of sets in the first pool. next pools are doubled up to maxSetCount.
+    uint32_t initialSetCount = 16;
+    uint32_t maxSetCount = 1024;
+    /// @brief additional pool flags. ex) update after bind.
+    VkDescriptorPoolCreateFlags flags = 0u;
+};
+
+class VulkanDevice;
+class VULKAN_EXPORT VulkanDescriptorAllocator final
+{
+public:
+    VulkanDescriptorAllocator() = delete;
+    VulkanDescriptorAllocator(VulkanDevice& device, const VulkanDescriptorAllocatorDescriptor& descriptor);
+    ~VulkanDescriptorAllocator();
+
+    VulkanDescriptorAllocator(const VulkanDescriptorAllocator&) = delete;
+    VulkanDescriptorAllocator& operator=(const VulkanDescriptorAllocator&) = delete;
+
+    /// @brief allocate a descriptor set from the pool chain for the descriptor counts of the layout.
+    /// @param poolSizes descriptor counts per type for one set.
+    VulkanDescriptorSetAllocation allocate(VkDescriptorSetLayout layout, const std::vector<VkDescriptorPoolSize>& poolSizes);
+    void free(const VulkanDescriptorSetAllocation& allocation);
+
+private:
+    struct Pool
+    {
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        uint32_t maxSets = 0;
+        uint32_t allocatedSets = 0;
+    };
+
+    // pools for the same descriptor counts. all sets in a chain have same size, so a pool is not fragmented.
+    struct PoolChain
+    {
+        std::vector<VkDescriptorPoolSize> poolSizes{};
+        std::list<Pool> pools{};
+    };
+
+    Pool createPool(const std::vector<VkDescriptorPoolSize>& poolSizes, uint32_t maxSets);
+
+private:
+    VulkanDevice& m_device;
+    const VulkanDescriptorAllocatorDescriptor m_descriptor;
+
+private:
+    struct Functor
+    {
+        size_t operator()(const std::vector<VkDescriptorPoolSize>& poolSizes) const;
+        bool operator()(const std::vector<VkDescriptorPoolSize>& lhs, const std::vector<VkDescriptorPoolSize>& rhs) const;
+    };
+    using PoolChains = std::unordered_map<std::vector<VkDescriptorPoolSize>, PoolChain, Functor, Functor>;
+
+    PoolChains m_poolChains{};
+    std::unordered_map<VkDescriptorPool, Pool*> m_pools{};
+};
+
+} // namespace jipu
@@ -1,5 +1,6 @@
 #include "vulkan_device.h"
 
+#include "vulkan_bindless_table.h"
 #include "vulkan_binding_group.h"
 #include "vulkan_binding_group_layout.h"
 #include "vulkan_buffer.h"
@@ -9,7 +10,9 @@
 #include "vulkan_query_set.h"
 #include "vulkan_queue.h"
 #include "vulkan_sampler.h"
+#include "vulkan_upload_manager.h"
 
+#include <algorithm>
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
@@ -22,6 +25,8 @@ VulkanDevice::VulkanDevice(VulkanPhysicalDevice& physicalDevice, const DeviceDes
     , m_physicalDevice(physicalDevice)
     , m_renderPassCache(*this)
     , m_frameBufferCache(*this)
+    , m_pipelineLibraryCache(*this)
+    , m_bindingGroupCache(*this)
 {
     const VulkanPhysicalDeviceInfo& info = physicalDevice.getVulkanPhysicalDeviceInfo();
 
@@ -37,6 +42,17 @@ VulkanDevice::VulkanDevice(VulkanPhysicalDevice& physicalDevice, const DeviceDes
         }
     }
 
+    // a transfer only queue family is used for uploads.
+    for (uint32_t i = 0; i < info.queueFamilyProperties.size(); ++i)
+    {
+        const VkQueueFlags flags = info.queueFamilyProperties[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & queueFlags))
+        {
+            queueFamilies.insert({ i, info.queueFamilyProperties[i] });
+            break;
+        }
+    }
+
     createDevice(queueFamilies);
 
     const VulkanDeviceKnobs& deviceKnobs = static_cast<const VulkanDeviceKnobs&>(info);
@@ -45,8 +61,8 @@ VulkanDevice::VulkanDevice(VulkanPhysicalDevice& physicalDevice, const DeviceDes
         throw std::runtime_error("Failed to load device procs.");
     }
 
-    // get queues.
-    m_queues.resize(queueFamilies.size());
+    // get queues. they are indexed by queue family index.
+    m_queues.resize(info.queueFamilyProperties.size());
     for (const auto& [index, _] : queueFamilies)
     {
         VkQueue queue{};
@@ -56,15 +72,26 @@ VulkanDevice::VulkanDevice(VulkanPhysicalDevice& physicalDevice, const DeviceDes
 
     VulkanResourceAllocatorDescriptor allocatorDescriptor{};
     m_resourceAllocator = std::make_unique<VulkanResourceAllocator>(*this, allocatorDescriptor);
+
+    VulkanDescriptorAllocatorDescriptor descriptorAllocatorDescriptor{};
+    m_descriptorAllocator = std::make_unique<VulkanDescriptorAllocator>(*this, descriptorAllocatorDescriptor);
+
+    m_submittedBufferTracker = std::make_unique<VulkanBufferTracker>(info.synchronization2);
 }
 
 VulkanDevice::~VulkanDevice()
 {
     vkAPI.DeviceWaitIdle(m_device);
 
+    m_uploadManager.reset();
+
     vkAPI.DestroyCommandPool(m_device, m_commandPool, nullptr);
-    vkAPI.DestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+    m_mipmapGenerator.reset();
+    m_bindlessTable.reset();
+    m_bindingGroupCache.clear();
+    m_descriptorAllocator.reset();
 
+    m_pipelineLibraryCache.clear();
     m_frameBufferCache.clear();
     m_renderPassCache.clear();
 
@@ -158,6 +185,29 @@ std::unique_ptr<Swapchain> VulkanDevice::createSwapchain(const VulkanSwapchainDe
     return std::make_unique<VulkanSwapchain>(*this, descriptor);
 }
 
+DeviceStatistics VulkanDevice::getStatistics() const
+{
+    DeviceStatistics statistics{};
+    statistics.caches.push_back(m_renderPassCache.getStatistics());
+    statistics.caches.push_back(m_frameBufferCache.getStatistics());
+    statistics.caches.push_back(m_pipelineLibraryCache.getStatistics());
+    statistics.caches.push_back(m_bindingGroupCache.getStatistics());
+    // the generator is created by the first generation.
+    statistics.caches.push_back(m_mipmapGenerator ? m_mipmapGenerator->getStatistics() : CacheStatistics{ .name = "Mipmap Pipeline" });
+
+    return statistics;
+}
+
+void VulkanDevice::resetStatistics()
+{
+    m_renderPassCache.resetStatistics();
+    m_frameBufferCache.resetStatistics();
+    m_pipelineLibraryCache.resetStatistics();
+    m_bindingGroupCache.resetStatistics();
+    if (m_mipmapGenerator)
+        m_mipmapGenerator->resetStatistics();
+}
+
 VulkanRenderPass& VulkanDevice::getRenderPass(const VulkanRenderPassDescriptor& descriptor)
 {
     return m_renderPassCache.getRenderPass(descriptor);
@@ -165,7 +215,61 @@ VulkanRenderPass& VulkanDevice::getRenderPass(const VulkanRenderPassDescriptor&
 
 VulkanFramebuffer& VulkanDevice::getFrameBuffer(const VulkanFramebufferDescriptor& descriptor)
 {
-    return m_frameBufferCache.getFrameBuffer(descriptor);
+    return *m_frameBufferCache.getFrameBuffer(descriptor);
+}
+
+VulkanFramebufferCache& VulkanDevice::getFrameBufferCache()
+{
+    return m_frameBufferCache;
+}
+
+VulkanPipelineLibraryCache& VulkanDevice::getPipelineLibraryCache()
+{
+    return m_pipelineLibraryCache;
+}
+
+BindlessTable* VulkanDevice::getBindlessTable()
+{
+    if (!m_physicalDevice.getVulkanPhysicalDeviceInfo().descriptorIndexing)
+        return nullptr;
+
+    // created at first use not to allocate large arrays for applications which do not use it.
+    if (!m_bindlessTable)
+        m_bindlessTable = std::make_unique<VulkanBindlessTable>(*this, VulkanBindlessTableDescriptor{});
+
+    return m_bindlessTable.get();
+}
+
+UploadManager& VulkanDevice::getUploadManager()
+{
+    // created at first use not to create command pools for applications which do not upload.
+    if (!m_uploadManager)
+        m_uploadManager = std::make_unique<VulkanUploadManager>(*this, VulkanUploadManagerDescriptor{});
+
+    return *m_uploadManager;
+}
+
+bool VulkanDevice::hasUploadManager() const
+{
+    return m_uploadManager != nullptr;
+}
+
+VulkanBindingGroupCache& VulkanDevice::getBindingGroupCache()
+{
+    return m_bindingGroupCache;
+}
+
+VulkanDescriptorAllocator& VulkanDevice::getDescriptorAllocator()
+{
+    return *m_descriptorAllocator;
+}
+
+VulkanMipmapGenerator& VulkanDevice::getMipmapGenerator()
+{
+    if (!m_mipmapGenerator)
+        m_mipmapGenerator = std::make_unique<VulkanMipmapGenerator>(*this);
+
+    return *m_mipmapGenerator;
 }
 
 VulkanResourceAllocator& VulkanDevice::getResourceAllocator()
@@ -173,6 +277,44 @@ VulkanResourceAllocator& VulkanDevice::getResourceAllocator()
     return *m_resourceAllocator;
 }
 
+uint64_t VulkanDevice::getPendingSerial()
+{
+    std::lock_guard<std::mutex> lock(m_serialMutex);
+
+    return m_submittedSerial + 1;
+}
+
+uint64_t VulkanDevice::getCompletedSerial()
+{
+    std::lock_guard<std::mutex> lock(m_serialMutex);
+
+    return m_pendingSerials.empty() ? m_submittedSerial : *m_pendingSerials.begin() - 1;
+}
+
+uint64_t VulkanDevice::beginSubmit()
+{
+    std::lock_guard<std::mutex> lock(m_serialMutex);
+
+    m_pendingSerials.insert(++m_submittedSerial);
+
+    return m_submittedSerial;
+}
+
+void VulkanDevice::endSubmit(uint64_t serial)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_serialMutex);
+        m_pendingSerials.erase(serial);
+    }
+
+    m_frameBufferCache.releaseCompleted(getCompletedSerial());
+}
+
+VulkanBufferTracker& VulkanDevice::getSubmittedBufferTracker()
+{
+    return *m_submittedBufferTracker;
+}
+
 VulkanPhysicalDevice& VulkanDevice::getPhysicalDevice() const
 {
     return m_physicalDevice;
@@ -198,6 +340,11 @@ VkQueue VulkanDevice::getVkQueue(uint32_t index) const
     return m_queues[index];
 }
 
+std::mutex& VulkanDevice::getQueueMutex()
+{
+    return m_queueMutex;
+}
+
 VkCommandPool VulkanDevice::getVkCommandPool()
 {
     // TODO: get or create by command pool create information (not VkCommandPoolCreateInfo).
@@ -218,56 +365,23 @@ VkCommandPool VulkanDevice::getVkCommandPool()
     return m_commandPool;
 }
 
-VkDescriptorPool VulkanDevice::getVkDescriptorPool()
-{
-    if (m_descriptorPool == VK_NULL_HANDLE)
-    {
-        const uint32_t maxSets = 30; // TODO: set correct max value.
-        const uint64_t descriptorPoolCount = 8;
-        const uint64_t maxDescriptorSetSize = descriptorPoolCount;
-        std::array<VkDescriptorPoolSize, descriptorPoolCount> poolSizes;
-        VkDescriptorPoolCreateInfo poolCreateInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-                                                   .pNext = nullptr,
-                                                   .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-                                                   .maxSets = maxSets,
-                                                   .poolSizeCount = descriptorPoolCount,
-                                                   .pPoolSizes = poolSizes.data() };
-
-        auto& vulkanPhysicalDevice = downcast(m_physicalDevice);
-        const VulkanPhysicalDeviceInfo& physicalDeviceInfo = vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo();
-        const VkPhysicalDeviceLimits& devicePropertyLimists = physicalDeviceInfo.physicalDeviceProperties.limits;
-
-        poolSizes[0] = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, devicePropertyLimists.maxDescriptorSetUniformBuffers };
-        poolSizes[1] = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, devicePropertyLimists.maxDescriptorSetUniformBuffersDynamic };
-        poolSizes[2] = { VK_DESCRIPTOR_TYPE_SAMPLER, devicePropertyLimists.maxDescriptorSetSamplers };
-        poolSizes[3] = { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, devicePropertyLimists.maxDescriptorSetSampledImages };
-        poolSizes[4] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, devicePropertyLimists.maxDescriptorSetSampledImages }; // TODO: need check
-        poolSizes[5] = { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, devicePropertyLimists.maxDescriptorSetInputAttachments };
-        poolSizes[6] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, devicePropertyLimists.maxDescriptorSetStorageBuffers };
-        poolSizes[7] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, devicePropertyLimists.maxDescriptorSetStorageBuffersDynamic };
-
-        VkResult result = vkAPI.CreateDescriptorPool(m_device, &poolCreateInfo, nullptr, &m_descriptorPool);
-        if (result != VK_SUCCESS)
-        {
-            throw std::runtime_error(fmt::format("Failed to create descriptor pool. {}", static_cast<uint32_t>(result)));
-        }
-    }
-
-    return m_descriptorPool;
-}
-
 void VulkanDevice::createDevice(const std::unordered_map<uint32_t, VkQueueFamilyProperties>& queueFamilies)
 {
     std::vector<VkDeviceQueueCreateInfo> deviceQueueCreateInfos;
 
-    float queuePriority = 1.0f;
+    uint32_t queueCount = 0;
+    for (const auto& [_, queueFamily] : queueFamilies)
+        queueCount = std::max(queueCount, queueFamily.queueCount);
+
+    // a priority for each queue of a family.
+    std::vector<float> queuePriorities(queueCount, 1.0f);
     for (const auto& [index, queueFamily] : queueFamilies)
     {
         VkDeviceQueueCreateInfo deviceQueueCreateInfo{};
         deviceQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
         deviceQueueCreateInfo.queueFamilyIndex = index;
         deviceQueueCreateInfo.queueCount = queueFamily.queueCount;
-        deviceQueueCreateInfo.pQueuePriorities = &queuePriority;
+        deviceQueueCreateInfo.pQueuePriorities = queuePriorities.data();
         deviceQueueCreateInfos.push_back(deviceQueueCreateInfo);
     }
 
@@ -280,6 +394,60 @@ void VulkanDevice::createDevice(const std::unordered_map<uint32_t, VkQueueFamily
     deviceCreateInfo.pQueueCreateInfos = deviceQueueCreateInfos.data();
     deviceCreateInfo.pEnabledFeatures = &vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().physicalDeviceFeatures;
 
+    const VulkanPhysicalDeviceInfo& physicalDeviceInfo = vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo();
+    const void** next = &deviceCreateInfo.pNext;
+
+    VkPhysicalDeviceImagelessFramebufferFeatures imagelessFramebufferFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGELESS_FRAMEBUFFER_FEATURES };
+    if (physicalDeviceInfo.imagelessFramebuffer)
+    {
+        imagelessFramebufferFeatures.imagelessFramebuffer = VK_TRUE;
+
+        *next = &imagelessFramebufferFeatures;
+        next = const_cast<const void**>(&imagelessFramebufferFeatures.pNext);
+    }
+
+    VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES };
+    if (physicalDeviceInfo.dynamicRendering)
+    {
+        dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+
+        *next = &dynamicRenderingFeatures;
+        next = const_cast<const void**>(&dynamicRenderingFeatures.pNext);
+    }
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT };
+    if (physicalDeviceInfo.graphicsPipelineLibrary)
+    {
+        graphicsPipelineLibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+
+        *next = &graphicsPipelineLibraryFeatures;
+        next = const_cast<const void**>(&graphicsPipelineLibraryFeatures.pNext);
+    }
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT };
+    if (physicalDeviceInfo.descriptorIndexing)
+    {
+        descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        descriptorIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing = physicalDeviceInfo.descriptorIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing;
+
+        *next = &descriptorIndexingFeatures;
+        next = const_cast<const void**>(&descriptorIndexingFeatures.pNext);
+    }
+
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR };
+    if (physicalDeviceInfo.synchronization2)
+    {
+        synchronization2Features.synchronization2 = VK_TRUE;
+
+        *next = &synchronization2Features;
+        next = const_cast<const void**>(&synchronization2Features.pNext);
+    }
+
     std::vector<const char*> requiredDeviceExtensions = getRequiredDeviceExtensions();
 
     deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(requiredDeviceExtensions.size());
@@ -307,6 +475,53 @@ const std::vector<const char*> VulkanDevice::getRequiredDeviceExtensions()
         requiredDeviceExtensions.push_back("VK_KHR_portability_subset");
     }
 
+    if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().imagelessFramebuffer)
+    {
+        // VK_KHR_image_format_list is required by VK_KHR_imageless_framebuffer before vulkan 1.2.
+        if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().imageFormatList)
+            requiredDeviceExtensions.push_back(VK_KHR_IMAGE_FORMAT_LIST_EXTENSION_NAME);
+
+        requiredDeviceExtensions.push_back(VK_KHR_IMAGELESS_FRAMEBUFFER_EXTENSION_NAME);
+    }
+
+    if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().dynamicRendering)
+    {
+        // VK_KHR_create_renderpass2 and VK_KHR_depth_stencil_resolve are required by VK_KHR_dynamic_rendering before vulkan 1.2.
+        if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().createRenderPass2)
+            requiredDeviceExtensions.push_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+        if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().depthStencilResolve)
+            requiredDeviceExtensions.push_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+
+        requiredDeviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    }
+
+    if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().graphicsPipelineLibrary)
+    {
+        requiredDeviceExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        requiredDeviceExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+    }
+
+    // VK_KHR_maintenance3 which is required by VK_EXT_descriptor_indexing is core in vulkan 1.1.
+    if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().descriptorIndexing)
+    {
+        requiredDeviceExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    }
+
+    if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().pushDescriptor)
+    {
+        requiredDeviceExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+    }
+
+    if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().drawIndirectCount)
+    {
+        requiredDeviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
+
+    if (vulkanPhysicalDevice.getVulkanPhysicalDeviceInfo().synchronization2)
+    {
+        requiredDeviceExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    }
+
     spdlog::info("Required Device extensions :");
     for (const auto& extension : requiredDeviceExtensions)
     {
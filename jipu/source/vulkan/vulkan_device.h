@@ -3,18 +3,25 @@
 #include "jipu/device.h"
 #include "utils/cast.h"
 #include "vulkan_api.h"
+#include "vulkan_bindless_table.h"
+#include "vulkan_binding_group.h"
 #include "vulkan_binding_group_layout.h"
 #include "vulkan_command_buffer.h"
+#include "vulkan_descriptor_allocator.h"
 #include "vulkan_export.h"
 #include "vulkan_framebuffer.h"
+#include "vulkan_mipmap_generator.h"
 #include "vulkan_pipeline.h"
 #include "vulkan_pipeline_layout.h"
 #include "vulkan_render_pass.h"
 #include "vulkan_resource_allocator.h"
 #include "vulkan_swapchain.h"
 #include "vulkan_texture.h"
+#include "vulkan_upload_manager.h"
 
 #include <memory>
+#include <mutex>
+#include <set>
 #include <unordered_set>
 #include <vector>
 
@@ -22,7 +29,7 @@ namespace jipu
 {
 
 class VulkanPhysicalDevice;
-class VULKAN_EXPORT VulkanDevice : public Device
+class VULKAN_EXPORT VulkanDevice final : public Device
 {
 public:
     VulkanDevice() = delete;
@@ -47,6 +54,20 @@ public:
     std::unique_ptr<Swapchain> createSwapchain(const SwapchainDescriptor& descriptor) override;
     std::unique_ptr<Texture> createTexture(const TextureDescriptor& descriptor) override;
 
+public:
+    BindlessTable* getBindlessTable() override;
+    UploadManager& getUploadManager() override;
+    /// @brief the upload manager is created. unlike getUploadManager, it doesn't create it.
+    bool hasUploadManager() const;
+
+public:
+    uint64_t getPendingSerial() override;
+    uint64_t getCompletedSerial() override;
+
+public:
+    DeviceStatistics getStatistics() const override;
+    void resetStatistics() override;
+
 public:
     std::unique_ptr<RenderPipeline> createRenderPipeline(const VulkanRenderPipelineDescriptor& descriptor);
     std::unique_ptr<BindingGroupLayout> createBindingGroupLayout(const VulkanBindingGroupLayoutDescriptor& descriptor);
@@ -56,8 +77,21 @@ public:
 public:
     VulkanRenderPass& getRenderPass(const VulkanRenderPassDescriptor& descriptor);
     VulkanFramebuffer& getFrameBuffer(const VulkanFramebufferDescriptor& descriptor);
+    VulkanFramebufferCache& getFrameBufferCache();
+    VulkanPipelineLibraryCache& getPipelineLibraryCache();
+    VulkanBindingGroupCache& getBindingGroupCache();
+    VulkanDescriptorAllocator& getDescriptorAllocator();
+    VulkanMipmapGenerator& getMipmapGenerator();
     VulkanResourceAllocator& getResourceAllocator();
 
+public:
+    /// @brief called by queues before a submission. it returns the serial of the submission.
+    uint64_t beginSubmit();
+    /// @brief called by queues after the submission is completed. resources retired by it are released.
+    void endSubmit(uint64_t serial);
+    /// @brief states of buffers at the end of submitted command buffers. it must be used under the queue mutex.
+    VulkanBufferTracker& getSubmittedBufferTracker();
+
 public:
     VulkanPhysicalDevice& getPhysicalDevice() const;
 
@@ -66,9 +100,10 @@ public:
     VkPhysicalDevice getVkPhysicalDevice() const;
 
     VkQueue getVkQueue(uint32_t index = 0) const;
+    /// @brief VkQueue must be externally synchronized. submissions and presents to queues of the device are made under it.
+    std::mutex& getQueueMutex();
 
     VkCommandPool getVkCommandPool();
-    VkDescriptorPool getVkDescriptorPool();
 
 public:
     VulkanAPI vkAPI{};
@@ -83,13 +118,26 @@ private:
 private:
     VkDevice m_device = VK_NULL_HANDLE;
     VkCommandPool m_commandPool = VK_NULL_HANDLE;
-    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
 
     std::vector<VkQueue> m_queues{};
 
     VulkanRenderPassCache m_renderPassCache;
     VulkanFramebufferCache m_frameBufferCache;
+    VulkanPipelineLibraryCache m_pipelineLibraryCache;
+    VulkanBindingGroupCache m_bindingGroupCache;
     std::unique_ptr<VulkanResourceAllocator> m_resourceAllocator = nullptr;
+    std::unique_ptr<VulkanDescriptorAllocator> m_descriptorAllocator = nullptr;
+    std::unique_ptr<VulkanBindlessTable> m_bindlessTable = nullptr;
+    std::unique_ptr<VulkanMipmapGenerator> m_mipmapGenerator = nullptr;
+    std::unique_ptr<VulkanUploadManager> m_uploadManager = nullptr;
+    std::unique_ptr<VulkanBufferTracker> m_submittedBufferTracker = nullptr;
+
+private:
+    std::mutex m_queueMutex{};
+    std::mutex m_serialMutex{};
+    uint64_t m_submittedSerial = 0;
+    // submissions which are not completed yet. queues may complete them out of order.
+    std::set<uint64_t> m_pendingSerials{};
 };
 
 DOWN_CAST(VulkanDevice, Device);
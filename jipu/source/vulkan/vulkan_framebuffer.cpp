@@ -6,6 +6,8 @@
 
 #include "utils/hash.h"
 
+#include <algorithm>
+#include <chrono>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 
@@ -26,6 +28,34 @@ VulkanFramebuffer::VulkanFramebuffer(VulkanDevice& device, const VulkanFramebuff
                                                    .height = descriptor.height,
                                                    .layers = descriptor.layers };
 
+    std::vector<VkFramebufferAttachmentImageInfo> attachmentImageInfos{};
+    VkFramebufferAttachmentsCreateInfo attachmentsCreateInfo{ .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENTS_CREATE_INFO };
+    if (isImageless())
+    {
+        attachmentImageInfos.resize(descriptor.attachmentImageInfos.size());
+        for (auto i = 0; i < attachmentImageInfos.size(); ++i)
+        {
+            const auto& imageInfo = descriptor.attachmentImageInfos[i];
+            attachmentImageInfos[i] = { .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENT_IMAGE_INFO,
+                                        .pNext = nullptr,
+                                        .flags = imageInfo.flags,
+                                        .usage = imageInfo.usage,
+                                        .width = imageInfo.width,
+                                        .height = imageInfo.height,
+                                        .layerCount = imageInfo.layerCount,
+                                        .viewFormatCount = 1,
+                                        .pViewFormats = &imageInfo.format };
+        }
+
+        attachmentsCreateInfo.pNext = descriptor.next;
+        attachmentsCreateInfo.attachmentImageInfoCount = static_cast<uint32_t>(attachmentImageInfos.size());
+        attachmentsCreateInfo.pAttachmentImageInfos = attachmentImageInfos.data();
+
+        framebufferCreateInfo.pNext = &attachmentsCreateInfo;
+        framebufferCreateInfo.attachmentCount = static_cast<uint32_t>(attachmentImageInfos.size());
+        framebufferCreateInfo.pAttachments = nullptr;
+    }
+
     if (m_device.vkAPI.CreateFramebuffer(device.getVkDevice(), &framebufferCreateInfo, nullptr, &m_framebuffer) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create framebuffer!");
@@ -52,71 +82,135 @@ uint32_t VulkanFramebuffer::getHeight() const
     return m_descriptor.height;
 }
 
-size_t VulkanFramebufferCache::Functor::operator()(const VulkanFramebufferDescriptor& descriptor) const
+bool VulkanFramebuffer::isImageless() const
 {
-    size_t hash = jipu::hash(reinterpret_cast<uint64_t>(descriptor.renderPass));
+    return m_descriptor.flags & VK_FRAMEBUFFER_CREATE_IMAGELESS_BIT;
+}
 
-    combineHash(hash, descriptor.flags);
-    combineHash(hash, descriptor.width);
-    combineHash(hash, descriptor.height);
-    combineHash(hash, descriptor.layers);
+size_t VulkanFramebufferCache::Functor::operator()(const VulkanFramebufferDescriptor& descriptor) const
+{
+    uint64_t hash = hashPod(descriptor.renderPass);
 
-    for (const auto& attachment : descriptor.attachments)
-    {
-        combineHash(hash, reinterpret_cast<uint64_t>(attachment));
-    }
+    hash = hashPod(descriptor.flags, hash);
+    hash = hashPod(descriptor.width, hash);
+    hash = hashPod(descriptor.height, hash);
+    hash = hashPod(descriptor.layers, hash);
+    hash = hashRange(descriptor.attachments, hash);
+    hash = hashRange(descriptor.attachmentImageInfos, hash);
 
-    return hash;
+    return static_cast<size_t>(hash);
 }
 
 bool VulkanFramebufferCache::Functor::operator()(const VulkanFramebufferDescriptor& lhs,
                                                  const VulkanFramebufferDescriptor& rhs) const
 {
-    if (lhs.flags == rhs.flags &&
-        lhs.width == rhs.width &&
-        lhs.height == rhs.height &&
-        lhs.layers == rhs.layers &&
-        lhs.renderPass == rhs.renderPass &&
-        lhs.attachments.size() == rhs.attachments.size())
-    {
-        for (auto i = 0; i < lhs.attachments.size(); ++i)
-        {
-            if (lhs.attachments[i] != rhs.attachments[i])
-                return false;
-        }
-
-        return true;
-    }
-
-    return false;
+    return lhs.flags == rhs.flags &&
+           lhs.width == rhs.width &&
+           lhs.height == rhs.height &&
+           lhs.layers == rhs.layers &&
+           lhs.renderPass == rhs.renderPass &&
+           equalRange(lhs.attachments, rhs.attachments) &&
+           equalRange(lhs.attachmentImageInfos, rhs.attachmentImageInfos);
 }
 
-VulkanFramebufferCache::VulkanFramebufferCache(VulkanDevice& device)
+VulkanFramebufferCache::VulkanFramebufferCache(VulkanDevice& device, size_t capacity)
     : m_device(device)
+    , m_capacity(capacity)
 {
-    // TODO
 }
 
-VulkanFramebuffer& VulkanFramebufferCache::getFrameBuffer(const VulkanFramebufferDescriptor& descriptor)
+std::shared_ptr<VulkanFramebuffer> VulkanFramebufferCache::getFrameBuffer(const VulkanFramebufferDescriptor& descriptor)
 {
+    releaseCompleted(m_device.getCompletedSerial());
+
+    const uint64_t serial = m_device.getPendingSerial();
+
     auto it = m_cache.find(descriptor);
     if (it != m_cache.end())
     {
-        return *(it->second);
+        // move to front as most recently used.
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        it->second->serial = serial;
+
+        ++m_statistics.hits;
+        return it->second->framebuffer;
+    }
+
+    ++m_statistics.misses;
+
+    if (m_capacity > 0 && m_entries.size() >= m_capacity)
+    {
+        retire(m_entries.back());
+        m_cache.erase(m_entries.back().descriptor);
+        m_entries.pop_back();
+
+        ++m_statistics.evictions;
     }
 
-    auto framebuffer = std::make_unique<VulkanFramebuffer>(m_device, descriptor);
+    const auto begin = std::chrono::steady_clock::now();
+    auto framebuffer = std::make_shared<VulkanFramebuffer>(m_device, descriptor);
+    m_statistics.creationTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
 
-    // get raw pointer before moving.
-    VulkanFramebuffer* framebufferPtr = framebuffer.get();
-    m_cache.emplace(descriptor, std::move(framebuffer));
+    m_entries.push_front({ .descriptor = descriptor, .framebuffer = framebuffer, .serial = serial });
+    m_cache.emplace(descriptor, m_entries.begin());
 
-    return *framebufferPtr;
+    return framebuffer;
+}
+
+void VulkanFramebufferCache::invalidate(VkImageView imageView)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        const auto& attachments = it->descriptor.attachments;
+        if (std::find(attachments.begin(), attachments.end(), imageView) != attachments.end())
+        {
+            retire(*it);
+            m_cache.erase(it->descriptor);
+            it = m_entries.erase(it);
+
+            ++m_statistics.evictions;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void VulkanFramebufferCache::releaseCompleted(uint64_t completedSerial)
+{
+    // command buffers which are not submitted yet still hold their framebuffers.
+    while (!m_retired.empty() && m_retired.front().first <= completedSerial)
+        m_retired.pop_front();
 }
 
 void VulkanFramebufferCache::clear()
 {
     m_cache.clear();
+    m_entries.clear();
+    m_retired.clear();
+}
+
+void VulkanFramebufferCache::retire(Entry& entry)
+{
+    // serials of entries are not ordered, so keep the retired list sorted.
+    auto position = std::upper_bound(m_retired.begin(), m_retired.end(), entry.serial, [](uint64_t serial, const auto& retired) {
+        return serial < retired.first;
+    });
+    m_retired.insert(position, { entry.serial, std::move(entry.framebuffer) });
+}
+
+CacheStatistics VulkanFramebufferCache::getStatistics() const
+{
+    CacheStatistics statistics = m_statistics;
+    statistics.entries = m_entries.size();
+
+    return statistics;
+}
+
+void VulkanFramebufferCache::resetStatistics()
+{
+    m_statistics = CacheStatistics{ .name = m_statistics.name };
 }
 
 } // namespace jipu
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <deque>
+#include <list>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -11,6 +13,17 @@
 namespace jipu
 {
 
+/// @brief attachment information for imageless framebuffer. it must match with the image of the view bound at begin render pass.
+struct VulkanFramebufferAttachmentImageInfo
+{
+    VkImageCreateFlags flags = 0u;
+    VkImageUsageFlags usage = 0u;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t layerCount = 1;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+};
+
 struct VulkanFramebufferDescriptor
 {
     const void* next = nullptr;
@@ -20,10 +33,13 @@ struct VulkanFramebufferDescriptor
     uint32_t width = 0;
     uint32_t height = 0;
     uint32_t layers = 0;
+
+    // used instead of attachments if flags has VK_FRAMEBUFFER_CREATE_IMAGELESS_BIT.
+    std::vector<VulkanFramebufferAttachmentImageInfo> attachmentImageInfos{};
 };
 
 class VulkanDevice;
-class VULKAN_EXPORT VulkanFramebuffer
+class VULKAN_EXPORT VulkanFramebuffer final
 {
 public:
     VulkanFramebuffer() = delete;
@@ -35,6 +51,8 @@ public:
     uint32_t getWidth() const;
     uint32_t getHeight() const;
 
+    bool isImageless() const;
+
 private:
     VulkanDevice& m_device;
     const VulkanFramebufferDescriptor m_descriptor{};
@@ -47,15 +65,28 @@ class VULKAN_EXPORT VulkanFramebufferCache final
 {
 
 public:
-    VulkanFramebufferCache(VulkanDevice& device);
+    VulkanFramebufferCache(VulkanDevice& device, size_t capacity = 64);
     ~VulkanFramebufferCache() = default;
 
-    VulkanFramebuffer& getFrameBuffer(const VulkanFramebufferDescriptor& descriptor);
+    /// @brief the framebuffer is tagged with the pending submit serial of the device.
+    /// command buffers keep the returned reference until they are recorded again.
+    std::shared_ptr<VulkanFramebuffer> getFrameBuffer(const VulkanFramebufferDescriptor& descriptor);
 
+    /// @brief remove all framebuffers which reference the image view. they are destroyed after their submits are completed.
+    void invalidate(VkImageView imageView);
+    /// @brief destroy removed framebuffers whose submits are completed.
+    void releaseCompleted(uint64_t completedSerial);
     void clear();
 
+    CacheStatistics getStatistics() const;
+    void resetStatistics();
+
 private:
     VulkanDevice& m_device;
+    CacheStatistics m_statistics{ .name = "Framebuffer" };
+
+    /// @brief the least recently used framebuffer is removed if the cache is full.
+    size_t m_capacity = 0;
 
 private:
     struct Functor
@@ -65,9 +96,23 @@ private:
         // equal
         bool operator()(const VulkanFramebufferDescriptor& lhs, const VulkanFramebufferDescriptor& rhs) const;
     };
-    using Cache = std::unordered_map<VulkanFramebufferDescriptor, std::unique_ptr<VulkanFramebuffer>, Functor, Functor>;
+    struct Entry
+    {
+        VulkanFramebufferDescriptor descriptor{};
+        std::shared_ptr<VulkanFramebuffer> framebuffer = nullptr;
+        // the last submit serial which may use the framebuffer.
+        uint64_t serial = 0;
+    };
+    using Entries = std::list<Entry>; // most recently used first.
+    using Cache = std::unordered_map<VulkanFramebufferDescriptor, Entries::iterator, Functor, Functor>;
+
+    /// @brief keep the framebuffer of the entry until its submit is completed.
+    void retire(Entry& entry);
 
+    Entries m_entries{};
     Cache m_cache{};
+    // removed framebuffers in serial order.
+    std::deque<std::pair<uint64_t, std::shared_ptr<VulkanFramebuffer>>> m_retired{};
 };
 
 } // namespace jipu
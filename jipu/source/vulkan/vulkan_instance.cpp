@@ -3,6 +3,7 @@
 #include "utils/assert.h"
 #include "vulkan_physical_device.h"
 
+#include <algorithm>
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
@@ -270,6 +271,9 @@ void VulkanInstance::gatherInstanceInfo()
                  VK_API_VERSION_MINOR(apiVersion),
                  VK_API_VERSION_PATCH(apiVersion));
 
+    // vulkan 1.0 loaders don't have vkEnumerateInstanceVersion, and fail to create an instance of higher version.
+    m_instanceInfo.apiVersion = std::min(m_instanceInfo.apiVersion, std::max(apiVersion, VK_API_VERSION_1_0));
+
     // Gather instance layer properties.
     {
         uint32_t instanceLayerCount = 0;
@@ -361,6 +365,10 @@ void VulkanInstance::gatherInstanceInfo()
                 m_instanceInfo.portabilityEnum = true;
             }
 #endif
+            if (strncmp(extensionProperty.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_instanceInfo.getPhysicalDeviceProperties2 = true;
+            }
         }
     }
 }
@@ -423,6 +431,12 @@ const std::vector<const char*> VulkanInstance::getRequiredInstanceExtensions()
     }
 #endif
 
+    // core in vulkan 1.1.
+    if (m_instanceInfo.getPhysicalDeviceProperties2 && m_instanceInfo.apiVersion < VK_API_VERSION_1_1)
+    {
+        requiredInstanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    }
+
     spdlog::info("Required Instance extensions :");
     for (const auto& extension : requiredInstanceExtensions)
     {
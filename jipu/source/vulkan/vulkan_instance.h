@@ -19,7 +19,7 @@ struct VulkanInstanceInfo : VulkanInstanceKnobs
     std::vector<VkExtensionProperties> extensionProperties;
 };
 
-class VULKAN_EXPORT VulkanInstance : public Instance
+class VULKAN_EXPORT VulkanInstance final : public Instance
 {
 
 public:
@@ -0,0 +1,360 @@
+#include "vulkan_mipmap_generator.h"
+#include "vulkan_buffer.h"
+#include "vulkan_command_buffer.h"
+#include "vulkan_device.h"
+#include "vulkan_physical_device.h"
+#include "vulkan_texture.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fmt/format.h>
+#include <stdexcept>
+
+namespace jipu
+{
+
+namespace
+{
+
+#if defined(JIPU_VULKAN_MIPMAP_SHADER)
+// compiled from shaders/vulkan_mipmap.comp for each storage format at build time.
+constexpr uint32_t kMipmapRGBA8ShaderCode[] =
+#include "shaders/vulkan_mipmap_rgba8.comp.inc"
+    ;
+constexpr uint32_t kMipmapRGBA16ShaderCode[] =
+#include "shaders/vulkan_mipmap_rgba16.comp.inc"
+    ;
+constexpr uint32_t kMipmapRGBA8SRGBShaderCode[] =
+#include "shaders/vulkan_mipmap_rgba8_srgb.comp.inc"
+    ;
+#endif
+
+// levels generated by a dispatch except the base level. it must be same as the shader.
+constexpr uint32_t kMaxGeneratedMipLevels = 12;
+// a work group reduces a tile of the base level to 6 levels, and the last work group reduces 64x64 texels to the rest.
+constexpr uint32_t kTileSize = 64;
+constexpr uint32_t kMaxExtent = 4096;
+
+struct PushConstants
+{
+    uint32_t mipLevels = 0;
+    uint32_t workGroups = 0;
+};
+
+std::vector<uint32_t> getShaderCode(VkFormat format)
+{
+#if defined(JIPU_VULKAN_MIPMAP_SHADER)
+    switch (format)
+    {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+        return { std::begin(kMipmapRGBA8ShaderCode), std::end(kMipmapRGBA8ShaderCode) };
+    case VK_FORMAT_R16G16B16A16_UNORM:
+        return { std::begin(kMipmapRGBA16ShaderCode), std::end(kMipmapRGBA16ShaderCode) };
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return { std::begin(kMipmapRGBA8SRGBShaderCode), std::end(kMipmapRGBA8SRGBShaderCode) };
+    default:
+        break;
+    }
+#endif
+    return {};
+}
+
+} // namespace
+
+VulkanMipmapGenerator::VulkanMipmapGenerator(VulkanDevice& device)
+    : m_device(device)
+{
+}
+
+VulkanMipmapGenerator::~VulkanMipmapGenerator()
+{
+    clear();
+
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+    for (auto& [format, pipeline] : m_pipelines)
+        vkAPI.DestroyPipeline(m_device.getVkDevice(), pipeline, nullptr);
+    m_pipelines.clear();
+
+    if (m_pipelineLayout != VK_NULL_HANDLE)
+        vkAPI.DestroyPipelineLayout(m_device.getVkDevice(), m_pipelineLayout, nullptr);
+    if (m_descriptorSetLayout != VK_NULL_HANDLE)
+        vkAPI.DestroyDescriptorSetLayout(m_device.getVkDevice(), m_descriptorSetLayout, nullptr);
+}
+
+bool VulkanMipmapGenerator::isSupported(const VulkanTexture& texture) const
+{
+    if (texture.getType() != TextureType::k2D)
+        return false;
+
+    if (!(texture.getUsage() & TextureUsageFlagBits::kStorageBinding))
+        return false;
+
+    if (texture.getMipLevels() > kMaxGeneratedMipLevels + 1 || texture.getWidth() > kMaxExtent || texture.getHeight() > kMaxExtent)
+        return false;
+
+    const VkFormat format = ToVkFormat(texture.getFormat());
+    if (getShaderCode(format).empty())
+        return false;
+
+    // sRGB images are written through unorm views, and the shader converts texels between sRGB and linear.
+    const VkFormat storageFormat = ToStorageVkFormat(format);
+    if (storageFormat != format && !(texture.getVkImageCreateFlags() & VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT))
+        return false;
+
+    // levels are indexed by a dynamic value in the shader.
+    auto& physicalDevice = m_device.getPhysicalDevice();
+    if (!physicalDevice.getVulkanPhysicalDeviceInfo().physicalDeviceFeatures.shaderStorageImageArrayDynamicIndexing)
+        return false;
+
+    return physicalDevice.isFormatFeatureSupported(storageFormat, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+}
+
+void VulkanMipmapGenerator::generate(VulkanCommandBuffer& commandBuffer, VulkanTexture& texture)
+{
+    if (!isSupported(texture))
+        throw std::runtime_error("The texture is not supported by the mipmap generator.");
+
+    if (texture.getMipLevels() <= 1)
+        return;
+
+    auto pipeline = getPipeline(ToVkFormat(texture.getFormat()));
+    auto& target = getTarget(texture);
+
+    auto& recorder = commandBuffer.getCommandRecorder();
+
+    // counters are cleared before each dispatch, after the dispatch of the previous generation counted them.
+    const VkBuffer counterBuffer = downcast(*target.counterBuffer).getVkBuffer();
+    auto& bufferTracker = commandBuffer.getBufferTracker();
+    bufferTracker.access({ .buffer = counterBuffer,
+                           .offset = 0,
+                           .size = VK_WHOLE_SIZE,
+                           .stageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                           .accessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT });
+    bufferTracker.flush(recorder);
+    recorder.cmdFillBuffer(counterBuffer, 0, VK_WHOLE_SIZE, 0);
+
+    bufferTracker.access({ .buffer = counterBuffer,
+                           .offset = 0,
+                           .size = VK_WHOLE_SIZE,
+                           .stageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                           .accessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT });
+    bufferTracker.flush(recorder);
+
+    const uint32_t workGroupsX = (texture.getWidth() + kTileSize - 1) / kTileSize;
+    const uint32_t workGroupsY = (texture.getHeight() + kTileSize - 1) / kTileSize;
+
+    PushConstants pushConstants{ .mipLevels = texture.getMipLevels() - 1,
+                                 .workGroups = workGroupsX * workGroupsY };
+
+    recorder.cmdBindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    recorder.cmdBindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &target.descriptorSet.descriptorSet, 0, nullptr);
+    recorder.cmdPushConstants(m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+    recorder.cmdDispatch(workGroupsX, workGroupsY, texture.getDepth());
+}
+
+void VulkanMipmapGenerator::invalidate(VkImage image)
+{
+    auto it = m_targets.find(image);
+    if (it == m_targets.end())
+        return;
+
+    destroyTarget(it->second);
+    m_targets.erase(it);
+}
+
+void VulkanMipmapGenerator::clear()
+{
+    for (auto& [image, target] : m_targets)
+        destroyTarget(target);
+    m_targets.clear();
+}
+
+VulkanMipmapGenerator::Target& VulkanMipmapGenerator::getTarget(VulkanTexture& texture)
+{
+    auto it = m_targets.find(texture.getVkImage());
+    if (it != m_targets.end())
+        return it->second;
+
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+    const uint32_t mipLevels = texture.getMipLevels();
+    const uint32_t layers = texture.getDepth();
+
+    Target target{};
+    for (uint32_t mipLevel = 0; mipLevel < mipLevels; ++mipLevel)
+    {
+        VkImageViewCreateInfo imageViewCreateInfo{};
+        imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewCreateInfo.image = texture.getVkImage();
+        imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+        imageViewCreateInfo.format = ToStorageVkFormat(ToVkFormat(texture.getFormat()));
+        imageViewCreateInfo.subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                 .baseMipLevel = mipLevel,
+                                                 .levelCount = 1,
+                                                 .baseArrayLayer = 0,
+                                                 .layerCount = layers };
+
+        VkImageView imageView = VK_NULL_HANDLE;
+        if (vkAPI.CreateImageView(m_device.getVkDevice(), &imageViewCreateInfo, nullptr, &imageView) != VK_SUCCESS)
+        {
+            destroyTarget(target);
+            throw std::runtime_error(fmt::format("Failed to create image view of mip level {} for mipmap generation.", mipLevel));
+        }
+        target.imageViews.push_back(imageView);
+    }
+
+    // a counter for each layer. it is cleared on the GPU before each generation.
+    target.counterBuffer = m_device.createBuffer({ .size = layers * sizeof(uint32_t), .usage = BufferUsageFlagBits::kStorage | BufferUsageFlagBits::kCopyDst });
+
+    target.descriptorSet = m_device.getDescriptorAllocator().allocate(m_descriptorSetLayout,
+                                                                      { { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, kMaxGeneratedMipLevels + 1 },
+                                                                        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 } });
+
+    VkDescriptorImageInfo baseLevelInfo{ .sampler = VK_NULL_HANDLE,
+                                         .imageView = target.imageViews[0],
+                                         .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+
+    // levels which are not generated are bound to the last level. the shader never accesses them.
+    std::array<VkDescriptorImageInfo, kMaxGeneratedMipLevels> mipLevelInfos{};
+    for (uint32_t i = 0; i < kMaxGeneratedMipLevels; ++i)
+    {
+        mipLevelInfos[i] = { .sampler = VK_NULL_HANDLE,
+                             .imageView = target.imageViews[std::min(i + 1, mipLevels - 1)],
+                             .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+    }
+
+    VkDescriptorBufferInfo counterInfo{ .buffer = downcast(*target.counterBuffer).getVkBuffer(),
+                                        .offset = 0,
+                                        .range = VK_WHOLE_SIZE };
+
+    std::array<VkWriteDescriptorSet, 3> writes{};
+    for (uint32_t i = 0; i < writes.size(); ++i)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = target.descriptorSet.descriptorSet;
+        writes[i].dstBinding = i;
+    }
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[0].descriptorCount = 1;
+    writes[0].pImageInfo = &baseLevelInfo;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[1].descriptorCount = kMaxGeneratedMipLevels;
+    writes[1].pImageInfo = mipLevelInfos.data();
+    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[2].descriptorCount = 1;
+    writes[2].pBufferInfo = &counterInfo;
+
+    vkAPI.UpdateDescriptorSets(m_device.getVkDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    return m_targets.emplace(texture.getVkImage(), std::move(target)).first->second;
+}
+
+VkPipeline VulkanMipmapGenerator::getPipeline(VkFormat format)
+{
+    auto it = m_pipelines.find(format);
+    if (it != m_pipelines.end())
+    {
+        ++m_statistics.hits;
+        return it->second;
+    }
+
+    ++m_statistics.misses;
+    const auto begin = std::chrono::steady_clock::now();
+
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+
+    if (m_descriptorSetLayout == VK_NULL_HANDLE)
+    {
+        std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+        bindings[0] = { .binding = 0, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT };
+        bindings[1] = { .binding = 1, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .descriptorCount = kMaxGeneratedMipLevels, .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT };
+        bindings[2] = { .binding = 2, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT };
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
+        descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        descriptorSetLayoutCreateInfo.pBindings = bindings.data();
+
+        if (vkAPI.CreateDescriptorSetLayout(m_device.getVkDevice(), &descriptorSetLayoutCreateInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create descriptor set layout for mipmap generation.");
+    }
+
+    if (m_pipelineLayout == VK_NULL_HANDLE)
+    {
+        VkPushConstantRange pushConstantRange{ .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                                               .offset = 0,
+                                               .size = sizeof(PushConstants) };
+
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+        pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutCreateInfo.setLayoutCount = 1;
+        pipelineLayoutCreateInfo.pSetLayouts = &m_descriptorSetLayout;
+        pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+        pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkAPI.CreatePipelineLayout(m_device.getVkDevice(), &pipelineLayoutCreateInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline layout for mipmap generation.");
+    }
+
+    auto code = getShaderCode(format);
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo{};
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.codeSize = code.size() * sizeof(uint32_t);
+    shaderModuleCreateInfo.pCode = code.data();
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    if (vkAPI.CreateShaderModule(m_device.getVkDevice(), &shaderModuleCreateInfo, nullptr, &shaderModule) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create shader module for mipmap generation.");
+
+    VkComputePipelineCreateInfo pipelineCreateInfo{};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineCreateInfo.stage.module = shaderModule;
+    pipelineCreateInfo.stage.pName = "main";
+    pipelineCreateInfo.layout = m_pipelineLayout;
+    pipelineCreateInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = vkAPI.CreateComputePipelines(m_device.getVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline);
+    vkAPI.DestroyShaderModule(m_device.getVkDevice(), shaderModule, nullptr);
+
+    if (result != VK_SUCCESS)
+        throw std::runtime_error(fmt::format("Failed to create compute pipeline for mipmap generation. [Result: {}]", static_cast<int32_t>(result)));
+
+    m_statistics.creationTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    m_pipelines.emplace(format, pipeline);
+    return pipeline;
+}
+
+CacheStatistics VulkanMipmapGenerator::getStatistics() const
+{
+    CacheStatistics statistics = m_statistics;
+    statistics.entries = m_pipelines.size();
+
+    return statistics;
+}
+
+void VulkanMipmapGenerator::resetStatistics()
+{
+    m_statistics = CacheStatistics{ .name = m_statistics.name };
+}
+
+void VulkanMipmapGenerator::destroyTarget(Target& target)
+{
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+
+    if (target.descriptorSet.descriptorSet != VK_NULL_HANDLE)
+        m_device.getDescriptorAllocator().free(target.descriptorSet);
+    target.descriptorSet = {};
+
+    for (auto imageView : target.imageViews)
+        vkAPI.DestroyImageView(m_device.getVkDevice(), imageView, nullptr);
+    target.imageViews.clear();
+
+    target.counterBuffer.reset();
+}
+
+} // namespace jipu
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "jipu/buffer.h"
+#include "jipu/device.h"
+#include "vulkan_api.h"
+#include "vulkan_descriptor_allocator.h"
+#include "vulkan_export.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace jipu
+{
+
+class VulkanDevice;
+class VulkanTexture;
+class VulkanCommandBuffer;
+
+/// @brief generates all mip levels of a texture from the base level with a single compute dispatch.
+/// each work group reduces a 64x64 tile of the base level to 6 levels in shared memory,
+/// and the last work group of a layer reduces the rest of levels.
+class VULKAN_EXPORT VulkanMipmapGenerator final
+{
+public:
+    VulkanMipmapGenerator() = delete;
+    VulkanMipmapGenerator(VulkanDevice& device);
+    ~VulkanMipmapGenerator();
+
+    VulkanMipmapGenerator(const VulkanMipmapGenerator&) = delete;
+    VulkanMipmapGenerator& operator=(const VulkanMipmapGenerator&) = delete;
+
+public:
+    /// @brief 2D textures which have storage binding usage and a storage format, up to 4096x4096.
+    /// sRGB textures are supported if they are created to be written through unorm views.
+    bool isSupported(const VulkanTexture& texture) const;
+
+    /// @brief record the dispatch. all levels of the texture must be in general layout for compute shaders.
+    void generate(VulkanCommandBuffer& commandBuffer, VulkanTexture& texture);
+
+    /// @brief remove resources of the texture. it must not be used by pending command buffers.
+    void invalidate(VkImage image);
+    void clear();
+
+    /// @brief pipelines of the formats. a lookup is counted for each generation by the compute shader.
+    CacheStatistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    // image views of the levels, the descriptor set and the counters of the layers for a texture.
+    struct Target
+    {
+        std::vector<VkImageView> imageViews{};
+        VulkanDescriptorSetAllocation descriptorSet{};
+        std::unique_ptr<Buffer> counterBuffer = nullptr;
+    };
+
+    Target& getTarget(VulkanTexture& texture);
+    VkPipeline getPipeline(VkFormat format);
+    void destroyTarget(Target& target);
+
+private:
+    VulkanDevice& m_device;
+
+    VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    std::unordered_map<VkFormat, VkPipeline> m_pipelines{};
+    std::unordered_map<VkImage, Target> m_targets{};
+
+    CacheStatistics m_statistics{ .name = "Mipmap Pipeline" };
+};
+
+} // namespace jipu
@@ -0,0 +1,187 @@
+#include "vulkan_pass_encoder_state.h"
+#include "vulkan_command_recorder.h"
+#include "vulkan_pipeline_layout.h"
+
+#include <algorithm>
+
+namespace jipu
+{
+
+namespace
+{
+
+bool isSameBinding(VkDescriptorSet lhsSet, std::span<const uint32_t> lhsOffsets, VkDescriptorSet rhsSet, std::span<const uint32_t> rhsOffsets)
+{
+    return lhsSet == rhsSet && std::equal(lhsOffsets.begin(), lhsOffsets.end(), rhsOffsets.begin(), rhsOffsets.end());
+}
+
+} // namespace
+
+VulkanDescriptorSetState::VulkanDescriptorSetState(VkPipelineBindPoint bindPoint, VulkanPassEncoderStatistics& statistics)
+    : m_bindPoint(bindPoint)
+    , m_statistics(statistics)
+{
+}
+
+void VulkanDescriptorSetState::setPipelineLayout(const VulkanPipelineLayout& pipelineLayout)
+{
+    if (m_pipelineLayout == &pipelineLayout)
+        return;
+
+    // binding a pipeline with a compatible layout doesn't disturb the sets which are already bound.
+    const uint32_t compatibleSetCount = m_pipelineLayout ? m_pipelineLayout->getCompatibleSetCount(pipelineLayout) : 0;
+    for (uint32_t index = compatibleSetCount; index < m_slots.size(); ++index)
+        m_slots[index].bound = Binding{};
+
+    markDirty(compatibleSetCount, static_cast<uint32_t>(m_slots.size()));
+
+    m_pipelineLayout = &pipelineLayout;
+}
+
+void VulkanDescriptorSetState::invalidate(uint32_t index)
+{
+    if (index < m_slots.size())
+        m_slots[index] = Slot{};
+}
+
+void VulkanDescriptorSetState::setDescriptorSet(uint32_t index, VkDescriptorSet descriptorSet, std::span<const uint32_t> dynamicOffsets)
+{
+    if (index >= m_slots.size())
+        m_slots.resize(index + 1);
+
+    auto& slot = m_slots[index];
+    auto& requested = slot.requested;
+    if (isSameBinding(requested.descriptorSet, requested.dynamicOffsets, descriptorSet, dynamicOffsets))
+    {
+        ++m_statistics.elidedCommands;
+        return;
+    }
+
+    // the call is elided once, if it replaces a request before it is bound or requests the bound set again.
+    const bool replaced = isDirty(slot);
+
+    requested.descriptorSet = descriptorSet;
+    requested.dynamicOffsets.assign(dynamicOffsets.begin(), dynamicOffsets.end());
+
+    const bool dirty = isDirty(slot);
+    if (replaced || !dirty)
+        ++m_statistics.elidedCommands;
+
+    if (dirty)
+        markDirty(index, index + 1);
+}
+
+void VulkanDescriptorSetState::flush(VulkanCommandRecorder& recorder)
+{
+    if (m_pipelineLayout == nullptr || m_dirtyBegin >= m_dirtyEnd)
+        return;
+
+    // sets which are not in the layout are kept dirty until a layout including them is set.
+    const uint32_t end = std::min({ m_dirtyEnd, static_cast<uint32_t>(m_slots.size()), m_pipelineLayout->getDescriptorSetLayoutCount() });
+
+    uint32_t index = m_dirtyBegin;
+    while (index < end)
+    {
+        if (!isDirty(m_slots[index]))
+        {
+            ++index;
+            continue;
+        }
+
+        const uint32_t firstSet = index;
+        m_descriptorSets.clear();
+        m_dynamicOffsets.clear();
+        for (; index < end && isDirty(m_slots[index]); ++index)
+        {
+            auto& slot = m_slots[index];
+            m_descriptorSets.push_back(slot.requested.descriptorSet);
+            m_dynamicOffsets.insert(m_dynamicOffsets.end(), slot.requested.dynamicOffsets.begin(), slot.requested.dynamicOffsets.end());
+            slot.bound = slot.requested;
+        }
+
+        recorder.cmdBindDescriptorSets(m_bindPoint,
+                                       m_pipelineLayout->getVkPipelineLayout(),
+                                       firstSet,
+                                       static_cast<uint32_t>(m_descriptorSets.size()),
+                                       m_descriptorSets.data(),
+                                       static_cast<uint32_t>(m_dynamicOffsets.size()),
+                                       m_dynamicOffsets.data());
+
+        ++m_statistics.issuedCommands;
+        m_statistics.elidedCommands += m_descriptorSets.size() - 1;
+    }
+
+    if (end < m_dirtyEnd)
+    {
+        m_dirtyBegin = std::max(m_dirtyBegin, end);
+    }
+    else
+    {
+        m_dirtyBegin = 0;
+        m_dirtyEnd = 0;
+    }
+}
+
+bool VulkanDescriptorSetState::isDirty(const Slot& slot) const
+{
+    return slot.requested.descriptorSet != VK_NULL_HANDLE &&
+           !isSameBinding(slot.requested.descriptorSet, slot.requested.dynamicOffsets, slot.bound.descriptorSet, slot.bound.dynamicOffsets);
+}
+
+void VulkanDescriptorSetState::markDirty(uint32_t begin, uint32_t end)
+{
+    if (begin >= end)
+        return;
+
+    if (m_dirtyBegin >= m_dirtyEnd)
+    {
+        m_dirtyBegin = begin;
+        m_dirtyEnd = end;
+        return;
+    }
+
+    m_dirtyBegin = std::min(m_dirtyBegin, begin);
+    m_dirtyEnd = std::max(m_dirtyEnd, end);
+}
+
+VulkanBufferAccessState::VulkanBufferAccessState(VkPipelineStageFlags2 stageMask)
+    : m_stageMask(stageMask)
+{
+}
+
+void VulkanBufferAccessState::setBufferAccesses(uint32_t index, std::span<const VulkanBufferAccess> accesses)
+{
+    if (index >= m_accesses.size())
+        m_accesses.resize(index + 1);
+
+    auto& setAccesses = m_accesses[index];
+    setAccesses.clear();
+    for (const auto& access : accesses)
+    {
+        if ((access.stageMask & m_stageMask) == VK_PIPELINE_STAGE_2_NONE)
+            continue;
+
+        setAccesses.push_back(access);
+        setAccesses.back().stageMask &= m_stageMask;
+    }
+
+    m_dirty = true;
+}
+
+bool VulkanBufferAccessState::isDirty() const
+{
+    return m_dirty;
+}
+
+void VulkanBufferAccessState::access(VulkanBufferTracker& tracker)
+{
+    for (const auto& setAccesses : m_accesses)
+    {
+        for (const auto& access : setAccesses)
+            tracker.access(access);
+    }
+
+    m_dirty = false;
+}
+
+} // namespace jipu
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "vulkan_api.h"
+#include "vulkan_buffer_tracker.h"
+#include "vulkan_export.h"
+
+#include <span>
+#include <vector>
+
+namespace jipu
+{
+
+struct VulkanPassEncoderStatistics
+{
+    /// @brief state commands which are recorded to the command buffer.
+    uint64_t issuedCommands = 0;
+    /// @brief state commands which are skipped because the same state is already requested or bound, replaced before they are bound,
+    /// or merged into another command. each call is counted once.
+    uint64_t elidedCommands = 0;
+};
+
+class VulkanCommandRecorder;
+class VulkanPipelineLayout;
+
+/// @brief descriptor sets of a bind point while a pass is recorded.
+/// sets are bound lazily by flush before draw or dispatch, so they can be set before the pipeline.
+class VULKAN_EXPORT VulkanDescriptorSetState final
+{
+public:
+    VulkanDescriptorSetState() = delete;
+    VulkanDescriptorSetState(VkPipelineBindPoint bindPoint, VulkanPassEncoderStatistics& statistics);
+
+public:
+    /// @brief sets after the compatible range of the new layout are bound again by next flush.
+    void setPipelineLayout(const VulkanPipelineLayout& pipelineLayout);
+
+    /// @brief forget the set at the index. it is overwritten by push descriptors.
+    void invalidate(uint32_t index);
+
+    void setDescriptorSet(uint32_t index, VkDescriptorSet descriptorSet, std::span<const uint32_t> dynamicOffsets);
+
+    /// @brief bind dirty sets with one command per contiguous range.
+    void flush(VulkanCommandRecorder& recorder);
+
+private:
+    struct Binding
+    {
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        std::vector<uint32_t> dynamicOffsets{};
+    };
+
+    struct Slot
+    {
+        Binding requested{};
+        Binding bound{};
+    };
+
+    bool isDirty(const Slot& slot) const;
+    void markDirty(uint32_t begin, uint32_t end);
+
+private:
+    const VkPipelineBindPoint m_bindPoint;
+    VulkanPassEncoderStatistics& m_statistics;
+
+    const VulkanPipelineLayout* m_pipelineLayout = nullptr;
+    std::vector<Slot> m_slots{};
+
+    // [begin, end) range of slots to check at flush.
+    uint32_t m_dirtyBegin = 0;
+    uint32_t m_dirtyEnd = 0;
+
+    // reused by flush to avoid allocation for each draw.
+    std::vector<VkDescriptorSet> m_descriptorSets{};
+    std::vector<uint32_t> m_dynamicOffsets{};
+};
+
+/// @brief buffers which are accessed by binding groups of a bind point. they are added to the buffer tracker at draw or dispatch.
+class VULKAN_EXPORT VulkanBufferAccessState final
+{
+public:
+    VulkanBufferAccessState() = delete;
+    /// @param stageMask stages of the bind point. other stages in binding group layouts are ignored.
+    explicit VulkanBufferAccessState(VkPipelineStageFlags2 stageMask);
+
+public:
+    void setBufferAccesses(uint32_t index, std::span<const VulkanBufferAccess> accesses);
+
+    /// @brief true if accesses are changed after they are added to a tracker.
+    bool isDirty() const;
+    /// @brief add accesses of all sets to the tracker.
+    void access(VulkanBufferTracker& tracker);
+
+private:
+    const VkPipelineStageFlags2 m_stageMask;
+
+    std::vector<std::vector<VulkanBufferAccess>> m_accesses{};
+    bool m_dirty = false;
+};
+
+} // namespace jipu
@@ -81,6 +81,10 @@ void VulkanPhysicalDevice::gatherPhysicalDeviceInfo()
 
     vkAPI.GetPhysicalDeviceFeatures(m_physicalDevice, &m_info.physicalDeviceFeatures);
 
+    // core in vulkan 1.1.
+    m_info.descriptorUpdateTemplate = m_info.physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_1;
+    m_info.imageExtendedUsage = m_info.physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_1;
+
     // Gather device memory properties.
     {
         VkPhysicalDeviceMemoryProperties memoryProperties{};
@@ -166,8 +170,155 @@ void VulkanPhysicalDevice::gatherPhysicalDeviceInfo()
             {
                 m_info.swapchain = true;
             }
+
+            if (strncmp(extensionProperty.extensionName, VK_KHR_IMAGE_FORMAT_LIST_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.imageFormatList = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_KHR_IMAGELESS_FRAMEBUFFER_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.imagelessFramebuffer = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.createRenderPass2 = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.depthStencilResolve = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.dynamicRendering = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.pipelineLibrary = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.graphicsPipelineLibrary = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.descriptorIndexing = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.pushDescriptor = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.drawIndirectCount = true;
+            }
+
+            if (strncmp(extensionProperty.extensionName, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE) == 0)
+            {
+                m_info.synchronization2 = true;
+            }
         }
     }
+
+    // extension features and properties are queried through vkGetPhysicalDevice*2, which needs vulkan 1.1 or VK_KHR_get_physical_device_properties2.
+    const auto& instanceInfo = downcast(m_instance).getInstanceInfo();
+    const bool properties2 = (instanceInfo.apiVersion >= VK_API_VERSION_1_1 && m_info.physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_1) ||
+                             (instanceInfo.getPhysicalDeviceProperties2 && instanceInfo.apiVersion < VK_API_VERSION_1_1);
+    if (!properties2)
+    {
+        spdlog::warn("Extension features are disabled because vkGetPhysicalDeviceFeatures2 is not supported.");
+
+        m_info.imagelessFramebuffer = false;
+        m_info.dynamicRendering = false;
+        m_info.graphicsPipelineLibrary = false;
+        m_info.descriptorIndexing = false;
+        m_info.pushDescriptor = false;
+        m_info.synchronization2 = false;
+        return;
+    }
+
+    // Gather extension features.
+    {
+        VkPhysicalDeviceFeatures2 features2{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+        void** next = &features2.pNext;
+
+        auto chain = [&next](auto& feature) {
+            *next = &feature;
+            next = &feature.pNext;
+        };
+
+        m_info.imagelessFramebufferFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGELESS_FRAMEBUFFER_FEATURES;
+        if (m_info.imagelessFramebuffer)
+            chain(m_info.imagelessFramebufferFeatures);
+
+        m_info.dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+        if (m_info.dynamicRendering)
+            chain(m_info.dynamicRenderingFeatures);
+
+        // VK_KHR_pipeline_library is required by VK_EXT_graphics_pipeline_library.
+        m_info.graphicsPipelineLibrary = m_info.graphicsPipelineLibrary && m_info.pipelineLibrary;
+        m_info.graphicsPipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+        if (m_info.graphicsPipelineLibrary)
+            chain(m_info.graphicsPipelineLibraryFeatures);
+
+        m_info.descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        if (m_info.descriptorIndexing)
+            chain(m_info.descriptorIndexingFeatures);
+
+        m_info.synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+        if (m_info.synchronization2)
+            chain(m_info.synchronization2Features);
+
+        vkAPI.GetPhysicalDeviceFeatures2(m_physicalDevice, &features2);
+
+        // the extension can be listed without the feature being supported.
+        m_info.imagelessFramebuffer = m_info.imagelessFramebufferFeatures.imagelessFramebuffer == VK_TRUE;
+        m_info.dynamicRendering = m_info.dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+        m_info.graphicsPipelineLibrary = m_info.graphicsPipelineLibraryFeatures.graphicsPipelineLibrary == VK_TRUE;
+        m_info.synchronization2 = m_info.synchronization2Features.synchronization2 == VK_TRUE;
+
+        // features used by bindless table.
+        const auto& descriptorIndexingFeatures = m_info.descriptorIndexingFeatures;
+        m_info.descriptorIndexing = descriptorIndexingFeatures.runtimeDescriptorArray == VK_TRUE &&
+                                    descriptorIndexingFeatures.descriptorBindingPartiallyBound == VK_TRUE &&
+                                    descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending == VK_TRUE &&
+                                    descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+                                    descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind == VK_TRUE &&
+                                    descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing == VK_TRUE;
+    }
+
+    // Gather extension properties.
+    {
+        VkPhysicalDeviceProperties2 properties2{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+        void** next = &properties2.pNext;
+
+        auto chain = [&next](auto& property) {
+            *next = &property;
+            next = &property.pNext;
+        };
+
+        m_info.graphicsPipelineLibraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+        if (m_info.graphicsPipelineLibrary)
+            chain(m_info.graphicsPipelineLibraryProperties);
+
+        m_info.descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+        if (m_info.descriptorIndexing)
+            chain(m_info.descriptorIndexingProperties);
+
+        m_info.pushDescriptorProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR;
+        if (m_info.pushDescriptor)
+            chain(m_info.pushDescriptorProperties);
+
+        vkAPI.GetPhysicalDeviceProperties2(m_physicalDevice, &properties2);
+    }
 }
 
 VulkanSurfaceInfo VulkanPhysicalDevice::gatherSurfaceInfo(VulkanSurface& surface) const
@@ -251,4 +402,14 @@ bool VulkanPhysicalDevice::isDepthStencilSupported(VkFormat format) const
     return formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
 }
 
+bool VulkanPhysicalDevice::isFormatFeatureSupported(VkFormat format, VkFormatFeatureFlags features) const
+{
+    const VulkanAPI& vkAPI = downcast(m_instance).vkAPI;
+
+    VkFormatProperties formatProperties{};
+    vkAPI.GetPhysicalDeviceFormatProperties(m_physicalDevice, format, &formatProperties);
+
+    return (formatProperties.optimalTilingFeatures & features) == features;
+}
+
 } // namespace jipu
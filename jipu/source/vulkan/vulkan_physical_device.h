@@ -12,7 +12,15 @@ namespace jipu
 struct VulkanPhysicalDeviceInfo : VulkanDeviceKnobs
 {
     VkPhysicalDeviceFeatures physicalDeviceFeatures{};
+    VkPhysicalDeviceImagelessFramebufferFeatures imagelessFramebufferFeatures{};
+    VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures{};
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{};
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{};
     VkPhysicalDeviceProperties physicalDeviceProperties{};
+    VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphicsPipelineLibraryProperties{};
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT descriptorIndexingProperties{};
+    VkPhysicalDevicePushDescriptorPropertiesKHR pushDescriptorProperties{};
 
     std::vector<VkQueueFamilyProperties> queueFamilyProperties{};
 
@@ -29,7 +37,7 @@ struct VulkanPhysicalDeviceDescriptor
 };
 
 class VulkanInstance;
-class VULKAN_EXPORT VulkanPhysicalDevice : public PhysicalDevice
+class VULKAN_EXPORT VulkanPhysicalDevice final : public PhysicalDevice
 {
 public:
     VulkanPhysicalDevice() = delete;
@@ -49,6 +57,8 @@ public:
 
     int findMemoryTypeIndex(VkMemoryPropertyFlags flags) const;
     bool isDepthStencilSupported(VkFormat format) const;
+    /// @brief true if optimal tiling images of the format support all of the features.
+    bool isFormatFeatureSupported(VkFormat format, VkFormatFeatureFlags features) const;
 
 public:
     VkInstance getVkInstance() const;
@@ -1,11 +1,17 @@
 #include "vulkan_pipeline.h"
 #include "vulkan_device.h"
+#include "vulkan_physical_device.h"
 #include "vulkan_pipeline_layout.h"
 #include "vulkan_render_pass.h"
 #include "vulkan_texture.h"
 #include "vulkan_texture_view.h"
 
+#include "utils/hash.h"
+
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 
@@ -64,6 +70,231 @@ void VulkanComputePipeline::initialize()
 }
 
 // Vulkan Render Pipeline
+namespace
+{
+
+VkPipelineVertexInputStateCreateInfo generateVkPipelineVertexInputStateCreateInfo(const VulkanPipelineVertexInputStateCreateInfo& vertexInputState)
+{
+    VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
+    vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputStateCreateInfo.pNext = vertexInputState.next;
+    vertexInputStateCreateInfo.flags = vertexInputState.flags;
+    vertexInputStateCreateInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(vertexInputState.vertexBindingDescriptions.size());
+    vertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInputState.vertexAttributeDescriptions.size());
+    vertexInputStateCreateInfo.pVertexBindingDescriptions = vertexInputState.vertexBindingDescriptions.data();
+    vertexInputStateCreateInfo.pVertexAttributeDescriptions = vertexInputState.vertexAttributeDescriptions.data();
+
+    return vertexInputStateCreateInfo;
+}
+
+VkPipelineColorBlendStateCreateInfo generateVkPipelineColorBlendStateCreateInfo(const VulkanPipelineColorBlendStateCreateInfo& colorBlendState)
+{
+    VkPipelineColorBlendStateCreateInfo colorBlendCreateInfo{};
+    colorBlendCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlendCreateInfo.pNext = colorBlendState.next;
+    colorBlendCreateInfo.flags = colorBlendState.flags;
+    colorBlendCreateInfo.attachmentCount = static_cast<uint32_t>(colorBlendState.attachments.size());
+    colorBlendCreateInfo.pAttachments = colorBlendState.attachments.data();
+    colorBlendCreateInfo.logicOpEnable = colorBlendState.logicOpEnable;
+    colorBlendCreateInfo.logicOp = colorBlendState.logicOp;
+    colorBlendCreateInfo.blendConstants[0] = colorBlendState.blendConstants[0];
+    colorBlendCreateInfo.blendConstants[1] = colorBlendState.blendConstants[1];
+    colorBlendCreateInfo.blendConstants[2] = colorBlendState.blendConstants[2];
+    colorBlendCreateInfo.blendConstants[3] = colorBlendState.blendConstants[3];
+
+    return colorBlendCreateInfo;
+}
+
+VkPipelineDynamicStateCreateInfo generateVkPipelineDynamicStateCreateInfo(const VulkanPipelineDynamicStateCreateInfo& dynamicState)
+{
+    VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
+    dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicStateCreateInfo.pNext = dynamicState.next;
+    dynamicStateCreateInfo.flags = dynamicState.flags;
+    dynamicStateCreateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicState.dynamicStates.size());
+    dynamicStateCreateInfo.pDynamicStates = dynamicState.dynamicStates.data();
+
+    return dynamicStateCreateInfo;
+}
+
+VkPipelineRenderingCreateInfo generateVkPipelineRenderingCreateInfo(const VulkanPipelineRenderingCreateInfo& renderingInfo)
+{
+    VkPipelineRenderingCreateInfo renderingCreateInfo{};
+    renderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    renderingCreateInfo.viewMask = renderingInfo.viewMask;
+    renderingCreateInfo.colorAttachmentCount = static_cast<uint32_t>(renderingInfo.colorAttachmentFormats.size());
+    renderingCreateInfo.pColorAttachmentFormats = renderingInfo.colorAttachmentFormats.data();
+    renderingCreateInfo.depthAttachmentFormat = renderingInfo.depthAttachmentFormat;
+    renderingCreateInfo.stencilAttachmentFormat = renderingInfo.stencilAttachmentFormat;
+
+    return renderingCreateInfo;
+}
+
+VkPipeline linkPipelineLibraries(VulkanDevice& device,
+                                 const std::array<VkPipeline, 4>& libraries,
+                                 VkPipelineLayout layout,
+                                 VkPipelineCreateFlags flags)
+{
+    VkPipelineLibraryCreateInfoKHR libraryCreateInfo{};
+    libraryCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    libraryCreateInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+    libraryCreateInfo.pLibraries = libraries.data();
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = &libraryCreateInfo;
+    pipelineInfo.flags = flags;
+    pipelineInfo.layout = layout;
+    pipelineInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (device.vkAPI.CreateGraphicsPipelines(device.getVkDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    return pipeline;
+}
+
+// pipeline library key
+template <typename T>
+void appendKey(std::string& key, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "key value must be trivially copyable.");
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void appendKey(std::string& key, const std::vector<T>& values)
+{
+    appendKey(key, values.size());
+    key.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+void appendKey(std::string& key, const VkPipelineShaderStageCreateInfo& stage)
+{
+    appendKey(key, stage.flags);
+    appendKey(key, stage.stage);
+    appendKey(key, stage.module);
+    key.append(stage.pName);
+    key.push_back('\0');
+
+    // stages which differ only in specialization constants are compiled to different libraries.
+    const VkSpecializationInfo* specializationInfo = stage.pSpecializationInfo;
+    if (specializationInfo == nullptr)
+    {
+        appendKey(key, uint32_t{ 0 });
+        appendKey(key, size_t{ 0 });
+        return;
+    }
+
+    appendKey(key, specializationInfo->mapEntryCount);
+    key.append(reinterpret_cast<const char*>(specializationInfo->pMapEntries), specializationInfo->mapEntryCount * sizeof(VkSpecializationMapEntry));
+    appendKey(key, specializationInfo->dataSize);
+    key.append(reinterpret_cast<const char*>(specializationInfo->pData), specializationInfo->dataSize);
+}
+
+void appendKey(std::string& key, const VkPipelineMultisampleStateCreateInfo& multisampleState)
+{
+    appendKey(key, multisampleState.rasterizationSamples);
+    appendKey(key, multisampleState.sampleShadingEnable);
+    appendKey(key, multisampleState.minSampleShading);
+    appendKey(key, multisampleState.alphaToCoverageEnable);
+    appendKey(key, multisampleState.alphaToOneEnable);
+}
+
+void appendRenderTargetKey(std::string& key, const VulkanRenderPipelineDescriptor& descriptor, bool formats)
+{
+    if (descriptor.renderPass)
+    {
+        appendKey(key, descriptor.renderPass->getVkRenderPass());
+        appendKey(key, descriptor.subpass);
+    }
+    else
+    {
+        appendKey(key, descriptor.renderingInfo.viewMask);
+        if (formats)
+        {
+            appendKey(key, descriptor.renderingInfo.colorAttachmentFormats);
+            appendKey(key, descriptor.renderingInfo.depthAttachmentFormat);
+            appendKey(key, descriptor.renderingInfo.stencilAttachmentFormat);
+        }
+    }
+}
+
+std::string generatePipelineLibraryKey(VkGraphicsPipelineLibraryFlagBitsEXT part, const VulkanRenderPipelineDescriptor& descriptor)
+{
+    std::string key{};
+    appendKey(key, part);
+
+    switch (part)
+    {
+    case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+        appendKey(key, descriptor.vertexInputState.vertexBindingDescriptions);
+        appendKey(key, descriptor.vertexInputState.vertexAttributeDescriptions);
+        appendKey(key, descriptor.inputAssemblyState.topology);
+        appendKey(key, descriptor.inputAssemblyState.primitiveRestartEnable);
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+        appendKey(key, downcast(descriptor.layout).getVkPipelineLayout());
+        for (const auto& stage : descriptor.stages)
+        {
+            if (stage.stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+                appendKey(key, stage);
+        }
+        appendKey(key, descriptor.viewportState.viewportCount);
+        appendKey(key, descriptor.viewportState.scissorCount);
+        appendKey(key, descriptor.rasterizationState.depthClampEnable);
+        appendKey(key, descriptor.rasterizationState.rasterizerDiscardEnable);
+        appendKey(key, descriptor.rasterizationState.polygonMode);
+        appendKey(key, descriptor.rasterizationState.cullMode);
+        appendKey(key, descriptor.rasterizationState.frontFace);
+        appendKey(key, descriptor.rasterizationState.depthBiasEnable);
+        appendKey(key, descriptor.rasterizationState.depthBiasConstantFactor);
+        appendKey(key, descriptor.rasterizationState.depthBiasClamp);
+        appendKey(key, descriptor.rasterizationState.depthBiasSlopeFactor);
+        appendKey(key, descriptor.rasterizationState.lineWidth);
+        appendKey(key, descriptor.dynamicState.dynamicStates);
+        appendRenderTargetKey(key, descriptor, false);
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+        appendKey(key, downcast(descriptor.layout).getVkPipelineLayout());
+        for (const auto& stage : descriptor.stages)
+        {
+            if (stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+                appendKey(key, stage);
+        }
+        appendKey(key, descriptor.depthStencilState.depthTestEnable);
+        appendKey(key, descriptor.depthStencilState.depthWriteEnable);
+        appendKey(key, descriptor.depthStencilState.depthCompareOp);
+        appendKey(key, descriptor.depthStencilState.depthBoundsTestEnable);
+        appendKey(key, descriptor.depthStencilState.stencilTestEnable);
+        appendKey(key, descriptor.depthStencilState.front);
+        appendKey(key, descriptor.depthStencilState.back);
+        appendKey(key, descriptor.depthStencilState.minDepthBounds);
+        appendKey(key, descriptor.depthStencilState.maxDepthBounds);
+        appendKey(key, descriptor.multisampleState);
+        appendKey(key, descriptor.dynamicState.dynamicStates);
+        appendRenderTargetKey(key, descriptor, false);
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+        appendKey(key, descriptor.colorBlendState.logicOpEnable);
+        appendKey(key, descriptor.colorBlendState.logicOp);
+        appendKey(key, descriptor.colorBlendState.attachments);
+        appendKey(key, descriptor.colorBlendState.blendConstants);
+        appendKey(key, descriptor.multisampleState);
+        appendKey(key, descriptor.dynamicState.dynamicStates);
+        appendRenderTargetKey(key, descriptor, true);
+        break;
+    default:
+        throw std::runtime_error(fmt::format("Unknown pipeline library part {}.", static_cast<uint32_t>(part)));
+    }
+
+    return key;
+}
+
+} // namespace
+
 std::vector<VkVertexInputBindingDescription> generateVertexInputBindingDescription(const RenderPipelineDescriptor& descriptor)
 {
     std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
@@ -281,13 +512,36 @@ VulkanRenderPassDescriptor generateVulkanRenderPassDescriptor(const RenderPipeli
     // Refer to render pass compatibility (https://registry.khronos.org/vulkan/specs/1.3-extensions/html/vkspec.html#renderpass-compatibility)
     VulkanRenderPassDescriptor vkdescriptor{};
 
-    uint32_t targetSize = static_cast<uint32_t>(descriptor.fragment.targets.size());
+    // formats of all attachments of the render pass if the pipeline is used in a subpass.
+    std::vector<TextureFormat> colorFormats{};
+    std::optional<TextureFormat> depthStencilFormat = std::nullopt;
+    std::vector<SubpassDescriptor> subpasses{};
+    if (descriptor.subpass.has_value())
+    {
+        const auto& subpass = descriptor.subpass.value();
+        if (subpass.index >= subpass.subpasses.size())
+            throw std::runtime_error(fmt::format("Subpass {} is out of {} subpasses.", subpass.index, subpass.subpasses.size()));
+        if (subpass.subpasses[subpass.index].colorAttachments.size() != descriptor.fragment.targets.size())
+            throw std::runtime_error("Fragment targets are not same as the color attachments of the subpass.");
+
+        colorFormats = subpass.colorFormats;
+        if (subpass.depthStencilFormat != TextureFormat::kUndefined)
+            depthStencilFormat = subpass.depthStencilFormat;
+        subpasses = subpass.subpasses;
+    }
+    else
+    {
+        for (const auto& target : descriptor.fragment.targets)
+            colorFormats.push_back(target.format);
+        if (descriptor.depthStencil.has_value())
+            depthStencilFormat = descriptor.depthStencil.value().format;
+    }
 
-    for (const auto& target : descriptor.fragment.targets)
+    for (const auto& format : colorFormats)
     {
         VkAttachmentDescription attachment{};
 
-        attachment.format = ToVkFormat(target.format);
+        attachment.format = ToVkFormat(format);
         attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
         attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
@@ -301,11 +555,11 @@ VulkanRenderPassDescriptor generateVulkanRenderPassDescriptor(const RenderPipeli
 
     if (descriptor.rasterization.sampleCount > 1)
     {
-        for (const auto& target : descriptor.fragment.targets)
+        for (const auto& format : colorFormats)
         {
             VkAttachmentDescription attachment{};
 
-            attachment.format = ToVkFormat(target.format);
+            attachment.format = ToVkFormat(format);
             attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
             attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
             attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
@@ -318,12 +572,10 @@ VulkanRenderPassDescriptor generateVulkanRenderPassDescriptor(const RenderPipeli
         }
     }
 
-    if (descriptor.depthStencil.has_value())
+    if (depthStencilFormat.has_value())
     {
-        auto depthStencil = descriptor.depthStencil.value();
-
         VkAttachmentDescription attachment{};
-        attachment.format = ToVkFormat(depthStencil.format);
+        attachment.format = ToVkFormat(depthStencilFormat.value());
         attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
         attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
@@ -335,64 +587,41 @@ VulkanRenderPassDescriptor generateVulkanRenderPassDescriptor(const RenderPipeli
         vkdescriptor.attachmentDescriptions.push_back(attachment);
     }
 
-    {
-        VulkanSubpassDescription subpassDescription{};
-        subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-
-        // color attachments
-        uint32_t colorAttachmentCount = static_cast<uint32_t>(descriptor.fragment.targets.size());
-        for (auto i = 0; i < colorAttachmentCount; ++i)
-        {
-            // attachment references
-            VkAttachmentReference colorAttachmentReference{};
-            colorAttachmentReference.attachment = i;
-            colorAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-            subpassDescription.colorAttachments.push_back(colorAttachmentReference);
-        }
+    const uint32_t colorAttachmentCount = static_cast<uint32_t>(colorFormats.size());
+    const bool resolve = descriptor.rasterization.sampleCount > 1;
+    const bool depthStencil = depthStencilFormat.has_value();
+    vkdescriptor.subpassDescriptions = generateVulkanSubpassDescriptions(subpasses, colorAttachmentCount, resolve, depthStencil);
+    vkdescriptor.subpassDependencies = generateVulkanSubpassDependencies(subpasses, colorAttachmentCount, depthStencil);
 
-        std::vector<VkAttachmentReference> resolveAttachmentReferences{};
-        if (descriptor.rasterization.sampleCount > 1)
-        {
-            // resolve attachments
-            for (uint32_t i = colorAttachmentCount; i < colorAttachmentCount * 2; ++i)
-            {
-                VkAttachmentReference resolveAttachmentReference{};
-                resolveAttachmentReference.attachment = i;
-                resolveAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    return vkdescriptor;
+}
 
-                subpassDescription.resolveAttachments.push_back(resolveAttachmentReference);
-            }
-        }
+VulkanPipelineRenderingCreateInfo generatePipelineRenderingCreateInfo(const RenderPipelineDescriptor& descriptor)
+{
+    VulkanPipelineRenderingCreateInfo renderingInfo{};
 
-        if (descriptor.depthStencil.has_value())
-        {
-            VkAttachmentReference depthAttachment{};
-            depthAttachment.attachment = static_cast<uint32_t>(subpassDescription.colorAttachments.size() + subpassDescription.resolveAttachments.size());
-            depthAttachment.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    for (const auto& target : descriptor.fragment.targets)
+        renderingInfo.colorAttachmentFormats.push_back(ToVkFormat(target.format));
 
-            subpassDescription.depthStencilAttachment = depthAttachment;
-        }
-        vkdescriptor.subpassDescriptions = { subpassDescription };
-
-        VkSubpassDependency subpassDependency{};
-        subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        subpassDependency.dstSubpass = 0;
-        subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        subpassDependency.srcAccessMask = 0;
-        subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        if (descriptor.depthStencil.has_value())
-            subpassDependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    if (descriptor.depthStencil.has_value())
+    {
+        VkFormat format = ToVkFormat(descriptor.depthStencil.value().format);
+        VkImageAspectFlags aspect = GenerateImageAspectFlags(format);
 
-        vkdescriptor.subpassDependencies = { subpassDependency };
+        if (aspect & VK_IMAGE_ASPECT_DEPTH_BIT)
+            renderingInfo.depthAttachmentFormat = format;
+        if (aspect & VK_IMAGE_ASPECT_STENCIL_BIT)
+            renderingInfo.stencilAttachmentFormat = format;
     }
 
-    return vkdescriptor;
+    return renderingInfo;
 }
 
 VulkanRenderPipelineDescriptor generateVulkanRenderPipelineDescriptor(VulkanDevice& device, const RenderPipelineDescriptor& descriptor)
 {
+    // render pass is not needed if dynamic rendering is supported. subpasses are in a render pass always.
+    const bool dynamicRendering = device.getPhysicalDevice().getVulkanPhysicalDeviceInfo().dynamicRendering && !descriptor.subpass.has_value();
+
     VulkanRenderPipelineDescriptor vkdescriptor{
         .next = nullptr,
         .flags = 0u,
@@ -406,10 +635,11 @@ VulkanRenderPipelineDescriptor generateVulkanRenderPipelineDescriptor(VulkanDevi
         .colorBlendState = generateColorBlendStateCreateInfo(descriptor),
         .dynamicState = generateDynamicStateCreateInfo(descriptor),
         .layout = downcast(descriptor.layout),
-        .renderPass = device.getRenderPass(generateVulkanRenderPassDescriptor(descriptor)),
-        .subpass = 0,
+        .renderPass = dynamicRendering ? nullptr : &device.getRenderPass(generateVulkanRenderPassDescriptor(descriptor)),
+        .subpass = descriptor.subpass.has_value() ? descriptor.subpass.value().index : 0,
         .basePipelineHandle = VK_NULL_HANDLE, // Optional
         .basePipelineIndex = -1,              // Optional
+        .renderingInfo = generatePipelineRenderingCreateInfo(descriptor),
     };
 
     return vkdescriptor;
@@ -430,6 +660,15 @@ VulkanRenderPipeline::VulkanRenderPipeline(VulkanDevice& device, const VulkanRen
 VulkanRenderPipeline::~VulkanRenderPipeline()
 {
     auto& vulkanDevice = downcast(m_device);
+
+    if (m_optimized)
+    {
+        // the link job destroys its result by itself if it is not done yet.
+        std::lock_guard<std::mutex> lock(m_optimized->mutex);
+        m_optimized->destroyed = true;
+        vulkanDevice.vkAPI.DestroyPipeline(vulkanDevice.getVkDevice(), m_optimized->pipeline.exchange(VK_NULL_HANDLE), nullptr);
+    }
+
     vulkanDevice.vkAPI.DestroyPipeline(vulkanDevice.getVkDevice(), m_pipeline, nullptr);
 }
 
@@ -440,38 +679,35 @@ PipelineLayout& VulkanRenderPipeline::getPipelineLayout() const
 
 VkPipeline VulkanRenderPipeline::getVkPipeline() const
 {
-    return m_pipeline;
+    // use the link time optimized pipeline once background linking is done.
+    const VkPipeline optimizedPipeline = m_optimized ? m_optimized->pipeline.load(std::memory_order_acquire) : VK_NULL_HANDLE;
+
+    return optimizedPipeline != VK_NULL_HANDLE ? optimizedPipeline : m_pipeline;
 }
 
 void VulkanRenderPipeline::initialize()
 {
     const auto& descriptor = m_descriptor;
 
-    VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
-    vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputStateCreateInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(descriptor.vertexInputState.vertexBindingDescriptions.size());
-    vertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(descriptor.vertexInputState.vertexAttributeDescriptions.size());
-    vertexInputStateCreateInfo.pVertexBindingDescriptions = descriptor.vertexInputState.vertexBindingDescriptions.data();
-    vertexInputStateCreateInfo.pVertexAttributeDescriptions = descriptor.vertexInputState.vertexAttributeDescriptions.data();
-
-    VkPipelineColorBlendStateCreateInfo colorBlendCreateInfo{};
-    colorBlendCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlendCreateInfo.attachmentCount = static_cast<uint32_t>(descriptor.colorBlendState.attachments.size());
-    colorBlendCreateInfo.pAttachments = descriptor.colorBlendState.attachments.data();
-    colorBlendCreateInfo.logicOpEnable = descriptor.colorBlendState.logicOpEnable;
-    colorBlendCreateInfo.logicOp = descriptor.colorBlendState.logicOp;
-    colorBlendCreateInfo.blendConstants[0] = descriptor.colorBlendState.blendConstants[0];
-    colorBlendCreateInfo.blendConstants[1] = descriptor.colorBlendState.blendConstants[1];
-    colorBlendCreateInfo.blendConstants[2] = descriptor.colorBlendState.blendConstants[2];
-    colorBlendCreateInfo.blendConstants[3] = descriptor.colorBlendState.blendConstants[3];
+    // link pipeline libraries only if it is fast. libraries do not know extension structures chained to the descriptor.
+    const auto& physicalDeviceInfo = downcast(m_device).getPhysicalDevice().getVulkanPhysicalDeviceInfo();
+    if (descriptor.pipelineLibrary &&
+        physicalDeviceInfo.graphicsPipelineLibrary &&
+        physicalDeviceInfo.graphicsPipelineLibraryProperties.graphicsPipelineLibraryFastLinking &&
+        descriptor.next == nullptr)
+    {
+        linkLibraries();
+        return;
+    }
 
-    VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
-    dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicStateCreateInfo.dynamicStateCount = static_cast<uint32_t>(descriptor.dynamicState.dynamicStates.size());
-    dynamicStateCreateInfo.pDynamicStates = descriptor.dynamicState.dynamicStates.data();
+    VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = generateVkPipelineVertexInputStateCreateInfo(descriptor.vertexInputState);
+    VkPipelineColorBlendStateCreateInfo colorBlendCreateInfo = generateVkPipelineColorBlendStateCreateInfo(descriptor.colorBlendState);
+    VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = generateVkPipelineDynamicStateCreateInfo(descriptor.dynamicState);
 
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = descriptor.next;
+    pipelineInfo.flags = descriptor.flags;
     pipelineInfo.stageCount = static_cast<uint32_t>(descriptor.stages.size());
     pipelineInfo.pStages = descriptor.stages.data();
     pipelineInfo.pVertexInputState = &vertexInputStateCreateInfo;
@@ -483,11 +719,24 @@ void VulkanRenderPipeline::initialize()
     pipelineInfo.pColorBlendState = &colorBlendCreateInfo;
     pipelineInfo.pDynamicState = &dynamicStateCreateInfo;
     pipelineInfo.layout = downcast(descriptor.layout).getVkPipelineLayout();
-    pipelineInfo.renderPass = descriptor.renderPass.getVkRenderPass();
     pipelineInfo.subpass = descriptor.subpass;
     pipelineInfo.basePipelineHandle = descriptor.basePipelineHandle;
     pipelineInfo.basePipelineIndex = descriptor.basePipelineIndex;
 
+    VkPipelineRenderingCreateInfo renderingCreateInfo{};
+    if (descriptor.renderPass)
+    {
+        pipelineInfo.renderPass = descriptor.renderPass->getVkRenderPass();
+    }
+    else
+    {
+        renderingCreateInfo = generateVkPipelineRenderingCreateInfo(descriptor.renderingInfo);
+        renderingCreateInfo.pNext = descriptor.next;
+
+        pipelineInfo.pNext = &renderingCreateInfo;
+        pipelineInfo.renderPass = VK_NULL_HANDLE;
+    }
+
     auto& vulkanDevice = downcast(m_device);
     if (vulkanDevice.vkAPI.CreateGraphicsPipelines(vulkanDevice.getVkDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline) != VK_SUCCESS)
     {
@@ -495,6 +744,306 @@ void VulkanRenderPipeline::initialize()
     }
 }
 
+void VulkanRenderPipeline::linkLibraries()
+{
+    auto& vulkanDevice = downcast(m_device);
+    auto& libraryCache = vulkanDevice.getPipelineLibraryCache();
+
+    m_libraries = {
+        libraryCache.getLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, m_descriptor),
+        libraryCache.getLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, m_descriptor),
+        libraryCache.getLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, m_descriptor),
+        libraryCache.getLibrary(VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, m_descriptor),
+    };
+
+    std::array<VkPipeline, 4> libraries{};
+    for (auto i = 0; i < libraries.size(); ++i)
+        libraries[i] = m_libraries[i]->getVkPipeline();
+    const VkPipelineLayout layout = downcast(m_descriptor.layout).getVkPipelineLayout();
+
+    m_pipeline = linkPipelineLibraries(vulkanDevice, libraries, layout, m_descriptor.flags);
+    if (m_pipeline == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("Failed to link graphics pipeline libraries.");
+    }
+
+    if (m_descriptor.optimizeLibraryLink)
+    {
+        const VkPipelineCreateFlags flags = m_descriptor.flags | VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+        m_optimized = std::make_shared<OptimizedPipeline>();
+
+        // the job keeps the libraries alive while it links them, even if the pipeline is destroyed.
+        libraryCache.link([&vulkanDevice, optimized = m_optimized, libraryRefs = m_libraries, libraries, layout, flags]() {
+            {
+                std::lock_guard<std::mutex> lock(optimized->mutex);
+                if (optimized->destroyed)
+                    return;
+            }
+
+            VkPipeline pipeline = linkPipelineLibraries(vulkanDevice, libraries, layout, flags);
+            if (pipeline == VK_NULL_HANDLE)
+            {
+                spdlog::warn("Failed to link optimized graphics pipeline. fast linked pipeline is used.");
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(optimized->mutex);
+            if (optimized->destroyed)
+                vulkanDevice.vkAPI.DestroyPipeline(vulkanDevice.getVkDevice(), pipeline, nullptr);
+            else
+                optimized->pipeline.store(pipeline, std::memory_order_release);
+        });
+    }
+}
+
+// Vulkan Pipeline Library
+VulkanPipelineLibrary::VulkanPipelineLibrary(VulkanDevice& device, VkPipeline library)
+    : m_device(device)
+    , m_library(library)
+{
+}
+
+VulkanPipelineLibrary::~VulkanPipelineLibrary()
+{
+    m_device.vkAPI.DestroyPipeline(m_device.getVkDevice(), m_library, nullptr);
+}
+
+VkPipeline VulkanPipelineLibrary::getVkPipeline() const
+{
+    return m_library;
+}
+
+// Vulkan Pipeline Library Cache
+size_t VulkanPipelineLibraryCache::Functor::operator()(const std::string& key) const
+{
+    return hashBytes(key.data(), key.size());
+}
+
+VulkanPipelineLibraryCache::VulkanPipelineLibraryCache(VulkanDevice& device)
+    : m_device(device)
+{
+}
+
+VulkanPipelineLibraryCache::~VulkanPipelineLibraryCache()
+{
+    clear();
+}
+
+std::shared_ptr<VulkanPipelineLibrary> VulkanPipelineLibraryCache::getLibrary(VkGraphicsPipelineLibraryFlagBitsEXT part, const VulkanRenderPipelineDescriptor& descriptor)
+{
+    std::string key = generatePipelineLibraryKey(part, descriptor);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_cache.find(key);
+    if (it != m_cache.end())
+    {
+        ++m_statistics.hits;
+        return it->second.library;
+    }
+
+    ++m_statistics.misses;
+
+    const auto begin = std::chrono::steady_clock::now();
+    Entry entry{ .library = std::make_shared<VulkanPipelineLibrary>(m_device, createLibrary(part, descriptor)) };
+    m_statistics.creationTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    if (part == VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT || part == VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT)
+    {
+        const VkShaderStageFlagBits stage = part == VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT ? VK_SHADER_STAGE_FRAGMENT_BIT : VK_SHADER_STAGE_VERTEX_BIT;
+        for (const auto& stageCreateInfo : descriptor.stages)
+        {
+            if (stageCreateInfo.stage == stage)
+                entry.shaderModule = stageCreateInfo.module;
+        }
+        entry.pipelineLayout = downcast(descriptor.layout).getVkPipelineLayout();
+    }
+
+    m_cache.emplace(std::move(key), entry);
+
+    return entry.library;
+}
+
+VkPipeline VulkanPipelineLibraryCache::createLibrary(VkGraphicsPipelineLibraryFlagBitsEXT part, const VulkanRenderPipelineDescriptor& descriptor)
+{
+    VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = generateVkPipelineVertexInputStateCreateInfo(descriptor.vertexInputState);
+    VkPipelineColorBlendStateCreateInfo colorBlendCreateInfo = generateVkPipelineColorBlendStateCreateInfo(descriptor.colorBlendState);
+    VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = generateVkPipelineDynamicStateCreateInfo(descriptor.dynamicState);
+    VkPipelineRenderingCreateInfo renderingCreateInfo = generateVkPipelineRenderingCreateInfo(descriptor.renderingInfo);
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo{};
+    libraryCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+    libraryCreateInfo.flags = part;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = &libraryCreateInfo;
+    // retain link time optimization information to relink optimized pipeline.
+    pipelineInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    pipelineInfo.pDynamicState = &dynamicStateCreateInfo;
+    pipelineInfo.basePipelineIndex = -1;
+
+    std::vector<VkPipelineShaderStageCreateInfo> stages{};
+    switch (part)
+    {
+    case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+        pipelineInfo.pVertexInputState = &vertexInputStateCreateInfo;
+        pipelineInfo.pInputAssemblyState = &descriptor.inputAssemblyState;
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+        for (const auto& stage : descriptor.stages)
+        {
+            if (stage.stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+                stages.push_back(stage);
+        }
+        pipelineInfo.pViewportState = &descriptor.viewportState;
+        pipelineInfo.pRasterizationState = &descriptor.rasterizationState;
+        pipelineInfo.layout = downcast(descriptor.layout).getVkPipelineLayout();
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+        for (const auto& stage : descriptor.stages)
+        {
+            if (stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+                stages.push_back(stage);
+        }
+        pipelineInfo.pMultisampleState = &descriptor.multisampleState;
+        pipelineInfo.pDepthStencilState = &descriptor.depthStencilState;
+        pipelineInfo.layout = downcast(descriptor.layout).getVkPipelineLayout();
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+        pipelineInfo.pMultisampleState = &descriptor.multisampleState;
+        pipelineInfo.pColorBlendState = &colorBlendCreateInfo;
+        break;
+    default:
+        throw std::runtime_error(fmt::format("Unknown pipeline library part {}.", static_cast<uint32_t>(part)));
+    }
+    pipelineInfo.stageCount = static_cast<uint32_t>(stages.size());
+    pipelineInfo.pStages = stages.data();
+
+    // vertex input interface does not depend on render targets.
+    if (part != VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT)
+    {
+        if (descriptor.renderPass)
+        {
+            pipelineInfo.renderPass = descriptor.renderPass->getVkRenderPass();
+            pipelineInfo.subpass = descriptor.subpass;
+        }
+        else
+        {
+            libraryCreateInfo.pNext = &renderingCreateInfo;
+        }
+    }
+
+    auto& vulkanDevice = downcast(m_device);
+
+    VkPipeline library = VK_NULL_HANDLE;
+    if (vulkanDevice.vkAPI.CreateGraphicsPipelines(vulkanDevice.getVkDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &library) != VK_SUCCESS)
+    {
+        throw std::runtime_error(fmt::format("Failed to create graphics pipeline library {}.", static_cast<uint32_t>(part)));
+    }
+
+    return library;
+}
+
+void VulkanPipelineLibraryCache::link(std::function<void()> job)
+{
+    std::lock_guard<std::mutex> lock(m_jobMutex);
+
+    // linking is heavy, so workers are fewer than the cores to leave room for rendering.
+    if (m_workers.empty())
+    {
+        m_stop = false;
+
+        const uint32_t workerCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+        for (uint32_t i = 0; i < workerCount; ++i)
+            m_workers.emplace_back(&VulkanPipelineLibraryCache::work, this);
+    }
+
+    m_jobs.push_back(std::move(job));
+    m_jobCondition.notify_one();
+}
+
+void VulkanPipelineLibraryCache::work()
+{
+    while (true)
+    {
+        std::function<void()> job{};
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobCondition.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+            if (m_stop)
+                return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job();
+    }
+}
+
+void VulkanPipelineLibraryCache::invalidateShaderModule(VkShaderModule shaderModule)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::erase_if(m_cache, [&](const auto& item) {
+        if (item.second.shaderModule != shaderModule)
+            return false;
+
+        ++m_statistics.evictions;
+        return true;
+    });
+}
+
+void VulkanPipelineLibraryCache::invalidatePipelineLayout(VkPipelineLayout pipelineLayout)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::erase_if(m_cache, [&](const auto& item) {
+        if (item.second.pipelineLayout != pipelineLayout)
+            return false;
+
+        ++m_statistics.evictions;
+        return true;
+    });
+}
+
+void VulkanPipelineLibraryCache::clear()
+{
+    std::vector<std::thread> workers{};
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_stop = true;
+        m_jobs.clear();
+        workers = std::move(m_workers);
+        m_workers.clear();
+    }
+
+    m_jobCondition.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cache.clear();
+}
+
+CacheStatistics VulkanPipelineLibraryCache::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    CacheStatistics statistics = m_statistics;
+    statistics.entries = m_cache.size();
+
+    return statistics;
+}
+
+void VulkanPipelineLibraryCache::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_statistics = CacheStatistics{ .name = m_statistics.name };
+}
+
 VkFormat ToVkVertexFormat(VertexFormat format)
 {
     switch (format)
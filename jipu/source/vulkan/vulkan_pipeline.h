@@ -1,5 +1,6 @@
 #pragma once
 
+#include "jipu/device.h"
 #include "jipu/pipeline.h"
 #include "utils/cast.h"
 #include "vulkan_api.h"
@@ -7,7 +8,16 @@
 #include "vulkan_render_pass.h"
 #include "vulkan_shader_module.h"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace jipu
@@ -15,7 +25,7 @@ namespace jipu
 
 class VulkanDevice;
 class VulkanPipelineLayout;
-class VULKAN_EXPORT VulkanComputePipeline : public ComputePipeline
+class VULKAN_EXPORT VulkanComputePipeline final : public ComputePipeline
 {
 public:
     VulkanComputePipeline() = delete;
@@ -74,6 +84,14 @@ struct VulkanPipelineDynamicStateCreateInfo
     std::vector<VkDynamicState> dynamicStates{};
 };
 
+struct VulkanPipelineRenderingCreateInfo
+{
+    uint32_t viewMask = 0u;
+    std::vector<VkFormat> colorAttachmentFormats{};
+    VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+    VkFormat stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+};
+
 struct VulkanRenderPipelineDescriptor
 {
     const void* next = nullptr;
@@ -89,14 +107,36 @@ struct VulkanRenderPipelineDescriptor
     VulkanPipelineColorBlendStateCreateInfo colorBlendState{};
     VulkanPipelineDynamicStateCreateInfo dynamicState{};
     VulkanPipelineLayout& layout;
-    VulkanRenderPass& renderPass;
+    VulkanRenderPass* renderPass = nullptr; // use dynamic rendering with renderingInfo if nullptr.
     uint32_t subpass = 0;
     VkPipeline basePipelineHandle = VK_NULL_HANDLE;
     int32_t basePipelineIndex = -1;
+    VulkanPipelineRenderingCreateInfo renderingInfo{};
+    bool pipelineLibrary = true;     // link from cached pipeline libraries if fast linking is supported.
+    bool optimizeLibraryLink = true; // relink with link time optimization in background if linked from pipeline libraries.
+};
+
+/// @brief a pipeline library is destroyed when it is removed from the cache and all pipelines linked with it are destroyed.
+class VULKAN_EXPORT VulkanPipelineLibrary final
+{
+public:
+    VulkanPipelineLibrary() = delete;
+    VulkanPipelineLibrary(VulkanDevice& device, VkPipeline library);
+    ~VulkanPipelineLibrary();
+
+    VulkanPipelineLibrary(const VulkanPipelineLibrary&) = delete;
+    VulkanPipelineLibrary& operator=(const VulkanPipelineLibrary&) = delete;
+
+public:
+    VkPipeline getVkPipeline() const;
+
+private:
+    VulkanDevice& m_device;
+    VkPipeline m_library = VK_NULL_HANDLE;
 };
 
 class VulkanRenderPass;
-class VULKAN_EXPORT VulkanRenderPipeline : public RenderPipeline
+class VULKAN_EXPORT VulkanRenderPipeline final : public RenderPipeline
 {
 public:
     VulkanRenderPipeline() = delete;
@@ -115,6 +155,7 @@ public:
 
 private:
     void initialize();
+    void linkLibraries();
 
 private:
     VulkanDevice& m_device;
@@ -123,11 +164,79 @@ private:
 private:
     VkPipeline m_pipeline = VK_NULL_HANDLE;
 
+    // libraries which the pipeline is linked with.
+    std::array<std::shared_ptr<VulkanPipelineLibrary>, 4> m_libraries{};
+
+    /// @brief link time optimized pipeline. it replaces the fast linked pipeline when background linking is done.
+    /// it is shared with the link job, which destroys its result if the pipeline is destroyed first.
+    struct OptimizedPipeline
+    {
+        std::mutex mutex{};
+        std::atomic<VkPipeline> pipeline = VK_NULL_HANDLE;
+        bool destroyed = false;
+    };
+    std::shared_ptr<OptimizedPipeline> m_optimized = nullptr;
+
 public:
     using Ref = std::reference_wrapper<VulkanRenderPipeline>;
 };
 DOWN_CAST(VulkanRenderPipeline, RenderPipeline);
 
+class VULKAN_EXPORT VulkanPipelineLibraryCache final
+{
+public:
+    VulkanPipelineLibraryCache(VulkanDevice& device);
+    ~VulkanPipelineLibraryCache();
+
+    /// @brief get the pipeline library which has only the state of the part. it is compiled at first use.
+    std::shared_ptr<VulkanPipelineLibrary> getLibrary(VkGraphicsPipelineLibraryFlagBitsEXT part, const VulkanRenderPipelineDescriptor& descriptor);
+
+    /// @brief run the link job on a background worker. workers are bounded, and jobs wait in order.
+    void link(std::function<void()> job);
+
+    /// @brief remove all libraries which are compiled with the shader module or the pipeline layout.
+    /// they are destroyed when pipelines linked with them are destroyed.
+    void invalidateShaderModule(VkShaderModule shaderModule);
+    void invalidatePipelineLayout(VkPipelineLayout pipelineLayout);
+    /// @brief remove all libraries, and stop workers after running jobs are done. waiting jobs are dropped.
+    void clear();
+
+    CacheStatistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    VkPipeline createLibrary(VkGraphicsPipelineLibraryFlagBitsEXT part, const VulkanRenderPipelineDescriptor& descriptor);
+    void work();
+
+private:
+    VulkanDevice& m_device;
+    CacheStatistics m_statistics{ .name = "Pipeline Library" };
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<VulkanPipelineLibrary> library = nullptr;
+        VkShaderModule shaderModule = VK_NULL_HANDLE;
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    };
+    struct Functor
+    {
+        size_t operator()(const std::string& key) const;
+    };
+    using Cache = std::unordered_map<std::string, Entry, Functor>;
+
+    // pipelines can be created on several threads.
+    mutable std::mutex m_mutex{};
+    Cache m_cache{};
+
+private:
+    std::mutex m_jobMutex{};
+    std::condition_variable m_jobCondition{};
+    std::deque<std::function<void()>> m_jobs{};
+    std::vector<std::thread> m_workers{};
+    bool m_stop = false;
+};
+
 // Generate Helper
 std::vector<VkVertexInputBindingDescription> VULKAN_EXPORT generateVertexInputBindingDescription(const RenderPipelineDescriptor& descriptor);
 std::vector<VkVertexInputAttributeDescription> VULKAN_EXPORT generateVertexInputAttributeDescription(const RenderPipelineDescriptor& descriptor);
@@ -140,6 +249,7 @@ VkPipelineMultisampleStateCreateInfo VULKAN_EXPORT generateMultisampleStateCreat
 VulkanPipelineColorBlendStateCreateInfo VULKAN_EXPORT generateColorBlendStateCreateInfo(const RenderPipelineDescriptor& descriptor);
 VkPipelineDepthStencilStateCreateInfo VULKAN_EXPORT generateDepthStencilStateCreateInfo(const RenderPipelineDescriptor& descriptor);
 VulkanPipelineDynamicStateCreateInfo VULKAN_EXPORT generateDynamicStateCreateInfo(const RenderPipelineDescriptor& descriptor);
+VulkanPipelineRenderingCreateInfo VULKAN_EXPORT generatePipelineRenderingCreateInfo(const RenderPipelineDescriptor& descriptor);
 std::vector<VkPipelineShaderStageCreateInfo> VULKAN_EXPORT generateShaderStageCreateInfo(const RenderPipelineDescriptor& descriptor);
 VulkanRenderPipelineDescriptor VULKAN_EXPORT generateVulkanRenderPipelineDescriptor(VulkanDevice& device, const RenderPipelineDescriptor& descriptor);
 
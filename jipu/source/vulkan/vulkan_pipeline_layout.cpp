@@ -2,6 +2,7 @@
 #include "vulkan_binding_group_layout.h"
 #include "vulkan_device.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace jipu
@@ -17,20 +18,36 @@ VulkanPipelineLayout::VulkanPipelineLayout(VulkanDevice& device, const PipelineL
         layouts[i] = downcast(descriptor.layouts[i]).getVkDescriptorSetLayout();
     }
 
+    std::vector<VkPushConstantRange> pushConstantRanges{};
+    pushConstantRanges.resize(descriptor.pushConstantRanges.size());
+    for (uint32_t i = 0; i < descriptor.pushConstantRanges.size(); ++i)
+    {
+        const auto& range = descriptor.pushConstantRanges[i];
+        pushConstantRanges[i] = { .stageFlags = ToVkShaderStageFlags(range.stages),
+                                  .offset = range.offset,
+                                  .size = range.size };
+    }
+
     VkPipelineLayoutCreateInfo createInfo{ .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
                                            .setLayoutCount = static_cast<uint32_t>(layouts.size()),
-                                           .pSetLayouts = layouts.data() };
+                                           .pSetLayouts = layouts.data(),
+                                           .pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+                                           .pPushConstantRanges = pushConstantRanges.data() };
 
     VkResult result = device.vkAPI.CreatePipelineLayout(device.getVkDevice(), &createInfo, nullptr, &m_pipelineLayout);
     if (result != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create VkPipelineLayout");
     }
+
+    m_descriptorSetLayouts = std::move(layouts);
+    m_pushConstantRanges = std::move(pushConstantRanges);
 }
 
 VulkanPipelineLayout::~VulkanPipelineLayout()
 {
     auto& vulkanDevice = downcast(m_device);
+    vulkanDevice.getPipelineLibraryCache().invalidatePipelineLayout(m_pipelineLayout);
     vulkanDevice.vkAPI.DestroyPipelineLayout(vulkanDevice.getVkDevice(), m_pipelineLayout, nullptr);
 }
 
@@ -39,4 +56,31 @@ VkPipelineLayout VulkanPipelineLayout::getVkPipelineLayout() const
     return m_pipelineLayout;
 }
 
+uint32_t VulkanPipelineLayout::getDescriptorSetLayoutCount() const
+{
+    return static_cast<uint32_t>(m_descriptorSetLayouts.size());
+}
+
+uint32_t VulkanPipelineLayout::getCompatibleSetCount(const VulkanPipelineLayout& other) const
+{
+    if (this == &other)
+        return static_cast<uint32_t>(m_descriptorSetLayouts.size());
+
+    const bool samePushConstantRanges = m_pushConstantRanges.size() == other.m_pushConstantRanges.size() &&
+                                        std::equal(m_pushConstantRanges.begin(), m_pushConstantRanges.end(), other.m_pushConstantRanges.begin(),
+                                                   [](const VkPushConstantRange& lhs, const VkPushConstantRange& rhs) {
+                                                       return lhs.stageFlags == rhs.stageFlags && lhs.offset == rhs.offset && lhs.size == rhs.size;
+                                                   });
+    if (!samePushConstantRanges)
+        return 0;
+
+    // identically defined set layouts are also compatible, but only same handles are checked.
+    const auto count = std::min(m_descriptorSetLayouts.size(), other.m_descriptorSetLayouts.size());
+    uint32_t index = 0;
+    while (index < count && m_descriptorSetLayouts[index] == other.m_descriptorSetLayouts[index])
+        ++index;
+
+    return index;
+}
+
 } // namespace jipu
\ No newline at end of file
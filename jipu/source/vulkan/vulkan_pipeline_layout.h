@@ -5,11 +5,13 @@
 #include "vulkan_api.h"
 #include "vulkan_export.h"
 
+#include <vector>
+
 namespace jipu
 {
 
 class VulkanDevice;
-class VULKAN_EXPORT VulkanPipelineLayout : public PipelineLayout
+class VULKAN_EXPORT VulkanPipelineLayout final : public PipelineLayout
 {
 public:
     VulkanPipelineLayout() = delete;
@@ -18,12 +20,18 @@ public:
 
 public:
     VkPipelineLayout getVkPipelineLayout() const;
+    uint32_t getDescriptorSetLayoutCount() const;
+
+    /// @brief the number of leading sets for which two layouts are compatible. 0 if push constant ranges are different.
+    uint32_t getCompatibleSetCount(const VulkanPipelineLayout& other) const;
 
 private:
     VulkanDevice& m_device;
 
 private:
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSetLayout> m_descriptorSetLayouts{};
+    std::vector<VkPushConstantRange> m_pushConstantRanges{};
 };
 
 DOWN_CAST(VulkanPipelineLayout, PipelineLayout);
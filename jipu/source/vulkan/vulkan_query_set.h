@@ -9,7 +9,7 @@ namespace jipu
 {
 
 class VulkanDevice;
-class VULKAN_EXPORT VulkanQuerySet : public QuerySet
+class VULKAN_EXPORT VulkanQuerySet final : public QuerySet
 {
 public:
     VulkanQuerySet() = delete;
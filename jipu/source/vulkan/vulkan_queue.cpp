@@ -1,7 +1,11 @@
 #include "vulkan_queue.h"
+#include "vulkan_command_buffer.h"
+#include "vulkan_command_recorder.h"
 #include "vulkan_device.h"
 #include "vulkan_physical_device.h"
 #include "vulkan_swapchain.h"
+#include "vulkan_texture.h"
+#include "vulkan_upload_manager.h"
 
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
@@ -65,7 +69,18 @@ VulkanQueue::~VulkanQueue()
     const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
 
     // wait idle state before destroy semaphore.
-    vkAPI.QueueWaitIdle(m_queue);
+    {
+        std::lock_guard<std::mutex> lock(vulkanDevice.getQueueMutex());
+        vkAPI.QueueWaitIdle(m_queue);
+    }
+
+    if (!m_barrierCommandBuffers.empty())
+    {
+        vkAPI.FreeCommandBuffers(vulkanDevice.getVkDevice(),
+                                 vulkanDevice.getVkCommandPool(),
+                                 static_cast<uint32_t>(m_barrierCommandBuffers.size()),
+                                 m_barrierCommandBuffers.data());
+    }
 
     vkAPI.DestroyFence(vulkanDevice.getVkDevice(), m_fence, nullptr);
     vkAPI.DestroySemaphore(vulkanDevice.getVkDevice(), m_semaphore, nullptr);
@@ -74,25 +89,53 @@ VulkanQueue::~VulkanQueue()
 }
 
 void VulkanQueue::submit(std::vector<CommandBuffer::Ref> commandBuffers)
+{
+    submit(std::span<const CommandBuffer::Ref>(commandBuffers));
+}
+
+void VulkanQueue::submit(std::vector<CommandBuffer::Ref> commandBuffers, Swapchain& swapchain)
+{
+    submit(std::span<const CommandBuffer::Ref>(commandBuffers), swapchain);
+}
+
+void VulkanQueue::submit(std::span<const CommandBuffer::Ref> commandBuffers)
 {
     std::vector<SubmitInfo> submits = gatherSubmitInfo(commandBuffers);
 
+    // don't create the upload manager for applications which never upload.
+    auto* uploadManager = m_device.hasUploadManager() ? &downcast(m_device.getUploadManager()) : nullptr;
+    VulkanUploadAcquire acquire{};
+    if (uploadManager)
+    {
+        acquire = uploadManager->acquire(m_index);
+        addUploadAcquire(submits, acquire);
+    }
+
     submit(submits);
+    if (uploadManager)
+        uploadManager->releaseAcquire(acquire);
 }
 
-void VulkanQueue::submit(std::vector<CommandBuffer::Ref> commandBuffers, Swapchain& swapchain)
+void VulkanQueue::submit(std::span<const CommandBuffer::Ref> commandBuffers, Swapchain& swapchain)
 {
     std::vector<SubmitInfo> submits = gatherSubmitInfo(commandBuffers);
 
+    auto* uploadManager = m_device.hasUploadManager() ? &downcast(m_device.getUploadManager()) : nullptr;
+    VulkanUploadAcquire acquire{};
+    if (uploadManager)
+    {
+        acquire = uploadManager->acquire(m_index);
+        addUploadAcquire(submits, acquire);
+    }
+
     auto& vulkanDevice = downcast(m_device);
     auto& vulkanSwapchain = downcast(swapchain);
     const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
 
-    auto commandBufferCount = commandBuffers.size();
+    auto commandBufferCount = submits.size();
     // we assume the last command buffer is for rendering.
     auto renderCommandBufferIndex = commandBufferCount - 1;
 
-    auto& renderCommandBuffer = downcast(commandBuffers[renderCommandBufferIndex]);
     auto acquireImageSemaphore = vulkanSwapchain.getPresentSemaphore();
 
     // add signal semaphore to signal that render command buffer is finished.
@@ -103,10 +146,27 @@ void VulkanQueue::submit(std::vector<CommandBuffer::Ref> commandBuffers, Swapcha
     submits[renderCommandBufferIndex].wait.second.push_back(acquireImageSemaphore.second);
 
     submit(submits);
+    if (uploadManager)
+        uploadManager->releaseAcquire(acquire);
 
     swapchain.present(*this);
 }
 
+void VulkanQueue::writeBuffer(Buffer& buffer, uint64_t offset, const void* data, uint64_t size)
+{
+    // uploads are flushed and acquired by the next submit.
+    m_device.getUploadManager().uploadBuffer(buffer, offset, data, size);
+}
+
+void VulkanQueue::writeTexture(const BlitTexture& texture,
+                               const void* data,
+                               uint64_t size,
+                               const TextureDataLayout& layout,
+                               const Extent3D& extent)
+{
+    m_device.getUploadManager().uploadTexture(texture, data, size, layout, extent);
+}
+
 VkQueue VulkanQueue::getVkQueue() const
 {
     return m_queue;
@@ -117,7 +177,7 @@ std::vector<VkSemaphore> VulkanQueue::getSemaphores() const
     return { m_semaphore };
 }
 
-std::vector<VulkanQueue::SubmitInfo> VulkanQueue::gatherSubmitInfo(std::vector<CommandBuffer::Ref> commandBuffers)
+std::vector<VulkanQueue::SubmitInfo> VulkanQueue::gatherSubmitInfo(std::span<const CommandBuffer::Ref> commandBuffers)
 {
     auto& vulkanDevice = downcast(m_device);
     const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
@@ -130,6 +190,7 @@ std::vector<VulkanQueue::SubmitInfo> VulkanQueue::gatherSubmitInfo(std::vector<C
     for (auto i = 0; i < commandBufferSize; ++i)
     {
         submitInfo[i].cmdBuf = downcast(commandBuffers[i]).getVkCommandBuffer();
+        submitInfo[i].commandBuffer = &downcast(commandBuffers[i].get());
 
         auto nextIndex = i + 1;
         if (nextIndex < commandBufferSize)
@@ -157,36 +218,138 @@ std::vector<VulkanQueue::SubmitInfo> VulkanQueue::gatherSubmitInfo(std::vector<C
     return submitInfo;
 }
 
-void VulkanQueue::submit(const std::vector<SubmitInfo>& submits)
+void VulkanQueue::addUploadAcquire(std::vector<SubmitInfo>& submits, const VulkanUploadAcquire& acquire)
+{
+    if (acquire.commandBuffers.empty())
+        return;
+
+    // acquires are submitted before the command buffers, after the uploads are completed by the transfer queue.
+    std::vector<SubmitInfo> acquireSubmits(acquire.commandBuffers.size());
+    for (auto i = 0; i < acquire.commandBuffers.size(); ++i)
+        acquireSubmits[i].cmdBuf = acquire.commandBuffers[i];
+
+    for (auto semaphore : acquire.semaphores)
+    {
+        acquireSubmits[0].wait.first.push_back(semaphore);
+        acquireSubmits[0].wait.second.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    }
+
+    submits.insert(submits.begin(), acquireSubmits.begin(), acquireSubmits.end());
+}
+
+std::vector<VulkanQueue::SubmitInfo> VulkanQueue::addBufferBarriers(const std::vector<SubmitInfo>& submits)
 {
     auto& vulkanDevice = downcast(m_device);
     const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
+    auto& submittedBufferTracker = vulkanDevice.getSubmittedBufferTracker();
 
-    auto submitInfoSize = submits.size();
+    std::vector<SubmitInfo> resolvedSubmits{};
+    resolvedSubmits.reserve(submits.size());
 
-    std::vector<VkSubmitInfo> submitInfos{};
-    submitInfos.resize(submitInfoSize);
-
-    for (auto i = 0; i < submitInfoSize; ++i)
+    uint32_t barrierCommandBufferCount = 0;
+    for (const auto& submit : submits)
     {
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &submits[i].cmdBuf;
+        if (submit.commandBuffer)
+        {
+            const auto& barriers = submittedBufferTracker.submit(submit.commandBuffer->getBufferTracker());
+            if (!barriers.empty())
+            {
+                // the barriers are executed after previous submissions and before the command buffer in submission order.
+                VkCommandBuffer commandBuffer = getBarrierCommandBuffer(barrierCommandBufferCount++);
 
-        submitInfo.signalSemaphoreCount = static_cast<uint32_t>(submits[i].signal.first.size());
-        submitInfo.pSignalSemaphores = submits[i].signal.first.data();
+                VkCommandBufferBeginInfo beginInfo{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+                beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                if (vkAPI.BeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+                    throw std::runtime_error("Failed to begin command buffer for buffer barriers.");
 
-        submitInfo.pWaitSemaphores = submits[i].wait.first.data();
-        submitInfo.pWaitDstStageMask = submits[i].wait.second.data();
-        submitInfo.waitSemaphoreCount = static_cast<uint32_t>(submits[i].wait.first.size());
+                VulkanCommandRecorder recorder(vkAPI, commandBuffer);
+                submittedBufferTracker.record(recorder, barriers);
 
-        submitInfos[i] = submitInfo;
+                if (vkAPI.EndCommandBuffer(commandBuffer) != VK_SUCCESS)
+                    throw std::runtime_error("Failed to end command buffer for buffer barriers.");
+
+                resolvedSubmits.push_back({ .cmdBuf = commandBuffer });
+            }
+        }
+
+        resolvedSubmits.push_back(submit);
     }
 
-    VkResult result = vkAPI.QueueSubmit(m_queue, static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), m_fence);
+    return resolvedSubmits;
+}
+
+VkCommandBuffer VulkanQueue::getBarrierCommandBuffer(uint32_t index)
+{
+    if (index < m_barrierCommandBuffers.size())
+        return m_barrierCommandBuffers[index];
+
+    auto& vulkanDevice = downcast(m_device);
+
+    // the command pool allows to reset command buffers, so they are reset when they begin.
+    VkCommandBufferAllocateInfo allocateInfo{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocateInfo.commandPool = vulkanDevice.getVkCommandPool();
+    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocateInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    if (vulkanDevice.vkAPI.AllocateCommandBuffers(vulkanDevice.getVkDevice(), &allocateInfo, &commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate command buffer for buffer barriers.");
+
+    m_barrierCommandBuffers.push_back(commandBuffer);
+
+    return commandBuffer;
+}
+
+void VulkanQueue::submit(const std::vector<SubmitInfo>& submits)
+{
+    auto& vulkanDevice = downcast(m_device);
+    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
+
+    const uint64_t serial = vulkanDevice.beginSubmit();
+
+    VkResult result = VK_SUCCESS;
+    {
+        // the upload manager submits to the same queues.
+        std::lock_guard<std::mutex> lock(vulkanDevice.getQueueMutex());
+
+        const auto resolvedSubmits = addBufferBarriers(submits);
+        const auto submitInfoSize = resolvedSubmits.size();
+
+        std::vector<VkSubmitInfo> submitInfos{};
+        submitInfos.resize(submitInfoSize);
+
+        for (auto i = 0; i < submitInfoSize; ++i)
+        {
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &resolvedSubmits[i].cmdBuf;
+
+            submitInfo.signalSemaphoreCount = static_cast<uint32_t>(resolvedSubmits[i].signal.first.size());
+            submitInfo.pSignalSemaphores = resolvedSubmits[i].signal.first.data();
+
+            submitInfo.pWaitSemaphores = resolvedSubmits[i].wait.first.data();
+            submitInfo.pWaitDstStageMask = resolvedSubmits[i].wait.second.data();
+            submitInfo.waitSemaphoreCount = static_cast<uint32_t>(resolvedSubmits[i].wait.first.size());
+
+            submitInfos[i] = submitInfo;
+        }
+
+        result = vkAPI.QueueSubmit(m_queue, static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), m_fence);
+
+        // uploads after the submission are executed after the command buffers.
+        for (const auto& submitInfo : submits)
+        {
+            if (submitInfo.commandBuffer)
+            {
+                for (auto texture : submitInfo.commandBuffer->ejectTextures())
+                    texture->markSubmitted();
+            }
+        }
+    }
     if (result != VK_SUCCESS)
     {
+        vulkanDevice.endSubmit(serial);
         throw std::runtime_error(fmt::format("failed to submit command buffer {}", static_cast<uint32_t>(result)));
     }
 
@@ -196,6 +359,8 @@ void VulkanQueue::submit(const std::vector<SubmitInfo>& submits)
         throw std::runtime_error(fmt::format("failed to wait for fences {}", static_cast<uint32_t>(result)));
     }
 
+    vulkanDevice.endSubmit(serial);
+
     result = vkAPI.ResetFences(vulkanDevice.getVkDevice(), 1, &m_fence);
     if (result != VK_SUCCESS)
     {
@@ -5,11 +5,15 @@
 #include "vulkan_api.h"
 #include "vulkan_export.h"
 
+#include <vector>
+
 namespace jipu
 {
 
 class VulkanDevice;
-class VULKAN_EXPORT VulkanQueue : public Queue
+class VulkanCommandBuffer;
+struct VulkanUploadAcquire;
+class VULKAN_EXPORT VulkanQueue final : public Queue
 {
 public:
     VulkanQueue() = delete;
@@ -18,6 +22,15 @@ public:
 
     void submit(std::vector<CommandBuffer::Ref> commandBuffers) override;
     void submit(std::vector<CommandBuffer::Ref> commandBuffers, Swapchain& swapchain) override;
+    void submit(std::span<const CommandBuffer::Ref> commandBuffers) override;
+    void submit(std::span<const CommandBuffer::Ref> commandBuffers, Swapchain& swapchain) override;
+
+    void writeBuffer(Buffer& buffer, uint64_t offset, const void* data, uint64_t size) override;
+    void writeTexture(const BlitTexture& texture,
+                      const void* data,
+                      uint64_t size,
+                      const TextureDataLayout& layout,
+                      const Extent3D& extent) override;
 
 public:
     VkQueue getVkQueue() const;
@@ -39,13 +52,24 @@ private:
     struct SubmitInfo
     {
         VkCommandBuffer cmdBuf = VK_NULL_HANDLE;
+        // null for command buffers which are recorded by the queue or the upload manager.
+        VulkanCommandBuffer* commandBuffer = nullptr;
         std::pair<std::vector<VkSemaphore>, std::vector<VkPipelineStageFlags>> signal{};
         std::pair<std::vector<VkSemaphore>, std::vector<VkPipelineStageFlags>> wait{};
 
     } m_submitInfo;
 
-    std::vector<SubmitInfo> gatherSubmitInfo(std::vector<CommandBuffer::Ref> commandBuffers);
+    std::vector<SubmitInfo> gatherSubmitInfo(std::span<const CommandBuffer::Ref> commandBuffers);
+    /// @brief put the acquires of uploads in front of the submits.
+    void addUploadAcquire(std::vector<SubmitInfo>& submits, const VulkanUploadAcquire& acquire);
+    /// @brief put the barriers for buffers written by previous submissions in front of the command buffers which access them.
+    /// it must be called under the queue mutex, so the submitted states of buffers are in submission order.
+    std::vector<SubmitInfo> addBufferBarriers(const std::vector<SubmitInfo>& submits);
+    VkCommandBuffer getBarrierCommandBuffer(uint32_t index);
     void submit(const std::vector<SubmitInfo>& submitInfos);
+
+    // command buffers for barriers resolved at submission. submit waits for completion, so they are recorded again by next submit.
+    std::vector<VkCommandBuffer> m_barrierCommandBuffers{};
 };
 
 DOWN_CAST(VulkanQueue, Queue);
@@ -3,12 +3,42 @@
 #include "vulkan_device.h"
 #include "vulkan_texture.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 
 namespace jipu
 {
 
+namespace
+{
+
+std::vector<SubpassDescriptor> generateSubpasses(const std::vector<SubpassDescriptor>& subpasses, uint32_t colorAttachmentCount)
+{
+    if (!subpasses.empty())
+        return subpasses;
+
+    SubpassDescriptor subpass{};
+    for (uint32_t i = 0; i < colorAttachmentCount; ++i)
+        subpass.colorAttachments.push_back(i);
+
+    return { subpass };
+}
+
+bool contains(const std::vector<uint32_t>& attachments, uint32_t attachment)
+{
+    return std::find(attachments.begin(), attachments.end(), attachment) != attachments.end();
+}
+
+bool uses(const SubpassDescriptor& subpass, uint32_t attachment)
+{
+    return contains(subpass.colorAttachments, attachment) || contains(subpass.inputAttachments, attachment);
+}
+
+} // namespace
+
 VulkanRenderPass::VulkanRenderPass(VulkanDevice& device, const VulkanRenderPassDescriptor& descriptor)
     : m_device(device)
 {
@@ -64,95 +94,55 @@ VkRenderPass VulkanRenderPass::getVkRenderPass() const
 
 size_t VulkanRenderPassCache::Functor::operator()(const VulkanRenderPassDescriptor& descriptor) const
 {
-    size_t hash = 0;
-
-    combineHash(hash, descriptor.flags);
-
-    for (auto attachment : descriptor.attachmentDescriptions)
-    {
-        combineHash(hash, attachment.finalLayout);
-        combineHash(hash, attachment.flags);
-        combineHash(hash, attachment.format);
-        combineHash(hash, attachment.initialLayout);
-        combineHash(hash, attachment.loadOp);
-        combineHash(hash, attachment.samples);
-        combineHash(hash, attachment.stencilLoadOp);
-        combineHash(hash, attachment.stencilStoreOp);
-        combineHash(hash, attachment.storeOp);
-    }
-
-    for (auto subpass : descriptor.subpassDescriptions)
-    {
-        combineHash(hash, subpass.flags);
-        combineHash(hash, subpass.colorAttachments.size());
-        combineHash(hash, subpass.inputAttachments.size());
-        combineHash(hash, subpass.resolveAttachments.size());
-        combineHash(hash, subpass.preserveAttachments.size());
-        combineHash(hash, subpass.depthStencilAttachment.has_value());
-    }
+    // vulkan structures are packed 32 bit fields, so hash them by their bytes.
+    uint64_t hash = hashPod(descriptor.flags);
 
-    for (auto subpass : descriptor.subpassDependencies)
+    hash = hashRange(descriptor.attachmentDescriptions, hash);
+    for (const auto& subpass : descriptor.subpassDescriptions)
     {
-        combineHash(hash, subpass.dependencyFlags);
-        combineHash(hash, subpass.dstAccessMask);
-        combineHash(hash, subpass.dstStageMask);
-        combineHash(hash, subpass.dstSubpass);
-        combineHash(hash, subpass.srcAccessMask);
-        combineHash(hash, subpass.srcStageMask);
-        combineHash(hash, subpass.srcSubpass);
+        hash = hashPod(subpass.flags, hash);
+        hash = hashPod(subpass.pipelineBindPoint, hash);
+        hash = hashRange(subpass.inputAttachments, hash);
+        hash = hashRange(subpass.colorAttachments, hash);
+        hash = hashRange(subpass.resolveAttachments, hash);
+        hash = hashRange(subpass.preserveAttachments, hash);
+        if (subpass.depthStencilAttachment.has_value())
+            hash = hashPod(subpass.depthStencilAttachment.value(), hash);
     }
+    hash = hashRange(descriptor.subpassDependencies, hash);
 
-    return hash;
+    return static_cast<size_t>(hash);
 }
 
 bool VulkanRenderPassCache::Functor::operator()(const VulkanRenderPassDescriptor& lhs,
                                                 const VulkanRenderPassDescriptor& rhs) const
 {
-    if (lhs.attachmentDescriptions.size() != rhs.attachmentDescriptions.size() ||
+    if (lhs.flags != rhs.flags ||
         lhs.subpassDescriptions.size() != rhs.subpassDescriptions.size() ||
-        lhs.subpassDependencies.size() != rhs.subpassDependencies.size())
+        !equalRange(lhs.attachmentDescriptions, rhs.attachmentDescriptions) ||
+        !equalRange(lhs.subpassDependencies, rhs.subpassDependencies))
     {
         return false;
     }
 
-    for (auto i = 0; i < lhs.attachmentDescriptions.size(); ++i)
-    {
-        if (lhs.attachmentDescriptions[i].finalLayout != rhs.attachmentDescriptions[i].finalLayout ||
-            lhs.attachmentDescriptions[i].flags != rhs.attachmentDescriptions[i].flags ||
-            lhs.attachmentDescriptions[i].format != rhs.attachmentDescriptions[i].format ||
-            lhs.attachmentDescriptions[i].initialLayout != rhs.attachmentDescriptions[i].initialLayout ||
-            lhs.attachmentDescriptions[i].loadOp != rhs.attachmentDescriptions[i].loadOp ||
-            lhs.attachmentDescriptions[i].samples != rhs.attachmentDescriptions[i].samples ||
-            lhs.attachmentDescriptions[i].stencilLoadOp != rhs.attachmentDescriptions[i].stencilLoadOp ||
-            lhs.attachmentDescriptions[i].stencilStoreOp != rhs.attachmentDescriptions[i].stencilStoreOp ||
-            lhs.attachmentDescriptions[i].storeOp != rhs.attachmentDescriptions[i].storeOp)
-        {
-            return false;
-        }
-    }
-
     for (auto i = 0; i < lhs.subpassDescriptions.size(); ++i)
     {
-        if (lhs.subpassDescriptions[i].flags != rhs.subpassDescriptions[i].flags ||
-            lhs.subpassDescriptions[i].colorAttachments.size() != rhs.subpassDescriptions[i].colorAttachments.size() ||
-            lhs.subpassDescriptions[i].inputAttachments.size() != rhs.subpassDescriptions[i].inputAttachments.size() ||
-            lhs.subpassDescriptions[i].resolveAttachments.size() != rhs.subpassDescriptions[i].resolveAttachments.size() ||
-            lhs.subpassDescriptions[i].preserveAttachments.size() != rhs.subpassDescriptions[i].preserveAttachments.size() ||
-            lhs.subpassDescriptions[i].depthStencilAttachment.has_value() != rhs.subpassDescriptions[i].depthStencilAttachment.has_value())
+        const auto& lhsSubpass = lhs.subpassDescriptions[i];
+        const auto& rhsSubpass = rhs.subpassDescriptions[i];
+
+        if (lhsSubpass.flags != rhsSubpass.flags ||
+            lhsSubpass.pipelineBindPoint != rhsSubpass.pipelineBindPoint ||
+            !equalRange(lhsSubpass.inputAttachments, rhsSubpass.inputAttachments) ||
+            !equalRange(lhsSubpass.colorAttachments, rhsSubpass.colorAttachments) ||
+            !equalRange(lhsSubpass.resolveAttachments, rhsSubpass.resolveAttachments) ||
+            !equalRange(lhsSubpass.preserveAttachments, rhsSubpass.preserveAttachments) ||
+            lhsSubpass.depthStencilAttachment.has_value() != rhsSubpass.depthStencilAttachment.has_value())
         {
             return false;
         }
-    }
 
-    for (auto i = 0; i < lhs.subpassDependencies.size(); ++i)
-    {
-        if (lhs.subpassDependencies[i].dependencyFlags != rhs.subpassDependencies[i].dependencyFlags ||
-            lhs.subpassDependencies[i].dstAccessMask != rhs.subpassDependencies[i].dstAccessMask ||
-            lhs.subpassDependencies[i].dstStageMask != rhs.subpassDependencies[i].dstStageMask ||
-            lhs.subpassDependencies[i].dstSubpass != rhs.subpassDependencies[i].dstSubpass ||
-            lhs.subpassDependencies[i].srcAccessMask != rhs.subpassDependencies[i].srcAccessMask ||
-            lhs.subpassDependencies[i].srcStageMask != rhs.subpassDependencies[i].srcStageMask ||
-            lhs.subpassDependencies[i].srcSubpass != rhs.subpassDependencies[i].srcSubpass)
+        if (lhsSubpass.depthStencilAttachment.has_value() &&
+            !equalPod(lhsSubpass.depthStencilAttachment.value(), rhsSubpass.depthStencilAttachment.value()))
         {
             return false;
         }
@@ -171,11 +161,16 @@ VulkanRenderPass& VulkanRenderPassCache::getRenderPass(const VulkanRenderPassDes
     auto it = m_cache.find(descriptor);
     if (it != m_cache.end())
     {
+        ++m_statistics.hits;
         return *(it->second);
     }
 
+    ++m_statistics.misses;
+
     // create new renderpass
+    const auto begin = std::chrono::steady_clock::now();
     std::unique_ptr<VulkanRenderPass> renderPass = std::make_unique<VulkanRenderPass>(m_device, descriptor);
+    m_statistics.creationTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
 
     // get raw pointer before moving.
     VulkanRenderPass* renderPassPtr = renderPass.get();
@@ -189,6 +184,191 @@ void VulkanRenderPassCache::clear()
     m_cache.clear();
 }
 
+CacheStatistics VulkanRenderPassCache::getStatistics() const
+{
+    CacheStatistics statistics = m_statistics;
+    statistics.entries = m_cache.size();
+
+    return statistics;
+}
+
+void VulkanRenderPassCache::resetStatistics()
+{
+    m_statistics = CacheStatistics{ .name = m_statistics.name };
+}
+
+std::vector<VulkanSubpassDescription> generateVulkanSubpassDescriptions(const std::vector<SubpassDescriptor>& descriptors,
+                                                                      uint32_t colorAttachmentCount,
+                                                                      bool resolve,
+                                                                      bool depthStencil)
+{
+    const auto subpasses = generateSubpasses(descriptors, colorAttachmentCount);
+    const uint32_t subpassCount = static_cast<uint32_t>(subpasses.size());
+
+    // resolve is done once by the last subpass which writes the attachment.
+    std::vector<uint32_t> lastWriters(colorAttachmentCount, UINT32_MAX);
+    for (uint32_t i = 0; i < subpassCount; ++i)
+    {
+        const auto& subpass = subpasses[i];
+        for (const auto attachment : subpass.colorAttachments)
+        {
+            if (attachment >= colorAttachmentCount)
+                throw std::runtime_error(fmt::format("Color attachment {} of subpass {} is out of {} color attachments.", attachment, i, colorAttachmentCount));
+            if (contains(subpass.inputAttachments, attachment))
+                throw std::runtime_error(fmt::format("Attachment {} of subpass {} can't be both color and input attachment.", attachment, i));
+
+            lastWriters[attachment] = i;
+        }
+
+        for (const auto attachment : subpass.inputAttachments)
+        {
+            if (attachment >= colorAttachmentCount)
+                throw std::runtime_error(fmt::format("Input attachment {} of subpass {} is out of {} color attachments.", attachment, i, colorAttachmentCount));
+        }
+    }
+
+    std::vector<VulkanSubpassDescription> subpassDescriptions(subpassCount);
+    for (uint32_t i = 0; i < subpassCount; ++i)
+    {
+        const auto& subpass = subpasses[i];
+
+        VulkanSubpassDescription& subpassDescription = subpassDescriptions[i];
+        subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+        for (const auto attachment : subpass.inputAttachments)
+            subpassDescription.inputAttachments.push_back({ attachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+
+        for (const auto attachment : subpass.colorAttachments)
+        {
+            subpassDescription.colorAttachments.push_back({ attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+
+            if (resolve)
+            {
+                const uint32_t resolveAttachment = lastWriters[attachment] == i ? colorAttachmentCount + attachment : VK_ATTACHMENT_UNUSED;
+                subpassDescription.resolveAttachments.push_back({ resolveAttachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+            }
+        }
+
+        if (depthStencil && subpass.depthStencil)
+        {
+            const uint32_t depthStencilAttachment = resolve ? colorAttachmentCount * 2 : colorAttachmentCount;
+            subpassDescription.depthStencilAttachment = VkAttachmentReference{ depthStencilAttachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+        }
+
+        // contents of attachments which are used before and after the subpass must be kept during it.
+        for (uint32_t attachment = 0; attachment < colorAttachmentCount; ++attachment)
+        {
+            if (uses(subpass, attachment))
+                continue;
+
+            auto usesAttachment = [attachment](const SubpassDescriptor& other) { return uses(other, attachment); };
+            if (std::any_of(subpasses.begin(), subpasses.begin() + i, usesAttachment) &&
+                std::any_of(subpasses.begin() + i + 1, subpasses.end(), usesAttachment))
+                subpassDescription.preserveAttachments.push_back(attachment);
+        }
+    }
+
+    return subpassDescriptions;
+}
+
+std::vector<VkSubpassDependency> generateVulkanSubpassDependencies(const std::vector<SubpassDescriptor>& descriptors,
+                                                                   uint32_t colorAttachmentCount,
+                                                                   bool depthStencil)
+{
+    const auto subpasses = generateSubpasses(descriptors, colorAttachmentCount);
+    const uint32_t subpassCount = static_cast<uint32_t>(subpasses.size());
+
+    std::vector<VkSubpassDependency> subpassDependencies{};
+
+    std::vector<bool> usedAttachments(colorAttachmentCount, false);
+    bool usedDepthStencil = false;
+    for (uint32_t dst = 0; dst < subpassCount; ++dst)
+    {
+        const auto& dstSubpass = subpasses[dst];
+        const bool dstDepthStencil = depthStencil && dstSubpass.depthStencil;
+
+        // wait for previous use of the attachments, such as swapchain image acquisition, before the first use in the render pass.
+        bool firstUse = dst == 0 || (dstDepthStencil && !usedDepthStencil);
+        for (uint32_t attachment = 0; attachment < colorAttachmentCount; ++attachment)
+        {
+            if (uses(dstSubpass, attachment) && !usedAttachments[attachment])
+            {
+                firstUse = true;
+                usedAttachments[attachment] = true;
+            }
+        }
+        usedDepthStencil |= dstDepthStencil;
+
+        if (firstUse)
+        {
+            VkSubpassDependency subpassDependency{};
+            subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+            subpassDependency.dstSubpass = dst;
+            subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+            subpassDependency.srcAccessMask = 0;
+            subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+            subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            if (dstDepthStencil)
+                subpassDependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+            subpassDependencies.push_back(subpassDependency);
+        }
+
+        // accesses of subpasses are in framebuffer space, so a subpass depends on the same region of previous subpasses only.
+        for (uint32_t src = 0; src < dst; ++src)
+        {
+            const auto& srcSubpass = subpasses[src];
+
+            VkSubpassDependency subpassDependency{};
+            subpassDependency.srcSubpass = src;
+            subpassDependency.dstSubpass = dst;
+            subpassDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+            for (uint32_t attachment = 0; attachment < colorAttachmentCount; ++attachment)
+            {
+                const bool srcWrite = contains(srcSubpass.colorAttachments, attachment);
+                const bool srcRead = contains(srcSubpass.inputAttachments, attachment);
+                const bool dstWrite = contains(dstSubpass.colorAttachments, attachment);
+                const bool dstRead = contains(dstSubpass.inputAttachments, attachment);
+
+                if (srcWrite && dstRead)
+                {
+                    subpassDependency.srcStageMask |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                    subpassDependency.srcAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+                    subpassDependency.dstStageMask |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+                    subpassDependency.dstAccessMask |= VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+                }
+                if (srcWrite && dstWrite)
+                {
+                    subpassDependency.srcStageMask |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                    subpassDependency.srcAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+                    subpassDependency.dstStageMask |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                    subpassDependency.dstAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+                }
+                // write after read needs an execution dependency only.
+                if (srcRead && dstWrite)
+                {
+                    subpassDependency.srcStageMask |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+                    subpassDependency.dstStageMask |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                }
+            }
+
+            if (depthStencil && srcSubpass.depthStencil && dstSubpass.depthStencil)
+            {
+                subpassDependency.srcStageMask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+                subpassDependency.srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+                subpassDependency.dstStageMask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+                subpassDependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            }
+
+            if (subpassDependency.srcStageMask != 0)
+                subpassDependencies.push_back(subpassDependency);
+        }
+    }
+
+    return subpassDependencies;
+}
+
 // Convert Helper
 VkAttachmentLoadOp ToVkAttachmentLoadOp(LoadOp loadOp)
 {
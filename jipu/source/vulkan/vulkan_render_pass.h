@@ -1,5 +1,6 @@
 #pragma once
 
+#include "jipu/device.h"
 #include "jipu/render_pass_encoder.h"
 #include "jipu/texture.h"
 #include "vulkan_api.h"
@@ -34,7 +35,7 @@ struct VulkanRenderPassDescriptor
 };
 
 class VulkanDevice;
-class VULKAN_EXPORT VulkanRenderPass
+class VULKAN_EXPORT VulkanRenderPass final
 {
 public:
     VulkanRenderPass() = delete;
@@ -64,8 +65,12 @@ public:
 
     void clear();
 
+    CacheStatistics getStatistics() const;
+    void resetStatistics();
+
 private:
     VulkanDevice& m_device;
+    CacheStatistics m_statistics{ .name = "Render Pass" };
 
 private:
     struct Functor
@@ -78,6 +83,19 @@ private:
     Cache m_cache{};
 };
 
+// Generate Helper
+/// @brief subpass descriptions for attachments which are ordered as color attachments, resolve attachments if resolve is true,
+/// and depth stencil attachment. a subpass which uses all attachments is generated if subpasses are empty.
+std::vector<VulkanSubpassDescription> VULKAN_EXPORT generateVulkanSubpassDescriptions(const std::vector<SubpassDescriptor>& subpasses,
+                                                                                     uint32_t colorAttachmentCount,
+                                                                                     bool resolve,
+                                                                                     bool depthStencil);
+/// @brief by region dependencies between subpasses which use the same attachments, and external dependencies of subpasses
+/// which use attachments first.
+std::vector<VkSubpassDependency> VULKAN_EXPORT generateVulkanSubpassDependencies(const std::vector<SubpassDescriptor>& subpasses,
+                                                                                 uint32_t colorAttachmentCount,
+                                                                                 bool depthStencil);
+
 // Convert Helper
 VkAttachmentLoadOp ToVkAttachmentLoadOp(LoadOp loadOp);
 LoadOp ToVkAttachmentLoadOp(VkAttachmentLoadOp loadOp);
@@ -2,15 +2,20 @@
 #include "vulkan_render_pass_encoder.h"
 
 #include "vulkan_binding_group.h"
+#include "vulkan_binding_group_layout.h"
 #include "vulkan_buffer.h"
 #include "vulkan_command_buffer.h"
 #include "vulkan_device.h"
+#include "vulkan_physical_device.h"
 #include "vulkan_pipeline.h"
 #include "vulkan_pipeline_layout.h"
 #include "vulkan_query_set.h"
 #include "vulkan_texture.h"
 #include "vulkan_texture_view.h"
 
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
 #include <optional>
 #include <spdlog/spdlog.h>
 
@@ -75,6 +80,71 @@ std::vector<VkClearValue> generateClearColor(const RenderPassEncoderDescriptor&
     return clearValues;
 }
 
+std::vector<VulkanTextureView*> generateAttachmentViews(const RenderPassEncoderDescriptor& descriptor)
+{
+    std::vector<VulkanTextureView*> views{};
+
+    for (const auto attachment : descriptor.colorAttachments)
+        views.push_back(&downcast(attachment.renderView));
+
+    if (descriptor.sampleCount > 1)
+    {
+        for (const auto attachment : descriptor.colorAttachments)
+            views.push_back(&downcast(attachment.resolveView.value().get()));
+    }
+
+    if (descriptor.depthStencilAttachment.has_value())
+    {
+        auto depthStencilAttachment = descriptor.depthStencilAttachment.value();
+        views.push_back(&downcast(depthStencilAttachment.textureView));
+    }
+
+    return views;
+}
+
+// same as the final layouts of the render pass.
+std::vector<VulkanAttachmentLayout> generateAttachmentLayouts(const RenderPassEncoderDescriptor& descriptor)
+{
+    std::vector<VulkanAttachmentLayout> layouts{};
+
+    for (const auto& colorAttachment : descriptor.colorAttachments)
+    {
+        auto texture = downcast(colorAttachment.renderView.getTexture());
+        layouts.push_back({ texture, texture->getFinalLayout() });
+
+        if (descriptor.sampleCount > 1)
+        {
+            auto resolveTexture = downcast(colorAttachment.resolveView.value().get().getTexture());
+            layouts.push_back({ resolveTexture, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR });
+        }
+    }
+
+    if (descriptor.depthStencilAttachment.has_value())
+    {
+        auto texture = downcast(descriptor.depthStencilAttachment.value().textureView.getTexture());
+        layouts.push_back({ texture, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL });
+    }
+
+    return layouts;
+}
+
+// transition the subresources of the view from their tracked states. depth and stencil aspects are transitioned together.
+void transitionAttachment(VulkanPipelineBarrier& barrier, const VulkanTextureView& view, VkImageLayout layout, VkPipelineStageFlags stageMask, VkAccessFlags accessMask)
+{
+    auto texture = downcast(view.getTexture());
+
+    VkImageSubresourceRange range = view.getVkImageSubresourceRange();
+    range.aspectMask = GenerateImageAspectFlags(ToVkFormat(texture->getFormat()));
+
+    texture->transitionLayout(barrier, range, layout, stageMask, accessMask);
+}
+
+void transitionAttachmentToFinalLayout(VulkanPipelineBarrier& barrier, const VulkanTextureView& view)
+{
+    const VkImageLayout finalLayout = downcast(view.getTexture())->getFinalLayout();
+    transitionAttachment(barrier, view, finalLayout, GenerateSrcPipelineStage(finalLayout), GenerateAccessFlags(finalLayout));
+}
+
 } // namespace
 
 VulkanRenderPassDescriptor generateVulkanRenderPassDescriptor(const RenderPassEncoderDescriptor& descriptor)
@@ -140,63 +210,35 @@ VulkanRenderPassDescriptor generateVulkanRenderPassDescriptor(const RenderPassEn
         vkdescriptor.attachmentDescriptions.push_back(attachment);
     }
 
-    {
-        VulkanSubpassDescription subpassDescription{};
-        subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-
-        // color attachments
-        uint32_t colorAttachmentCount = static_cast<uint32_t>(descriptor.colorAttachments.size());
-        for (auto i = 0; i < colorAttachmentCount; ++i)
-        {
-            // attachment references
-            VkAttachmentReference colorAttachmentReference{};
-            colorAttachmentReference.attachment = i;
-            colorAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-            subpassDescription.colorAttachments.push_back(colorAttachmentReference);
-        }
+    const uint32_t colorAttachmentCount = static_cast<uint32_t>(descriptor.colorAttachments.size());
+    const bool resolve = descriptor.sampleCount > 1;
+    const bool depthStencil = descriptor.depthStencilAttachment.has_value();
+    vkdescriptor.subpassDescriptions = generateVulkanSubpassDescriptions(descriptor.subpasses, colorAttachmentCount, resolve, depthStencil);
+    vkdescriptor.subpassDependencies = generateVulkanSubpassDependencies(descriptor.subpasses, colorAttachmentCount, depthStencil);
 
-        std::vector<VkAttachmentReference> resolveAttachmentReferences{};
-        if (descriptor.sampleCount > 1)
-        {
-            // resolve attachments
-            for (uint32_t i = colorAttachmentCount; i < colorAttachmentCount * 2; ++i)
-            {
-                VkAttachmentReference resolveAttachmentReference{};
-                resolveAttachmentReference.attachment = i;
-                resolveAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-                subpassDescription.resolveAttachments.push_back(resolveAttachmentReference);
-            }
-        }
+    return vkdescriptor;
+}
 
-        if (descriptor.depthStencilAttachment.has_value())
-        {
-            VkAttachmentReference depthAttachment{};
-            depthAttachment.attachment = static_cast<uint32_t>(subpassDescription.colorAttachments.size() + subpassDescription.resolveAttachments.size());
-            depthAttachment.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+VulkanFramebufferDescriptor generateVulkanFramebufferDescriptor(VulkanRenderPass& renderPass, const RenderPassEncoderDescriptor& descriptor)
+{
+    if (descriptor.colorAttachments.empty())
+        throw std::runtime_error("The attachments for color is empty to create frame buffer descriptor.");
 
-            subpassDescription.depthStencilAttachment = depthAttachment;
-        }
-        vkdescriptor.subpassDescriptions = { subpassDescription };
+    const auto texture = downcast(descriptor.colorAttachments[0].renderView.getTexture());
 
-        VkSubpassDependency subpassDependency{};
-        subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        subpassDependency.dstSubpass = 0;
-        subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        subpassDependency.srcAccessMask = 0;
-        subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        if (descriptor.depthStencilAttachment.has_value())
-            subpassDependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    VulkanFramebufferDescriptor vkdescriptor{};
+    vkdescriptor.width = texture->getWidth();
+    vkdescriptor.height = texture->getHeight();
+    vkdescriptor.layers = 1;
+    vkdescriptor.renderPass = renderPass.getVkRenderPass();
 
-        vkdescriptor.subpassDependencies = { subpassDependency };
-    }
+    for (const auto view : generateAttachmentViews(descriptor))
+        vkdescriptor.attachments.push_back(view->getVkImageView());
 
     return vkdescriptor;
 }
 
-VulkanFramebufferDescriptor generateVulkanFramebufferDescriptor(VulkanRenderPass& renderPass, const RenderPassEncoderDescriptor& descriptor)
+VulkanFramebufferDescriptor generateVulkanImagelessFramebufferDescriptor(VulkanRenderPass& renderPass, const RenderPassEncoderDescriptor& descriptor)
 {
     if (descriptor.colorAttachments.empty())
         throw std::runtime_error("The attachments for color is empty to create frame buffer descriptor.");
@@ -204,55 +246,178 @@ VulkanFramebufferDescriptor generateVulkanFramebufferDescriptor(VulkanRenderPass
     const auto texture = downcast(descriptor.colorAttachments[0].renderView.getTexture());
 
     VulkanFramebufferDescriptor vkdescriptor{};
+    vkdescriptor.flags = VK_FRAMEBUFFER_CREATE_IMAGELESS_BIT;
     vkdescriptor.width = texture->getWidth();
     vkdescriptor.height = texture->getHeight();
     vkdescriptor.layers = 1;
     vkdescriptor.renderPass = renderPass.getVkRenderPass();
 
-    for (const auto attachment : descriptor.colorAttachments)
-        vkdescriptor.attachments.push_back(downcast(attachment.renderView).getVkImageView());
+    for (const auto view : generateAttachmentViews(descriptor))
+    {
+        const auto attachmentTexture = downcast(view->getTexture());
 
-    if (descriptor.sampleCount > 1)
+        VulkanFramebufferAttachmentImageInfo imageInfo{};
+        imageInfo.flags = attachmentTexture->getVkImageCreateFlags();
+        imageInfo.usage = attachmentTexture->getVkImageUsageFlags();
+        imageInfo.width = view->getWidth();
+        imageInfo.height = view->getHeight();
+        imageInfo.layerCount = view->getLayerCount();
+        imageInfo.format = view->getVkFormat();
+
+        vkdescriptor.attachmentImageInfos.push_back(imageInfo);
+    }
+
+    return vkdescriptor;
+}
+
+VulkanRenderingInfo generateVulkanRenderingInfo(const RenderPassEncoderDescriptor& descriptor)
+{
+    if (descriptor.colorAttachments.empty())
+        throw std::runtime_error("Failed to create vulkan rendering info due to empty color attachment.");
+
+    VulkanRenderingInfo renderingInfo{};
+
+    for (const auto& colorAttachment : descriptor.colorAttachments)
     {
-        for (const auto attachment : descriptor.colorAttachments)
-            vkdescriptor.attachments.push_back(downcast(attachment.resolveView.value()).getVkImageView());
+        auto& renderView = downcast(colorAttachment.renderView);
+
+        VkRenderingAttachmentInfo attachment{ .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
+        attachment.imageView = renderView.getVkImageView();
+        attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachment.resolveMode = VK_RESOLVE_MODE_NONE;
+        attachment.loadOp = ToVkAttachmentLoadOp(colorAttachment.loadOp);
+        attachment.storeOp = ToVkAttachmentStoreOp(colorAttachment.storeOp);
+        attachment.clearValue.color.float32[0] = colorAttachment.clearValue.r;
+        attachment.clearValue.color.float32[1] = colorAttachment.clearValue.g;
+        attachment.clearValue.color.float32[2] = colorAttachment.clearValue.b;
+        attachment.clearValue.color.float32[3] = colorAttachment.clearValue.a;
+
+        transitionAttachment(renderingInfo.beginBarrier,
+                             renderView,
+                             VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+        transitionAttachmentToFinalLayout(renderingInfo.endBarrier, renderView);
+
+        if (descriptor.sampleCount > 1)
+        {
+            auto& resolveView = downcast(colorAttachment.resolveView.value().get());
+            attachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+            attachment.resolveImageView = resolveView.getVkImageView();
+            attachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+            transitionAttachment(renderingInfo.beginBarrier,
+                                 resolveView,
+                                 VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                 VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                 VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+            transitionAttachmentToFinalLayout(renderingInfo.endBarrier, resolveView);
+        }
+
+        renderingInfo.colorAttachments.push_back(attachment);
     }
 
     if (descriptor.depthStencilAttachment.has_value())
     {
         auto depthStencilAttachment = descriptor.depthStencilAttachment.value();
-        vkdescriptor.attachments.push_back(downcast(depthStencilAttachment.textureView).getVkImageView());
+
+        auto& textureView = downcast(depthStencilAttachment.textureView);
+        auto texture = downcast(textureView.getTexture());
+
+        VkRenderingAttachmentInfo attachment{ .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
+        attachment.imageView = textureView.getVkImageView();
+        attachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        attachment.resolveMode = VK_RESOLVE_MODE_NONE;
+        attachment.clearValue.depthStencil = { depthStencilAttachment.clearValue.depth,
+                                               depthStencilAttachment.clearValue.stencil };
+
+        VkImageAspectFlags aspect = GenerateImageAspectFlags(ToVkFormat(texture->getFormat()));
+        if (aspect & VK_IMAGE_ASPECT_DEPTH_BIT)
+        {
+            attachment.loadOp = ToVkAttachmentLoadOp(depthStencilAttachment.depthLoadOp);
+            attachment.storeOp = ToVkAttachmentStoreOp(depthStencilAttachment.depthStoreOp);
+            renderingInfo.depthAttachment = attachment;
+        }
+        if (aspect & VK_IMAGE_ASPECT_STENCIL_BIT)
+        {
+            attachment.loadOp = ToVkAttachmentLoadOp(depthStencilAttachment.stencilLoadOp);
+            attachment.storeOp = ToVkAttachmentStoreOp(depthStencilAttachment.stencilStoreOp);
+            renderingInfo.stencilAttachment = attachment;
+        }
+
+        // same as the render pass, depth stencil attachment is remained in attachment layout.
+        transitionAttachment(renderingInfo.beginBarrier,
+                             textureView,
+                             VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                             VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
     }
 
-    return vkdescriptor;
+    // same as the external subpass dependency in render pass. it also waits for swapchain image acquisition.
+    renderingInfo.beginBarrier.srcStageMask |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+
+    return renderingInfo;
 }
 
-VulkanRenderPassEncoderDescriptor generateVulkanRenderPassEncoderDescriptor(VulkanDevice& device, const RenderPassEncoderDescriptor& descriptor)
+VulkanRenderPassEncoderDescriptor generateVulkanRenderPassEncoderDescriptor(VulkanCommandBuffer& commandBuffer, const RenderPassEncoderDescriptor& descriptor)
 {
-    auto& renderPass = device.getRenderPass(generateVulkanRenderPassDescriptor(descriptor));
-    auto& framebuffer = device.getFrameBuffer(generateVulkanFramebufferDescriptor(renderPass, descriptor));
+    auto& device = commandBuffer.getDevice();
 
     VulkanRenderPassEncoderDescriptor vkdescriptor{};
+
+    // TODO: convert timestampWrites for vulkan.
+    vkdescriptor.occlusionQuerySet = descriptor.occlusionQuerySet;
+    vkdescriptor.timestampWrites = descriptor.timestampWrites;
+
+    // render pass and framebuffer are not needed if dynamic rendering is supported.
+    // subpasses need a render pass to keep attachments in tile memory between them.
+    if (device.getPhysicalDevice().getVulkanPhysicalDeviceInfo().dynamicRendering && descriptor.subpasses.empty())
+    {
+        const auto texture = downcast(descriptor.colorAttachments[0].renderView.getTexture());
+
+        vkdescriptor.renderingInfo = generateVulkanRenderingInfo(descriptor);
+        vkdescriptor.renderArea.offset = { 0, 0 };
+        vkdescriptor.renderArea.extent = { texture->getWidth(), texture->getHeight() };
+
+        return vkdescriptor;
+    }
+
+    auto& renderPass = device.getRenderPass(generateVulkanRenderPassDescriptor(descriptor));
+
+    // an imageless framebuffer is shared by all views which have same format and extent. (ex. swapchain images)
+    const bool imageless = device.getPhysicalDevice().getVulkanPhysicalDeviceInfo().imagelessFramebuffer;
+    auto& framebufferCache = device.getFrameBufferCache();
+    auto framebufferRef = imageless ? framebufferCache.getFrameBuffer(generateVulkanImagelessFramebufferDescriptor(renderPass, descriptor))
+                                    : framebufferCache.getFrameBuffer(generateVulkanFramebufferDescriptor(renderPass, descriptor));
+    auto& framebuffer = *framebufferRef;
+    // the framebuffer may be removed from the cache before the command buffer is submitted.
+    commandBuffer.retain(std::move(framebufferRef));
+    if (framebuffer.isImageless())
+    {
+        for (const auto view : generateAttachmentViews(descriptor))
+            vkdescriptor.attachments.push_back(view->getVkImageView());
+    }
+
     vkdescriptor.clearValues = generateClearColor(descriptor);
     vkdescriptor.renderPass = renderPass.getVkRenderPass();
+    vkdescriptor.subpassCount = static_cast<uint32_t>(std::max<size_t>(descriptor.subpasses.size(), 1));
     vkdescriptor.framebuffer = framebuffer.getVkFrameBuffer();
     vkdescriptor.renderArea.offset = { 0, 0 };
     vkdescriptor.renderArea.extent = { framebuffer.getWidth(), framebuffer.getHeight() };
-
-    // TODO: convert timestampWrites for vulkan.
-    vkdescriptor.occlusionQuerySet = descriptor.occlusionQuerySet;
-    vkdescriptor.timestampWrites = descriptor.timestampWrites;
+    vkdescriptor.attachmentLayouts = generateAttachmentLayouts(descriptor);
 
     return vkdescriptor;
 }
 
 VulkanRenderPassEncoder::VulkanRenderPassEncoder(VulkanCommandBuffer& commandBuffer, const RenderPassEncoderDescriptor& descriptor)
-    : VulkanRenderPassEncoder(commandBuffer, generateVulkanRenderPassEncoderDescriptor(commandBuffer.getDevice(), descriptor))
+    : VulkanRenderPassEncoder(commandBuffer, generateVulkanRenderPassEncoderDescriptor(commandBuffer, descriptor))
 {
 }
 
 VulkanRenderPassEncoder::VulkanRenderPassEncoder(VulkanCommandBuffer& commandBuffer, const VulkanRenderPassEncoderDescriptor& descriptor)
     : m_commandBuffer(commandBuffer)
+    , m_recorder(commandBuffer.getCommandRecorder())
+    , m_bufferTracker(commandBuffer.getBufferTracker())
     , m_descriptor(descriptor)
 {
     resetQuery();
@@ -262,53 +427,106 @@ VulkanRenderPassEncoder::VulkanRenderPassEncoder(VulkanCommandBuffer& commandBuf
 void VulkanRenderPassEncoder::setPipeline(RenderPipeline& pipeline)
 {
     m_pipeline = std::make_optional<VulkanRenderPipeline::Ref>(downcast(pipeline));
+    m_descriptorSetState.setPipelineLayout(downcast(m_pipeline.value().get().getPipelineLayout()));
 
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
+    VkPipeline vkPipeline = m_pipeline.value().get().getVkPipeline();
+    if (m_boundPipeline == vkPipeline)
+    {
+        ++m_statistics.elidedCommands;
+        return;
+    }
 
-    vulkanDevice.vkAPI.CmdBindPipeline(vulkanCommandBuffer.getVkCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.value().get().getVkPipeline());
+    m_recorder.cmdBindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, vkPipeline);
+    m_boundPipeline = vkPipeline;
+    ++m_statistics.issuedCommands;
 }
 
-void VulkanRenderPassEncoder::setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::vector<uint32_t> dynamicOffset)
+void VulkanRenderPassEncoder::setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::span<const uint32_t> dynamicOffset)
+{
+    auto& vulkanBindingGroup = downcast(bindingGroup);
+    m_descriptorSetState.setDescriptorSet(index, vulkanBindingGroup.getVkDescriptorSet(), dynamicOffset);
+    m_bufferAccessState.setBufferAccesses(index, vulkanBindingGroup.getBufferAccesses());
+}
+
+void VulkanRenderPassEncoder::setPushConstants(BindingStageFlags stages, uint32_t offset, const void* data, uint32_t size)
 {
     if (!m_pipeline.has_value())
         throw std::runtime_error("The pipeline is null opt");
 
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
     auto& vulkanPipelineLayout = downcast(m_pipeline.value().get().getPipelineLayout());
-    auto& vulkanBindingGroup = downcast(bindingGroup);
-    VkDescriptorSet set = vulkanBindingGroup.getVkDescriptorSet();
-    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
 
-    vkAPI.CmdBindDescriptorSets(vulkanCommandBuffer.getVkCommandBuffer(),
-                                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                vulkanPipelineLayout.getVkPipelineLayout(),
-                                index,
-                                1,
-                                &set,
-                                static_cast<uint32_t>(dynamicOffset.size()),
-                                dynamicOffset.data());
+    m_recorder.cmdPushConstants(vulkanPipelineLayout.getVkPipelineLayout(),
+                                ToVkShaderStageFlags(stages),
+                                offset,
+                                size,
+                                data);
 }
 
-void VulkanRenderPassEncoder::setVertexBuffer(uint32_t slot, Buffer& buffer)
+void VulkanRenderPassEncoder::pushBindings(uint32_t index, const BindingGroupDescriptor& descriptor)
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
+    if (!m_pipeline.has_value())
+        throw std::runtime_error("The pipeline is null opt");
 
+    auto& vulkanPipelineLayout = downcast(m_pipeline.value().get().getPipelineLayout());
+
+    if (!downcast(descriptor.layout).isPushDescriptor())
+        throw std::runtime_error("The binding group layout is not for push descriptor.");
+
+    // infos are referenced by writes until they are recorded.
+    const VulkanBindingGroupDescriptor vulkanDescriptor = generateVulkanBindingGroupDescriptor(descriptor);
+    const std::vector<VkWriteDescriptorSet> descriptorWrites = generateVkWriteDescriptorSets(vulkanDescriptor, VK_NULL_HANDLE);
+
+    m_recorder.cmdPushDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    vulkanPipelineLayout.getVkPipelineLayout(),
+                                    index,
+                                    static_cast<uint32_t>(descriptorWrites.size()),
+                                    descriptorWrites.data());
+    m_descriptorSetState.invalidate(index);
+    m_bufferAccessState.setBufferAccesses(index, generateVulkanBufferAccesses(vulkanDescriptor));
+}
+
+void VulkanRenderPassEncoder::setVertexBuffer(uint32_t slot, Buffer& buffer)
+{
     auto& vulkanBuffer = downcast(buffer);
     VkBuffer vertexBuffers[] = { vulkanBuffer.getVkBuffer() };
+
+    if (slot >= m_vertexBuffers.size())
+        m_vertexBuffers.resize(slot + 1, VK_NULL_HANDLE);
+
+    if (m_vertexBuffers[slot] == vertexBuffers[0])
+    {
+        ++m_statistics.elidedCommands;
+        return;
+    }
+
     VkDeviceSize offsets[] = { 0 };
-    vulkanDevice.vkAPI.CmdBindVertexBuffers(vulkanCommandBuffer.getVkCommandBuffer(), slot, 1, vertexBuffers, offsets);
+    m_recorder.cmdBindVertexBuffers(slot, 1, vertexBuffers, offsets);
+    m_vertexBuffers[slot] = vertexBuffers[0];
+    ++m_statistics.issuedCommands;
+
+    m_bufferTracker.access({ .buffer = vertexBuffers[0],
+                             .stageMask = VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT,
+                             .accessMask = VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT });
 }
 
 void VulkanRenderPassEncoder::setIndexBuffer(Buffer& buffer, IndexFormat format)
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-
     auto& vulkanBuffer = downcast(buffer);
-    vulkanDevice.vkAPI.CmdBindIndexBuffer(vulkanCommandBuffer.getVkCommandBuffer(), vulkanBuffer.getVkBuffer(), 0, ToVkIndexType(format));
+    const IndexBufferState indexBuffer{ .buffer = vulkanBuffer.getVkBuffer(), .indexType = ToVkIndexType(format) };
+
+    if (m_indexBuffer.buffer == indexBuffer.buffer && m_indexBuffer.indexType == indexBuffer.indexType)
+    {
+        ++m_statistics.elidedCommands;
+        return;
+    }
+
+    m_recorder.cmdBindIndexBuffer(indexBuffer.buffer, 0, indexBuffer.indexType);
+    m_indexBuffer = indexBuffer;
+    ++m_statistics.issuedCommands;
+
+    m_bufferTracker.access({ .buffer = indexBuffer.buffer,
+                             .stageMask = VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT,
+                             .accessMask = VK_ACCESS_2_INDEX_READ_BIT });
 }
 
 void VulkanRenderPassEncoder::setViewport(float x,
@@ -318,11 +536,16 @@ void VulkanRenderPassEncoder::setViewport(float x,
                                           float minDepth,
                                           float maxDepth)
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-
     VkViewport viewport{ x, y, width, height, minDepth, maxDepth };
-    vulkanDevice.vkAPI.CmdSetViewport(vulkanCommandBuffer.getVkCommandBuffer(), 0, 1, &viewport);
+    if (m_viewport.has_value() && std::memcmp(&m_viewport.value(), &viewport, sizeof(VkViewport)) == 0)
+    {
+        ++m_statistics.elidedCommands;
+        return;
+    }
+
+    m_recorder.cmdSetViewport(viewport);
+    m_viewport = viewport;
+    ++m_statistics.issuedCommands;
 }
 
 void VulkanRenderPassEncoder::setScissor(float x,
@@ -330,37 +553,46 @@ void VulkanRenderPassEncoder::setScissor(float x,
                                          float width,
                                          float height)
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-
     VkRect2D scissorRect{};
     scissorRect.offset.x = x;
     scissorRect.offset.y = y;
     scissorRect.extent.width = width;
     scissorRect.extent.height = height;
 
-    vulkanDevice.vkAPI.CmdSetScissor(vulkanCommandBuffer.getVkCommandBuffer(), 0, 1, &scissorRect);
+    if (m_scissor.has_value() && std::memcmp(&m_scissor.value(), &scissorRect, sizeof(VkRect2D)) == 0)
+    {
+        ++m_statistics.elidedCommands;
+        return;
+    }
+
+    m_recorder.cmdSetScissor(scissorRect);
+    m_scissor = scissorRect;
+    ++m_statistics.issuedCommands;
 }
 
 void VulkanRenderPassEncoder::setBlendConstant(const Color& color)
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
+    const std::array<float, 4> blendConstants = { static_cast<float>(color.r),
+                                                  static_cast<float>(color.g),
+                                                  static_cast<float>(color.b),
+                                                  static_cast<float>(color.a) };
 
-    float blendConstants[4] = { static_cast<float>(color.r),
-                                static_cast<float>(color.g),
-                                static_cast<float>(color.b),
-                                static_cast<float>(color.a) };
+    if (m_blendConstants == blendConstants)
+    {
+        ++m_statistics.elidedCommands;
+        return;
+    }
 
-    vulkanDevice.vkAPI.CmdSetBlendConstants(vulkanCommandBuffer.getVkCommandBuffer(), blendConstants);
+    m_recorder.cmdSetBlendConstants(blendConstants.data());
+    m_blendConstants = blendConstants;
+    ++m_statistics.issuedCommands;
 }
 
 void VulkanRenderPassEncoder::draw(uint32_t vertexCount)
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-
-    vulkanDevice.vkAPI.CmdDraw(vulkanCommandBuffer.getVkCommandBuffer(), vertexCount, 1, 0, 0);
+    trackBufferAccesses();
+    m_descriptorSetState.flush(m_recorder);
+    m_recorder.cmdDraw(vertexCount, 1, 0, 0);
 }
 
 void VulkanRenderPassEncoder::drawIndexed(uint32_t indexCount,
@@ -369,15 +601,110 @@ void VulkanRenderPassEncoder::drawIndexed(uint32_t indexCount,
                                           uint32_t vertexOffset,
                                           uint32_t firstInstance)
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
+    trackBufferAccesses();
+    m_descriptorSetState.flush(m_recorder);
+    m_recorder.cmdDrawIndexed(indexCount,
+                              instanceCount,
+                              indexOffset,
+                              vertexOffset,
+                              firstInstance);
+}
+
+void VulkanRenderPassEncoder::drawIndirect(Buffer& indirectBuffer, uint64_t indirectOffset)
+{
+    VkBuffer vkIndirectBuffer = downcast(indirectBuffer).getVkBuffer();
+
+    trackBufferAccesses();
+    trackIndirectBuffer(vkIndirectBuffer, indirectOffset, sizeof(DrawIndirectArgs));
+    m_descriptorSetState.flush(m_recorder);
+    m_recorder.cmdDrawIndirect(vkIndirectBuffer, indirectOffset, 1, sizeof(DrawIndirectArgs));
+}
+
+void VulkanRenderPassEncoder::drawIndexedIndirect(Buffer& indirectBuffer, uint64_t indirectOffset)
+{
+    VkBuffer vkIndirectBuffer = downcast(indirectBuffer).getVkBuffer();
 
-    vulkanDevice.vkAPI.CmdDrawIndexed(vulkanCommandBuffer.getVkCommandBuffer(),
-                                      indexCount,
-                                      instanceCount,
-                                      indexOffset,
-                                      vertexOffset,
-                                      firstInstance);
+    trackBufferAccesses();
+    trackIndirectBuffer(vkIndirectBuffer, indirectOffset, sizeof(DrawIndexedIndirectArgs));
+    m_descriptorSetState.flush(m_recorder);
+    m_recorder.cmdDrawIndexedIndirect(vkIndirectBuffer, indirectOffset, 1, sizeof(DrawIndexedIndirectArgs));
+}
+
+void VulkanRenderPassEncoder::multiDrawIndirect(Buffer& indirectBuffer,
+                                                uint64_t indirectOffset,
+                                                uint32_t maxDrawCount,
+                                                Buffer* countBuffer,
+                                                uint64_t countBufferOffset)
+{
+    recordMultiDrawIndirect(downcast(indirectBuffer).getVkBuffer(), indirectOffset, maxDrawCount, countBuffer, countBufferOffset, false);
+}
+
+void VulkanRenderPassEncoder::multiDrawIndexedIndirect(Buffer& indirectBuffer,
+                                                       uint64_t indirectOffset,
+                                                       uint32_t maxDrawCount,
+                                                       Buffer* countBuffer,
+                                                       uint64_t countBufferOffset)
+{
+    recordMultiDrawIndirect(downcast(indirectBuffer).getVkBuffer(), indirectOffset, maxDrawCount, countBuffer, countBufferOffset, true);
+}
+
+void VulkanRenderPassEncoder::recordMultiDrawIndirect(VkBuffer indirectBuffer, uint64_t indirectOffset, uint32_t maxDrawCount, Buffer* countBuffer, uint64_t countBufferOffset, bool indexed)
+{
+    if (maxDrawCount == 0)
+        return;
+
+    const auto& physicalDeviceInfo = m_commandBuffer.getDevice().getPhysicalDevice().getVulkanPhysicalDeviceInfo();
+    const uint32_t stride = indexed ? sizeof(DrawIndexedIndirectArgs) : sizeof(DrawIndirectArgs);
+
+    trackBufferAccesses();
+    trackIndirectBuffer(indirectBuffer, indirectOffset, static_cast<uint64_t>(maxDrawCount) * stride);
+    m_descriptorSetState.flush(m_recorder);
+
+    if (countBuffer)
+    {
+        if (!physicalDeviceInfo.drawIndirectCount)
+        {
+            throw std::runtime_error("Multi draw indirect with count buffer requires draw indirect count.");
+        }
+
+        VkBuffer vkCountBuffer = downcast(countBuffer)->getVkBuffer();
+        trackIndirectBuffer(vkCountBuffer, countBufferOffset, sizeof(uint32_t));
+        if (indexed)
+            m_recorder.cmdDrawIndexedIndirectCount(indirectBuffer, indirectOffset, vkCountBuffer, countBufferOffset, maxDrawCount, stride);
+        else
+            m_recorder.cmdDrawIndirectCount(indirectBuffer, indirectOffset, vkCountBuffer, countBufferOffset, maxDrawCount, stride);
+
+        return;
+    }
+
+    // draw count must be 0 or 1 without multi draw indirect feature. record draws one by one.
+    const bool multiDraw = physicalDeviceInfo.physicalDeviceFeatures.multiDrawIndirect;
+    const uint32_t drawCountPerCommand = multiDraw ? std::max(physicalDeviceInfo.physicalDeviceProperties.limits.maxDrawIndirectCount, 1u) : 1u;
+
+    for (uint32_t first = 0; first < maxDrawCount; first += drawCountPerCommand)
+    {
+        const uint32_t drawCount = std::min(maxDrawCount - first, drawCountPerCommand);
+        const uint64_t offset = indirectOffset + static_cast<uint64_t>(first) * stride;
+        if (indexed)
+            m_recorder.cmdDrawIndexedIndirect(indirectBuffer, offset, drawCount, stride);
+        else
+            m_recorder.cmdDrawIndirect(indirectBuffer, offset, drawCount, stride);
+    }
+}
+
+void VulkanRenderPassEncoder::trackBufferAccesses()
+{
+    if (m_bufferAccessState.isDirty())
+        m_bufferAccessState.access(m_bufferTracker);
+}
+
+void VulkanRenderPassEncoder::trackIndirectBuffer(VkBuffer buffer, uint64_t offset, uint64_t size)
+{
+    m_bufferTracker.access({ .buffer = buffer,
+                             .offset = offset,
+                             .size = size,
+                             .stageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+                             .accessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT });
 }
 
 void VulkanRenderPassEncoder::beginOcclusionQuery(uint32_t queryIndex)
@@ -387,15 +714,11 @@ void VulkanRenderPassEncoder::beginOcclusionQuery(uint32_t queryIndex)
         throw std::runtime_error("The occlusion query set is nullptr to begin occlusion query.");
     }
 
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
     auto vulkanOcclusionQuerySet = downcast(m_descriptor.occlusionQuerySet);
 
-    auto& vkAPI = vulkanDevice.vkAPI;
-    vkAPI.CmdBeginQuery(vulkanCommandBuffer.getVkCommandBuffer(),
-                        vulkanOcclusionQuerySet->getVkQueryPool(),
-                        queryIndex,
-                        0);
+    m_recorder.cmdBeginQuery(vulkanOcclusionQuerySet->getVkQueryPool(),
+                             queryIndex,
+                             0);
 }
 
 void VulkanRenderPassEncoder::endOcclusionQuery()
@@ -405,78 +728,82 @@ void VulkanRenderPassEncoder::endOcclusionQuery()
         throw std::runtime_error("The occlusion query set is nullptr to end occlusion query.");
     }
 
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
     auto vulkanOcclusionQuerySet = downcast(m_descriptor.occlusionQuerySet);
 
-    auto& vkAPI = vulkanDevice.vkAPI;
-
-    vkAPI.CmdEndQuery(vulkanCommandBuffer.getVkCommandBuffer(),
-                      vulkanOcclusionQuerySet->getVkQueryPool(),
-                      0);
+    m_recorder.cmdEndQuery(vulkanOcclusionQuerySet->getVkQueryPool(),
+                           0);
 }
 
 void VulkanRenderPassEncoder::end()
 {
+    if (m_passIndex + 1 != m_descriptor.subpassCount)
+        throw std::runtime_error(fmt::format("Render pass is ended at subpass {} of {} subpasses.", m_passIndex, m_descriptor.subpassCount));
+
     endRenderPass();
+    m_bufferTracker.track();
+
+    spdlog::trace("Render pass state commands issued: {}, elided: {}", m_statistics.issuedCommands, m_statistics.elidedCommands);
 
     // TODO: generate stage from binding group.
     VkPipelineStageFlags flags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     auto& vulkanCommandBuffer = downcast(m_commandBuffer);
     vulkanCommandBuffer.setSignalPipelineStage(flags);
+    vulkanCommandBuffer.addStatistics(m_statistics);
 }
 
 void VulkanRenderPassEncoder::nextPass()
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
+    if (m_descriptor.renderPass == VK_NULL_HANDLE)
+        throw std::runtime_error("Subpass is not supported in dynamic rendering.");
 
-    vulkanDevice.vkAPI.CmdNextSubpass(vulkanCommandBuffer.getVkCommandBuffer(), VK_SUBPASS_CONTENTS_INLINE);
+    if (m_passIndex + 1 >= m_descriptor.subpassCount)
+        throw std::runtime_error(fmt::format("There is no subpass after subpass {}.", m_passIndex));
+
+    m_recorder.cmdNextSubpass(VK_SUBPASS_CONTENTS_INLINE);
     ++m_passIndex;
 }
 
-void VulkanRenderPassEncoder::resetQuery()
+const VulkanPassEncoderStatistics& VulkanRenderPassEncoder::getStatistics() const
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
+    return m_statistics;
+}
 
-    const auto& vkAPI = vulkanDevice.vkAPI;
+void VulkanRenderPassEncoder::resetQuery()
+{
     if (m_descriptor.timestampWrites.querySet)
     {
         auto vulkanQuerySet = downcast(m_descriptor.timestampWrites.querySet);
-        vkAPI.CmdResetQueryPool(vulkanCommandBuffer.getVkCommandBuffer(),
-                                vulkanQuerySet->getVkQueryPool(),
-                                0,
-                                vulkanQuerySet->getCount());
+        m_recorder.cmdResetQueryPool(vulkanQuerySet->getVkQueryPool(),
+                                     0,
+                                     vulkanQuerySet->getCount());
     }
 
     if (m_descriptor.occlusionQuerySet)
     {
         auto vulkanOcclusionQuerySet = downcast(m_descriptor.occlusionQuerySet);
-        vkAPI.CmdResetQueryPool(vulkanCommandBuffer.getVkCommandBuffer(),
-                                vulkanOcclusionQuerySet->getVkQueryPool(),
-                                0,
-                                vulkanOcclusionQuerySet->getCount());
+        m_recorder.cmdResetQueryPool(vulkanOcclusionQuerySet->getVkQueryPool(),
+                                     0,
+                                     vulkanOcclusionQuerySet->getCount());
     }
 }
 
 void VulkanRenderPassEncoder::beginRenderPass()
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
-
-    const auto& vkAPI = vulkanDevice.vkAPI;
     if (m_descriptor.timestampWrites.querySet)
     {
         auto vulkanQuerySet = downcast(m_descriptor.timestampWrites.querySet);
-        vkAPI.CmdResetQueryPool(vulkanCommandBuffer.getVkCommandBuffer(),
-                                vulkanQuerySet->getVkQueryPool(),
-                                0,
-                                vulkanQuerySet->getCount());
-        vkAPI.CmdWriteTimestamp(vulkanCommandBuffer.getVkCommandBuffer(),
-                                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                vulkanQuerySet->getVkQueryPool(),
-                                m_descriptor.timestampWrites.beginQueryIndex);
+        m_recorder.cmdResetQueryPool(vulkanQuerySet->getVkQueryPool(),
+                                     0,
+                                     vulkanQuerySet->getCount());
+        m_recorder.cmdWriteTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                     vulkanQuerySet->getVkQueryPool(),
+                                     m_descriptor.timestampWrites.beginQueryIndex);
+    }
+
+    if (m_descriptor.renderPass == VK_NULL_HANDLE)
+    {
+        beginRendering();
+        return;
     }
 
     VkRenderPassBeginInfo renderPassInfo{};
@@ -487,27 +814,67 @@ void VulkanRenderPassEncoder::beginRenderPass()
     renderPassInfo.clearValueCount = static_cast<uint32_t>(m_descriptor.clearValues.size());
     renderPassInfo.pClearValues = m_descriptor.clearValues.data();
 
-    vkAPI.CmdBeginRenderPass(vulkanCommandBuffer.getVkCommandBuffer(), &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    VkRenderPassAttachmentBeginInfo attachmentBeginInfo{ .sType = VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO };
+    if (!m_descriptor.attachments.empty())
+    {
+        attachmentBeginInfo.attachmentCount = static_cast<uint32_t>(m_descriptor.attachments.size());
+        attachmentBeginInfo.pAttachments = m_descriptor.attachments.data();
+
+        renderPassInfo.pNext = &attachmentBeginInfo;
+    }
+
+    m_recorder.cmdBeginRenderPass(&renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 }
 
 void VulkanRenderPassEncoder::endRenderPass()
 {
-    auto& vulkanCommandBuffer = downcast(m_commandBuffer);
-    auto& vulkanDevice = downcast(vulkanCommandBuffer.getDevice());
+    if (m_descriptor.renderPass == VK_NULL_HANDLE)
+        endRendering();
+    else
+        m_recorder.cmdEndRenderPass();
 
-    const auto& vkAPI = vulkanDevice.vkAPI;
-    vkAPI.CmdEndRenderPass(vulkanCommandBuffer.getVkCommandBuffer());
+    for (const auto& attachmentLayout : m_descriptor.attachmentLayouts)
+    {
+        attachmentLayout.texture->setLayout(attachmentLayout.layout);
+        m_commandBuffer.addTexture(*attachmentLayout.texture);
+    }
 
     if (m_descriptor.timestampWrites.querySet)
     {
         auto vulkanQuerySet = downcast(m_descriptor.timestampWrites.querySet);
-        vkAPI.CmdWriteTimestamp(vulkanCommandBuffer.getVkCommandBuffer(),
-                                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-                                vulkanQuerySet->getVkQueryPool(),
-                                m_descriptor.timestampWrites.endQueryIndex);
+        m_recorder.cmdWriteTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                     vulkanQuerySet->getVkQueryPool(),
+                                     m_descriptor.timestampWrites.endQueryIndex);
     }
 }
 
+void VulkanRenderPassEncoder::beginRendering()
+{
+    const auto& renderingInfo = m_descriptor.renderingInfo;
+
+    m_recorder.cmdPipelineBarrier(renderingInfo.beginBarrier);
+
+    VkRenderingInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    info.pNext = m_descriptor.next;
+    info.renderArea = m_descriptor.renderArea;
+    info.layerCount = 1;
+    info.viewMask = 0;
+    info.colorAttachmentCount = static_cast<uint32_t>(renderingInfo.colorAttachments.size());
+    info.pColorAttachments = renderingInfo.colorAttachments.data();
+    info.pDepthAttachment = renderingInfo.depthAttachment.has_value() ? &renderingInfo.depthAttachment.value() : nullptr;
+    info.pStencilAttachment = renderingInfo.stencilAttachment.has_value() ? &renderingInfo.stencilAttachment.value() : nullptr;
+
+    m_recorder.cmdBeginRendering(&info);
+}
+
+void VulkanRenderPassEncoder::endRendering()
+{
+    m_recorder.cmdEndRendering();
+
+    m_recorder.cmdPipelineBarrier(m_descriptor.renderingInfo.endBarrier);
+}
+
 // Convert Helper
 VkIndexType ToVkIndexType(IndexFormat format)
 {
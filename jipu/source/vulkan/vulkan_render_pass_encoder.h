@@ -2,24 +2,59 @@
 
 #include "jipu/render_pass_encoder.h"
 #include "vulkan_api.h"
+#include "vulkan_command_recorder.h"
 #include "vulkan_export.h"
 #include "vulkan_framebuffer.h"
+#include "vulkan_pass_encoder_state.h"
 #include "vulkan_pipeline.h"
 #include "vulkan_render_pass.h"
 
 #include "utils/cast.h"
 
+#include <array>
+#include <optional>
+#include <span>
+#include <vector>
+
 namespace jipu
 {
 
+class VulkanTexture;
+struct VulkanAttachmentLayout
+{
+    VulkanTexture* texture = nullptr;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+struct VulkanRenderingInfo
+{
+    std::vector<VkRenderingAttachmentInfo> colorAttachments{};
+    std::optional<VkRenderingAttachmentInfo> depthAttachment = std::nullopt;
+    std::optional<VkRenderingAttachmentInfo> stencilAttachment = std::nullopt;
+
+    // layout transitions which are done by render pass if not dynamic rendering.
+    // they are generated from the tracked states of the attachments, which are updated to the states after the pass.
+    VulkanPipelineBarrier beginBarrier{};
+    VulkanPipelineBarrier endBarrier{};
+};
+
 struct VulkanRenderPassEncoderDescriptor
 {
     const void* next = nullptr;
-    VkRenderPass renderPass = VK_NULL_HANDLE;
+    VkRenderPass renderPass = VK_NULL_HANDLE; // use dynamic rendering with renderingInfo if null handle.
+    uint32_t subpassCount = 1;
     VkFramebuffer framebuffer = VK_NULL_HANDLE;
     VkRect2D renderArea{};
     std::vector<VkClearValue> clearValues{};
 
+    // image views to bind at begin render pass if framebuffer is imageless.
+    std::vector<VkImageView> attachments{};
+
+    VulkanRenderingInfo renderingInfo{};
+
+    // layouts which attachments are left in after the render pass. they are set to the textures at end.
+    std::vector<VulkanAttachmentLayout> attachmentLayouts{};
+
     // TODO: convert timestampWrites for vulkan.
     QuerySet* occlusionQuerySet = nullptr;
     RenderPassTimestampWrites timestampWrites{};
@@ -29,7 +64,7 @@ class VulkanDevice;
 class VulkanRenderPass;
 class VulkanFramebuffer;
 class VulkanCommandBuffer;
-class VULKAN_EXPORT VulkanRenderPassEncoder : public RenderPassEncoder
+class VULKAN_EXPORT VulkanRenderPassEncoder final : public RenderPassEncoder
 {
 public:
     VulkanRenderPassEncoder() = delete;
@@ -38,7 +73,9 @@ public:
     ~VulkanRenderPassEncoder() override = default;
 
     void setPipeline(RenderPipeline& pipeline) override;
-    void setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::vector<uint32_t> dynamicOffset = {}) override;
+    void setBindingGroup(uint32_t index, BindingGroup& bindingGroup, std::span<const uint32_t> dynamicOffset = {}) override;
+    void setPushConstants(BindingStageFlags stages, uint32_t offset, const void* data, uint32_t size) override;
+    void pushBindings(uint32_t index, const BindingGroupDescriptor& descriptor) override;
     void setVertexBuffer(uint32_t slot, Buffer& buffer) override;
     void setIndexBuffer(Buffer& buffer, IndexFormat format) override;
     void setViewport(float x,
@@ -60,33 +97,80 @@ public:
                      uint32_t vertexOffset,
                      uint32_t firstInstance) override;
 
+    void drawIndirect(Buffer& indirectBuffer, uint64_t indirectOffset) override;
+    void drawIndexedIndirect(Buffer& indirectBuffer, uint64_t indirectOffset) override;
+    void multiDrawIndirect(Buffer& indirectBuffer,
+                           uint64_t indirectOffset,
+                           uint32_t maxDrawCount,
+                           Buffer* countBuffer = nullptr,
+                           uint64_t countBufferOffset = 0) override;
+    void multiDrawIndexedIndirect(Buffer& indirectBuffer,
+                                  uint64_t indirectOffset,
+                                  uint32_t maxDrawCount,
+                                  Buffer* countBuffer = nullptr,
+                                  uint64_t countBufferOffset = 0) override;
+
     void beginOcclusionQuery(uint32_t queryIndex) override;
     void endOcclusionQuery() override;
 
+    void nextPass() override;
     void end() override;
 
 public:
-    void nextPass();
+    const VulkanPassEncoderStatistics& getStatistics() const;
 
 private:
     void resetQuery();
     void beginRenderPass();
     void endRenderPass();
+    void beginRendering();
+    void endRendering();
+    void recordMultiDrawIndirect(VkBuffer indirectBuffer, uint64_t indirectOffset, uint32_t maxDrawCount, Buffer* countBuffer, uint64_t countBufferOffset, bool indexed);
+    void trackBufferAccesses();
+    void trackIndirectBuffer(VkBuffer buffer, uint64_t offset, uint64_t size);
 
 private:
     VulkanCommandBuffer& m_commandBuffer;
+    // cached to record commands without going through the command buffer and device.
+    VulkanCommandRecorder& m_recorder;
+    // barriers can't be recorded in a render pass. accesses in the pass are tracked for commands after it.
+    VulkanBufferTracker& m_bufferTracker;
+
     std::optional<VulkanRenderPipeline::Ref> m_pipeline = std::nullopt;
 
     uint32_t m_passIndex = 0;
 
     const VulkanRenderPassEncoderDescriptor m_descriptor{};
+
+private:
+    // shadow state to skip binding same state again. state is unknown at the beginning of a pass.
+    // binding groups are bound at draw.
+    struct IndexBufferState
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+    };
+
+    VulkanPassEncoderStatistics m_statistics{};
+
+    VkPipeline m_boundPipeline = VK_NULL_HANDLE;
+    VulkanDescriptorSetState m_descriptorSetState{ VK_PIPELINE_BIND_POINT_GRAPHICS, m_statistics };
+    VulkanBufferAccessState m_bufferAccessState{ VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT };
+    std::vector<VkBuffer> m_vertexBuffers{};
+    IndexBufferState m_indexBuffer{};
+    // dynamic states are kept across pipelines, because all pipelines are created with them.
+    std::optional<VkViewport> m_viewport = std::nullopt;
+    std::optional<VkRect2D> m_scissor = std::nullopt;
+    std::optional<std::array<float, 4>> m_blendConstants = std::nullopt;
 };
 DOWN_CAST(VulkanRenderPassEncoder, RenderPassEncoder);
 
 // Generate Helper
 VulkanRenderPassDescriptor VULKAN_EXPORT generateVulkanRenderPassDescriptor(const RenderPassEncoderDescriptor& descriptor);
 VulkanFramebufferDescriptor VULKAN_EXPORT generateVulkanFramebufferDescriptor(VulkanRenderPass& renderPass, const RenderPassEncoderDescriptor& descriptor);
-VulkanRenderPassEncoderDescriptor VULKAN_EXPORT generateVulkanRenderPassEncoderDescriptor(VulkanDevice& device, const RenderPassEncoderDescriptor& descriptor);
+VulkanFramebufferDescriptor VULKAN_EXPORT generateVulkanImagelessFramebufferDescriptor(VulkanRenderPass& renderPass, const RenderPassEncoderDescriptor& descriptor);
+VulkanRenderingInfo VULKAN_EXPORT generateVulkanRenderingInfo(const RenderPassEncoderDescriptor& descriptor);
+VulkanRenderPassEncoderDescriptor VULKAN_EXPORT generateVulkanRenderPassEncoderDescriptor(VulkanCommandBuffer& commandBuffer, const RenderPassEncoderDescriptor& descriptor);
 
 // Convert Helper
 VkIndexType ToVkIndexType(IndexFormat format);
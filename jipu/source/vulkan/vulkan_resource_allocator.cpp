@@ -113,6 +113,14 @@ void unmapResource(VmaAllocator allocator, VmaAllocation allocation)
 {
     vmaUnmapMemory(allocator, allocation);
 }
+void flushResource(VmaAllocator allocator, VmaAllocation allocation, uint64_t offset, uint64_t size)
+{
+    VkResult result = vmaFlushAllocation(allocator, allocation, offset, size);
+    if (result != VK_SUCCESS)
+    {
+        spdlog::error("Failed to flush mapped memory. error: {}", static_cast<int32_t>(result));
+    }
+}
 #else
 VulkanBufferResource createBufferResource(VulkanDevice& device, const VkBufferCreateInfo& createInfo)
 {
@@ -336,4 +344,13 @@ void VulkanResourceAllocator::unmap(VulkanAllocation allocation)
 #endif
 }
 
+void VulkanResourceAllocator::flush(VulkanAllocation allocation, uint64_t offset, uint64_t size)
+{
+#if defined(USE_VMA)
+    flushResource(m_allocator, allocation, offset, size);
+#else
+    // buffers are allocated from host coherent memory.
+#endif
+}
+
 } // namespace jipu
\ No newline at end of file
@@ -26,6 +26,8 @@ public:
 
     void* map(VulkanAllocation allocation);
     void unmap(VulkanAllocation allocation);
+    /// @brief make host writes to the mapped range visible to the device. nothing is done for host coherent memory.
+    void flush(VulkanAllocation allocation, uint64_t offset, uint64_t size);
 
 private:
     VulkanDevice& m_device;
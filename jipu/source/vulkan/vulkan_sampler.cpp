@@ -47,6 +47,7 @@ VulkanSampler::~VulkanSampler()
     auto& vulkanDevice = downcast(m_device);
     const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
 
+    vulkanDevice.getBindingGroupCache().invalidate(m_sampler);
     vkAPI.DestroySampler(vulkanDevice.getVkDevice(), m_sampler, nullptr);
 }
 
@@ -9,7 +9,7 @@ namespace jipu
 {
 
 class VulkanDevice;
-class VULKAN_EXPORT VulkanSampler : public Sampler
+class VULKAN_EXPORT VulkanSampler final : public Sampler
 {
 public:
     VulkanSampler() = delete;
@@ -25,6 +25,7 @@ VulkanShaderModule::VulkanShaderModule(VulkanDevice& device, const ShaderModuleD
 VulkanShaderModule::~VulkanShaderModule()
 {
     auto& vulkanDevice = downcast(m_device);
+    vulkanDevice.getPipelineLibraryCache().invalidateShaderModule(m_shaderModule);
     vulkanDevice.vkAPI.DestroyShaderModule(vulkanDevice.getVkDevice(), m_shaderModule, nullptr);
 }
 
@@ -10,7 +10,7 @@ namespace jipu
 {
 
 class VulkanDevice;
-class VULKAN_EXPORT VulkanShaderModule : public ShaderModule
+class VULKAN_EXPORT VulkanShaderModule final : public ShaderModule
 {
 public:
     VulkanShaderModule() = delete;
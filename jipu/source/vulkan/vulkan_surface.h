@@ -41,7 +41,7 @@ struct VulkanSurfaceDescriptor
 };
 
 class VulkanInstance;
-class VULKAN_EXPORT VulkanSurface : public Surface
+class VULKAN_EXPORT VulkanSurface final : public Surface
 {
 public:
     VulkanSurface() = delete;
@@ -253,6 +253,7 @@ void VulkanSwapchain::present(Queue& queue)
     presentInfo.pImageIndices = &m_acquiredImageIndex;
     presentInfo.pResults = nullptr; // Optional
 
+    std::lock_guard<std::mutex> lock(vulkanDevice.getQueueMutex());
     vkAPI.QueuePresentKHR(vulkanQueue.getVkQueue(), &presentInfo);
 }
 
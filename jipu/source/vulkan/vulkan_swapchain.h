@@ -40,7 +40,7 @@ struct VulkanSwapchainDescriptor
     VkSwapchainKHR oldSwapchain;
 };
 
-class VULKAN_EXPORT VulkanSwapchain : public Swapchain
+class VULKAN_EXPORT VulkanSwapchain final : public Swapchain
 {
 public:
     VulkanSwapchain() = delete;
@@ -1,8 +1,10 @@
 #include "vulkan_texture.h"
 #include "vulkan_command_buffer.h"
 #include "vulkan_device.h"
+#include "vulkan_physical_device.h"
 #include "vulkan_resource_allocator.h"
 
+#include <algorithm>
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
@@ -10,6 +12,87 @@
 namespace jipu
 {
 
+namespace
+{
+
+constexpr VkAccessFlags kWriteAccessMask = VK_ACCESS_SHADER_WRITE_BIT |
+                                           VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                           VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                           VK_ACCESS_TRANSFER_WRITE_BIT |
+                                           VK_ACCESS_HOST_WRITE_BIT |
+                                           VK_ACCESS_MEMORY_WRITE_BIT;
+
+bool isSameTransition(const VkImageMemoryBarrier& lhs, const VkImageMemoryBarrier& rhs)
+{
+    return lhs.image == rhs.image &&
+           lhs.oldLayout == rhs.oldLayout &&
+           lhs.newLayout == rhs.newLayout &&
+           lhs.srcAccessMask == rhs.srcAccessMask &&
+           lhs.dstAccessMask == rhs.dstAccessMask &&
+           lhs.subresourceRange.aspectMask == rhs.subresourceRange.aspectMask;
+}
+
+bool isNextLayer(const VkImageSubresourceRange& lhs, const VkImageSubresourceRange& rhs)
+{
+    return lhs.baseMipLevel == rhs.baseMipLevel && lhs.levelCount == rhs.levelCount && lhs.baseArrayLayer + lhs.layerCount == rhs.baseArrayLayer;
+}
+
+// merge into the barrier for the previous mip level in the same layer.
+void addImageMemoryBarrier(VulkanPipelineBarrier& barrier, const VkImageMemoryBarrier& imageMemoryBarrier)
+{
+    auto& barriers = barrier.imageMemoryBarriers;
+    if (!barriers.empty() && isSameTransition(barriers.back(), imageMemoryBarrier))
+    {
+        auto& lastRange = barriers.back().subresourceRange;
+        const auto& range = imageMemoryBarrier.subresourceRange;
+        if (lastRange.layerCount == 1 && lastRange.baseArrayLayer == range.baseArrayLayer && lastRange.baseMipLevel + lastRange.levelCount == range.baseMipLevel)
+        {
+            lastRange.levelCount += range.levelCount;
+            return;
+        }
+    }
+
+    barriers.push_back(imageMemoryBarrier);
+}
+
+// merge the last barrier into the barrier for the same mip levels in the previous layer.
+void mergeLastLayer(VulkanPipelineBarrier& barrier, size_t first)
+{
+    auto& barriers = barrier.imageMemoryBarriers;
+    if (barriers.size() < first + 2)
+        return;
+
+    const auto& last = barriers.back();
+    for (size_t i = barriers.size() - 1; i-- > first;)
+    {
+        if (isSameTransition(barriers[i], last) && isNextLayer(barriers[i].subresourceRange, last.subresourceRange))
+        {
+            barriers[i].subresourceRange.layerCount += last.subresourceRange.layerCount;
+            barriers.pop_back();
+            return;
+        }
+    }
+}
+
+// sRGB formats don't support storage images in general. such images are created to be written through unorm views.
+VulkanTextureDescriptor generateVulkanTextureDescriptor(VulkanDevice& device, const TextureDescriptor& descriptor)
+{
+    VulkanTextureDescriptor vkdescriptor = jipu::generateVulkanTextureDescriptor(descriptor);
+
+    auto& physicalDevice = device.getPhysicalDevice();
+    if ((vkdescriptor.usage & VK_IMAGE_USAGE_STORAGE_BIT) &&
+        ToStorageVkFormat(vkdescriptor.format) != vkdescriptor.format &&
+        physicalDevice.getVulkanPhysicalDeviceInfo().imageExtendedUsage &&
+        !physicalDevice.isFormatFeatureSupported(vkdescriptor.format, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT))
+    {
+        vkdescriptor.flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+    }
+
+    return vkdescriptor;
+}
+
+} // namespace
+
 VulkanTextureDescriptor generateVulkanTextureDescriptor(const TextureDescriptor& descriptor)
 {
     VulkanTextureDescriptor vkdescriptor{};
@@ -17,9 +100,17 @@ VulkanTextureDescriptor generateVulkanTextureDescriptor(const TextureDescriptor&
     vkdescriptor.imageType = ToVkImageType(descriptor.type);
     vkdescriptor.extent.width = descriptor.width;
     vkdescriptor.extent.height = descriptor.height;
-    vkdescriptor.extent.depth = descriptor.depth;
     vkdescriptor.mipLevels = descriptor.mipLevels;
-    vkdescriptor.arrayLayers = 1;
+    if (descriptor.type == TextureType::k3D)
+    {
+        vkdescriptor.extent.depth = descriptor.depth;
+        vkdescriptor.arrayLayers = 1;
+    }
+    else
+    {
+        vkdescriptor.extent.depth = 1;
+        vkdescriptor.arrayLayers = descriptor.depth;
+    }
     vkdescriptor.format = ToVkFormat(descriptor.format);
     vkdescriptor.tiling = VK_IMAGE_TILING_OPTIMAL;
     vkdescriptor.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -32,7 +123,7 @@ VulkanTextureDescriptor generateVulkanTextureDescriptor(const TextureDescriptor&
 }
 
 VulkanTexture::VulkanTexture(VulkanDevice& device, const TextureDescriptor& descriptor)
-    : VulkanTexture(device, generateVulkanTextureDescriptor(descriptor))
+    : VulkanTexture(device, generateVulkanTextureDescriptor(device, descriptor))
 {
 }
 
@@ -40,7 +131,7 @@ VulkanTexture::VulkanTexture(VulkanDevice& device, const VulkanTextureDescriptor
     : m_device(device)
     , m_descriptor(descriptor)
 {
-    if (m_descriptor.extent.width == 0 || m_descriptor.extent.height == 0 || m_descriptor.extent.depth == 0)
+    if (m_descriptor.extent.width == 0 || m_descriptor.extent.height == 0 || m_descriptor.extent.depth == 0 || m_descriptor.arrayLayers == 0)
     {
         throw std::runtime_error("Texture size must be greater than 0.");
     }
@@ -83,10 +174,18 @@ VulkanTexture::VulkanTexture(VulkanDevice& device, const VulkanTextureDescriptor
         m_resource.image = m_descriptor.image;
         m_owner = VulkanTextureOwner::Swapchain;
     }
+
+    VulkanTextureSubresourceState state{};
+    state.layout = m_descriptor.initialLayout;
+    m_subresourceStates.resize(m_descriptor.mipLevels * m_descriptor.arrayLayers, state);
+    m_definedSubresources.resize(m_subresourceStates.size(), state.layout != VK_IMAGE_LAYOUT_UNDEFINED);
 }
 
 VulkanTexture::~VulkanTexture()
 {
+    // views and descriptors for mipmap generation reference the image.
+    m_device.getMipmapGenerator().invalidate(getVkImage());
+
     if (m_owner == VulkanTextureOwner::User)
     {
         auto& vulkanResourceAllocator = downcast(m_device).getResourceAllocator();
@@ -126,7 +225,10 @@ uint32_t VulkanTexture::getHeight() const
 
 uint32_t VulkanTexture::getDepth() const
 {
-    return m_descriptor.extent.depth;
+    if (m_descriptor.imageType == VK_IMAGE_TYPE_3D)
+        return m_descriptor.extent.depth;
+
+    return m_descriptor.arrayLayers;
 }
 
 uint32_t VulkanTexture::getMipLevels() const
@@ -149,45 +251,203 @@ VkImage VulkanTexture::getVkImage() const
     return m_resource.image;
 }
 
-void VulkanTexture::setPipelineBarrier(VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageSubresourceRange range)
+VkImageCreateFlags VulkanTexture::getVkImageCreateFlags() const
 {
-    if (commandBuffer == VK_NULL_HANDLE)
-        throw std::runtime_error("Command buffer is null handle to set pipeline barrier in texture.");
+    return m_descriptor.flags;
+}
 
-    if (oldLayout == newLayout)
+VkImageUsageFlags VulkanTexture::getVkImageUsageFlags() const
+{
+    return m_descriptor.usage;
+}
+
+void VulkanTexture::transitionLayout(VulkanPipelineBarrier& barrier,
+                                     const VkImageSubresourceRange& range,
+                                     VkImageLayout layout,
+                                     VkPipelineStageFlags stageMask,
+                                     VkAccessFlags accessMask)
+{
+    const uint32_t levelCount = range.levelCount == VK_REMAINING_MIP_LEVELS ? m_descriptor.mipLevels - range.baseMipLevel : range.levelCount;
+    const uint32_t layerCount = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? m_descriptor.arrayLayers - range.baseArrayLayer : range.layerCount;
+
+    if (range.baseMipLevel + levelCount > m_descriptor.mipLevels || range.baseArrayLayer + layerCount > m_descriptor.arrayLayers)
     {
-        spdlog::debug("old layout and new layout are same.");
-        return;
+        throw std::runtime_error(fmt::format("The subresource range [mip {}-{}, layer {}-{}] is out of the texture.",
+                                             range.baseMipLevel,
+                                             range.baseMipLevel + levelCount,
+                                             range.baseArrayLayer,
+                                             range.baseArrayLayer + layerCount));
+    }
+
+    const size_t first = barrier.imageMemoryBarriers.size();
+    for (uint32_t arrayLayer = range.baseArrayLayer; arrayLayer < range.baseArrayLayer + layerCount; ++arrayLayer)
+    {
+        for (uint32_t mipLevel = range.baseMipLevel; mipLevel < range.baseMipLevel + levelCount; ++mipLevel)
+        {
+            transitionSubresource(barrier, mipLevel, arrayLayer, range.aspectMask, layout, stageMask, accessMask);
+        }
+        mergeLastLayer(barrier, first);
+    }
+}
+
+void VulkanTexture::transitionToFinalLayout(VulkanPipelineBarrier& barrier)
+{
+    const VkImageLayout finalLayout = getFinalLayout();
+    const VkImageAspectFlags aspectMask = GenerateImageAspectFlags(m_descriptor.format);
+
+    const size_t first = barrier.imageMemoryBarriers.size();
+    for (uint32_t arrayLayer = 0; arrayLayer < m_descriptor.arrayLayers; ++arrayLayer)
+    {
+        for (uint32_t mipLevel = 0; mipLevel < m_descriptor.mipLevels; ++mipLevel)
+        {
+            // keep the last access. it is synchronized by the next transition.
+            if (getSubresourceState(mipLevel, arrayLayer).layout == finalLayout)
+                continue;
+
+            transitionSubresource(barrier,
+                                  mipLevel,
+                                  arrayLayer,
+                                  aspectMask,
+                                  finalLayout,
+                                  GenerateSrcPipelineStage(finalLayout),
+                                  GenerateAccessFlags(finalLayout));
+        }
+        mergeLastLayer(barrier, first);
     }
+}
+
+void VulkanTexture::transitionUpload(VulkanPipelineBarrier& preBarrier, VulkanPipelineBarrier& postBarrier, const VkImageSubresourceRange& range)
+{
+    const VkImageLayout finalLayout = getFinalLayout();
+    const VkPipelineStageFlags finalStageMask = GenerateSrcPipelineStage(finalLayout);
+    const VkAccessFlags finalAccessMask = GenerateAccessFlags(finalLayout);
+
+    const size_t preFirst = preBarrier.imageMemoryBarriers.size();
+    const size_t postFirst = postBarrier.imageMemoryBarriers.size();
+    for (uint32_t arrayLayer = range.baseArrayLayer; arrayLayer < range.baseArrayLayer + range.layerCount; ++arrayLayer)
+    {
+        for (uint32_t mipLevel = range.baseMipLevel; mipLevel < range.baseMipLevel + range.levelCount; ++mipLevel)
+        {
+            // command buffers which are recorded but not submitted yet are executed after the upload.
+            const size_t index = arrayLayer * m_descriptor.mipLevels + mipLevel;
+            const bool undefined = !m_definedSubresources[index];
+            m_definedSubresources[index] = true;
+
+            VkImageMemoryBarrier imageMemoryBarrier{};
+            imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            imageMemoryBarrier.srcAccessMask = undefined ? 0u : finalAccessMask;
+            imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            imageMemoryBarrier.oldLayout = undefined ? VK_IMAGE_LAYOUT_UNDEFINED : finalLayout;
+            imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageMemoryBarrier.image = m_resource.image;
+            imageMemoryBarrier.subresourceRange.aspectMask = range.aspectMask;
+            imageMemoryBarrier.subresourceRange.baseMipLevel = mipLevel;
+            imageMemoryBarrier.subresourceRange.levelCount = 1;
+            imageMemoryBarrier.subresourceRange.baseArrayLayer = arrayLayer;
+            imageMemoryBarrier.subresourceRange.layerCount = 1;
+            addImageMemoryBarrier(preBarrier, imageMemoryBarrier);
+
+            imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            imageMemoryBarrier.dstAccessMask = finalAccessMask;
+            imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            imageMemoryBarrier.newLayout = finalLayout;
+            addImageMemoryBarrier(postBarrier, imageMemoryBarrier);
+
+            // command buffers which are recorded later must keep the uploaded contents.
+            auto& state = getSubresourceState(mipLevel, arrayLayer);
+            if (state.layout == VK_IMAGE_LAYOUT_UNDEFINED)
+                state = { .layout = finalLayout, .stageMask = finalStageMask, .accessMask = finalAccessMask };
+        }
+        mergeLastLayer(preBarrier, preFirst);
+        mergeLastLayer(postBarrier, postFirst);
+    }
+
+    preBarrier.srcStageMask |= finalStageMask;
+    preBarrier.dstStageMask |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    postBarrier.srcStageMask |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    postBarrier.dstStageMask |= finalStageMask;
+}
+
+void VulkanTexture::markSubmitted()
+{
+    std::fill(m_definedSubresources.begin(), m_definedSubresources.end(), true);
+}
 
-    auto& vulkanDevice = downcast(m_device);
-    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
+void VulkanTexture::setLayout(VkImageLayout layout)
+{
+    for (auto& state : m_subresourceStates)
+    {
+        state.layout = layout;
+        state.stageMask = GenerateSrcPipelineStage(layout);
+        state.accessMask = GenerateAccessFlags(layout);
+    }
+}
 
-    // set Image Memory Barrier
-    VkImageMemoryBarrier barrier{};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.pNext = VK_NULL_HANDLE;
-    barrier.srcAccessMask = GenerateAccessFlags(oldLayout);
-    barrier.dstAccessMask = GenerateAccessFlags(newLayout);
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.oldLayout = oldLayout;
-    barrier.newLayout = newLayout;
-    barrier.image = m_resource.image;
-    barrier.subresourceRange = range;
+VkImageLayout VulkanTexture::getLayout(uint32_t mipLevel, uint32_t arrayLayer) const
+{
+    return m_subresourceStates[arrayLayer * m_descriptor.mipLevels + mipLevel].layout;
+}
 
-    VkPipelineStageFlags srcStage = GenerateSrcPipelineStage(oldLayout);
-    VkPipelineStageFlags dstStage = GenerateDstPipelineStage(newLayout);
+VkImageSubresourceRange VulkanTexture::getSubresourceRange() const
+{
+    VkImageSubresourceRange range{};
+    range.aspectMask = GenerateImageAspectFlags(m_descriptor.format);
+    range.baseMipLevel = 0;
+    range.levelCount = m_descriptor.mipLevels;
+    range.baseArrayLayer = 0;
+    range.layerCount = m_descriptor.arrayLayers;
+
+    return range;
+}
 
-    setPipelineBarrier(commandBuffer, srcStage, dstStage, barrier);
+VulkanTextureSubresourceState& VulkanTexture::getSubresourceState(uint32_t mipLevel, uint32_t arrayLayer)
+{
+    return m_subresourceStates[arrayLayer * m_descriptor.mipLevels + mipLevel];
 }
 
-void VulkanTexture::setPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, VkImageMemoryBarrier barrier)
+void VulkanTexture::transitionSubresource(VulkanPipelineBarrier& barrier,
+                                          uint32_t mipLevel,
+                                          uint32_t arrayLayer,
+                                          VkImageAspectFlags aspectMask,
+                                          VkImageLayout layout,
+                                          VkPipelineStageFlags stageMask,
+                                          VkAccessFlags accessMask)
 {
-    auto& vulkanDevice = downcast(m_device);
-    const VulkanAPI& vkAPI = vulkanDevice.vkAPI;
+    auto& state = getSubresourceState(mipLevel, arrayLayer);
+
+    // read after read in the same layout doesn't need a barrier.
+    if (state.layout == layout && !(state.accessMask & kWriteAccessMask) && !(accessMask & kWriteAccessMask))
+    {
+        state.stageMask |= stageMask;
+        state.accessMask |= accessMask;
+        return;
+    }
 
-    vkAPI.CmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    VkImageMemoryBarrier imageMemoryBarrier{};
+    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.srcAccessMask = state.accessMask;
+    imageMemoryBarrier.dstAccessMask = accessMask;
+    imageMemoryBarrier.oldLayout = state.layout;
+    imageMemoryBarrier.newLayout = layout;
+    imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image = m_resource.image;
+    imageMemoryBarrier.subresourceRange.aspectMask = aspectMask;
+    imageMemoryBarrier.subresourceRange.baseMipLevel = mipLevel;
+    imageMemoryBarrier.subresourceRange.levelCount = 1;
+    imageMemoryBarrier.subresourceRange.baseArrayLayer = arrayLayer;
+    imageMemoryBarrier.subresourceRange.layerCount = 1;
+
+    addImageMemoryBarrier(barrier, imageMemoryBarrier);
+
+    barrier.srcStageMask |= state.stageMask != 0u ? state.stageMask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    barrier.dstStageMask |= stageMask;
+
+    state.layout = layout;
+    state.stageMask = stageMask;
+    state.accessMask = accessMask;
 }
 
 VkImageLayout VulkanTexture::getFinalLayout() const
@@ -231,6 +491,21 @@ VkFormat ToVkFormat(TextureFormat format)
     }
 }
 
+VkFormat ToStorageVkFormat(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        return VK_FORMAT_B8G8R8A8_UNORM;
+    case VK_FORMAT_R8G8B8_SRGB:
+        return VK_FORMAT_R8G8B8_UNORM;
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    default:
+        return format;
+    }
+}
+
 TextureFormat ToTextureFormat(VkFormat format)
 {
     switch (format)
@@ -316,6 +591,10 @@ TextureUsageFlags ToTextureUsageFlags(VkImageUsageFlags usages)
     {
         flags |= TextureUsageFlagBits::kColorAttachment;
     }
+    if (usages & VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT)
+    {
+        flags |= TextureUsageFlagBits::kInputAttachment;
+    }
 
     return flags;
 }
@@ -348,6 +627,10 @@ VkImageUsageFlags ToVkImageUsageFlags(TextureUsageFlags usages)
     {
         flags |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     }
+    if (usages & TextureUsageFlagBits::kInputAttachment)
+    {
+        flags |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    }
 
     return flags;
 }
@@ -399,6 +682,36 @@ VkImageLayout GenerateFinalImageLayout(VkImageUsageFlags usage)
     return VK_IMAGE_LAYOUT_UNDEFINED;
 }
 
+VkImageAspectFlags GenerateImageAspectFlags(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+uint32_t GenerateTexelBlockSize(VkFormat format, VkImageAspectFlags aspect)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R8G8B8_UNORM:
+    case VK_FORMAT_R8G8B8_SRGB:
+        return 3;
+    case VK_FORMAT_R16G16B16A16_UNORM:
+        return 8;
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+        // depth is copied as 32 bits, and stencil is copied as 8 bits.
+        return aspect == VK_IMAGE_ASPECT_STENCIL_BIT ? 1 : 4;
+    default:
+        return 4;
+    }
+}
+
 // VkImageLayout GenerateFinalImageLayout(TextureUsageFlags usage)
 // {
 //     if (usage & TextureUsageFlagBits::kTextureBinding)
@@ -448,6 +761,12 @@ VkAccessFlags GenerateAccessFlags(VkImageLayout layout)
     case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
         accessFlags = VK_ACCESS_SHADER_READ_BIT;
         break;
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        accessFlags = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        accessFlags = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        break;
     }
 
     return accessFlags;
@@ -470,6 +789,12 @@ VkPipelineStageFlags GenerateSrcPipelineStage(VkImageLayout layout)
     case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
         pipelineStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
         break;
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        pipelineStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        pipelineStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        break;
     }
 
     return pipelineStage;
@@ -492,6 +817,12 @@ VkPipelineStageFlags GenerateDstPipelineStage(VkImageLayout layout)
     case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
         pipelineStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
         break;
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        pipelineStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+        pipelineStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        break;
     }
 
     return pipelineStage;
@@ -34,8 +34,17 @@ struct VulkanTextureDescriptor
     VkImage image = VK_NULL_HANDLE;
 };
 
+struct VulkanTextureSubresourceState
+{
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // stages and accesses after the last barrier. reads in the same layout are accumulated.
+    VkPipelineStageFlags stageMask = 0u;
+    VkAccessFlags accessMask = 0u;
+};
+
+struct VulkanPipelineBarrier;
 class VulkanDevice;
-class VULKAN_EXPORT VulkanTexture : public Texture
+class VULKAN_EXPORT VulkanTexture final : public Texture
 {
 public:
     VulkanTexture() = delete;
@@ -60,10 +69,29 @@ public:
 
 public:
     VkImage getVkImage() const;
-
-    /// @brief record pipeline barrier command, but not submitted.
-    void setPipelineBarrier(VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageSubresourceRange range);
-    void setPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, VkImageMemoryBarrier barrier);
+    VkImageCreateFlags getVkImageCreateFlags() const;
+    VkImageUsageFlags getVkImageUsageFlags() const;
+
+    /// @brief add barriers to transition the subresources from their tracked states, and update the states.
+    /// the barriers are merged for adjacent subresources, and nothing is added for read after read in the same layout.
+    void transitionLayout(VulkanPipelineBarrier& barrier,
+                          const VkImageSubresourceRange& range,
+                          VkImageLayout layout,
+                          VkPipelineStageFlags stageMask,
+                          VkAccessFlags accessMask);
+    /// @brief add barriers to transition the subresources which are not in the final layout.
+    void transitionToFinalLayout(VulkanPipelineBarrier& barrier);
+    /// @brief add barriers around copies which are submitted between command buffers. subresources are in the final layout there,
+    /// or undefined if no submitted command buffer or upload has used them. tracked states are not changed, except that undefined subresources are in the final layout.
+    void transitionUpload(VulkanPipelineBarrier& preBarrier, VulkanPipelineBarrier& postBarrier, const VkImageSubresourceRange& range);
+    /// @brief a command buffer which uses the texture is submitted. it leaves all subresources in the final layout.
+    void markSubmitted();
+    /// @brief update the tracked states without barriers. ex) render pass transitions attachments by itself.
+    void setLayout(VkImageLayout layout);
+    VkImageLayout getLayout(uint32_t mipLevel, uint32_t arrayLayer) const;
+
+    /// @brief all mip levels and array layers of the texture.
+    VkImageSubresourceRange getSubresourceRange() const;
 
     /// @brief generate final layout by usage.
     /// @return VKImageLayout
@@ -80,9 +108,24 @@ private:
         Swapchain
     };
 
+private:
+    VulkanTextureSubresourceState& getSubresourceState(uint32_t mipLevel, uint32_t arrayLayer);
+    void transitionSubresource(VulkanPipelineBarrier& barrier,
+                               uint32_t mipLevel,
+                               uint32_t arrayLayer,
+                               VkImageAspectFlags aspectMask,
+                               VkImageLayout layout,
+                               VkPipelineStageFlags stageMask,
+                               VkAccessFlags accessMask);
+
 private:
     VulkanTextureResource m_resource;
     VulkanTextureOwner m_owner;
+
+    // states per (mip level, array layer) in recording order. command buffers must be submitted in the order they are recorded.
+    std::vector<VulkanTextureSubresourceState> m_subresourceStates{};
+    // subresources which are not undefined per (mip level, array layer) in submission order. uploads are submitted between command buffers.
+    std::vector<bool> m_definedSubresources{};
 };
 
 DOWN_CAST(VulkanTexture, Texture);
@@ -92,6 +135,8 @@ VulkanTextureDescriptor VULKAN_EXPORT generateVulkanTextureDescriptor(const Text
 
 // Convert Helper
 VkFormat VULKAN_EXPORT ToVkFormat(TextureFormat format);
+/// @brief unorm format of a sRGB format, which storage images are written through. same format for others.
+VkFormat ToStorageVkFormat(VkFormat format);
 TextureFormat ToTextureFormat(VkFormat format);
 VkImageType ToVkImageType(TextureType type);
 TextureType ToTextureType(VkImageType type);
@@ -102,6 +147,9 @@ uint32_t ToSampleCount(VkSampleCountFlagBits flag);
 
 // Utils
 VkImageLayout GenerateFinalImageLayout(VkImageUsageFlags usage);
+VkImageAspectFlags GenerateImageAspectFlags(VkFormat format);
+/// @brief bytes of a texel of the aspect in buffers which are copied from or to images.
+uint32_t GenerateTexelBlockSize(VkFormat format, VkImageAspectFlags aspect);
 // VkImageLayout GenerateFinalImageLayout(TextureUsageFlags usage);
 VkAccessFlags GenerateAccessFlags(VkImageLayout layout);
 VkPipelineStageFlags GenerateSrcPipelineStage(VkImageLayout layout);
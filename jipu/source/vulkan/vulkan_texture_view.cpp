@@ -1,5 +1,6 @@
 #include "vulkan_texture_view.h"
 #include "vulkan_device.h"
+#include "vulkan_physical_device.h"
 #include "vulkan_texture.h"
 
 #include <stdexcept>
@@ -11,6 +12,12 @@ VulkanTextureView::VulkanTextureView(VulkanTexture& texture, const TextureViewDe
     : m_texture(texture)
     , m_descriptor(descriptor)
 {
+    if (descriptor.baseMipLevel >= texture.getMipLevels() || descriptor.baseMipLevel + descriptor.mipLevelCount > texture.getMipLevels())
+        throw std::runtime_error(fmt::format("The mip levels [{}, {}) of the view are out of {} mip levels.",
+                                             descriptor.baseMipLevel,
+                                             descriptor.baseMipLevel + descriptor.mipLevelCount,
+                                             texture.getMipLevels()));
+
     VkImageViewCreateInfo imageViewCreateInfo{};
     imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     imageViewCreateInfo.image = texture.getVkImage();
@@ -23,12 +30,25 @@ VulkanTextureView::VulkanTextureView(VulkanTexture& texture, const TextureViewDe
     imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 
     imageViewCreateInfo.subresourceRange.aspectMask = ToVkImageAspectFlags(descriptor.aspect);
-    imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-    imageViewCreateInfo.subresourceRange.levelCount = texture.getMipLevels();
+    imageViewCreateInfo.subresourceRange.baseMipLevel = descriptor.baseMipLevel;
+    imageViewCreateInfo.subresourceRange.levelCount = descriptor.mipLevelCount == 0 ? texture.getMipLevels() - descriptor.baseMipLevel : descriptor.mipLevelCount;
     imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
     imageViewCreateInfo.subresourceRange.layerCount = 1;
 
+    m_format = imageViewCreateInfo.format;
+    m_subresourceRange = imageViewCreateInfo.subresourceRange;
+
     auto& vulkanDevice = downcast(m_texture.getDevice());
+
+    // the storage usage of an image of extended usage is for views of the other format. e.g. unorm views of sRGB images.
+    VkImageViewUsageCreateInfo imageViewUsageCreateInfo{};
+    if ((texture.getVkImageCreateFlags() & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT) &&
+        !vulkanDevice.getPhysicalDevice().isFormatFeatureSupported(imageViewCreateInfo.format, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT))
+    {
+        imageViewUsageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+        imageViewUsageCreateInfo.usage = texture.getVkImageUsageFlags() & ~VK_IMAGE_USAGE_STORAGE_BIT;
+        imageViewCreateInfo.pNext = &imageViewUsageCreateInfo;
+    }
     if (vulkanDevice.vkAPI.CreateImageView(vulkanDevice.getVkDevice(), &imageViewCreateInfo, nullptr, &m_imageView) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create image views!");
@@ -38,6 +58,10 @@ VulkanTextureView::VulkanTextureView(VulkanTexture& texture, const TextureViewDe
 VulkanTextureView::~VulkanTextureView()
 {
     auto& vulkanDevice = downcast(m_texture.getDevice());
+
+    // framebuffers must not outlive their attachments. it also prevents stale hit by recycled handle.
+    vulkanDevice.getFrameBufferCache().invalidate(m_imageView);
+    vulkanDevice.getBindingGroupCache().invalidate(m_imageView);
     vulkanDevice.vkAPI.DestroyImageView(vulkanDevice.getVkDevice(), m_imageView, nullptr);
 }
 
@@ -76,6 +100,21 @@ VkImageView VulkanTextureView::getVkImageView() const
     return m_imageView;
 }
 
+VkFormat VulkanTextureView::getVkFormat() const
+{
+    return m_format;
+}
+
+uint32_t VulkanTextureView::getLayerCount() const
+{
+    return m_subresourceRange.layerCount;
+}
+
+const VkImageSubresourceRange& VulkanTextureView::getVkImageSubresourceRange() const
+{
+    return m_subresourceRange;
+}
+
 // Convert Helper
 
 VkImageViewType ToVkImageViewType(TextureViewType type)
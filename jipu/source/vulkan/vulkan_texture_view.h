@@ -9,7 +9,7 @@ namespace jipu
 {
 
 class VulkanTexture;
-class VULKAN_EXPORT VulkanTextureView : public TextureView
+class VULKAN_EXPORT VulkanTextureView final : public TextureView
 {
 public:
     VulkanTextureView() = delete;
@@ -26,6 +26,10 @@ public:
 
 public:
     VkImageView getVkImageView() const;
+    VkFormat getVkFormat() const;
+    uint32_t getLayerCount() const;
+    /// @brief mip levels and array layers of the texture which the view covers.
+    const VkImageSubresourceRange& getVkImageSubresourceRange() const;
 
 private:
     VulkanTexture& m_texture;
@@ -33,6 +37,8 @@ private:
 
 private:
     VkImageView m_imageView = VK_NULL_HANDLE;
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    VkImageSubresourceRange m_subresourceRange{};
 };
 
 DOWN_CAST(VulkanTextureView, TextureView);
@@ -0,0 +1,814 @@
+#include "vulkan_upload_manager.h"
+#include "vulkan_buffer.h"
+#include "vulkan_device.h"
+#include "vulkan_physical_device.h"
+#include "vulkan_texture.h"
+#include "vulkan_texture_view.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <utility>
+
+namespace jipu
+{
+
+namespace
+{
+
+// accesses which are supported by transfer only queue families.
+constexpr VkAccessFlags kTransferAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// index of the first queue family which has all of the flags and none of the excluded flags. -1 if there is not.
+int32_t findQueueFamilyIndex(const std::vector<VkQueueFamilyProperties>& properties, VkQueueFlags flags, VkQueueFlags excludedFlags)
+{
+    for (uint32_t index = 0; index < properties.size(); ++index)
+    {
+        const VkQueueFlags queueFlags = properties[index].queueFlags;
+        if ((queueFlags & flags) == flags && !(queueFlags & excludedFlags))
+            return static_cast<int32_t>(index);
+    }
+
+    return -1;
+}
+
+// all device local memory is host visible on unified memory architectures.
+bool isUnifiedMemoryArchitecture(const std::vector<VkMemoryType>& memoryTypes)
+{
+    bool deviceLocal = false;
+    for (const auto& memoryType : memoryTypes)
+    {
+        if (!(memoryType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+            continue;
+
+        if (!(memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+            return false;
+
+        deviceLocal = true;
+    }
+
+    return deviceLocal;
+}
+
+bool overlaps(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b)
+{
+    return a.baseMipLevel < b.baseMipLevel + b.levelCount && b.baseMipLevel < a.baseMipLevel + a.levelCount &&
+           a.baseArrayLayer < b.baseArrayLayer + b.layerCount && b.baseArrayLayer < a.baseArrayLayer + a.layerCount;
+}
+
+bool overlaps(const VkBufferCopy& a, const VkBufferCopy& b)
+{
+    return a.dstOffset < b.dstOffset + b.size && b.dstOffset < a.dstOffset + a.size;
+}
+
+VkCommandPool createCommandPool(VulkanDevice& device, uint32_t queueFamilyIndex)
+{
+    VkCommandPoolCreateInfo commandPoolCreateInfo{};
+    commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+    commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    if (device.vkAPI.CreateCommandPool(device.getVkDevice(), &commandPoolCreateInfo, nullptr, &commandPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create command pool for uploads.");
+    }
+
+    return commandPool;
+}
+
+// queues of the device are shared with VulkanQueue, so submissions are made under the queue mutex of the device.
+void submitCommandBuffer(VulkanDevice& device,
+                         VkQueue queue,
+                         VkCommandBuffer commandBuffer,
+                         const std::vector<VkSemaphore>& waitSemaphores,
+                         const std::vector<VkPipelineStageFlags>& waitStages,
+                         VkSemaphore signalSemaphore,
+                         VkFence fence)
+{
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.signalSemaphoreCount = signalSemaphore != VK_NULL_HANDLE ? 1 : 0;
+    submitInfo.pSignalSemaphores = &signalSemaphore;
+
+    std::lock_guard<std::mutex> lock(device.getQueueMutex());
+    VkResult result = device.vkAPI.QueueSubmit(queue, 1, &submitInfo, fence);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error(fmt::format("failed to submit uploads {}", static_cast<uint32_t>(result)));
+    }
+}
+
+} // namespace
+
+VulkanUploadManager::VulkanUploadManager(VulkanDevice& device, const VulkanUploadManagerDescriptor& descriptor)
+    : m_device(device)
+    , m_descriptor(descriptor)
+{
+    const VulkanPhysicalDeviceInfo& info = device.getPhysicalDevice().getVulkanPhysicalDeviceInfo();
+
+    // the device creates queues for the families which support graphics and compute, and for a transfer only family.
+    const int32_t graphicsQueueFamilyIndex = findQueueFamilyIndex(info.queueFamilyProperties, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, 0);
+    if (graphicsQueueFamilyIndex < 0)
+    {
+        throw std::runtime_error("There is no queue family for graphics.");
+    }
+    m_graphicsQueueFamilyIndex = static_cast<uint32_t>(graphicsQueueFamilyIndex);
+    m_queueFamilyIndex = m_graphicsQueueFamilyIndex;
+
+    if (descriptor.useTransferQueue)
+    {
+        const int32_t transferQueueFamilyIndex = findQueueFamilyIndex(info.queueFamilyProperties, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+        if (transferQueueFamilyIndex >= 0)
+        {
+            // copies of any region are allowed only if the granularity is a texel.
+            const VkExtent3D& granularity = info.queueFamilyProperties[transferQueueFamilyIndex].minImageTransferGranularity;
+            if (granularity.width == 1 && granularity.height == 1 && granularity.depth == 1)
+                m_queueFamilyIndex = static_cast<uint32_t>(transferQueueFamilyIndex);
+        }
+    }
+
+    m_graphicsQueue = device.getVkQueue(m_graphicsQueueFamilyIndex);
+    m_queue = device.getVkQueue(m_queueFamilyIndex);
+
+    m_commandPool = createCommandPool(device, m_queueFamilyIndex);
+    if (m_queueFamilyIndex != m_graphicsQueueFamilyIndex)
+        m_graphicsCommandPool = createCommandPool(device, m_graphicsQueueFamilyIndex);
+
+    m_unifiedMemory = isUnifiedMemoryArchitecture(info.memoryTypes);
+
+    spdlog::debug("upload manager: queue family {}, graphics queue family {}, unified memory {}",
+                  m_queueFamilyIndex,
+                  m_graphicsQueueFamilyIndex,
+                  m_unifiedMemory);
+}
+
+VulkanUploadManager::~VulkanUploadManager()
+{
+    // pending uploads which are not flushed are discarded.
+    while (!m_submissions.empty())
+        pollSubmissions(true);
+
+    destroyAcquire(m_acquire);
+
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+    vkAPI.DestroyCommandPool(m_device.getVkDevice(), m_commandPool, nullptr);
+    if (m_graphicsCommandPool != VK_NULL_HANDLE)
+        vkAPI.DestroyCommandPool(m_device.getVkDevice(), m_graphicsCommandPool, nullptr);
+}
+
+uint64_t VulkanUploadManager::uploadBuffer(Buffer& buffer, uint64_t offset, const void* data, uint64_t size)
+{
+    if (!(buffer.getUsage() & BufferUsageFlagBits::kCopyDst))
+        throw std::runtime_error("The buffer is not used for copy dst.");
+
+    if (offset + size > buffer.getSize())
+        throw std::runtime_error(fmt::format("The upload range (offset {}, size {}) is out of the buffer (size {}).", offset, size, buffer.getSize()));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (size == 0)
+        return m_completedSerial;
+
+    auto& vulkanBuffer = downcast(buffer);
+
+    // buffers are host visible. write to device local memory directly, unless copies to the buffer are not completed.
+    if (m_unifiedMemory && !isPending(vulkanBuffer.getVkBuffer()))
+    {
+        std::memcpy(static_cast<uint8_t*>(vulkanBuffer.map()) + offset, data, size);
+        vulkanBuffer.flush(offset, size);
+        return m_completedSerial;
+    }
+
+    auto staging = allocateStaging(data, size, 4);
+    m_batch.buffers.push_back({ .srcBuffer = staging.buffer,
+                                .dstBuffer = vulkanBuffer.getVkBuffer(),
+                                .region = { .srcOffset = staging.offset, .dstOffset = offset, .size = size } });
+
+    return m_submittedSerial + 1;
+}
+
+uint64_t VulkanUploadManager::uploadTexture(const BlitTexture& texture,
+                                            const void* data,
+                                            uint64_t size,
+                                            const TextureDataLayout& layout,
+                                            const Extent3D& extent)
+{
+    auto& vulkanTexture = downcast(texture.texture);
+    if (!(vulkanTexture.getUsage() & TextureUsageFlagBits::kCopyDst))
+        throw std::runtime_error("The texture is not used for copy dst.");
+
+    if (texture.mipLevel >= vulkanTexture.getMipLevels())
+        throw std::runtime_error(fmt::format("The mip level {} is out of {} mip levels.", texture.mipLevel, vulkanTexture.getMipLevels()));
+
+    const uint32_t width = std::max(vulkanTexture.getWidth() >> texture.mipLevel, 1u);
+    const uint32_t height = std::max(vulkanTexture.getHeight() >> texture.mipLevel, 1u);
+    const uint32_t depth = vulkanTexture.getType() == TextureType::k3D ? std::max(vulkanTexture.getDepth() >> texture.mipLevel, 1u) : vulkanTexture.getDepth();
+    if (texture.origin.x + extent.width > width || texture.origin.y + extent.height > height || texture.origin.z + extent.depth > depth)
+        throw std::runtime_error("The upload region is out of the texture.");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (extent.width == 0 || extent.height == 0 || extent.depth == 0)
+        return m_completedSerial;
+
+    const VkImageAspectFlags aspectMask = ToVkImageAspectFlags(texture.aspect);
+    const uint64_t texelBlockSize = GenerateTexelBlockSize(ToVkFormat(vulkanTexture.getFormat()), aspectMask);
+    if (layout.bytesPerRow % texelBlockSize != 0)
+        throw std::runtime_error(fmt::format("The bytes per row {} is not a multiple of the texel size {}.", layout.bytesPerRow, texelBlockSize));
+
+    const uint64_t bytesPerRow = layout.bytesPerRow != 0 ? layout.bytesPerRow : extent.width * texelBlockSize;
+    const uint64_t rowsPerTexture = layout.rowsPerTexture != 0 ? layout.rowsPerTexture : extent.height;
+    const uint64_t requiredSize = bytesPerRow * rowsPerTexture * (extent.depth - 1) + bytesPerRow * (extent.height - 1) + extent.width * texelBlockSize;
+    if (layout.offset + requiredSize > size)
+    {
+        throw std::runtime_error(fmt::format("The texture data (size {}) is smaller than the layout requires (offset {}, size {}).",
+                                             size, layout.offset, requiredSize));
+    }
+
+    // buffer offsets of copies to images must be multiples of the texel block size and 4.
+    auto staging = allocateStaging(static_cast<const uint8_t*>(data) + layout.offset, requiredSize, texelBlockSize * 4);
+
+    // 3D textures copy depth slices, and others copy array layers.
+    const bool is3D = vulkanTexture.getType() == TextureType::k3D;
+
+    TextureUpload upload{ .srcBuffer = staging.buffer, .texture = &vulkanTexture };
+    upload.range = { .aspectMask = aspectMask,
+                     .baseMipLevel = texture.mipLevel,
+                     .levelCount = 1,
+                     .baseArrayLayer = is3D ? 0 : texture.origin.z,
+                     .layerCount = is3D ? 1 : extent.depth };
+
+    upload.region.bufferOffset = staging.offset;
+    upload.region.bufferRowLength = layout.bytesPerRow / static_cast<uint32_t>(texelBlockSize); // texels
+    upload.region.bufferImageHeight = layout.rowsPerTexture;
+    upload.region.imageSubresource = { .aspectMask = aspectMask,
+                                       .mipLevel = texture.mipLevel,
+                                       .baseArrayLayer = upload.range.baseArrayLayer,
+                                       .layerCount = upload.range.layerCount };
+    upload.region.imageOffset = { static_cast<int32_t>(texture.origin.x),
+                                  static_cast<int32_t>(texture.origin.y),
+                                  static_cast<int32_t>(is3D ? texture.origin.z : 0) };
+    upload.region.imageExtent = { .width = extent.width,
+                                  .height = extent.height,
+                                  .depth = is3D ? extent.depth : 1 };
+
+    vulkanTexture.transitionUpload(upload.preBarrier, upload.postBarrier, upload.range);
+
+    m_batch.textures.push_back(std::move(upload));
+
+    return m_submittedSerial + 1;
+}
+
+uint64_t VulkanUploadManager::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return flushLocked();
+}
+
+uint64_t VulkanUploadManager::getCompletedSerial()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    pollSubmissions(false);
+
+    return m_completedSerial;
+}
+
+bool VulkanUploadManager::isCompleted(uint64_t serial)
+{
+    return getCompletedSerial() >= serial;
+}
+
+void VulkanUploadManager::wait(uint64_t serial)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (serial > m_submittedSerial)
+        flushLocked();
+
+    while (m_completedSerial < serial && !m_submissions.empty())
+        pollSubmissions(true);
+}
+
+VulkanUploadAcquire VulkanUploadManager::acquire(uint32_t queueFamilyIndex)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    flushLocked();
+
+    if (queueFamilyIndex != m_graphicsQueueFamilyIndex)
+        return {};
+
+    return std::exchange(m_acquire, {});
+}
+
+void VulkanUploadManager::releaseAcquire(const VulkanUploadAcquire& acquire)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    destroyAcquire(acquire);
+}
+
+uint32_t VulkanUploadManager::getQueueFamilyIndex() const
+{
+    return m_queueFamilyIndex;
+}
+
+bool VulkanUploadManager::isUnifiedMemory() const
+{
+    return m_unifiedMemory;
+}
+
+VulkanUploadManager::StagingAllocation VulkanUploadManager::allocateStaging(const void* data, uint64_t size, uint64_t alignment)
+{
+    // large uploads would hold the ring until they are completed.
+    if (size > m_descriptor.ringSize / 4)
+    {
+        BufferDescriptor descriptor{ .size = size,
+                                     .usage = BufferUsageFlagBits::kMapWrite | BufferUsageFlagBits::kCopySrc };
+        auto buffer = m_device.createBuffer(descriptor);
+        std::memcpy(buffer->map(), data, size);
+        downcast(*buffer).flush(0, size);
+        buffer->unmap();
+
+        StagingAllocation allocation{ .buffer = downcast(*buffer).getVkBuffer(), .offset = 0 };
+        m_batch.stagingBuffers.push_back(std::move(buffer));
+
+        return allocation;
+    }
+
+    if (!m_ring)
+    {
+        BufferDescriptor descriptor{ .size = m_descriptor.ringSize,
+                                     .usage = BufferUsageFlagBits::kMapWrite | BufferUsageFlagBits::kCopySrc };
+        m_ring = m_device.createBuffer(descriptor);
+        m_ringData = static_cast<uint8_t*>(m_ring->map());
+    }
+
+    uint64_t offset = 0;
+    while (!allocateRing(size, alignment, offset))
+    {
+        // submit the uploads in the ring, and reclaim the oldest submission.
+        if (m_batch.ringBytes > 0)
+            flushLocked();
+
+        pollSubmissions(true);
+    }
+
+    std::memcpy(m_ringData + offset, data, size);
+    downcast(*m_ring).flush(offset, size);
+
+    return { .buffer = downcast(*m_ring).getVkBuffer(), .offset = offset };
+}
+
+bool VulkanUploadManager::allocateRing(uint64_t size, uint64_t alignment, uint64_t& offset)
+{
+    const uint64_t ringSize = m_ring->getSize();
+
+    uint64_t begin = alignUp(m_ringHead, alignment);
+    // wrap around. the end of the ring is wasted until the submission is completed.
+    if (begin + size > ringSize)
+        begin = 0;
+
+    const uint64_t end = begin + size;
+    const uint64_t bytes = begin >= m_ringHead ? end - m_ringHead : ringSize - m_ringHead + end;
+    if (m_ringUsed + bytes > ringSize)
+        return false;
+
+    m_ringUsed += bytes;
+    m_batch.ringBytes += bytes;
+    m_ringHead = end;
+
+    offset = begin;
+    return true;
+}
+
+uint64_t VulkanUploadManager::flushLocked()
+{
+    pollSubmissions(false);
+
+    if (m_batch.buffers.empty() && m_batch.textures.empty())
+        return m_submittedSerial;
+
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+    const bool ownershipTransfer = m_queueFamilyIndex != m_graphicsQueueFamilyIndex;
+
+    Submission submission{ .serial = m_submittedSerial + 1 };
+    for (const auto& upload : m_batch.buffers)
+    {
+        if (std::find(submission.dstBuffers.begin(), submission.dstBuffers.end(), upload.dstBuffer) == submission.dstBuffers.end())
+            submission.dstBuffers.push_back(upload.dstBuffer);
+    }
+
+    VkCommandBuffer commandBuffer = beginCommandBuffer(m_commandPool);
+    submission.commandBuffers.push_back(commandBuffer);
+
+    // barriers of the graphics queue family which release the resources before the uploads, and acquire them after the uploads.
+    Barriers release{ .dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT };
+    Barriers acquire{ .srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT };
+    // barriers after the uploads.
+    Barriers end{ .srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT };
+
+    VulkanCommandRecorder recorder(vkAPI, commandBuffer);
+    recordBufferUploads(recorder, submission.dstBuffers, release, end, acquire);
+    recordTextureUploads(recorder, release, end, acquire);
+    recordBarriers(recorder, end);
+
+    if (vkAPI.EndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to end command buffer for uploads.");
+    }
+
+    std::vector<VkSemaphore> waitSemaphores{};
+    std::vector<VkPipelineStageFlags> waitStages{};
+    if (ownershipTransfer && (!release.bufferMemoryBarriers.empty() || !release.imageMemoryBarriers.empty()))
+    {
+        VkCommandBuffer releaseCommandBuffer = beginCommandBuffer(m_graphicsCommandPool);
+        VulkanCommandRecorder releaseRecorder(vkAPI, releaseCommandBuffer);
+        recordBarriers(releaseRecorder, release);
+        if (vkAPI.EndCommandBuffer(releaseCommandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to end command buffer for releases of uploads.");
+        }
+
+        VkSemaphore semaphore = createSemaphore();
+        submitCommandBuffer(m_device, m_graphicsQueue, releaseCommandBuffer, {}, {}, semaphore, VK_NULL_HANDLE);
+
+        submission.graphicsCommandBuffers.push_back(releaseCommandBuffer);
+        submission.semaphores.push_back(semaphore);
+        waitSemaphores.push_back(semaphore);
+        waitStages.push_back(VK_PIPELINE_STAGE_TRANSFER_BIT);
+    }
+
+    // the acquire is submitted by the next submission of a graphics queue.
+    VkSemaphore signalSemaphore = VK_NULL_HANDLE;
+    if (ownershipTransfer && (!acquire.bufferMemoryBarriers.empty() || !acquire.imageMemoryBarriers.empty()))
+    {
+        VkCommandBuffer acquireCommandBuffer = beginCommandBuffer(m_graphicsCommandPool);
+        VulkanCommandRecorder acquireRecorder(vkAPI, acquireCommandBuffer);
+        recordBarriers(acquireRecorder, acquire);
+        if (vkAPI.EndCommandBuffer(acquireCommandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to end command buffer for acquires of uploads.");
+        }
+
+        signalSemaphore = createSemaphore();
+        m_acquire.commandBuffers.push_back(acquireCommandBuffer);
+        m_acquire.semaphores.push_back(signalSemaphore);
+    }
+
+    VkFenceCreateInfo fenceCreateInfo{};
+    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkAPI.CreateFence(m_device.getVkDevice(), &fenceCreateInfo, nullptr, &submission.fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create fence for uploads.");
+    }
+
+    submitCommandBuffer(m_device, m_queue, commandBuffer, waitSemaphores, waitStages, signalSemaphore, submission.fence);
+
+    spdlog::trace("upload manager: serial {}, buffer uploads {}, texture uploads {}, ring bytes {}",
+                  submission.serial,
+                  m_batch.buffers.size(),
+                  m_batch.textures.size(),
+                  m_batch.ringBytes);
+
+    submission.stagingBuffers = std::move(m_batch.stagingBuffers);
+    submission.ringBytes = m_batch.ringBytes;
+    m_submissions.push_back(std::move(submission));
+    m_batch = Batch{};
+
+    return ++m_submittedSerial;
+}
+
+void VulkanUploadManager::recordBufferUploads(VulkanCommandRecorder& recorder, const std::vector<VkBuffer>& dstBuffers, Barriers& release, Barriers& end, Barriers& acquire)
+{
+    if (m_batch.buffers.empty())
+        return;
+
+    Barriers begin{ .dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT };
+    if (m_queueFamilyIndex != m_graphicsQueueFamilyIndex)
+    {
+        // buffers don't have tracked states, so the whole buffers are released by the graphics queue family.
+        for (VkBuffer buffer : dstBuffers)
+        {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+            barrier.dstQueueFamilyIndex = m_queueFamilyIndex;
+            barrier.buffer = buffer;
+            barrier.offset = 0;
+            barrier.size = VK_WHOLE_SIZE;
+
+            barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+            release.bufferMemoryBarriers.push_back(barrier);
+
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            begin.bufferMemoryBarriers.push_back(barrier);
+
+            std::swap(barrier.srcQueueFamilyIndex, barrier.dstQueueFamilyIndex);
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+            end.bufferMemoryBarriers.push_back(barrier);
+
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+            acquire.bufferMemoryBarriers.push_back(barrier);
+        }
+
+        release.srcStageMask |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        begin.srcStageMask |= VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        end.dstStageMask |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        acquire.dstStageMask |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    }
+    else
+    {
+        begin.memoryBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                         .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+                                         .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT });
+        begin.srcStageMask |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        end.memoryBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                       .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                       .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT });
+        end.dstStageMask |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    }
+    recordBarriers(recorder, begin);
+
+    // copies which write overlapped ranges are separated by barriers. adjacent copies between the same buffers are recorded at once.
+    const auto& uploads = m_batch.buffers;
+    std::vector<VkBufferCopy> regions{};
+    size_t first = 0;
+    for (size_t i = 0; i < uploads.size(); ++i)
+    {
+        const bool hazard = std::any_of(uploads.begin() + first, uploads.begin() + i, [&](const BufferUpload& upload) {
+            return upload.dstBuffer == uploads[i].dstBuffer && overlaps(upload.region, uploads[i].region);
+        });
+
+        const bool split = i > 0 && (uploads[i - 1].srcBuffer != uploads[i].srcBuffer || uploads[i - 1].dstBuffer != uploads[i].dstBuffer);
+        if (!regions.empty() && (hazard || split))
+        {
+            recorder.cmdCopyBuffer(uploads[i - 1].srcBuffer, uploads[i - 1].dstBuffer, static_cast<uint32_t>(regions.size()), regions.data());
+            regions.clear();
+        }
+
+        if (hazard)
+        {
+            VkMemoryBarrier barrier{ .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                     .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                     .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT };
+            recorder.cmdPipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+            first = i;
+        }
+
+        regions.push_back(uploads[i].region);
+    }
+    recorder.cmdCopyBuffer(uploads.back().srcBuffer, uploads.back().dstBuffer, static_cast<uint32_t>(regions.size()), regions.data());
+}
+
+void VulkanUploadManager::recordTextureUploads(VulkanCommandRecorder& recorder, Barriers& release, Barriers& end, Barriers& acquire)
+{
+    if (m_batch.textures.empty())
+        return;
+
+    const bool ownershipTransfer = m_queueFamilyIndex != m_graphicsQueueFamilyIndex;
+    const auto& uploads = m_batch.textures;
+
+    auto uploaded = [&](size_t begin, size_t end, const VulkanTexture* texture, const VkImageSubresourceRange& range) {
+        return std::any_of(uploads.begin() + begin, uploads.begin() + end, [&](const TextureUpload& upload) {
+            return upload.texture == texture && overlaps(upload.range, range);
+        });
+    };
+
+    // transitions of uploads are recorded at once around their copies, until an upload writes subresources which are written in the segment.
+    size_t first = 0;
+    while (first < uploads.size())
+    {
+        size_t last = first + 1;
+        while (last < uploads.size() && !uploaded(first, last, uploads[last].texture, uploads[last].range))
+            ++last;
+
+        Barriers begin{ .dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT };
+        Barriers segmentEnd{ .srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT };
+        for (size_t i = first; i < last; ++i)
+        {
+            const auto& upload = uploads[i];
+
+            // contents of undefined layout and subresources which are uploaded by previous segments don't need to be released.
+            for (auto barrier : upload.preBarrier.imageMemoryBarriers)
+            {
+                if (ownershipTransfer && barrier.oldLayout != VK_IMAGE_LAYOUT_UNDEFINED && !uploaded(0, first, upload.texture, barrier.subresourceRange))
+                {
+                    barrier.srcQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+                    barrier.dstQueueFamilyIndex = m_queueFamilyIndex;
+
+                    auto releaseBarrier = barrier;
+                    releaseBarrier.dstAccessMask = 0;
+                    release.imageMemoryBarriers.push_back(releaseBarrier);
+                    release.srcStageMask |= upload.preBarrier.srcStageMask;
+
+                    barrier.srcAccessMask = 0;
+                }
+                if (ownershipTransfer)
+                    barrier.srcAccessMask &= kTransferAccessMask;
+                begin.imageMemoryBarriers.push_back(barrier);
+            }
+
+            // subresources which are uploaded by next segments are released by them.
+            for (auto barrier : upload.postBarrier.imageMemoryBarriers)
+            {
+                if (ownershipTransfer && !uploaded(last, uploads.size(), upload.texture, barrier.subresourceRange))
+                {
+                    barrier.srcQueueFamilyIndex = m_queueFamilyIndex;
+                    barrier.dstQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+
+                    auto acquireBarrier = barrier;
+                    acquireBarrier.srcAccessMask = 0;
+                    acquire.imageMemoryBarriers.push_back(acquireBarrier);
+                    acquire.dstStageMask |= upload.postBarrier.dstStageMask;
+
+                    barrier.dstAccessMask = 0;
+                }
+                if (ownershipTransfer)
+                    barrier.dstAccessMask &= kTransferAccessMask;
+                segmentEnd.imageMemoryBarriers.push_back(barrier);
+            }
+
+            // stages of the graphics queue family are not supported by the transfer queue family.
+            begin.srcStageMask |= ownershipTransfer ? VK_PIPELINE_STAGE_TRANSFER_BIT : upload.preBarrier.srcStageMask;
+            segmentEnd.dstStageMask |= ownershipTransfer ? VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : upload.postBarrier.dstStageMask;
+        }
+        recordBarriers(recorder, begin);
+
+        // adjacent copies between the same resources are recorded at once.
+        std::vector<VkBufferImageCopy> regions{};
+        for (size_t i = first; i < last; ++i)
+        {
+            regions.push_back(uploads[i].region);
+            if (i + 1 == last || uploads[i + 1].srcBuffer != uploads[i].srcBuffer || uploads[i + 1].texture != uploads[i].texture)
+            {
+                recorder.cmdCopyBufferToImage(uploads[i].srcBuffer,
+                                              uploads[i].texture->getVkImage(),
+                                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                              static_cast<uint32_t>(regions.size()),
+                                              regions.data());
+                regions.clear();
+            }
+        }
+
+        // the barriers after the last segment are recorded with the barriers for buffers.
+        if (last == uploads.size())
+        {
+            end.dstStageMask |= segmentEnd.dstStageMask;
+            end.imageMemoryBarriers.insert(end.imageMemoryBarriers.end(), segmentEnd.imageMemoryBarriers.begin(), segmentEnd.imageMemoryBarriers.end());
+        }
+        else
+        {
+            recordBarriers(recorder, segmentEnd);
+        }
+
+        first = last;
+    }
+}
+
+void VulkanUploadManager::recordBarriers(VulkanCommandRecorder& recorder, const Barriers& barriers)
+{
+    if (barriers.memoryBarriers.empty() && barriers.bufferMemoryBarriers.empty() && barriers.imageMemoryBarriers.empty())
+        return;
+
+    recorder.cmdPipelineBarrier(barriers.srcStageMask,
+                                barriers.dstStageMask,
+                                0,
+                                static_cast<uint32_t>(barriers.memoryBarriers.size()),
+                                barriers.memoryBarriers.data(),
+                                static_cast<uint32_t>(barriers.bufferMemoryBarriers.size()),
+                                barriers.bufferMemoryBarriers.data(),
+                                static_cast<uint32_t>(barriers.imageMemoryBarriers.size()),
+                                barriers.imageMemoryBarriers.data());
+}
+
+void VulkanUploadManager::pollSubmissions(bool waitOldest)
+{
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+
+    if (waitOldest && !m_submissions.empty())
+    {
+        VkResult result = vkAPI.WaitForFences(m_device.getVkDevice(), 1, &m_submissions.front().fence, VK_TRUE, UINT64_MAX);
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error(fmt::format("failed to wait for uploads {}", static_cast<uint32_t>(result)));
+        }
+    }
+
+    // submissions to a queue are completed in order.
+    while (!m_submissions.empty() && vkAPI.GetFenceStatus(m_device.getVkDevice(), m_submissions.front().fence) == VK_SUCCESS)
+    {
+        auto& submission = m_submissions.front();
+
+        m_completedSerial = submission.serial;
+        m_ringUsed -= submission.ringBytes;
+
+        destroySubmission(submission);
+        m_submissions.pop_front();
+    }
+
+    // start from the beginning not to waste the end of the ring.
+    if (m_ringUsed == 0)
+        m_ringHead = 0;
+}
+
+void VulkanUploadManager::destroySubmission(Submission& submission)
+{
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+    VkDevice device = m_device.getVkDevice();
+
+    vkAPI.DestroyFence(device, submission.fence, nullptr);
+    vkAPI.FreeCommandBuffers(device, m_commandPool, static_cast<uint32_t>(submission.commandBuffers.size()), submission.commandBuffers.data());
+    if (!submission.graphicsCommandBuffers.empty())
+        vkAPI.FreeCommandBuffers(device, m_graphicsCommandPool, static_cast<uint32_t>(submission.graphicsCommandBuffers.size()), submission.graphicsCommandBuffers.data());
+    for (VkSemaphore semaphore : submission.semaphores)
+        vkAPI.DestroySemaphore(device, semaphore, nullptr);
+
+    submission.stagingBuffers.clear();
+}
+
+void VulkanUploadManager::destroyAcquire(const VulkanUploadAcquire& acquire)
+{
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+    VkDevice device = m_device.getVkDevice();
+
+    if (!acquire.commandBuffers.empty())
+        vkAPI.FreeCommandBuffers(device, m_graphicsCommandPool, static_cast<uint32_t>(acquire.commandBuffers.size()), acquire.commandBuffers.data());
+    for (VkSemaphore semaphore : acquire.semaphores)
+        vkAPI.DestroySemaphore(device, semaphore, nullptr);
+}
+
+VkCommandBuffer VulkanUploadManager::beginCommandBuffer(VkCommandPool commandPool)
+{
+    const VulkanAPI& vkAPI = m_device.vkAPI;
+
+    VkCommandBufferAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocateInfo.commandPool = commandPool;
+    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocateInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    if (vkAPI.AllocateCommandBuffers(m_device.getVkDevice(), &allocateInfo, &commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate command buffer for uploads.");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkAPI.BeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin command buffer for uploads.");
+    }
+
+    return commandBuffer;
+}
+
+VkSemaphore VulkanUploadManager::createSemaphore()
+{
+    VkSemaphoreCreateInfo semaphoreCreateInfo{};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    if (m_device.vkAPI.CreateSemaphore(m_device.getVkDevice(), &semaphoreCreateInfo, nullptr, &semaphore) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create semaphore for uploads.");
+    }
+
+    return semaphore;
+}
+
+bool VulkanUploadManager::isPending(VkBuffer buffer) const
+{
+    auto batched = std::any_of(m_batch.buffers.begin(), m_batch.buffers.end(), [&](const BufferUpload& upload) {
+        return upload.dstBuffer == buffer;
+    });
+    if (batched)
+        return true;
+
+    return std::any_of(m_submissions.begin(), m_submissions.end(), [&](const Submission& submission) {
+        return std::find(submission.dstBuffers.begin(), submission.dstBuffers.end(), buffer) != submission.dstBuffers.end();
+    });
+}
+
+} // namespace jipu
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "jipu/upload_manager.h"
+#include "utils/cast.h"
+#include "vulkan_api.h"
+#include "vulkan_command_recorder.h"
+#include "vulkan_export.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace jipu
+{
+
+struct VulkanUploadManagerDescriptor
+{
+    /// @brief size of the staging ring. larger uploads than a quarter of it have their own staging buffer.
+    uint64_t ringSize = 32 * 1024 * 1024;
+    /// @brief submit uploads to a queue family which supports only transfer if there is.
+    bool useTransferQueue = true;
+};
+
+/// @brief command buffers which acquire uploaded resources from the transfer queue family, and semaphores to wait before them.
+struct VulkanUploadAcquire
+{
+    std::vector<VkCommandBuffer> commandBuffers{};
+    std::vector<VkSemaphore> semaphores{};
+};
+
+class VulkanDevice;
+class VulkanTexture;
+class VULKAN_EXPORT VulkanUploadManager final : public UploadManager
+{
+public:
+    VulkanUploadManager() = delete;
+    VulkanUploadManager(VulkanDevice& device, const VulkanUploadManagerDescriptor& descriptor);
+    ~VulkanUploadManager() override;
+
+    VulkanUploadManager(const VulkanUploadManager&) = delete;
+    VulkanUploadManager& operator=(const VulkanUploadManager&) = delete;
+
+public:
+    uint64_t uploadBuffer(Buffer& buffer, uint64_t offset, const void* data, uint64_t size) override;
+    uint64_t uploadTexture(const BlitTexture& texture,
+                           const void* data,
+                           uint64_t size,
+                           const TextureDataLayout& layout,
+                           const Extent3D& extent) override;
+
+    uint64_t flush() override;
+
+    uint64_t getCompletedSerial() override;
+    bool isCompleted(uint64_t serial) override;
+    void wait(uint64_t serial) override;
+
+public:
+    /// @brief flush pending uploads, and return acquires which must be submitted before command buffers of the queue family.
+    /// it is empty if uploads are submitted to the queue family itself. uploads are not acquired by other queue families.
+    VulkanUploadAcquire acquire(uint32_t queueFamilyIndex);
+    /// @brief release the acquire after its submission is completed.
+    void releaseAcquire(const VulkanUploadAcquire& acquire);
+
+    uint32_t getQueueFamilyIndex() const;
+    /// @brief device local memory is host visible, so buffers are written directly.
+    bool isUnifiedMemory() const;
+
+private:
+    struct StagingAllocation
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        uint64_t offset = 0;
+    };
+
+    struct BufferUpload
+    {
+        VkBuffer srcBuffer = VK_NULL_HANDLE;
+        VkBuffer dstBuffer = VK_NULL_HANDLE;
+        VkBufferCopy region{};
+    };
+
+    // uploads are submitted before command buffers of the next submission, which may be recorded before them.
+    // so layouts are transitioned from the final layout between submissions, instead of the tracked states of recording.
+    struct TextureUpload
+    {
+        VkBuffer srcBuffer = VK_NULL_HANDLE;
+        VulkanTexture* texture = nullptr;
+        VkBufferImageCopy region{};
+        VkImageSubresourceRange range{};
+        // transitions to transfer dst layout, and to the final layout.
+        VulkanPipelineBarrier preBarrier{};
+        VulkanPipelineBarrier postBarrier{};
+    };
+
+    // uploads which are recorded at flush.
+    struct Batch
+    {
+        std::vector<BufferUpload> buffers{};
+        std::vector<TextureUpload> textures{};
+        std::vector<std::unique_ptr<Buffer>> stagingBuffers{};
+        uint64_t ringBytes = 0;
+    };
+
+    struct Submission
+    {
+        uint64_t serial = 0;
+        VkFence fence = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> commandBuffers{};
+        std::vector<VkCommandBuffer> graphicsCommandBuffers{};
+        std::vector<VkSemaphore> semaphores{};
+        std::vector<VkBuffer> dstBuffers{};
+        std::vector<std::unique_ptr<Buffer>> stagingBuffers{};
+        uint64_t ringBytes = 0;
+    };
+
+    // barriers of a pipeline barrier command.
+    struct Barriers
+    {
+        VkPipelineStageFlags srcStageMask = 0u;
+        VkPipelineStageFlags dstStageMask = 0u;
+        std::vector<VkMemoryBarrier> memoryBarriers{};
+        std::vector<VkBufferMemoryBarrier> bufferMemoryBarriers{};
+        std::vector<VkImageMemoryBarrier> imageMemoryBarriers{};
+    };
+
+    StagingAllocation allocateStaging(const void* data, uint64_t size, uint64_t alignment);
+    bool allocateRing(uint64_t size, uint64_t alignment, uint64_t& offset);
+
+    uint64_t flushLocked();
+    /// @brief record copies of the batch. barriers of the graphics queue family to transfer the ownership are added to release and acquire.
+    void recordBufferUploads(VulkanCommandRecorder& recorder, const std::vector<VkBuffer>& dstBuffers, Barriers& release, Barriers& end, Barriers& acquire);
+    void recordTextureUploads(VulkanCommandRecorder& recorder, Barriers& release, Barriers& end, Barriers& acquire);
+    void recordBarriers(VulkanCommandRecorder& recorder, const Barriers& barriers);
+
+    /// @brief release completed submissions. wait for the oldest one if it is required.
+    void pollSubmissions(bool waitOldest);
+    void destroySubmission(Submission& submission);
+    void destroyAcquire(const VulkanUploadAcquire& acquire);
+
+    VkCommandBuffer beginCommandBuffer(VkCommandPool commandPool);
+    VkSemaphore createSemaphore();
+    /// @brief copies to the buffer are pending or in flight.
+    bool isPending(VkBuffer buffer) const;
+
+private:
+    VulkanDevice& m_device;
+    const VulkanUploadManagerDescriptor m_descriptor{};
+
+    std::mutex m_mutex{};
+
+    uint32_t m_graphicsQueueFamilyIndex = 0;
+    uint32_t m_queueFamilyIndex = 0;
+    VkQueue m_graphicsQueue = VK_NULL_HANDLE;
+    VkQueue m_queue = VK_NULL_HANDLE;
+    VkCommandPool m_commandPool = VK_NULL_HANDLE;
+    VkCommandPool m_graphicsCommandPool = VK_NULL_HANDLE;
+    bool m_unifiedMemory = false;
+
+    // staging ring. it is allocated at first upload and kept mapped.
+    std::unique_ptr<Buffer> m_ring = nullptr;
+    uint8_t* m_ringData = nullptr;
+    uint64_t m_ringHead = 0;
+    uint64_t m_ringUsed = 0;
+
+    Batch m_batch{};
+    std::deque<Submission> m_submissions{};
+    VulkanUploadAcquire m_acquire{};
+
+    uint64_t m_submittedSerial = 0;
+    uint64_t m_completedSerial = 0;
+};
+
+DOWN_CAST(VulkanUploadManager, UploadManager);
+
+} // namespace jipu
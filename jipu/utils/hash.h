@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <type_traits>
+#include <vector>
 
 namespace jipu
 {
@@ -17,4 +21,121 @@ inline void combineHash(size_t& seed, const T& value) noexcept
     seed ^= std::hash<T>()(value) + 0x9e3779b9u + (seed << 6u) + (seed >> 2u);
 }
 
-} // namespace jipu
\ No newline at end of file
+namespace detail
+{
+
+constexpr uint64_t kHashSecret0 = 0xa0761d6478bd642full;
+constexpr uint64_t kHashSecret1 = 0xe7037ed1a0b428dbull;
+constexpr uint64_t kHashSecret2 = 0x8ebc6af09c88c6e3ull;
+
+// 64x64 -> 128 bit multiply, folded to 64 bit.
+inline uint64_t mix(uint64_t a, uint64_t b) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    return lo ^ hi;
+#endif
+}
+
+inline uint64_t read64(const uint8_t* p) noexcept
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t read32(const uint8_t* p) noexcept
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+} // namespace detail
+
+/**
+ * @brief wyhash style hash of raw bytes. consumes 16 bytes per round.
+ */
+inline size_t hashBytes(const void* data, size_t size, uint64_t seed = 0) noexcept
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    seed ^= detail::mix(seed ^ detail::kHashSecret0, detail::kHashSecret1);
+
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (size <= 16)
+    {
+        if (size >= 4)
+        {
+            a = (detail::read32(p) << 32) | detail::read32(p + ((size >> 3) << 2));
+            b = (detail::read32(p + size - 4) << 32) | detail::read32(p + size - 4 - ((size >> 3) << 2));
+        }
+        else if (size > 0)
+        {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+        }
+    }
+    else
+    {
+        size_t i = size;
+        while (i > 16)
+        {
+            seed = detail::mix(detail::read64(p) ^ detail::kHashSecret1, detail::read64(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = detail::read64(p + i - 16);
+        b = detail::read64(p + i - 8);
+    }
+
+    a ^= detail::kHashSecret1;
+    b ^= seed;
+    a = detail::mix(a, b);
+    return static_cast<size_t>(detail::mix(a ^ detail::kHashSecret0 ^ size, b ^ detail::kHashSecret1 ^ detail::kHashSecret2));
+}
+
+/**
+ * @brief hash a packed POD key by its bytes. the type must not have padding.
+ */
+template <typename T>
+inline size_t hashPod(const T& value, uint64_t seed = 0) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>,
+                  "hashPod requires a trivially copyable type without padding.");
+    return hashBytes(&value, sizeof(T), seed);
+}
+
+template <typename T>
+inline size_t hashRange(const std::vector<T>& values, uint64_t seed = 0) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>,
+                  "hashRange requires a trivially copyable type without padding.");
+    return hashBytes(values.data(), values.size() * sizeof(T), seed + values.size());
+}
+
+template <typename T>
+inline bool equalPod(const T& lhs, const T& rhs) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>,
+                  "equalPod requires a trivially copyable type without padding.");
+    return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+
+template <typename T>
+inline bool equalRange(const std::vector<T>& lhs, const std::vector<T>& rhs) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>,
+                  "equalRange requires a trivially copyable type without padding.");
+    return lhs.size() == rhs.size() && (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0);
+}
+
+} // namespace jipu
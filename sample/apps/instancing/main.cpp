@@ -287,7 +287,7 @@ void InstancingSample::draw()
             for (auto i = 0; i < m_imguiSettings.objectCount; ++i)
             {
                 uint32_t offset = i * sizeof(Transform);
-                renderPassEncoder->setBindingGroup(0, *m_nonInstancing.bindingGroup, { offset });
+                renderPassEncoder->setBindingGroup(0, *m_nonInstancing.bindingGroup, std::span<const uint32_t>(&offset, 1));
                 renderPassEncoder->drawIndexed(static_cast<uint32_t>(m_indices.size()), 1, 0, 0, 0);
             }
             renderPassEncoder->end();
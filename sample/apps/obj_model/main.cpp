@@ -1,9 +1,9 @@
 
 
 #include "file.h"
-#include "image.h"
 #include "model.h"
 #include "sample.h"
+#include "texture_streamer.h"
 
 #include "jipu/binding_group.h"
 #include "jipu/binding_group_layout.h"
@@ -54,8 +54,8 @@ private:
     void createUniformBuffer();
 
     void createImageTexture();
-    void createImageTextureView();
     void createImageSampler();
+    void updateImageTexture();
 
     void createColorAttachmentTexture();
     void createColorAttachmentTextureView();
@@ -64,12 +64,12 @@ private:
 
     void createBindingGroupLayout();
     void createBindingGroup();
+    void createImageBindingGroup();
 
     void createPipelineLayout();
     void createRenderPipeline();
 
     void copyBufferToBuffer(Buffer& src, Buffer& dst);
-    void copyBufferToTexture(Buffer& imageTextureBuffer, Texture& imageTexture);
 
     void updateUniformBuffer();
 
@@ -83,13 +83,13 @@ private:
 
     // data
     Polygon m_polygon{};
-    std::unique_ptr<Image> m_image = nullptr;
 
     std::unique_ptr<Buffer> m_vertexBuffer = nullptr;
     std::unique_ptr<Buffer> m_indexBuffer = nullptr;
 
-    std::unique_ptr<Texture> m_imageTexture = nullptr;
-    std::unique_ptr<TextureView> m_imageTextureView = nullptr;
+    std::unique_ptr<TextureStreamer> m_textureStreamer = nullptr;
+    StreamingTexture* m_imageTexture = nullptr;
+    uint64_t m_imageTextureVersion = 0;
     std::unique_ptr<Sampler> m_imageSampler = nullptr;
 
     std::unique_ptr<Buffer> m_uniformBuffer = nullptr;
@@ -139,8 +139,8 @@ OBJModelSample::~OBJModelSample()
     m_uniformBuffer.reset();
 
     m_imageSampler.reset();
-    m_imageTextureView.reset();
-    m_imageTexture.reset();
+    // wait for uploads of streaming textures.
+    m_textureStreamer.reset();
 
     m_indexBuffer.reset();
     m_vertexBuffer.reset();
@@ -163,7 +163,6 @@ void OBJModelSample::init()
     createUniformBuffer();
 
     createImageTexture();
-    createImageTextureView();
     createImageSampler();
 
     createColorAttachmentTexture();
@@ -182,6 +181,7 @@ void OBJModelSample::update()
 {
     Sample::update();
 
+    updateImageTexture();
     updateUniformBuffer();
     updateImGui();
 }
@@ -218,14 +218,18 @@ void OBJModelSample::draw()
                                                       .sampleCount = m_sampleCount };
 
     std::unique_ptr<RenderPassEncoder> renderPassEncoder = commandEncoder->beginRenderPass(renderPassDescriptor);
-    renderPassEncoder->setPipeline(*m_renderPipeline);
-    renderPassEncoder->setBindingGroup(0, *m_bindingGroups[0]);
-    renderPassEncoder->setBindingGroup(1, *m_bindingGroups[1]);
-    renderPassEncoder->setVertexBuffer(0, *m_vertexBuffer);
-    renderPassEncoder->setIndexBuffer(*m_indexBuffer, IndexFormat::kUint16);
-    renderPassEncoder->setViewport(0, 0, m_width, m_height, 0, 1); // set viewport state.
-    renderPassEncoder->setScissor(0, 0, m_width, m_height);        // set scissor state.
-    renderPassEncoder->drawIndexed(static_cast<uint32_t>(m_polygon.indices.size()), 1, 0, 0, 0);
+    // the model is drawn after the coarsest mip of its texture is resident.
+    if (m_bindingGroups[1] != nullptr)
+    {
+        renderPassEncoder->setPipeline(*m_renderPipeline);
+        renderPassEncoder->setBindingGroup(0, *m_bindingGroups[0]);
+        renderPassEncoder->setBindingGroup(1, *m_bindingGroups[1]);
+        renderPassEncoder->setVertexBuffer(0, *m_vertexBuffer);
+        renderPassEncoder->setIndexBuffer(*m_indexBuffer, IndexFormat::kUint16);
+        renderPassEncoder->setViewport(0, 0, m_width, m_height, 0, 1); // set viewport state.
+        renderPassEncoder->setScissor(0, 0, m_width, m_height);        // set scissor state.
+        renderPassEncoder->drawIndexed(static_cast<uint32_t>(m_polygon.indices.size()), 1, 0, 0, 0);
+    }
     renderPassEncoder->end();
 
     drawImGui(commandEncoder.get(), renderView);
@@ -281,52 +285,29 @@ void OBJModelSample::createUniformBuffer()
 
 void OBJModelSample::createImageTexture()
 {
-    // load as buffer for android.
-    std::vector<char> buffer = utils::readFile(m_appDir / "viking_room.png", m_handle);
-    m_image = std::make_unique<Image>(buffer.data(), buffer.size());
-
-    unsigned char* pixels = static_cast<unsigned char*>(m_image->getPixels());
-    uint32_t width = m_image->getWidth();
-    uint32_t height = m_image->getHeight();
-    uint32_t channel = m_image->getChannel();
-    uint64_t imageSize = sizeof(unsigned char) * width * height * channel;
-
-    uint32_t mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
-
-    // create image staging buffer.
-    BufferDescriptor descriptor{ .size = imageSize, .usage = BufferUsageFlagBits::kCopySrc };
-    std::unique_ptr<Buffer> imageTextureStagingBuffer = m_device->createBuffer(descriptor);
-
-    void* mappedPointer = imageTextureStagingBuffer->map();
-    memcpy(mappedPointer, pixels, imageSize);
+    // decoded on worker threads, and its mips are uploaded from the coarsest one over frames.
+    TextureStreamerDescriptor descriptor{ .platformContext = m_handle };
+    m_textureStreamer = std::make_unique<TextureStreamer>(*m_device, descriptor);
 
-    // create texture.
-    TextureDescriptor textureDescriptor{ .type = TextureType::k2D,
-                                         .format = TextureFormat::kRGBA_8888_UInt_Norm_SRGB,
-                                         .usage = TextureUsageFlagBits::kCopySrc |
-                                                  TextureUsageFlagBits::kCopyDst |
-                                                  TextureUsageFlagBits::kTextureBinding,
-                                         .width = width,
-                                         .height = height,
-                                         .depth = 1,
-                                         .mipLevels = mipLevels,
-                                         .sampleCount = 1 };
-    m_imageTexture = m_device->createTexture(textureDescriptor);
-
-    // copy image staging buffer to texture
-    copyBufferToTexture(*imageTextureStagingBuffer, *m_imageTexture);
-
-    // unmap staging buffer
-    // imageTextureStagingBuffer->unmap(); // TODO: need unmap before destroy it?
+    m_imageTexture = &m_textureStreamer->load({ .path = m_appDir / "viking_room.png",
+                                                .format = TextureFormat::kRGBA_8888_UInt_Norm_SRGB });
 }
 
-void OBJModelSample::createImageTextureView()
+void OBJModelSample::updateImageTexture()
 {
-    TextureViewDescriptor descriptor{};
-    descriptor.type = TextureViewType::k2D;
-    descriptor.aspect = TextureAspectFlagBits::kColor;
+    // the model fits in a unit sphere, so its size on the screen is from the eye distance and the field of view.
+    const float distance = glm::length(glm::vec3(2.0f, 2.0f, 2.0f));
+    const float screenSize = m_swapchain->getHeight() / (distance * std::tan(glm::radians(45.0f) / 2.0f));
+    m_imageTexture->setScreenSize(screenSize);
+
+    m_textureStreamer->update();
 
-    m_imageTextureView = m_imageTexture->createTextureView(descriptor);
+    // the texture view is recreated when finer mips are resident.
+    if (m_imageTexture->getVersion() != m_imageTextureVersion)
+    {
+        createImageBindingGroup();
+        m_imageTextureVersion = m_imageTexture->getVersion();
+    }
 }
 
 void OBJModelSample::createColorAttachmentTexture()
@@ -386,8 +367,6 @@ void OBJModelSample::createImageSampler()
     descriptor.addressModeV = AddressMode::kClampToEdge;
     descriptor.addressModeW = AddressMode::kClampToEdge;
     descriptor.lodMin = 0.0f;
-    // descriptor.lodMin = static_cast<float>(m_imageTexture->getMipLevels() / 2);
-    descriptor.lodMax = static_cast<float>(m_imageTexture->getMipLevels());
 
     m_imageSampler = m_device->createSampler(descriptor);
 }
@@ -449,25 +428,32 @@ void OBJModelSample::createBindingGroup()
         m_bindingGroups[0] = m_device->createBindingGroup(descriptor);
     }
 
-    {
-        SamplerBinding samplerBinding{
-            .index = 0,
-            .sampler = *m_imageSampler,
-        };
+    createImageBindingGroup();
+}
 
-        TextureBinding textureBinding{
-            .index = 1,
-            .textureView = *m_imageTextureView,
-        };
+void OBJModelSample::createImageBindingGroup()
+{
+    // it is created after the texture view is.
+    if (m_imageTexture->getTextureView() == nullptr)
+        return;
 
-        BindingGroupDescriptor descriptor{
-            .layout = *m_bindingGroupLayouts[1],
-            .samplers = { samplerBinding },
-            .textures = { textureBinding },
-        };
+    SamplerBinding samplerBinding{
+        .index = 0,
+        .sampler = *m_imageSampler,
+    };
 
-        m_bindingGroups[1] = m_device->createBindingGroup(descriptor);
-    }
+    TextureBinding textureBinding{
+        .index = 1,
+        .textureView = *m_imageTexture->getTextureView(),
+    };
+
+    BindingGroupDescriptor descriptor{
+        .layout = *m_bindingGroupLayouts[1],
+        .samplers = { samplerBinding },
+        .textures = { textureBinding },
+    };
+
+    m_bindingGroups[1] = m_device->createBindingGroup(descriptor);
 }
 
 void OBJModelSample::createPipelineLayout()
@@ -593,36 +579,6 @@ void OBJModelSample::copyBufferToBuffer(Buffer& src, Buffer& dst)
     m_queue->submit({ commandEncoder->finish() });
 }
 
-void OBJModelSample::copyBufferToTexture(Buffer& imageTextureStagingBuffer, Texture& imageTexture)
-{
-    BlitTextureBuffer blitTextureBuffer{
-        .buffer = imageTextureStagingBuffer,
-        .offset = 0,
-        .bytesPerRow = 0,
-        .rowsPerTexture = 0
-    };
-
-    uint32_t channel = 4;                          // TODO: from texture.
-    uint32_t bytesPerData = sizeof(unsigned char); // TODO: from buffer.
-    blitTextureBuffer.bytesPerRow = bytesPerData * imageTexture.getWidth() * channel;
-    blitTextureBuffer.rowsPerTexture = imageTexture.getHeight();
-
-    BlitTexture blitTexture{ .texture = imageTexture, .aspect = TextureAspectFlagBits::kColor };
-    Extent3D extent{};
-    extent.width = imageTexture.getWidth();
-    extent.height = imageTexture.getHeight();
-    extent.depth = 1;
-
-    CommandBufferDescriptor commandBufferDescriptor{};
-    std::unique_ptr<CommandBuffer> commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
-
-    CommandEncoderDescriptor commandEncoderDescriptor{};
-    std::unique_ptr<CommandEncoder> commandEndoer = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
-    commandEndoer->copyBufferToTexture(blitTextureBuffer, blitTexture, extent);
-
-    m_queue->submit({ commandEndoer->finish() });
-}
-
 void OBJModelSample::updateUniformBuffer()
 {
     static auto startTime = std::chrono::high_resolution_clock::now();
@@ -316,7 +316,7 @@ void ParticleSample::createComputeBindingGroup()
     BufferBindingLayout bufferInBindingLayout{};
     bufferInBindingLayout.index = 1;
     bufferInBindingLayout.stages = BindingStageFlagBits::kVertexStage | BindingStageFlagBits::kComputeStage;
-    bufferInBindingLayout.type = BufferBindingType::kStorage;
+    bufferInBindingLayout.type = BufferBindingType::kReadOnlyStorage;
 
     BufferBindingLayout bufferOutBindingLayout{};
     bufferOutBindingLayout.index = 2;
@@ -227,22 +227,11 @@ void VulkanNBufferingSample::createVertexBuffer()
     m_polygon = loadOBJ(buffer.data(), buffer.size());
 
     uint64_t vertexSize = static_cast<uint64_t>(sizeof(Vertex) * m_polygon.vertices.size());
-    BufferDescriptor vertexStagingBufferDescriptor{ .size = vertexSize,
-                                                    .usage = BufferUsageFlagBits::kCopySrc };
-    std::unique_ptr<Buffer> vertexStagingBuffer = m_device->createBuffer(vertexStagingBufferDescriptor);
-
-    void* mappedPointer = vertexStagingBuffer->map();
-    memcpy(mappedPointer, m_polygon.vertices.data(), vertexSize);
-
     BufferDescriptor vertexBufferDescriptor{ .size = vertexSize,
                                              .usage = BufferUsageFlagBits::kVertex | BufferUsageFlagBits::kCopyDst };
     m_vertexBuffer = m_device->createBuffer(vertexBufferDescriptor);
 
-    // copy staging buffer to target buffer
-    copyBufferToBuffer(*vertexStagingBuffer, *m_vertexBuffer);
-
-    // unmap staging buffer.
-    // vertexStagingBuffer->unmap(); // TODO: need unmap before destroy it?
+    m_device->getUploadManager().uploadBuffer(*m_vertexBuffer, 0, m_polygon.vertices.data(), vertexSize);
 }
 
 void VulkanNBufferingSample::createIndexBuffer()
@@ -280,13 +269,6 @@ void VulkanNBufferingSample::createImageTexture()
 
     uint32_t mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
 
-    // create image staging buffer.
-    BufferDescriptor descriptor{ .size = imageSize, .usage = BufferUsageFlagBits::kCopySrc };
-    std::unique_ptr<Buffer> imageTextureStagingBuffer = m_device->createBuffer(descriptor);
-
-    void* mappedPointer = imageTextureStagingBuffer->map();
-    memcpy(mappedPointer, pixels, imageSize);
-
     // create texture.
     TextureDescriptor textureDescriptor{ .type = TextureType::k2D,
                                          .format = TextureFormat::kRGBA_8888_UInt_Norm_SRGB,
@@ -300,11 +282,18 @@ void VulkanNBufferingSample::createImageTexture()
                                          .sampleCount = 1 };
     m_imageTexture = m_device->createTexture(textureDescriptor);
 
-    // copy image staging buffer to texture
-    copyBufferToTexture(*imageTextureStagingBuffer, *m_imageTexture);
+    // upload the base level. it is submitted before the command buffer which generates mipmaps.
+    BlitTexture blitTexture{ .texture = *m_imageTexture, .aspect = TextureAspectFlagBits::kColor };
+    TextureDataLayout dataLayout{ .offset = 0,
+                                  .bytesPerRow = sizeof(unsigned char) * width * channel,
+                                  .rowsPerTexture = height };
+    Extent3D extent{};
+    extent.width = width;
+    extent.height = height;
+    extent.depth = 1;
+    m_device->getUploadManager().uploadTexture(blitTexture, pixels, imageSize, dataLayout, extent);
 
-    // unmap staging buffer
-    // imageTextureStagingBuffer->unmap(); // TODO: need unmap before destroy it?
+    generateMipmaps(*m_imageTexture);
 }
 
 void VulkanNBufferingSample::createImageTextureView()
@@ -549,53 +538,14 @@ void VulkanNBufferingSample::createRenderPipeline()
     m_renderPipeline = m_device->createRenderPipeline(descriptor);
 }
 
-void VulkanNBufferingSample::copyBufferToBuffer(Buffer& src, Buffer& dst)
-{
-    BlitBuffer srcBuffer{
-        .buffer = src,
-        .offset = 0,
-    };
-
-    BlitBuffer dstBuffer{
-        .buffer = dst,
-        .offset = 0,
-    };
-
-    CommandBufferDescriptor commandBufferDescriptor{};
-    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
-
-    CommandEncoderDescriptor commandEncoderDescriptor{};
-    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
-
-    commandEncoder->copyBufferToBuffer(srcBuffer, dstBuffer, src.getSize());
-
-    m_queue->submit({ commandEncoder->finish() });
-}
-
-void VulkanNBufferingSample::copyBufferToTexture(Buffer& imageTextureStagingBuffer, Texture& imageTexture)
+void VulkanNBufferingSample::generateMipmaps(Texture& imageTexture)
 {
-    uint32_t channel = 4;                          // TODO: from texture.
-    uint32_t bytesPerData = sizeof(unsigned char); // TODO: from buffer.
-
-    BlitTextureBuffer blitTextureBuffer{
-        .buffer = imageTextureStagingBuffer,
-        .offset = 0,
-        .bytesPerRow = bytesPerData * imageTexture.getWidth() * channel,
-        .rowsPerTexture = imageTexture.getHeight(),
-    };
-
-    BlitTexture blitTexture{ .texture = imageTexture, .aspect = TextureAspectFlagBits::kColor };
-    Extent3D extent{};
-    extent.width = imageTexture.getWidth();
-    extent.height = imageTexture.getHeight();
-    extent.depth = 1;
-
     CommandBufferDescriptor commandBufferDescriptor{};
     std::unique_ptr<CommandBuffer> commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
 
     CommandEncoderDescriptor commandEncoderDescriptor{};
     std::unique_ptr<CommandEncoder> commandEndoer = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
-    commandEndoer->copyBufferToTexture(blitTextureBuffer, blitTexture, extent);
+    commandEndoer->generateMipmaps(imageTexture);
 
     m_queue->submit({ commandEndoer->finish() });
 }
@@ -71,8 +71,7 @@ private:
     void createPipelineLayout();
     void createRenderPipeline();
 
-    void copyBufferToBuffer(Buffer& src, Buffer& dst);
-    void copyBufferToTexture(Buffer& imageTextureBuffer, Texture& imageTexture);
+    void generateMipmaps(Texture& imageTexture);
 
     void updateUniformBuffer();
 
@@ -682,7 +682,7 @@ void VulkanPipelineBarrierSample::createOffscreenRenderPipeline()
             .colorBlendState = generateColorBlendStateCreateInfo(descriptor),
             .dynamicState = generateDynamicStateCreateInfo(descriptor),
             .layout = downcast(descriptor.layout),
-            .renderPass = getOffscreenRenderPass(stage),
+            .renderPass = &getOffscreenRenderPass(stage),
             .subpass = 0,
             .basePipelineHandle = VK_NULL_HANDLE, // Optional
             .basePipelineIndex = -1,              // Optional
@@ -6,23 +6,6 @@
 #include <random>
 #include <stdexcept>
 
-#include "vulkan_binding_group.h"
-#include "vulkan_binding_group_layout.h"
-#include "vulkan_buffer.h"
-#include "vulkan_command_buffer.h"
-#include "vulkan_command_encoder.h"
-#include "vulkan_device.h"
-#include "vulkan_framebuffer.h"
-#include "vulkan_instance.h"
-#include "vulkan_physical_device.h"
-#include "vulkan_queue.h"
-#include "vulkan_render_pass.h"
-#include "vulkan_render_pass_encoder.h"
-#include "vulkan_surface.h"
-#include "vulkan_swapchain.h"
-#include "vulkan_texture.h"
-#include "vulkan_texture_view.h"
-
 namespace jipu
 {
 
@@ -243,8 +226,6 @@ void VulkanSubpassesSample::draw()
 {
     CommandEncoderDescriptor commandEncoderDescriptor{};
     auto commandEncoder = m_commandBuffer->createCommandEncoder(commandEncoderDescriptor);
-    auto vulkanDevice = downcast(m_device.get());
-    auto vulkanCommandEncoder = downcast(commandEncoder.get());
 
     auto& renderView = m_swapchain->acquireNextTexture();
 
@@ -350,8 +331,40 @@ void VulkanSubpassesSample::draw()
     else
     {
         // subpasses
-        auto& vulkanRenderPass = getSubpassesRenderPass();
-        auto& vulkanFramebuffer = getSubpassesFrameBuffer(renderView);
+        ColorAttachment positionColorAttachment{
+            .renderView = *m_offscreen.subPasses.positionColorAttachmentTextureView
+        };
+        positionColorAttachment.loadOp = LoadOp::kClear;
+        positionColorAttachment.storeOp = StoreOp::kDontCare;
+        positionColorAttachment.clearValue = { 0.0, 0.0, 0.0, 0.0 };
+
+        ColorAttachment normalColorAttachment{
+            .renderView = *m_offscreen.subPasses.normalColorAttachmentTextureView
+        };
+        normalColorAttachment.loadOp = LoadOp::kClear;
+        normalColorAttachment.storeOp = StoreOp::kDontCare;
+        normalColorAttachment.clearValue = { 0.0, 0.0, 0.0, 0.0 };
+
+        ColorAttachment albedoColorAttachment{
+            .renderView = *m_offscreen.subPasses.albedoColorAttachmentTextureView
+        };
+        albedoColorAttachment.loadOp = LoadOp::kClear;
+        albedoColorAttachment.storeOp = StoreOp::kDontCare;
+        albedoColorAttachment.clearValue = { 0.0, 0.0, 0.0, 0.0 };
+
+        ColorAttachment colorAttachment{
+            .renderView = renderView
+        };
+        colorAttachment.loadOp = LoadOp::kClear;
+        colorAttachment.storeOp = StoreOp::kStore;
+        colorAttachment.clearValue = { 0.0, 0.0, 0.0, 0.0 };
+
+        DepthStencilAttachment depthStencilAttachment{
+            .textureView = *m_depthStencilTextureView
+        };
+        depthStencilAttachment.depthLoadOp = LoadOp::kClear;
+        depthStencilAttachment.depthStoreOp = StoreOp::kDontCare;
+        depthStencilAttachment.clearValue = { .depth = 1.0f, .stencil = 0 };
 
         RenderPassTimestampWrites timestampWrites;
         if (m_useTimestamp)
@@ -361,49 +374,36 @@ void VulkanSubpassesSample::draw()
             timestampWrites.endQueryIndex = 1;
         }
 
-        // first pass
-        VulkanRenderPassEncoderDescriptor renderPassEncoderDescriptor{};
-        renderPassEncoderDescriptor.renderPass = vulkanRenderPass.getVkRenderPass();
-        renderPassEncoderDescriptor.framebuffer = vulkanFramebuffer.getVkFrameBuffer();
-        renderPassEncoderDescriptor.renderArea.offset = { 0, 0 };
-        renderPassEncoderDescriptor.renderArea.extent = { m_swapchain->getWidth(), m_swapchain->getHeight() };
-        renderPassEncoderDescriptor.timestampWrites = timestampWrites;
-
-        VkClearValue colorClearValue{};
-        colorClearValue.color.float32[0] = 0.0f;
-        colorClearValue.color.float32[1] = 0.0f;
-        colorClearValue.color.float32[2] = 0.0f;
-        colorClearValue.color.float32[3] = 0.0f;
-        VkClearValue depthClearValue{ .depthStencil = { .depth = 1.0f, .stencil = 0 } };
-        renderPassEncoderDescriptor.clearValues.push_back(colorClearValue);
-        renderPassEncoderDescriptor.clearValues.push_back(colorClearValue);
-        renderPassEncoderDescriptor.clearValues.push_back(colorClearValue);
-        renderPassEncoderDescriptor.clearValues.push_back(colorClearValue);
-        renderPassEncoderDescriptor.clearValues.push_back(depthClearValue);
-
-        auto renderPassEncoder = vulkanCommandEncoder->beginRenderPass(renderPassEncoderDescriptor);
-        VulkanRenderPassEncoder* vulkanRenderPassEncoder = downcast(renderPassEncoder.get());
-        vulkanRenderPassEncoder->setViewport(0, 0, m_width, m_height, 0, 1);
-        vulkanRenderPassEncoder->setScissor(0, 0, m_width, m_height);
+        RenderPassEncoderDescriptor renderPassDescriptor{
+            .colorAttachments = { positionColorAttachment, normalColorAttachment, albedoColorAttachment, colorAttachment },
+            .depthStencilAttachment = depthStencilAttachment,
+            .timestampWrites = timestampWrites,
+            .sampleCount = m_sampleCount,
+            .subpasses = getSubpasses()
+        };
+
+        auto renderPassEncoder = commandEncoder->beginRenderPass(renderPassDescriptor);
+        renderPassEncoder->setViewport(0, 0, m_width, m_height, 0, 1);
+        renderPassEncoder->setScissor(0, 0, m_width, m_height);
 
         // first pass
-        vulkanRenderPassEncoder->setPipeline(*m_offscreen.subPasses.renderPipeline);
-        vulkanRenderPassEncoder->setVertexBuffer(0, *m_offscreen.vertexBuffer);
-        vulkanRenderPassEncoder->setIndexBuffer(*m_offscreen.indexBuffer, IndexFormat::kUint16);
-        vulkanRenderPassEncoder->setBindingGroup(0, *m_offscreen.subPasses.bindingGroups[0]);
-        vulkanRenderPassEncoder->setBindingGroup(1, *m_offscreen.subPasses.bindingGroups[1]);
-        vulkanRenderPassEncoder->drawIndexed(static_cast<uint32_t>(m_offscreen.polygon.indices.size()), 1, 0, 0, 0);
+        renderPassEncoder->setPipeline(*m_offscreen.subPasses.renderPipeline);
+        renderPassEncoder->setVertexBuffer(0, *m_offscreen.vertexBuffer);
+        renderPassEncoder->setIndexBuffer(*m_offscreen.indexBuffer, IndexFormat::kUint16);
+        renderPassEncoder->setBindingGroup(0, *m_offscreen.subPasses.bindingGroups[0]);
+        renderPassEncoder->setBindingGroup(1, *m_offscreen.subPasses.bindingGroups[1]);
+        renderPassEncoder->drawIndexed(static_cast<uint32_t>(m_offscreen.polygon.indices.size()), 1, 0, 0, 0);
 
-        vulkanRenderPassEncoder->nextPass();
+        renderPassEncoder->nextPass();
 
         // second pass
-        vulkanRenderPassEncoder->setPipeline(*m_composition.subPasses.renderPipeline);
-        vulkanRenderPassEncoder->setVertexBuffer(0, *m_composition.vertexBuffer);
-        vulkanRenderPassEncoder->setBindingGroup(0, *m_composition.subPasses.bindingGroups[0]);
-        vulkanRenderPassEncoder->setBindingGroup(1, *m_composition.subPasses.bindingGroups[1]);
-        vulkanRenderPassEncoder->draw(static_cast<uint32_t>(m_composition.vertices.size()));
+        renderPassEncoder->setPipeline(*m_composition.subPasses.renderPipeline);
+        renderPassEncoder->setVertexBuffer(0, *m_composition.vertexBuffer);
+        renderPassEncoder->setBindingGroup(0, *m_composition.subPasses.bindingGroups[0]);
+        renderPassEncoder->setBindingGroup(1, *m_composition.subPasses.bindingGroups[1]);
+        renderPassEncoder->draw(static_cast<uint32_t>(m_composition.vertices.size()));
 
-        vulkanRenderPassEncoder->end();
+        renderPassEncoder->end();
     }
 
     drawImGui(commandEncoder.get(), renderView);
@@ -412,12 +412,12 @@ void VulkanSubpassesSample::draw()
     {
         if (!m_useSubpasses)
         {
-            vulkanCommandEncoder->resolveQuerySet(m_multipass1QuerySet.get(), 0, m_multipass1QuerySet->getCount(), m_multipass1QueryBuffer.get(), 0);
-            vulkanCommandEncoder->resolveQuerySet(m_multipass2QuerySet.get(), 0, m_multipass2QuerySet->getCount(), m_multipass2QueryBuffer.get(), 0);
+            commandEncoder->resolveQuerySet(m_multipass1QuerySet.get(), 0, m_multipass1QuerySet->getCount(), m_multipass1QueryBuffer.get(), 0);
+            commandEncoder->resolveQuerySet(m_multipass2QuerySet.get(), 0, m_multipass2QuerySet->getCount(), m_multipass2QueryBuffer.get(), 0);
         }
         else
         {
-            vulkanCommandEncoder->resolveQuerySet(m_subpassQuerySet.get(), 0, m_subpassQuerySet->getCount(), m_subpassQueryBuffer.get(), 0);
+            commandEncoder->resolveQuerySet(m_subpassQuerySet.get(), 0, m_subpassQuerySet->getCount(), m_subpassQueryBuffer.get(), 0);
         }
     }
 
@@ -457,36 +457,32 @@ void VulkanSubpassesSample::createOffscreenPositionColorAttachmentTexture()
 {
     // render passes
     {
-        VulkanTextureDescriptor descriptor{};
-        descriptor.imageType = VK_IMAGE_TYPE_2D;
-        descriptor.format = VK_FORMAT_R16G16B16A16_UNORM;
-        descriptor.extent = { m_swapchain->getWidth(), m_swapchain->getHeight(), 1 };
+        TextureDescriptor descriptor{};
+        descriptor.type = TextureType::k2D;
+        descriptor.format = TextureFormat::kRGBA_16161616_UInt_Norm;
+        descriptor.width = m_swapchain->getWidth();
+        descriptor.height = m_swapchain->getHeight();
+        descriptor.depth = 1;
         descriptor.mipLevels = 1;
-        descriptor.arrayLayers = 1;
-        descriptor.samples = VK_SAMPLE_COUNT_1_BIT;
-        descriptor.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        descriptor.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-        descriptor.tiling = VK_IMAGE_TILING_OPTIMAL;
-        descriptor.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        m_offscreen.renderPasses.positionColorAttachmentTexture = downcast(m_device.get())->createTexture(descriptor);
+        descriptor.sampleCount = 1;
+        descriptor.usage = TextureUsageFlagBits::kColorAttachment | TextureUsageFlagBits::kTextureBinding;
+
+        m_offscreen.renderPasses.positionColorAttachmentTexture = m_device->createTexture(descriptor);
     }
 
     // subpasses
     {
-        VulkanTextureDescriptor descriptor{};
-        descriptor.imageType = VK_IMAGE_TYPE_2D;
-        descriptor.format = VK_FORMAT_R16G16B16A16_UNORM;
-        descriptor.extent = { m_swapchain->getWidth(), m_swapchain->getHeight(), 1 };
+        TextureDescriptor descriptor{};
+        descriptor.type = TextureType::k2D;
+        descriptor.format = TextureFormat::kRGBA_16161616_UInt_Norm;
+        descriptor.width = m_swapchain->getWidth();
+        descriptor.height = m_swapchain->getHeight();
+        descriptor.depth = 1;
         descriptor.mipLevels = 1;
-        descriptor.arrayLayers = 1;
-        descriptor.samples = VK_SAMPLE_COUNT_1_BIT;
-        descriptor.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        descriptor.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
-        descriptor.tiling = VK_IMAGE_TILING_OPTIMAL;
-        descriptor.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        m_offscreen.subPasses.positionColorAttachmentTexture = downcast(m_device.get())->createTexture(descriptor);
+        descriptor.sampleCount = 1;
+        descriptor.usage = TextureUsageFlagBits::kColorAttachment | TextureUsageFlagBits::kInputAttachment;
+
+        m_offscreen.subPasses.positionColorAttachmentTexture = m_device->createTexture(descriptor);
     }
 }
 
@@ -515,36 +511,32 @@ void VulkanSubpassesSample::createOffscreenNormalColorAttachmentTexture()
 {
     // render passes
     {
-        VulkanTextureDescriptor descriptor{};
-        descriptor.imageType = VK_IMAGE_TYPE_2D;
-        descriptor.format = VK_FORMAT_R16G16B16A16_UNORM;
-        descriptor.extent = { m_swapchain->getWidth(), m_swapchain->getHeight(), 1 };
+        TextureDescriptor descriptor{};
+        descriptor.type = TextureType::k2D;
+        descriptor.format = TextureFormat::kRGBA_16161616_UInt_Norm;
+        descriptor.width = m_swapchain->getWidth();
+        descriptor.height = m_swapchain->getHeight();
+        descriptor.depth = 1;
         descriptor.mipLevels = 1;
-        descriptor.arrayLayers = 1;
-        descriptor.samples = VK_SAMPLE_COUNT_1_BIT;
-        descriptor.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        descriptor.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-        descriptor.tiling = VK_IMAGE_TILING_OPTIMAL;
-        descriptor.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        m_offscreen.renderPasses.normalColorAttachmentTexture = downcast(m_device.get())->createTexture(descriptor);
+        descriptor.sampleCount = 1;
+        descriptor.usage = TextureUsageFlagBits::kColorAttachment | TextureUsageFlagBits::kTextureBinding;
+
+        m_offscreen.renderPasses.normalColorAttachmentTexture = m_device->createTexture(descriptor);
     }
 
     // subpasses
     {
-        VulkanTextureDescriptor descriptor{};
-        descriptor.imageType = VK_IMAGE_TYPE_2D;
-        descriptor.format = VK_FORMAT_R16G16B16A16_UNORM;
-        descriptor.extent = { m_swapchain->getWidth(), m_swapchain->getHeight(), 1 };
+        TextureDescriptor descriptor{};
+        descriptor.type = TextureType::k2D;
+        descriptor.format = TextureFormat::kRGBA_16161616_UInt_Norm;
+        descriptor.width = m_swapchain->getWidth();
+        descriptor.height = m_swapchain->getHeight();
+        descriptor.depth = 1;
         descriptor.mipLevels = 1;
-        descriptor.arrayLayers = 1;
-        descriptor.samples = VK_SAMPLE_COUNT_1_BIT;
-        descriptor.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        descriptor.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
-        descriptor.tiling = VK_IMAGE_TILING_OPTIMAL;
-        descriptor.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        m_offscreen.subPasses.normalColorAttachmentTexture = downcast(m_device.get())->createTexture(descriptor);
+        descriptor.sampleCount = 1;
+        descriptor.usage = TextureUsageFlagBits::kColorAttachment | TextureUsageFlagBits::kInputAttachment;
+
+        m_offscreen.subPasses.normalColorAttachmentTexture = m_device->createTexture(descriptor);
     }
 }
 
@@ -573,36 +565,32 @@ void VulkanSubpassesSample::createOffscreenAlbedoColorAttachmentTexture()
 {
     // render passes
     {
-        VulkanTextureDescriptor descriptor{};
-        descriptor.imageType = VK_IMAGE_TYPE_2D;
-        descriptor.format = VK_FORMAT_B8G8R8A8_UNORM;
-        descriptor.extent = { m_swapchain->getWidth(), m_swapchain->getHeight(), 1 };
+        TextureDescriptor descriptor{};
+        descriptor.type = TextureType::k2D;
+        descriptor.format = TextureFormat::kBGRA_8888_UInt_Norm;
+        descriptor.width = m_swapchain->getWidth();
+        descriptor.height = m_swapchain->getHeight();
+        descriptor.depth = 1;
         descriptor.mipLevels = 1;
-        descriptor.arrayLayers = 1;
-        descriptor.samples = VK_SAMPLE_COUNT_1_BIT;
-        descriptor.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        descriptor.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-        descriptor.tiling = VK_IMAGE_TILING_OPTIMAL;
-        descriptor.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        m_offscreen.renderPasses.albedoColorAttachmentTexture = downcast(m_device.get())->createTexture(descriptor);
+        descriptor.sampleCount = 1;
+        descriptor.usage = TextureUsageFlagBits::kColorAttachment | TextureUsageFlagBits::kTextureBinding;
+
+        m_offscreen.renderPasses.albedoColorAttachmentTexture = m_device->createTexture(descriptor);
     }
 
     // subpasses
     {
-        VulkanTextureDescriptor descriptor{};
-        descriptor.imageType = VK_IMAGE_TYPE_2D;
-        descriptor.format = VK_FORMAT_B8G8R8A8_UNORM;
-        descriptor.extent = { m_swapchain->getWidth(), m_swapchain->getHeight(), 1 };
+        TextureDescriptor descriptor{};
+        descriptor.type = TextureType::k2D;
+        descriptor.format = TextureFormat::kBGRA_8888_UInt_Norm;
+        descriptor.width = m_swapchain->getWidth();
+        descriptor.height = m_swapchain->getHeight();
+        descriptor.depth = 1;
         descriptor.mipLevels = 1;
-        descriptor.arrayLayers = 1;
-        descriptor.samples = VK_SAMPLE_COUNT_1_BIT;
-        descriptor.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        descriptor.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
-        descriptor.tiling = VK_IMAGE_TILING_OPTIMAL;
-        descriptor.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        m_offscreen.subPasses.albedoColorAttachmentTexture = downcast(m_device.get())->createTexture(descriptor);
+        descriptor.sampleCount = 1;
+        descriptor.usage = TextureUsageFlagBits::kColorAttachment | TextureUsageFlagBits::kInputAttachment;
+
+        m_offscreen.subPasses.albedoColorAttachmentTexture = m_device->createTexture(descriptor);
     }
 }
 
@@ -1050,8 +1038,7 @@ void VulkanSubpassesSample::createOffscreenPipelineLayout()
         PipelineLayoutDescriptor descriptor{};
         descriptor.layouts = { *m_offscreen.renderPasses.bindingGroupLayouts[0], *m_offscreen.renderPasses.bindingGroupLayouts[1] };
 
-        auto vulkanDevice = downcast(m_device.get());
-        m_offscreen.renderPasses.pipelineLayout = vulkanDevice->createPipelineLayout(descriptor);
+        m_offscreen.renderPasses.pipelineLayout = m_device->createPipelineLayout(descriptor);
     }
 
     // subpasses
@@ -1059,8 +1046,7 @@ void VulkanSubpassesSample::createOffscreenPipelineLayout()
         PipelineLayoutDescriptor descriptor{};
         descriptor.layouts = { *m_offscreen.subPasses.bindingGroupLayouts[0], *m_offscreen.subPasses.bindingGroupLayouts[1] };
 
-        auto vulkanDevice = downcast(m_device.get());
-        m_offscreen.subPasses.pipelineLayout = vulkanDevice->createPipelineLayout(descriptor);
+        m_offscreen.subPasses.pipelineLayout = m_device->createPipelineLayout(descriptor);
     }
 }
 
@@ -1163,8 +1149,7 @@ void VulkanSubpassesSample::createOffscreenPipeline()
             depthStencil
         };
 
-        auto vulkanDevice = downcast(m_device.get());
-        m_offscreen.renderPasses.renderPipeline = vulkanDevice->createRenderPipeline(descriptor);
+        m_offscreen.renderPasses.renderPipeline = m_device->createRenderPipeline(descriptor);
     }
 
     // subpasses
@@ -1253,35 +1238,24 @@ void VulkanSubpassesSample::createOffscreenPipeline()
         DepthStencilStage depthStencil{};
         depthStencil.format = m_depthStencilTexture->getFormat();
 
+        RenderPipelineSubpass subpass{
+            .colorFormats = { positionTarget.format, normalTarget.format, albedoTarget.format, m_swapchain->getTextureFormat() },
+            .depthStencilFormat = depthStencil.format,
+            .subpasses = getSubpasses(),
+            .index = 0
+        };
+
         RenderPipelineDescriptor descriptor{
             { *m_offscreen.subPasses.pipelineLayout },
             inputAssembly,
             vertexStage,
             rasterizationStage,
             fragmentStage,
-            depthStencil
+            depthStencil,
+            subpass
         };
 
-        VulkanRenderPipelineDescriptor vkdescriptor{
-            .stages = generateShaderStageCreateInfo(descriptor),
-            .inputAssemblyState = generateInputAssemblyStateCreateInfo(descriptor),
-            .vertexInputState = generateVertexInputStateCreateInfo(descriptor),
-            .viewportState = generateViewportStateCreateInfo(descriptor),
-            .rasterizationState = generateRasterizationStateCreateInfo(descriptor),
-            .multisampleState = generateMultisampleStateCreateInfo(descriptor),
-            .depthStencilState = generateDepthStencilStateCreateInfo(descriptor),
-            .colorBlendState = generateColorBlendStateCreateInfo(descriptor),
-            .dynamicState = generateDynamicStateCreateInfo(descriptor),
-            .layout = downcast(descriptor.layout),
-            .renderPass = getSubpassesRenderPass(),
-            // .renderPass = getSubpassesCompatibleRenderPass(),
-            .subpass = 0,
-            .basePipelineHandle = VK_NULL_HANDLE,
-            .basePipelineIndex = -1,
-        };
-
-        auto vulkanDevice = downcast(m_device.get());
-        m_offscreen.subPasses.renderPipeline = vulkanDevice->createRenderPipeline(vkdescriptor);
+        m_offscreen.subPasses.renderPipeline = m_device->createRenderPipeline(descriptor);
     }
 }
 
@@ -1334,35 +1308,34 @@ void VulkanSubpassesSample::createCompositionBindingGroupLayout()
         m_composition.subPasses.bindingGroupLayouts.resize(2);
 
         {
-            VkDescriptorSetLayoutBinding uniformBufferBindingLayout{};
-            uniformBufferBindingLayout.binding = 0;
-            uniformBufferBindingLayout.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-            uniformBufferBindingLayout.descriptorCount = 1;
-            uniformBufferBindingLayout.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            BufferBindingLayout uniformBufferBindingLayout{};
+            uniformBufferBindingLayout.index = 0;
+            uniformBufferBindingLayout.stages = BindingStageFlagBits::kFragmentStage;
+            uniformBufferBindingLayout.type = BufferBindingType::kUniform;
 
-            VulkanBindingGroupLayoutDescriptor descriptor{};
+            BindingGroupLayoutDescriptor descriptor{};
             descriptor.buffers = { uniformBufferBindingLayout };
 
-            m_composition.subPasses.bindingGroupLayouts[0] = downcast(m_device.get())->createBindingGroupLayout(descriptor);
+            m_composition.subPasses.bindingGroupLayouts[0] = m_device->createBindingGroupLayout(descriptor);
         }
 
         {
-            VkDescriptorSetLayoutBinding positionTextureBindingLayout{};
-            positionTextureBindingLayout.binding = 0;
-            positionTextureBindingLayout.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-            positionTextureBindingLayout.descriptorCount = 1;
-            positionTextureBindingLayout.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            InputAttachmentBindingLayout positionInputAttachmentBindingLayout{};
+            positionInputAttachmentBindingLayout.index = 0;
+            positionInputAttachmentBindingLayout.stages = BindingStageFlagBits::kFragmentStage;
 
-            VkDescriptorSetLayoutBinding normalTextureBindingLayout = positionTextureBindingLayout;
-            normalTextureBindingLayout.binding = 1;
+            InputAttachmentBindingLayout normalInputAttachmentBindingLayout{};
+            normalInputAttachmentBindingLayout.index = 1;
+            normalInputAttachmentBindingLayout.stages = BindingStageFlagBits::kFragmentStage;
 
-            VkDescriptorSetLayoutBinding albedoTextureBindingLayout = positionTextureBindingLayout;
-            albedoTextureBindingLayout.binding = 2;
+            InputAttachmentBindingLayout albedoInputAttachmentBindingLayout{};
+            albedoInputAttachmentBindingLayout.index = 2;
+            albedoInputAttachmentBindingLayout.stages = BindingStageFlagBits::kFragmentStage;
 
-            VulkanBindingGroupLayoutDescriptor descriptor{};
-            descriptor.textures = { positionTextureBindingLayout, normalTextureBindingLayout, albedoTextureBindingLayout };
+            BindingGroupLayoutDescriptor descriptor{};
+            descriptor.inputAttachments = { positionInputAttachmentBindingLayout, normalInputAttachmentBindingLayout, albedoInputAttachmentBindingLayout };
 
-            m_composition.subPasses.bindingGroupLayouts[1] = downcast(m_device.get())->createBindingGroupLayout(descriptor);
+            m_composition.subPasses.bindingGroupLayouts[1] = m_device->createBindingGroupLayout(descriptor);
         }
     }
 }
@@ -1500,7 +1473,7 @@ void VulkanSubpassesSample::createCompositionBindingGroup()
 
             BindingGroupDescriptor descriptor{
                 .layout = *m_composition.subPasses.bindingGroupLayouts[1],
-                .textures = { positionTextureBinding, normalTextureBinding, albedoTextureBinding }
+                .inputAttachments = { positionTextureBinding, normalTextureBinding, albedoTextureBinding }
             };
 
             m_composition.subPasses.bindingGroups[1] = m_device->createBindingGroup(descriptor);
@@ -1515,8 +1488,7 @@ void VulkanSubpassesSample::createCompositionPipelineLayout()
         PipelineLayoutDescriptor descriptor{};
         descriptor.layouts = { *m_composition.renderPasses.bindingGroupLayouts[0] };
 
-        auto vulkanDevice = downcast(m_device.get());
-        m_composition.renderPasses.pipelineLayout = vulkanDevice->createPipelineLayout(descriptor);
+        m_composition.renderPasses.pipelineLayout = m_device->createPipelineLayout(descriptor);
     }
 
     // subpasses
@@ -1524,8 +1496,7 @@ void VulkanSubpassesSample::createCompositionPipelineLayout()
         PipelineLayoutDescriptor descriptor{};
         descriptor.layouts = { *m_composition.subPasses.bindingGroupLayouts[0], *m_composition.subPasses.bindingGroupLayouts[1] };
 
-        auto vulkanDevice = downcast(m_device.get());
-        m_composition.subPasses.pipelineLayout = vulkanDevice->createPipelineLayout(descriptor);
+        m_composition.subPasses.pipelineLayout = m_device->createPipelineLayout(descriptor);
     }
 }
 
@@ -1685,9 +1656,18 @@ void VulkanSubpassesSample::createCompositionPipeline()
             { target }
         };
 
-        // DepthStencil
-        DepthStencilStage depthStencilStage{};
-        depthStencilStage.format = m_depthStencilTexture->getFormat();
+        // Subpass
+        RenderPipelineSubpass subpass{
+            .colorFormats = {
+                m_offscreen.subPasses.positionColorAttachmentTexture->getFormat(),
+                m_offscreen.subPasses.normalColorAttachmentTexture->getFormat(),
+                m_offscreen.subPasses.albedoColorAttachmentTexture->getFormat(),
+                m_swapchain->getTextureFormat(),
+            },
+            .depthStencilFormat = m_depthStencilTexture->getFormat(),
+            .subpasses = getSubpasses(),
+            .index = 1
+        };
 
         RenderPipelineDescriptor descriptor{
             { *m_composition.subPasses.pipelineLayout },
@@ -1695,30 +1675,11 @@ void VulkanSubpassesSample::createCompositionPipeline()
             vertexStage,
             rasterizationStage,
             fragmentStage,
-            depthStencilStage
+            std::nullopt,
+            subpass
         };
 
-        VulkanRenderPipelineDescriptor vkdescriptor{
-            .stages = generateShaderStageCreateInfo(descriptor),
-            .inputAssemblyState = generateInputAssemblyStateCreateInfo(descriptor),
-            .vertexInputState = generateVertexInputStateCreateInfo(descriptor),
-            .viewportState = generateViewportStateCreateInfo(descriptor),
-            .rasterizationState = generateRasterizationStateCreateInfo(descriptor),
-            .multisampleState = generateMultisampleStateCreateInfo(descriptor),
-            .depthStencilState = generateDepthStencilStateCreateInfo(descriptor),
-            .colorBlendState = generateColorBlendStateCreateInfo(descriptor),
-            .dynamicState = generateDynamicStateCreateInfo(descriptor),
-            .layout = downcast(descriptor.layout),
-            .renderPass = getSubpassesRenderPass(),
-            // .renderPass = getSubpassesCompatibleRenderPass(),
-            .subpass = 1,
-            .basePipelineHandle = VK_NULL_HANDLE,
-            .basePipelineIndex = -1,
-        };
-        vkdescriptor.depthStencilState.depthWriteEnable = false;
-
-        auto vulkanDevice = downcast(m_device.get());
-        m_composition.subPasses.renderPipeline = vulkanDevice->createRenderPipeline(vkdescriptor);
+        m_composition.subPasses.renderPipeline = m_device->createRenderPipeline(descriptor);
     }
 }
 
@@ -1802,533 +1763,13 @@ void VulkanSubpassesSample::createCompositionVertexBuffer()
     vertexBuffer->unmap();
 }
 
-VulkanRenderPass& VulkanSubpassesSample::getSubpassesRenderPass()
+std::vector<SubpassDescriptor> VulkanSubpassesSample::getSubpasses() const
 {
-    VulkanRenderPassDescriptor renderPassDescriptor{};
-
-    // attachment descriptors
-    renderPassDescriptor.attachmentDescriptions.resize(5);
-    {
-        // first pass
-        {
-            // position
-            {
-                auto texture = downcast(m_offscreen.subPasses.positionColorAttachmentTextureView->getTexture());
-
-                VkAttachmentDescription attachment{};
-                attachment.format = ToVkFormat(texture->getFormat());
-                attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-                attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-                attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-                attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-
-                renderPassDescriptor.attachmentDescriptions[0] = attachment;
-            }
-
-            // normal
-            {
-                auto texture = downcast(m_offscreen.subPasses.normalColorAttachmentTextureView->getTexture());
-
-                VkAttachmentDescription attachment{};
-                attachment.format = ToVkFormat(texture->getFormat());
-                attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-                attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-                attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-                attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-
-                renderPassDescriptor.attachmentDescriptions[1] = attachment;
-            }
-
-            // albedo
-            {
-                auto texture = downcast(m_offscreen.subPasses.albedoColorAttachmentTextureView->getTexture());
-
-                VkAttachmentDescription attachment{};
-                attachment.format = ToVkFormat(texture->getFormat());
-                attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-                attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-                attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-                attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-
-                renderPassDescriptor.attachmentDescriptions[2] = attachment;
-            }
-        }
-
-        // second pass
-        {
-            auto& swapchain = downcast(*m_swapchain);
-
-            VkAttachmentDescription attachment{};
-            attachment.format = ToVkFormat(swapchain.getTextureFormat());
-            attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-            attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-            attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            attachment.samples = ToVkSampleCountFlagBits(m_sampleCount);
-
-            renderPassDescriptor.attachmentDescriptions[3] = attachment;
-        }
-
-        // depth
-        {
-            auto texture = downcast(m_depthStencilTextureView->getTexture());
-
-            VkAttachmentDescription attachment{};
-            attachment.format = ToVkFormat(texture->getFormat());
-            attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-            attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-            attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            attachment.samples = ToVkSampleCountFlagBits(m_sampleCount);
-
-            renderPassDescriptor.attachmentDescriptions[4] = attachment;
-        }
-    }
-
-    // subpass descriptions
-    renderPassDescriptor.subpassDescriptions.resize(2);
-    {
-        // first pass
-        {
-            VulkanSubpassDescription description{};
-            description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-            // color attachment
-            {
-                description.colorAttachments.resize(3);
-                // position attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 0;
-                    reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-                    description.colorAttachments[0] = reference;
-                }
-                // normal attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 1;
-                    reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-                    description.colorAttachments[1] = reference;
-                }
-
-                // albedo attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 2;
-                    reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-                    description.colorAttachments[2] = reference;
-                }
-            }
-            // depth attachment
-            {
-                VkAttachmentReference reference{};
-                reference.attachment = 4;
-                reference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-                description.depthStencilAttachment = reference;
-            }
-
-            renderPassDescriptor.subpassDescriptions[0] = description;
-        }
-        // second pass
-        {
-            VulkanSubpassDescription description{};
-            description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-            // input attachment
-            {
-                description.inputAttachments.resize(3);
-                // position attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 0;
-                    reference.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-                    description.inputAttachments[0] = reference;
-                }
-
-                // normal attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 1;
-                    reference.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-                    description.inputAttachments[1] = reference;
-                }
-
-                // albedo attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 2;
-                    reference.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-                    description.inputAttachments[2] = reference;
-                }
-            }
-            // color attachment
-            {
-                description.colorAttachments.resize(1);
-                // render attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 3;
-                    reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-                    description.colorAttachments[0] = reference;
-                }
-            }
-            // depth attachment
-            {
-                VkAttachmentReference reference{};
-                reference.attachment = 4;
-                reference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-                description.depthStencilAttachment = reference;
-            }
-
-            renderPassDescriptor.subpassDescriptions[1] = description;
-        }
-    }
-
-    // subpass dependencies
-    {
-        renderPassDescriptor.subpassDependencies.resize(3);
-        {
-            VkSubpassDependency subpassDependency{};
-            subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-            subpassDependency.dstSubpass = 0;
-            subpassDependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-            subpassDependency.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-            subpassDependency.srcAccessMask = 0;
-            subpassDependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            subpassDependency.dependencyFlags = 0;
-
-            renderPassDescriptor.subpassDependencies[0] = subpassDependency;
-        }
-        {
-            VkSubpassDependency subpassDependency{};
-            subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-            subpassDependency.dstSubpass = 0;
-            subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            subpassDependency.srcAccessMask = 0;
-            subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            subpassDependency.dependencyFlags = 0;
-
-            renderPassDescriptor.subpassDependencies[1] = subpassDependency;
-        }
-        {
-            VkSubpassDependency subpassDependency{};
-            subpassDependency.srcSubpass = 0;
-            subpassDependency.dstSubpass = 1;
-            subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            subpassDependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            subpassDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            subpassDependency.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
-            subpassDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-            renderPassDescriptor.subpassDependencies[2] = subpassDependency;
-        }
-    }
-
-    auto& vulkanDevice = downcast(*m_device);
-    return vulkanDevice.getRenderPass(renderPassDescriptor);
-}
-
-VulkanRenderPass& VulkanSubpassesSample::getSubpassesCompatibleRenderPass()
-{
-    VulkanRenderPassDescriptor renderPassDescriptor{};
-
-    // attachment descriptors
-    renderPassDescriptor.attachmentDescriptions.resize(5);
-    {
-        // first pass
-        {
-            // position
-            {
-                auto texture = downcast(m_offscreen.subPasses.positionColorAttachmentTextureView->getTexture());
-
-                VkAttachmentDescription attachment{};
-                attachment.format = ToVkFormat(texture->getFormat());
-                attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-                attachment.finalLayout = VK_IMAGE_LAYOUT_GENERAL;
-                attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                attachment.samples = ToVkSampleCountFlagBits(m_sampleCount);
-
-                renderPassDescriptor.attachmentDescriptions[0] = attachment;
-            }
-
-            // normal
-            {
-                auto texture = downcast(m_offscreen.subPasses.normalColorAttachmentTextureView->getTexture());
-
-                VkAttachmentDescription attachment{};
-                attachment.format = ToVkFormat(texture->getFormat());
-                attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-                attachment.finalLayout = VK_IMAGE_LAYOUT_GENERAL;
-                attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                attachment.samples = ToVkSampleCountFlagBits(m_sampleCount);
-
-                renderPassDescriptor.attachmentDescriptions[1] = attachment;
-            }
-
-            // albedo
-            {
-                auto texture = downcast(m_offscreen.subPasses.albedoColorAttachmentTextureView->getTexture());
-
-                VkAttachmentDescription attachment{};
-                attachment.format = ToVkFormat(texture->getFormat());
-                attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-                attachment.finalLayout = VK_IMAGE_LAYOUT_GENERAL;
-                attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-                attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-                attachment.samples = ToVkSampleCountFlagBits(m_sampleCount);
-
-                renderPassDescriptor.attachmentDescriptions[2] = attachment;
-            }
-        }
-
-        // second pass
-        {
-            auto& swapchain = downcast(*m_swapchain);
-
-            VkAttachmentDescription attachment{};
-            attachment.format = ToVkFormat(swapchain.getTextureFormat());
-            attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            attachment.finalLayout = VK_IMAGE_LAYOUT_GENERAL;
-            attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            attachment.samples = ToVkSampleCountFlagBits(m_sampleCount);
-
-            renderPassDescriptor.attachmentDescriptions[3] = attachment;
-        }
-
-        // depth
-        {
-            auto texture = downcast(m_depthStencilTextureView->getTexture());
-
-            VkAttachmentDescription attachment{};
-            attachment.format = ToVkFormat(texture->getFormat());
-            attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            attachment.finalLayout = VK_IMAGE_LAYOUT_GENERAL;
-            attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-            attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            attachment.samples = ToVkSampleCountFlagBits(m_sampleCount);
-
-            renderPassDescriptor.attachmentDescriptions[4] = attachment;
-        }
-    }
-
-    // subpass descriptions
-    renderPassDescriptor.subpassDescriptions.resize(2);
-    {
-        // first pass
-        {
-            VulkanSubpassDescription description{};
-            description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-            // color attachment
-            {
-                description.colorAttachments.resize(3);
-                // position attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 0;
-                    reference.layout = VK_IMAGE_LAYOUT_GENERAL;
-
-                    description.colorAttachments[0] = reference;
-                }
-                // normal attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 1;
-                    reference.layout = VK_IMAGE_LAYOUT_GENERAL;
-
-                    description.colorAttachments[1] = reference;
-                }
-
-                // albedo attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 2;
-                    reference.layout = VK_IMAGE_LAYOUT_GENERAL;
-
-                    description.colorAttachments[2] = reference;
-                }
-            }
-            // depth attachment
-            {
-                VkAttachmentReference reference{};
-                reference.attachment = 4;
-                reference.layout = VK_IMAGE_LAYOUT_GENERAL;
-
-                description.depthStencilAttachment = reference;
-            }
-
-            renderPassDescriptor.subpassDescriptions[0] = description;
-        }
-        // second pass
-        {
-            VulkanSubpassDescription description{};
-            description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-            // color attachment
-            {
-                description.colorAttachments.resize(1);
-                // render attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 3;
-                    reference.layout = VK_IMAGE_LAYOUT_GENERAL;
-
-                    description.colorAttachments[0] = reference;
-                }
-            }
-            // input attachment
-            {
-                description.inputAttachments.resize(3);
-                // position attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 0;
-                    reference.layout = VK_IMAGE_LAYOUT_GENERAL;
-
-                    description.inputAttachments[0] = reference;
-                }
-
-                // normal attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 1;
-                    reference.layout = VK_IMAGE_LAYOUT_GENERAL;
-
-                    description.inputAttachments[1] = reference;
-                }
-
-                // albedo attachment
-                {
-                    VkAttachmentReference reference{};
-                    reference.attachment = 2;
-                    reference.layout = VK_IMAGE_LAYOUT_GENERAL;
-
-                    description.inputAttachments[2] = reference;
-                }
-            }
-            // depth attachment
-            {
-                VkAttachmentReference reference{};
-                reference.attachment = 4;
-                reference.layout = VK_IMAGE_LAYOUT_GENERAL;
-
-                description.depthStencilAttachment = reference;
-            }
-
-            renderPassDescriptor.subpassDescriptions[1] = description;
-        }
-    }
-
-    // subpass dependencies
-    {
-        renderPassDescriptor.subpassDependencies.resize(4);
-        {
-            VkSubpassDependency subpassDependency{};
-            subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-            subpassDependency.dstSubpass = 0;
-            subpassDependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-            subpassDependency.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-            subpassDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            subpassDependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            subpassDependency.dependencyFlags = 0;
-
-            renderPassDescriptor.subpassDependencies[0] = subpassDependency;
-        }
-        {
-            VkSubpassDependency subpassDependency{};
-            subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-            subpassDependency.dstSubpass = 0;
-            subpassDependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-            subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            subpassDependency.srcAccessMask = 0;
-            subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            subpassDependency.dependencyFlags = 0;
-
-            renderPassDescriptor.subpassDependencies[1] = subpassDependency;
-        }
-        {
-            VkSubpassDependency subpassDependency{};
-            subpassDependency.srcSubpass = 0;
-            subpassDependency.dstSubpass = 1;
-            subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            subpassDependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            subpassDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            subpassDependency.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
-            subpassDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-            renderPassDescriptor.subpassDependencies[2] = subpassDependency;
-        }
-        {
-            VkSubpassDependency subpassDependency{};
-            subpassDependency.srcSubpass = 0;
-            subpassDependency.dstSubpass = 1;
-            subpassDependency.srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-            subpassDependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            subpassDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            subpassDependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-            subpassDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-            renderPassDescriptor.subpassDependencies[3] = subpassDependency;
-        }
-    }
-
-    auto& vulkanDevice = downcast(*m_device);
-    return vulkanDevice.getRenderPass(renderPassDescriptor);
-}
-
-VulkanFramebuffer& VulkanSubpassesSample::getSubpassesFrameBuffer(TextureView& renderView)
-{
-    VulkanFramebufferDescriptor descriptor{};
-    descriptor.renderPass = getSubpassesRenderPass().getVkRenderPass();
-    descriptor.width = m_swapchain->getWidth();
-    descriptor.height = m_swapchain->getHeight();
-    descriptor.layers = 1;
-
-    // first pass
-    descriptor.attachments.push_back(downcast(*m_offscreen.subPasses.positionColorAttachmentTextureView).getVkImageView());
-    descriptor.attachments.push_back(downcast(*m_offscreen.subPasses.normalColorAttachmentTextureView).getVkImageView());
-    descriptor.attachments.push_back(downcast(*m_offscreen.subPasses.albedoColorAttachmentTextureView).getVkImageView());
-
-    // second pass
-    descriptor.attachments.push_back(downcast(renderView).getVkImageView());
-
-    // depth
-    descriptor.attachments.push_back(downcast(*m_depthStencilTextureView).getVkImageView());
-
-    auto& vulkanDevice = downcast(*m_device);
-    return vulkanDevice.getFrameBuffer(descriptor);
+    // first subpass writes g-buffers, second subpass reads them at the same pixel and writes the swapchain texture.
+    return {
+        { .colorAttachments = { 0, 1, 2 } },
+        { .colorAttachments = { 3 }, .inputAttachments = { 0, 1, 2 }, .depthStencil = false },
+    };
 }
 
 void VulkanSubpassesSample::createDepthStencilTexture()
@@ -15,6 +15,7 @@
 #include "jipu/device.h"
 #include "jipu/instance.h"
 #include "jipu/physical_device.h"
+#include "jipu/pipeline.h"
 #include "jipu/pipeline_layout.h"
 #include "jipu/query_set.h"
 #include "jipu/queue.h"
@@ -22,15 +23,11 @@
 #include "jipu/surface.h"
 #include "jipu/swapchain.h"
 
-#include "vulkan_pipeline.h"
-
 #include "khronos_texture.h"
 
 namespace jipu
 {
 
-class VulkanFramebuffer;
-class VulkanRenderPass;
 class VulkanSubpassesSample : public Sample
 {
 public:
@@ -84,9 +81,7 @@ private:
     void createMultipassQuerySet();
     void createSubpassQuerySet();
 
-    VulkanRenderPass& getSubpassesRenderPass();
-    VulkanRenderPass& getSubpassesCompatibleRenderPass();
-    VulkanFramebuffer& getSubpassesFrameBuffer(TextureView& renderView);
+    std::vector<SubpassDescriptor> getSubpasses() const;
 
 private:
     struct CompositionUBO
@@ -82,9 +82,6 @@ void Im_Gui::init(Device* device, Queue* queue, Swapchain& swapchain)
     m_device = device;
     m_queue = queue;
 
-    CommandBufferDescriptor commandBufferDescriptor{};
-    m_commandBuffer = device->createCommandBuffer(commandBufferDescriptor);
-
 #if defined(__ANDROID__)
     m_padding.top = 80.0f;
     m_padding.bottom = 170.0f;
@@ -150,47 +147,27 @@ void Im_Gui::init(Device* device, Queue* queue, Swapchain& swapchain)
         m_fontTextureView = m_fontTexture->createTextureView(fontTextureViewDescriptor);
     }
 
-    // create font staging buffer.
+    // upload font data. it is submitted with the next submission of the queue.
     {
-        BufferDescriptor fontBufferDescriptor{};
-        fontBufferDescriptor.size = fontTexWidth * fontTexHeight * 4 * sizeof(FontDataType);
-        fontBufferDescriptor.usage = BufferUsageFlagBits::kCopySrc;
-
-        m_fontBuffer = device->createBuffer(fontBufferDescriptor);
-
-        void* fontGPUMappedPointer = m_fontBuffer->map();
-        memcpy(fontGPUMappedPointer, fontData, fontBufferDescriptor.size);
-        m_fontBuffer->unmap();
-    }
-
-    // copy buffer to texture
-    {
-        BlitTextureBuffer blitTextureBuffer{
-            .buffer = *m_fontBuffer,
-            .offset = 0,
-            .bytesPerRow = 0,
-            .rowsPerTexture = 0,
-        };
-
         uint32_t channel = 4;
         uint32_t bytesPerData = sizeof(FontDataType);
-        blitTextureBuffer.bytesPerRow = bytesPerData * m_fontTexture->getWidth() * channel;
-        blitTextureBuffer.rowsPerTexture = m_fontTexture->getHeight();
 
         BlitTexture blitTexture{
             .texture = *m_fontTexture,
             .aspect = TextureAspectFlagBits::kColor
         };
+        TextureDataLayout dataLayout{
+            .offset = 0,
+            .bytesPerRow = bytesPerData * m_fontTexture->getWidth() * channel,
+            .rowsPerTexture = m_fontTexture->getHeight(),
+        };
         Extent3D extent{};
         extent.width = m_fontTexture->getWidth();
         extent.height = m_fontTexture->getHeight();
         extent.depth = 1;
 
-        CommandEncoderDescriptor commandEncoderDescriptor{};
-        std::unique_ptr<CommandEncoder> commandEncoder = m_commandBuffer->createCommandEncoder(commandEncoderDescriptor);
-        commandEncoder->copyBufferToTexture(blitTextureBuffer, blitTexture, extent);
-
-        queue->submit({ commandEncoder->finish() });
+        const uint64_t fontDataSize = fontTexWidth * fontTexHeight * channel * bytesPerData;
+        device->getUploadManager().uploadTexture(blitTexture, fontData, fontDataSize, dataLayout, extent);
     }
 
     // create uniform buffer
@@ -515,7 +492,6 @@ void Im_Gui::clear()
     m_fontTextureView.reset();
     m_fontTexture.reset();
 
-    m_fontBuffer.reset();
     m_uniformBuffer.reset();
     m_vertexBuffer.reset();
     m_indexBuffer.reset();
@@ -524,8 +500,6 @@ void Im_Gui::clear()
     m_pipelineLayout.reset();
     m_bindingGroups.clear();
     m_bindingGroupLayouts.clear();
-
-    m_commandBuffer.reset();
 }
 
 } // namespace jipu
\ No newline at end of file
@@ -1,11 +1,61 @@
 #include "khronos_texture.h"
 
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 
 namespace jipu
 {
 
+namespace
+{
+
+// VkFormat of ktx2 files.
+TextureFormat toTextureFormatFromVk(uint32_t vkFormat)
+{
+    switch (vkFormat)
+    {
+    case 23: // VK_FORMAT_R8G8B8_UNORM
+        return TextureFormat::kRGB_888_UInt_Norm;
+    case 29: // VK_FORMAT_R8G8B8_SRGB
+        return TextureFormat::kRGB_888_UInt_Norm_SRGB;
+    case 37: // VK_FORMAT_R8G8B8A8_UNORM
+        return TextureFormat::kRGBA_8888_UInt_Norm;
+    case 43: // VK_FORMAT_R8G8B8A8_SRGB
+        return TextureFormat::kRGBA_8888_UInt_Norm_SRGB;
+    case 44: // VK_FORMAT_B8G8R8A8_UNORM
+        return TextureFormat::kBGRA_8888_UInt_Norm;
+    case 50: // VK_FORMAT_B8G8R8A8_SRGB
+        return TextureFormat::kBGRA_8888_UInt_Norm_SRGB;
+    case 91: // VK_FORMAT_R16G16B16A16_UNORM
+        return TextureFormat::kRGBA_16161616_UInt_Norm;
+    default:
+        throw std::runtime_error(fmt::format("{} VkFormat of KTX is not supported.", vkFormat));
+    }
+}
+
+// GL internal format of ktx1 files.
+TextureFormat toTextureFormatFromGL(uint32_t glInternalformat)
+{
+    switch (glInternalformat)
+    {
+    case 0x8051: // GL_RGB8
+        return TextureFormat::kRGB_888_UInt_Norm;
+    case 0x8C41: // GL_SRGB8
+        return TextureFormat::kRGB_888_UInt_Norm_SRGB;
+    case 0x8058: // GL_RGBA8
+        return TextureFormat::kRGBA_8888_UInt_Norm;
+    case 0x8C43: // GL_SRGB8_ALPHA8
+        return TextureFormat::kRGBA_8888_UInt_Norm_SRGB;
+    case 0x805B: // GL_RGBA16
+        return TextureFormat::kRGBA_16161616_UInt_Norm;
+    default:
+        throw std::runtime_error(fmt::format("{:#x} GL internal format of KTX is not supported.", glInternalformat));
+    }
+}
+
+} // namespace
+
 KTX::KTX(const std::filesystem::path& path)
 {
     ktxResult ret = ktxTexture_CreateFromNamedFile(path.string().c_str(),
@@ -55,4 +105,33 @@ int KTX::getChannel() const
     return ktxTexture_GetElementSize(m_texture);
 }
 
+int KTX::getMipLevels() const
+{
+    return m_texture->numLevels;
+}
+
+TextureFormat KTX::getFormat() const
+{
+    if (m_texture->classId == ktxTexture2_c)
+        return toTextureFormatFromVk(reinterpret_cast<ktxTexture2*>(m_texture)->vkFormat);
+
+    return toTextureFormatFromGL(reinterpret_cast<ktxTexture1*>(m_texture)->glInternalformat);
+}
+
+void* KTX::getPixels(uint32_t mipLevel) const
+{
+    ktx_size_t offset = 0;
+    if (ktxTexture_GetImageOffset(m_texture, mipLevel, 0, 0, &offset) != KTX_SUCCESS)
+    {
+        throw std::runtime_error("Failed to get the image offset of KTX.");
+    }
+
+    return ktxTexture_GetData(m_texture) + offset;
+}
+
+uint64_t KTX::getSize(uint32_t mipLevel) const
+{
+    return ktxTexture_GetImageSize(m_texture, mipLevel);
+}
+
 } // namespace jipu
\ No newline at end of file
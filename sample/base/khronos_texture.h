@@ -2,6 +2,7 @@
 
 #include <filesystem>
 
+#include <jipu/texture.h>
 #include <ktx.h>
 
 namespace jipu
@@ -19,6 +20,12 @@ public:
     int getWidth() const;
     int getHeight() const;
     int getChannel() const;
+    int getMipLevels() const;
+    /// @brief throws if the format of the file is not supported.
+    TextureFormat getFormat() const;
+
+    void* getPixels(uint32_t mipLevel) const;
+    uint64_t getSize(uint32_t mipLevel) const;
 
 private:
     ktxTexture* m_texture = nullptr;
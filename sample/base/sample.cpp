@@ -232,6 +232,29 @@ void Sample::profilingWindow()
             drawPolyline("FPS", m_fps.getAll());
             ImGui::Separator();
 
+            ImGui::Text("Device Caches");
+            ImGui::Separator();
+            if (m_device)
+            {
+                const auto statistics = m_device->getStatistics();
+                for (const auto& cache : statistics.caches)
+                {
+                    const auto lookups = cache.hits + cache.misses;
+                    const auto hitRate = lookups > 0 ? 100.0 * cache.hits / lookups : 0.0;
+                    ImGui::Text("%s: %llu entries, %.1f%% hit (%llu/%llu), %llu evicted, %.2f ms",
+                                cache.name.c_str(),
+                                static_cast<unsigned long long>(cache.entries),
+                                hitRate,
+                                static_cast<unsigned long long>(cache.hits),
+                                static_cast<unsigned long long>(lookups),
+                                static_cast<unsigned long long>(cache.evictions),
+                                cache.creationTime);
+                }
+                if (ImGui::Button("Reset Cache Statistics"))
+                    m_device->resetStatistics();
+            }
+            ImGui::Separator();
+
             ImGui::Text("GPU Profiling");
             ImGui::Separator();
             drawPolyline("Fragment Usage", m_profiling[hpc::Counter::FragmentUtilization], "%");
@@ -0,0 +1,434 @@
+#include "texture_streamer.h"
+
+#include "file.h"
+#include "image.h"
+#include "khronos_texture.h"
+
+#include <jipu/command_encoder.h>
+#include <jipu/upload_manager.h>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace jipu
+{
+
+namespace
+{
+
+uint32_t getTargetMipLevel(uint32_t width, uint32_t height, uint32_t mipLevels, float screenSize)
+{
+    const float size = static_cast<float>(std::max(width, height));
+    if (screenSize >= size)
+        return 0;
+
+    const uint32_t mipLevel = static_cast<uint32_t>(std::floor(std::log2(size / std::max(screenSize, 1.0f))));
+    return std::min(mipLevel, mipLevels - 1);
+}
+
+// 2x2 box filter of RGBA8. sRGB texels are averaged without linearization.
+std::vector<uint8_t> downsample(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height)
+{
+    const uint32_t mipWidth = std::max(width / 2, 1u);
+    const uint32_t mipHeight = std::max(height / 2, 1u);
+
+    std::vector<uint8_t> mipPixels(static_cast<size_t>(mipWidth) * mipHeight * 4);
+    for (uint32_t y = 0; y < mipHeight; ++y)
+    {
+        const uint32_t y0 = std::min(y * 2, height - 1);
+        const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+        for (uint32_t x = 0; x < mipWidth; ++x)
+        {
+            const uint32_t x0 = std::min(x * 2, width - 1);
+            const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                const uint32_t sum = pixels[(static_cast<size_t>(y0) * width + x0) * 4 + c] +
+                                     pixels[(static_cast<size_t>(y0) * width + x1) * 4 + c] +
+                                     pixels[(static_cast<size_t>(y1) * width + x0) * 4 + c] +
+                                     pixels[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+                mipPixels[(static_cast<size_t>(y) * mipWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+
+    return mipPixels;
+}
+
+// how much finer the screen is than the uploaded mip. textures which have nothing uploaded are the first.
+float getPriority(uint32_t width, uint32_t height, uint32_t uploadedMipLevel, float screenSize)
+{
+    if (uploadedMipLevel == UINT32_MAX)
+        return std::numeric_limits<float>::infinity();
+
+    const uint32_t size = std::max(std::max(width, height) >> uploadedMipLevel, 1u);
+    return screenSize / static_cast<float>(size);
+}
+
+} // namespace
+
+StreamingTexture::StreamingTexture(const StreamingTextureDescriptor& descriptor)
+    : m_descriptor(descriptor)
+    , m_screenSize(std::numeric_limits<float>::max())
+{
+}
+
+void StreamingTexture::setScreenSize(float pixels)
+{
+    m_screenSize.store(pixels);
+}
+
+float StreamingTexture::getScreenSize() const
+{
+    return m_screenSize.load();
+}
+
+Texture* StreamingTexture::getTexture() const
+{
+    return m_texture.get();
+}
+
+TextureView* StreamingTexture::getTextureView() const
+{
+    return m_textureView.get();
+}
+
+uint64_t StreamingTexture::getVersion() const
+{
+    return m_version;
+}
+
+uint32_t StreamingTexture::getResidentMipLevel() const
+{
+    return m_residentMipLevel;
+}
+
+TextureStreamer::TextureStreamer(Device& device, const TextureStreamerDescriptor& descriptor)
+    : m_device(device)
+    , m_descriptor(descriptor)
+{
+    const uint32_t workerCount = std::max(m_descriptor.workerCount, 1u);
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        m_workers.emplace_back(&TextureStreamer::work, this);
+    }
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    // textures must be alive until their uploads are completed.
+    if (m_uploadSerial != 0)
+        m_device.getUploadManager().wait(m_uploadSerial);
+}
+
+StreamingTexture& TextureStreamer::load(const StreamingTextureDescriptor& descriptor)
+{
+    auto texture = std::make_unique<StreamingTexture>(descriptor);
+    auto& ref = *texture;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_textures.push_back(std::move(texture));
+    }
+    m_condition.notify_one();
+
+    return ref;
+}
+
+void TextureStreamer::update()
+{
+    std::vector<Upload> uploads{};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (auto& texture : m_textures)
+        {
+            if (texture->m_texture == nullptr && texture->m_mipLevels != 0)
+                createTexture(*texture);
+
+            if (texture->m_texture == nullptr)
+                continue;
+
+            updateResidency(*texture);
+            requestMips(*texture);
+        }
+
+        uploads = takeMips();
+    }
+
+    uploadMips(uploads);
+}
+
+uint64_t TextureStreamer::getDecodedBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_decodedBytes;
+}
+
+void TextureStreamer::work()
+{
+    while (true)
+    {
+        StreamingTexture* texture = nullptr;
+        uint32_t decodedMipLevel = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            // the queued texture which is the largest on the screen.
+            auto findQueued = [&]() {
+                texture = nullptr;
+                for (auto& queued : m_textures)
+                {
+                    if (queued->m_state != StreamingTexture::State::kQueued)
+                        continue;
+
+                    if (texture == nullptr || queued->getScreenSize() > texture->getScreenSize())
+                        texture = queued.get();
+                }
+                return texture != nullptr;
+            };
+
+            m_condition.wait(lock, [&]() {
+                return m_stop || (m_decodedBytes < m_descriptor.memoryBudget && findQueued());
+            });
+
+            if (m_stop)
+                return;
+
+            texture->m_state = StreamingTexture::State::kDecoding;
+            decodedMipLevel = texture->m_decodedMipLevel;
+        }
+
+        Decoded decoded{};
+        try
+        {
+            decoded = decode(*texture, decodedMipLevel);
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::error("Failed to stream {}: {}", texture->m_descriptor.path.generic_string(), e.what());
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            texture->m_state = StreamingTexture::State::kFailed;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        texture->m_format = decoded.format;
+        texture->m_width = decoded.width;
+        texture->m_height = decoded.height;
+        texture->m_mipLevels = decoded.mipLevels;
+        for (auto& mip : decoded.mips)
+        {
+            m_decodedBytes += mip.data.size();
+            texture->m_decodedMipLevel = std::min(texture->m_decodedMipLevel, mip.level);
+            texture->m_mips.push_back(std::move(mip));
+        }
+        texture->m_state = StreamingTexture::State::kIdle;
+    }
+}
+
+TextureStreamer::Decoded TextureStreamer::decode(const StreamingTexture& texture, uint32_t decodedMipLevel) const
+{
+    const auto& path = texture.m_descriptor.path;
+    std::vector<char> buffer = utils::readFile(path, m_descriptor.platformContext);
+
+    Decoded decoded{};
+    if (path.extension() == ".ktx" || path.extension() == ".ktx2")
+    {
+        KTX ktx{ buffer.data(), buffer.size() };
+
+        decoded.format = ktx.getFormat();
+        decoded.width = ktx.getWidth();
+        decoded.height = ktx.getHeight();
+        decoded.mipLevels = ktx.getMipLevels();
+
+        const uint32_t targetMipLevel = getTargetMipLevel(decoded.width, decoded.height, decoded.mipLevels, texture.getScreenSize());
+        for (uint32_t level = std::min(decodedMipLevel, decoded.mipLevels); level > targetMipLevel; --level)
+        {
+            const uint32_t mipLevel = level - 1;
+            const uint8_t* pixels = static_cast<const uint8_t*>(ktx.getPixels(mipLevel));
+
+            StreamingTexture::Mip mip{ .level = mipLevel,
+                                       .width = std::max(decoded.width >> mipLevel, 1u),
+                                       .height = std::max(decoded.height >> mipLevel, 1u),
+                                       .data = std::vector<uint8_t>(pixels, pixels + ktx.getSize(mipLevel)) };
+            decoded.mips.push_back(std::move(mip));
+        }
+
+        return decoded;
+    }
+
+    // images are decoded and downsampled as RGBA8.
+    const TextureFormat format = texture.m_descriptor.format;
+    if (format != TextureFormat::kRGBA_8888_UInt_Norm && format != TextureFormat::kRGBA_8888_UInt_Norm_SRGB)
+        throw std::runtime_error(fmt::format("{} format is not supported for images which are not KTX.", static_cast<uint32_t>(format)));
+
+    Image image{ buffer.data(), buffer.size() };
+    buffer.clear();
+
+    decoded.format = format;
+    decoded.width = image.getWidth();
+    decoded.height = image.getHeight();
+    decoded.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(decoded.width, decoded.height)))) + 1;
+
+    const uint32_t targetMipLevel = getTargetMipLevel(decoded.width, decoded.height, decoded.mipLevels, texture.getScreenSize());
+    const uint32_t endMipLevel = std::min(decodedMipLevel, decoded.mipLevels);
+
+    // finer mips are generated to downsample coarser ones, but only required ones are kept.
+    const uint8_t* pixels = static_cast<const uint8_t*>(image.getPixels());
+    std::vector<uint8_t> mipPixels(pixels, pixels + static_cast<size_t>(decoded.width) * decoded.height * image.getChannel());
+    uint32_t width = decoded.width;
+    uint32_t height = decoded.height;
+    for (uint32_t level = 0; level < endMipLevel; ++level)
+    {
+        std::vector<uint8_t> nextMipPixels{};
+        if (level + 1 < endMipLevel)
+            nextMipPixels = downsample(mipPixels, width, height);
+
+        if (level >= targetMipLevel)
+            decoded.mips.push_back({ .level = level, .width = width, .height = height, .data = std::move(mipPixels) });
+
+        mipPixels = std::move(nextMipPixels);
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+    std::reverse(decoded.mips.begin(), decoded.mips.end());
+
+    return decoded;
+}
+
+void TextureStreamer::createTexture(StreamingTexture& texture)
+{
+    TextureDescriptor descriptor{ .type = TextureType::k2D,
+                                  .format = texture.m_format,
+                                  .usage = TextureUsageFlagBits::kCopyDst |
+                                           TextureUsageFlagBits::kTextureBinding,
+                                  .width = texture.m_width,
+                                  .height = texture.m_height,
+                                  .depth = 1,
+                                  .mipLevels = texture.m_mipLevels,
+                                  .sampleCount = 1 };
+    texture.m_texture = m_device.createTexture(descriptor);
+}
+
+std::vector<TextureStreamer::Upload> TextureStreamer::takeMips()
+{
+    // priorities are evaluated when textures are pushed, because screen sizes may be changed by other threads.
+    auto push = [](auto& queue, StreamingTexture* texture) {
+        queue.push({ getPriority(texture->m_width, texture->m_height, texture->m_uploadedMipLevel, texture->getScreenSize()), texture });
+    };
+    auto compare = [](const std::pair<float, StreamingTexture*>& lhs, const std::pair<float, StreamingTexture*>& rhs) {
+        return lhs.first < rhs.first;
+    };
+    std::priority_queue<std::pair<float, StreamingTexture*>, std::vector<std::pair<float, StreamingTexture*>>, decltype(compare)> queue(compare);
+
+    for (auto& texture : m_textures)
+    {
+        if (texture->m_texture != nullptr && !texture->m_mips.empty())
+            push(queue, texture.get());
+    }
+
+    std::vector<Upload> uploads{};
+    uint64_t uploadBytes = 0;
+    while (!queue.empty() && uploadBytes < m_descriptor.uploadBudget)
+    {
+        StreamingTexture* texture = queue.top().second;
+        queue.pop();
+
+        auto& mip = texture->m_mips.front();
+        texture->m_uploadedMipLevel = mip.level;
+
+        uploadBytes += mip.data.size();
+        m_decodedBytes -= mip.data.size();
+        uploads.push_back({ .texture = texture, .mip = std::move(mip) });
+        texture->m_mips.pop_front();
+
+        if (!texture->m_mips.empty())
+            push(queue, texture);
+    }
+
+    return uploads;
+}
+
+void TextureStreamer::uploadMips(std::vector<Upload>& uploads)
+{
+    if (uploads.empty())
+        return;
+
+    auto& uploadManager = m_device.getUploadManager();
+    for (auto& upload : uploads)
+    {
+        auto& mip = upload.mip;
+
+        BlitTexture blitTexture{ .texture = *upload.texture->m_texture, .aspect = TextureAspectFlagBits::kColor, .mipLevel = mip.level };
+        TextureDataLayout dataLayout{ .offset = 0, .bytesPerRow = 0, .rowsPerTexture = 0 };
+        Extent3D extent{};
+        extent.width = mip.width;
+        extent.height = mip.height;
+        extent.depth = 1;
+        uint64_t serial = uploadManager.uploadTexture(blitTexture, mip.data.data(), mip.data.size(), dataLayout, extent);
+
+        upload.texture->m_uploads.push_back({ mip.level, serial });
+        m_uploadSerial = std::max(m_uploadSerial, serial);
+    }
+
+    // workers may wait for the memory budget.
+    m_condition.notify_all();
+}
+
+void TextureStreamer::updateResidency(StreamingTexture& texture)
+{
+    auto& uploadManager = m_device.getUploadManager();
+
+    uint32_t residentMipLevel = texture.m_residentMipLevel;
+    while (!texture.m_uploads.empty() && uploadManager.isCompleted(texture.m_uploads.front().second))
+    {
+        residentMipLevel = texture.m_uploads.front().first;
+        texture.m_uploads.pop_front();
+    }
+
+    if (residentMipLevel == texture.m_residentMipLevel)
+        return;
+
+    TextureViewDescriptor descriptor{};
+    descriptor.type = TextureViewType::k2D;
+    descriptor.aspect = TextureAspectFlagBits::kColor;
+    descriptor.baseMipLevel = residentMipLevel;
+
+    texture.m_textureView = texture.m_texture->createTextureView(descriptor);
+    texture.m_residentMipLevel = residentMipLevel;
+    ++texture.m_version;
+}
+
+void TextureStreamer::requestMips(StreamingTexture& texture)
+{
+    if (texture.m_state != StreamingTexture::State::kIdle || !texture.m_mips.empty())
+        return;
+
+    // decode again if the texture became larger on the screen than decoded mips.
+    const uint32_t targetMipLevel = getTargetMipLevel(texture.m_width, texture.m_height, texture.m_mipLevels, texture.getScreenSize());
+    if (targetMipLevel >= texture.m_decodedMipLevel)
+        return;
+
+    texture.m_state = StreamingTexture::State::kQueued;
+    m_condition.notify_one();
+}
+
+} // namespace jipu
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <jipu/device.h>
+#include <jipu/texture.h>
+#include <jipu/texture_view.h>
+
+namespace jipu
+{
+
+struct TextureStreamerDescriptor
+{
+    /// @brief threads which read and decode files.
+    uint32_t workerCount = 2;
+    /// @brief bytes of decoded mips which wait for upload. workers don't start decoding while it is exceeded.
+    uint64_t memoryBudget = 256 * 1024 * 1024;
+    /// @brief bytes of mips uploaded in a frame. a mip is uploaded at least.
+    uint64_t uploadBudget = 4 * 1024 * 1024;
+    void* platformContext = nullptr;
+};
+
+struct StreamingTextureDescriptor
+{
+    /// @brief ktx files are loaded with their mips. mips of other images are generated.
+    std::filesystem::path path;
+    /// @brief format of images which are not ktx. it must be RGBA8. ktx files are loaded with their own formats.
+    TextureFormat format = TextureFormat::kRGBA_8888_UInt_Norm_SRGB;
+};
+
+class TextureStreamer;
+class StreamingTexture final
+{
+public:
+    StreamingTexture() = delete;
+    StreamingTexture(const StreamingTextureDescriptor& descriptor);
+    ~StreamingTexture() = default;
+
+    StreamingTexture(const StreamingTexture&) = delete;
+    StreamingTexture& operator=(const StreamingTexture&) = delete;
+
+public:
+    /// @brief size in pixels on the screen. finer mips than it are not streamed, and larger ones are streamed first.
+    /// all mips are streamed until it is set.
+    void setScreenSize(float pixels);
+    float getScreenSize() const;
+
+    /// @brief it is nullptr until the file is decoded.
+    Texture* getTexture() const;
+    /// @brief view of resident mips. it is nullptr until the coarsest mip is resident, and recreated when finer mips are.
+    TextureView* getTextureView() const;
+    /// @brief incremented when the texture view is recreated. binding groups of the view must be recreated.
+    uint64_t getVersion() const;
+    uint32_t getResidentMipLevel() const;
+
+private:
+    friend class TextureStreamer;
+
+    enum class State
+    {
+        kQueued,
+        kDecoding,
+        kIdle,
+        kFailed,
+    };
+
+    struct Mip
+    {
+        uint32_t level = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> data{};
+    };
+
+    const StreamingTextureDescriptor m_descriptor{};
+    std::atomic<float> m_screenSize;
+
+    // guarded by the mutex of the streamer.
+    State m_state = State::kQueued;
+    TextureFormat m_format = TextureFormat::kUndefined;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_mipLevels = 0;
+    // decoded mips which wait for upload. the coarsest one is the first.
+    std::deque<Mip> m_mips{};
+    // the finest mip which is decoded. mips finer than it are decoded when they are required.
+    uint32_t m_decodedMipLevel = UINT32_MAX;
+
+    // used by the thread which updates the streamer.
+    std::unique_ptr<Texture> m_texture = nullptr;
+    std::unique_ptr<TextureView> m_textureView = nullptr;
+    uint64_t m_version = 0;
+    uint32_t m_uploadedMipLevel = UINT32_MAX;
+    uint32_t m_residentMipLevel = UINT32_MAX;
+    // mip levels and upload serials in upload order.
+    std::deque<std::pair<uint32_t, uint64_t>> m_uploads{};
+};
+
+/// @brief load textures on worker threads, and upload their mips from the coarsest one over frames.
+class TextureStreamer final
+{
+public:
+    TextureStreamer() = delete;
+    TextureStreamer(Device& device, const TextureStreamerDescriptor& descriptor);
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+public:
+    /// @brief the texture is owned by the streamer.
+    StreamingTexture& load(const StreamingTextureDescriptor& descriptor);
+
+    /// @brief create decoded textures, upload mips in priority order within the upload budget, and recreate views of
+    /// completed mips. call it once a frame before recording commands which use the textures.
+    void update();
+
+    uint64_t getDecodedBytes() const;
+
+private:
+    struct Decoded
+    {
+        TextureFormat format = TextureFormat::kUndefined;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipLevels = 0;
+        // the coarsest one is the first.
+        std::vector<StreamingTexture::Mip> mips{};
+    };
+
+    void work();
+    /// @brief decode mips from the one for the screen size to the one coarser than the decoded mip.
+    Decoded decode(const StreamingTexture& texture, uint32_t decodedMipLevel) const;
+
+    struct Upload
+    {
+        StreamingTexture* texture = nullptr;
+        StreamingTexture::Mip mip{};
+    };
+
+    void createTexture(StreamingTexture& texture);
+    /// @brief take decoded mips in priority order within the upload budget. it is called with the mutex locked.
+    std::vector<Upload> takeMips();
+    /// @brief it is called without the mutex, so workers are not blocked by copies to staging memory.
+    void uploadMips(std::vector<Upload>& uploads);
+    void updateResidency(StreamingTexture& texture);
+    void requestMips(StreamingTexture& texture);
+
+private:
+    Device& m_device;
+    const TextureStreamerDescriptor m_descriptor{};
+
+    std::vector<std::unique_ptr<StreamingTexture>> m_textures{};
+    uint64_t m_decodedBytes = 0;
+    uint64_t m_uploadSerial = 0;
+
+    mutable std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    bool m_stop = false;
+    std::vector<std::thread> m_workers{};
+};
+
+} // namespace jipu
@@ -53,6 +53,11 @@ TEST_F(BufferTest, test_createbuffer_usage)
         buffer = m_device->createBuffer(bufferDescriptor);
         ASSERT_NE(buffer, nullptr);
     }
+    {
+        bufferDescriptor.usage = BufferUsageFlagBits::kIndirect;
+        buffer = m_device->createBuffer(bufferDescriptor);
+        ASSERT_NE(buffer, nullptr);
+    }
 }
 
 TEST_F(BufferTest, test_createbuffer_with_size)
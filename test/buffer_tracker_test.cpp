@@ -0,0 +1,413 @@
+#include "buffer_tracker_test.h"
+
+#include "jipu/command_buffer.h"
+#include "jipu/command_encoder.h"
+#include "jipu/texture.h"
+
+#include <cstring>
+
+using namespace jipu;
+
+namespace
+{
+
+/*
+    #version 450
+    layout(local_size_x = 1) in;
+    layout(set = 0, binding = 0) buffer Data { uint values[]; } data;
+    void main() { data.values[gl_GlobalInvocationID.x] = gl_GlobalInvocationID.x + 1; }
+*/
+const std::vector<uint32_t> fillShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x00000015, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000005, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00060010, 0x00000001, 0x00000011, 0x00000001, 0x00000001, 0x00000001, 0x00040047, 0x00000002, 0x0000000b, 0x0000001c, 0x00040047, 0x00000003, 0x00000006, 0x00000004, 0x00050048, 0x00000004, 0x00000000, 0x00000023, 0x00000000, 0x00030047, 0x00000004, 0x00000003, 0x00040047, 0x00000005, 0x00000022, 0x00000000, 0x00040047, 0x00000005, 0x00000021, 0x00000000, 0x00020013, 0x00000006, 0x00030021, 0x00000007, 0x00000006, 0x00040015, 0x00000008, 0x00000020, 0x00000000, 0x00040017, 0x00000009, 0x00000008, 0x00000003, 0x00040020, 0x0000000a, 0x00000001, 0x00000009, 0x0004003b, 0x0000000a, 0x00000002, 0x00000001, 0x0003001d, 0x00000003, 0x00000008, 0x0003001e, 0x00000004, 0x00000003, 0x00040020, 0x0000000b, 0x00000002, 0x00000004, 0x0004003b, 0x0000000b, 0x00000005, 0x00000002, 0x00040020, 0x0000000c, 0x00000002, 0x00000008, 0x00040015, 0x0000000d, 0x00000020, 0x00000001, 0x0004002b, 0x0000000d, 0x0000000e, 0x00000000, 0x0004002b, 0x00000008, 0x0000000f, 0x00000001, 0x00050036, 0x00000006, 0x00000001, 0x00000000, 0x00000007, 0x000200f8, 0x00000010, 0x0004003d, 0x00000009, 0x00000011, 0x00000002, 0x00050051, 0x00000008, 0x00000012, 0x00000011, 0x00000000, 0x00050080, 0x00000008, 0x00000013, 0x00000012, 0x0000000f, 0x00060041, 0x0000000c, 0x00000014, 0x00000005, 0x0000000e, 0x00000012, 0x0003003e, 0x00000014, 0x00000013, 0x000100fd, 0x00010038 };
+
+} // namespace
+
+void BufferTrackerTest::SetUp()
+{
+    Test::SetUp();
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kGraphics;
+
+    m_queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, m_queue);
+}
+
+void BufferTrackerTest::TearDown()
+{
+    m_queue.reset();
+
+    Test::TearDown();
+}
+
+std::unique_ptr<Buffer> BufferTrackerTest::createBuffer(uint32_t count, BufferUsageFlags usage)
+{
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = count * sizeof(uint32_t);
+    bufferDescriptor.usage = usage;
+
+    auto buffer = m_device->createBuffer(bufferDescriptor);
+    EXPECT_NE(nullptr, buffer);
+
+    void* pointer = buffer->map();
+    EXPECT_NE(nullptr, pointer);
+    memset(pointer, 0, bufferDescriptor.size);
+    buffer->unmap();
+
+    return buffer;
+}
+
+std::vector<uint32_t> BufferTrackerTest::read(Buffer& buffer, uint32_t count)
+{
+    std::vector<uint32_t> values(count);
+
+    void* pointer = buffer.map();
+    EXPECT_NE(nullptr, pointer);
+    memcpy(values.data(), pointer, count * sizeof(uint32_t));
+    buffer.unmap();
+
+    return values;
+}
+
+TEST_F(BufferTrackerTest, test_ReadAfterRead)
+{
+    constexpr uint32_t count = 64;
+    constexpr uint64_t size = count * sizeof(uint32_t);
+
+    auto src = createBuffer(count, BufferUsageFlagBits::kCopySrc);
+    std::vector<std::unique_ptr<Buffer>> dsts{};
+    for (auto i = 0; i < 3; ++i)
+        dsts.push_back(createBuffer(count, BufferUsageFlagBits::kCopyDst));
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    for (auto& dst : dsts)
+        commandEncoder->copyBufferToBuffer({ .buffer = *src, .offset = 0 }, { .buffer = *dst, .offset = 0 }, size);
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    // the source is written by the host only, so no barrier is recorded.
+    auto statistics = commandBuffer->getStatistics();
+    EXPECT_EQ(statistics.bufferMemoryBarriers, 0);
+    EXPECT_EQ(statistics.bufferExecutionBarriers, 0);
+    EXPECT_EQ(statistics.barrierCommands, 0);
+}
+
+TEST_F(BufferTrackerTest, test_WriteAfterRead)
+{
+    constexpr uint32_t count = 64;
+    constexpr uint64_t size = count * sizeof(uint32_t);
+
+    auto first = createBuffer(count, BufferUsageFlagBits::kCopySrc | BufferUsageFlagBits::kCopyDst);
+    auto second = createBuffer(count, BufferUsageFlagBits::kCopyDst);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // the fill waits for the copy which reads the buffer, but nothing is made visible.
+    commandEncoder->copyBufferToBuffer({ .buffer = *first, .offset = 0 }, { .buffer = *second, .offset = 0 }, size);
+    commandEncoder->fillBuffer(*first, 0, size, 7);
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    auto statistics = commandBuffer->getStatistics();
+    EXPECT_EQ(statistics.bufferMemoryBarriers, 0);
+    EXPECT_EQ(statistics.bufferExecutionBarriers, 1);
+    EXPECT_EQ(statistics.barrierCommands, 1);
+
+    EXPECT_EQ(read(*second, count), std::vector<uint32_t>(count, 0));
+    EXPECT_EQ(read(*first, count), std::vector<uint32_t>(count, 7));
+}
+
+TEST_F(BufferTrackerTest, test_ReadAfterPartialWrite)
+{
+    constexpr uint32_t count = 128;
+
+    auto src = createBuffer(count, BufferUsageFlagBits::kCopySrc | BufferUsageFlagBits::kCopyDst);
+    auto dst = createBuffer(count, BufferUsageFlagBits::kCopyDst);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // the copy reads the second half of the filled range and the first half of the rest.
+    // only the filled part needs a barrier.
+    commandEncoder->fillBuffer(*src, 0, 256, 7);
+    commandEncoder->copyBufferToBuffer(*src, *dst, { { .srcOffset = 128, .dstOffset = 0, .size = 256 } });
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    auto statistics = commandBuffer->getStatistics();
+    EXPECT_EQ(statistics.bufferMemoryBarriers, 1);
+    EXPECT_EQ(statistics.bufferExecutionBarriers, 0);
+    EXPECT_EQ(statistics.barrierCommands, 1);
+
+    auto values = read(*dst, count);
+    for (auto i = 0; i < 32; ++i)
+        EXPECT_EQ(values[i], 7);
+    for (auto i = 32; i < 64; ++i)
+        EXPECT_EQ(values[i], 0);
+}
+
+TEST_F(BufferTrackerTest, test_ParticleComputeToVertex)
+{
+    constexpr uint32_t count = 4;
+
+    BufferBindingLayout bufferBindingLayout{};
+    bufferBindingLayout.index = 0;
+    bufferBindingLayout.stages = BindingStageFlagBits::kComputeStage;
+    bufferBindingLayout.type = BufferBindingType::kStorage;
+
+    BindingGroupLayoutDescriptor bindingGroupLayoutDescriptor{};
+    bindingGroupLayoutDescriptor.buffers = { bufferBindingLayout };
+
+    auto bindingGroupLayout = m_device->createBindingGroupLayout(bindingGroupLayoutDescriptor);
+    EXPECT_NE(nullptr, bindingGroupLayout);
+
+    PipelineLayoutDescriptor pipelineLayoutDescriptor{};
+    pipelineLayoutDescriptor.layouts = { *bindingGroupLayout };
+
+    auto pipelineLayout = m_device->createPipelineLayout(pipelineLayoutDescriptor);
+    EXPECT_NE(nullptr, pipelineLayout);
+
+    ShaderModuleDescriptor shaderModuleDescriptor{};
+    shaderModuleDescriptor.code = reinterpret_cast<const char*>(fillShaderSpv.data());
+    shaderModuleDescriptor.codeSize = static_cast<uint32_t>(fillShaderSpv.size() * sizeof(uint32_t));
+
+    auto shaderModule = m_device->createShaderModule(shaderModuleDescriptor);
+    EXPECT_NE(nullptr, shaderModule);
+
+    ComputePipelineDescriptor pipelineDescriptor{
+        { *pipelineLayout },
+        { { *shaderModule, "main" } },
+    };
+
+    auto pipeline = m_device->createComputePipeline(pipelineDescriptor);
+    EXPECT_NE(nullptr, pipeline);
+
+    // particles are written by compute and read as vertices.
+    auto particleBuffer = createBuffer(count, BufferUsageFlagBits::kStorage | BufferUsageFlagBits::kVertex);
+
+    BindingGroupDescriptor bindingGroupDescriptor{
+        .layout = *bindingGroupLayout,
+        .buffers = { { .index = 0, .offset = 0, .size = count * sizeof(uint32_t), .buffer = *particleBuffer } },
+    };
+
+    auto bindingGroup = m_device->createBindingGroup(bindingGroupDescriptor);
+    EXPECT_NE(nullptr, bindingGroup);
+
+    TextureDescriptor textureDescriptor{};
+    textureDescriptor.type = TextureType::k2D;
+    textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    textureDescriptor.usage = TextureUsageFlagBits::kColorAttachment;
+    textureDescriptor.width = 1;
+    textureDescriptor.height = 1;
+    textureDescriptor.depth = 1;
+    textureDescriptor.mipLevels = 1;
+    textureDescriptor.sampleCount = 1;
+
+    auto texture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, texture);
+
+    auto textureView = texture->createTextureView({ .type = TextureViewType::k2D, .aspect = TextureAspectFlagBits::kColor });
+    EXPECT_NE(nullptr, textureView);
+
+    ColorAttachment colorAttachment{
+        .renderView = *textureView,
+        .loadOp = LoadOp::kClear,
+        .storeOp = StoreOp::kStore,
+        .clearValue = { 0.0, 0.0, 0.0, 1.0 },
+    };
+
+    RenderPassEncoderDescriptor renderPassEncoderDescriptor{
+        .colorAttachments = { colorAttachment },
+        .sampleCount = 1,
+    };
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // two frames. the particles written by compute are made visible to vertex input when a render pass begins,
+    // and the next compute waits for vertex input before it writes them again.
+    for (auto frame = 0; frame < 2; ++frame)
+    {
+        ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+        auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+        computePassEncoder->setPipeline(*pipeline);
+        computePassEncoder->setBindingGroup(0, *bindingGroup);
+        computePassEncoder->dispatch(count);
+        computePassEncoder->end();
+
+        auto renderPassEncoder = commandEncoder->beginRenderPass(renderPassEncoderDescriptor);
+        renderPassEncoder->setVertexBuffer(0, *particleBuffer);
+        renderPassEncoder->end();
+    }
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    auto statistics = commandBuffer->getStatistics();
+    EXPECT_EQ(statistics.bufferMemoryBarriers, 3);
+    EXPECT_EQ(statistics.bufferExecutionBarriers, 0);
+
+    EXPECT_EQ(read(*particleBuffer, count), (std::vector<uint32_t>{ 1, 2, 3, 4 }));
+}
+
+TEST_F(BufferTrackerTest, test_ReadAfterSubmittedWrite)
+{
+    constexpr uint32_t count = 64;
+    constexpr uint64_t size = count * sizeof(uint32_t);
+
+    auto src = createBuffer(count, BufferUsageFlagBits::kCopySrc | BufferUsageFlagBits::kCopyDst);
+    auto dst = createBuffer(count, BufferUsageFlagBits::kCopyDst);
+    auto secondDst = createBuffer(count, BufferUsageFlagBits::kCopyDst);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+
+    auto fillCommandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    auto fillCommandEncoder = fillCommandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    fillCommandEncoder->fillBuffer(*src, 0, size, 7);
+
+    // the copy is recorded before the fill is submitted, so its barrier is resolved at submission.
+    auto copyCommandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    auto copyCommandEncoder = copyCommandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    copyCommandEncoder->copyBufferToBuffer({ .buffer = *src, .offset = 0 }, { .buffer = *dst, .offset = 0 }, size);
+    auto& copyCommandBufferRef = copyCommandEncoder->finish();
+
+    m_queue->submit({ fillCommandEncoder->finish() });
+    m_queue->submit({ copyCommandBufferRef });
+
+    auto statistics = copyCommandBuffer->getStatistics();
+    EXPECT_EQ(statistics.bufferMemoryBarriers, 1);
+    EXPECT_EQ(statistics.bufferExecutionBarriers, 0);
+    EXPECT_EQ(statistics.barrierCommands, 0);
+    EXPECT_EQ(read(*dst, count), std::vector<uint32_t>(count, 7));
+
+    // the fill is already visible to copies.
+    auto secondCommandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    auto secondCommandEncoder = secondCommandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    secondCommandEncoder->copyBufferToBuffer({ .buffer = *src, .offset = 0 }, { .buffer = *secondDst, .offset = 0 }, size);
+    m_queue->submit({ secondCommandEncoder->finish() });
+
+    statistics = secondCommandBuffer->getStatistics();
+    EXPECT_EQ(statistics.bufferMemoryBarriers, 0);
+    EXPECT_EQ(statistics.bufferExecutionBarriers, 0);
+    EXPECT_EQ(read(*secondDst, count), std::vector<uint32_t>(count, 7));
+}
+
+TEST_F(BufferTrackerTest, test_ReadOnlyStorage)
+{
+    constexpr uint32_t count = 4;
+
+    ShaderModuleDescriptor shaderModuleDescriptor{};
+    shaderModuleDescriptor.code = reinterpret_cast<const char*>(fillShaderSpv.data());
+    shaderModuleDescriptor.codeSize = static_cast<uint32_t>(fillShaderSpv.size() * sizeof(uint32_t));
+
+    auto shaderModule = m_device->createShaderModule(shaderModuleDescriptor);
+    EXPECT_NE(nullptr, shaderModule);
+
+    // two dispatches write their own buffers, and share a buffer which is bound as the type.
+    // the shader doesn't use the shared binding, but the tracker takes its access from the binding.
+    auto dispatch = [&](BufferBindingType type) {
+        BufferBindingLayout outBindingLayout{};
+        outBindingLayout.index = 0;
+        outBindingLayout.stages = BindingStageFlagBits::kComputeStage;
+        outBindingLayout.type = BufferBindingType::kStorage;
+
+        BufferBindingLayout sharedBindingLayout{};
+        sharedBindingLayout.index = 1;
+        sharedBindingLayout.stages = BindingStageFlagBits::kComputeStage;
+        sharedBindingLayout.type = type;
+
+        BindingGroupLayoutDescriptor bindingGroupLayoutDescriptor{};
+        bindingGroupLayoutDescriptor.buffers = { outBindingLayout, sharedBindingLayout };
+
+        auto bindingGroupLayout = m_device->createBindingGroupLayout(bindingGroupLayoutDescriptor);
+        EXPECT_NE(nullptr, bindingGroupLayout);
+
+        PipelineLayoutDescriptor pipelineLayoutDescriptor{};
+        pipelineLayoutDescriptor.layouts = { *bindingGroupLayout };
+
+        auto pipelineLayout = m_device->createPipelineLayout(pipelineLayoutDescriptor);
+        EXPECT_NE(nullptr, pipelineLayout);
+
+        ComputePipelineDescriptor pipelineDescriptor{
+            { *pipelineLayout },
+            { { *shaderModule, "main" } },
+        };
+
+        auto pipeline = m_device->createComputePipeline(pipelineDescriptor);
+        EXPECT_NE(nullptr, pipeline);
+
+        auto sharedBuffer = createBuffer(count, BufferUsageFlagBits::kStorage);
+        std::vector<std::unique_ptr<Buffer>> outBuffers{};
+        std::vector<std::unique_ptr<BindingGroup>> bindingGroups{};
+        for (auto i = 0; i < 2; ++i)
+        {
+            outBuffers.push_back(createBuffer(count, BufferUsageFlagBits::kStorage));
+
+            BindingGroupDescriptor bindingGroupDescriptor{
+                .layout = *bindingGroupLayout,
+                .buffers = { { .index = 0, .offset = 0, .size = count * sizeof(uint32_t), .buffer = *outBuffers[i] },
+                             { .index = 1, .offset = 0, .size = count * sizeof(uint32_t), .buffer = *sharedBuffer } },
+            };
+
+            bindingGroups.push_back(m_device->createBindingGroup(bindingGroupDescriptor));
+            EXPECT_NE(nullptr, bindingGroups[i]);
+        }
+
+        CommandBufferDescriptor commandBufferDescriptor{};
+        auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+        EXPECT_NE(nullptr, commandBuffer);
+
+        CommandEncoderDescriptor commandEncoderDescriptor{};
+        auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+        EXPECT_NE(nullptr, commandEncoder);
+
+        ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+        auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+        computePassEncoder->setPipeline(*pipeline);
+        for (auto& bindingGroup : bindingGroups)
+        {
+            computePassEncoder->setBindingGroup(0, *bindingGroup);
+            computePassEncoder->dispatch(count);
+        }
+        computePassEncoder->end();
+
+        m_queue->submit({ commandEncoder->finish() });
+
+        for (auto& outBuffer : outBuffers)
+            EXPECT_EQ(read(*outBuffer, count), (std::vector<uint32_t>{ 1, 2, 3, 4 }));
+
+        return commandBuffer->getStatistics();
+    };
+
+    // read after read needs no barrier.
+    auto statistics = dispatch(BufferBindingType::kReadOnlyStorage);
+    EXPECT_EQ(statistics.bufferMemoryBarriers, 0);
+    EXPECT_EQ(statistics.bufferExecutionBarriers, 0);
+
+    // a read-write binding is a write, so the second dispatch waits for the first one.
+    statistics = dispatch(BufferBindingType::kStorage);
+    EXPECT_EQ(statistics.bufferMemoryBarriers, 1);
+    EXPECT_EQ(statistics.bufferExecutionBarriers, 0);
+}
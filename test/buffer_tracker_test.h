@@ -0,0 +1,31 @@
+#pragma once
+#include "base/test.h"
+
+#include "jipu/binding_group.h"
+#include "jipu/binding_group_layout.h"
+#include "jipu/buffer.h"
+#include "jipu/pipeline.h"
+#include "jipu/pipeline_layout.h"
+#include "jipu/queue.h"
+#include "jipu/shader_module.h"
+
+namespace jipu
+{
+
+// barriers of buffer hazards are checked by statistics of command buffers which are recorded by encoders.
+class BufferTrackerTest : public Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+protected:
+    /// @brief buffer of zero filled uint values.
+    std::unique_ptr<Buffer> createBuffer(uint32_t count, BufferUsageFlags usage);
+    std::vector<uint32_t> read(Buffer& buffer, uint32_t count);
+
+protected:
+    std::unique_ptr<Queue> m_queue = nullptr;
+};
+
+} // namespace jipu
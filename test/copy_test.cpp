@@ -1,5 +1,7 @@
 #include "copy_test.h"
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 
 using namespace jipu;
@@ -133,6 +135,198 @@ void CopyTest::copyTextureToBuffer(Texture* srcTexture)
     EXPECT_EQ(firstData, m_value);
 }
 
+namespace
+{
+
+double toLinear(double value)
+{
+    return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+}
+
+double toSRGB(double value)
+{
+    return value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+}
+
+} // namespace
+
+CacheStatistics CopyTest::getMipmapStatistics()
+{
+    for (const auto& cache : m_device->getStatistics().caches)
+    {
+        if (cache.name == "Mipmap Pipeline")
+            return cache;
+    }
+
+    ADD_FAILURE() << "no cache statistics for Mipmap Pipeline";
+    return CacheStatistics{};
+}
+
+void CopyTest::generateMipmaps(TextureFormat format, TextureUsageFlags usage)
+{
+    const uint32_t width = 256;
+    const uint32_t height = 256;
+    const uint32_t channel = 4;
+    const uint32_t mipLevels = static_cast<uint32_t>(std::log2(width)) + 1;
+    const bool srgb = format == TextureFormat::kRGBA_8888_UInt_Norm_SRGB;
+
+    // gradient on red and green, 16x16 checker on blue.
+    std::vector<std::vector<uint8_t>> levels(mipLevels);
+    levels[0].resize(width * height * channel);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            uint8_t* texel = &levels[0][(y * width + x) * channel];
+            texel[0] = static_cast<uint8_t>(x);
+            texel[1] = static_cast<uint8_t>(y);
+            texel[2] = ((x / 16 + y / 16) % 2) ? 255 : 0;
+            texel[3] = 255;
+        }
+    }
+
+    // reference: 2x2 box filter of the previous level, averaged in linear space for srgb.
+    for (uint32_t level = 1; level < mipLevels; ++level)
+    {
+        const uint32_t srcWidth = width >> (level - 1);
+        const uint32_t dstWidth = width >> level;
+        const uint32_t dstHeight = height >> level;
+        const auto& src = levels[level - 1];
+        auto& dst = levels[level];
+        dst.resize(dstWidth * dstHeight * channel);
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+            for (uint32_t x = 0; x < dstWidth; ++x)
+            {
+                for (uint32_t c = 0; c < channel; ++c)
+                {
+                    const bool encoded = srgb && c < 3;
+                    double sum = 0.0;
+                    for (uint32_t i = 0; i < 4; ++i)
+                    {
+                        const uint32_t sx = x * 2 + (i % 2);
+                        const uint32_t sy = y * 2 + (i / 2);
+                        const double value = src[(sy * srcWidth + sx) * channel + c] / 255.0;
+                        sum += encoded ? toLinear(value) : value;
+                    }
+
+                    const double average = sum / 4.0;
+                    dst[(y * dstWidth + x) * channel + c] = static_cast<uint8_t>(std::lround((encoded ? toSRGB(average) : average) * 255.0));
+                }
+            }
+        }
+    }
+
+    BufferDescriptor srcBufferDescriptor{};
+    srcBufferDescriptor.size = levels[0].size();
+    srcBufferDescriptor.usage = BufferUsageFlagBits::kCopySrc;
+
+    auto srcBuffer = m_device->createBuffer(srcBufferDescriptor);
+    EXPECT_NE(nullptr, srcBuffer);
+    memcpy(srcBuffer->map(), levels[0].data(), levels[0].size());
+    srcBuffer->unmap();
+
+    TextureDescriptor textureDescriptor{};
+    textureDescriptor.type = TextureType::k2D;
+    textureDescriptor.format = format;
+    textureDescriptor.mipLevels = mipLevels;
+    textureDescriptor.sampleCount = 1;
+    textureDescriptor.width = width;
+    textureDescriptor.height = height;
+    textureDescriptor.depth = 1;
+    textureDescriptor.usage = TextureUsageFlagBits::kCopySrc | TextureUsageFlagBits::kCopyDst | usage;
+
+    auto texture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, texture);
+
+    // every level is copied to its own range of the buffer.
+    std::vector<uint32_t> offsets(mipLevels);
+    uint32_t size = 0;
+    for (uint32_t level = 0; level < mipLevels; ++level)
+    {
+        offsets[level] = size;
+        size += static_cast<uint32_t>(levels[level].size());
+    }
+
+    BufferDescriptor dstBufferDescriptor{};
+    dstBufferDescriptor.size = size;
+    dstBufferDescriptor.usage = BufferUsageFlagBits::kCopyDst;
+
+    auto dstBuffer = m_device->createBuffer(dstBufferDescriptor);
+    EXPECT_NE(nullptr, dstBuffer);
+
+    BlitTextureBuffer srcBlitBuffer{
+        .buffer = *srcBuffer,
+        .offset = 0,
+        .bytesPerRow = width * channel,
+        .rowsPerTexture = height,
+    };
+
+    Extent3D extent{};
+    extent.width = width;
+    extent.height = height;
+    extent.depth = 1;
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    commandEncoder->copyBufferToTexture(srcBlitBuffer, { .texture = *texture, .aspect = TextureAspectFlagBits::kColor }, extent);
+    commandEncoder->generateMipmaps(*texture);
+
+    for (uint32_t level = 0; level < mipLevels; ++level)
+    {
+        BlitTexture srcBlitTexture{
+            .texture = *texture,
+            .aspect = TextureAspectFlagBits::kColor,
+            .mipLevel = level,
+        };
+
+        BlitTextureBuffer dstBlitBuffer{
+            .buffer = *dstBuffer,
+            .offset = offsets[level],
+            .bytesPerRow = (width >> level) * channel,
+            .rowsPerTexture = height >> level,
+        };
+
+        Extent3D levelExtent{};
+        levelExtent.width = width >> level;
+        levelExtent.height = height >> level;
+        levelExtent.depth = 1;
+
+        commandEncoder->copyTextureToBuffer(srcBlitTexture, dstBlitBuffer, levelExtent);
+    }
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kGraphics | QueueFlagBits::kCompute | QueueFlagBits::kTransfer;
+
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+    queue->submit({ commandEncoder->finish() });
+
+    const uint8_t* data = static_cast<const uint8_t*>(dstBuffer->map());
+    EXPECT_NE(nullptr, data);
+
+    // the shader averages levels 1-6 without rounding in between, so allow small differences.
+    for (uint32_t level = 0; level < mipLevels; ++level)
+    {
+        const auto& reference = levels[level];
+        uint32_t mismatches = 0;
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            if (std::abs(static_cast<int>(data[offsets[level] + i]) - static_cast<int>(reference[i])) > 2)
+                ++mismatches;
+        }
+        EXPECT_EQ(0, mismatches) << "mip level " << level;
+    }
+
+    dstBuffer->unmap();
+}
+
 TEST_F(CopyTest, test_BufferToBuffer)
 {
     CommandBufferDescriptor commandBufferDescriptor{};
@@ -230,6 +424,97 @@ TEST_F(CopyTest, test_BufferToTexture)
     copyTextureToBuffer(texture.get()); // to check copied texture data.
 }
 
+TEST_F(CopyTest, test_DeferredBufferToBufferAndTexture)
+{
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = m_srcBuffer->getSize();
+    bufferDescriptor.usage = BufferUsageFlagBits::kCopyDst;
+
+    auto buffer = m_device->createBuffer(bufferDescriptor);
+    EXPECT_NE(nullptr, buffer);
+
+    TextureDescriptor textureDescriptor{};
+    textureDescriptor.type = TextureType::k2D;
+    textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    textureDescriptor.mipLevels = 1;
+    textureDescriptor.sampleCount = 1;
+    textureDescriptor.width = m_image.width;
+    textureDescriptor.height = m_image.height;
+    textureDescriptor.depth = 1;
+    textureDescriptor.usage = TextureUsageFlagBits::kCopySrc | // to check copied data by copying buffer.
+                              TextureUsageFlagBits::kCopyDst;
+
+    auto texture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, texture);
+
+    auto secondTexture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, secondTexture);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    commandEncoderDescriptor.deferred = true;
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // independent copies are recorded to the stream and translated at finish.
+    BlitBuffer srcBlitBuffer{
+        .buffer = *m_srcBuffer,
+        .offset = 0,
+    };
+    BlitBuffer dstBlitBuffer{
+        .buffer = *buffer,
+        .offset = 0,
+    };
+    commandEncoder->copyBufferToBuffer(srcBlitBuffer, dstBlitBuffer, m_srcBuffer->getSize());
+
+    BlitTextureBuffer blitTextureBuffer{
+        .buffer = *m_srcBuffer,
+        .offset = 0,
+        .bytesPerRow = static_cast<uint32_t>(m_image.width * m_image.channel * sizeof(char)),
+        .rowsPerTexture = static_cast<uint32_t>(m_image.height),
+    };
+    BlitTexture blitTexture{
+        .texture = *texture,
+        .aspect = TextureAspectFlagBits::kColor,
+    };
+    Extent3D extent{};
+    extent.width = m_image.width;
+    extent.height = m_image.height;
+    extent.depth = 1;
+    commandEncoder->copyBufferToTexture(blitTextureBuffer, blitTexture, extent);
+
+    BlitTexture secondBlitTexture{
+        .texture = *secondTexture,
+        .aspect = TextureAspectFlagBits::kColor,
+    };
+    commandEncoder->copyBufferToTexture(blitTextureBuffer, secondBlitTexture, extent);
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kTransfer;
+
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+    queue->submit({ commandEncoder->finish() });
+
+    // the layout transition of the second texture is moved before the copy to the first texture and merged into
+    // the transition of the first texture. the final layout transition stays.
+    auto statistics = commandBuffer->getStatistics();
+    EXPECT_EQ(statistics.mergedBarriers, 1);
+    EXPECT_EQ(statistics.elidedCommands, 0);
+    EXPECT_EQ(statistics.reorderedCommands, 2);
+
+    char* dataPointer = static_cast<char*>(buffer->map());
+    EXPECT_NE(nullptr, dataPointer);
+    EXPECT_EQ(dataPointer[0], m_value);
+    EXPECT_EQ(dataPointer[m_srcBuffer->getSize() - 1], m_value);
+
+    copyTextureToBuffer(texture.get()); // to check copied texture data.
+    copyTextureToBuffer(secondTexture.get());
+}
+
 TEST_F(CopyTest, test_TextureToBuffer)
 {
     copyTextureToBuffer(m_srcTexture.get());
@@ -284,4 +569,430 @@ TEST_F(CopyTest, test_TextureToTexture)
     queue->submit({ commandEncoder->finish() });
 
     copyTextureToBuffer(dstTexture.get()); // to check copied texture data.
-}
\ No newline at end of file
+}
+
+TEST_F(CopyTest, test_BufferToMipmappedTextureToBuffer)
+{
+    TextureDescriptor textureDescriptor{};
+    textureDescriptor.type = TextureType::k2D;
+    textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    textureDescriptor.mipLevels = 4;
+    textureDescriptor.sampleCount = 1;
+    textureDescriptor.width = m_image.width;
+    textureDescriptor.height = m_image.height;
+    textureDescriptor.depth = 1;
+    textureDescriptor.usage = TextureUsageFlagBits::kCopySrc |
+                              TextureUsageFlagBits::kCopyDst;
+
+    auto texture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, texture);
+
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = m_srcBuffer->getSize();
+    bufferDescriptor.usage = BufferUsageFlagBits::kCopyDst;
+
+    auto dstBuffer = m_device->createBuffer(bufferDescriptor);
+    EXPECT_NE(nullptr, dstBuffer);
+
+    BlitTextureBuffer srcBlitBuffer{
+        .buffer = *m_srcBuffer,
+        .offset = 0,
+        .bytesPerRow = static_cast<uint32_t>(m_image.width * m_image.channel * sizeof(char)),
+        .rowsPerTexture = static_cast<uint32_t>(m_image.height),
+    };
+
+    BlitTextureBuffer dstBlitBuffer{
+        .buffer = *dstBuffer,
+        .offset = 0,
+        .bytesPerRow = static_cast<uint32_t>(m_image.width * m_image.channel * sizeof(char)),
+        .rowsPerTexture = static_cast<uint32_t>(m_image.height),
+    };
+
+    BlitTexture blitTexture{
+        .texture = *texture,
+        .aspect = TextureAspectFlagBits::kColor,
+    };
+
+    Extent3D extent{};
+    extent.width = m_image.width;
+    extent.height = m_image.height;
+    extent.depth = 1;
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // the copy reads the uploaded mip level from its tracked layout in the same encoder.
+    commandEncoder->copyBufferToTexture(srcBlitBuffer, blitTexture, extent);
+    commandEncoder->copyTextureToBuffer(blitTexture, dstBlitBuffer, extent);
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kTransfer;
+
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+    queue->submit({ commandEncoder->finish() });
+
+    // one transition for each copy, and one for all levels to the final layout at finish.
+    // buffers written by previous submissions are resolved at submission, not in the command buffer.
+    EXPECT_EQ(commandBuffer->getStatistics().barrierCommands, 3);
+
+    char* dataPointer = static_cast<char*>(dstBuffer->map());
+    EXPECT_NE(nullptr, dataPointer);
+    EXPECT_EQ(dataPointer[0], m_value);
+    EXPECT_EQ(dataPointer[m_srcBuffer->getSize() - 1], m_value);
+
+    copyTextureToBuffer(texture.get()); // to check the texture is restored to its final layout with contents.
+}
+
+TEST_F(CopyTest, test_BufferToBufferRegions)
+{
+    BufferDescriptor srcBufferDescriptor{};
+    srcBufferDescriptor.size = 256;
+    srcBufferDescriptor.usage = BufferUsageFlagBits::kCopySrc;
+
+    auto srcBuffer = m_device->createBuffer(srcBufferDescriptor);
+    EXPECT_NE(nullptr, srcBuffer);
+
+    char* srcPointer = static_cast<char*>(srcBuffer->map());
+    EXPECT_NE(nullptr, srcPointer);
+    for (auto i = 0; i < srcBufferDescriptor.size; ++i)
+        srcPointer[i] = static_cast<char>(i);
+    srcBuffer->unmap();
+
+    BufferDescriptor dstBufferDescriptor{};
+    dstBufferDescriptor.size = 256;
+    dstBufferDescriptor.usage = BufferUsageFlagBits::kCopyDst;
+
+    auto dstBuffer = m_device->createBuffer(dstBufferDescriptor);
+    EXPECT_NE(nullptr, dstBuffer);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // offsets of single copy are honored.
+    commandEncoder->copyBufferToBuffer(BlitBuffer{ .buffer = *srcBuffer, .offset = 8 },
+                                       BlitBuffer{ .buffer = *dstBuffer, .offset = 128 },
+                                       16);
+    commandEncoder->copyBufferToBuffer(*srcBuffer,
+                                       *dstBuffer,
+                                       { { .srcOffset = 0, .dstOffset = 64, .size = 16 },
+                                         { .srcOffset = 32, .dstOffset = 0, .size = 16 } });
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kTransfer;
+
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+    queue->submit({ commandEncoder->finish() });
+
+    char* dataPointer = static_cast<char*>(dstBuffer->map());
+    EXPECT_NE(nullptr, dataPointer);
+    EXPECT_EQ(dataPointer[128], static_cast<char>(8));
+    EXPECT_EQ(dataPointer[143], static_cast<char>(23));
+    EXPECT_EQ(dataPointer[64], static_cast<char>(0));
+    EXPECT_EQ(dataPointer[79], static_cast<char>(15));
+    EXPECT_EQ(dataPointer[0], static_cast<char>(32));
+    EXPECT_EQ(dataPointer[15], static_cast<char>(47));
+}
+
+TEST_F(CopyTest, test_BufferToTextureArrayLayersAndMipLevel)
+{
+    const uint32_t layers = 3;
+    const uint32_t width = 32; // width and height of mip level 1.
+    const uint32_t bytesPerRow = 256;
+
+    TextureDescriptor textureDescriptor{};
+    textureDescriptor.type = TextureType::k2D;
+    textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    textureDescriptor.mipLevels = 2;
+    textureDescriptor.sampleCount = 1;
+    textureDescriptor.width = width * 2;
+    textureDescriptor.height = width * 2;
+    textureDescriptor.depth = layers;
+    textureDescriptor.usage = TextureUsageFlagBits::kCopySrc | TextureUsageFlagBits::kCopyDst;
+
+    auto texture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, texture);
+    EXPECT_EQ(layers, texture->getDepth());
+
+    // rows are padded to bytes per row, and each layer has its value.
+    BufferDescriptor srcBufferDescriptor{};
+    srcBufferDescriptor.size = bytesPerRow * width * layers;
+    srcBufferDescriptor.usage = BufferUsageFlagBits::kCopySrc;
+
+    auto srcBuffer = m_device->createBuffer(srcBufferDescriptor);
+    EXPECT_NE(nullptr, srcBuffer);
+
+    char* srcPointer = static_cast<char*>(srcBuffer->map());
+    EXPECT_NE(nullptr, srcPointer);
+    for (auto layer = 0; layer < layers; ++layer)
+        memset(srcPointer + bytesPerRow * width * layer, layer + 1, bytesPerRow * width);
+    srcBuffer->unmap();
+
+    BufferDescriptor dstBufferDescriptor{};
+    dstBufferDescriptor.size = width * width * 4;
+    dstBufferDescriptor.usage = BufferUsageFlagBits::kCopyDst;
+
+    auto dstBuffer = m_device->createBuffer(dstBufferDescriptor);
+    EXPECT_NE(nullptr, dstBuffer);
+
+    Extent3D extent{};
+    extent.width = width;
+    extent.height = width;
+    extent.depth = 1;
+
+    std::vector<BufferTextureCopyRegion> regions{};
+    for (auto layer = 0; layer < layers; ++layer)
+    {
+        regions.push_back({ .bufferOffset = static_cast<uint64_t>(bytesPerRow) * width * layer,
+                            .bytesPerRow = bytesPerRow,
+                            .rowsPerTexture = width,
+                            .mipLevel = 1,
+                            .origin = { .z = static_cast<uint32_t>(layer) },
+                            .extent = extent });
+    }
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    commandEncoder->copyBufferToTexture(*srcBuffer, *texture, TextureAspectFlagBits::kColor, regions);
+
+    BlitTexture srcBlitTexture{
+        .texture = *texture,
+        .aspect = TextureAspectFlagBits::kColor,
+        .mipLevel = 1,
+        .origin = { .z = layers - 1 },
+    };
+
+    BlitTextureBuffer dstBlitBuffer{
+        .buffer = *dstBuffer,
+        .offset = 0,
+        .bytesPerRow = width * 4,
+        .rowsPerTexture = width,
+    };
+
+    commandEncoder->copyTextureToBuffer(srcBlitTexture, dstBlitBuffer, extent);
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kTransfer;
+
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+    queue->submit({ commandEncoder->finish() });
+
+    char* dataPointer = static_cast<char*>(dstBuffer->map());
+    EXPECT_NE(nullptr, dataPointer);
+    EXPECT_EQ(dataPointer[0], static_cast<char>(layers));
+    EXPECT_EQ(dataPointer[dstBufferDescriptor.size - 1], static_cast<char>(layers));
+}
+
+TEST_F(CopyTest, test_GenerateMipmapsByBlit)
+{
+    m_device->resetStatistics();
+    generateMipmaps(TextureFormat::kRGBA_8888_UInt_Norm, TextureUsageFlagBits::kUndefined);
+
+    // without storage binding usage, the compute shader must not be used.
+    auto statistics = getMipmapStatistics();
+    EXPECT_EQ(0, statistics.hits + statistics.misses);
+}
+
+TEST_F(CopyTest, test_GenerateMipmapsByCompute)
+{
+    // storage binding usage selects the single dispatch downsampler if the device supports it.
+    m_device->resetStatistics();
+    generateMipmaps(TextureFormat::kRGBA_8888_UInt_Norm, TextureUsageFlagBits::kStorageBinding);
+
+    auto statistics = getMipmapStatistics();
+    if (statistics.hits + statistics.misses == 0)
+        GTEST_SKIP() << "mipmaps are generated by blit, the compute shader isn't supported.";
+    EXPECT_EQ(1, statistics.entries);
+}
+
+TEST_F(CopyTest, test_GenerateMipmapsByComputeSRGB)
+{
+    m_device->resetStatistics();
+    generateMipmaps(TextureFormat::kRGBA_8888_UInt_Norm_SRGB, TextureUsageFlagBits::kStorageBinding);
+
+    auto statistics = getMipmapStatistics();
+    if (statistics.hits + statistics.misses == 0)
+        GTEST_SKIP() << "mipmaps are generated by blit, the compute shader isn't supported for srgb.";
+    EXPECT_EQ(1, statistics.entries);
+}
+
+TEST_F(CopyTest, test_FillAndClearBuffer)
+{
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = 256;
+    bufferDescriptor.usage = BufferUsageFlagBits::kCopyDst;
+
+    auto buffer = m_device->createBuffer(bufferDescriptor);
+    EXPECT_NE(nullptr, buffer);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // offset and size must be multiples of 4, and in the buffer.
+    EXPECT_ANY_THROW(commandEncoder->fillBuffer(*buffer, 2, 4, 0));
+    EXPECT_ANY_THROW(commandEncoder->fillBuffer(*buffer, 0, 6, 0));
+    EXPECT_ANY_THROW(commandEncoder->clearBuffer(*buffer, 128, 256));
+
+    commandEncoder->fillBuffer(*buffer, 0, bufferDescriptor.size, 0x01020304);
+    commandEncoder->clearBuffer(*buffer, 128, 128);
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kTransfer;
+
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+    queue->submit({ commandEncoder->finish() });
+
+    uint32_t* dataPointer = static_cast<uint32_t*>(buffer->map());
+    EXPECT_NE(nullptr, dataPointer);
+    EXPECT_EQ(dataPointer[0], 0x01020304u);
+    EXPECT_EQ(dataPointer[31], 0x01020304u);
+    EXPECT_EQ(dataPointer[32], 0u);
+    EXPECT_EQ(dataPointer[63], 0u);
+}
+
+TEST_F(CopyTest, test_QueueWriteBufferAndTexture)
+{
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = 256;
+    bufferDescriptor.usage = BufferUsageFlagBits::kCopyDst;
+
+    auto buffer = m_device->createBuffer(bufferDescriptor);
+    EXPECT_NE(nullptr, buffer);
+
+    TextureDescriptor textureDescriptor{};
+    textureDescriptor.type = TextureType::k2D;
+    textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    textureDescriptor.mipLevels = 1;
+    textureDescriptor.sampleCount = 1;
+    textureDescriptor.width = m_image.width;
+    textureDescriptor.height = m_image.height;
+    textureDescriptor.depth = 1;
+    textureDescriptor.usage = TextureUsageFlagBits::kCopySrc | TextureUsageFlagBits::kCopyDst;
+
+    auto texture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, texture);
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kTransfer;
+
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+
+    Extent3D extent{};
+    extent.width = m_image.width;
+    extent.height = m_image.height;
+    extent.depth = 1;
+
+    // the data is copied at the call, so it can be released before submit.
+    {
+        std::vector<char> data(bufferDescriptor.size, m_value);
+        queue->writeBuffer(*buffer, 0, data.data(), data.size());
+    }
+    queue->writeTexture({ .texture = *texture, .aspect = TextureAspectFlagBits::kColor },
+                        m_image.data.data(),
+                        m_image.data.size(),
+                        {},
+                        extent);
+
+    EXPECT_ANY_THROW(queue->writeBuffer(*buffer, 128, m_image.data.data(), 256));
+    EXPECT_ANY_THROW(queue->writeTexture({ .texture = *texture, .aspect = TextureAspectFlagBits::kColor },
+                                         m_image.data.data(),
+                                         m_image.data.size() - 1,
+                                         {},
+                                         extent));
+
+    // writes are executed by the next submit.
+    queue->submit(std::vector<CommandBuffer::Ref>{});
+
+    char* dataPointer = static_cast<char*>(buffer->map());
+    EXPECT_NE(nullptr, dataPointer);
+    EXPECT_EQ(dataPointer[0], m_value);
+    EXPECT_EQ(dataPointer[bufferDescriptor.size - 1], m_value);
+
+    copyTextureToBuffer(texture.get()); // to check written texture data.
+}
+
+TEST_F(CopyTest, test_UploadManager)
+{
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = 256;
+    bufferDescriptor.usage = BufferUsageFlagBits::kCopyDst;
+
+    auto buffer = m_device->createBuffer(bufferDescriptor);
+    EXPECT_NE(nullptr, buffer);
+
+    TextureDescriptor textureDescriptor{};
+    textureDescriptor.type = TextureType::k2D;
+    textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    textureDescriptor.mipLevels = 1;
+    textureDescriptor.sampleCount = 1;
+    textureDescriptor.width = m_image.width;
+    textureDescriptor.height = m_image.height;
+    textureDescriptor.depth = 1;
+    textureDescriptor.usage = TextureUsageFlagBits::kCopySrc | TextureUsageFlagBits::kCopyDst;
+
+    auto texture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, texture);
+
+    Extent3D extent{};
+    extent.width = m_image.width;
+    extent.height = m_image.height;
+    extent.depth = 1;
+
+    auto& uploadManager = m_device->getUploadManager();
+
+    // overlapped uploads in a submission are applied in order. the data is copied at the call.
+    {
+        std::vector<char> data(bufferDescriptor.size, 0);
+        uploadManager.uploadBuffer(*buffer, 0, data.data(), data.size());
+        std::fill(data.begin(), data.end(), m_value);
+        uploadManager.uploadBuffer(*buffer, 0, data.data(), data.size());
+    }
+    uint64_t serial = uploadManager.uploadTexture({ .texture = *texture, .aspect = TextureAspectFlagBits::kColor },
+                                                  m_image.data.data(),
+                                                  m_image.data.size(),
+                                                  {},
+                                                  extent);
+
+    EXPECT_ANY_THROW(uploadManager.uploadBuffer(*buffer, 128, m_image.data.data(), 256));
+    EXPECT_ANY_THROW(uploadManager.uploadTexture({ .texture = *texture, .aspect = TextureAspectFlagBits::kColor },
+                                                 m_image.data.data(),
+                                                 m_image.data.size() - 1,
+                                                 {},
+                                                 extent));
+
+    uploadManager.wait(serial);
+    EXPECT_TRUE(uploadManager.isCompleted(serial));
+    EXPECT_GE(uploadManager.getCompletedSerial(), serial);
+
+    char* dataPointer = static_cast<char*>(buffer->map());
+    EXPECT_NE(nullptr, dataPointer);
+    EXPECT_EQ(dataPointer[0], m_value);
+    EXPECT_EQ(dataPointer[bufferDescriptor.size - 1], m_value);
+
+    copyTextureToBuffer(texture.get()); // to check uploaded texture data.
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "base/test.h"
 
+#include "jipu/device.h"
 #include "jipu/texture.h"
 
 namespace jipu
@@ -14,6 +15,9 @@ protected:
 
 protected:
     void copyTextureToBuffer(Texture* dstTexture);
+    /// @brief upload a gradient to the base level, generate mipmaps and check every level against a box filter.
+    void generateMipmaps(TextureFormat format, TextureUsageFlags usage);
+    CacheStatistics getMipmapStatistics();
 
 protected:
     std::unique_ptr<Buffer> m_srcBuffer = nullptr;
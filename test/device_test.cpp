@@ -1,5 +1,9 @@
 #include "device_test.h"
+
+#include "jipu/command_encoder.h"
+
 #include <limits>
+#include <stdexcept>
 
 using namespace jipu;
 
@@ -55,3 +59,60 @@ TEST_F(DeviceTest, createShaderModule)
     auto shaderModule = m_device->createShaderModule(shaderModuleDescriptor);
     ASSERT_NE(shaderModule, nullptr);
 }
+
+TEST_F(DeviceTest, bindlessTable)
+{
+    auto bindlessTable = m_device->getBindlessTable();
+    if (bindlessTable == nullptr)
+        GTEST_SKIP() << "descriptor indexing is not supported.";
+
+    SamplerDescriptor samplerDescriptor{};
+    auto sampler = m_device->createSampler(samplerDescriptor);
+
+    auto first = bindlessTable->addSampler(*sampler);
+    auto second = bindlessTable->addSampler(*sampler);
+    EXPECT_NE(first, second);
+
+    // removed index may be read by commands which are not submitted yet, so it is not reused until they are completed.
+    bindlessTable->removeSampler(first);
+    auto third = bindlessTable->addSampler(*sampler);
+    EXPECT_NE(third, first);
+    EXPECT_NE(third, second);
+
+    auto queue = m_device->createQueue({ .flags = QueueFlagBits::kGraphics });
+    auto commandBuffer = m_device->createCommandBuffer({});
+    auto commandEncoder = commandBuffer->createCommandEncoder({});
+    queue->submit({ commandEncoder->finish() });
+
+    // the removed index is reused after the submission is completed.
+    EXPECT_EQ(bindlessTable->addSampler(*sampler), first);
+
+    bindlessTable->removeSampler(first);
+    bindlessTable->removeSampler(second);
+    bindlessTable->removeSampler(third);
+}
+
+TEST_F(DeviceTest, bindlessTableDoubleRemove)
+{
+    auto bindlessTable = m_device->getBindlessTable();
+    if (bindlessTable == nullptr)
+        GTEST_SKIP() << "descriptor indexing is not supported.";
+
+    SamplerDescriptor samplerDescriptor{};
+    auto sampler = m_device->createSampler(samplerDescriptor);
+
+    auto index = bindlessTable->addSampler(*sampler);
+    bindlessTable->removeSampler(index);
+    EXPECT_THROW(bindlessTable->removeSampler(index), std::runtime_error);
+
+    // the index is free once, so two adds return different indexes.
+    auto first = bindlessTable->addSampler(*sampler);
+    auto second = bindlessTable->addSampler(*sampler);
+    EXPECT_NE(first, second);
+
+    // an index which is never added.
+    EXPECT_THROW(bindlessTable->removeSampler(second + 1), std::runtime_error);
+
+    bindlessTable->removeSampler(first);
+    bindlessTable->removeSampler(second);
+}
@@ -0,0 +1,1178 @@
+#include "pass_encoder_test.h"
+
+#include "jipu/command_buffer.h"
+#include "jipu/command_encoder.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+using namespace jipu;
+
+namespace
+{
+
+/*
+    #version 450
+    layout(local_size_x = 1) in;
+    layout(set = 0, binding = 0) buffer Data { uint values[]; } data;
+    void main() { data.values[gl_GlobalInvocationID.x] = gl_GlobalInvocationID.x + 1; }
+*/
+const std::vector<uint32_t> fillShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x00000015, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000005, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00060010, 0x00000001, 0x00000011, 0x00000001, 0x00000001, 0x00000001, 0x00040047, 0x00000002, 0x0000000b, 0x0000001c, 0x00040047, 0x00000003, 0x00000006, 0x00000004, 0x00050048, 0x00000004, 0x00000000, 0x00000023, 0x00000000, 0x00030047, 0x00000004, 0x00000003, 0x00040047, 0x00000005, 0x00000022, 0x00000000, 0x00040047, 0x00000005, 0x00000021, 0x00000000, 0x00020013, 0x00000006, 0x00030021, 0x00000007, 0x00000006, 0x00040015, 0x00000008, 0x00000020, 0x00000000, 0x00040017, 0x00000009, 0x00000008, 0x00000003, 0x00040020, 0x0000000a, 0x00000001, 0x00000009, 0x0004003b, 0x0000000a, 0x00000002, 0x00000001, 0x0003001d, 0x00000003, 0x00000008, 0x0003001e, 0x00000004, 0x00000003, 0x00040020, 0x0000000b, 0x00000002, 0x00000004, 0x0004003b, 0x0000000b, 0x00000005, 0x00000002, 0x00040020, 0x0000000c, 0x00000002, 0x00000008, 0x00040015, 0x0000000d, 0x00000020, 0x00000001, 0x0004002b, 0x0000000d, 0x0000000e, 0x00000000, 0x0004002b, 0x00000008, 0x0000000f, 0x00000001, 0x00050036, 0x00000006, 0x00000001, 0x00000000, 0x00000007, 0x000200f8, 0x00000010, 0x0004003d, 0x00000009, 0x00000011, 0x00000002, 0x00050051, 0x00000008, 0x00000012, 0x00000011, 0x00000000, 0x00050080, 0x00000008, 0x00000013, 0x00000012, 0x0000000f, 0x00060041, 0x0000000c, 0x00000014, 0x00000005, 0x0000000e, 0x00000012, 0x0003003e, 0x00000014, 0x00000013, 0x000100fd, 0x00010038 };
+
+/*
+    #version 450
+    layout(local_size_x = 1) in;
+    layout(set = 0, binding = 0) buffer Data { uint values[]; } data;
+    layout(push_constant) uniform PushConstants { uint value; } pc;
+    void main() { data.values[gl_GlobalInvocationID.x] = pc.value + gl_GlobalInvocationID.x; }
+*/
+const std::vector<uint32_t> pushConstantShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x0000001b, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000005, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00060010, 0x00000001, 0x00000011, 0x00000001, 0x00000001, 0x00000001, 0x00040047, 0x00000002, 0x0000000b, 0x0000001c, 0x00040047, 0x00000003, 0x00000006, 0x00000004, 0x00050048, 0x00000004, 0x00000000, 0x00000023, 0x00000000, 0x00030047, 0x00000004, 0x00000003, 0x00040047, 0x00000005, 0x00000022, 0x00000000, 0x00040047, 0x00000005, 0x00000021, 0x00000000, 0x00050048, 0x00000006, 0x00000000, 0x00000023, 0x00000000, 0x00030047, 0x00000006, 0x00000002, 0x00020013, 0x00000007, 0x00030021, 0x00000008, 0x00000007, 0x00040015, 0x00000009, 0x00000020, 0x00000000, 0x00040017, 0x0000000a, 0x00000009, 0x00000003, 0x00040020, 0x0000000b, 0x00000001, 0x0000000a, 0x0004003b, 0x0000000b, 0x00000002, 0x00000001, 0x0003001d, 0x00000003, 0x00000009, 0x0003001e, 0x00000004, 0x00000003, 0x00040020, 0x0000000c, 0x00000002, 0x00000004, 0x0004003b, 0x0000000c, 0x00000005, 0x00000002, 0x00040020, 0x0000000d, 0x00000002, 0x00000009, 0x00040015, 0x0000000e, 0x00000020, 0x00000001, 0x0004002b, 0x0000000e, 0x0000000f, 0x00000000, 0x0004002b, 0x00000009, 0x00000010, 0x00000001, 0x0003001e, 0x00000006, 0x00000009, 0x00040020, 0x00000011, 0x00000009, 0x00000006, 0x0004003b, 0x00000011, 0x00000012, 0x00000009, 0x00040020, 0x00000013, 0x00000009, 0x00000009, 0x00050036, 0x00000007, 0x00000001, 0x00000000, 0x00000008, 0x000200f8, 0x00000014, 0x0004003d, 0x0000000a, 0x00000015, 0x00000002, 0x00050051, 0x00000009, 0x00000016, 0x00000015, 0x00000000, 0x00050041, 0x00000013, 0x00000017, 0x00000012, 0x0000000f, 0x0004003d, 0x00000009, 0x00000018, 0x00000017, 0x00050080, 0x00000009, 0x00000019, 0x00000018, 0x00000016, 0x00060041, 0x0000000d, 0x0000001a, 0x00000005, 0x0000000f, 0x00000016, 0x0003003e, 0x0000001a, 0x00000019, 0x000100fd, 0x00010038 };
+
+/*
+    #version 450
+    layout(local_size_x = 1) in;
+    layout(set = 0, binding = 0) buffer Data0 { uint values[]; } data0;
+    layout(set = 1, binding = 0) buffer Data1 { uint values[]; } data1;
+    void main()
+    {
+        data0.values[gl_GlobalInvocationID.x] = gl_GlobalInvocationID.x + 1;
+        data1.values[gl_GlobalInvocationID.x] = gl_GlobalInvocationID.x + 1;
+    }
+*/
+const std::vector<uint32_t> fillTwoSetsShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x00000017, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000005, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00060010, 0x00000001, 0x00000011, 0x00000001, 0x00000001, 0x00000001, 0x00040047, 0x00000002, 0x0000000b, 0x0000001c, 0x00040047, 0x00000003, 0x00000006, 0x00000004, 0x00050048, 0x00000004, 0x00000000, 0x00000023, 0x00000000, 0x00030047, 0x00000004, 0x00000003, 0x00040047, 0x00000005, 0x00000022, 0x00000000, 0x00040047, 0x00000005, 0x00000021, 0x00000000, 0x00040047, 0x00000006, 0x00000022, 0x00000001, 0x00040047, 0x00000006, 0x00000021, 0x00000000, 0x00020013, 0x00000007, 0x00030021, 0x00000008, 0x00000007, 0x00040015, 0x00000009, 0x00000020, 0x00000000, 0x00040017, 0x0000000a, 0x00000009, 0x00000003, 0x00040020, 0x0000000b, 0x00000001, 0x0000000a, 0x0004003b, 0x0000000b, 0x00000002, 0x00000001, 0x0003001d, 0x00000003, 0x00000009, 0x0003001e, 0x00000004, 0x00000003, 0x00040020, 0x0000000c, 0x00000002, 0x00000004, 0x0004003b, 0x0000000c, 0x00000005, 0x00000002, 0x0004003b, 0x0000000c, 0x00000006, 0x00000002, 0x00040020, 0x0000000d, 0x00000002, 0x00000009, 0x00040015, 0x0000000e, 0x00000020, 0x00000001, 0x0004002b, 0x0000000e, 0x0000000f, 0x00000000, 0x0004002b, 0x00000009, 0x00000010, 0x00000001, 0x00050036, 0x00000007, 0x00000001, 0x00000000, 0x00000008, 0x000200f8, 0x00000011, 0x0004003d, 0x0000000a, 0x00000012, 0x00000002, 0x00050051, 0x00000009, 0x00000013, 0x00000012, 0x00000000, 0x00050080, 0x00000009, 0x00000014, 0x00000013, 0x00000010, 0x00060041, 0x0000000d, 0x00000015, 0x00000005, 0x0000000f, 0x00000013, 0x0003003e, 0x00000015, 0x00000014, 0x00060041, 0x0000000d, 0x00000016, 0x00000006, 0x0000000f, 0x00000013, 0x0003003e, 0x00000016, 0x00000014, 0x000100fd, 0x00010038 };
+
+/*
+    #version 450
+    void main()
+    {
+        vec2 position = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+        gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+    }
+*/
+const std::vector<uint32_t> fullScreenVertexShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x0000001c, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0007000f, 0x00000000, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00000003, 0x00040047, 0x00000002, 0x0000000b, 0x0000002a, 0x00040047, 0x00000003, 0x0000000b, 0x00000000, 0x00020013, 0x00000004, 0x00030021, 0x00000005, 0x00000004, 0x00030016, 0x00000006, 0x00000020, 0x00040017, 0x00000007, 0x00000006, 0x00000004, 0x00040015, 0x00000008, 0x00000020, 0x00000001, 0x00040020, 0x00000009, 0x00000001, 0x00000008, 0x0004003b, 0x00000009, 0x00000002, 0x00000001, 0x00040020, 0x0000000a, 0x00000003, 0x00000007, 0x0004003b, 0x0000000a, 0x00000003, 0x00000003, 0x0004002b, 0x00000008, 0x0000000b, 0x00000001, 0x0004002b, 0x00000008, 0x0000000c, 0x00000002, 0x0004002b, 0x00000006, 0x0000000d, 0x00000000, 0x0004002b, 0x00000006, 0x0000000e, 0x3f800000, 0x0004002b, 0x00000006, 0x0000000f, 0x40000000, 0x00050036, 0x00000004, 0x00000001, 0x00000000, 0x00000005, 0x000200f8, 0x00000010, 0x0004003d, 0x00000008, 0x00000011, 0x00000002, 0x000500c4, 0x00000008, 0x00000012, 0x00000011, 0x0000000b, 0x000500c7, 0x00000008, 0x00000013, 0x00000012, 0x0000000c, 0x000500c7, 0x00000008, 0x00000014, 0x00000011, 0x0000000c, 0x0004006f, 0x00000006, 0x00000015, 0x00000013, 0x0004006f, 0x00000006, 0x00000016, 0x00000014, 0x00050085, 0x00000006, 0x00000017, 0x00000015, 0x0000000f, 0x00050083, 0x00000006, 0x00000018, 0x00000017, 0x0000000e, 0x00050085, 0x00000006, 0x00000019, 0x00000016, 0x0000000f, 0x00050083, 0x00000006, 0x0000001a, 0x00000019, 0x0000000e, 0x00070050, 0x00000007, 0x0000001b, 0x00000018, 0x0000001a, 0x0000000d, 0x0000000e, 0x0003003e, 0x00000003, 0x0000001b, 0x000100fd, 0x00010038 };
+
+/*
+    #version 450
+    layout(location = 0) out vec4 outColor;
+    void main() { outColor = vec4(0.0, 1.0, 0.0, 1.0); }
+*/
+const std::vector<uint32_t> greenFragmentShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x0000000c, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000004, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00030010, 0x00000001, 0x00000007, 0x00040047, 0x00000002, 0x0000001e, 0x00000000, 0x00020013, 0x00000003, 0x00030021, 0x00000004, 0x00000003, 0x00030016, 0x00000005, 0x00000020, 0x00040017, 0x00000006, 0x00000005, 0x00000004, 0x00040020, 0x00000007, 0x00000003, 0x00000006, 0x0004003b, 0x00000007, 0x00000002, 0x00000003, 0x0004002b, 0x00000005, 0x00000008, 0x00000000, 0x0004002b, 0x00000005, 0x00000009, 0x3f800000, 0x0007002c, 0x00000006, 0x0000000a, 0x00000008, 0x00000009, 0x00000008, 0x00000009, 0x00050036, 0x00000003, 0x00000001, 0x00000000, 0x00000004, 0x000200f8, 0x0000000b, 0x0003003e, 0x00000002, 0x0000000a, 0x000100fd, 0x00010038 };
+
+/*
+    #version 450
+    layout(location = 0) out vec4 outAlbedo;
+    layout(location = 1) out vec4 outNormal;
+    void main()
+    {
+        outAlbedo = vec4(1.0, 0.0, 0.0, 1.0);
+        outNormal = vec4(0.0, 0.0, 1.0, 1.0);
+    }
+*/
+const std::vector<uint32_t> gbufferFragmentShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x0000000e, 0x00000000, 0x00020011, 0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0007000f, 0x00000004, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00000003, 0x00030010, 0x00000001, 0x00000007, 0x00040047, 0x00000002, 0x0000001e, 0x00000000, 0x00040047, 0x00000003, 0x0000001e, 0x00000001, 0x00020013, 0x00000004, 0x00030021, 0x00000005, 0x00000004, 0x00030016, 0x00000006, 0x00000020, 0x00040017, 0x00000007, 0x00000006, 0x00000004, 0x00040020, 0x00000008, 0x00000003, 0x00000007, 0x0004003b, 0x00000008, 0x00000002, 0x00000003, 0x0004003b, 0x00000008, 0x00000003, 0x00000003, 0x0004002b, 0x00000006, 0x00000009, 0x00000000, 0x0004002b, 0x00000006, 0x0000000a, 0x3f800000, 0x0007002c, 0x00000007, 0x0000000b, 0x0000000a, 0x00000009, 0x00000009, 0x0000000a, 0x0007002c, 0x00000007, 0x0000000c, 0x00000009, 0x00000009, 0x0000000a, 0x0000000a, 0x00050036, 0x00000004, 0x00000001, 0x00000000, 0x00000005, 0x000200f8, 0x0000000d, 0x0003003e, 0x00000002, 0x0000000b, 0x0003003e, 0x00000003, 0x0000000c, 0x000100fd, 0x00010038 };
+
+/*
+    #version 450
+    layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput albedo;
+    layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInput normal;
+    layout(location = 0) out vec4 outColor;
+    void main() { outColor = subpassLoad(albedo) + subpassLoad(normal); }
+*/
+const std::vector<uint32_t> lightingFragmentShaderSpv = { 0x07230203, 0x00010000, 0x00080001, 0x00000016, 0x00000000, 0x00020011, 0x00000001, 0x00020011, 0x00000028, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000004, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00030010, 0x00000001, 0x00000007, 0x00040047, 0x00000002, 0x0000001e, 0x00000000, 0x00040047, 0x00000003, 0x00000022, 0x00000000, 0x00040047, 0x00000003, 0x00000021, 0x00000000, 0x00040047, 0x00000003, 0x0000002b, 0x00000000, 0x00040047, 0x00000004, 0x00000022, 0x00000000, 0x00040047, 0x00000004, 0x00000021, 0x00000001, 0x00040047, 0x00000004, 0x0000002b, 0x00000001, 0x00020013, 0x00000005, 0x00030021, 0x00000006, 0x00000005, 0x00030016, 0x00000007, 0x00000020, 0x00040017, 0x00000008, 0x00000007, 0x00000004, 0x00040020, 0x00000009, 0x00000003, 0x00000008, 0x0004003b, 0x00000009, 0x00000002, 0x00000003, 0x00090019, 0x0000000a, 0x00000007, 0x00000006, 0x00000000, 0x00000000, 0x00000000, 0x00000002, 0x00000000, 0x00040020, 0x0000000b, 0x00000000, 0x0000000a, 0x0004003b, 0x0000000b, 0x00000003, 0x00000000, 0x0004003b, 0x0000000b, 0x00000004, 0x00000000, 0x00040015, 0x0000000c, 0x00000020, 0x00000001, 0x00040017, 0x0000000d, 0x0000000c, 0x00000002, 0x0004002b, 0x0000000c, 0x0000000e, 0x00000000, 0x0005002c, 0x0000000d, 0x0000000f, 0x0000000e, 0x0000000e, 0x00050036, 0x00000005, 0x00000001, 0x00000000, 0x00000006, 0x000200f8, 0x00000010, 0x0004003d, 0x0000000a, 0x00000011, 0x00000003, 0x00050062, 0x00000008, 0x00000012, 0x00000011, 0x0000000f, 0x0004003d, 0x0000000a, 0x00000013, 0x00000004, 0x00050062, 0x00000008, 0x00000014, 0x00000013, 0x0000000f, 0x00050081, 0x00000008, 0x00000015, 0x00000012, 0x00000014, 0x0003003e, 0x00000002, 0x00000015, 0x000100fd, 0x00010038 };
+
+const std::array<uint8_t, 4> kRed = { 255, 0, 0, 255 };
+const std::array<uint8_t, 4> kGreen = { 0, 255, 0, 255 };
+const std::array<uint8_t, 4> kMagenta = { 255, 0, 255, 255 };
+
+} // namespace
+
+void PassEncoderTest::SetUp()
+{
+    Test::SetUp();
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kGraphics;
+
+    m_queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, m_queue);
+
+    BufferBindingLayout bufferBindingLayout{};
+    bufferBindingLayout.index = 0;
+    bufferBindingLayout.stages = BindingStageFlagBits::kComputeStage;
+    bufferBindingLayout.type = BufferBindingType::kStorage;
+
+    BindingGroupLayoutDescriptor bindingGroupLayoutDescriptor{};
+    bindingGroupLayoutDescriptor.buffers = { bufferBindingLayout };
+
+    m_bindingGroupLayout = m_device->createBindingGroupLayout(bindingGroupLayoutDescriptor);
+    EXPECT_NE(nullptr, m_bindingGroupLayout);
+}
+
+void PassEncoderTest::TearDown()
+{
+    m_pipeline.reset();
+    m_shaderModules.clear();
+    m_pipelineLayouts.clear();
+    m_bindingGroupLayout.reset();
+    m_queue.reset();
+
+    Test::TearDown();
+}
+
+std::unique_ptr<ComputePipeline> PassEncoderTest::createComputePipeline(const std::vector<uint32_t>& spirv,
+                                                                        uint32_t setCount,
+                                                                        const std::vector<PushConstantRange>& pushConstantRanges)
+{
+    PipelineLayoutDescriptor pipelineLayoutDescriptor{};
+    pipelineLayoutDescriptor.layouts = BindingGroupLayouts(setCount, *m_bindingGroupLayout);
+    pipelineLayoutDescriptor.pushConstantRanges = pushConstantRanges;
+
+    auto pipelineLayout = m_device->createPipelineLayout(pipelineLayoutDescriptor);
+    EXPECT_NE(nullptr, pipelineLayout);
+
+    ShaderModuleDescriptor shaderModuleDescriptor{};
+    shaderModuleDescriptor.code = reinterpret_cast<const char*>(spirv.data());
+    shaderModuleDescriptor.codeSize = static_cast<uint32_t>(spirv.size() * sizeof(uint32_t));
+
+    auto shaderModule = m_device->createShaderModule(shaderModuleDescriptor);
+    EXPECT_NE(nullptr, shaderModule);
+
+    ComputePipelineDescriptor pipelineDescriptor{
+        { *pipelineLayout },
+        { { *shaderModule, "main" } },
+    };
+
+    auto pipeline = m_device->createComputePipeline(pipelineDescriptor);
+    EXPECT_NE(nullptr, pipeline);
+
+    // the pipeline references them.
+    m_pipelineLayouts.push_back(std::move(pipelineLayout));
+    m_shaderModules.push_back(std::move(shaderModule));
+
+    return pipeline;
+}
+
+std::unique_ptr<Buffer> PassEncoderTest::createStorageBuffer(uint32_t count, BufferUsageFlags usage)
+{
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = count * sizeof(uint32_t);
+    bufferDescriptor.usage = BufferUsageFlagBits::kStorage | usage;
+
+    auto buffer = m_device->createBuffer(bufferDescriptor);
+    EXPECT_NE(nullptr, buffer);
+
+    void* pointer = buffer->map();
+    EXPECT_NE(nullptr, pointer);
+    memset(pointer, 0, bufferDescriptor.size);
+    buffer->unmap();
+
+    return buffer;
+}
+
+std::unique_ptr<BindingGroup> PassEncoderTest::createBindingGroup(Buffer& buffer, uint32_t count, bool cached)
+{
+    BindingGroupDescriptor bindingGroupDescriptor{
+        .layout = *m_bindingGroupLayout,
+        .buffers = { { .index = 0, .offset = 0, .size = count * sizeof(uint32_t), .buffer = buffer } },
+        .cached = cached,
+    };
+
+    auto bindingGroup = m_device->createBindingGroup(bindingGroupDescriptor);
+    EXPECT_NE(nullptr, bindingGroup);
+
+    return bindingGroup;
+}
+
+std::vector<uint32_t> PassEncoderTest::read(Buffer& buffer, uint32_t count)
+{
+    std::vector<uint32_t> values(count);
+
+    void* pointer = buffer.map();
+    EXPECT_NE(nullptr, pointer);
+    memcpy(values.data(), pointer, count * sizeof(uint32_t));
+    buffer.unmap();
+
+    return values;
+}
+
+CacheStatistics PassEncoderTest::getCacheStatistics(const std::string& name)
+{
+    for (const auto& cache : m_device->getStatistics().caches)
+    {
+        if (cache.name == name)
+            return cache;
+    }
+
+    ADD_FAILURE() << "no cache statistics for " << name;
+    return CacheStatistics{};
+}
+
+std::unique_ptr<RenderPipeline> PassEncoderTest::createRenderPipeline()
+{
+    PipelineLayoutDescriptor pipelineLayoutDescriptor{};
+    auto pipelineLayout = m_device->createPipelineLayout(pipelineLayoutDescriptor);
+    EXPECT_NE(nullptr, pipelineLayout);
+
+    auto vertexShaderModule = createShaderModule(fullScreenVertexShaderSpv);
+    auto fragmentShaderModule = createShaderModule(greenFragmentShaderSpv);
+
+    auto pipeline = createRenderPipeline(*pipelineLayout, *vertexShaderModule, *fragmentShaderModule);
+
+    m_pipelineLayouts.push_back(std::move(pipelineLayout));
+    m_shaderModules.push_back(std::move(vertexShaderModule));
+    m_shaderModules.push_back(std::move(fragmentShaderModule));
+
+    return pipeline;
+}
+
+std::unique_ptr<RenderPipeline> PassEncoderTest::createRenderPipeline(PipelineLayout& pipelineLayout,
+                                                                      ShaderModule& vertexShaderModule,
+                                                                      ShaderModule& fragmentShaderModule,
+                                                                      FrontFace frontFace,
+                                                                      const std::optional<RenderPipelineSubpass>& subpass)
+{
+    InputAssemblyStage inputAssemblyStage{};
+    inputAssemblyStage.topology = PrimitiveTopology::kTriangleList;
+
+    VertexStage vertexStage{
+        { vertexShaderModule, "main" },
+        {}
+    };
+
+    RasterizationStage rasterizationStage{};
+    rasterizationStage.sampleCount = 1;
+    rasterizationStage.cullMode = CullMode::kNone;
+    rasterizationStage.frontFace = frontFace;
+
+    FragmentStage::Target target{};
+    target.format = TextureFormat::kRGBA_8888_UInt_Norm;
+
+    const size_t targetCount = subpass.has_value() ? subpass->subpasses[subpass->index].colorAttachments.size() : 1;
+    FragmentStage fragmentStage{
+        { fragmentShaderModule, "main" },
+        std::vector<FragmentStage::Target>(targetCount, target)
+    };
+
+    RenderPipelineDescriptor pipelineDescriptor{
+        { pipelineLayout },
+        inputAssemblyStage,
+        vertexStage,
+        rasterizationStage,
+        fragmentStage
+    };
+    pipelineDescriptor.subpass = subpass;
+
+    auto pipeline = m_device->createRenderPipeline(pipelineDescriptor);
+    EXPECT_NE(nullptr, pipeline);
+
+    return pipeline;
+}
+
+std::unique_ptr<ShaderModule> PassEncoderTest::createShaderModule(const std::vector<uint32_t>& spirv)
+{
+    ShaderModuleDescriptor shaderModuleDescriptor{};
+    shaderModuleDescriptor.code = reinterpret_cast<const char*>(spirv.data());
+    shaderModuleDescriptor.codeSize = static_cast<uint32_t>(spirv.size() * sizeof(uint32_t));
+
+    auto shaderModule = m_device->createShaderModule(shaderModuleDescriptor);
+    EXPECT_NE(nullptr, shaderModule);
+
+    return shaderModule;
+}
+
+void PassEncoderTest::drawFullScreen(RenderPipeline& pipeline, TextureView& textureView)
+{
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    ColorAttachment colorAttachment{
+        .renderView = textureView,
+        .loadOp = LoadOp::kClear,
+        .storeOp = StoreOp::kStore,
+        .clearValue = { 1.0, 0.0, 0.0, 1.0 },
+    };
+
+    RenderPassEncoderDescriptor renderPassEncoderDescriptor{
+        .colorAttachments = { colorAttachment },
+        .sampleCount = 1,
+    };
+
+    auto renderPassEncoder = commandEncoder->beginRenderPass(renderPassEncoderDescriptor);
+    renderPassEncoder->setPipeline(pipeline);
+    renderPassEncoder->setViewport(0, 0, static_cast<float>(textureView.getWidth()), static_cast<float>(textureView.getHeight()), 0, 1);
+    renderPassEncoder->setScissor(0, 0, static_cast<float>(textureView.getWidth()), static_cast<float>(textureView.getHeight()));
+    renderPassEncoder->draw(3);
+    renderPassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+}
+
+std::unique_ptr<Texture> PassEncoderTest::createRenderTexture(uint32_t width, uint32_t height)
+{
+    TextureDescriptor textureDescriptor{};
+    textureDescriptor.type = TextureType::k2D;
+    textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    textureDescriptor.usage = TextureUsageFlagBits::kColorAttachment | TextureUsageFlagBits::kCopySrc;
+    textureDescriptor.width = width;
+    textureDescriptor.height = height;
+    textureDescriptor.depth = 1;
+    textureDescriptor.mipLevels = 1;
+    textureDescriptor.sampleCount = 1;
+
+    auto texture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, texture);
+
+    return texture;
+}
+
+std::vector<std::array<uint8_t, 4>> PassEncoderTest::readPixels(Texture& texture)
+{
+    const uint32_t width = texture.getWidth();
+    const uint32_t height = texture.getHeight();
+
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = width * height * 4;
+    bufferDescriptor.usage = BufferUsageFlagBits::kCopyDst;
+
+    auto buffer = m_device->createBuffer(bufferDescriptor);
+    EXPECT_NE(nullptr, buffer);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    Extent3D extent{};
+    extent.width = width;
+    extent.height = height;
+    extent.depth = 1;
+
+    commandEncoder->copyTextureToBuffer({ .texture = texture, .aspect = TextureAspectFlagBits::kColor },
+                                        { .buffer = *buffer, .offset = 0, .bytesPerRow = width * 4, .rowsPerTexture = height },
+                                        extent);
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    std::vector<std::array<uint8_t, 4>> pixels(width * height);
+
+    void* pointer = buffer->map();
+    EXPECT_NE(nullptr, pointer);
+    memcpy(pixels.data(), pointer, bufferDescriptor.size);
+    buffer->unmap();
+
+    return pixels;
+}
+
+std::unique_ptr<Buffer> PassEncoderTest::createBuffer(const void* data, uint64_t size, BufferUsageFlags usage)
+{
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = size;
+    bufferDescriptor.usage = usage;
+
+    auto buffer = m_device->createBuffer(bufferDescriptor);
+    EXPECT_NE(nullptr, buffer);
+
+    void* pointer = buffer->map();
+    EXPECT_NE(nullptr, pointer);
+    memcpy(pointer, data, size);
+    buffer->unmap();
+
+    return buffer;
+}
+
+TEST_F(PassEncoderTest, test_BindingGroupsBeyondPoolCapacity)
+{
+    // the first descriptor pool has 16 sets and next pools are doubled. groups are allocated from 3 pools.
+    constexpr uint32_t bindingGroupCount = 100;
+    constexpr uint32_t count = 4;
+
+    m_pipeline = createComputePipeline(fillShaderSpv);
+
+    std::vector<std::unique_ptr<Buffer>> buffers{};
+    std::vector<std::unique_ptr<BindingGroup>> bindingGroups{};
+    for (uint32_t i = 0; i < bindingGroupCount; ++i)
+    {
+        buffers.push_back(createStorageBuffer(count));
+        bindingGroups.push_back(createBindingGroup(*buffers.back(), count));
+    }
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+    auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+    computePassEncoder->setPipeline(*m_pipeline);
+    for (auto& bindingGroup : bindingGroups)
+    {
+        computePassEncoder->setBindingGroup(0, *bindingGroup);
+        computePassEncoder->dispatch(count);
+    }
+    computePassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    for (auto& buffer : buffers)
+    {
+        auto values = read(*buffer, count);
+        for (uint32_t i = 0; i < count; ++i)
+            EXPECT_EQ(i + 1, values[i]);
+    }
+}
+
+TEST_F(PassEncoderTest, test_CachedBindingGroups)
+{
+    constexpr uint32_t count = 4;
+
+    m_pipeline = createComputePipeline(fillShaderSpv);
+
+    auto buffer = createStorageBuffer(count);
+    auto otherBuffer = createStorageBuffer(count);
+
+    m_device->resetStatistics();
+
+    // binding groups are not cached by default.
+    auto uncached = createBindingGroup(*buffer, count);
+    auto statistics = getCacheStatistics("Binding Group");
+    EXPECT_EQ(0, statistics.hits);
+    EXPECT_EQ(0, statistics.misses);
+    EXPECT_EQ(0, statistics.entries);
+
+    auto first = createBindingGroup(*buffer, count, true);
+    auto second = createBindingGroup(*buffer, count, true);
+    statistics = getCacheStatistics("Binding Group");
+    EXPECT_EQ(1, statistics.hits);
+    EXPECT_EQ(1, statistics.misses);
+    EXPECT_EQ(1, statistics.entries);
+
+    auto other = createBindingGroup(*otherBuffer, count, true);
+    statistics = getCacheStatistics("Binding Group");
+    EXPECT_EQ(1, statistics.hits);
+    EXPECT_EQ(2, statistics.misses);
+    EXPECT_EQ(2, statistics.entries);
+
+    // groups which share a descriptor set are bound as usual.
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+    auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+    computePassEncoder->setPipeline(*m_pipeline);
+    computePassEncoder->setBindingGroup(0, *second);
+    computePassEncoder->dispatch(count);
+    computePassEncoder->setBindingGroup(0, *other);
+    computePassEncoder->dispatch(count);
+    computePassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    for (auto* target : { buffer.get(), otherBuffer.get() })
+    {
+        auto values = read(*target, count);
+        for (uint32_t i = 0; i < count; ++i)
+            EXPECT_EQ(i + 1, values[i]);
+    }
+
+    // destroying a bound resource evicts only the entries which reference it.
+    other.reset();
+    otherBuffer.reset();
+    statistics = getCacheStatistics("Binding Group");
+    EXPECT_EQ(1, statistics.evictions);
+    EXPECT_EQ(1, statistics.entries);
+
+    // a new buffer may have the handle of the destroyed one, but it must not hit.
+    auto newBuffer = createStorageBuffer(count);
+    auto newGroup = createBindingGroup(*newBuffer, count, true);
+    statistics = getCacheStatistics("Binding Group");
+    EXPECT_EQ(1, statistics.hits);
+    EXPECT_EQ(3, statistics.misses);
+    EXPECT_EQ(2, statistics.entries);
+
+    first.reset();
+    second.reset();
+    uncached.reset();
+    newGroup.reset();
+    buffer.reset();
+    newBuffer.reset();
+    statistics = getCacheStatistics("Binding Group");
+    EXPECT_EQ(0, statistics.entries);
+}
+
+TEST_F(PassEncoderTest, test_PushConstants)
+{
+    constexpr uint32_t count = 4;
+
+    m_pipeline = createComputePipeline(pushConstantShaderSpv, 1, { { .stages = BindingStageFlagBits::kComputeStage, .offset = 0, .size = sizeof(uint32_t) } });
+
+    auto firstBuffer = createStorageBuffer(count);
+    auto secondBuffer = createStorageBuffer(count);
+    auto firstBindingGroup = createBindingGroup(*firstBuffer, count);
+    auto secondBindingGroup = createBindingGroup(*secondBuffer, count);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // each dispatch reads the value which is pushed before it.
+    const uint32_t firstValue = 100;
+    const uint32_t secondValue = 200;
+
+    ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+    auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+    computePassEncoder->setPipeline(*m_pipeline);
+    computePassEncoder->setBindingGroup(0, *firstBindingGroup);
+    computePassEncoder->setPushConstants(BindingStageFlagBits::kComputeStage, 0, &firstValue, sizeof(uint32_t));
+    computePassEncoder->dispatch(count);
+    computePassEncoder->setBindingGroup(0, *secondBindingGroup);
+    computePassEncoder->setPushConstants(BindingStageFlagBits::kComputeStage, 0, &secondValue, sizeof(uint32_t));
+    computePassEncoder->dispatch(count);
+    computePassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    auto firstValues = read(*firstBuffer, count);
+    auto secondValues = read(*secondBuffer, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(firstValue + i, firstValues[i]);
+        EXPECT_EQ(secondValue + i, secondValues[i]);
+    }
+}
+
+TEST_F(PassEncoderTest, test_PushBindings)
+{
+    constexpr uint32_t count = 4;
+
+    BufferBindingLayout bufferBindingLayout{};
+    bufferBindingLayout.index = 0;
+    bufferBindingLayout.stages = BindingStageFlagBits::kComputeStage;
+    bufferBindingLayout.type = BufferBindingType::kStorage;
+
+    BindingGroupLayoutDescriptor bindingGroupLayoutDescriptor{};
+    bindingGroupLayoutDescriptor.buffers = { bufferBindingLayout };
+    bindingGroupLayoutDescriptor.pushDescriptor = true;
+
+    try
+    {
+        m_bindingGroupLayout = m_device->createBindingGroupLayout(bindingGroupLayoutDescriptor);
+    }
+    catch (const std::runtime_error& error)
+    {
+        GTEST_SKIP() << error.what();
+    }
+
+    m_pipeline = createComputePipeline(fillShaderSpv);
+
+    auto firstBuffer = createStorageBuffer(count);
+    auto secondBuffer = createStorageBuffer(count);
+
+    // binding groups can't be created for the push descriptor layout.
+    EXPECT_THROW(createBindingGroup(*firstBuffer, count), std::runtime_error);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // each dispatch writes the buffer which is pushed before it.
+    ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+    auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+    computePassEncoder->setPipeline(*m_pipeline);
+    for (auto* buffer : { firstBuffer.get(), secondBuffer.get() })
+    {
+        BindingGroupDescriptor bindingGroupDescriptor{
+            .layout = *m_bindingGroupLayout,
+            .buffers = { { .index = 0, .offset = 0, .size = count * sizeof(uint32_t), .buffer = *buffer } },
+        };
+        computePassEncoder->pushBindings(0, bindingGroupDescriptor);
+        computePassEncoder->dispatch(count);
+    }
+    computePassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    for (auto* buffer : { firstBuffer.get(), secondBuffer.get() })
+    {
+        auto values = read(*buffer, count);
+        for (uint32_t i = 0; i < count; ++i)
+            EXPECT_EQ(i + 1, values[i]);
+    }
+}
+
+TEST_F(PassEncoderTest, test_BindingGroupBeforePipeline)
+{
+    constexpr uint32_t count = 4;
+
+    m_pipeline = createComputePipeline(fillShaderSpv);
+
+    auto buffer = createStorageBuffer(count);
+    auto bindingGroup = createBindingGroup(*buffer, count);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    // the binding group is bound at dispatch with the layout of the pipeline which is set after it.
+    ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+    auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+    computePassEncoder->setBindingGroup(0, *bindingGroup, {});
+    computePassEncoder->setPipeline(*m_pipeline);
+    computePassEncoder->dispatch(count);
+    computePassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    auto statistics = commandBuffer->getStatistics();
+    EXPECT_EQ(2, statistics.issuedCommands);
+    EXPECT_EQ(0, statistics.elidedCommands);
+
+    auto values = read(*buffer, count);
+    for (uint32_t i = 0; i < count; ++i)
+        EXPECT_EQ(i + 1, values[i]);
+}
+
+TEST_F(PassEncoderTest, test_ElidedBindingGroups)
+{
+    constexpr uint32_t count = 4;
+
+    m_pipeline = createComputePipeline(fillShaderSpv);
+
+    auto boundBuffer = createStorageBuffer(count);
+    auto replacedBuffer = createStorageBuffer(count);
+    auto boundBindingGroup = createBindingGroup(*boundBuffer, count);
+    auto replacedBindingGroup = createBindingGroup(*replacedBuffer, count);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+    auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+    computePassEncoder->setPipeline(*m_pipeline);                  // issued
+    computePassEncoder->setBindingGroup(0, *replacedBindingGroup); // replaced by the next call
+    computePassEncoder->setBindingGroup(0, *replacedBindingGroup); // elided, same as requested
+    computePassEncoder->setBindingGroup(0, *boundBindingGroup);    // elided once for the replaced request
+    computePassEncoder->dispatch(count);                           // issued
+    computePassEncoder->setBindingGroup(0, *boundBindingGroup);    // elided, same as bound
+    computePassEncoder->setBindingGroup(0, *replacedBindingGroup); // replaced by the next call
+    computePassEncoder->setBindingGroup(0, *boundBindingGroup);    // elided once, same as bound and replaces a request
+    computePassEncoder->setPipeline(*m_pipeline);                  // elided
+    computePassEncoder->dispatch(count);
+    computePassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    auto statistics = commandBuffer->getStatistics();
+    EXPECT_EQ(2, statistics.issuedCommands);
+    EXPECT_EQ(5, statistics.elidedCommands);
+
+    // replaced binding groups are never bound.
+    auto boundValues = read(*boundBuffer, count);
+    auto replacedValues = read(*replacedBuffer, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(i + 1, boundValues[i]);
+        EXPECT_EQ(0, replacedValues[i]);
+    }
+}
+
+TEST_F(PassEncoderTest, test_CoalescedBindingGroups)
+{
+    constexpr uint32_t count = 4;
+
+    m_pipeline = createComputePipeline(fillShaderSpv);
+    auto twoSetsPipeline = createComputePipeline(fillTwoSetsShaderSpv, 2);
+
+    std::vector<std::unique_ptr<Buffer>> buffers{};
+    std::vector<std::unique_ptr<BindingGroup>> bindingGroups{};
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        buffers.push_back(createStorageBuffer(count));
+        bindingGroups.push_back(createBindingGroup(*buffers.back(), count));
+    }
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+    auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+    // sets which are set in reverse order are bound by one command.
+    computePassEncoder->setBindingGroup(1, *bindingGroups[1]);
+    computePassEncoder->setBindingGroup(0, *bindingGroups[0]);
+    computePassEncoder->setPipeline(*twoSetsPipeline);
+    computePassEncoder->dispatch(count);
+    // only the changed set is bound.
+    computePassEncoder->setBindingGroup(1, *bindingGroups[2]);
+    computePassEncoder->dispatch(count);
+    // the set 0 is kept for the pipeline which has a compatible layout.
+    computePassEncoder->setPipeline(*m_pipeline);
+    computePassEncoder->dispatch(count);
+    computePassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    // 3 pipelines and 2 descriptor set binds. set 1 is merged into the first bind.
+    auto statistics = commandBuffer->getStatistics();
+    EXPECT_EQ(4, statistics.issuedCommands);
+    EXPECT_EQ(1, statistics.elidedCommands);
+
+    for (auto& buffer : buffers)
+    {
+        auto values = read(*buffer, count);
+        for (uint32_t i = 0; i < count; ++i)
+            EXPECT_EQ(i + 1, values[i]);
+    }
+}
+
+TEST_F(PassEncoderTest, test_RebindAfterIncompatiblePipeline)
+{
+    constexpr uint32_t count = 4;
+
+    m_pipeline = createComputePipeline(fillShaderSpv);
+    auto pushConstantPipeline = createComputePipeline(pushConstantShaderSpv, 1, { { .stages = BindingStageFlagBits::kComputeStage, .offset = 0, .size = sizeof(uint32_t) } });
+
+    auto fillBuffer = createStorageBuffer(count);
+    auto pushConstantBuffer = createStorageBuffer(count);
+    auto fillBindingGroup = createBindingGroup(*fillBuffer, count);
+    auto pushConstantBindingGroup = createBindingGroup(*pushConstantBuffer, count);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    const uint32_t value = 100;
+
+    ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+    auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+    computePassEncoder->setPipeline(*m_pipeline);
+    computePassEncoder->setBindingGroup(0, *pushConstantBindingGroup);
+    computePassEncoder->dispatch(count);
+    // push constant ranges are different, so the set which is set before is bound again.
+    computePassEncoder->setPipeline(*pushConstantPipeline);
+    computePassEncoder->setPushConstants(BindingStageFlagBits::kComputeStage, 0, &value, sizeof(uint32_t));
+    computePassEncoder->dispatch(count);
+    // back to the first pipeline with another set.
+    computePassEncoder->setPipeline(*m_pipeline);
+    computePassEncoder->setBindingGroup(0, *fillBindingGroup);
+    computePassEncoder->dispatch(count);
+    computePassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    // 3 pipelines and 3 descriptor set binds. the set which is bound again for the last pipeline is replaced before it is bound.
+    auto statistics = commandBuffer->getStatistics();
+    EXPECT_EQ(6, statistics.issuedCommands);
+    EXPECT_EQ(1, statistics.elidedCommands);
+
+    auto fillValues = read(*fillBuffer, count);
+    auto pushConstantValues = read(*pushConstantBuffer, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(i + 1, fillValues[i]);
+        EXPECT_EQ(value + i, pushConstantValues[i]);
+    }
+}
+
+TEST_F(PassEncoderTest, test_DrawIndirect)
+{
+    auto pipeline = createRenderPipeline();
+    auto texture = createRenderTexture(4, 1);
+    auto textureView = texture->createTextureView({ .type = TextureViewType::k2D, .aspect = TextureAspectFlagBits::kColor });
+
+    // the second draw has no instance.
+    const std::array<DrawIndirectArgs, 2> drawArgs = { DrawIndirectArgs{ .vertexCount = 3, .instanceCount = 1 },
+                                                       DrawIndirectArgs{ .vertexCount = 3, .instanceCount = 0 } };
+    const std::array<DrawIndexedIndirectArgs, 1> drawIndexedArgs = { DrawIndexedIndirectArgs{ .indexCount = 3, .instanceCount = 1 } };
+    const std::array<uint32_t, 3> indices = { 0, 1, 2 };
+
+    auto drawBuffer = createBuffer(drawArgs.data(), sizeof(drawArgs), BufferUsageFlagBits::kIndirect);
+    auto drawIndexedBuffer = createBuffer(drawIndexedArgs.data(), sizeof(drawIndexedArgs), BufferUsageFlagBits::kIndirect);
+    auto indexBuffer = createBuffer(indices.data(), sizeof(indices), BufferUsageFlagBits::kIndex);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    ColorAttachment colorAttachment{
+        .renderView = *textureView,
+        .loadOp = LoadOp::kClear,
+        .storeOp = StoreOp::kStore,
+        .clearValue = { 1.0, 0.0, 0.0, 1.0 },
+    };
+
+    RenderPassEncoderDescriptor renderPassEncoderDescriptor{
+        .colorAttachments = { colorAttachment },
+        .sampleCount = 1,
+    };
+
+    // each draw covers a pixel.
+    auto renderPassEncoder = commandEncoder->beginRenderPass(renderPassEncoderDescriptor);
+    renderPassEncoder->setPipeline(*pipeline);
+    renderPassEncoder->setIndexBuffer(*indexBuffer, IndexFormat::kUint32);
+
+    renderPassEncoder->setViewport(0, 0, 1, 1, 0, 1);
+    renderPassEncoder->setScissor(0, 0, 1, 1);
+    renderPassEncoder->drawIndirect(*drawBuffer, 0);
+
+    renderPassEncoder->setViewport(1, 0, 1, 1, 0, 1);
+    renderPassEncoder->setScissor(1, 0, 1, 1);
+    renderPassEncoder->drawIndexedIndirect(*drawIndexedBuffer, 0);
+
+    renderPassEncoder->setViewport(2, 0, 1, 1, 0, 1);
+    renderPassEncoder->setScissor(2, 0, 1, 1);
+    renderPassEncoder->drawIndirect(*drawBuffer, sizeof(DrawIndirectArgs));
+
+    renderPassEncoder->setViewport(3, 0, 1, 1, 0, 1);
+    renderPassEncoder->setScissor(3, 0, 1, 1);
+    renderPassEncoder->multiDrawIndirect(*drawBuffer, 0, static_cast<uint32_t>(drawArgs.size()));
+
+    renderPassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    auto pixels = readPixels(*texture);
+    EXPECT_EQ(kGreen, pixels[0]);
+    EXPECT_EQ(kGreen, pixels[1]);
+    EXPECT_EQ(kRed, pixels[2]);
+    EXPECT_EQ(kGreen, pixels[3]);
+}
+
+TEST_F(PassEncoderTest, test_MultiDrawIndirectCount)
+{
+    auto pipeline = createRenderPipeline();
+    auto texture = createRenderTexture(3, 1);
+    auto textureView = texture->createTextureView({ .type = TextureViewType::k2D, .aspect = TextureAspectFlagBits::kColor });
+
+    const std::array<DrawIndirectArgs, 1> drawArgs = { DrawIndirectArgs{ .vertexCount = 3, .instanceCount = 1 } };
+    const std::array<DrawIndexedIndirectArgs, 1> drawIndexedArgs = { DrawIndexedIndirectArgs{ .indexCount = 3, .instanceCount = 1 } };
+    const std::array<uint32_t, 3> indices = { 0, 1, 2 };
+    // draw counts read by the count buffer.
+    const std::array<uint32_t, 2> counts = { 1, 0 };
+
+    auto drawBuffer = createBuffer(drawArgs.data(), sizeof(drawArgs), BufferUsageFlagBits::kIndirect);
+    auto drawIndexedBuffer = createBuffer(drawIndexedArgs.data(), sizeof(drawIndexedArgs), BufferUsageFlagBits::kIndirect);
+    auto indexBuffer = createBuffer(indices.data(), sizeof(indices), BufferUsageFlagBits::kIndex);
+    auto countBuffer = createBuffer(counts.data(), sizeof(counts), BufferUsageFlagBits::kIndirect);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    ColorAttachment colorAttachment{
+        .renderView = *textureView,
+        .loadOp = LoadOp::kClear,
+        .storeOp = StoreOp::kStore,
+        .clearValue = { 1.0, 0.0, 0.0, 1.0 },
+    };
+
+    RenderPassEncoderDescriptor renderPassEncoderDescriptor{
+        .colorAttachments = { colorAttachment },
+        .sampleCount = 1,
+    };
+
+    auto renderPassEncoder = commandEncoder->beginRenderPass(renderPassEncoderDescriptor);
+    renderPassEncoder->setPipeline(*pipeline);
+    renderPassEncoder->setIndexBuffer(*indexBuffer, IndexFormat::kUint32);
+
+    renderPassEncoder->setViewport(0, 0, 1, 1, 0, 1);
+    renderPassEncoder->setScissor(0, 0, 1, 1);
+    try
+    {
+        renderPassEncoder->multiDrawIndirect(*drawBuffer, 0, 1, countBuffer.get(), 0);
+    }
+    catch (const std::runtime_error& error)
+    {
+        GTEST_SKIP() << error.what();
+    }
+
+    // the count is 0.
+    renderPassEncoder->setViewport(1, 0, 1, 1, 0, 1);
+    renderPassEncoder->setScissor(1, 0, 1, 1);
+    renderPassEncoder->multiDrawIndirect(*drawBuffer, 0, 1, countBuffer.get(), sizeof(uint32_t));
+
+    renderPassEncoder->setViewport(2, 0, 1, 1, 0, 1);
+    renderPassEncoder->setScissor(2, 0, 1, 1);
+    renderPassEncoder->multiDrawIndexedIndirect(*drawIndexedBuffer, 0, 1, countBuffer.get(), 0);
+
+    renderPassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    auto pixels = readPixels(*texture);
+    EXPECT_EQ(kGreen, pixels[0]);
+    EXPECT_EQ(kRed, pixels[1]);
+    EXPECT_EQ(kGreen, pixels[2]);
+}
+
+TEST_F(PassEncoderTest, test_DispatchIndirect)
+{
+    constexpr uint32_t count = 4;
+
+    m_pipeline = createComputePipeline(fillShaderSpv);
+
+    auto firstBuffer = createStorageBuffer(count);
+    auto secondBuffer = createStorageBuffer(count);
+    auto firstBindingGroup = createBindingGroup(*firstBuffer, count);
+    auto secondBindingGroup = createBindingGroup(*secondBuffer, count);
+
+    const std::array<DispatchIndirectArgs, 2> dispatchArgs = { DispatchIndirectArgs{ .x = count, .y = 1, .z = 1 },
+                                                               DispatchIndirectArgs{ .x = count / 2, .y = 1, .z = 1 } };
+    auto indirectBuffer = createBuffer(dispatchArgs.data(), sizeof(dispatchArgs), BufferUsageFlagBits::kIndirect);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    CommandEncoderDescriptor commandEncoderDescriptor{};
+    auto commandEncoder = commandBuffer->createCommandEncoder(commandEncoderDescriptor);
+    EXPECT_NE(nullptr, commandEncoder);
+
+    ComputePassEncoderDescriptor computePassEncoderDescriptor{};
+    auto computePassEncoder = commandEncoder->beginComputePass(computePassEncoderDescriptor);
+    computePassEncoder->setPipeline(*m_pipeline);
+    computePassEncoder->setBindingGroup(0, *firstBindingGroup);
+    computePassEncoder->dispatchIndirect(*indirectBuffer, 0);
+    computePassEncoder->setBindingGroup(0, *secondBindingGroup);
+    computePassEncoder->dispatchIndirect(*indirectBuffer, sizeof(DispatchIndirectArgs));
+    computePassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    // the second dispatch has half of workgroups.
+    auto firstValues = read(*firstBuffer, count);
+    auto secondValues = read(*secondBuffer, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(i + 1, firstValues[i]);
+        EXPECT_EQ(i < count / 2 ? i + 1 : 0, secondValues[i]);
+    }
+}
+
+TEST_F(PassEncoderTest, test_ReusePipelineLibraries)
+{
+    auto pipelineLayout = m_device->createPipelineLayout(PipelineLayoutDescriptor{});
+    auto vertexShaderModule = createShaderModule(fullScreenVertexShaderSpv);
+    auto fragmentShaderModule = createShaderModule(greenFragmentShaderSpv);
+
+    m_device->resetStatistics();
+
+    // vertex input, pre-rasterization shaders, fragment shader and fragment output libraries are compiled.
+    auto pipeline = createRenderPipeline(*pipelineLayout, *vertexShaderModule, *fragmentShaderModule);
+    auto statistics = getCacheStatistics("Pipeline Library");
+    if (statistics.misses == 0)
+        GTEST_SKIP() << "graphics pipeline libraries with fast linking are not supported.";
+    EXPECT_EQ(4, statistics.misses);
+    EXPECT_EQ(0, statistics.hits);
+
+    // only the pre-rasterization shaders library has the front face.
+    auto clockwisePipeline = createRenderPipeline(*pipelineLayout, *vertexShaderModule, *fragmentShaderModule, FrontFace::kClockwise);
+    statistics = getCacheStatistics("Pipeline Library");
+    EXPECT_EQ(5, statistics.misses);
+    EXPECT_EQ(3, statistics.hits);
+
+    // same states are linked from cached libraries only.
+    auto samePipeline = createRenderPipeline(*pipelineLayout, *vertexShaderModule, *fragmentShaderModule);
+    statistics = getCacheStatistics("Pipeline Library");
+    EXPECT_EQ(5, statistics.misses);
+    EXPECT_EQ(7, statistics.hits);
+    EXPECT_EQ(5, statistics.entries);
+
+    // fast linked pipelines are replaced by link time optimized ones in background. both draw the same.
+    auto texture = createRenderTexture(4, 4);
+    auto textureView = texture->createTextureView({ .type = TextureViewType::k2D, .aspect = TextureAspectFlagBits::kColor });
+    for (auto frame = 0; frame < 10; ++frame)
+    {
+        for (auto linkedPipeline : { pipeline.get(), clockwisePipeline.get(), samePipeline.get() })
+        {
+            drawFullScreen(*linkedPipeline, *textureView);
+            for (const auto& pixel : readPixels(*texture))
+                EXPECT_EQ(kGreen, pixel);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+TEST_F(PassEncoderTest, test_InvalidatePipelineLibraries)
+{
+    auto pipelineLayout = m_device->createPipelineLayout(PipelineLayoutDescriptor{});
+    auto vertexShaderModule = createShaderModule(fullScreenVertexShaderSpv);
+    auto fragmentShaderModule = createShaderModule(greenFragmentShaderSpv);
+
+    m_device->resetStatistics();
+
+    auto pipeline = createRenderPipeline(*pipelineLayout, *vertexShaderModule, *fragmentShaderModule);
+    auto statistics = getCacheStatistics("Pipeline Library");
+    if (statistics.misses == 0)
+        GTEST_SKIP() << "graphics pipeline libraries with fast linking are not supported.";
+    EXPECT_EQ(4, statistics.entries);
+
+    // the fragment shader library is removed with its module, but the linked pipeline keeps it.
+    fragmentShaderModule.reset();
+    statistics = getCacheStatistics("Pipeline Library");
+    EXPECT_EQ(1, statistics.evictions);
+    EXPECT_EQ(3, statistics.entries);
+
+    auto texture = createRenderTexture(4, 4);
+    auto textureView = texture->createTextureView({ .type = TextureViewType::k2D, .aspect = TextureAspectFlagBits::kColor });
+    drawFullScreen(*pipeline, *textureView);
+    for (const auto& pixel : readPixels(*texture))
+        EXPECT_EQ(kGreen, pixel);
+
+    // a new module is compiled to a new library, even if its code is same.
+    fragmentShaderModule = createShaderModule(greenFragmentShaderSpv);
+    auto recreatedPipeline = createRenderPipeline(*pipelineLayout, *vertexShaderModule, *fragmentShaderModule);
+    statistics = getCacheStatistics("Pipeline Library");
+    EXPECT_EQ(5, statistics.misses);
+    EXPECT_EQ(3, statistics.hits);
+
+    // the pre-rasterization shaders and fragment shader libraries are removed with the layout.
+    pipeline.reset();
+    recreatedPipeline.reset();
+    pipelineLayout.reset();
+    statistics = getCacheStatistics("Pipeline Library");
+    EXPECT_EQ(3, statistics.evictions);
+    EXPECT_EQ(2, statistics.entries);
+}
+
+TEST_F(PassEncoderTest, test_Subpasses)
+{
+    constexpr uint32_t width = 4;
+    constexpr uint32_t height = 4;
+
+    // the gbuffer is written by the first subpass and read as input attachments by the second one.
+    TextureDescriptor gbufferDescriptor{};
+    gbufferDescriptor.type = TextureType::k2D;
+    gbufferDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    gbufferDescriptor.usage = TextureUsageFlagBits::kColorAttachment | TextureUsageFlagBits::kInputAttachment;
+    gbufferDescriptor.width = width;
+    gbufferDescriptor.height = height;
+    gbufferDescriptor.depth = 1;
+    gbufferDescriptor.mipLevels = 1;
+    gbufferDescriptor.sampleCount = 1;
+
+    const TextureViewDescriptor textureViewDescriptor{ .type = TextureViewType::k2D, .aspect = TextureAspectFlagBits::kColor };
+    auto albedoTexture = m_device->createTexture(gbufferDescriptor);
+    auto albedoTextureView = albedoTexture->createTextureView(textureViewDescriptor);
+    auto normalTexture = m_device->createTexture(gbufferDescriptor);
+    auto normalTextureView = normalTexture->createTextureView(textureViewDescriptor);
+    auto outputTexture = createRenderTexture(width, height);
+    auto outputTextureView = outputTexture->createTextureView(textureViewDescriptor);
+
+    const std::vector<SubpassDescriptor> subpasses = {
+        { .colorAttachments = { 0, 1 }, .depthStencil = false },
+        { .colorAttachments = { 2 }, .inputAttachments = { 0, 1 }, .depthStencil = false },
+    };
+    RenderPipelineSubpass subpass{
+        .colorFormats = { gbufferDescriptor.format, gbufferDescriptor.format, outputTexture->getFormat() },
+        .subpasses = subpasses,
+    };
+
+    auto vertexShaderModule = createShaderModule(fullScreenVertexShaderSpv);
+    auto gbufferShaderModule = createShaderModule(gbufferFragmentShaderSpv);
+    auto lightingShaderModule = createShaderModule(lightingFragmentShaderSpv);
+
+    auto gbufferPipelineLayout = m_device->createPipelineLayout(PipelineLayoutDescriptor{});
+    subpass.index = 0;
+    auto gbufferPipeline = createRenderPipeline(*gbufferPipelineLayout, *vertexShaderModule, *gbufferShaderModule, FrontFace::kCounterClockwise, subpass);
+
+    BindingGroupLayoutDescriptor bindingGroupLayoutDescriptor{};
+    bindingGroupLayoutDescriptor.inputAttachments = {
+        { { .index = 0, .stages = BindingStageFlagBits::kFragmentStage } },
+        { { .index = 1, .stages = BindingStageFlagBits::kFragmentStage } },
+    };
+    auto bindingGroupLayout = m_device->createBindingGroupLayout(bindingGroupLayoutDescriptor);
+    EXPECT_NE(nullptr, bindingGroupLayout);
+
+    auto lightingPipelineLayout = m_device->createPipelineLayout({ .layouts = { *bindingGroupLayout } });
+    subpass.index = 1;
+    auto lightingPipeline = createRenderPipeline(*lightingPipelineLayout, *vertexShaderModule, *lightingShaderModule, FrontFace::kCounterClockwise, subpass);
+
+    auto bindingGroup = m_device->createBindingGroup({
+        .layout = *bindingGroupLayout,
+        .inputAttachments = { { .index = 0, .textureView = *albedoTextureView }, { .index = 1, .textureView = *normalTextureView } },
+    });
+    EXPECT_NE(nullptr, bindingGroup);
+
+    auto commandBuffer = m_device->createCommandBuffer(CommandBufferDescriptor{});
+    auto commandEncoder = commandBuffer->createCommandEncoder(CommandEncoderDescriptor{});
+
+    // the gbuffer is not needed after the render pass, so it is not stored.
+    RenderPassEncoderDescriptor renderPassEncoderDescriptor{
+        .colorAttachments = {
+            { .renderView = *albedoTextureView, .loadOp = LoadOp::kClear, .storeOp = StoreOp::kDontCare },
+            { .renderView = *normalTextureView, .loadOp = LoadOp::kClear, .storeOp = StoreOp::kDontCare },
+            { .renderView = *outputTextureView, .loadOp = LoadOp::kClear, .storeOp = StoreOp::kStore, .clearValue = { 1.0, 0.0, 0.0, 1.0 } },
+        },
+        .sampleCount = 1,
+        .subpasses = subpasses,
+    };
+
+    auto renderPassEncoder = commandEncoder->beginRenderPass(renderPassEncoderDescriptor);
+    renderPassEncoder->setViewport(0, 0, width, height, 0, 1);
+    renderPassEncoder->setScissor(0, 0, width, height);
+    renderPassEncoder->setPipeline(*gbufferPipeline);
+    renderPassEncoder->draw(3);
+
+    renderPassEncoder->nextPass();
+    renderPassEncoder->setPipeline(*lightingPipeline);
+    renderPassEncoder->setBindingGroup(0, *bindingGroup);
+    renderPassEncoder->draw(3);
+    renderPassEncoder->end();
+
+    m_queue->submit({ commandEncoder->finish() });
+
+    // red albedo and blue normal are added by the second subpass.
+    for (const auto& pixel : readPixels(*outputTexture))
+        EXPECT_EQ(kMagenta, pixel);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "base/test.h"
+
+#include "jipu/binding_group.h"
+#include "jipu/binding_group_layout.h"
+#include "jipu/buffer.h"
+#include "jipu/pipeline.h"
+#include "jipu/pipeline_layout.h"
+#include "jipu/queue.h"
+#include "jipu/shader_module.h"
+#include "jipu/texture.h"
+#include "jipu/texture_view.h"
+
+#include <array>
+#include <optional>
+
+namespace jipu
+{
+
+class PassEncoderTest : public Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+protected:
+    /// @brief create the compute pipeline which writes uint values to storage buffers at binding 0 of sets.
+    /// all sets have the binding group layout of the fixture.
+    std::unique_ptr<ComputePipeline> createComputePipeline(const std::vector<uint32_t>& spirv,
+                                                           uint32_t setCount = 1,
+                                                           const std::vector<PushConstantRange>& pushConstantRanges = {});
+    /// @brief storage buffer of zero filled uint values.
+    std::unique_ptr<Buffer> createStorageBuffer(uint32_t count, BufferUsageFlags usage = 0);
+    std::unique_ptr<BindingGroup> createBindingGroup(Buffer& buffer, uint32_t count, bool cached = false);
+    std::vector<uint32_t> read(Buffer& buffer, uint32_t count);
+    CacheStatistics getCacheStatistics(const std::string& name);
+
+    /// @brief pipeline which draws a green triangle over the viewport without vertex buffers.
+    std::unique_ptr<RenderPipeline> createRenderPipeline();
+    /// @brief same pipeline with the given layout and shader modules. triangles are not culled, so the front face doesn't change the output.
+    /// the pipeline has a RGBA8 target for each color attachment of the subpass.
+    std::unique_ptr<RenderPipeline> createRenderPipeline(PipelineLayout& pipelineLayout,
+                                                         ShaderModule& vertexShaderModule,
+                                                         ShaderModule& fragmentShaderModule,
+                                                         FrontFace frontFace = FrontFace::kCounterClockwise,
+                                                         const std::optional<RenderPipelineSubpass>& subpass = std::nullopt);
+    std::unique_ptr<ShaderModule> createShaderModule(const std::vector<uint32_t>& spirv);
+    /// @brief clear the view to red and draw the pipeline over it.
+    void drawFullScreen(RenderPipeline& pipeline, TextureView& textureView);
+    /// @brief RGBA8 color attachment which can be copied to a buffer.
+    std::unique_ptr<Texture> createRenderTexture(uint32_t width, uint32_t height);
+    std::vector<std::array<uint8_t, 4>> readPixels(Texture& texture);
+    std::unique_ptr<Buffer> createBuffer(const void* data, uint64_t size, BufferUsageFlags usage);
+
+protected:
+    std::unique_ptr<Queue> m_queue = nullptr;
+    std::unique_ptr<BindingGroupLayout> m_bindingGroupLayout = nullptr;
+    std::vector<std::unique_ptr<PipelineLayout>> m_pipelineLayouts{};
+    std::vector<std::unique_ptr<ShaderModule>> m_shaderModules{};
+    std::unique_ptr<ComputePipeline> m_pipeline = nullptr;
+};
+
+} // namespace jipu
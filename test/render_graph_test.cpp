@@ -0,0 +1,313 @@
+#include "render_graph_test.h"
+
+using namespace jipu;
+
+void RenderGraphTest::SetUp()
+{
+    Test::SetUp();
+
+    TextureDescriptor textureDescriptor = getColorTextureDescriptor();
+    textureDescriptor.usage = TextureUsageFlagBits::kColorAttachment | TextureUsageFlagBits::kTextureBinding;
+
+    m_outputTexture = m_device->createTexture(textureDescriptor);
+    EXPECT_NE(nullptr, m_outputTexture);
+
+    TextureViewDescriptor textureViewDescriptor{};
+    textureViewDescriptor.type = TextureViewType::k2D;
+    textureViewDescriptor.aspect = TextureAspectFlagBits::kColor;
+
+    m_outputTextureView = m_outputTexture->createTextureView(textureViewDescriptor);
+    EXPECT_NE(nullptr, m_outputTextureView);
+}
+
+void RenderGraphTest::TearDown()
+{
+    m_outputTextureView.reset();
+    m_outputTexture.reset();
+
+    Test::TearDown();
+}
+
+TextureDescriptor RenderGraphTest::getColorTextureDescriptor() const
+{
+    TextureDescriptor textureDescriptor{};
+    textureDescriptor.type = TextureType::k2D;
+    textureDescriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    textureDescriptor.width = 64;
+    textureDescriptor.height = 64;
+    textureDescriptor.depth = 1;
+    textureDescriptor.mipLevels = 1;
+    textureDescriptor.sampleCount = 1;
+
+    return textureDescriptor;
+}
+
+TEST_F(RenderGraphTest, test_cull)
+{
+    RenderGraph graph(*m_device, RenderGraphDescriptor{});
+
+    auto unused = graph.createTexture("unused", getColorTextureDescriptor());
+    auto output = graph.importTexture("output", *m_outputTextureView);
+
+    graph.addPass("unused", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .addColorAttachment({ .texture = unused });
+    graph.addPass("output", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .addColorAttachment({ .texture = output });
+    graph.addPass("side effect", RenderGraphPassType::kTransfer, [](RenderGraphPassContext&) {})
+        .setSideEffect();
+    graph.compile();
+
+    EXPECT_EQ(graph.getStatistics().culledPasses, 1);
+    EXPECT_EQ(graph.getStatistics().transientTextures, 0);
+    EXPECT_EQ(graph.getPassOrder(), (std::vector<std::string>{ "output", "side effect" }));
+}
+
+TEST_F(RenderGraphTest, test_order)
+{
+    RenderGraph graph(*m_device, RenderGraphDescriptor{});
+
+    auto shadow = graph.createTexture("shadow", getColorTextureDescriptor());
+    auto blur = graph.createTexture("blur", getColorTextureDescriptor());
+    auto gbuffer = graph.createTexture("gbuffer", getColorTextureDescriptor());
+    auto output = graph.importTexture("output", *m_outputTextureView);
+
+    graph.addPass("shadow", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .addColorAttachment({ .texture = shadow });
+    graph.addPass("blur", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .read(shadow, TextureUsageFlagBits::kTextureBinding)
+        .addColorAttachment({ .texture = blur });
+    graph.addPass("gbuffer", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .addColorAttachment({ .texture = gbuffer });
+    graph.addPass("lighting", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .read(blur, TextureUsageFlagBits::kTextureBinding)
+        .read(gbuffer, TextureUsageFlagBits::kTextureBinding)
+        .addColorAttachment({ .texture = output });
+    graph.compile();
+
+    // the independent pass is placed between the shadow pass and the pass which reads it.
+    EXPECT_EQ(graph.getPassOrder(), (std::vector<std::string>{ "shadow", "gbuffer", "blur", "lighting" }));
+    EXPECT_EQ(graph.getStatistics().dependencies, 3);
+}
+
+TEST_F(RenderGraphTest, test_alias)
+{
+    RenderGraph graph(*m_device, RenderGraphDescriptor{});
+
+    auto first = graph.createTexture("first", getColorTextureDescriptor());
+    auto second = graph.createTexture("second", getColorTextureDescriptor());
+    auto third = graph.createTexture("third", getColorTextureDescriptor());
+    auto output = graph.importTexture("output", *m_outputTextureView);
+
+    graph.addPass("first", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .addColorAttachment({ .texture = first });
+    graph.addPass("second", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .read(first, TextureUsageFlagBits::kTextureBinding)
+        .addColorAttachment({ .texture = second });
+    graph.addPass("third", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .read(second, TextureUsageFlagBits::kTextureBinding)
+        .addColorAttachment({ .texture = third });
+    graph.addPass("output", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .read(third, TextureUsageFlagBits::kTextureBinding)
+        .addColorAttachment({ .texture = output });
+    graph.compile();
+
+    // first is not used after second pass, so third shares its texture.
+    const auto& statistics = graph.getStatistics();
+    EXPECT_EQ(statistics.transientTextures, 3);
+    EXPECT_EQ(statistics.physicalTextures, 2);
+    EXPECT_EQ(statistics.aliasedMemory, 64 * 64 * 4);
+}
+
+TEST_F(RenderGraphTest, test_alias_compatible)
+{
+    RenderGraph graph(*m_device, RenderGraphDescriptor{});
+
+    auto first = graph.createTexture("first", getColorTextureDescriptor());
+    auto second = graph.createTexture("second", getColorTextureDescriptor());
+    auto third = graph.createTexture("third", getColorTextureDescriptor());
+    auto small = graph.createBuffer("small", { .size = 256, .usage = BufferUsageFlagBits::kStorage });
+    auto large = graph.createBuffer("large", { .size = 512, .usage = BufferUsageFlagBits::kUniform });
+    auto output = graph.importTexture("output", *m_outputTextureView);
+
+    graph.addPass("first", RenderGraphPassType::kCompute, [](RenderGraphPassContext&) {})
+        .write(first, TextureUsageFlagBits::kStorageBinding)
+        .write(small, BufferUsageFlagBits::kStorage);
+    graph.addPass("second", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .read(first, TextureUsageFlagBits::kTextureBinding)
+        .read(small, BufferUsageFlagBits::kStorage)
+        .addColorAttachment({ .texture = second });
+    graph.addPass("third", RenderGraphPassType::kTransfer, [](RenderGraphPassContext&) {})
+        .read(second, TextureUsageFlagBits::kCopySrc)
+        .write(third, TextureUsageFlagBits::kCopyDst)
+        .write(large, BufferUsageFlagBits::kCopyDst);
+    graph.addPass("output", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .read(third, TextureUsageFlagBits::kTextureBinding)
+        .read(large, BufferUsageFlagBits::kUniform)
+        .addColorAttachment({ .texture = output });
+    graph.compile();
+
+    // usages differ, but third shares the texture of first, and large shares the buffer of small which grows to 512 bytes.
+    const auto& statistics = graph.getStatistics();
+    EXPECT_EQ(statistics.physicalTextures, 2);
+    EXPECT_EQ(statistics.physicalBuffers, 1);
+    EXPECT_EQ(statistics.transientMemory, 2 * 64 * 64 * 4 + 512);
+    EXPECT_EQ(statistics.aliasedMemory, 64 * 64 * 4 + 256);
+}
+
+TEST_F(RenderGraphTest, test_merge_subpasses)
+{
+    RenderGraph graph(*m_device, RenderGraphDescriptor{});
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kGraphics;
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+
+    auto commandBuffer = m_device->createCommandBuffer(CommandBufferDescriptor{});
+    EXPECT_NE(nullptr, commandBuffer);
+
+    auto albedo = graph.createTexture("albedo", getColorTextureDescriptor());
+    auto normal = graph.createTexture("normal", getColorTextureDescriptor());
+    auto output = graph.importTexture("output", *m_outputTextureView);
+
+    std::optional<RenderPipelineSubpass> gbufferSubpass = std::nullopt;
+    std::optional<RenderPipelineSubpass> lightingSubpass = std::nullopt;
+    graph.addPass("gbuffer", RenderGraphPassType::kRender, [&](RenderGraphPassContext& context) { gbufferSubpass = context.getSubpass(); })
+        .addColorAttachment({ .texture = albedo })
+        .addColorAttachment({ .texture = normal });
+    graph.addPass("independent", RenderGraphPassType::kTransfer, [](RenderGraphPassContext&) {})
+        .setSideEffect();
+    graph.addPass("lighting", RenderGraphPassType::kRender, [&](RenderGraphPassContext& context) { lightingSubpass = context.getSubpass(); })
+        .readInputAttachment(albedo)
+        .readInputAttachment(normal)
+        .addColorAttachment({ .texture = output });
+    graph.compile();
+
+    // lighting follows gbuffer to be merged, even if the independent pass was ready before.
+    EXPECT_EQ(graph.getPassOrder(), (std::vector<std::string>{ "gbuffer", "lighting", "independent" }));
+    EXPECT_EQ(graph.getStatistics().mergedPasses, 1);
+    EXPECT_EQ(graph.getStatistics().physicalTextures, 2);
+
+    auto commandEncoder = commandBuffer->createCommandEncoder(CommandEncoderDescriptor{});
+    graph.execute(*commandEncoder);
+    queue->submit({ commandEncoder->finish() });
+
+    // the gbuffer stays in tile memory, so it is not stored.
+    EXPECT_EQ(graph.getStatistics().discardedStores, 2);
+
+    ASSERT_TRUE(gbufferSubpass.has_value());
+    ASSERT_TRUE(lightingSubpass.has_value());
+    EXPECT_EQ(gbufferSubpass->index, 0);
+    EXPECT_EQ(lightingSubpass->index, 1);
+    EXPECT_EQ(lightingSubpass->colorFormats.size(), 3);
+    EXPECT_EQ(lightingSubpass->depthStencilFormat, TextureFormat::kUndefined);
+    ASSERT_EQ(lightingSubpass->subpasses.size(), 2);
+    EXPECT_EQ(lightingSubpass->subpasses[0].colorAttachments, (std::vector<uint32_t>{ 0, 1 }));
+    EXPECT_EQ(lightingSubpass->subpasses[1].colorAttachments, (std::vector<uint32_t>{ 2 }));
+    EXPECT_EQ(lightingSubpass->subpasses[1].inputAttachments, (std::vector<uint32_t>{ 0, 1 }));
+}
+
+TEST_F(RenderGraphTest, test_merge_conflict)
+{
+    RenderGraph graph(*m_device, RenderGraphDescriptor{});
+
+    auto albedo = graph.createTexture("albedo", getColorTextureDescriptor());
+    auto normal = graph.createTexture("normal", getColorTextureDescriptor());
+    auto output = graph.importTexture("output", *m_outputTextureView);
+
+    graph.addPass("gbuffer", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .addColorAttachment({ .texture = albedo })
+        .addColorAttachment({ .texture = normal });
+    // sampling an attachment of the render pass needs a barrier between passes, so they can't be merged.
+    graph.addPass("lighting", RenderGraphPassType::kRender, [](RenderGraphPassContext&) {})
+        .readInputAttachment(albedo)
+        .read(normal, TextureUsageFlagBits::kTextureBinding)
+        .addColorAttachment({ .texture = output });
+
+    EXPECT_THROW(graph.compile(), std::runtime_error);
+}
+
+TEST_F(RenderGraphTest, test_execute)
+{
+    RenderGraph graph(*m_device, RenderGraphDescriptor{});
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kGraphics;
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+
+    CommandBufferDescriptor commandBufferDescriptor{};
+    auto commandBuffer = m_device->createCommandBuffer(commandBufferDescriptor);
+    EXPECT_NE(nullptr, commandBuffer);
+
+    for (auto frame = 0; frame < 2; ++frame)
+    {
+        auto scene = graph.createTexture("scene", getColorTextureDescriptor());
+        auto output = graph.importTexture("output", *m_outputTextureView);
+
+        uint32_t executedPasses = 0;
+        graph.addPass("scene", RenderGraphPassType::kRender, [&](RenderGraphPassContext& context) {
+                 EXPECT_EQ(&context.getTexture(scene), context.getTextureView(scene).getTexture());
+                 ++executedPasses;
+             })
+            .addColorAttachment({ .texture = scene });
+        graph.addPass("output", RenderGraphPassType::kRender, [&](RenderGraphPassContext& context) {
+                 EXPECT_EQ(&context.getTextureView(output), m_outputTextureView.get());
+                 ++executedPasses;
+             })
+            .read(scene, TextureUsageFlagBits::kTextureBinding)
+            .addColorAttachment({ .texture = output });
+
+        auto commandEncoder = commandBuffer->createCommandEncoder(CommandEncoderDescriptor{});
+        graph.execute(*commandEncoder);
+        queue->submit({ commandEncoder->finish() });
+
+        EXPECT_EQ(executedPasses, 2);
+        // the physical texture of the previous frame is reused.
+        EXPECT_EQ(graph.getStatistics().createdTextures, frame == 0 ? 1 : 0);
+
+        graph.reset();
+    }
+}
+
+TEST_F(RenderGraphTest, test_reuse_completed_buffer)
+{
+    RenderGraph graph(*m_device, RenderGraphDescriptor{});
+
+    QueueDescriptor queueDescriptor{};
+    queueDescriptor.flags = QueueFlagBits::kGraphics;
+    auto queue = m_device->createQueue(queueDescriptor);
+    EXPECT_NE(nullptr, queue);
+
+    auto firstCommandBuffer = m_device->createCommandBuffer(CommandBufferDescriptor{});
+    auto secondCommandBuffer = m_device->createCommandBuffer(CommandBufferDescriptor{});
+
+    BufferDescriptor bufferDescriptor{};
+    bufferDescriptor.size = 256;
+    bufferDescriptor.usage = BufferUsageFlagBits::kStorage;
+
+    auto execute = [&](CommandBuffer& commandBuffer) {
+        auto scratch = graph.createBuffer("scratch", bufferDescriptor);
+        graph.addPass("scratch", RenderGraphPassType::kTransfer, [](RenderGraphPassContext&) {})
+            .write(scratch, BufferUsageFlagBits::kStorage)
+            .setSideEffect();
+
+        auto commandEncoder = commandBuffer.createCommandEncoder(CommandEncoderDescriptor{});
+        graph.execute(*commandEncoder);
+        commandEncoder->finish();
+
+        auto createdBuffers = graph.getStatistics().createdBuffers;
+        graph.reset();
+
+        return createdBuffers;
+    };
+
+    EXPECT_EQ(execute(*firstCommandBuffer), 1);
+    // the buffer of the previous frame is not submitted yet, so it is not reused.
+    EXPECT_EQ(execute(*secondCommandBuffer), 1);
+
+    queue->submit({ *firstCommandBuffer, *secondCommandBuffer });
+
+    EXPECT_EQ(execute(*firstCommandBuffer), 0);
+    queue->submit({ *firstCommandBuffer });
+}
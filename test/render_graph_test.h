@@ -0,0 +1,22 @@
+#pragma once
+
+#include "base/test.h"
+
+#include "jipu/render_graph.h"
+
+namespace jipu
+{
+
+class RenderGraphTest : public Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    TextureDescriptor getColorTextureDescriptor() const;
+
+    std::unique_ptr<Texture> m_outputTexture = nullptr;
+    std::unique_ptr<TextureView> m_outputTextureView = nullptr;
+};
+
+} // namespace jipu
@@ -0,0 +1,156 @@
+#include "texture_streamer_test.h"
+
+#include "jipu/upload_manager.h"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace jipu;
+
+namespace
+{
+
+// RGBA8 bytes of all mips from the level.
+uint64_t getMipBytes(uint32_t size, uint32_t baseMipLevel)
+{
+    uint64_t bytes = 0;
+    for (uint32_t mipSize = size >> baseMipLevel; mipSize > 0; mipSize >>= 1)
+        bytes += mipSize * mipSize * 4;
+
+    return bytes;
+}
+
+} // namespace
+
+void TextureStreamerTest::SetUp()
+{
+    Test::SetUp();
+
+    m_directory = std::filesystem::temp_directory_path() / "jipu_texture_streamer_test";
+    std::filesystem::create_directories(m_directory);
+}
+
+void TextureStreamerTest::TearDown()
+{
+    std::filesystem::remove_all(m_directory);
+
+    Test::TearDown();
+}
+
+std::filesystem::path TextureStreamerTest::writeImage(const std::string& name, uint32_t size)
+{
+    const auto path = m_directory / (name + ".ppm");
+
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n"
+         << size << " " << size << "\n255\n";
+
+    std::vector<char> pixels(static_cast<size_t>(size) * size * 3, 0x40);
+    file.write(pixels.data(), pixels.size());
+
+    return path;
+}
+
+void TextureStreamerTest::update(TextureStreamer& streamer)
+{
+    streamer.update();
+
+    auto& uploadManager = m_device->getUploadManager();
+    uploadManager.wait(uploadManager.flush());
+}
+
+void TextureStreamerTest::waitForDecodedBytes(TextureStreamer& streamer, uint64_t bytes)
+{
+    for (auto i = 0; i < 1000 && streamer.getDecodedBytes() != bytes; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    EXPECT_EQ(streamer.getDecodedBytes(), bytes);
+}
+
+TEST_F(TextureStreamerTest, test_residency_and_version)
+{
+    // a mip is uploaded in an update at least.
+    TextureStreamer streamer(*m_device, TextureStreamerDescriptor{ .workerCount = 1, .uploadBudget = 1 });
+
+    auto& texture = streamer.load({ .path = writeImage("texture", 16) });
+    waitForDecodedBytes(streamer, getMipBytes(16, 0));
+
+    EXPECT_EQ(texture.getTextureView(), nullptr);
+    EXPECT_EQ(texture.getResidentMipLevel(), UINT32_MAX);
+
+    update(streamer);
+    EXPECT_NE(texture.getTexture(), nullptr);
+    EXPECT_EQ(texture.getTextureView(), nullptr);
+
+    // mips are resident from the coarsest one, and the view is recreated for each.
+    for (uint32_t mipLevel = 5; mipLevel-- > 0;)
+    {
+        update(streamer);
+        EXPECT_NE(texture.getTextureView(), nullptr);
+        EXPECT_EQ(texture.getResidentMipLevel(), mipLevel);
+        EXPECT_EQ(texture.getVersion(), 5 - mipLevel);
+    }
+    EXPECT_EQ(streamer.getDecodedBytes(), 0);
+
+    // nothing is changed after all mips are resident.
+    update(streamer);
+    EXPECT_EQ(texture.getResidentMipLevel(), 0);
+    EXPECT_EQ(texture.getVersion(), 5);
+}
+
+TEST_F(TextureStreamerTest, test_priority_order)
+{
+    TextureStreamer streamer(*m_device, TextureStreamerDescriptor{ .workerCount = 1, .uploadBudget = 1 });
+
+    // both are larger on the screen than their sizes, so all mips are decoded.
+    auto& near = streamer.load({ .path = writeImage("near", 16) });
+    auto& far = streamer.load({ .path = writeImage("far", 16) });
+    near.setScreenSize(64.0f);
+    far.setScreenSize(20.0f);
+
+    waitForDecodedBytes(streamer, getMipBytes(16, 0) * 2);
+
+    // the coarsest mips of both are uploaded first.
+    update(streamer);
+    update(streamer);
+
+    // then a mip of the texture which is the largest on the screen relative to its uploaded mip is uploaded.
+    const std::vector<std::pair<uint32_t, uint32_t>> residentMipLevels{
+        { 4, 4 }, { 3, 4 }, { 2, 4 }, { 2, 3 }, { 1, 3 }, { 1, 2 }, { 0, 2 }, { 0, 1 }, { 0, 0 }
+    };
+    for (const auto& [nearMipLevel, farMipLevel] : residentMipLevels)
+    {
+        update(streamer);
+        EXPECT_EQ(near.getResidentMipLevel(), nearMipLevel);
+        EXPECT_EQ(far.getResidentMipLevel(), farMipLevel);
+    }
+    EXPECT_EQ(near.getVersion(), 5);
+    EXPECT_EQ(far.getVersion(), 5);
+}
+
+TEST_F(TextureStreamerTest, test_memory_budget)
+{
+    // workers don't start decoding while decoded mips exceed the budget.
+    TextureStreamer streamer(*m_device, TextureStreamerDescriptor{ .workerCount = 1, .memoryBudget = 1 });
+
+    auto& first = streamer.load({ .path = writeImage("first", 16) });
+    auto& second = streamer.load({ .path = writeImage("second", 8) });
+
+    waitForDecodedBytes(streamer, getMipBytes(16, 0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(streamer.getDecodedBytes(), getMipBytes(16, 0));
+
+    // uploads release the decoded mips, and the second texture is decoded.
+    update(streamer);
+    EXPECT_NE(first.getTexture(), nullptr);
+    EXPECT_EQ(second.getTexture(), nullptr);
+
+    waitForDecodedBytes(streamer, getMipBytes(8, 0));
+    update(streamer);
+    update(streamer);
+    EXPECT_EQ(first.getResidentMipLevel(), 0);
+    EXPECT_EQ(second.getResidentMipLevel(), 0);
+}
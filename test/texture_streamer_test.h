@@ -0,0 +1,30 @@
+#pragma once
+#include "base/test.h"
+
+#include "texture_streamer.h"
+
+#include <filesystem>
+#include <string>
+
+namespace jipu
+{
+
+class TextureStreamerTest : public Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+protected:
+    /// @brief write a square gray image to a temporary file. it has log2(size) + 1 mips.
+    std::filesystem::path writeImage(const std::string& name, uint32_t size);
+    /// @brief update the streamer and wait for the uploads of the update. they are resident by next update.
+    void update(TextureStreamer& streamer);
+    /// @brief wait until workers decode the bytes.
+    void waitForDecodedBytes(TextureStreamer& streamer, uint64_t bytes);
+
+protected:
+    std::filesystem::path m_directory{};
+};
+
+} // namespace jipu
@@ -201,3 +201,49 @@ TEST_F(TextureTest, test_createtexture_with_format)
         ASSERT_NE(texture, nullptr);
     }
 }
+
+TEST_F(TextureTest, test_createtextureview_with_mip_levels)
+{
+    TextureDescriptor descriptor{};
+    descriptor.type = TextureType::k2D;
+    descriptor.format = TextureFormat::kRGBA_8888_UInt_Norm;
+    descriptor.usage = TextureUsageFlagBits::kTextureBinding;
+    descriptor.width = 8;
+    descriptor.height = 8;
+    descriptor.depth = 1;
+    descriptor.mipLevels = 4;
+    descriptor.sampleCount = 1;
+
+    std::unique_ptr<Texture> texture = m_device->createTexture(descriptor);
+    ASSERT_NE(texture, nullptr);
+
+    TextureViewDescriptor viewDescriptor{};
+    viewDescriptor.type = TextureViewType::k2D;
+    viewDescriptor.aspect = TextureAspectFlagBits::kColor;
+
+    {
+        viewDescriptor.baseMipLevel = 2;
+        viewDescriptor.mipLevelCount = 0;
+        auto textureView = texture->createTextureView(viewDescriptor);
+        ASSERT_NE(textureView, nullptr);
+    }
+
+    {
+        viewDescriptor.baseMipLevel = 1;
+        viewDescriptor.mipLevelCount = 2;
+        auto textureView = texture->createTextureView(viewDescriptor);
+        ASSERT_NE(textureView, nullptr);
+    }
+
+    {
+        viewDescriptor.baseMipLevel = 4;
+        viewDescriptor.mipLevelCount = 0;
+        ASSERT_ANY_THROW({ texture->createTextureView(viewDescriptor); });
+    }
+
+    {
+        viewDescriptor.baseMipLevel = 2;
+        viewDescriptor.mipLevelCount = 3;
+        ASSERT_ANY_THROW({ texture->createTextureView(viewDescriptor); });
+    }
+}
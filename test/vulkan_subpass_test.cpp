@@ -0,0 +1,129 @@
+#include "vulkan_subpass_test.h"
+
+#include <stdexcept>
+
+using namespace jipu;
+
+std::vector<uint32_t> VulkanSubpassTest::getAttachments(const std::vector<VkAttachmentReference>& references) const
+{
+    std::vector<uint32_t> attachments{};
+    for (const auto& reference : references)
+        attachments.push_back(reference.attachment);
+
+    return attachments;
+}
+
+TEST_F(VulkanSubpassTest, test_default_subpass)
+{
+    // attachments are ordered as color 0, 1, resolve 2, 3 and depth stencil 4.
+    auto descriptions = generateVulkanSubpassDescriptions({}, 2, true, true);
+    EXPECT_EQ(descriptions.size(), 1);
+
+    const auto& description = descriptions[0];
+    EXPECT_EQ(description.pipelineBindPoint, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    EXPECT_TRUE(description.inputAttachments.empty());
+    EXPECT_EQ(getAttachments(description.colorAttachments), (std::vector<uint32_t>{ 0, 1 }));
+    EXPECT_EQ(getAttachments(description.resolveAttachments), (std::vector<uint32_t>{ 2, 3 }));
+    EXPECT_TRUE(description.depthStencilAttachment.has_value());
+    EXPECT_EQ(description.depthStencilAttachment->attachment, 4);
+    EXPECT_EQ(description.depthStencilAttachment->layout, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    EXPECT_TRUE(description.preserveAttachments.empty());
+
+    auto dependencies = generateVulkanSubpassDependencies({}, 2, true);
+    EXPECT_EQ(dependencies.size(), 1);
+    EXPECT_EQ(dependencies[0].srcSubpass, VK_SUBPASS_EXTERNAL);
+    EXPECT_EQ(dependencies[0].dstSubpass, 0);
+    EXPECT_EQ(dependencies[0].dstAccessMask, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+}
+
+TEST_F(VulkanSubpassTest, test_input_attachments)
+{
+    // gbuffer writes albedo 0 and normal 1 with depth, and lighting reads them to write output 2.
+    std::vector<SubpassDescriptor> subpasses{
+        { .colorAttachments = { 0, 1 }, .depthStencil = true },
+        { .colorAttachments = { 2 }, .inputAttachments = { 0, 1 }, .depthStencil = false },
+    };
+
+    auto descriptions = generateVulkanSubpassDescriptions(subpasses, 3, false, true);
+    EXPECT_EQ(descriptions.size(), 2);
+
+    EXPECT_EQ(getAttachments(descriptions[0].colorAttachments), (std::vector<uint32_t>{ 0, 1 }));
+    EXPECT_TRUE(descriptions[0].resolveAttachments.empty());
+    EXPECT_EQ(descriptions[0].depthStencilAttachment->attachment, 3);
+
+    EXPECT_EQ(getAttachments(descriptions[1].inputAttachments), (std::vector<uint32_t>{ 0, 1 }));
+    EXPECT_EQ(descriptions[1].inputAttachments[0].layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    EXPECT_EQ(getAttachments(descriptions[1].colorAttachments), (std::vector<uint32_t>{ 2 }));
+    EXPECT_FALSE(descriptions[1].depthStencilAttachment.has_value());
+
+    auto dependencies = generateVulkanSubpassDependencies(subpasses, 3, true);
+    EXPECT_EQ(dependencies.size(), 3);
+
+    // output is used first by lighting, so lighting waits for the previous use too.
+    EXPECT_EQ(dependencies[0].srcSubpass, VK_SUBPASS_EXTERNAL);
+    EXPECT_EQ(dependencies[0].dstSubpass, 0);
+    EXPECT_EQ(dependencies[1].srcSubpass, VK_SUBPASS_EXTERNAL);
+    EXPECT_EQ(dependencies[1].dstSubpass, 1);
+    EXPECT_EQ(dependencies[1].dstAccessMask, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+    const auto& dependency = dependencies[2];
+    EXPECT_EQ(dependency.srcSubpass, 0);
+    EXPECT_EQ(dependency.dstSubpass, 1);
+    EXPECT_EQ(dependency.dependencyFlags, VK_DEPENDENCY_BY_REGION_BIT);
+    EXPECT_EQ(dependency.srcStageMask, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    EXPECT_EQ(dependency.srcAccessMask, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    EXPECT_EQ(dependency.dstStageMask, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    EXPECT_EQ(dependency.dstAccessMask, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT);
+}
+
+TEST_F(VulkanSubpassTest, test_resolve_and_preserve)
+{
+    std::vector<SubpassDescriptor> subpasses{
+        { .colorAttachments = { 0 } },
+        { .colorAttachments = { 1 } },
+        { .colorAttachments = { 0 }, .inputAttachments = { 1 } },
+    };
+
+    auto descriptions = generateVulkanSubpassDescriptions(subpasses, 2, true, false);
+    EXPECT_EQ(descriptions.size(), 3);
+
+    // attachments are resolved by the last subpass which writes them.
+    EXPECT_EQ(getAttachments(descriptions[0].resolveAttachments), (std::vector<uint32_t>{ VK_ATTACHMENT_UNUSED }));
+    EXPECT_EQ(getAttachments(descriptions[1].resolveAttachments), (std::vector<uint32_t>{ 3 }));
+    EXPECT_EQ(getAttachments(descriptions[2].resolveAttachments), (std::vector<uint32_t>{ 2 }));
+
+    // attachment 0 is written before and after the second subpass.
+    EXPECT_TRUE(descriptions[0].preserveAttachments.empty());
+    EXPECT_EQ(descriptions[1].preserveAttachments, (std::vector<uint32_t>{ 0 }));
+    EXPECT_TRUE(descriptions[2].preserveAttachments.empty());
+
+    for (const auto& description : descriptions)
+        EXPECT_FALSE(description.depthStencilAttachment.has_value());
+
+    // the first two subpasses don't share attachments, so there is no dependency between them.
+    auto dependencies = generateVulkanSubpassDependencies(subpasses, 2, false);
+    EXPECT_EQ(dependencies.size(), 4);
+
+    EXPECT_EQ(dependencies[0].srcSubpass, VK_SUBPASS_EXTERNAL);
+    EXPECT_EQ(dependencies[0].dstSubpass, 0);
+    EXPECT_EQ(dependencies[1].srcSubpass, VK_SUBPASS_EXTERNAL);
+    EXPECT_EQ(dependencies[1].dstSubpass, 1);
+
+    EXPECT_EQ(dependencies[2].srcSubpass, 0);
+    EXPECT_EQ(dependencies[2].dstSubpass, 2);
+    EXPECT_EQ(dependencies[2].dstStageMask, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    EXPECT_EQ(dependencies[2].dstAccessMask, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+    EXPECT_EQ(dependencies[3].srcSubpass, 1);
+    EXPECT_EQ(dependencies[3].dstSubpass, 2);
+    EXPECT_EQ(dependencies[3].dstAccessMask, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT);
+}
+
+TEST_F(VulkanSubpassTest, test_invalid_attachments)
+{
+    std::vector<SubpassDescriptor> outOfRange{ { .colorAttachments = { 2 } } };
+    EXPECT_THROW(generateVulkanSubpassDescriptions(outOfRange, 2, false, false), std::runtime_error);
+
+    std::vector<SubpassDescriptor> colorAndInput{ { .colorAttachments = { 0 }, .inputAttachments = { 0 } } };
+    EXPECT_THROW(generateVulkanSubpassDescriptions(colorAndInput, 1, false, false), std::runtime_error);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "gtest/gtest.h"
+
+#include "vulkan_render_pass.h"
+
+namespace jipu
+{
+
+// subpass descriptions and dependencies are generated without a device.
+class VulkanSubpassTest : public ::testing::Test
+{
+protected:
+    std::vector<uint32_t> getAttachments(const std::vector<VkAttachmentReference>& references) const;
+};
+
+} // namespace jipu